@@ -258,6 +258,7 @@ typedef struct SQueryTableDataCond {
   STimeWindow  twindows;
   int64_t      startVersion;
   int64_t      endVersion;
+  int8_t       rollupLevel;  // the lowest rollup level to read, 0 for the raw data
 } SQueryTableDataCond;
 
 int32_t tEncodeDataBlock(void** buf, const SSDataBlock* pBlock);
@@ -359,6 +360,7 @@ typedef struct {
 
 #define SORT_QSORT_T              0x1
 #define SORT_SPILLED_MERGE_SORT_T 0x2
+#define SORT_TOPK_T               0x3
 typedef struct SSortExecInfo {
   int32_t sortMethod;
   int32_t sortBuffer;
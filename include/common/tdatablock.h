@@ -229,6 +229,11 @@ size_t blockDataGetSerialMetaSize(uint32_t numOfCols);
 int32_t blockDataSort(SSDataBlock* pDataBlock, SArray* pOrderInfo);
 int32_t blockDataSort_rv(SSDataBlock* pDataBlock, SArray* pOrderInfo, bool nullFirst);
 
+// The order columns of a row are encoded into a key of fixed length, and the keys compare by memcmp in the same order
+// as pOrderInfo. The key length is 0 if any order column is of var type.
+int32_t blockDataGetSortKeyLen(const SSDataBlock* pBlock, const SArray* pOrderInfo);
+void    blockDataBuildSortKeys(const SSDataBlock* pBlock, const SArray* pOrderInfo, char* pKeys, int32_t stride);
+
 int32_t colInfoDataEnsureCapacity(SColumnInfoData* pColumn, uint32_t numOfRows, bool clearPayload);
 int32_t blockDataEnsureCapacity(SSDataBlock* pDataBlock, uint32_t numOfRows);
 int32_t blockDataEnsureCapacityNoClear(SSDataBlock* pDataBlock, uint32_t numOfRows);
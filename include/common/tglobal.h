@@ -96,6 +96,8 @@ extern bool    tsQueryPlannerTrace;
 extern int32_t tsQueryNodeChunkSize;
 extern bool    tsQueryUseNodeAllocator;
 extern bool    tsKeepColumnName;
+extern int32_t tsQueryPlanCacheSize;
+extern bool    tsQueryStatsOptimize;
 extern bool    tsEnableQueryHb;
 extern int32_t tsRedirectPeriod;
 extern int32_t tsRedirectFactor;
@@ -126,9 +128,10 @@ extern int32_t  tsDiskCfgNum;
 extern SDiskCfg tsDiskCfg[];
 
 // udf
-extern bool tsStartUdfd;
-extern char tsUdfdResFuncs[];
-extern char tsUdfdLdLibPath[];
+extern bool    tsStartUdfd;
+extern char    tsUdfdResFuncs[];
+extern char    tsUdfdLdLibPath[];
+extern int32_t tsUdfShmSize;
 
 // schemaless
 extern char    tsSmlChildTableName[];
@@ -139,10 +142,17 @@ extern int32_t tsSmlBatchSize;
 // wal
 extern int64_t tsWalFsyncDataSizeLimit;
 
+// tsdb
+extern int32_t tsCompactMaxSpeed;
+extern int32_t tsCompactInterval;
+extern int32_t tsCacheLastLoad;
+extern int32_t tsMigrateMaxSpeed;
+
 // internal
 extern int32_t tsTransPullupInterval;
 extern int32_t tsMqRebalanceInterval;
 extern int32_t tsStreamCheckpointTickInterval;
+extern int32_t tsStreamBufferSize;
 extern int32_t tsTtlUnit;
 extern int32_t tsTtlPushInterval;
 extern int32_t tsGrantHBInterval;
@@ -22,6 +22,7 @@
 #include "tcoding.h"
 #include "tencode.h"
 #include "thash.h"
+#include "thll.h"
 #include "tlist.h"
 #include "tname.h"
 #include "trow.h"
@@ -720,6 +721,23 @@ typedef struct {
   char     tbName[TSDB_TABLE_NAME_LEN];
 } STableCfgReq;
 
+typedef struct STagNdv {
+  col_id_t colId;
+  int64_t  ndv;  // estimated number of distinct values
+} STagNdv;
+
+typedef struct STableStats {
+  int64_t  numOfTables;
+  int64_t  numOfRows;  // rows in the files of the vnodes, without those in memory
+  TSKEY    skey;
+  TSKEY    ekey;
+  int32_t  numOfTags;
+  STagNdv* pTagNdv;  // tags with no value reported are absent
+} STableStats;
+
+STableStats* tCloneTableStats(const STableStats* pStats);
+void         tFreeTableStats(STableStats* pStats);
+
 typedef struct {
   char     tbName[TSDB_TABLE_NAME_LEN];
   char     stbName[TSDB_TABLE_NAME_LEN];
@@ -738,6 +756,7 @@ typedef struct {
   SSchema* pSchemas;
   int32_t  tagsLen;
   char*    pTags;
+  STableStats* pStats;  // of super tables only, NULL if no statistics are reported yet
 } STableCfg;
 
 typedef STableCfg STableCfgRsp;
@@ -1087,6 +1106,24 @@ typedef struct {
   int64_t numOfBatchInsertSuccessReqs;
 } SVnodeLoad;
 
+typedef struct {
+  col_id_t colId;
+  uint8_t  sketch[HLL_SKETCH_REGISTERS];  // distinct values of the tag in the child tables
+} STagSketch;
+
+// the statistics of a super table in a vnode, merged by mnode for all vnodes of the super table
+typedef struct {
+  int32_t vgId;
+  int64_t suid;
+  int64_t numOfTables;
+  int64_t numOfRows;  // rows in the data files
+  TSKEY   skey;
+  TSKEY   ekey;
+  SArray* pTagSketches;  // array of STagSketch
+} SStbStatsLoad;
+
+void tFreeSStbStatsLoad(void* pLoad);
+
 typedef struct {
   int8_t syncState;
   int8_t syncRestore;
@@ -1124,6 +1161,7 @@ typedef struct {
   SClusterCfg clusterCfg;
   SArray*     pVloads;  // array of SVnodeLoad
   int32_t     statusSeq;
+  SArray*     pStbStats;  // array of SStbStatsLoad
 } SStatusReq;
 
 int32_t tSerializeSStatusReq(void* buf, int32_t bufLen, SStatusReq* pReq);
@@ -167,7 +167,8 @@ typedef struct tExprNode {
     } _function;
 
     struct {
-      struct SNode *pRootNode;
+      struct SNode          *pRootNode;
+      struct SScalarProgram *pProgram;  // the compiled pRootNode, NULL if it is not supported
     } _optrRoot;
   };
 } tExprNode;
@@ -99,18 +99,27 @@ typedef struct SScanLogicNode {
   SNodeList*    pTags;      // for create stream
   SNode*        pSubtable;  // for create stream
   int8_t        cacheLastMode;
+  SRollupInfo   rollupInfo;
+  STableStats*  pStats;         // statistics of the super table, NULL if unknown
+  int8_t        rollupLevel;    // rollup level to read, 0 for the raw data
   bool          hasNormalCols;  // neither tag column nor primary key tag column
   bool          sortPrimaryKey;
   bool          igLastNull;
 } SScanLogicNode;
 
+typedef enum EJoinAlgorithm { JOIN_ALGO_MERGE = 1, JOIN_ALGO_HASH } EJoinAlgorithm;
+
 typedef struct SJoinLogicNode {
-  SLogicNode node;
-  EJoinType  joinType;
-  SNode*     pMergeCondition;
-  SNode*     pOnConditions;
-  bool       isSingleTableJoin;
-  EOrder     inputTsOrder;
+  SLogicNode     node;
+  EJoinType      joinType;
+  EJoinAlgorithm joinAlgo;
+  SNode*         pMergeCondition;
+  SNode*         pOnConditions;
+  SNodeList*     pLeftKeys;   // equi-join keys of the hash join from the left child
+  SNodeList*     pRightKeys;  // equi-join keys of the hash join from the right child
+  int8_t         buildSide;   // the child the hash table is built from, 0: left, 1: right
+  bool           isSingleTableJoin;
+  EOrder         inputTsOrder;
 } SJoinLogicNode;
 
 typedef struct SAggLogicNode {
@@ -356,6 +365,7 @@ typedef struct STableScanPhysiNode {
   int64_t        watermark;
   int8_t         igExpired;
   bool           assignBlockUid;
+  int8_t         rollupLevel;
 } STableScanPhysiNode;
 
 typedef STableScanPhysiNode STableSeqScanPhysiNode;
@@ -396,6 +406,16 @@ typedef struct SSortMergeJoinPhysiNode {
   EOrder     inputTsOrder;
 } SSortMergeJoinPhysiNode;
 
+typedef struct SHashJoinPhysiNode {
+  SPhysiNode node;
+  EJoinType  joinType;
+  SNodeList* pLeftKeys;
+  SNodeList* pRightKeys;
+  SNode*     pOnConditions;
+  SNodeList* pTargets;
+  int8_t     buildSide;
+} SHashJoinPhysiNode;
+
 typedef struct SAggPhysiNode {
   SPhysiNode node;
   SNodeList* pExprs;  // these are expression list of group_by_clause and parameter expression of aggregate function
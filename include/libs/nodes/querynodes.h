@@ -152,6 +152,11 @@ typedef struct STableNode {
 
 struct STableMeta;
 
+typedef struct SRollupInfo {
+  char    funcName[TSDB_FUNC_NAME_LEN];  // rollup function of the super table, empty if the db has no rollup level
+  int64_t freq[TSDB_RETENTION_L2];       // granularity of the r1 and r2 levels, in the precision of the db
+} SRollupInfo;
+
 typedef struct SRealTableNode {
   STableNode         table;  // QUERY_NODE_REAL_TABLE
   struct STableMeta* pMeta;
@@ -160,6 +165,8 @@ typedef struct SRealTableNode {
   double             ratio;
   SArray*            pSmaIndexes;
   int8_t             cacheLastMode;
+  SRollupInfo        rollupInfo;
+  STableStats*       pStats;
 } SRealTableNode;
 
 typedef struct STempTableNode {
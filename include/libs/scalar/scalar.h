@@ -39,6 +39,16 @@ pDst need to freed in caller
 */
 int32_t scalarCalculate(SNode *pNode, SArray *pBlockList, SScalarParam *pDst);
 
+/*
+The arithmetic expression over numeric columns is compiled into a program, which is run by chunks of rows.
+*pProgram is NULL if the expression is not supported, and it should be calculated by scalarCalculate.
+*/
+typedef struct SScalarProgram SScalarProgram;
+
+int32_t scalarCompile(SNode *pNode, SScalarProgram **pProgram);
+int32_t scalarExecute(SScalarProgram *pProgram, SSDataBlock *pSrcBlock, SColumnInfoData *pOutput, int32_t offset);
+void    scalarDestroyProgram(SScalarProgram *pProgram);
+
 int32_t scalarGetOperatorParamNum(EOperatorType type);
 int32_t scalarGenerateSetFromList(void **data, void *pNode, uint32_t type);
 
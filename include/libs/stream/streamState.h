@@ -16,26 +16,29 @@
 #include "tdatablock.h"
 #include "tdbInt.h"
 
+#ifndef _STREAM_STATE_H_
+#define _STREAM_STATE_H_
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#ifndef _STREAM_STATE_H_
-#define _STREAM_STATE_H_
-
 typedef struct SStreamTask SStreamTask;
 
 typedef bool (*state_key_cmpr_fn)(void* pKey1, void* pKey2);
 
+typedef struct SStreamStateBuf SStreamStateBuf;
+
 typedef struct STdbState {
-  SStreamTask* pOwner;
-  TDB*         db;
-  TTB*         pStateDb;
-  TTB*         pFuncStateDb;
-  TTB*         pFillStateDb;  // todo refactor
-  TTB*         pSessionStateDb;
-  TTB*         pParNameDb;
-  TXN*         txn;
+  SStreamTask*     pOwner;
+  TDB*             db;
+  TTB*             pStateDb;
+  TTB*             pFuncStateDb;
+  TTB*             pFillStateDb;  // todo refactor
+  TTB*             pSessionStateDb;
+  TTB*             pParNameDb;
+  TXN*             txn;
+  SStreamStateBuf* pStateBuf;  // write buffer in front of pStateDb, flushed when committed
 } STdbState;
 
 // incremental state storage
@@ -66,6 +69,17 @@ int32_t streamStateDel(SStreamState* pState, const SWinKey* key);
 int32_t streamStateClear(SStreamState* pState);
 void    streamStateSetNumber(SStreamState* pState, int32_t number);
 
+typedef struct {
+  int64_t hit;
+  int64_t miss;
+  int64_t numOfEntries;
+  int64_t numOfDirty;     // not written to the state table yet
+  int64_t numOfDetached;  // dropped from the buffer but still held by the callers
+  int64_t size;
+} SStreamStateBufStat;
+
+void streamStateGetBufStat(SStreamState* pState, SStreamStateBufStat* pStat);
+
 int32_t streamStateSessionAddIfNotExist(SStreamState* pState, SSessionKey* key, TSKEY gap, void** pVal, int32_t* pVLen);
 int32_t streamStateSessionPut(SStreamState* pState, const SSessionKey* key, const void* value, int32_t vLen);
 int32_t streamStateSessionGet(SStreamState* pState, SSessionKey* key, void** pVal, int32_t* pVLen);
@@ -24,13 +24,13 @@
 #include "tqueue.h"
 #include "trpc.h"
 
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#ifndef _STREAM_H_
-#define _STREAM_H_
-
 typedef struct SStreamTask SStreamTask;
 
 enum {
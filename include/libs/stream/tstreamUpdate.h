@@ -30,6 +30,9 @@ typedef struct SUpdateKey {
   TSKEY   ts;
 } SUpdateKey;
 
+// the per-table state is split into shards by table uid, so that a serialization only carries the changed shards
+#define UPDATE_INFO_NUM_SHARDS 64
+
 typedef struct SUpdateInfo {
   SArray      *pTsBuckets;
   uint64_t     numBuckets;
@@ -43,6 +46,9 @@ typedef struct SUpdateInfo {
   STimeWindow  scanWindow;
   uint64_t     scanGroupId;
   uint64_t     maxVersion;
+  uint64_t     dirtyShards;    // bitmap of the table shards changed since the last updateInfoClearDirty
+  SArray      *pSBFDirty;      // int8_t, whether the filter of the same index in pTsSBFs changed
+  int8_t       closeWinDirty;  // whether pCloseWinSBF changed
 } SUpdateInfo;
 
 SUpdateInfo *updateInfoInitP(SInterval *pInterval, int64_t watermark);
@@ -57,6 +63,7 @@ void         updateInfoAddCloseWindowSBF(SUpdateInfo *pInfo);
 void         updateInfoDestoryColseWinSBF(SUpdateInfo *pInfo);
 int32_t      updateInfoSerialize(void *buf, int32_t bufLen, const SUpdateInfo *pInfo);
 int32_t      updateInfoDeserialize(void *buf, int32_t bufLen, SUpdateInfo *pInfo);
+void         updateInfoClearDirty(SUpdateInfo *pInfo);
 
 #ifdef __cplusplus
 }
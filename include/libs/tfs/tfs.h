@@ -104,6 +104,28 @@ const char *tfsGetPrimaryPath(STfs *pTfs);
  */
 const char *tfsGetDiskPath(STfs *pTfs, SDiskID diskId);
 
+/**
+ * @brief Limit the I/O rate on a disk, shared by all callers. Sleep when the bytes reported go past the budget.
+ *
+ * @param pTfs The fs object.
+ * @param diskId The diskId.
+ * @param nBytes Bytes just read from or written to the disk.
+ * @param speed Bytes per second, 0 means unlimited.
+ */
+void tfsThrottle(STfs *pTfs, SDiskID diskId, int64_t nBytes, int64_t speed);
+
+/**
+ * @brief Charge the bytes to the I/O budget of a disk as tfsThrottle() does, without sleeping.
+ *
+ * @param pTfs The fs object.
+ * @param diskId The diskId.
+ * @param nBytes Bytes just read from or written to the disk.
+ * @param speed Bytes per second, 0 means unlimited.
+ * @param nowUs The current time in microseconds.
+ * @return int64_t Microseconds to wait before the next I/O, 0 or less if none.
+ */
+int64_t tfsThrottleAt(STfs *pTfs, SDiskID diskId, int64_t nBytes, int64_t speed, int64_t nowUs);
+
 /**
  * @brief Make directory at all levels in tfs.
  *
@@ -105,6 +105,7 @@ int32_t taosRemoveFile(const char *path);
 void taosGetTmpfilePath(const char *inputTmpDir, const char *fileNamePrefix, char *dstPath);
 
 int64_t taosFSendFile(TdFilePtr pFileOut, TdFilePtr pFileIn, int64_t *offset, int64_t size);
+int64_t taosFCopyFile(TdFilePtr pFileOut, TdFilePtr pFileIn, int64_t *offset, int64_t size);
 
 bool taosValidFile(TdFilePtr pFile);
 
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_OS_SHM_H_
+#define _TD_OS_SHM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// If the error is in a third-party library, place this header file under the third-party library header file.
+// When you want to use this feature, you should find or add the same function in the following section.
+#ifndef ALLOW_FORBID_FUNC
+#define shm_open   SHM_OPEN_FUNC_TAOS_FORBID
+#define shm_unlink SHM_UNLINK_FUNC_TAOS_FORBID
+#endif
+
+#define TD_SHM_NAME_LEN 64
+
+typedef struct TdShm *TdShmPtr;
+
+// create a named shared memory segment and map it, the name is removed when the creator closes it
+TdShmPtr taosCreateShm(const char *name, int64_t size);
+// map an existing named shared memory segment created by another process
+TdShmPtr taosOpenShm(const char *name, int64_t size);
+void    *taosShmAddr(TdShmPtr pShm);
+int64_t  taosShmSize(TdShmPtr pShm);
+// remove the name of the segment, the mapped memory is still valid until it is closed
+void     taosUnlinkShm(TdShmPtr pShm);
+void     taosCloseShm(TdShmPtr *ppShm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*_TD_OS_SHM_H_*/
@@ -24,8 +24,12 @@
 extern "C" {
 #endif
 
+// a blocked bloom filter keeps all bits of a key in one cache-line-sized block of BF_BLOCK_UNITS units
+#define BF_BLOCK_UNITS 8
+
 typedef struct SBloomFilter {
   uint32_t   hashFunctions;
+  int8_t     blocked;
   uint64_t   expectedEntries;
   uint64_t   numUnits;
   uint64_t   numBits;
@@ -37,8 +41,11 @@ typedef struct SBloomFilter {
 } SBloomFilter;
 
 SBloomFilter *tBloomFilterInit(uint64_t expectedEntries, double errorRate);
+SBloomFilter *tBloomFilterInitBlocked(uint64_t expectedEntries, double errorRate);
 int32_t       tBloomFilterPut(SBloomFilter *pBF, const void *keyBuf, uint32_t len);
+int32_t       tBloomFilterPutHash(SBloomFilter *pBF, uint64_t h1, uint64_t h2);
 int32_t       tBloomFilterNoContain(const SBloomFilter *pBF, const void *keyBuf, uint32_t len);
+int32_t       tBloomFilterNoContainHash(const SBloomFilter *pBF, uint64_t h1, uint64_t h2);
 void          tBloomFilterDestroy(SBloomFilter *pBF);
 void          tBloomFilterDump(const SBloomFilter *pBF);
 bool          tBloomFilterIsFull(const SBloomFilter *pBF);
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_UTIL_HLL_H_
+#define _TD_UTIL_HLL_H_
+
+#include "os.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A HyperLogLog sketch of HLL_SKETCH_REGISTERS one byte registers estimates the number of distinct values added to
+// it with a standard error of about 9%. Sketches built on different nodes are merged register by register.
+#define HLL_SKETCH_BITS      7
+#define HLL_SKETCH_REGISTERS (1 << HLL_SKETCH_BITS)
+
+void    tHllAdd(uint8_t *pRegs, const void *pData, uint32_t len);
+void    tHllAddHash(uint8_t *pRegs, uint64_t hash);
+void    tHllMerge(uint8_t *pDst, const uint8_t *pSrc);
+int64_t tHllCount(const uint8_t *pRegs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*_TD_UTIL_HLL_H_*/
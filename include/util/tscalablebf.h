@@ -26,11 +26,15 @@ typedef struct SScalableBf {
   SArray  *bfArray;  // array of bloom filters
   uint32_t growth;
   uint64_t numBits;
+  int8_t   blocked;
 } SScalableBf;
 
 SScalableBf *tScalableBfInit(uint64_t expectedEntries, double errorRate);
+SScalableBf *tScalableBfInitBlocked(uint64_t expectedEntries, double errorRate);
 int32_t      tScalableBfPut(SScalableBf *pSBf, const void *keyBuf, uint32_t len);
+int32_t      tScalableBfPutHash(SScalableBf *pSBf, uint64_t h1, uint64_t h2);
 int32_t      tScalableBfNoContain(const SScalableBf *pSBf, const void *keyBuf, uint32_t len);
+int32_t      tScalableBfNoContainHash(const SScalableBf *pSBf, uint64_t h1, uint64_t h2);
 void         tScalableBfDestroy(SScalableBf *pSBf);
 int32_t      tScalableBfEncode(const SScalableBf *pSBf, SEncoder *pEncoder);
 SScalableBf *tScalableBfDecode(SDecoder *pDecoder);
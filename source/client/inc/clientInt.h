@@ -30,6 +30,7 @@ extern "C" {
 #include "tdef.h"
 #include "thash.h"
 #include "tlist.h"
+#include "tlrucache.h"
 #include "tmsg.h"
 #include "tmsgtype.h"
 #include "trpc.h"
@@ -122,6 +123,8 @@ struct SAppInstInfo {
   void*              pTransporter;
   SAppHbMgr*         pAppHbMgr;
   char*              instKey;
+  SLRUCache*         pPlanCache;        // normalized sql -> SPlanCacheEntry, NULL if disabled
+  int64_t            planCacheAuthVer;  // increased on each user privilege update pushed by the hb
 };
 
 typedef struct SAppInfo {
@@ -251,6 +254,10 @@ typedef struct SRequestObj {
   uint32_t             retry;
   int64_t              allocatorRefId;
   SQuery*              pQuery;
+  char*                planCacheKey;  // set only if the plan of this request can be cached
+  int32_t              planCacheKeyLen;
+  int64_t              planCacheAuthVer;  // privilege version of the app inst when the key was built
+  SQueryPlan*          pCachedPlan;  // plan restored from the plan cache, consumed by getPlan
 } SRequestObj;
 
 typedef struct SSyncQueryParam {
@@ -279,6 +286,15 @@ void taosAsyncQueryImplWithReqid(uint64_t connId, const char* sql, __taos_async_
 
 int32_t getVersion1BlockMetaSize(const char* p, int32_t numOfCols);
 
+int32_t clientPlanCacheInit(SAppInstInfo* pAppInfo);
+void    clientPlanCacheCleanup(SAppInstInfo* pAppInfo);
+bool    clientIsPlanCacheable(SQuery* pQuery);
+int32_t clientBuildPlanCacheKey(SRequestObj* pRequest, SArray* pPlaceholderValues);
+bool    clientGetCachedPlan(SRequestObj* pRequest, SQueryPlan** ppPlan);
+int32_t clientPutCachedPlan(SRequestObj* pRequest, SQueryPlan* pPlan);
+void    clientClearPlanCacheKey(SRequestObj* pRequest);
+void    clientPlanCacheOnAuthUpdate(SAppInstInfo* pAppInfo);
+
 static FORCE_INLINE SReqResultInfo* tmqGetCurResInfo(TAOS_RES* res) {
   SMqRspObj* msg = (SMqRspObj*)res;
   return (SReqResultInfo*)&msg->resInfo;
@@ -390,6 +406,7 @@ typedef struct SSqlCallbackWrapper {
 SRequestObj* launchQueryImpl(SRequestObj* pRequest, SQuery* pQuery, bool keepQuery, void** res);
 int32_t      scheduleQuery(SRequestObj* pRequest, SQueryPlan* pDag, SArray* pNodeList);
 void    launchAsyncQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaData* pResultMeta, SSqlCallbackWrapper* pWrapper);
+int32_t launchAsyncCachedPlan(SRequestObj* pRequest, SQueryPlan* pDag, SSqlCallbackWrapper* pWrapper);
 int32_t refreshMeta(STscObj* pTscObj, SRequestObj* pRequest);
 int32_t updateQnodeList(SAppInstInfo* pInfo, SArray* pNodeList);
 void    doAsyncQuery(SRequestObj* pRequest, bool forceUpdateMeta);
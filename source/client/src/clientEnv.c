@@ -203,6 +203,7 @@ void destroyAppInst(SAppInstInfo *pAppInfo) {
 
   taosMemoryFreeClear(pAppInfo->instKey);
   closeTransporter(pAppInfo);
+  clientPlanCacheCleanup(pAppInfo);
 
   taosThreadMutexLock(&pAppInfo->qnodeMutex);
   taosArrayDestroy(pAppInfo->pQnodeList);
@@ -359,6 +360,8 @@ void doDestroyRequest(void *p) {
   taosArrayDestroy(pRequest->dbList);
   taosArrayDestroy(pRequest->targetTableList);
   qDestroyQuery(pRequest->pQuery);
+  qDestroyQueryPlan(pRequest->pCachedPlan);
+  taosMemoryFreeClear(pRequest->planCacheKey);
   nodesDestroyAllocator(pRequest->allocatorRefId);
 
   destroyQueryExecRes(&pRequest->body.resInfo.execRes);
@@ -228,6 +228,7 @@ static int32_t hbQueryHbRspHandle(SAppHbMgr *pAppHbMgr, SClientHbRsp *pRsp) {
         }
 
         hbProcessUserAuthInfoRsp(kv->value, kv->valueLen, pCatalog);
+        clientPlanCacheOnAuthUpdate(pAppHbMgr->pAppInstInfo);
         break;
       }
       case HEARTBEAT_KEY_DBINFO: {
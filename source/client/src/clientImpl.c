@@ -133,7 +133,7 @@ STscObj* taos_connect_internal(const char* ip, const char* user, const char* pas
     taosThreadMutexInit(&p->qnodeMutex, NULL);
     p->pTransporter = openTransporter(user, secretEncrypt, tsNumOfCores / 2);
     p->pAppHbMgr = appHbMgrInit(p, key);
-    if (NULL == p->pAppHbMgr) {
+    if (NULL == p->pAppHbMgr || TSDB_CODE_SUCCESS != clientPlanCacheInit(p)) {
       destroyAppInst(p);
       taosThreadMutexUnlock(&appInfo.mutex);
       taosMemoryFreeClear(key);
@@ -443,7 +443,17 @@ int32_t getPlan(SRequestObj* pRequest, SQuery* pQuery, SQueryPlan** pPlan, SArra
                       .pUser = pRequest->pTscObj->user,
                       .sysInfo = pRequest->pTscObj->sysInfo};
 
-  return qCreateQueryPlan(&cxt, pPlan, pNodeList);
+  if (NULL != pRequest->pCachedPlan) {
+    *pPlan = pRequest->pCachedPlan;
+    pRequest->pCachedPlan = NULL;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t code = qCreateQueryPlan(&cxt, pPlan, pNodeList);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = clientPutCachedPlan(pRequest, *pPlan);
+  }
+  return code;
 }
 
 void setResSchemaInfo(SReqResultInfo* pResInfo, const SSchema* pSchema, int32_t numOfCols) {
@@ -1023,6 +1033,48 @@ SRequestObj* launchQueryImpl(SRequestObj* pRequest, SQuery* pQuery, bool keepQue
   return pRequest;
 }
 
+static int32_t asyncSchedulePlan(SRequestObj* pRequest, SQueryPlan* pDag, SArray* pNodeList,
+                                 SSqlCallbackWrapper* pWrapper) {
+  SRequestConnInfo conn = {.pTrans = getAppInfo(pRequest)->pTransporter,
+                           .requestId = pRequest->requestId,
+                           .requestObjRefId = pRequest->self};
+  SSchedulerReq    req = {
+         .syncReq = false,
+         .localReq = (tsQueryPolicy == QUERY_POLICY_CLIENT),
+         .pConn = &conn,
+         .pNodeList = pNodeList,
+         .pDag = pDag,
+         .allocatorRefId = pRequest->allocatorRefId,
+         .sql = pRequest->sqlstr,
+         .startTs = pRequest->metric.start,
+         .execFp = schedulerExecCb,
+         .cbParam = pWrapper,
+         .chkKillFp = chkRequestKilled,
+         .chkKillParam = (void*)pRequest->self,
+         .pExecRes = NULL,
+  };
+  return schedulerExecJob(&req, &pRequest->body.queryJob);
+}
+
+int32_t launchAsyncCachedPlan(SRequestObj* pRequest, SQueryPlan* pDag, SSqlCallbackWrapper* pWrapper) {
+  pRequest->body.execMode = QUERY_EXEC_MODE_SCHEDULE;
+  pRequest->body.subplanNum = pDag->numOfSubplans;
+  pRequest->metric.planEnd = taosGetTimestampUs();
+
+  SArray* pNodeList = NULL;
+  int32_t code = buildSyncExecNodeList(pRequest, &pNodeList, NULL);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = asyncSchedulePlan(pRequest, pDag, pNodeList, pWrapper);
+  } else {
+    qDestroyQueryPlan(pDag);
+    destorySqlCallbackWrapper(pWrapper);
+    pRequest->code = code;
+    pRequest->body.queryFp(pRequest->body.param, pRequest, code);
+  }
+  taosArrayDestroy(pNodeList);
+  return code;
+}
+
 static int32_t asyncExecSchQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaData* pResultMeta,
                                  SSqlCallbackWrapper* pWrapper) {
   pRequest->type = pQuery->msgType;
@@ -1056,6 +1108,7 @@ static int32_t asyncExecSchQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaDat
   if (code == TSDB_CODE_SUCCESS) {
     tscDebug("0x%" PRIx64 " create query plan success, elapsed time:%.2f ms, 0x%" PRIx64, pRequest->self,
              (pRequest->metric.planEnd - st) / 1000.0, pRequest->requestId);
+    code = clientPutCachedPlan(pRequest, pDag);
   }
   if (TSDB_CODE_SUCCESS == code && !pRequest->validateOnly) {
     SArray* pNodeList = NULL;
@@ -1063,25 +1116,7 @@ static int32_t asyncExecSchQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaDat
       buildAsyncExecNodeList(pRequest, &pNodeList, pMnodeList, pResultMeta);
     }
 
-    SRequestConnInfo conn = {.pTrans = getAppInfo(pRequest)->pTransporter,
-                             .requestId = pRequest->requestId,
-                             .requestObjRefId = pRequest->self};
-    SSchedulerReq    req = {
-           .syncReq = false,
-           .localReq = (tsQueryPolicy == QUERY_POLICY_CLIENT),
-           .pConn = &conn,
-           .pNodeList = pNodeList,
-           .pDag = pDag,
-           .allocatorRefId = pRequest->allocatorRefId,
-           .sql = pRequest->sqlstr,
-           .startTs = pRequest->metric.start,
-           .execFp = schedulerExecCb,
-           .cbParam = pWrapper,
-           .chkKillFp = chkRequestKilled,
-           .chkKillParam = (void*)pRequest->self,
-           .pExecRes = NULL,
-    };
-    code = schedulerExecJob(&req, &pRequest->body.queryJob);
+    code = asyncSchedulePlan(pRequest, pDag, pNodeList, pWrapper);
     taosArrayDestroy(pNodeList);
   } else {
     tscDebug("0x%" PRIx64 " plan not executed, code:%s 0x%" PRIx64, pRequest->self, tstrerror(code),
@@ -908,6 +908,18 @@ void doAsyncQuery(SRequestObj *pRequest, bool updateMetaForce) {
     code = catalogGetHandle(pTscObj->pAppInfo->clusterId, &pWrapper->pParseCtx->pCatalog);
   }
 
+  if (TSDB_CODE_SUCCESS == code) {
+    code = clientBuildPlanCacheKey(pRequest, NULL);
+  }
+
+  SQueryPlan *pCachedPlan = NULL;
+  if (TSDB_CODE_SUCCESS == code && !updateMetaForce && clientGetCachedPlan(pRequest, &pCachedPlan)) {
+    SAppClusterSummary *pActivity = &pTscObj->pAppInfo->summary;
+    atomic_add_fetch_64((int64_t *)&pActivity->numOfQueryReq, 1);
+    launchAsyncCachedPlan(pRequest, pCachedPlan, pWrapper);
+    return;
+  }
+
   if (TSDB_CODE_SUCCESS == code) {
     pRequest->metric.syntaxStart = taosGetTimestampUs();
 
@@ -923,6 +935,10 @@ void doAsyncQuery(SRequestObj *pRequest, bool updateMetaForce) {
     pRequest->metric.syntaxEnd = taosGetTimestampUs();
   }
 
+  if (TSDB_CODE_SUCCESS == code && !clientIsPlanCacheable(pRequest->pQuery)) {
+    clientClearPlanCacheKey(pRequest);
+  }
+
   if (TSDB_CODE_SUCCESS == code && !updateMetaForce) {
     SAppClusterSummary *pActivity = &pTscObj->pAppInfo->summary;
     if (QUERY_NODE_INSERT_STMT == nodeType(pRequest->pQuery->pRoot)) {
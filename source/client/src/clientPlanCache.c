@@ -0,0 +1,636 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "clientInt.h"
+#include "clientLog.h"
+#include "functionMgt.h"
+#include "systable.h"
+#include "tglobal.h"
+
+/*
+ * Client side cache of physical plans.
+ *
+ * The key is built from the user, the current db, the sql text normalized outside of quotes and, for stmt queries,
+ * the bound parameter types and values. Literals are part of the key since the planner folds them into scan time
+ * ranges and vgroup pruning, so a plan can not be reused with other literal values.
+ *
+ * Every entry remembers the id and vgroup version of each db and the uid, suid and schema/tag version of each table it
+ * was built from. A lookup only hits if all of them still match the local catalog cache, so any catalog update, and a
+ * db or table dropped and created again with the same name, invalidates the plan.
+ *
+ * Privileges are checked by the parser down to table and tag filter level, which a cached plan skips. So every entry
+ * also remembers the privilege version of the app inst, which is increased whenever the hb pushes a user privilege
+ * update, and an entry built before the latest update is never reused.
+ */
+
+typedef struct SPlanCacheDbVer {
+  char    dbFName[TSDB_DB_FNAME_LEN];
+  int64_t dbId;  // a db dropped and created again with the same name has another id
+  int32_t vgVersion;
+} SPlanCacheDbVer;
+
+typedef struct SPlanCacheTbVer {
+  SName    name;
+  uint64_t uid;  // as is the uid of a table dropped and created again
+  uint64_t suid;
+  int32_t  sversion;
+  int32_t  tversion;
+} SPlanCacheTbVer;
+
+typedef struct SPlanCacheLink {
+  int32_t level;
+  int32_t index;
+  int32_t parentLevel;
+  int32_t parentIndex;
+} SPlanCacheLink;
+
+typedef struct SPlanCacheEntry {
+  char*       pPlan;  // json string of SQueryPlan, the subplan parent/child links are kept in pLinks
+  int32_t     planLen;
+  int32_t     msgType;
+  int32_t     stmtType;
+  bool        stableQuery;
+  uint32_t    numOfCols;
+  int32_t     precision;
+  TAOS_FIELD* fields;
+  TAOS_FIELD* userFields;
+  int64_t     authVer;     // SAppInstInfo::planCacheAuthVer when the plan was built
+  SArray*     pLinks;      // SArray<SPlanCacheLink>
+  SArray*     pDbVers;     // SArray<SPlanCacheDbVer>
+  SArray*     pTbVers;     // SArray<SPlanCacheTbVer>
+  SArray*     pDbList;     // same as SRequestObj::dbList
+  SArray*     pTableList;  // same as SRequestObj::tableList
+} SPlanCacheEntry;
+
+typedef struct SPlanCacheableCxt {
+  bool cacheable;
+} SPlanCacheableCxt;
+
+static void destroyPlanCacheEntry(SPlanCacheEntry* pEntry) {
+  if (NULL == pEntry) {
+    return;
+  }
+  taosMemoryFree(pEntry->pPlan);
+  taosMemoryFree(pEntry->fields);
+  taosMemoryFree(pEntry->userFields);
+  taosArrayDestroy(pEntry->pLinks);
+  taosArrayDestroy(pEntry->pDbVers);
+  taosArrayDestroy(pEntry->pTbVers);
+  taosArrayDestroy(pEntry->pDbList);
+  taosArrayDestroy(pEntry->pTableList);
+  taosMemoryFree(pEntry);
+}
+
+static void planCacheEntryDeleter(const void* key, size_t keyLen, void* value) {
+  destroyPlanCacheEntry((SPlanCacheEntry*)value);
+}
+
+int32_t clientPlanCacheInit(SAppInstInfo* pAppInfo) {
+  if (tsQueryPlanCacheSize <= 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  pAppInfo->pPlanCache = taosLRUCacheInit((size_t)tsQueryPlanCacheSize * 1024 * 1024, -1, .5);
+  if (NULL == pAppInfo->pPlanCache) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  taosLRUCacheSetStrictCapacity(pAppInfo->pPlanCache, false);
+
+  tscDebug("plan cache of app inst %p created, size:%dMB", pAppInfo, tsQueryPlanCacheSize);
+  return TSDB_CODE_SUCCESS;
+}
+
+void clientPlanCacheOnAuthUpdate(SAppInstInfo* pAppInfo) {
+  int64_t authVer = atomic_add_fetch_64(&pAppInfo->planCacheAuthVer, 1);
+  tscDebug("user privileges of app inst %p updated, plan cache auth version:%" PRId64, pAppInfo, authVer);
+}
+
+void clientPlanCacheCleanup(SAppInstInfo* pAppInfo) {
+  if (NULL == pAppInfo->pPlanCache) {
+    return;
+  }
+
+  taosLRUCacheEraseUnrefEntries(pAppInfo->pPlanCache);
+  taosLRUCacheCleanup(pAppInfo->pPlanCache);
+  pAppInfo->pPlanCache = NULL;
+}
+
+static bool isVolatileFunc(const char* pFuncName) {
+  switch (fmGetFuncType(pFuncName)) {
+    case FUNCTION_TYPE_NOW:
+    case FUNCTION_TYPE_TODAY:
+    case FUNCTION_TYPE_TIMEZONE:
+    case FUNCTION_TYPE_DATABASE:
+    case FUNCTION_TYPE_CLIENT_VERSION:
+    case FUNCTION_TYPE_SERVER_VERSION:
+    case FUNCTION_TYPE_SERVER_STATUS:
+    case FUNCTION_TYPE_CURRENT_USER:
+    case FUNCTION_TYPE_USER:
+    case FUNCTION_TYPE_UDF:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
+static void checkStmtPlanCacheable(SNode* pStmt, SPlanCacheableCxt* pCxt);
+
+static EDealRes checkPlanCacheableImpl(SNode* pNode, void* pContext) {
+  SPlanCacheableCxt* pCxt = (SPlanCacheableCxt*)pContext;
+  switch (nodeType(pNode)) {
+    case QUERY_NODE_FUNCTION:
+      if (isVolatileFunc(((SFunctionNode*)pNode)->functionName)) {
+        pCxt->cacheable = false;
+      }
+      break;
+    case QUERY_NODE_TEMP_TABLE:
+      checkStmtPlanCacheable(((STempTableNode*)pNode)->pSubquery, pCxt);
+      break;
+    default:
+      break;
+  }
+  return pCxt->cacheable ? DEAL_RES_CONTINUE : DEAL_RES_END;
+}
+
+static void checkStmtPlanCacheable(SNode* pStmt, SPlanCacheableCxt* pCxt) {
+  if (!pCxt->cacheable) {
+    return;
+  }
+
+  switch (nodeType(pStmt)) {
+    case QUERY_NODE_SELECT_STMT:
+      nodesWalkSelectStmt((SSelectStmt*)pStmt, SQL_CLAUSE_FROM, checkPlanCacheableImpl, pCxt);
+      break;
+    case QUERY_NODE_SET_OPERATOR: {
+      SSetOperator* pSetOp = (SSetOperator*)pStmt;
+      checkStmtPlanCacheable(pSetOp->pLeft, pCxt);
+      checkStmtPlanCacheable(pSetOp->pRight, pCxt);
+      nodesWalkExprs(pSetOp->pOrderByList, checkPlanCacheableImpl, pCxt);
+      break;
+    }
+    default:
+      pCxt->cacheable = false;
+      break;
+  }
+}
+
+// must be called before the semantic analysis, which folds the volatile functions into constants
+bool clientIsPlanCacheable(SQuery* pQuery) {
+  if (NULL == pQuery || NULL == pQuery->pRoot) {
+    return false;
+  }
+
+  SPlanCacheableCxt cxt = {.cacheable = true};
+  checkStmtPlanCacheable(pQuery->pRoot, &cxt);
+  return cxt.cacheable;
+}
+
+static int32_t normalizeSql(const char* pSql, int32_t sqlLen, char* pBuf) {
+  int32_t len = 0;
+  char    quote = 0;
+  bool    space = false;
+
+  for (int32_t i = 0; i < sqlLen; ++i) {
+    char c = pSql[i];
+    if (0 != quote) {
+      pBuf[len++] = c;
+      if (c == quote) {
+        quote = 0;
+      } else if ('\\' == c && i + 1 < sqlLen) {
+        pBuf[len++] = pSql[++i];
+      }
+      continue;
+    }
+
+    if ('\'' == c || '"' == c || '`' == c) {
+      quote = c;
+    } else if (isspace((unsigned char)c)) {
+      space = true;
+      continue;
+    }
+
+    if (space && len > 0) {
+      pBuf[len++] = ' ';
+    }
+    space = false;
+    pBuf[len++] = (0 != quote) ? c : tolower((unsigned char)c);
+  }
+
+  while (len > 0 && ';' == pBuf[len - 1]) {
+    --len;
+  }
+  return len;
+}
+
+static int32_t placeholderValueLen(const SValueNode* pVal) {
+  if (TSDB_DATA_TYPE_NULL == pVal->node.resType.type) {
+    return 0;
+  } else if (IS_VAR_DATA_TYPE(pVal->node.resType.type)) {
+    return varDataTLen(pVal->datum.p);
+  } else if (TSDB_DATA_TYPE_BOOL == pVal->node.resType.type) {
+    return sizeof(bool);
+  }
+  return sizeof(int64_t);
+}
+
+static char* placeholderValuePos(const SValueNode* pVal) {
+  if (IS_VAR_DATA_TYPE(pVal->node.resType.type)) {
+    return pVal->datum.p;
+  } else if (TSDB_DATA_TYPE_BOOL == pVal->node.resType.type) {
+    return (char*)&pVal->datum.b;
+  }
+  return (char*)&pVal->datum.i;
+}
+
+int32_t clientBuildPlanCacheKey(SRequestObj* pRequest, SArray* pPlaceholderValues) {
+  clientClearPlanCacheKey(pRequest);
+
+  if (NULL == pRequest->pTscObj->pAppInfo->pPlanCache || pRequest->validateOnly || NULL == pRequest->sqlstr ||
+      qIsInsertValuesSql(pRequest->sqlstr, pRequest->sqlLen)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  const char* pDb = (NULL != pRequest->pDb) ? pRequest->pDb : "";
+  int32_t     userLen = strlen(pRequest->pTscObj->user);
+  int32_t     dbLen = strlen(pDb);
+  int32_t     paramNum = taosArrayGetSize(pPlaceholderValues);
+  int32_t     keyLen = userLen + 1 + dbLen + 1 + pRequest->sqlLen + 1;
+  for (int32_t i = 0; i < paramNum; ++i) {
+    keyLen += sizeof(int8_t) + sizeof(int32_t) + placeholderValueLen(taosArrayGetP(pPlaceholderValues, i));
+  }
+
+  char* pKey = taosMemoryMalloc(keyLen);
+  if (NULL == pKey) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  int32_t len = 0;
+  memcpy(pKey + len, pRequest->pTscObj->user, userLen + 1);
+  len += userLen + 1;
+  memcpy(pKey + len, pDb, dbLen + 1);
+  len += dbLen + 1;
+  len += normalizeSql(pRequest->sqlstr, pRequest->sqlLen, pKey + len);
+  pKey[len++] = 0;
+
+  for (int32_t i = 0; i < paramNum; ++i) {
+    SValueNode* pVal = taosArrayGetP(pPlaceholderValues, i);
+    int32_t     valLen = placeholderValueLen(pVal);
+    pKey[len++] = (char)pVal->node.resType.type;
+    memcpy(pKey + len, &valLen, sizeof(valLen));
+    len += sizeof(valLen);
+    if (valLen > 0) {
+      memcpy(pKey + len, placeholderValuePos(pVal), valLen);
+      len += valLen;
+    }
+  }
+
+  pRequest->planCacheKey = pKey;
+  pRequest->planCacheKeyLen = len;
+  // taken before the parser checks the privileges, so an update that arrives during planning expires the new entry
+  pRequest->planCacheAuthVer = atomic_load_64(&pRequest->pTscObj->pAppInfo->planCacheAuthVer);
+  return TSDB_CODE_SUCCESS;
+}
+
+void clientClearPlanCacheKey(SRequestObj* pRequest) {
+  taosMemoryFreeClear(pRequest->planCacheKey);
+  pRequest->planCacheKeyLen = 0;
+}
+
+static bool isPlanCacheEntryValid(SRequestObj* pRequest, SCatalog* pCatalog, SPlanCacheEntry* pEntry) {
+  if (pEntry->authVer != atomic_load_64(&pRequest->pTscObj->pAppInfo->planCacheAuthVer)) {
+    return false;
+  }
+
+  int32_t dbNum = taosArrayGetSize(pEntry->pDbVers);
+  for (int32_t i = 0; i < dbNum; ++i) {
+    SPlanCacheDbVer* pDbVer = taosArrayGet(pEntry->pDbVers, i);
+    int32_t          vgVersion = 0;
+    int64_t          dbId = 0;
+    int32_t          tableNum = 0;
+    int64_t          stateTs = 0;
+    if (TSDB_CODE_SUCCESS !=
+            catalogGetDBVgVersion(pCatalog, pDbVer->dbFName, &vgVersion, &dbId, &tableNum, &stateTs) ||
+        vgVersion != pDbVer->vgVersion || dbId != pDbVer->dbId) {
+      return false;
+    }
+
+    bool pass = false;
+    bool exists = false;
+    if (TSDB_CODE_SUCCESS !=
+            catalogChkAuthFromCache(pCatalog, pRequest->pTscObj->user, pDbVer->dbFName, AUTH_TYPE_READ, &pass, &exists) ||
+        !exists || !pass) {
+      return false;
+    }
+  }
+
+  int32_t tbNum = taosArrayGetSize(pEntry->pTbVers);
+  for (int32_t i = 0; i < tbNum; ++i) {
+    SPlanCacheTbVer* pTbVer = taosArrayGet(pEntry->pTbVers, i);
+    STableMeta*      pMeta = NULL;
+    if (TSDB_CODE_SUCCESS != catalogGetCachedTableMeta(pCatalog, &pTbVer->name, &pMeta) || NULL == pMeta) {
+      return false;
+    }
+    bool same = (pMeta->uid == pTbVer->uid && pMeta->suid == pTbVer->suid && pMeta->sversion == pTbVer->sversion &&
+                 pMeta->tversion == pTbVer->tversion);
+    taosMemoryFree(pMeta);
+    if (!same) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static SSubplan* getSubplanByPos(SQueryPlan* pPlan, int32_t level, int32_t index) {
+  SNodeListNode* pGroup = (SNodeListNode*)nodesListGetNode(pPlan->pSubplans, level);
+  if (NULL == pGroup) {
+    return NULL;
+  }
+  return (SSubplan*)nodesListGetNode(pGroup->pNodeList, index);
+}
+
+static int32_t restorePlanFromEntry(SRequestObj* pRequest, SPlanCacheEntry* pEntry, SQueryPlan** ppPlan) {
+  SQueryPlan* pPlan = qStringToQueryPlan(pEntry->pPlan);
+  if (NULL == pPlan) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  int32_t linkNum = taosArrayGetSize(pEntry->pLinks);
+  for (int32_t i = 0; TSDB_CODE_SUCCESS == code && i < linkNum; ++i) {
+    SPlanCacheLink* pLink = taosArrayGet(pEntry->pLinks, i);
+    SSubplan*       pSubplan = getSubplanByPos(pPlan, pLink->level, pLink->index);
+    SSubplan*       pParent = getSubplanByPos(pPlan, pLink->parentLevel, pLink->parentIndex);
+    if (NULL == pSubplan || NULL == pParent) {
+      code = TSDB_CODE_APP_ERROR;
+      break;
+    }
+    code = nodesListMakeAppend(&pParent->pChildren, (SNode*)pSubplan);
+    if (TSDB_CODE_SUCCESS == code) {
+      code = nodesListMakeAppend(&pSubplan->pParents, (SNode*)pParent);
+    }
+  }
+
+  if (TSDB_CODE_SUCCESS != code) {
+    qDestroyQueryPlan(pPlan);
+    return code;
+  }
+
+  pPlan->queryId = pRequest->requestId;
+  SNode* pGroup = NULL;
+  FOREACH(pGroup, pPlan->pSubplans) {
+    SNode* pSubplan = NULL;
+    FOREACH(pSubplan, ((SNodeListNode*)pGroup)->pNodeList) { ((SSubplan*)pSubplan)->id.queryId = pRequest->requestId; }
+  }
+
+  *ppPlan = pPlan;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t restoreRequestFromEntry(SRequestObj* pRequest, SPlanCacheEntry* pEntry) {
+  SReqResultInfo* pResInfo = &pRequest->body.resInfo;
+  if (pEntry->numOfCols > 0) {
+    int32_t size = pEntry->numOfCols * sizeof(TAOS_FIELD);
+    taosMemoryFree(pResInfo->fields);
+    taosMemoryFree(pResInfo->userFields);
+    pResInfo->fields = taosMemoryMalloc(size);
+    pResInfo->userFields = taosMemoryMalloc(size);
+    if (NULL == pResInfo->fields || NULL == pResInfo->userFields) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+    memcpy(pResInfo->fields, pEntry->fields, size);
+    memcpy(pResInfo->userFields, pEntry->userFields, size);
+  }
+  pResInfo->numOfCols = pEntry->numOfCols;
+  pResInfo->precision = pEntry->precision;
+
+  taosArrayDestroy(pRequest->dbList);
+  taosArrayDestroy(pRequest->tableList);
+  pRequest->dbList = taosArrayDup(pEntry->pDbList, NULL);
+  pRequest->tableList = taosArrayDup(pEntry->pTableList, NULL);
+  if ((NULL != pEntry->pDbList && NULL == pRequest->dbList) ||
+      (NULL != pEntry->pTableList && NULL == pRequest->tableList)) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pRequest->type = pEntry->msgType;
+  pRequest->stmtType = pEntry->stmtType;
+  pRequest->stableQuery = pEntry->stableQuery;
+  return TSDB_CODE_SUCCESS;
+}
+
+bool clientGetCachedPlan(SRequestObj* pRequest, SQueryPlan** ppPlan) {
+  SLRUCache* pCache = pRequest->pTscObj->pAppInfo->pPlanCache;
+  if (NULL == pCache || NULL == pRequest->planCacheKey) {
+    return false;
+  }
+
+  SCatalog* pCatalog = NULL;
+  if (TSDB_CODE_SUCCESS != catalogGetHandle(pRequest->pTscObj->pAppInfo->clusterId, &pCatalog)) {
+    return false;
+  }
+
+  LRUHandle* h = taosLRUCacheLookup(pCache, pRequest->planCacheKey, pRequest->planCacheKeyLen);
+  if (NULL == h) {
+    tscDebug("0x%" PRIx64 " plan cache miss, reqId:0x%" PRIx64, pRequest->self, pRequest->requestId);
+    return false;
+  }
+
+  SPlanCacheEntry* pEntry = taosLRUCacheValue(pCache, h);
+  if (!isPlanCacheEntryValid(pRequest, pCatalog, pEntry)) {
+    taosLRUCacheRelease(pCache, h, true);
+    taosLRUCacheErase(pCache, pRequest->planCacheKey, pRequest->planCacheKeyLen);
+    tscDebug("0x%" PRIx64 " cached plan is expired, reqId:0x%" PRIx64, pRequest->self, pRequest->requestId);
+    return false;
+  }
+
+  int32_t code = restoreRequestFromEntry(pRequest, pEntry);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = restorePlanFromEntry(pRequest, pEntry, ppPlan);
+  }
+  taosLRUCacheRelease(pCache, h, false);
+
+  if (TSDB_CODE_SUCCESS != code) {
+    tscWarn("0x%" PRIx64 " failed to restore cached plan, code:%s, reqId:0x%" PRIx64, pRequest->self, tstrerror(code),
+            pRequest->requestId);
+    return false;
+  }
+
+  tscDebug("0x%" PRIx64 " plan cache hit, reqId:0x%" PRIx64, pRequest->self, pRequest->requestId);
+  return true;
+}
+
+static int32_t buildPlanLinks(SQueryPlan* pPlan, SArray* pLinks) {
+  int32_t levelNum = LIST_LENGTH(pPlan->pSubplans);
+  for (int32_t level = 0; level < levelNum; ++level) {
+    SNodeListNode* pGroup = (SNodeListNode*)nodesListGetNode(pPlan->pSubplans, level);
+    int32_t        index = 0;
+    SNode*         pNode = NULL;
+    FOREACH(pNode, pGroup->pNodeList) {
+      SSubplan* pSubplan = (SSubplan*)pNode;
+      SNode*    pParent = NULL;
+      FOREACH(pParent, pSubplan->pParents) {
+        SPlanCacheLink link = {.level = level, .index = index, .parentLevel = -1, .parentIndex = -1};
+        for (int32_t parentLevel = 0; parentLevel < level && link.parentLevel < 0; ++parentLevel) {
+          SNodeListNode* pParentGroup = (SNodeListNode*)nodesListGetNode(pPlan->pSubplans, parentLevel);
+          int32_t        parentIndex = 0;
+          SNode*         pCandidate = NULL;
+          FOREACH(pCandidate, pParentGroup->pNodeList) {
+            if (pCandidate == pParent) {
+              link.parentLevel = parentLevel;
+              link.parentIndex = parentIndex;
+              break;
+            }
+            ++parentIndex;
+          }
+        }
+        if (link.parentLevel < 0 || NULL == taosArrayPush(pLinks, &link)) {
+          return TSDB_CODE_APP_ERROR;
+        }
+      }
+      ++index;
+    }
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t buildPlanVersions(SRequestObj* pRequest, SCatalog* pCatalog, SPlanCacheEntry* pEntry) {
+  int32_t dbNum = taosArrayGetSize(pRequest->dbList);
+  int32_t tbNum = taosArrayGetSize(pRequest->tableList);
+
+  pEntry->pDbVers = taosArrayInit(TMAX(dbNum, 1), sizeof(SPlanCacheDbVer));
+  pEntry->pTbVers = taosArrayInit(TMAX(tbNum, 1), sizeof(SPlanCacheTbVer));
+  if (NULL == pEntry->pDbVers || NULL == pEntry->pTbVers) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < dbNum; ++i) {
+    char* dbFName = taosArrayGet(pRequest->dbList, i);
+    if (IS_SYS_DBNAME(strchr(dbFName, '.') ? strchr(dbFName, '.') + 1 : dbFName)) {
+      return TSDB_CODE_FAILED;
+    }
+
+    SPlanCacheDbVer dbVer = {0};
+    int32_t         tableNum = 0;
+    int64_t         stateTs = 0;
+    tstrncpy(dbVer.dbFName, dbFName, sizeof(dbVer.dbFName));
+    int32_t code = catalogGetDBVgVersion(pCatalog, dbFName, &dbVer.vgVersion, &dbVer.dbId, &tableNum, &stateTs);
+    if (TSDB_CODE_SUCCESS != code) {
+      return code;
+    }
+    if (dbVer.vgVersion < 0) {
+      return TSDB_CODE_FAILED;
+    }
+    taosArrayPush(pEntry->pDbVers, &dbVer);
+  }
+
+  for (int32_t i = 0; i < tbNum; ++i) {
+    SPlanCacheTbVer tbVer = {.name = *(SName*)taosArrayGet(pRequest->tableList, i)};
+    STableMeta*     pMeta = NULL;
+    int32_t         code = catalogGetCachedTableMeta(pCatalog, &tbVer.name, &pMeta);
+    if (TSDB_CODE_SUCCESS != code || NULL == pMeta) {
+      return TSDB_CODE_SUCCESS == code ? TSDB_CODE_FAILED : code;
+    }
+    tbVer.uid = pMeta->uid;
+    tbVer.suid = pMeta->suid;
+    tbVer.sversion = pMeta->sversion;
+    tbVer.tversion = pMeta->tversion;
+    taosMemoryFree(pMeta);
+    taosArrayPush(pEntry->pTbVers, &tbVer);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t buildPlanCacheEntry(SRequestObj* pRequest, SCatalog* pCatalog, SQueryPlan* pPlan,
+                                   SPlanCacheEntry** ppEntry) {
+  SPlanCacheEntry* pEntry = taosMemoryCalloc(1, sizeof(SPlanCacheEntry));
+  if (NULL == pEntry) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  int32_t code = buildPlanVersions(pRequest, pCatalog, pEntry);
+  if (TSDB_CODE_SUCCESS == code) {
+    pEntry->pLinks = taosArrayInit(pPlan->numOfSubplans, sizeof(SPlanCacheLink));
+    code = (NULL == pEntry->pLinks) ? TSDB_CODE_OUT_OF_MEMORY : buildPlanLinks(pPlan, pEntry->pLinks);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = nodesNodeToString((SNode*)pPlan, false, &pEntry->pPlan, &pEntry->planLen);
+  }
+
+  SReqResultInfo* pResInfo = &pRequest->body.resInfo;
+  if (TSDB_CODE_SUCCESS == code && pResInfo->numOfCols > 0) {
+    int32_t size = pResInfo->numOfCols * sizeof(TAOS_FIELD);
+    pEntry->fields = taosMemoryMalloc(size);
+    pEntry->userFields = taosMemoryMalloc(size);
+    if (NULL == pEntry->fields || NULL == pEntry->userFields) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    } else {
+      memcpy(pEntry->fields, pResInfo->fields, size);
+      memcpy(pEntry->userFields, pResInfo->userFields, size);
+    }
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    pEntry->numOfCols = pResInfo->numOfCols;
+    pEntry->precision = pResInfo->precision;
+    pEntry->authVer = pRequest->planCacheAuthVer;
+    pEntry->msgType = pRequest->type;
+    pEntry->stmtType = pRequest->stmtType;
+    pEntry->stableQuery = pRequest->stableQuery;
+    pEntry->pDbList = taosArrayDup(pRequest->dbList, NULL);
+    pEntry->pTableList = taosArrayDup(pRequest->tableList, NULL);
+  }
+
+  if (TSDB_CODE_SUCCESS != code) {
+    destroyPlanCacheEntry(pEntry);
+    return code;
+  }
+
+  *ppEntry = pEntry;
+  return TSDB_CODE_SUCCESS;
+}
+
+// must be called before the plan is handed over to the scheduler, which binds the execution nodes into it
+int32_t clientPutCachedPlan(SRequestObj* pRequest, SQueryPlan* pPlan) {
+  SLRUCache* pCache = pRequest->pTscObj->pAppInfo->pPlanCache;
+  if (NULL == pCache || NULL == pRequest->planCacheKey || pPlan->explainInfo.mode != EXPLAIN_MODE_DISABLE) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SCatalog* pCatalog = NULL;
+  int32_t   code = catalogGetHandle(pRequest->pTscObj->pAppInfo->clusterId, &pCatalog);
+  if (TSDB_CODE_SUCCESS != code) {
+    return code;
+  }
+
+  SPlanCacheEntry* pEntry = NULL;
+  code = buildPlanCacheEntry(pRequest, pCatalog, pPlan, &pEntry);
+  if (TSDB_CODE_SUCCESS != code) {
+    tscDebug("0x%" PRIx64 " plan not cached, code:%s, reqId:0x%" PRIx64, pRequest->self, tstrerror(code),
+             pRequest->requestId);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  size_t    charge = pRequest->planCacheKeyLen + pEntry->planLen + sizeof(SPlanCacheEntry);
+  LRUStatus status = taosLRUCacheInsert(pCache, pRequest->planCacheKey, pRequest->planCacheKeyLen, pEntry, charge,
+                                        planCacheEntryDeleter, NULL, TAOS_LRU_PRIORITY_LOW);
+  if (TAOS_LRU_STATUS_OK != status && TAOS_LRU_STATUS_OK_OVERWRITTEN != status) {
+    tscDebug("0x%" PRIx64 " failed to insert plan cache, status:%d, reqId:0x%" PRIx64, pRequest->self, status,
+             pRequest->requestId);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
@@ -263,6 +263,38 @@ int32_t stmtParseSql(STscStmt* pStmt) {
   return TSDB_CODE_SUCCESS;
 }
 
+int32_t stmtGetCachedQueryPlan(STscStmt* pStmt, bool* pHit) {
+  SRequestObj* pRequest = pStmt->exec.pRequest;
+  SQuery*      pQuery = pStmt->sql.pQuery;
+
+  *pHit = false;
+
+  STMT_ERR_RET(clientBuildPlanCacheKey(pRequest, pQuery->pPlaceholderValues));
+  if (NULL == pRequest->planCacheKey) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (!clientIsPlanCacheable(pQuery)) {
+    clientClearPlanCacheKey(pRequest);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  qDestroyQueryPlan(pRequest->pCachedPlan);
+  pRequest->pCachedPlan = NULL;
+  if (!clientGetCachedPlan(pRequest, &pRequest->pCachedPlan)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  pQuery->execMode = QUERY_EXEC_MODE_SCHEDULE;
+  pQuery->msgType = pRequest->type;
+  pQuery->haveResultSet = true;
+  *pHit = true;
+
+  tscDebug("stmt:%p reuse cached query plan", pStmt);
+
+  return TSDB_CODE_SUCCESS;
+}
+
 int32_t stmtCleanBindInfo(STscStmt* pStmt) {
   pStmt->bInfo.tbUid = 0;
   pStmt->bInfo.tbSuid = 0;
@@ -693,6 +725,14 @@ int stmtBindBatch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind, int32_t colIdx) {
   if (STMT_TYPE_QUERY == pStmt->sql.type) {
     STMT_ERR_RET(qStmtBindParams(pStmt->sql.pQuery, bind, colIdx));
 
+    if (colIdx < 0 || colIdx + 1 == pStmt->sql.pQuery->placeholderNum) {
+      bool hit = false;
+      STMT_ERR_RET(stmtGetCachedQueryPlan(pStmt, &hit));
+      if (hit) {
+        return TSDB_CODE_SUCCESS;
+      }
+    }
+
     SParseContext ctx = {.requestId = pStmt->exec.pRequest->requestId,
                          .acctId = pStmt->taos->acctId,
                          .db = pStmt->exec.pRequest->pDb,
@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include "catalog.h"
+#include "clientInt.h"
+#include "taoserror.h"
+#include "tglobal.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+
+namespace {
+
+const uint64_t pcTestClusterId = 0x1;
+const char*    pcTestUser = "user1";
+const char*    pcTestDb = "db1";
+const char*    pcTestDbFName = "1.db1";
+const char*    pcTestTable = "t1";
+const int64_t  pcTestDbId = 10;
+const int32_t  pcTestWaitMs = 10000;
+
+SCatalog* pCtg = NULL;
+int32_t   pcTestVgVersion = 1;
+int32_t   pcTestSVersion = 1;
+
+// the catalog applies updates in its own thread, so wait until the cache reflects them
+template <typename F>
+bool waitUntil(F cond) {
+  for (int32_t i = 0; i < pcTestWaitMs / 10; ++i) {
+    if (cond()) {
+      return true;
+    }
+    taosMsleep(10);
+  }
+  return false;
+}
+
+void setDbVgroups(int32_t vgVersion, int64_t dbId = pcTestDbId) {
+  SDBVgInfo* pDbVg = (SDBVgInfo*)taosMemoryCalloc(1, sizeof(SDBVgInfo));
+  pDbVg->vgVersion = vgVersion;
+  pDbVg->vgHash = taosHashInit(1, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, HASH_ENTRY_LOCK);
+
+  SVgroupInfo vg = {.vgId = 2, .hashBegin = 0, .hashEnd = UINT32_MAX};
+  vg.epSet.numOfEps = 1;
+  strcpy(vg.epSet.eps[0].fqdn, "localhost");
+  vg.epSet.eps[0].port = 6030;
+  taosHashPut(pDbVg->vgHash, &vg.vgId, sizeof(vg.vgId), &vg, sizeof(vg));
+
+  ASSERT_EQ(catalogUpdateDBVgInfo(pCtg, pcTestDbFName, dbId, pDbVg), TSDB_CODE_SUCCESS);
+  ASSERT_TRUE(waitUntil([vgVersion, dbId]() {
+    int32_t version = -1, tableNum = 0;
+    int64_t id = 0, stateTs = 0;
+    return TSDB_CODE_SUCCESS == catalogGetDBVgVersion(pCtg, pcTestDbFName, &version, &id, &tableNum, &stateTs) &&
+           version == vgVersion && id == dbId;
+  }));
+}
+
+SName tableName() {
+  SName name = {0};
+  tNameFromString(&name, "1.db1.t1", T_NAME_ACCT | T_NAME_DB | T_NAME_TABLE);
+  return name;
+}
+
+void setTableMeta(int32_t sversion, uint64_t uid = 100) {
+  STableMetaRsp rsp = {0};
+  strcpy(rsp.dbFName, pcTestDbFName);
+  strcpy(rsp.tbName, pcTestTable);
+  rsp.dbId = pcTestDbId;
+  rsp.numOfColumns = 2;
+  rsp.precision = TSDB_TIME_PRECISION_MILLI;
+  rsp.tableType = TSDB_NORMAL_TABLE;
+  rsp.sversion = sversion;
+  rsp.tversion = 1;
+  rsp.tuid = uid;
+  rsp.vgId = 2;
+  rsp.pSchemas = (SSchema*)taosMemoryCalloc(rsp.numOfColumns, sizeof(SSchema));
+  rsp.pSchemas[0] = {.type = TSDB_DATA_TYPE_TIMESTAMP, .colId = 1, .bytes = 8};
+  strcpy(rsp.pSchemas[0].name, "ts");
+  rsp.pSchemas[1] = {.type = TSDB_DATA_TYPE_INT, .colId = 2, .bytes = 4};
+  strcpy(rsp.pSchemas[1].name, "c1");
+
+  ASSERT_EQ(catalogUpdateTableMeta(pCtg, &rsp), TSDB_CODE_SUCCESS);
+  taosMemoryFree(rsp.pSchemas);
+
+  SName name = tableName();
+  ASSERT_TRUE(waitUntil([&name, sversion, uid]() {
+    STableMeta* pMeta = NULL;
+    bool        same = TSDB_CODE_SUCCESS == catalogGetCachedTableMeta(pCtg, &name, &pMeta) && NULL != pMeta &&
+                pMeta->sversion == sversion && pMeta->uid == uid;
+    taosMemoryFree(pMeta);
+    return same;
+  }));
+}
+
+void setUserAuth(int32_t version, bool canRead) {
+  SGetUserAuthRsp rsp = {0};
+  strcpy(rsp.user, pcTestUser);
+  rsp.version = version;
+  rsp.createdDbs = taosHashInit(1, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_ENTRY_LOCK);
+  rsp.readDbs = taosHashInit(1, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_ENTRY_LOCK);
+  rsp.writeDbs = taosHashInit(1, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_ENTRY_LOCK);
+  if (canRead) {
+    taosHashPut(rsp.readDbs, pcTestDbFName, strlen(pcTestDbFName), pcTestDbFName, strlen(pcTestDbFName));
+  }
+  ASSERT_EQ(catalogUpdateUserAuthInfo(pCtg, &rsp), TSDB_CODE_SUCCESS);
+  ASSERT_TRUE(waitUntil([canRead]() {
+    bool pass = false, exists = false;
+    return TSDB_CODE_SUCCESS ==
+               catalogChkAuthFromCache(pCtg, pcTestUser, pcTestDbFName, AUTH_TYPE_READ, &pass, &exists) &&
+           exists && pass == canRead;
+  }));
+}
+
+// two levels: a merge subplan on top of a scan subplan
+SQueryPlan* buildPlan() {
+  SQueryPlan* pPlan = (SQueryPlan*)nodesMakeNode(QUERY_NODE_PHYSICAL_PLAN);
+  SSubplan*   pMerge = (SSubplan*)nodesMakeNode(QUERY_NODE_PHYSICAL_SUBPLAN);
+  SSubplan*   pScan = (SSubplan*)nodesMakeNode(QUERY_NODE_PHYSICAL_SUBPLAN);
+  pMerge->subplanType = SUBPLAN_TYPE_MERGE;
+  pMerge->id.groupId = 1;
+  pScan->subplanType = SUBPLAN_TYPE_SCAN;
+  pScan->id.groupId = 2;
+  pScan->execNode.nodeId = 2;
+  nodesListMakeAppend(&pMerge->pChildren, (SNode*)pScan);
+  nodesListMakeAppend(&pScan->pParents, (SNode*)pMerge);
+
+  SNodeListNode* pTop = (SNodeListNode*)nodesMakeNode(QUERY_NODE_NODE_LIST);
+  SNodeListNode* pBottom = (SNodeListNode*)nodesMakeNode(QUERY_NODE_NODE_LIST);
+  nodesListMakeAppend(&pTop->pNodeList, (SNode*)pMerge);
+  nodesListMakeAppend(&pBottom->pNodeList, (SNode*)pScan);
+  nodesListMakeAppend(&pPlan->pSubplans, (SNode*)pTop);
+  nodesListMakeAppend(&pPlan->pSubplans, (SNode*)pBottom);
+  pPlan->numOfSubplans = 2;
+  pPlan->explainInfo.mode = EXPLAIN_MODE_DISABLE;
+  return pPlan;
+}
+
+}  // namespace
+
+class PlanCacheTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    ASSERT_EQ(catalogInit(NULL), TSDB_CODE_SUCCESS);
+    ASSERT_EQ(catalogGetHandle(pcTestClusterId, &pCtg), TSDB_CODE_SUCCESS);
+  }
+
+  static void TearDownTestSuite() { catalogDestroy(); }
+
+  void SetUp() override {
+    tsQueryPlanCacheSize = 1;
+    memset(&appInfo, 0, sizeof(appInfo));
+    appInfo.clusterId = pcTestClusterId;
+    ASSERT_EQ(clientPlanCacheInit(&appInfo), TSDB_CODE_SUCCESS);
+    ASSERT_NE(appInfo.pPlanCache, nullptr);
+
+    memset(&tscObj, 0, sizeof(tscObj));
+    tscObj.pAppInfo = &appInfo;
+    strcpy(tscObj.user, pcTestUser);
+
+    setDbVgroups(++pcTestVgVersion);
+    setTableMeta(++pcTestSVersion);
+    setUserAuth(pcTestVgVersion, true);
+  }
+
+  void TearDown() override { clientPlanCacheCleanup(&appInfo); }
+
+  SRequestObj* newRequest(const char* sql) {
+    SRequestObj* pRequest = (SRequestObj*)taosMemoryCalloc(1, sizeof(SRequestObj));
+    pRequest->pTscObj = &tscObj;
+    pRequest->pDb = (char*)pcTestDb;
+    pRequest->sqlstr = strdup(sql);
+    pRequest->sqlLen = strlen(sql);
+    pRequest->requestId = ++reqId;
+    pRequest->type = TDMT_SCH_QUERY;
+    char dbFName[TSDB_DB_FNAME_LEN] = {0};
+    strcpy(dbFName, pcTestDbFName);
+    pRequest->dbList = taosArrayInit(1, TSDB_DB_FNAME_LEN);
+    taosArrayPush(pRequest->dbList, dbFName);
+    pRequest->tableList = taosArrayInit(1, sizeof(SName));
+    SName name = tableName();
+    taosArrayPush(pRequest->tableList, &name);
+    EXPECT_EQ(clientBuildPlanCacheKey(pRequest, NULL), TSDB_CODE_SUCCESS);
+    return pRequest;
+  }
+
+  void freeRequest(SRequestObj* pRequest) {
+    clientClearPlanCacheKey(pRequest);
+    taosMemoryFree(pRequest->sqlstr);
+    taosArrayDestroy(pRequest->dbList);
+    taosArrayDestroy(pRequest->tableList);
+    taosMemoryFree(pRequest->body.resInfo.fields);
+    taosMemoryFree(pRequest->body.resInfo.userFields);
+    taosMemoryFree(pRequest);
+  }
+
+  void putPlan(const char* sql) {
+    SRequestObj* pRequest = newRequest(sql);
+    SQueryPlan*  pPlan = buildPlan();
+    ASSERT_EQ(clientPutCachedPlan(pRequest, pPlan), TSDB_CODE_SUCCESS);
+    qDestroyQueryPlan(pPlan);
+    freeRequest(pRequest);
+  }
+
+  bool getPlan(const char* sql) {
+    SRequestObj* pRequest = newRequest(sql);
+    SQueryPlan*  pPlan = NULL;
+    bool         hit = clientGetCachedPlan(pRequest, &pPlan);
+    if (hit) {
+      EXPECT_EQ(pPlan->queryId, pRequest->requestId);
+      EXPECT_EQ(pPlan->numOfSubplans, 2);
+      SSubplan* pMerge = (SSubplan*)nodesListGetNode(((SNodeListNode*)nodesListGetNode(pPlan->pSubplans, 0))->pNodeList, 0);
+      SSubplan* pScan = (SSubplan*)nodesListGetNode(((SNodeListNode*)nodesListGetNode(pPlan->pSubplans, 1))->pNodeList, 0);
+      EXPECT_EQ(LIST_LENGTH(pMerge->pChildren), 1);
+      EXPECT_EQ(nodesListGetNode(pMerge->pChildren, 0), (SNode*)pScan);
+      EXPECT_EQ(nodesListGetNode(pScan->pParents, 0), (SNode*)pMerge);
+      EXPECT_EQ(pScan->id.queryId, pRequest->requestId);
+      EXPECT_EQ(pRequest->type, TDMT_SCH_QUERY);
+      EXPECT_EQ(taosArrayGetSize(pRequest->tableList), 1);
+      qDestroyQueryPlan(pPlan);
+    }
+    freeRequest(pRequest);
+    return hit;
+  }
+
+  SAppInstInfo appInfo;
+  STscObj      tscObj;
+  uint64_t     reqId = 0;
+};
+
+TEST_F(PlanCacheTest, hit) {
+  putPlan("select * from t1 where c1 > 10");
+  ASSERT_TRUE(getPlan("select * from t1 where c1 > 10"));
+  ASSERT_TRUE(getPlan("SELECT  *\n FROM t1 WHERE c1 > 10;"));
+  ASSERT_TRUE(getPlan("select * from t1 where c1 > 10"));
+}
+
+TEST_F(PlanCacheTest, miss) {
+  putPlan("select * from t1 where c1 > 10");
+  ASSERT_FALSE(getPlan("select * from t1 where c1 > 11"));
+  ASSERT_FALSE(getPlan("select c1 from t1 where c1 > 10"));
+
+  // quoted literals are case sensitive
+  putPlan("select * from t1 where c1 = 'a'");
+  ASSERT_TRUE(getPlan("select * from t1 where c1 = 'a'"));
+  ASSERT_FALSE(getPlan("select * from t1 where c1 = 'A'"));
+
+  // the key includes the user
+  strcpy(tscObj.user, "user2");
+  ASSERT_FALSE(getPlan("select * from t1 where c1 > 10"));
+}
+
+TEST_F(PlanCacheTest, invalidation) {
+  putPlan("select * from t1");
+  ASSERT_TRUE(getPlan("select * from t1"));
+
+  setTableMeta(++pcTestSVersion);
+  ASSERT_FALSE(getPlan("select * from t1"));
+
+  putPlan("select * from t1");
+  ASSERT_TRUE(getPlan("select * from t1"));
+
+  setDbVgroups(++pcTestVgVersion);
+  ASSERT_FALSE(getPlan("select * from t1"));
+}
+
+TEST_F(PlanCacheTest, recreation) {
+  putPlan("select * from t1");
+  ASSERT_TRUE(getPlan("select * from t1"));
+
+  // a table dropped and created again with the same name and the same versions
+  setTableMeta(pcTestSVersion, 200);
+  ASSERT_FALSE(getPlan("select * from t1"));
+
+  putPlan("select * from t1");
+  ASSERT_TRUE(getPlan("select * from t1"));
+
+  // and a db
+  setDbVgroups(pcTestVgVersion, pcTestDbId + 1);
+  setTableMeta(pcTestSVersion, 200);
+  ASSERT_FALSE(getPlan("select * from t1"));
+}
+
+TEST_F(PlanCacheTest, privilegeRevocation) {
+  putPlan("select * from t1");
+  ASSERT_TRUE(getPlan("select * from t1"));
+
+  // a table level or tag filter revocation does not change the db privileges, but is pushed by the hb
+  clientPlanCacheOnAuthUpdate(&appInfo);
+  ASSERT_FALSE(getPlan("select * from t1"));
+
+  // an update that arrives while the plan is being built expires it immediately
+  SRequestObj* pRequest = newRequest("select * from t1");
+  clientPlanCacheOnAuthUpdate(&appInfo);
+  SQueryPlan* pPlan = buildPlan();
+  ASSERT_EQ(clientPutCachedPlan(pRequest, pPlan), TSDB_CODE_SUCCESS);
+  qDestroyQueryPlan(pPlan);
+  freeRequest(pRequest);
+  ASSERT_FALSE(getPlan("select * from t1"));
+
+  putPlan("select * from t1");
+  ASSERT_TRUE(getPlan("select * from t1"));
+
+  // db level revocation
+  setUserAuth(++pcTestVgVersion, false);
+  ASSERT_FALSE(getPlan("select * from t1"));
+}
+
+#pragma GCC diagnostic pop
@@ -904,6 +904,193 @@ static int32_t* createTupleIndex(size_t rows) {
 
 static void destroyTupleIndex(int32_t* index) { taosMemoryFreeClear(index); }
 
+// sort keys longer than this are ordered by memcmp instead of the radix sort
+#define SORT_KEY_RADIX_MAX_LEN 16
+
+int32_t blockDataGetSortKeyLen(const SSDataBlock* pBlock, const SArray* pOrderInfo) {
+  int32_t len = 0;
+  for (int32_t i = 0; i < taosArrayGetSize(pOrderInfo); ++i) {
+    SBlockOrderInfo* pOrder = taosArrayGet(pOrderInfo, i);
+    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, pOrder->slotId);
+
+    switch (pColInfoData->info.type) {
+      case TSDB_DATA_TYPE_BOOL:
+      case TSDB_DATA_TYPE_TINYINT:
+      case TSDB_DATA_TYPE_SMALLINT:
+      case TSDB_DATA_TYPE_INT:
+      case TSDB_DATA_TYPE_BIGINT:
+      case TSDB_DATA_TYPE_TIMESTAMP:
+      case TSDB_DATA_TYPE_UTINYINT:
+      case TSDB_DATA_TYPE_USMALLINT:
+      case TSDB_DATA_TYPE_UINT:
+      case TSDB_DATA_TYPE_UBIGINT:
+      case TSDB_DATA_TYPE_FLOAT:
+      case TSDB_DATA_TYPE_DOUBLE:
+        len += 1 + tDataTypes[pColInfoData->info.type].bytes;  // one byte for the null flag
+        break;
+      default:
+        return 0;
+    }
+  }
+
+  return len;
+}
+
+// Map the value to an unsigned integer of the same width that keeps the order of getKeyComparFunc() in ascending order.
+static FORCE_INLINE uint64_t sortKeyEncodeValue(int8_t type, const char* pData) {
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+      return (uint8_t)(*(int8_t*)pData) ^ 0x80u;
+    case TSDB_DATA_TYPE_SMALLINT:
+      return (uint16_t)(*(int16_t*)pData) ^ 0x8000u;
+    case TSDB_DATA_TYPE_INT:
+      return (uint32_t)(*(int32_t*)pData) ^ 0x80000000u;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      return (uint64_t)(*(int64_t*)pData) ^ 0x8000000000000000ull;
+    case TSDB_DATA_TYPE_UTINYINT:
+      return *(uint8_t*)pData;
+    case TSDB_DATA_TYPE_USMALLINT:
+      return *(uint16_t*)pData;
+    case TSDB_DATA_TYPE_UINT:
+      return *(uint32_t*)pData;
+    case TSDB_DATA_TYPE_UBIGINT:
+      return *(uint64_t*)pData;
+    case TSDB_DATA_TYPE_FLOAT: {
+      // NaN is the smallest one, and -0.0 equals to 0.0
+      float v = GET_FLOAT_VAL(pData);
+      if (isnan(v)) {
+        return 0;
+      }
+      if (v == 0) {
+        v = 0;
+      }
+      uint32_t u = 0;
+      memcpy(&u, &v, sizeof(u));
+      return (u & 0x80000000u) ? (uint32_t)~u : (u | 0x80000000u);
+    }
+    case TSDB_DATA_TYPE_DOUBLE: {
+      double v = GET_DOUBLE_VAL(pData);
+      if (isnan(v)) {
+        return 0;
+      }
+      if (v == 0) {
+        v = 0;
+      }
+      uint64_t u = 0;
+      memcpy(&u, &v, sizeof(u));
+      return (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+    }
+    default:
+      return 0;
+  }
+}
+
+void blockDataBuildSortKeys(const SSDataBlock* pBlock, const SArray* pOrderInfo, char* pKeys, int32_t stride) {
+  int32_t rows = pBlock->info.rows;
+  int32_t offset = 0;
+
+  for (int32_t i = 0; i < taosArrayGetSize(pOrderInfo); ++i) {
+    SBlockOrderInfo* pOrder = taosArrayGet(pOrderInfo, i);
+    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, pOrder->slotId);
+
+    int8_t   type = pColInfoData->info.type;
+    int32_t  bytes = tDataTypes[type].bytes;
+    uint8_t  nullFlag = pOrder->nullFirst ? 0 : 1;
+    uint64_t mask = (pOrder->order == TSDB_ORDER_DESC) ? UINT64_MAX : 0;
+
+    for (int32_t j = 0; j < rows; ++j) {
+      uint8_t* pKey = (uint8_t*)pKeys + (int64_t)j * stride + offset;
+      uint64_t v = 0;
+      if (colDataIsNull_s(pColInfoData, j)) {
+        pKey[0] = nullFlag;
+      } else {
+        pKey[0] = nullFlag ^ 1u;
+        v = sortKeyEncodeValue(type, colDataGetData(pColInfoData, j)) ^ mask;
+      }
+
+      // big endian, so that memcmp gives the order
+      for (int32_t k = bytes; k > 0; --k) {
+        pKey[k] = (uint8_t)v;
+        v >>= 8;
+      }
+    }
+
+    offset += 1 + bytes;
+  }
+}
+
+static int32_t sortKeyCompar(const void* p1, const void* p2, const void* param) {
+  return memcmp(p1, p2, *(const int32_t*)param);
+}
+
+// Sort the normalized keys of the rows, each of which is followed by its row index, and output the sorted row indexes.
+// The short keys are sorted by the LSD radix sort, in which the bytes that are the same for all the rows are skipped.
+static int32_t blockDataSortByKeys(const SSDataBlock* pDataBlock, const SArray* pOrderInfo, int32_t keyLen,
+                                   int32_t* index) {
+  int32_t rows = pDataBlock->info.rows;
+  int32_t recLen = keyLen + sizeof(int32_t);
+
+  char* pBuf = taosMemoryMalloc((int64_t)rows * recLen * 2);
+  if (pBuf == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  char* pSrc = pBuf;
+  char* pDst = pBuf + (int64_t)rows * recLen;
+  blockDataBuildSortKeys(pDataBlock, pOrderInfo, pSrc, recLen);
+  for (int32_t i = 0; i < rows; ++i) {
+    memcpy(pSrc + (int64_t)i * recLen + keyLen, &i, sizeof(int32_t));
+  }
+
+  if (keyLen > SORT_KEY_RADIX_MAX_LEN) {
+    taosqsort(pSrc, rows, recLen, &keyLen, sortKeyCompar);
+  } else {
+    uint32_t* pCounts = taosMemoryCalloc(keyLen * 256, sizeof(uint32_t));
+    if (pCounts == NULL) {
+      taosMemoryFree(pBuf);
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+
+    for (int32_t i = 0; i < rows; ++i) {
+      const uint8_t* pRec = (const uint8_t*)pSrc + (int64_t)i * recLen;
+      for (int32_t b = 0; b < keyLen; ++b) {
+        pCounts[b * 256 + pRec[b]] += 1;
+      }
+    }
+
+    for (int32_t b = keyLen - 1; b >= 0; --b) {
+      uint32_t* pCount = pCounts + b * 256;
+      if (pCount[(uint8_t)pSrc[b]] == rows) {
+        continue;
+      }
+
+      uint32_t pos = 0;
+      for (int32_t c = 0; c < 256; ++c) {
+        uint32_t n = pCount[c];
+        pCount[c] = pos;
+        pos += n;
+      }
+
+      for (int32_t i = 0; i < rows; ++i) {
+        const char* pRec = pSrc + (int64_t)i * recLen;
+        memcpy(pDst + (int64_t)(pCount[(uint8_t)pRec[b]]++) * recLen, pRec, recLen);
+      }
+      TSWAP(pSrc, pDst);
+    }
+
+    taosMemoryFree(pCounts);
+  }
+
+  for (int32_t i = 0; i < rows; ++i) {
+    memcpy(&index[i], pSrc + (int64_t)i * recLen + keyLen, sizeof(int32_t));
+  }
+
+  taosMemoryFree(pBuf);
+  return TSDB_CODE_SUCCESS;
+}
+
 int32_t blockDataSort(SSDataBlock* pDataBlock, SArray* pOrderInfo) {
   ASSERT(pDataBlock != NULL && pOrderInfo != NULL);
   if (pDataBlock->info.rows <= 1) {
@@ -960,15 +1147,25 @@ int32_t blockDataSort(SSDataBlock* pDataBlock, SArray* pOrderInfo) {
 
   int64_t p0 = taosGetTimestampUs();
 
-  SSDataBlockSortHelper helper = {.pDataBlock = pDataBlock, .orderInfo = pOrderInfo};
-  for (int32_t i = 0; i < taosArrayGetSize(helper.orderInfo); ++i) {
-    struct SBlockOrderInfo* pInfo = taosArrayGet(helper.orderInfo, i);
-    pInfo->pColData = taosArrayGet(pDataBlock->pDataBlock, pInfo->slotId);
-  }
+  int32_t keyLen = blockDataGetSortKeyLen(pDataBlock, pOrderInfo);
+  if (keyLen > 0) {
+    int32_t code = blockDataSortByKeys(pDataBlock, pOrderInfo, keyLen, index);
+    if (code != TSDB_CODE_SUCCESS) {
+      destroyTupleIndex(index);
+      terrno = code;
+      return code;
+    }
+  } else {
+    SSDataBlockSortHelper helper = {.pDataBlock = pDataBlock, .orderInfo = pOrderInfo};
+    for (int32_t i = 0; i < taosArrayGetSize(helper.orderInfo); ++i) {
+      struct SBlockOrderInfo* pInfo = taosArrayGet(helper.orderInfo, i);
+      pInfo->pColData = taosArrayGet(pDataBlock->pDataBlock, pInfo->slotId);
+    }
 
-  terrno = 0;
-  taosqsort(index, rows, sizeof(int32_t), &helper, dataBlockCompar);
-  if (terrno) return terrno;
+    terrno = 0;
+    taosqsort(index, rows, sizeof(int32_t), &helper, dataBlockCompar);
+    if (terrno) return terrno;
+  }
 
   int64_t p1 = taosGetTimestampUs();
 
@@ -989,8 +1186,8 @@ int32_t blockDataSort(SSDataBlock* pDataBlock, SArray* pOrderInfo) {
   int64_t p4 = taosGetTimestampUs();
 
   uDebug("blockDataSort complex sort:%" PRId64 ", create:%" PRId64 ", assign:%" PRId64 ", copyback:%" PRId64
-         ", rows:%d\n",
-         p1 - p0, p2 - p1, p3 - p2, p4 - p3, rows);
+         ", rows:%d, keyLen:%d\n",
+         p1 - p0, p2 - p1, p3 - p2, p4 - p3, rows, keyLen);
   destroyTupleIndex(index);
 
   return TSDB_CODE_SUCCESS;
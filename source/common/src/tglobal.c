@@ -92,6 +92,8 @@ bool    tsQueryPlannerTrace = false;
 int32_t tsQueryNodeChunkSize = 32 * 1024;
 bool    tsQueryUseNodeAllocator = true;
 bool    tsKeepColumnName = false;
+int32_t tsQueryPlanCacheSize = 0;  // MB, 0 means the client-side plan cache is disabled
+bool    tsQueryStatsOptimize = false;
 int32_t tsRedirectPeriod = 10;
 int32_t tsRedirectFactor = 2;
 int32_t tsRedirectMaxPeriod = 1000;
@@ -164,15 +166,23 @@ uint32_t tsCurRange = 100;                      // range
 char     tsCompressor[32] = "ZSTD_COMPRESSOR";  // ZSTD_COMPRESSOR or GZIP_COMPRESSOR
 
 // udf
-bool tsStartUdfd = true;
+bool    tsStartUdfd = true;
+int32_t tsUdfShmSize = 0;  // MB, shared memory of each udf session to pass large messages, 0 means disabled
 
 // wal
 int64_t tsWalFsyncDataSizeLimit = (100 * 1024 * 1024L);
 
+// tsdb
+int32_t tsCompactMaxSpeed = 0;     // MB/s, I/O budget of the tsdb compaction of each vnode, 0 means unlimited
+int32_t tsCompactInterval = 3600;  // seconds between the automatic compactions of a vnode, 0 means disabled
+int32_t tsCacheLastLoad = 1;       // 0: last cache is not persisted, 1: persisted entries loaded on demand, 2: eagerly
+int32_t tsMigrateMaxSpeed = 0;     // MB/s, I/O budget of moving file sets between tiers on each disk, 0 means unlimited
+
 // internal
 int32_t tsTransPullupInterval = 2;
 int32_t tsMqRebalanceInterval = 2;
 int32_t tsStreamCheckpointTickInterval = 1;
+int32_t tsStreamBufferSize = 32;  // MB, write buffer in front of the state storage of each stream task
 int32_t tsTtlUnit = 86400;
 int32_t tsTtlPushInterval = 86400;
 int32_t tsGrantHBInterval = 60;
@@ -303,11 +313,13 @@ static int32_t taosAddClientCfg(SConfig *pCfg) {
   if (cfgAddInt32(pCfg, "compressColData", tsCompressColData, -1, 100000000, 1) != 0) return -1;
   if (cfgAddInt32(pCfg, "queryPolicy", tsQueryPolicy, 1, 4, 1) != 0) return -1;
   if (cfgAddBool(pCfg, "enableQueryHb", tsEnableQueryHb, false) != 0) return -1;
-  if (cfgAddInt32(pCfg, "querySmaOptimize", tsQuerySmaOptimize, 0, 1, 1) != 0) return -1;
+  if (cfgAddInt32(pCfg, "querySmaOptimize", tsQuerySmaOptimize, 0, 2, 1) != 0) return -1;
   if (cfgAddBool(pCfg, "queryPlannerTrace", tsQueryPlannerTrace, true) != 0) return -1;
   if (cfgAddInt32(pCfg, "queryNodeChunkSize", tsQueryNodeChunkSize, 1024, 128 * 1024, true) != 0) return -1;
   if (cfgAddBool(pCfg, "queryUseNodeAllocator", tsQueryUseNodeAllocator, true) != 0) return -1;
   if (cfgAddBool(pCfg, "keepColumnName", tsKeepColumnName, true) != 0) return -1;
+  if (cfgAddInt32(pCfg, "queryPlanCacheSize", tsQueryPlanCacheSize, 0, 1024, true) != 0) return -1;
+  if (cfgAddBool(pCfg, "queryStatsOptimize", tsQueryStatsOptimize, true) != 0) return -1;
   if (cfgAddString(pCfg, "smlChildTableName", "", 1) != 0) return -1;
   if (cfgAddString(pCfg, "smlTagName", tsSmlTagName, 1) != 0) return -1;
   if (cfgAddBool(pCfg, "smlDataFormat", tsSmlDataFormat, 1) != 0) return -1;
@@ -419,6 +431,7 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
   tsNumOfSnodeWriteThreads = tsNumOfCores / 4;
   tsNumOfSnodeWriteThreads = TRANGE(tsNumOfSnodeWriteThreads, 2, 4);
   if (cfgAddInt32(pCfg, "numOfSnodeUniqueThreads", tsNumOfSnodeWriteThreads, 2, 1024, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "streamBufferSize", tsStreamBufferSize, 0, 4096, 0) != 0) return -1;
 
   tsRpcQueueMemoryAllowed = tsTotalMemoryKB * 1024 * 0.1;
   tsRpcQueueMemoryAllowed = TRANGE(tsRpcQueueMemoryAllowed, TSDB_MAX_MSG_SIZE * 10LL, TSDB_MAX_MSG_SIZE * 10000LL);
@@ -450,10 +463,15 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
 
   if (cfgAddInt64(pCfg, "walFsyncDataSizeLimit", tsWalFsyncDataSizeLimit, 100 * 1024 * 1024, INT64_MAX, 0) != 0)
     return -1;
+  if (cfgAddInt32(pCfg, "compactMaxSpeed", tsCompactMaxSpeed, 0, 10240, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "compactInterval", tsCompactInterval, 0, 86400 * 365, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "cacheLastLoad", tsCacheLastLoad, 0, 2, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "migrateMaxSpeed", tsMigrateMaxSpeed, 0, 10240, 0) != 0) return -1;
 
   if (cfgAddBool(pCfg, "udf", tsStartUdfd, 0) != 0) return -1;
   if (cfgAddString(pCfg, "udfdResFuncs", tsUdfdResFuncs, 0) != 0) return -1;
   if (cfgAddString(pCfg, "udfdLdLibPath", tsUdfdLdLibPath, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "udfShmSize", tsUdfShmSize, 0, 1024, 0) != 0) return -1;
 
   GRANT_CFG_ADD;
   return 0;
@@ -668,6 +686,8 @@ static int32_t taosSetClientCfg(SConfig *pCfg) {
   tsQueryNodeChunkSize = cfgGetItem(pCfg, "queryNodeChunkSize")->i32;
   tsQueryUseNodeAllocator = cfgGetItem(pCfg, "queryUseNodeAllocator")->bval;
   tsKeepColumnName = cfgGetItem(pCfg, "keepColumnName")->bval;
+  tsQueryPlanCacheSize = cfgGetItem(pCfg, "queryPlanCacheSize")->i32;
+  tsQueryStatsOptimize = cfgGetItem(pCfg, "queryStatsOptimize")->bval;
 
   tsMaxRetryWaitTime = cfgGetItem(pCfg, "maxRetryWaitTime")->i32;
   return 0;
@@ -716,6 +736,7 @@ static int32_t taosSetServerCfg(SConfig *pCfg) {
   //  tsNumOfQnodeFetchThreads = cfgGetItem(pCfg, "numOfQnodeFetchThreads")->i32;
   tsNumOfSnodeStreamThreads = cfgGetItem(pCfg, "numOfSnodeSharedThreads")->i32;
   tsNumOfSnodeWriteThreads = cfgGetItem(pCfg, "numOfSnodeUniqueThreads")->i32;
+  tsStreamBufferSize = cfgGetItem(pCfg, "streamBufferSize")->i32;
   tsRpcQueueMemoryAllowed = cfgGetItem(pCfg, "rpcQueueMemoryAllowed")->i64;
 
   tsEnableMonitor = cfgGetItem(pCfg, "monitor")->bval;
@@ -739,6 +760,10 @@ static int32_t taosSetServerCfg(SConfig *pCfg) {
   tsQueryRsmaTolerance = cfgGetItem(pCfg, "queryRsmaTolerance")->i32;
 
   tsWalFsyncDataSizeLimit = cfgGetItem(pCfg, "walFsyncDataSizeLimit")->i64;
+  tsCompactMaxSpeed = cfgGetItem(pCfg, "compactMaxSpeed")->i32;
+  tsCompactInterval = cfgGetItem(pCfg, "compactInterval")->i32;
+  tsCacheLastLoad = cfgGetItem(pCfg, "cacheLastLoad")->i32;
+  tsMigrateMaxSpeed = cfgGetItem(pCfg, "migrateMaxSpeed")->i32;
 
   tsElectInterval = cfgGetItem(pCfg, "syncElectInterval")->i32;
   tsHeartbeatInterval = cfgGetItem(pCfg, "syncHeartbeatInterval")->i32;
@@ -747,6 +772,7 @@ static int32_t taosSetServerCfg(SConfig *pCfg) {
   tsStartUdfd = cfgGetItem(pCfg, "udf")->bval;
   tstrncpy(tsUdfdResFuncs, cfgGetItem(pCfg, "udfdResFuncs")->str, sizeof(tsUdfdResFuncs));
   tstrncpy(tsUdfdLdLibPath, cfgGetItem(pCfg, "udfdLdLibPath")->str, sizeof(tsUdfdLdLibPath));
+  tsUdfShmSize = cfgGetItem(pCfg, "udfShmSize")->i32;
   if (tsQueryBufferSize >= 0) {
     tsQueryBufferSizeBytes = tsQueryBufferSize * 1048576UL;
   }
@@ -792,6 +818,10 @@ int32_t taosSetCfg(SConfig *pCfg, char *name) {
         tsCompressMsgSize = cfgGetItem(pCfg, "compressMsgSize")->i32;
       } else if (strcasecmp("compressColData", name) == 0) {
         tsCompressColData = cfgGetItem(pCfg, "compressColData")->i32;
+      } else if (strcasecmp("compactMaxSpeed", name) == 0) {
+        tsCompactMaxSpeed = cfgGetItem(pCfg, "compactMaxSpeed")->i32;
+      } else if (strcasecmp("compactInterval", name) == 0) {
+        tsCompactInterval = cfgGetItem(pCfg, "compactInterval")->i32;
       } else if (strcasecmp("countAlwaysReturnValue", name) == 0) {
         tsCountAlwaysReturnValue = cfgGetItem(pCfg, "countAlwaysReturnValue")->i32;
       } else if (strcasecmp("cDebugFlag", name) == 0) {
@@ -912,6 +942,8 @@ int32_t taosSetCfg(SConfig *pCfg, char *name) {
             tsMinIntervalTime = cfgGetItem(pCfg, "minIntervalTime")->i32;
           } else if (strcasecmp("minimalLogDirGB", name) == 0) {
             tsLogSpace.reserved = (int64_t)(((double)cfgGetItem(pCfg, "minimalLogDirGB")->fval) * 1024 * 1024 * 1024);
+          } else if (strcasecmp("migrateMaxSpeed", name) == 0) {
+            tsMigrateMaxSpeed = cfgGetItem(pCfg, "migrateMaxSpeed")->i32;
           }
           break;
         }
@@ -992,6 +1024,8 @@ int32_t taosSetCfg(SConfig *pCfg, char *name) {
         tsQueryPolicy = cfgGetItem(pCfg, "queryPolicy")->i32;
       } else if (strcasecmp("querySmaOptimize", name) == 0) {
         tsQuerySmaOptimize = cfgGetItem(pCfg, "querySmaOptimize")->i32;
+      } else if (strcasecmp("queryStatsOptimize", name) == 0) {
+        tsQueryStatsOptimize = cfgGetItem(pCfg, "queryStatsOptimize")->bval;
       } else if (strcasecmp("queryBufferSize", name) == 0) {
         tsQueryBufferSize = cfgGetItem(pCfg, "queryBufferSize")->i32;
         if (tsQueryBufferSize >= 0) {
@@ -1100,6 +1134,8 @@ int32_t taosSetCfg(SConfig *pCfg, char *name) {
     case 'u': {
       if (strcasecmp("udf", name) == 0) {
         tsStartUdfd = cfgGetItem(pCfg, "udf")->bval;
+      } else if (strcasecmp("udfShmSize", name) == 0) {
+        tsUdfShmSize = cfgGetItem(pCfg, "udfShmSize")->i32;
       } else if (strcasecmp("uDebugFlag", name) == 0) {
         uDebugFlag = cfgGetItem(pCfg, "uDebugFlag")->i32;
       }
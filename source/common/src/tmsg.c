@@ -1034,6 +1034,26 @@ int32_t tSerializeSStatusReq(void *buf, int32_t bufLen, SStatusReq *pReq) {
   if (tEncodeI64(&encoder, pReq->qload.timeInFetchQueue) < 0) return -1;
 
   if (tEncodeI32(&encoder, pReq->statusSeq) < 0) return -1;
+
+  // super table stats
+  int32_t slen = (int32_t)taosArrayGetSize(pReq->pStbStats);
+  if (tEncodeI32(&encoder, slen) < 0) return -1;
+  for (int32_t i = 0; i < slen; ++i) {
+    SStbStatsLoad *pStats = taosArrayGet(pReq->pStbStats, i);
+    if (tEncodeI32(&encoder, pStats->vgId) < 0) return -1;
+    if (tEncodeI64(&encoder, pStats->suid) < 0) return -1;
+    if (tEncodeI64(&encoder, pStats->numOfTables) < 0) return -1;
+    if (tEncodeI64(&encoder, pStats->numOfRows) < 0) return -1;
+    if (tEncodeI64(&encoder, pStats->skey) < 0) return -1;
+    if (tEncodeI64(&encoder, pStats->ekey) < 0) return -1;
+    int32_t nTags = (int32_t)taosArrayGetSize(pStats->pTagSketches);
+    if (tEncodeI32(&encoder, nTags) < 0) return -1;
+    for (int32_t j = 0; j < nTags; ++j) {
+      STagSketch *pSketch = taosArrayGet(pStats->pTagSketches, j);
+      if (tEncodeI16(&encoder, pSketch->colId) < 0) return -1;
+      if (tEncodeBinary(&encoder, pSketch->sketch, HLL_SKETCH_REGISTERS) < 0) return -1;
+    }
+  }
   tEndEncode(&encoder);
 
   int32_t tlen = encoder.pos;
@@ -1115,12 +1135,62 @@ int32_t tDeserializeSStatusReq(void *buf, int32_t bufLen, SStatusReq *pReq) {
   if (tDecodeI64(&decoder, &pReq->qload.timeInFetchQueue) < 0) return -1;
 
   if (tDecodeI32(&decoder, &pReq->statusSeq) < 0) return -1;
+
+  if (!tDecodeIsEnd(&decoder)) {
+    int32_t slen = 0;
+    if (tDecodeI32(&decoder, &slen) < 0) return -1;
+    if (slen > 0) {
+      pReq->pStbStats = taosArrayInit(slen, sizeof(SStbStatsLoad));
+      if (pReq->pStbStats == NULL) {
+        terrno = TSDB_CODE_OUT_OF_MEMORY;
+        return -1;
+      }
+    }
+
+    for (int32_t i = 0; i < slen; ++i) {
+      SStbStatsLoad stats = {0};
+      int32_t       nTags = 0;
+      if (tDecodeI32(&decoder, &stats.vgId) < 0) return -1;
+      if (tDecodeI64(&decoder, &stats.suid) < 0) return -1;
+      if (tDecodeI64(&decoder, &stats.numOfTables) < 0) return -1;
+      if (tDecodeI64(&decoder, &stats.numOfRows) < 0) return -1;
+      if (tDecodeI64(&decoder, &stats.skey) < 0) return -1;
+      if (tDecodeI64(&decoder, &stats.ekey) < 0) return -1;
+      if (tDecodeI32(&decoder, &nTags) < 0) return -1;
+      if (taosArrayPush(pReq->pStbStats, &stats) == NULL) {
+        terrno = TSDB_CODE_OUT_OF_MEMORY;
+        return -1;
+      }
+
+      SStbStatsLoad *pStats = taosArrayGetLast(pReq->pStbStats);
+      pStats->pTagSketches = taosArrayInit(nTags, sizeof(STagSketch));
+      if (pStats->pTagSketches == NULL) {
+        terrno = TSDB_CODE_OUT_OF_MEMORY;
+        return -1;
+      }
+      for (int32_t j = 0; j < nTags; ++j) {
+        STagSketch sketch = {0};
+        uint8_t   *pRegs = NULL;
+        uint32_t   len = 0;
+        if (tDecodeI16(&decoder, &sketch.colId) < 0) return -1;
+        if (tDecodeBinary(&decoder, &pRegs, &len) < 0) return -1;
+        memcpy(sketch.sketch, pRegs, TMIN(len, HLL_SKETCH_REGISTERS));
+        taosArrayPush(pStats->pTagSketches, &sketch);
+      }
+    }
+  }
+
   tEndDecode(&decoder);
   tDecoderClear(&decoder);
   return 0;
 }
 
-void tFreeSStatusReq(SStatusReq *pReq) { taosArrayDestroy(pReq->pVloads); }
+void tFreeSStbStatsLoad(void *pLoad) { taosArrayDestroy(((SStbStatsLoad *)pLoad)->pTagSketches); }
+
+void tFreeSStatusReq(SStatusReq *pReq) {
+  taosArrayDestroy(pReq->pVloads);
+  taosArrayDestroyEx(pReq->pStbStats, tFreeSStbStatsLoad);
+}
 
 int32_t tSerializeSStatusRsp(void *buf, int32_t bufLen, SStatusRsp *pRsp) {
   SEncoder encoder = {0};
@@ -1948,6 +2018,19 @@ int32_t tSerializeSTableCfgRsp(void *buf, int32_t bufLen, STableCfgRsp *pRsp) {
   if (tEncodeI32(&encoder, pRsp->tagsLen) < 0) return -1;
   if (tEncodeBinary(&encoder, pRsp->pTags, pRsp->tagsLen) < 0) return -1;
 
+  if (tEncodeI8(&encoder, NULL != pRsp->pStats) < 0) return -1;
+  if (NULL != pRsp->pStats) {
+    if (tEncodeI64(&encoder, pRsp->pStats->numOfTables) < 0) return -1;
+    if (tEncodeI64(&encoder, pRsp->pStats->numOfRows) < 0) return -1;
+    if (tEncodeI64(&encoder, pRsp->pStats->skey) < 0) return -1;
+    if (tEncodeI64(&encoder, pRsp->pStats->ekey) < 0) return -1;
+    if (tEncodeI32(&encoder, pRsp->pStats->numOfTags) < 0) return -1;
+    for (int32_t i = 0; i < pRsp->pStats->numOfTags; ++i) {
+      if (tEncodeI16(&encoder, pRsp->pStats->pTagNdv[i].colId) < 0) return -1;
+      if (tEncodeI64(&encoder, pRsp->pStats->pTagNdv[i].ndv) < 0) return -1;
+    }
+  }
+
   tEndEncode(&encoder);
 
   int32_t tlen = encoder.pos;
@@ -2006,6 +2089,28 @@ int32_t tDeserializeSTableCfgRsp(void *buf, int32_t bufLen, STableCfgRsp *pRsp)
   if (tDecodeI32(&decoder, &pRsp->tagsLen) < 0) return -1;
   if (tDecodeBinaryAlloc(&decoder, (void **)&pRsp->pTags, NULL) < 0) return -1;
 
+  int8_t hasStats = 0;
+  if (!tDecodeIsEnd(&decoder)) {
+    if (tDecodeI8(&decoder, &hasStats) < 0) return -1;
+  }
+  if (hasStats) {
+    pRsp->pStats = taosMemoryCalloc(1, sizeof(STableStats));
+    if (pRsp->pStats == NULL) return -1;
+    if (tDecodeI64(&decoder, &pRsp->pStats->numOfTables) < 0) return -1;
+    if (tDecodeI64(&decoder, &pRsp->pStats->numOfRows) < 0) return -1;
+    if (tDecodeI64(&decoder, &pRsp->pStats->skey) < 0) return -1;
+    if (tDecodeI64(&decoder, &pRsp->pStats->ekey) < 0) return -1;
+    if (tDecodeI32(&decoder, &pRsp->pStats->numOfTags) < 0) return -1;
+    if (pRsp->pStats->numOfTags > 0) {
+      pRsp->pStats->pTagNdv = taosMemoryCalloc(pRsp->pStats->numOfTags, sizeof(STagNdv));
+      if (pRsp->pStats->pTagNdv == NULL) return -1;
+    }
+    for (int32_t i = 0; i < pRsp->pStats->numOfTags; ++i) {
+      if (tDecodeI16(&decoder, &pRsp->pStats->pTagNdv[i].colId) < 0) return -1;
+      if (tDecodeI64(&decoder, &pRsp->pStats->pTagNdv[i].ndv) < 0) return -1;
+    }
+  }
+
   tEndDecode(&decoder);
 
   tDecoderClear(&decoder);
@@ -2022,6 +2127,38 @@ void tFreeSTableCfgRsp(STableCfgRsp *pRsp) {
   taosMemoryFreeClear(pRsp->pTags);
 
   taosArrayDestroy(pRsp->pFuncs);
+  tFreeTableStats(pRsp->pStats);
+  pRsp->pStats = NULL;
+}
+
+STableStats *tCloneTableStats(const STableStats *pStats) {
+  if (NULL == pStats) {
+    return NULL;
+  }
+
+  STableStats *pNew = taosMemoryMalloc(sizeof(STableStats));
+  if (NULL == pNew) {
+    return NULL;
+  }
+  memcpy(pNew, pStats, sizeof(STableStats));
+  pNew->pTagNdv = NULL;
+  if (pStats->numOfTags > 0) {
+    pNew->pTagNdv = taosMemoryMalloc(pStats->numOfTags * sizeof(STagNdv));
+    if (NULL == pNew->pTagNdv) {
+      taosMemoryFree(pNew);
+      return NULL;
+    }
+    memcpy(pNew->pTagNdv, pStats->pTagNdv, pStats->numOfTags * sizeof(STagNdv));
+  }
+  return pNew;
+}
+
+void tFreeTableStats(STableStats *pStats) {
+  if (NULL == pStats) {
+    return;
+  }
+  taosMemoryFree(pStats->pTagNdv);
+  taosMemoryFree(pStats);
 }
 
 int32_t tSerializeSCreateDbReq(void *buf, int32_t bufLen, SCreateDbReq *pReq) {
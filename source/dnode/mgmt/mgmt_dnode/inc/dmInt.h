@@ -34,6 +34,7 @@ typedef struct SDnodeMgmt {
   ProcessDropNodeFp   processDropNodeFp;
   SendMonitorReportFp sendMonitorReportFp;
   GetVnodeLoadsFp     getVnodeLoadsFp;
+  GetStbStatsLoadsFp  getStbStatsLoadsFp;
   GetMnodeLoadsFp     getMnodeLoadsFp;
   GetQnodeLoadsFp     getQnodeLoadsFp;
   int32_t             statusSeq;
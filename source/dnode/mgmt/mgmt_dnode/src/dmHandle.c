@@ -18,6 +18,9 @@
 #include "systable.h"
 #include "tgrant.h"
 
+// the stats of super tables are reported with one of every so many status messages
+#define DM_STB_STATS_REPORT_TIMES 30
+
 extern SConfig *tsCfg;
 
 static void dmUpdateDnodeCfg(SDnodeMgmt *pMgmt, SDnodeCfg *pCfg) {
@@ -98,6 +101,10 @@ void dmSendStatusReq(SDnodeMgmt *pMgmt) {
   pMgmt->statusSeq++;
   req.statusSeq = pMgmt->statusSeq;
 
+  if (req.statusSeq % DM_STB_STATS_REPORT_TIMES == 1) {
+    (*pMgmt->getStbStatsLoadsFp)(&req.pStbStats);
+  }
+
   int32_t contLen = tSerializeSStatusReq(NULL, 0, &req);
   void   *pHead = rpcMallocCont(contLen);
   tSerializeSStatusReq(pHead, contLen, &req);
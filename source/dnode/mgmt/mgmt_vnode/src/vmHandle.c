@@ -38,6 +38,25 @@ void vmGetVnodeLoads(SVnodeMgmt *pMgmt, SMonVloadInfo *pInfo, bool isReset) {
   taosThreadRwlockUnlock(&pMgmt->lock);
 }
 
+void vmGetStbStatsLoads(SVnodeMgmt *pMgmt, SArray **ppLoads) {
+  *ppLoads = taosArrayInit(pMgmt->state.totalVnodes, sizeof(SStbStatsLoad));
+  if (*ppLoads == NULL) return;
+
+  taosThreadRwlockRdlock(&pMgmt->lock);
+
+  // only the stats collected in the background are copied here
+  void *pIter = taosHashIterate(pMgmt->hash, NULL);
+  while (pIter) {
+    SVnodeObj **ppVnode = pIter;
+    if (ppVnode != NULL && *ppVnode != NULL) {
+      vnodeGetStbStatsLoad((*ppVnode)->pImpl, *ppLoads);
+    }
+    pIter = taosHashIterate(pMgmt->hash, pIter);
+  }
+
+  taosThreadRwlockUnlock(&pMgmt->lock);
+}
+
 void vmGetMonitorInfo(SVnodeMgmt *pMgmt, SMonVmInfo *pInfo) {
   SMonVloadInfo vloads = {0};
   vmGetVnodeLoads(pMgmt, &vloads, true);
@@ -101,6 +101,11 @@ typedef struct {
   int64_t timeseriesAllowed;
 } SGrantInfo;
 
+typedef struct {
+  TdThreadMutex lock;
+  SHashObj     *pStats;  // suid -> SArray<SStbStatsLoad>, reported by the leader of each vgroup
+} SStbStatsMgmt;
+
 typedef struct SMnode {
   int32_t        selfDnodeId;
   int64_t        clusterId;
@@ -124,6 +129,7 @@ typedef struct SMnode {
   STelemMgmt     telemMgmt;
   SSyncMgmt      syncMgmt;
   SGrantInfo     grant;
+  SStbStatsMgmt  stbStatsMgmt;
   MndMsgFp       msgFp[TDMT_MAX];
   SMsgCb         msgCb;
 } SMnode;
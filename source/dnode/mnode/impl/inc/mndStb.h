@@ -42,6 +42,12 @@ void mndExtractTbNameFromStbFullName(const char *stbFullName, char *dst, int32_t
 
 const char *mndGetStbStr(const char *src);
 
+int32_t      mndInitStbStats(SMnode *pMnode);
+void         mndCleanupStbStats(SMnode *pMnode);
+void         mndUpdateStbStats(SMnode *pMnode, SArray *pStbStats);
+void         mndDropStbStats(SMnode *pMnode, int64_t suid);
+STableStats *mndBuildStbStats(SMnode *pMnode, SStbObj *pStb);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,7 @@
 #include "mndQnode.h"
 #include "mndShow.h"
 #include "mndSnode.h"
+#include "mndStb.h"
 #include "mndTrans.h"
 #include "mndUser.h"
 #include "mndVgroup.h"
@@ -407,6 +408,8 @@ static int32_t mndProcessStatusReq(SRpcMsg *pReq) {
     mndReleaseVgroup(pMnode, pVgroup);
   }
 
+  mndUpdateStbStats(pMnode, statusReq.pStbStats);
+
   SMnodeObj *pObj = mndAcquireMnode(pMnode, pDnode->id);
   if (pObj != NULL) {
     if (pObj->syncState != statusReq.mload.syncState || pObj->syncRestore != statusReq.mload.syncRestore) {
@@ -497,7 +500,7 @@ static int32_t mndProcessStatusReq(SRpcMsg *pReq) {
 
 _OVER:
   mndReleaseDnode(pMnode, pDnode);
-  taosArrayDestroy(statusReq.pVloads);
+  tFreeSStatusReq(&statusReq);
   return code;
 }
 
@@ -45,6 +45,7 @@ static int32_t  mndProcessTableMetaReq(SRpcMsg *pReq);
 static int32_t  mndRetrieveStb(SRpcMsg *pReq, SShowObj *pShow, SSDataBlock *pBlock, int32_t rows);
 static void     mndCancelGetNextStb(SMnode *pMnode, void *pIter);
 static int32_t  mndProcessTableCfgReq(SRpcMsg *pReq);
+static void     mndFreeStbStatsLoads(void *p);
 static int32_t  mndAlterStbImp(SMnode *pMnode, SRpcMsg *pReq, SDbObj *pDb, SStbObj *pStb, bool needRsp,
                                void *alterOriData, int32_t alterOriDataLen);
 static int32_t  mndCheckColAndTagModifiable(SMnode *pMnode, const char *stbname, int64_t suid, col_id_t colId);
@@ -73,10 +74,146 @@ int32_t mndInitStb(SMnode *pMnode) {
   mndAddShowRetrieveHandle(pMnode, TSDB_MGMT_TABLE_STB, mndRetrieveStb);
   mndAddShowFreeIterHandle(pMnode, TSDB_MGMT_TABLE_STB, mndCancelGetNextStb);
 
+  if (mndInitStbStats(pMnode) != 0) {
+    return -1;
+  }
+
   return sdbSetTable(pMnode->pSdb, table);
 }
 
-void mndCleanupStb(SMnode *pMnode) {}
+void mndCleanupStb(SMnode *pMnode) { mndCleanupStbStats(pMnode); }
+
+int32_t mndInitStbStats(SMnode *pMnode) {
+  SStbStatsMgmt *pMgmt = &pMnode->stbStatsMgmt;
+  pMgmt->pStats = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, HASH_NO_LOCK);
+  if (pMgmt->pStats == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+  taosHashSetFreeFp(pMgmt->pStats, mndFreeStbStatsLoads);
+  taosThreadMutexInit(&pMgmt->lock, NULL);
+  return 0;
+}
+
+void mndCleanupStbStats(SMnode *pMnode) {
+  SStbStatsMgmt *pMgmt = &pMnode->stbStatsMgmt;
+  if (pMgmt->pStats != NULL) {
+    taosHashCleanup(pMgmt->pStats);
+    pMgmt->pStats = NULL;
+    taosThreadMutexDestroy(&pMgmt->lock);
+  }
+}
+
+static void mndFreeStbStatsLoads(void *p) { taosArrayDestroyEx(*(SArray **)p, tFreeSStbStatsLoad); }
+
+void mndUpdateStbStats(SMnode *pMnode, SArray *pStbStats) {
+  SStbStatsMgmt *pMgmt = &pMnode->stbStatsMgmt;
+  if (pMgmt->pStats == NULL) return;
+
+  taosThreadMutexLock(&pMgmt->lock);
+  for (int32_t i = 0; i < taosArrayGetSize(pStbStats); ++i) {
+    SStbStatsLoad *pLoad = taosArrayGet(pStbStats, i);
+
+    SArray **ppLoads = taosHashGet(pMgmt->pStats, &pLoad->suid, sizeof(pLoad->suid));
+    if (ppLoads == NULL) {
+      SArray *pLoads = taosArrayInit(1, sizeof(SStbStatsLoad));
+      if (pLoads == NULL) break;
+      if (taosHashPut(pMgmt->pStats, &pLoad->suid, sizeof(pLoad->suid), &pLoads, POINTER_BYTES) != 0) {
+        taosArrayDestroy(pLoads);
+        break;
+      }
+      ppLoads = taosHashGet(pMgmt->pStats, &pLoad->suid, sizeof(pLoad->suid));
+    }
+
+    // the load of a vgroup replaces its previous one, and the tag sketches are moved out of the request
+    SStbStatsLoad *pOld = NULL;
+    for (int32_t j = 0; j < taosArrayGetSize(*ppLoads); ++j) {
+      SStbStatsLoad *p = taosArrayGet(*ppLoads, j);
+      if (p->vgId == pLoad->vgId) {
+        pOld = p;
+        break;
+      }
+    }
+    if (pOld != NULL) {
+      tFreeSStbStatsLoad(pOld);
+      *pOld = *pLoad;
+    } else if (taosArrayPush(*ppLoads, pLoad) == NULL) {
+      continue;
+    }
+    pLoad->pTagSketches = NULL;
+  }
+  taosThreadMutexUnlock(&pMgmt->lock);
+}
+
+void mndDropStbStats(SMnode *pMnode, int64_t suid) {
+  SStbStatsMgmt *pMgmt = &pMnode->stbStatsMgmt;
+  if (pMgmt->pStats == NULL) return;
+
+  taosThreadMutexLock(&pMgmt->lock);
+  taosHashRemove(pMgmt->pStats, &suid, sizeof(suid));
+  taosThreadMutexUnlock(&pMgmt->lock);
+}
+
+// merge the loads of all the vgroups, the NDV of a tag is estimated from the union of its sketches
+STableStats *mndBuildStbStats(SMnode *pMnode, SStbObj *pStb) {
+  SStbStatsMgmt *pMgmt = &pMnode->stbStatsMgmt;
+  STableStats   *pStats = NULL;
+  if (pMgmt->pStats == NULL) return NULL;
+
+  taosThreadMutexLock(&pMgmt->lock);
+  SArray **ppLoads = taosHashGet(pMgmt->pStats, &pStb->uid, sizeof(pStb->uid));
+  if (ppLoads == NULL || taosArrayGetSize(*ppLoads) == 0) {
+    goto _OVER;
+  }
+
+  pStats = taosMemoryCalloc(1, sizeof(STableStats));
+  if (pStats == NULL) goto _OVER;
+  pStats->skey = TSKEY_MAX;
+  pStats->ekey = TSKEY_MIN;
+  pStats->pTagNdv = taosMemoryCalloc(pStb->numOfTags, sizeof(STagNdv));
+  uint8_t *pSketch = taosMemoryCalloc(1, HLL_SKETCH_REGISTERS);
+  if (pStats->pTagNdv == NULL || pSketch == NULL) {
+    taosMemoryFree(pSketch);
+    tFreeTableStats(pStats);
+    pStats = NULL;
+    goto _OVER;
+  }
+
+  for (int32_t i = 0; i < taosArrayGetSize(*ppLoads); ++i) {
+    SStbStatsLoad *pLoad = taosArrayGet(*ppLoads, i);
+    pStats->numOfTables += pLoad->numOfTables;
+    pStats->numOfRows += pLoad->numOfRows;
+    pStats->skey = TMIN(pStats->skey, pLoad->skey);
+    pStats->ekey = TMAX(pStats->ekey, pLoad->ekey);
+  }
+
+  for (int32_t t = 0; t < pStb->numOfTags; ++t) {
+    col_id_t colId = pStb->pTags[t].colId;
+    bool     found = false;
+    memset(pSketch, 0, HLL_SKETCH_REGISTERS);
+    for (int32_t i = 0; i < taosArrayGetSize(*ppLoads); ++i) {
+      SStbStatsLoad *pLoad = taosArrayGet(*ppLoads, i);
+      for (int32_t j = 0; j < taosArrayGetSize(pLoad->pTagSketches); ++j) {
+        STagSketch *pTagSketch = taosArrayGet(pLoad->pTagSketches, j);
+        if (pTagSketch->colId == colId) {
+          tHllMerge(pSketch, pTagSketch->sketch);
+          found = true;
+          break;
+        }
+      }
+    }
+    if (found) {
+      pStats->pTagNdv[pStats->numOfTags].colId = colId;
+      pStats->pTagNdv[pStats->numOfTags].ndv = tHllCount(pSketch);
+      ++pStats->numOfTags;
+    }
+  }
+  taosMemoryFree(pSketch);
+
+_OVER:
+  taosThreadMutexUnlock(&pMgmt->lock);
+  return pStats;
+}
 
 SSdbRaw *mndStbActionEncode(SStbObj *pStb) {
   terrno = TSDB_CODE_OUT_OF_MEMORY;
@@ -286,6 +423,7 @@ static int32_t mndStbActionInsert(SSdb *pSdb, SStbObj *pStb) {
 
 static int32_t mndStbActionDelete(SSdb *pSdb, SStbObj *pStb) {
   mTrace("stb:%s, perform delete action, row:%p", pStb->name, pStb);
+  mndDropStbStats(pSdb->pMnode, pStb->uid);
   mndFreeStb(pStb);
   return 0;
 }
@@ -1743,6 +1881,9 @@ static int32_t mndBuildStbCfg(SMnode *pMnode, const char *dbFName, const char *t
   }
 
   int32_t code = mndBuildStbCfgImp(pDb, pStb, tbName, pRsp);
+  if (code == 0) {
+    pRsp->pStats = mndBuildStbStats(pMnode, pStb);
+  }
 
   mndReleaseDb(pMnode, pDb);
   mndReleaseStb(pMnode, pStb);
@@ -1009,3 +1009,134 @@ TEST_F(MndTestSdb, 01_Read_Str) {
   ASSERT_EQ(mnode.insertTimes, 9);
   ASSERT_EQ(mnode.deleteTimes, 9);
 }
+
+TEST_F(MndTestSdb, 02_Write_Delta) {
+  SStrObj *pObj = NULL;
+  SI32Obj *pI32Obj = NULL;
+  SMnode   mnode = {0};
+  SSdb    *pSdb = NULL;
+  SSdbOpt  opt = {0};
+  SStrObj  strObj = {0};
+  SI32Obj  i32Obj = {0};
+  SSdbRaw *pRaw = NULL;
+  int64_t  index = 0, term = 0, config = 0;
+  char     file[PATH_MAX] = {0};
+
+  const char *path = TD_TMP_DIR_PATH "mnode_test_sdb_delta";
+  taosRemoveDir(path);
+  opt.pMnode = &mnode;
+  opt.path = path;
+
+  SSdbTable strTable1;
+  memset(&strTable1, 0, sizeof(SSdbTable));
+  strTable1.sdbType = SDB_USER;
+  strTable1.keyType = SDB_KEY_BINARY;
+  strTable1.deployFp = (SdbDeployFp)strDefault;
+  strTable1.encodeFp = (SdbEncodeFp)strEncode;
+  strTable1.decodeFp = (SdbDecodeFp)strDecode;
+  strTable1.insertFp = (SdbInsertFp)strInsert;
+  strTable1.updateFp = (SdbUpdateFp)strUpdate;
+  strTable1.deleteFp = (SdbDeleteFp)strDelete;
+
+  SSdbTable strTable2;
+  memset(&strTable2, 0, sizeof(SSdbTable));
+  strTable2.sdbType = SDB_VGROUP;
+  strTable2.keyType = SDB_KEY_INT32;
+  strTable2.encodeFp = (SdbEncodeFp)i32Encode;
+  strTable2.decodeFp = (SdbDecodeFp)i32Decode;
+  strTable2.insertFp = (SdbInsertFp)i32Insert;
+  strTable2.updateFp = (SdbUpdateFp)i32Update;
+  strTable2.deleteFp = (SdbDeleteFp)i32Delete;
+
+  pSdb = sdbInit(&opt);
+  mnode.pSdb = pSdb;
+  ASSERT_NE(pSdb, nullptr);
+  ASSERT_EQ(sdbSetTable(pSdb, strTable1), 0);
+  ASSERT_EQ(sdbSetTable(pSdb, strTable2), 0);
+  ASSERT_EQ(sdbDeploy(pSdb), 0);
+  sdbSetApplyInfo(pSdb, 1, 1, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+
+  // the rows changed after sdb.data is written go to the delta files
+  strSetDefault(&strObj, 1);
+  strObj.v8 = 11;
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  strSetDefault(&strObj, 2);
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_DROPPED);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  strSetDefault(&strObj, 3);
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  sdbSetApplyInfo(pSdb, 2, 1, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+
+  // created and dropped between two checkpoints
+  strSetDefault(&strObj, 4);
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+  strSetDefault(&strObj, 4);
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_DROPPED);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  i32SetDefault(&i32Obj, 1);
+  pRaw = i32Encode(&i32Obj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  sdbSetApplyInfo(pSdb, 3, 1, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+  ASSERT_EQ(pSdb->numOfDeltas, 2);
+  sdbCleanup(pSdb);
+
+  for (int32_t round = 0; round < 2; ++round) {
+    pSdb = sdbInit(&opt);
+    mnode.pSdb = pSdb;
+    ASSERT_NE(pSdb, nullptr);
+    ASSERT_EQ(sdbSetTable(pSdb, strTable1), 0);
+    ASSERT_EQ(sdbSetTable(pSdb, strTable2), 0);
+    ASSERT_EQ(sdbReadFile(pSdb), 0);
+    ASSERT_EQ(pSdb->numOfDeltas, round == 0 ? 2 : 0);
+
+    sdbGetCommitInfo(pSdb, &index, &term, &config);
+    ASSERT_EQ(index, 3);
+    ASSERT_EQ(sdbGetSize(pSdb, SDB_USER), 2);
+    ASSERT_EQ(sdbGetSize(pSdb, SDB_VGROUP), 1);
+
+    pObj = (SStrObj *)sdbAcquire(pSdb, SDB_USER, "k1000");
+    ASSERT_NE(pObj, nullptr);
+    ASSERT_EQ(pObj->v8, 11);
+    sdbRelease(pSdb, pObj);
+
+    ASSERT_EQ(sdbAcquire(pSdb, SDB_USER, "k2000"), nullptr);
+    ASSERT_EQ(sdbAcquire(pSdb, SDB_USER, "k4000"), nullptr);
+
+    pObj = (SStrObj *)sdbAcquire(pSdb, SDB_USER, "k3000");
+    ASSERT_NE(pObj, nullptr);
+    ASSERT_EQ(pObj->v32, 3000);
+    sdbRelease(pSdb, pObj);
+
+    int32_t key = 1;
+    pI32Obj = (SI32Obj *)sdbAcquire(pSdb, SDB_VGROUP, &key);
+    ASSERT_NE(pI32Obj, nullptr);
+    ASSERT_EQ(pI32Obj->v32, 1000);
+    sdbRelease(pSdb, pI32Obj);
+
+    // merge the delta files into sdb.data, the next round reads it only
+    if (round == 0) {
+      ASSERT_EQ(sdbMergeFile(pSdb), 0);
+      ASSERT_EQ(pSdb->numOfDeltas, 0);
+      snprintf(file, sizeof(file), "%s%sdata%ssdb.delta.1", path, TD_DIRSEP, TD_DIRSEP);
+      ASSERT_FALSE(taosCheckExistFile(file));
+    }
+    sdbCleanup(pSdb);
+  }
+}
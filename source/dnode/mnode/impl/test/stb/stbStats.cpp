@@ -0,0 +1,108 @@
+/**
+ * @file stbStats.cpp
+ * @brief MNODE module super table stats tests
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "mndStb.h"
+#include "thll.h"
+
+class MndTestStbStats : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(&mnode, 0, sizeof(mnode));
+    ASSERT_EQ(mndInitStbStats(&mnode), 0);
+
+    memset(&stb, 0, sizeof(stb));
+    stb.uid = 100;
+    stb.numOfTags = 2;
+    stb.pTags = tags;
+    tags[0].colId = 3;
+    tags[1].colId = 4;
+  }
+
+  void TearDown() override { mndCleanupStbStats(&mnode); }
+
+  // the load of a vgroup, with the tag colId having the values [from, to)
+  SStbStatsLoad buildLoad(int32_t vgId, int64_t suid, int64_t numOfRows, TSKEY skey, TSKEY ekey, col_id_t colId,
+                          int64_t from, int64_t to) {
+    SStbStatsLoad load = {.vgId = vgId, .suid = suid, .numOfTables = to - from, .numOfRows = numOfRows};
+    load.skey = skey;
+    load.ekey = ekey;
+    load.pTagSketches = taosArrayInit(1, sizeof(STagSketch));
+
+    STagSketch sketch = {.colId = colId};
+    for (int64_t v = from; v < to; v++) tHllAdd(sketch.sketch, &v, sizeof(v));
+    taosArrayPush(load.pTagSketches, &sketch);
+    return load;
+  }
+
+  // the loads of a status request, which are moved into the mnode
+  void update(const std::vector<SStbStatsLoad>& loads) {
+    SArray* pLoads = taosArrayInit(loads.size(), sizeof(SStbStatsLoad));
+    for (auto& load : loads) taosArrayPush(pLoads, &load);
+    mndUpdateStbStats(&mnode, pLoads);
+    for (int32_t i = 0; i < taosArrayGetSize(pLoads); ++i) {
+      EXPECT_EQ(((SStbStatsLoad*)taosArrayGet(pLoads, i))->pTagSketches, nullptr);
+    }
+    taosArrayDestroyEx(pLoads, tFreeSStbStatsLoad);
+  }
+
+  int64_t ndv(STableStats* pStats, col_id_t colId) {
+    for (int32_t i = 0; i < pStats->numOfTags; ++i) {
+      if (pStats->pTagNdv[i].colId == colId) return pStats->pTagNdv[i].ndv;
+    }
+    return -1;
+  }
+
+  SMnode  mnode;
+  SStbObj stb;
+  SSchema tags[2];
+};
+
+TEST_F(MndTestStbStats, 01_Merge_Vgroups) {
+  EXPECT_EQ(mndBuildStbStats(&mnode, &stb), nullptr);
+
+  // two vgroups, whose tag values partly overlap, and a load of another super table
+  update({buildLoad(2, 100, 1000, 10, 20, 3, 0, 60), buildLoad(3, 100, 500, 5, 15, 3, 40, 100),
+          buildLoad(2, 200, 7, 0, 1, 3, 0, 1)});
+
+  STableStats* pStats = mndBuildStbStats(&mnode, &stb);
+  ASSERT_NE(pStats, nullptr);
+  EXPECT_EQ(pStats->numOfTables, 120);
+  EXPECT_EQ(pStats->numOfRows, 1500);
+  EXPECT_EQ(pStats->skey, 5);
+  EXPECT_EQ(pStats->ekey, 20);
+
+  // the sketches are merged, the values in both vgroups are counted once
+  ASSERT_EQ(pStats->numOfTags, 1);
+  EXPECT_NEAR(ndv(pStats, 3), 100, 20);
+  EXPECT_EQ(ndv(pStats, 4), -1);
+  tFreeTableStats(pStats);
+}
+
+TEST_F(MndTestStbStats, 02_Replace_And_Drop) {
+  update({buildLoad(2, 100, 1000, 10, 20, 3, 0, 10), buildLoad(3, 100, 500, 5, 15, 4, 0, 10)});
+
+  // the next load of a vgroup replaces the previous one
+  update({buildLoad(2, 100, 3000, 10, 30, 3, 0, 50)});
+  STableStats* pStats = mndBuildStbStats(&mnode, &stb);
+  ASSERT_NE(pStats, nullptr);
+  EXPECT_EQ(pStats->numOfTables, 60);
+  EXPECT_EQ(pStats->numOfRows, 3500);
+  EXPECT_EQ(pStats->ekey, 30);
+  EXPECT_EQ(pStats->numOfTags, 2);
+  EXPECT_NEAR(ndv(pStats, 3), 50, 10);
+  EXPECT_NEAR(ndv(pStats, 4), 10, 3);
+  tFreeTableStats(pStats);
+
+  // the stats are gone with the super table
+  mndDropStbStats(&mnode, stb.uid);
+  EXPECT_EQ(mndBuildStbStats(&mnode, &stb), nullptr);
+}
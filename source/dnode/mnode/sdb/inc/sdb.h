@@ -189,6 +189,13 @@ typedef struct SSdb {
   SdbDeployFp    deployFps[SDB_MAX];
   SdbEncodeFp    encodeFps[SDB_MAX];
   SdbDecodeFp    decodeFps[SDB_MAX];
+  SHashObj      *dirtyObjs[SDB_MAX];  // key -> raw of the dropped row or NULL, rows changed since the last checkpoint
+  bool           fullWrite;           // the next checkpoint rewrites sdb.data instead of appending a delta file
+  int32_t        numOfDeltas;
+  int64_t        baseSize;
+  int64_t        deltaSize;
+  TdThread       mergeThread;
+  int8_t         merging;
   TdThreadMutex  filelock;
 } SSdb;
 
@@ -264,6 +271,14 @@ int32_t sdbReadFile(SSdb *pSdb);
  */
 int32_t sdbWriteFile(SSdb *pSdb, int32_t delta);
 
+/**
+ * @brief Merge the delta files into sdb.data.
+ *
+ * @param pSdb The sdb object.
+ * @return int32_t 0 for success, -1 for failure.
+ */
+int32_t sdbMergeFile(SSdb *pSdb);
+
 /**
  * @brief Parse and write raw data to sdb, then free the pRaw object
  *
@@ -403,6 +418,9 @@ const char *sdbTableName(ESdbType type);
 const char *sdbStatusName(ESdbStatus status);
 void        sdbPrintOper(SSdb *pSdb, SSdbRow *pRow, const char *oper);
 int32_t     sdbGetIdFromRaw(SSdb *pSdb, SSdbRaw *pRaw);
+int32_t     sdbGetkeySize(SSdb *pSdb, ESdbType type, const void *pKey);
+
+void sdbClearDirty(SSdb *pSdb, int32_t type);
 
 void sdbWriteLock(SSdb *pSdb, int32_t type);
 void sdbReadLock(SSdb *pSdb, int32_t type);
@@ -60,6 +60,7 @@ SSdb *sdbInit(SSdbOpt *pOption) {
   pSdb->commitIndex = -1;
   pSdb->commitTerm = -1;
   pSdb->commitConfig = -1;
+  pSdb->fullWrite = true;
   pSdb->pMnode = pOption->pMnode;
   taosThreadMutexInit(&pSdb->filelock, NULL);
   mInfo("sdb init success");
@@ -69,6 +70,11 @@ SSdb *sdbInit(SSdbOpt *pOption) {
 void sdbCleanup(SSdb *pSdb) {
   mInfo("start to cleanup sdb");
 
+  if (taosCheckPthreadValid(pSdb->mergeThread)) {
+    taosThreadJoin(pSdb->mergeThread, NULL);
+    taosThreadClear(&pSdb->mergeThread);
+  }
+
   sdbWriteFile(pSdb, 0);
 
   if (pSdb->currDir != NULL) {
@@ -100,8 +106,11 @@ void sdbCleanup(SSdb *pSdb) {
 
     taosHashClear(hash);
     taosHashCleanup(hash);
+    sdbClearDirty(pSdb, i);
+    taosHashCleanup(pSdb->dirtyObjs[i]);
     taosThreadRwlockDestroy(&pSdb->locks[i]);
     pSdb->hashObjs[i] = NULL;
+    pSdb->dirtyObjs[i] = NULL;
     memset(&pSdb->locks[i], 0, sizeof(pSdb->locks[i]));
 
     mInfo("sdb table:%s is cleaned up", sdbTableName(i));
@@ -138,8 +147,16 @@ int32_t sdbSetTable(SSdb *pSdb, SSdbTable table) {
     return -1;
   }
 
+  SHashObj *dirty = taosHashInit(64, taosGetDefaultHashFunction(hashType), true, HASH_NO_LOCK);
+  if (dirty == NULL) {
+    taosHashCleanup(hash);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
   pSdb->maxId[sdbType] = 0;
   pSdb->hashObjs[sdbType] = hash;
+  pSdb->dirtyObjs[sdbType] = dirty;
   mInfo("sdb table:%s is initialized", sdbTableName(sdbType));
 
   return 0;
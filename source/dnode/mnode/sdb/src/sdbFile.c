@@ -23,6 +23,23 @@
 #define SDB_RESERVE_SIZE 512
 #define SDB_FILE_VER     1
 
+// A checkpoint rewrites sdb.data only when there is no sdb.data yet or the rows changed can not be told, otherwise it
+// writes the rows changed since the last checkpoint to a new delta file sdb.delta.<n>. A delta file has the same
+// layout as sdb.data, except that it also holds the rows dropped. The delta files are merged into sdb.data by a
+// background thread when they grow too many or too large, which works on the files only and does not lock the tables.
+#define SDB_MERGE_DELTAS   64
+#define SDB_MERGE_MIN_SIZE (1024 * 1024)
+
+typedef struct {
+  int64_t applyIndex;
+  int64_t applyTerm;
+  int64_t applyConfig;
+  int64_t maxId[SDB_MAX];
+  int64_t tableVer[SDB_MAX];
+} SSdbFileHead;
+
+typedef int32_t (*SdbFileRawFp)(SSdb *pSdb, SSdbRaw *pRaw, void *param);
+
 static int32_t sdbDeployData(SSdb *pSdb) {
   mInfo("start to deploy sdb");
 
@@ -63,6 +80,7 @@ static void sdbResetData(SSdb *pSdb) {
     if (hash == NULL) continue;
 
     taosHashClear(pSdb->hashObjs[i]);
+    sdbClearDirty(pSdb, i);
     pSdb->tableVer[i] = 0;
     pSdb->maxId[i] = 0;
     mInfo("sdb:%s is reset", sdbTableName(i));
@@ -74,10 +92,44 @@ static void sdbResetData(SSdb *pSdb) {
   pSdb->commitIndex = -1;
   pSdb->commitTerm = -1;
   pSdb->commitConfig = -1;
+  pSdb->fullWrite = true;
+  pSdb->numOfDeltas = 0;
+  pSdb->baseSize = 0;
+  pSdb->deltaSize = 0;
   mInfo("sdb reset success");
 }
 
-static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
+static void sdbGetFileHead(SSdb *pSdb, SSdbFileHead *pHead) {
+  pHead->applyIndex = pSdb->applyIndex;
+  pHead->applyTerm = pSdb->applyTerm;
+  pHead->applyConfig = pSdb->applyConfig;
+  memcpy(pHead->maxId, pSdb->maxId, sizeof(pHead->maxId));
+  memcpy(pHead->tableVer, pSdb->tableVer, sizeof(pHead->tableVer));
+}
+
+static void sdbDeltaFileName(SSdb *pSdb, int32_t index, char *file, int32_t size) {
+  snprintf(file, size, "%s%ssdb.delta.%d", pSdb->currDir, TD_DIRSEP, index);
+}
+
+// remove the delta files from the last one, so that the ones left by a failure are always numbered from 1
+static int32_t sdbRemoveDeltaFiles(SSdb *pSdb) {
+  char file[PATH_MAX] = {0};
+
+  for (int32_t i = pSdb->numOfDeltas; i > 0; --i) {
+    sdbDeltaFileName(pSdb, i, file, sizeof(file));
+    if (taosRemoveFile(file) < 0 && errno != ENOENT) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      mError("failed to remove sdb file:%s since %s", file, terrstr());
+      return -1;
+    }
+    pSdb->numOfDeltas = i - 1;
+  }
+
+  pSdb->deltaSize = 0;
+  return 0;
+}
+
+static int32_t sdbReadFileHead(SSdbFileHead *pHead, TdFilePtr pFile) {
   int64_t sver = 0;
   int32_t ret = taosReadFile(pFile, &sver, sizeof(int64_t));
   if (ret < 0) {
@@ -93,7 +145,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
     return -1;
   }
 
-  ret = taosReadFile(pFile, &pSdb->applyIndex, sizeof(int64_t));
+  ret = taosReadFile(pFile, &pHead->applyIndex, sizeof(int64_t));
   if (ret < 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
@@ -103,7 +155,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
     return -1;
   }
 
-  ret = taosReadFile(pFile, &pSdb->applyTerm, sizeof(int64_t));
+  ret = taosReadFile(pFile, &pHead->applyTerm, sizeof(int64_t));
   if (ret < 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
@@ -113,7 +165,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
     return -1;
   }
 
-  ret = taosReadFile(pFile, &pSdb->applyConfig, sizeof(int64_t));
+  ret = taosReadFile(pFile, &pHead->applyConfig, sizeof(int64_t));
   if (ret < 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
@@ -135,7 +187,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
       return -1;
     }
     if (i < SDB_MAX) {
-      pSdb->maxId[i] = maxId;
+      pHead->maxId[i] = maxId;
     }
   }
 
@@ -151,7 +203,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
       return -1;
     }
     if (i < SDB_MAX) {
-      pSdb->tableVer[i] = ver;
+      pHead->tableVer[i] = ver;
     }
   }
 
@@ -169,24 +221,24 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
   return 0;
 }
 
-static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
+static int32_t sdbWriteFileHead(const SSdbFileHead *pHead, TdFilePtr pFile) {
   int64_t sver = SDB_FILE_VER;
   if (taosWriteFile(pFile, &sver, sizeof(int64_t)) != sizeof(int64_t)) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
 
-  if (taosWriteFile(pFile, &pSdb->applyIndex, sizeof(int64_t)) != sizeof(int64_t)) {
+  if (taosWriteFile(pFile, &pHead->applyIndex, sizeof(int64_t)) != sizeof(int64_t)) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
 
-  if (taosWriteFile(pFile, &pSdb->applyTerm, sizeof(int64_t)) != sizeof(int64_t)) {
+  if (taosWriteFile(pFile, &pHead->applyTerm, sizeof(int64_t)) != sizeof(int64_t)) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
 
-  if (taosWriteFile(pFile, &pSdb->applyConfig, sizeof(int64_t)) != sizeof(int64_t)) {
+  if (taosWriteFile(pFile, &pHead->applyConfig, sizeof(int64_t)) != sizeof(int64_t)) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
@@ -194,7 +246,7 @@ static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
   for (int32_t i = 0; i < SDB_TABLE_SIZE; ++i) {
     int64_t maxId = 0;
     if (i < SDB_MAX) {
-      maxId = pSdb->maxId[i];
+      maxId = pHead->maxId[i];
     }
     if (taosWriteFile(pFile, &maxId, sizeof(int64_t)) != sizeof(int64_t)) {
       terrno = TAOS_SYSTEM_ERROR(errno);
@@ -205,7 +257,7 @@ static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
   for (int32_t i = 0; i < SDB_TABLE_SIZE; ++i) {
     int64_t ver = 0;
     if (i < SDB_MAX) {
-      ver = pSdb->tableVer[i];
+      ver = pHead->tableVer[i];
     }
     if (taosWriteFile(pFile, &ver, sizeof(int64_t)) != sizeof(int64_t)) {
       terrno = TAOS_SYSTEM_ERROR(errno);
@@ -222,40 +274,36 @@ static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
   return 0;
 }
 
-static int32_t sdbReadFileImp(SSdb *pSdb) {
-  int64_t offset = 0;
-  int32_t code = 0;
-  int32_t readLen = 0;
-  int64_t ret = 0;
-  char    file[PATH_MAX] = {0};
-
-  snprintf(file, sizeof(file), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
-  mInfo("start to read sdb file:%s", file);
-
-  SSdbRaw *pRaw = taosMemoryMalloc(TSDB_MAX_MSG_SIZE + 100);
-  if (pRaw == NULL) {
-    terrno = TSDB_CODE_OUT_OF_MEMORY;
-    mError("failed read sdb file since %s", terrstr());
-    return -1;
-  }
-
-  TdFilePtr pFile = taosOpenFile(file, TD_FILE_READ);
-  if (pFile == NULL) {
-    taosMemoryFree(pRaw);
+// open the file and read its head, *ppFile is NULL if the file does not exist
+static int32_t sdbOpenFileHead(const char *file, TdFilePtr *ppFile, SSdbFileHead *pHead) {
+  *ppFile = taosOpenFile(file, TD_FILE_READ);
+  if (*ppFile == NULL) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     mDebug("failed to read sdb file:%s since %s", file, terrstr());
     return 0;
   }
 
-  if (sdbReadFileHead(pSdb, pFile) != 0) {
+  if (sdbReadFileHead(pHead, *ppFile) != 0) {
     mError("failed to read sdb file:%s head since %s", file, terrstr());
-    taosMemoryFree(pRaw);
-    taosCloseFile(&pFile);
+    taosCloseFile(ppFile);
     return -1;
   }
 
-  int64_t tableVer[SDB_MAX] = {0};
-  memcpy(tableVer, pSdb->tableVer, sizeof(tableVer));
+  return 0;
+}
+
+static int32_t sdbReadFileRaws(SSdb *pSdb, TdFilePtr pFile, const char *file, SdbFileRawFp fp, void *param) {
+  int32_t code = 0;
+  int32_t readLen = 0;
+  int32_t rawLen = TSDB_MAX_MSG_SIZE + 100;
+  int64_t ret = 0;
+
+  SSdbRaw *pRaw = taosMemoryMalloc(rawLen);
+  if (pRaw == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    mError("failed read sdb file since %s", terrstr());
+    return -1;
+  }
 
   while (1) {
     readLen = sizeof(SSdbRaw);
@@ -275,10 +323,10 @@ static int32_t sdbReadFileImp(SSdb *pSdb) {
     }
 
     readLen = pRaw->dataLen + sizeof(int32_t);
-    if (readLen >= pRaw->dataLen) {
+    if ((int64_t)sizeof(SSdbRaw) + readLen > rawLen) {
       SSdbRaw *pNewRaw = taosMemoryMalloc(pRaw->dataLen + TSDB_MAX_MSG_SIZE);
       if (pNewRaw == NULL) {
-        terrno = TSDB_CODE_OUT_OF_MEMORY;
+        code = TSDB_CODE_OUT_OF_MEMORY;
         mError("failed read sdb file since malloc new sdbRaw size:%d failed", pRaw->dataLen + TSDB_MAX_MSG_SIZE);
         goto _OVER;
       }
@@ -286,6 +334,7 @@ static int32_t sdbReadFileImp(SSdb *pSdb) {
       memcpy(pNewRaw, pRaw, sizeof(SSdbRaw));
       sdbFreeRaw(pRaw);
       pRaw = pNewRaw;
+      rawLen = pRaw->dataLen + TSDB_MAX_MSG_SIZE;
     }
 
     ret = taosReadFile(pFile, pRaw->pData, readLen);
@@ -308,7 +357,7 @@ static int32_t sdbReadFileImp(SSdb *pSdb) {
       goto _OVER;
     }
 
-    code = sdbWriteWithoutFree(pSdb, pRaw);
+    code = (*fp)(pSdb, pRaw, param);
     if (code != 0) {
       mError("failed to read sdb file:%s since %s", file, terrstr());
       goto _OVER;
@@ -316,29 +365,154 @@ static int32_t sdbReadFileImp(SSdb *pSdb) {
   }
 
   code = 0;
+
+_OVER:
+  sdbFreeRaw(pRaw);
+  terrno = code;
+  return code;
+}
+
+static int32_t sdbWriteRaw(TdFilePtr pFile, SSdbRaw *pRaw) {
+  int32_t writeLen = sizeof(SSdbRaw) + pRaw->dataLen;
+  if (taosWriteFile(pFile, pRaw, writeLen) != writeLen) {
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  int32_t cksum = taosCalcChecksum(0, (const uint8_t *)pRaw, writeLen);
+  if (taosWriteFile(pFile, &cksum, sizeof(int32_t)) != sizeof(int32_t)) {
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  return 0;
+}
+
+// sync and close the file written, then move it to the current one if code is 0
+static int32_t sdbFinishFile(TdFilePtr *ppFile, const char *tmpfile, const char *curfile, int32_t code,
+                             int64_t *pSize) {
+  if (code == 0) {
+    code = taosFsyncFile(*ppFile);
+    if (code != 0) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      mError("failed to sync sdb file:%s since %s", tmpfile, tstrerror(code));
+    }
+  }
+
+  if (code == 0 && taosFStatFile(*ppFile, pSize, NULL) != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+  }
+
+  taosCloseFile(ppFile);
+
+  if (code == 0) {
+    code = taosRenameFile(tmpfile, curfile);
+    if (code != 0) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      mError("failed to write sdb file:%s since %s", curfile, tstrerror(code));
+    }
+  }
+
+  return code;
+}
+
+static int32_t sdbApplyRaw(SSdb *pSdb, SSdbRaw *pRaw, void *param) {
+  bool    isDelta = *(bool *)param;
+  int32_t code = sdbWriteWithoutFree(pSdb, pRaw);
+
+  // a delta file also drops the rows created and dropped between two checkpoints, which were never written
+  if (code == TSDB_CODE_SDB_OBJ_NOT_THERE && isDelta && pRaw->status == SDB_STATUS_DROPPED) {
+    code = 0;
+  }
+
+  return code;
+}
+
+static int32_t sdbReadFileImp(SSdb *pSdb, const char *file, bool isDelta, bool *exist) {
+  int32_t      code = 0;
+  int64_t      size = 0;
+  TdFilePtr    pFile = NULL;
+  SSdbFileHead head = {0};
+
+  *exist = false;
+  mInfo("start to read sdb file:%s", file);
+
+  if (sdbOpenFileHead(file, &pFile, &head) != 0) {
+    return -1;
+  }
+  if (pFile == NULL) {
+    return 0;
+  }
+  *exist = true;
+
+  if (taosFStatFile(pFile, &size, NULL) != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to stat sdb file:%s since %s", file, tstrerror(code));
+    goto _OVER;
+  }
+
+  // left by a merge not finished, the rows are already in sdb.data
+  if (isDelta && head.applyIndex <= pSdb->applyIndex) {
+    mInfo("skip sdb file:%s, apply index:%" PRId64 " not after:%" PRId64, file, head.applyIndex, pSdb->applyIndex);
+    pSdb->deltaSize += size;
+    goto _OVER;
+  }
+
+  pSdb->applyIndex = head.applyIndex;
+  pSdb->applyTerm = head.applyTerm;
+  pSdb->applyConfig = head.applyConfig;
+  memcpy(pSdb->maxId, head.maxId, sizeof(head.maxId));
+
+  code = sdbReadFileRaws(pSdb, pFile, file, sdbApplyRaw, &isDelta);
+  if (code != 0) {
+    goto _OVER;
+  }
+
+  if (isDelta) {
+    pSdb->deltaSize += size;
+  } else {
+    pSdb->baseSize = size;
+  }
+
   pSdb->commitIndex = pSdb->applyIndex;
   pSdb->commitTerm = pSdb->applyTerm;
   pSdb->commitConfig = pSdb->applyConfig;
-  memcpy(pSdb->tableVer, tableVer, sizeof(tableVer));
+  memcpy(pSdb->tableVer, head.tableVer, sizeof(head.tableVer));
   mInfo("read sdb file:%s success, commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64, file, pSdb->commitIndex,
         pSdb->commitTerm, pSdb->commitConfig);
 
 _OVER:
   taosCloseFile(&pFile);
-  sdbFreeRaw(pRaw);
 
   terrno = code;
   return code;
 }
 
 int32_t sdbReadFile(SSdb *pSdb) {
+  char file[PATH_MAX] = {0};
+  bool exist = false;
+
   taosThreadMutexLock(&pSdb->filelock);
 
   sdbResetData(pSdb);
-  int32_t code = sdbReadFileImp(pSdb);
+  snprintf(file, sizeof(file), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
+  int32_t code = sdbReadFileImp(pSdb, file, false, &exist);
+  if (code == 0 && exist) {
+    pSdb->fullWrite = false;
+    for (int32_t i = 1; code == 0; ++i) {
+      sdbDeltaFileName(pSdb, i, file, sizeof(file));
+      code = sdbReadFileImp(pSdb, file, true, &exist);
+      if (!exist) break;
+      pSdb->numOfDeltas = i;
+    }
+  }
+
   if (code != 0) {
     mError("failed to read sdb file since %s", terrstr());
     sdbResetData(pSdb);
+  } else {
+    // the rows read are all in the files already
+    for (ESdbType i = 0; i < SDB_MAX; ++i) {
+      sdbClearDirty(pSdb, i);
+    }
   }
 
   taosThreadMutexUnlock(&pSdb->filelock);
@@ -346,7 +520,9 @@ int32_t sdbReadFile(SSdb *pSdb) {
 }
 
 static int32_t sdbWriteFileImp(SSdb *pSdb) {
-  int32_t code = 0;
+  int32_t      code = 0;
+  int64_t      size = 0;
+  SSdbFileHead head = {0};
 
   char tmpfile[PATH_MAX] = {0};
   snprintf(tmpfile, sizeof(tmpfile), "%s%ssdb.data", pSdb->tmpDir, TD_DIRSEP);
@@ -365,7 +541,8 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
     return -1;
   }
 
-  if (sdbWriteFileHead(pSdb, pFile) != 0) {
+  sdbGetFileHead(pSdb, &head);
+  if (sdbWriteFileHead(&head, pFile) != 0) {
     mError("failed to write sdb file:%s head since %s", tmpfile, terrstr());
     taosCloseFile(&pFile);
     return -1;
@@ -399,17 +576,8 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
       SSdbRaw *pRaw = (*encodeFp)(pRow->pObj);
       if (pRaw != NULL) {
         pRaw->status = pRow->status;
-        int32_t writeLen = sizeof(SSdbRaw) + pRaw->dataLen;
-        if (taosWriteFile(pFile, pRaw, writeLen) != writeLen) {
-          code = TAOS_SYSTEM_ERROR(errno);
-          taosHashCancelIterate(hash, ppRow);
-          sdbFreeRaw(pRaw);
-          break;
-        }
-
-        int32_t cksum = taosCalcChecksum(0, (const uint8_t *)pRaw, sizeof(SSdbRaw) + pRaw->dataLen);
-        if (taosWriteFile(pFile, &cksum, sizeof(int32_t)) != sizeof(int32_t)) {
-          code = TAOS_SYSTEM_ERROR(errno);
+        code = sdbWriteRaw(pFile, pRaw);
+        if (code != 0) {
           taosHashCancelIterate(hash, ppRow);
           sdbFreeRaw(pRaw);
           break;
@@ -423,41 +591,321 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
       sdbFreeRaw(pRaw);
       ppRow = taosHashIterate(hash, ppRow);
     }
+    sdbClearDirty(pSdb, i);
     sdbUnLock(pSdb, i);
   }
 
-  if (code == 0) {
-    code = taosFsyncFile(pFile);
-    if (code != 0) {
-      code = TAOS_SYSTEM_ERROR(errno);
-      mError("failed to sync sdb file:%s since %s", tmpfile, tstrerror(code));
-    }
+  code = sdbFinishFile(&pFile, tmpfile, curfile, code, &size);
+
+  if (code != 0) {
+    mError("failed to write sdb file:%s since %s", curfile, tstrerror(code));
+  } else {
+    pSdb->commitIndex = pSdb->applyIndex;
+    pSdb->commitTerm = pSdb->applyTerm;
+    pSdb->commitConfig = pSdb->applyConfig;
+    pSdb->fullWrite = false;
+    pSdb->baseSize = size;
+    (void)sdbRemoveDeltaFiles(pSdb);
+    mInfo("write sdb file success, commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64 " file:%s",
+          pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig, curfile);
   }
 
-  taosCloseFile(&pFile);
+  terrno = code;
+  return code;
+}
 
-  if (code == 0) {
-    code = taosRenameFile(tmpfile, curfile);
-    if (code != 0) {
-      code = TAOS_SYSTEM_ERROR(errno);
-      mError("failed to write sdb file:%s since %s", curfile, tstrerror(code));
+static int32_t sdbWriteDeltaImp(SSdb *pSdb) {
+  int32_t      code = 0;
+  int64_t      size = 0;
+  int32_t      numOfRows = 0;
+  SSdbFileHead head = {0};
+
+  char tmpfile[PATH_MAX] = {0};
+  snprintf(tmpfile, sizeof(tmpfile), "%s%ssdb.delta", pSdb->tmpDir, TD_DIRSEP);
+  char curfile[PATH_MAX] = {0};
+  sdbDeltaFileName(pSdb, pSdb->numOfDeltas + 1, curfile, sizeof(curfile));
+
+  mInfo("start to write sdb delta file, apply index:%" PRId64 " term:%" PRId64 " config:%" PRId64
+        ", commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64 ", file:%s",
+        pSdb->applyIndex, pSdb->applyTerm, pSdb->applyConfig, pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig,
+        curfile);
+
+  TdFilePtr pFile = taosOpenFile(tmpfile, TD_FILE_CREATE | TD_FILE_WRITE | TD_FILE_TRUNC);
+  if (pFile == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to open sdb file:%s for write since %s", tmpfile, terrstr());
+    return -1;
+  }
+
+  sdbGetFileHead(pSdb, &head);
+  if (sdbWriteFileHead(&head, pFile) != 0) {
+    mError("failed to write sdb file:%s head since %s", tmpfile, terrstr());
+    taosCloseFile(&pFile);
+    return -1;
+  }
+
+  for (int32_t i = SDB_MAX - 1; i >= 0 && code == 0; --i) {
+    SdbEncodeFp encodeFp = pSdb->encodeFps[i];
+    SHashObj   *dirty = pSdb->dirtyObjs[i];
+    if (encodeFp == NULL || dirty == NULL) continue;
+
+    SHashObj *hash = pSdb->hashObjs[i];
+    sdbWriteLock(pSdb, i);
+
+    SSdbRaw **ppRaw = taosHashIterate(dirty, NULL);
+    while (ppRaw != NULL) {
+      SSdbRaw *pRaw = *ppRaw;  // the raw of the row dropped
+      if (pRaw != NULL) {
+        code = sdbWriteRaw(pFile, pRaw);
+      } else {
+        size_t    keyLen = 0;
+        void     *pKey = taosHashGetKey(ppRaw, &keyLen);
+        SSdbRow **ppRow = taosHashGet(hash, pKey, keyLen);
+        if (ppRow == NULL || *ppRow == NULL) {
+          ppRaw = taosHashIterate(dirty, ppRaw);
+          continue;
+        }
+
+        SSdbRow *pRow = *ppRow;
+        sdbPrintOper(pSdb, pRow, "write");
+        pRaw = (*encodeFp)(pRow->pObj);
+        if (pRaw == NULL) {
+          code = TSDB_CODE_APP_ERROR;
+        } else {
+          // sdb.data only keeps the rows ready or dropping, so are the files merged
+          if (pRow->status == SDB_STATUS_READY || pRow->status == SDB_STATUS_DROPPING) {
+            pRaw->status = pRow->status;
+          } else {
+            pRaw->status = SDB_STATUS_DROPPED;
+          }
+          code = sdbWriteRaw(pFile, pRaw);
+          sdbFreeRaw(pRaw);
+        }
+      }
+
+      if (code != 0) {
+        taosHashCancelIterate(dirty, ppRaw);
+        break;
+      }
+
+      numOfRows++;
+      ppRaw = taosHashIterate(dirty, ppRaw);
     }
+
+    sdbClearDirty(pSdb, i);
+    sdbUnLock(pSdb, i);
   }
 
+  code = sdbFinishFile(&pFile, tmpfile, curfile, code, &size);
+
   if (code != 0) {
+    // the rows changed are lost with the delta not written
+    pSdb->fullWrite = true;
     mError("failed to write sdb file:%s since %s", curfile, tstrerror(code));
   } else {
     pSdb->commitIndex = pSdb->applyIndex;
     pSdb->commitTerm = pSdb->applyTerm;
     pSdb->commitConfig = pSdb->applyConfig;
-    mInfo("write sdb file success, commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64 " file:%s",
-          pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig, curfile);
+    pSdb->numOfDeltas++;
+    pSdb->deltaSize += size;
+    mInfo("write sdb delta file success, %d rows, commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64
+          " file:%s",
+          numOfRows, pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig, curfile);
+  }
+
+  terrno = code;
+  return code;
+}
+
+typedef struct {
+  SHashObj *rows[SDB_MAX];  // key -> raw
+} SSdbMerger;
+
+static int32_t sdbMergeRaw(SSdb *pSdb, SSdbRaw *pRaw, void *param) {
+  SSdbMerger *pMerger = param;
+
+  if (pRaw->type < 0 || pRaw->type >= SDB_MAX || pMerger->rows[pRaw->type] == NULL) {
+    return TSDB_CODE_SDB_INVALID_TABLE_TYPE;
+  }
+
+  SdbDecodeFp decodeFp = pSdb->decodeFps[pRaw->type];
+  SSdbRow    *pRow = (*decodeFp)(pRaw);
+  if (pRow == NULL) return terrno;
+  pRow->type = pRaw->type;
+
+  SHashObj *rows = pMerger->rows[pRaw->type];
+  int32_t   keySize = sdbGetkeySize(pSdb, pRow->type, pRow->pObj);
+  int32_t   code = 0;
+
+  SSdbRaw **ppOld = taosHashGet(rows, pRow->pObj, keySize);
+  if (ppOld != NULL) {
+    sdbFreeRaw(*ppOld);
+    taosHashRemove(rows, pRow->pObj, keySize);
+  }
+
+  if (pRaw->status != SDB_STATUS_DROPPED) {
+    int32_t  size = sizeof(SSdbRaw) + pRaw->dataLen;
+    SSdbRaw *pCopy = taosMemoryMalloc(size);
+    if (pCopy == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    } else {
+      memcpy(pCopy, pRaw, size);
+      if (taosHashPut(rows, pRow->pObj, keySize, &pCopy, sizeof(SSdbRaw *)) != 0) {
+        sdbFreeRaw(pCopy);
+        code = TSDB_CODE_OUT_OF_MEMORY;
+      }
+    }
+  }
+
+  sdbFreeRow(pSdb, pRow, false);
+  return code;
+}
+
+static int32_t sdbMergeFileImp(SSdb *pSdb) {
+  int32_t      code = 0;
+  int64_t      size = 0;
+  TdFilePtr    pFile = NULL;
+  SSdbFileHead head = {0};
+  SSdbFileHead deltaHead = {0};
+  SSdbMerger   merger = {0};
+
+  if (pSdb->numOfDeltas == 0) {
+    return 0;
+  }
+
+  char tmpfile[PATH_MAX] = {0};
+  snprintf(tmpfile, sizeof(tmpfile), "%s%ssdb.data", pSdb->tmpDir, TD_DIRSEP);
+  char curfile[PATH_MAX] = {0};
+  snprintf(curfile, sizeof(curfile), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
+  char file[PATH_MAX] = {0};
+
+  mInfo("start to merge %d sdb delta files of %" PRId64 " bytes into sdb file of %" PRId64 " bytes", pSdb->numOfDeltas,
+        pSdb->deltaSize, pSdb->baseSize);
+
+  for (int32_t i = 0; i < SDB_MAX; ++i) {
+    if (pSdb->decodeFps[i] == NULL) continue;
+    merger.rows[i] = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+    if (merger.rows[i] == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      goto _OVER;
+    }
+  }
+
+  code = sdbOpenFileHead(curfile, &pFile, &head);
+  if (code == 0 && pFile == NULL) {
+    code = terrno;
+  }
+  if (code == 0) {
+    code = sdbReadFileRaws(pSdb, pFile, curfile, sdbMergeRaw, &merger);
+  }
+  taosCloseFile(&pFile);
+  if (code != 0) goto _OVER;
+
+  for (int32_t i = 1; i <= pSdb->numOfDeltas; ++i) {
+    sdbDeltaFileName(pSdb, i, file, sizeof(file));
+    code = sdbOpenFileHead(file, &pFile, &deltaHead);
+    if (code == 0 && pFile == NULL) {
+      code = terrno;
+    }
+    if (code == 0 && deltaHead.applyIndex > head.applyIndex) {
+      head = deltaHead;
+      code = sdbReadFileRaws(pSdb, pFile, file, sdbMergeRaw, &merger);
+    }
+    taosCloseFile(&pFile);
+    if (code != 0) goto _OVER;
+  }
+
+  pFile = taosOpenFile(tmpfile, TD_FILE_CREATE | TD_FILE_WRITE | TD_FILE_TRUNC);
+  if (pFile == NULL) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to open sdb file:%s for write since %s", tmpfile, tstrerror(code));
+    goto _OVER;
+  }
+
+  if (sdbWriteFileHead(&head, pFile) != 0) {
+    code = terrno;
+  }
+
+  for (int32_t i = SDB_MAX - 1; i >= 0 && code == 0; --i) {
+    if (merger.rows[i] == NULL) continue;
+
+    SSdbRaw **ppRaw = taosHashIterate(merger.rows[i], NULL);
+    while (ppRaw != NULL) {
+      code = sdbWriteRaw(pFile, *ppRaw);
+      if (code != 0) {
+        taosHashCancelIterate(merger.rows[i], ppRaw);
+        break;
+      }
+      ppRaw = taosHashIterate(merger.rows[i], ppRaw);
+    }
+  }
+
+  code = sdbFinishFile(&pFile, tmpfile, curfile, code, &size);
+  if (code != 0) goto _OVER;
+
+  pSdb->baseSize = size;
+  (void)sdbRemoveDeltaFiles(pSdb);
+  mInfo("merge sdb delta files success, apply index:%" PRId64 " file:%s size:%" PRId64, head.applyIndex, curfile, size);
+
+_OVER:
+  if (code != 0) {
+    mError("failed to merge sdb delta files since %s", tstrerror(code));
+  }
+
+  for (int32_t i = 0; i < SDB_MAX; ++i) {
+    if (merger.rows[i] == NULL) continue;
+
+    SSdbRaw **ppRaw = taosHashIterate(merger.rows[i], NULL);
+    while (ppRaw != NULL) {
+      sdbFreeRaw(*ppRaw);
+      ppRaw = taosHashIterate(merger.rows[i], ppRaw);
+    }
+    taosHashCleanup(merger.rows[i]);
   }
 
   terrno = code;
   return code;
 }
 
+int32_t sdbMergeFile(SSdb *pSdb) {
+  taosThreadMutexLock(&pSdb->filelock);
+  int32_t code = sdbMergeFileImp(pSdb);
+  taosThreadMutexUnlock(&pSdb->filelock);
+  return code;
+}
+
+static bool sdbNeedMerge(SSdb *pSdb) {
+  if (pSdb->numOfDeltas >= SDB_MERGE_DELTAS) return true;
+  return pSdb->deltaSize >= SDB_MERGE_MIN_SIZE && pSdb->deltaSize >= pSdb->baseSize / 2;
+}
+
+static void *sdbMergeThreadFp(void *param) {
+  SSdb *pSdb = param;
+  setThreadName("sdb-merge");
+
+  (void)sdbMergeFile(pSdb);
+  atomic_store_8(&pSdb->merging, 0);
+  return NULL;
+}
+
+static void sdbStartMerge(SSdb *pSdb) {
+  if (atomic_val_compare_exchange_8(&pSdb->merging, 0, 1) != 0) return;
+
+  if (taosCheckPthreadValid(pSdb->mergeThread)) {
+    taosThreadJoin(pSdb->mergeThread, NULL);
+    taosThreadClear(&pSdb->mergeThread);
+  }
+
+  TdThreadAttr thAttr;
+  taosThreadAttrInit(&thAttr);
+  taosThreadAttrSetDetachState(&thAttr, PTHREAD_CREATE_JOINABLE);
+  if (taosThreadCreate(&pSdb->mergeThread, &thAttr, sdbMergeThreadFp, pSdb) != 0) {
+    mError("failed to create sdb merge thread since %s", strerror(errno));
+    atomic_store_8(&pSdb->merging, 0);
+  }
+  taosThreadAttrDestroy(&thAttr);
+}
+
 int32_t sdbWriteFile(SSdb *pSdb, int32_t delta) {
   int32_t code = 0;
   if (pSdb->applyIndex == pSdb->commitIndex) {
@@ -468,7 +916,15 @@ int32_t sdbWriteFile(SSdb *pSdb, int32_t delta) {
     return 0;
   }
 
-  taosThreadMutexLock(&pSdb->filelock);
+  if (delta > 0) {
+    // the delta files are being merged, take the checkpoint the next time
+    if (taosThreadMutexTryLock(&pSdb->filelock) != 0) {
+      return 0;
+    }
+  } else {
+    taosThreadMutexLock(&pSdb->filelock);
+  }
+
   if (pSdb->pWal != NULL) {
     // code = walBeginSnapshot(pSdb->pWal, pSdb->applyIndex);
     if (pSdb->sync == 0) {
@@ -478,7 +934,7 @@ int32_t sdbWriteFile(SSdb *pSdb, int32_t delta) {
     }
   }
   if (code == 0) {
-    code = sdbWriteFileImp(pSdb);
+    code = pSdb->fullWrite ? sdbWriteFileImp(pSdb) : sdbWriteDeltaImp(pSdb);
   }
   if (code == 0) {
     if (pSdb->pWal != NULL) {
@@ -494,7 +950,13 @@ int32_t sdbWriteFile(SSdb *pSdb, int32_t delta) {
   if (code != 0) {
     mError("failed to write sdb file since %s", terrstr());
   }
+
+  bool merge = (code == 0) && sdbNeedMerge(pSdb);
   taosThreadMutexUnlock(&pSdb->filelock);
+
+  if (merge) {
+    sdbStartMerge(pSdb);
+  }
   return code;
 }
 
@@ -555,6 +1017,12 @@ int32_t sdbStartRead(SSdb *pSdb, SSdbIter **ppIter, int64_t *index, int64_t *ter
   snprintf(datafile, sizeof(datafile), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
 
   taosThreadMutexLock(&pSdb->filelock);
+  if (pSdb->numOfDeltas > 0 && sdbMergeFileImp(pSdb) != 0) {
+    taosThreadMutexUnlock(&pSdb->filelock);
+    mError("failed to merge sdb file to read snapshot since %s", terrstr());
+    sdbCloseIter(pIter);
+    return -1;
+  }
   int64_t commitIndex = pSdb->commitIndex;
   int64_t commitTerm = pSdb->commitTerm;
   int64_t commitConfig = pSdb->commitConfig;
@@ -653,12 +1121,24 @@ int32_t sdbStopWrite(SSdb *pSdb, SSdbIter *pIter, bool isApply, int64_t index, i
 
   char datafile[PATH_MAX] = {0};
   snprintf(datafile, sizeof(datafile), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
+
+  // the delta files belong to the sdb.data replaced
+  taosThreadMutexLock(&pSdb->filelock);
+  if (sdbRemoveDeltaFiles(pSdb) != 0) {
+    taosThreadMutexUnlock(&pSdb->filelock);
+    mError("sdbiter:%p, failed to remove sdb delta files since %s", pIter, terrstr());
+    sdbCloseIter(pIter);
+    return -1;
+  }
+
   if (taosRenameFile(pIter->name, datafile) != 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
+    taosThreadMutexUnlock(&pSdb->filelock);
     mError("sdbiter:%p, failed to rename file %s to %s since %s", pIter, pIter->name, datafile, terrstr());
     sdbCloseIter(pIter);
     return -1;
   }
+  taosThreadMutexUnlock(&pSdb->filelock);
 
   if (sdbReadFile(pSdb) != 0) {
     mError("sdbiter:%p, failed to read from %s since %s", pIter, datafile, terrstr());
@@ -115,7 +115,7 @@ static SHashObj *sdbGetHash(SSdb *pSdb, int32_t type) {
   return hash;
 }
 
-static int32_t sdbGetkeySize(SSdb *pSdb, ESdbType type, const void *pKey) {
+int32_t sdbGetkeySize(SSdb *pSdb, ESdbType type, const void *pKey) {
   int32_t  keySize = 0;
   EKeyType keyType = pSdb->keyTypes[type];
 
@@ -130,6 +130,45 @@ static int32_t sdbGetkeySize(SSdb *pSdb, ESdbType type, const void *pKey) {
   return keySize;
 }
 
+void sdbClearDirty(SSdb *pSdb, int32_t type) {
+  SHashObj *dirty = pSdb->dirtyObjs[type];
+  if (dirty == NULL) return;
+
+  SSdbRaw **ppRaw = taosHashIterate(dirty, NULL);
+  while (ppRaw != NULL) {
+    sdbFreeRaw(*ppRaw);
+    ppRaw = taosHashIterate(dirty, ppRaw);
+  }
+  taosHashClear(dirty);
+}
+
+// record the row changed since the last checkpoint with the write lock of the table held, pRaw is the raw of the row
+// if it is dropped
+static void sdbSetDirty(SSdb *pSdb, int32_t type, const void *pKey, int32_t keySize, SSdbRaw *pRaw) {
+  SHashObj *dirty = pSdb->dirtyObjs[type];
+  if (dirty == NULL) return;
+
+  SSdbRaw *pCopy = NULL;
+  if (pRaw != NULL) {
+    int32_t size = sizeof(SSdbRaw) + pRaw->dataLen;
+    pCopy = taosMemoryMalloc(size);
+    if (pCopy == NULL) {
+      pSdb->fullWrite = true;
+      return;
+    }
+    memcpy(pCopy, pRaw, size);
+  }
+
+  SSdbRaw **ppOld = taosHashGet(dirty, pKey, keySize);
+  if (ppOld != NULL) {
+    sdbFreeRaw(*ppOld);
+    *ppOld = pCopy;
+  } else if (taosHashPut(dirty, pKey, keySize, &pCopy, sizeof(SSdbRaw *)) != 0) {
+    sdbFreeRaw(pCopy);
+    pSdb->fullWrite = true;
+  }
+}
+
 static int32_t sdbInsertRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *pRow, int32_t keySize) {
   int32_t type = pRow->type;
   sdbWriteLock(pSdb, type);
@@ -167,6 +206,7 @@ static int32_t sdbInsertRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *
     }
   }
 
+  sdbSetDirty(pSdb, type, pRow->pObj, keySize, NULL);
   sdbUnLock(pSdb, type);
 
   if (pSdb->keyTypes[pRow->type] == SDB_KEY_INT32) {
@@ -201,6 +241,11 @@ static int32_t sdbUpdateRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *
     code = (*updateFp)(pSdb, pOldRow->pObj, pNewRow->pObj);
   }
 
+  // marked after the object is updated, so that a checkpoint never takes the change without the new object
+  sdbWriteLock(pSdb, type);
+  sdbSetDirty(pSdb, type, pOldRow->pObj, keySize, NULL);
+  sdbUnLock(pSdb, type);
+
   // sdbUnLock(pSdb, type);
   sdbFreeRow(pSdb, pNewRow, false);
 
@@ -225,6 +270,7 @@ static int32_t sdbDeleteRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *
   atomic_add_fetch_32(&pOldRow->refCount, 1);
   sdbPrintOper(pSdb, pOldRow, "delete");
 
+  sdbSetDirty(pSdb, type, pOldRow->pObj, keySize, pRaw);
   taosHashRemove(hash, pOldRow->pObj, keySize);
   pSdb->tableVer[pOldRow->type]++;
   sdbUnLock(pSdb, type);
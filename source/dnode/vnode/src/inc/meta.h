@@ -73,6 +73,12 @@ int32_t metaStatsCacheGet(SMeta* pMeta, int64_t uid, SMetaStbStats* pInfo);
 void    metaUpdateStbStats(SMeta* pMeta, int64_t uid, int64_t delta);
 int32_t metaUidFilterCacheGet(SMeta* pMeta, uint64_t suid, const void* pKey, int32_t keyLen, LRUHandle** pHandle);
 
+int32_t metaTagSketchAdd(SArray* aSketch, const STag* pTag);
+int32_t metaTagSketchCacheGet(SMeta* pMeta, tb_uid_t suid, SArray* aSketch);
+int32_t metaTagSketchCachePut(SMeta* pMeta, tb_uid_t suid, SArray* aSketch);
+void    metaTagSketchCacheUpdate(SMeta* pMeta, tb_uid_t suid, const STag* pTag);
+void    metaTagSketchCacheDrop(SMeta* pMeta, tb_uid_t suid);
+
 struct SMeta {
   TdThreadRwlock lock;
 
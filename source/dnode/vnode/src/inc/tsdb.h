@@ -69,6 +69,11 @@ typedef struct SDiskCol         SDiskCol;
 typedef struct SDiskData        SDiskData;
 typedef struct SDiskDataBuilder SDiskDataBuilder;
 typedef struct SBlkInfo         SBlkInfo;
+typedef struct STsdbMigrator    STsdbMigrator;
+typedef struct STsdbCacheFile   STsdbCacheFile;
+typedef struct STsdbCacheCkpt   STsdbCacheCkpt;
+typedef struct STsdbColCache    STsdbColCache;
+typedef struct STsdbStats       STsdbStats;
 
 #define TSDB_FILE_DLMT     ((uint32_t)0xF00AFA0F)
 #define TSDB_MAX_SUBBLOCKS 8
@@ -210,6 +215,9 @@ STbData *tsdbGetTbDataFromMemTable(SMemTable *pMemTable, tb_uid_t suid, tb_uid_t
 void     tsdbRefMemTable(SMemTable *pMemTable);
 void     tsdbUnrefMemTable(SMemTable *pMemTable);
 SArray  *tsdbMemTableGetTbDataArray(SMemTable *pMemTable);
+int64_t  tsdbMemTableGetStbNRow(SMemTable *pMemTable, tb_uid_t suid);
+int64_t  tsdbMemTableDropTbNRow(SMemTable *pMemTable, tb_uid_t uid);
+void     tsdbMemTableDropStbNRow(SMemTable *pMemTable, tb_uid_t suid);
 // STbDataIter
 int32_t tsdbTbDataIterCreate(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDataIter **ppIter);
 void   *tsdbTbDataIterDestroy(STbDataIter *pIter);
@@ -243,6 +251,7 @@ int32_t tsdbFSClose(STsdb *pTsdb);
 int32_t tsdbFSCopy(STsdb *pTsdb, STsdbFS *pFS);
 void    tsdbFSDestroy(STsdbFS *pFS);
 int32_t tDFileSetCmprFn(const void *p1, const void *p2);
+bool    tDFileSetIsSame(SDFileSet *pSet1, SDFileSet *pSet2);
 int32_t tsdbFSCommit(STsdb *pTsdb);
 int32_t tsdbFSRollback(STsdb *pTsdb);
 int32_t tsdbFSPrepareCommit(STsdb *pTsdb, STsdbFS *pFS);
@@ -263,7 +272,6 @@ int32_t tsdbWriteBlockData(SDataFWriter *pWriter, SBlockData *pBlockData, SBlock
                            int8_t cmprAlg, int8_t toLast);
 int32_t tsdbWriteDiskData(SDataFWriter *pWriter, const SDiskData *pDiskData, SBlockInfo *pBlkInfo, SSmaInfo *pSmaInfo);
 
-int32_t tsdbDFileSetCopy(STsdb *pTsdb, SDFileSet *pSetFrom, SDFileSet *pSetTo);
 // SDataFReader
 int32_t tsdbDataFReaderOpen(SDataFReader **ppReader, STsdb *pTsdb, SDFileSet *pSet);
 int32_t tsdbDataFReaderClose(SDataFReader **ppReader);
@@ -290,6 +298,16 @@ int32_t tsdbTakeReadSnap(STsdb *pTsdb, STsdbReadSnap **ppSnap, const char *id);
 void    tsdbUntakeReadSnap(STsdb *pTsdb, STsdbReadSnap *pSnap, const char *id);
 // tsdbMerge.c ==============================================================================================
 int32_t tsdbMerge(STsdb *pTsdb);
+// tsdbRetention.c ==============================================================================================
+void tsdbStopMigration(STsdb *pTsdb);
+// tsdbStats.c ==============================================================================================
+int32_t tsdbOpenStats(STsdb *pTsdb);
+void    tsdbCloseStats(STsdb *pTsdb);
+int32_t tsdbStatsAddDataBlk(STsdb *pTsdb, SArray *aStbStats, const SBlockIdx *pBlockIdx, SMapData *mDataBlk);
+int32_t tsdbStatsAddSttBlk(STsdb *pTsdb, SArray *aStbStats, SArray *aSttBlk);
+void    tsdbStatsBeginCommit(STsdb *pTsdb);
+int32_t tsdbStatsPutCommitted(STsdb *pTsdb, SDFileSet *pSet, SArray *aHeadStbStats, SArray *aSttBlk);
+int32_t tsdbStatsFinishCommit(STsdb *pTsdb);
 
 #define TSDB_CACHE_NO(c)       ((c).cacheLast == 0)
 #define TSDB_CACHE_LAST_ROW(c) (((c).cacheLast & 1) > 0)
@@ -311,15 +329,21 @@ struct STsdbFS {
 };
 
 struct STsdb {
-  char          *path;
-  SVnode        *pVnode;
-  STsdbKeepCfg   keepCfg;
-  TdThreadRwlock rwLock;
-  SMemTable     *mem;
-  SMemTable     *imem;
-  STsdbFS        fs;
-  SLRUCache     *lruCache;
-  TdThreadMutex  lruMutex;
+  char           *path;
+  SVnode         *pVnode;
+  STsdbKeepCfg    keepCfg;
+  TdThreadRwlock  rwLock;
+  SMemTable      *mem;
+  SMemTable      *imem;
+  STsdbFS         fs;
+  SLRUCache      *lruCache;
+  TdThreadMutex   lruMutex;
+  STsdbCacheFile *pCacheFile;  // index of the last cache entries persisted by the commits
+  STsdbCacheCkpt *pCacheCkpt;  // last cache entries changed, dumped when the commit is prepared
+  STsdbColCache  *pColCache;   // last cache of the child tables of super tables in columns
+  STsdbMigrator  *pMigrator;
+  STsdbStats     *pStats;       // rows and time range of super tables in the file sets
+  SHashObj       *pRollupKeys;  // suid -> TSKEY, the data of the super table until it is rolled up into a rsma level
 };
 
 struct TSDBKEY {
@@ -353,6 +377,7 @@ struct STbData {
   tb_uid_t     uid;
   TSKEY        minKey;
   TSKEY        maxKey;
+  int64_t      minVer;  // the first version written or deleted from the table in the memory table
   SDelData    *pHead;
   SDelData    *pTail;
   SMemSkipList sl;
@@ -368,6 +393,7 @@ struct SMemTable {
   TSKEY            maxKey;
   int64_t          nRow;
   int64_t          nDel;
+  SHashObj        *pStbNRow;  // suid -> number of rows of the child tables
   struct {
     int32_t   nTbData;
     int32_t   nBucket;
@@ -653,13 +679,14 @@ typedef struct SSttBlockLoadInfo {
 } SSttBlockLoadInfo;
 
 typedef struct SMergeTree {
-  int8_t             backward;
-  SRBTree            rbt;
-  SArray            *pIterList;
-  SLDataIter        *pIter;
-  bool               destroyLoadInfo;
-  SSttBlockLoadInfo *pLoadInfo;
-  const char        *idStr;
+  int8_t                  backward;
+  SMultiwayMergeTreeInfo *pLoserTree;
+  SArray                 *pIterList;
+  SLDataIter             *pIter;
+  SLDataIter             *pRunnerUp;  // the rows of pIter before the current row of pRunnerUp are merged without the tree
+  bool                    destroyLoadInfo;
+  SSttBlockLoadInfo      *pLoadInfo;
+  const char             *idStr;
 } SMergeTree;
 
 typedef struct {
@@ -703,7 +730,6 @@ struct SDiskDataBuilder {
 int32_t tMergeTreeOpen(SMergeTree *pMTree, int8_t backward, SDataFReader *pFReader, uint64_t suid, uint64_t uid,
                        STimeWindow *pTimeWindow, SVersionRange *pVerRange, SSttBlockLoadInfo *pBlockLoadInfo,
                        bool destroyLoadInfo, const char *idStr);
-void    tMergeTreeAddIter(SMergeTree *pMTree, SLDataIter *pIter);
 bool    tMergeTreeNext(SMergeTree *pMTree);
 TSDBROW tMergeTreeGetRow(SMergeTree *pMTree);
 void    tMergeTreeClose(SMergeTree *pMTree);
@@ -730,8 +756,39 @@ typedef struct SCacheRowsReader {
   STsdbReadSnap     *pReadSnap;
   SDataFReader      *pDataFReader;
   SDataFReader      *pDataFReaderLast;
+  int64_t            colGen;   // gen of the columnar table aColRow is resolved in, 0 if not yet, -1 if not usable
+  int32_t           *aColRow;  // row of each table in the columnar table
 } SCacheRowsReader;
 
+#define TSDB_CACHE_COL_ROW_INVALID 0  // not filled yet, or invalidated by a change it can not follow
+#define TSDB_CACHE_COL_ROW_VALID   1
+#define TSDB_CACHE_COL_ROW_EMPTY   2  // the table has no data
+
+typedef struct {
+  int64_t    gen;
+  tb_uid_t   suid;
+  int8_t     cacheType;
+  STSchema  *pTSchema;
+  int32_t    numOfRows;
+  int32_t    capacity;
+  int64_t    size;
+  tb_uid_t  *aUid;
+  int8_t    *aState;
+  uint32_t  *aVer;   // bumped by each change of the row
+  int8_t   **aFlag;  // aFlag[iCol][iRow] is 1 if the column has a value
+  TSKEY    **aTs;    // aTs[iCol][iRow] is the timestamp of the value, for the last cache only
+  char     **aData;  // values of a column in slots of the column bytes, a var value keeps its header
+} SCacheColTable;
+
+struct STsdbColCache {
+  TdThreadRwlock lock;
+  int64_t        gen;
+  int64_t        size;
+  int32_t        nRow;
+  SHashObj      *pTables;  // cache key of suid -> SCacheColTable *
+  SHashObj      *pRows;    // cache key of uid -> SCacheColRow
+};
+
 typedef struct {
   TSKEY   ts;
   SColVal colVal;
@@ -739,8 +796,8 @@ typedef struct {
 
 int32_t tsdbOpenCache(STsdb *pTsdb);
 void    tsdbCloseCache(STsdb *pTsdb);
-int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, STSRow *row, STsdb *pTsdb);
-int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, STSRow *row, bool dup);
+int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, int64_t version, STSRow *row, STsdb *pTsdb);
+int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, int64_t version, STSRow *row, bool dup);
 int32_t tsdbCacheGetLastH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *pr, LRUHandle **h);
 int32_t tsdbCacheGetLastrowH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *pr, LRUHandle **h);
 int32_t tsdbCacheRelease(SLRUCache *pCache, LRUHandle *h);
@@ -749,6 +806,15 @@ int32_t tsdbCacheDeleteLastrow(SLRUCache *pCache, tb_uid_t uid, TSKEY eKey);
 int32_t tsdbCacheDeleteLast(SLRUCache *pCache, tb_uid_t uid, TSKEY eKey);
 int32_t tsdbCacheDelete(SLRUCache *pCache, tb_uid_t uid, TSKEY eKey);
 
+int32_t         tsdbCacheColAcquire(STsdb *pTsdb, SCacheRowsReader *pr, int8_t cacheType);
+SCacheColTable *tsdbCacheColGet(STsdb *pTsdb, SCacheRowsReader *pr, int8_t cacheType);
+void            tsdbCacheColFill(STsdb *pTsdb, SCacheRowsReader *pr, int8_t cacheType, int32_t iRow, uint32_t ver,
+                                 SArray *pLastArray);
+void            tsdbCacheColDelete(STsdb *pTsdb, tb_uid_t uid, int8_t cacheType);
+
+int32_t tsdbCachePrepareCheckpoint(STsdb *pTsdb);
+int32_t tsdbCacheCheckpoint(STsdb *pTsdb);
+
 void   tsdbCacheSetCapacity(SVnode *pVnode, size_t capacity);
 size_t tsdbCacheGetCapacity(SVnode *pVnode);
 
@@ -50,6 +50,7 @@ int32_t vnodeDecodeConfig(const SJson* pJson, void* pObj);
 
 // vnodeModule.c
 int32_t vnodeScheduleTask(int32_t (*execute)(void*), void* arg);
+int32_t vnodeScheduleCompactTask(int32_t (*execute)(void*), void* arg);
 
 // vnodeBufPool.c
 typedef struct SVBufPoolNode SVBufPoolNode;
@@ -92,6 +93,8 @@ int32_t vnodeCommitInfo(const char* dir, const SVnodeInfo* pInfo);
 int32_t vnodeLoadInfo(const char* dir, SVnodeInfo* pInfo);
 int32_t vnodeSyncCommit(SVnode* pVnode);
 int32_t vnodeAsyncCommit(SVnode* pVnode);
+int32_t vnodeAsyncCompact(SVnode* pVnode);
+void    vnodeCompactIfNeeded(SVnode* pVnode);
 bool    vnodeShouldRollback(SVnode* pVnode);
 
 // vnodeSync.c
@@ -143,6 +143,15 @@ typedef struct SMetaInfo {
   int32_t skmVer;
 } SMetaInfo;
 int32_t metaGetInfo(SMeta* pMeta, int64_t uid, SMetaInfo* pInfo, SMetaReader* pReader);
+int32_t metaGetTagSketches(SMeta* pMeta, tb_uid_t suid, SArray* aSketch);
+
+typedef struct STsdbStbStats {
+  int64_t             suid;
+  int64_t             nRow;
+  TSKEY               minKey;
+  TSKEY               maxKey;
+  STableBlockDistInfo blockDist;  // blocks of the data files
+} STsdbStbStats;
 
 // tsdb
 int     tsdbOpen(SVnode* pVnode, STsdb** ppTsdb, const char* dir, STsdbKeepCfg* pKeepCfg, int8_t rollback);
@@ -153,12 +162,21 @@ int32_t tsdbCommit(STsdb* pTsdb, SCommitInfo* pInfo);
 int32_t tsdbFinishCommit(STsdb* pTsdb);
 int32_t tsdbRollbackCommit(STsdb* pTsdb);
 int32_t tsdbDoRetention(STsdb* pTsdb, int64_t now);
+int32_t tsdbCompact(STsdb* pTsdb, int64_t commitID);
+bool    tsdbShouldCompact(STsdb* pTsdb, int64_t sinceCommitID);
 int     tsdbScanAndConvertSubmitMsg(STsdb* pTsdb, SSubmitReq* pMsg);
 int     tsdbInsertData(STsdb* pTsdb, int64_t version, SSubmitReq* pMsg, SSubmitRsp* pRsp);
 int32_t tsdbInsertTableData(STsdb* pTsdb, int64_t version, SSubmitMsgIter* pMsgIter, SSubmitBlk* pBlock,
                             SSubmitBlkRsp* pRsp);
 int32_t tsdbDeleteTableData(STsdb* pTsdb, int64_t version, tb_uid_t suid, tb_uid_t uid, TSKEY sKey, TSKEY eKey);
 int32_t tsdbSetKeepCfg(STsdb* pTsdb, STsdbCfg* pCfg);
+int32_t tsdbGetStbStats(STsdb* pTsdb, SArray* aStbStats);
+int32_t tsdbGetStbBlockDistInfo(STsdb* pTsdb, int64_t suid, STableBlockDistInfo* pInfo);
+void    tsdbStatsDropTable(STsdb* pTsdb, int64_t suid, int64_t uid);
+void    tsdbStatsDropStb(STsdb* pTsdb, int64_t suid);
+int32_t tsdbStbStatsCmprFn(const void* p1, const void* p2);
+void    tsdbSetRollupKey(STsdb* pTsdb, tb_uid_t suid, TSKEY key);
+TSKEY   tsdbGetRollupKey(STsdb* pTsdb, tb_uid_t suid);
 
 // tq
 int     tqInit();
@@ -339,6 +357,14 @@ struct SVnode {
   STQ*          pTq;
   SSink*        pSink;
   tsem_t        canCommit;
+  int8_t        compacting;
+  int8_t        stopCompact;
+  int64_t       compactCommitID;  // commit ID of the last compaction
+  int64_t       compactTs;        // start time of the last automatic compaction, in seconds
+  TdThreadCond  compactDone;
+  int8_t        statsLoading;   // the stats of the super tables are being collected in the background
+  SArray*       aStbStatsLoad;  // SArray<SStbStatsLoad>, the last collected, guarded by mutex
+  TdThreadCond  statsDone;
   int64_t       sync;
   TdThreadMutex lock;
   bool          blocked;
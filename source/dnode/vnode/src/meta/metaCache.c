@@ -58,6 +58,11 @@ struct SMetaCache {
     SLRUCache* pUidResCache;
     uint64_t   keyBuf[3];
   } sTagFilterResCache;
+
+  // tag value sketches of super tables, suid -> SArray<STagSketch>*
+  struct STagSketchCache {
+    SHashObj* pStbs;
+  } sTagSketchCache;
 };
 
 static void entryCacheClose(SMeta* pMeta) {
@@ -90,6 +95,8 @@ static void statsCacheClose(SMeta* pMeta) {
   }
 }
 
+static void freeTagSketchFp(void* param) { taosArrayDestroy(*(SArray**)param); }
+
 static void freeCacheEntryFp(void* param) {
   STagFilterResEntry** p = param;
   tdListEmpty(&(*p)->list);
@@ -140,6 +147,15 @@ int32_t metaCacheOpen(SMeta* pMeta) {
   }
 
   taosHashSetFreeFp(pCache->sTagFilterResCache.pTableEntry, freeCacheEntryFp);
+
+  pCache->sTagSketchCache.pStbs =
+      taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false, HASH_NO_LOCK);
+  if (pCache->sTagSketchCache.pStbs == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err2;
+  }
+
+  taosHashSetFreeFp(pCache->sTagSketchCache.pStbs, freeTagSketchFp);
   pMeta->pCache = pCache;
   return code;
 
@@ -159,6 +175,7 @@ void metaCacheClose(SMeta* pMeta) {
 
     taosHashCleanup(pMeta->pCache->sTagFilterResCache.pTableEntry);
     taosLRUCacheCleanup(pMeta->pCache->sTagFilterResCache.pUidResCache);
+    taosHashCleanup(pMeta->pCache->sTagSketchCache.pStbs);
     taosMemoryFree(pMeta->pCache);
     pMeta->pCache = NULL;
   }
@@ -564,3 +581,83 @@ int32_t metaUidCacheClear(SMeta* pMeta, uint64_t suid) {
 
   return TSDB_CODE_SUCCESS;
 }
+
+// add the tag values of a child table to the sketches of its super table, json tags are skipped
+int32_t metaTagSketchAdd(SArray* aSketch, const STag* pTag) {
+  SArray* pTagVals = NULL;
+  if (pTag == NULL || (pTag->flags & TD_TAG_JSON)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t code = tTagToValArray(pTag, &pTagVals);
+  if (code) {
+    return code;
+  }
+
+  for (int32_t i = 0; i < taosArrayGetSize(pTagVals); i++) {
+    STagVal* pTagVal = (STagVal*)taosArrayGet(pTagVals, i);
+
+    STagSketch* pSketch = NULL;
+    for (int32_t j = 0; j < taosArrayGetSize(aSketch); j++) {
+      STagSketch* p = (STagSketch*)taosArrayGet(aSketch, j);
+      if (p->colId == pTagVal->cid) {
+        pSketch = p;
+        break;
+      }
+    }
+    if (pSketch == NULL) {
+      STagSketch sketch = {.colId = pTagVal->cid};
+      pSketch = taosArrayPush(aSketch, &sketch);
+      if (pSketch == NULL) {
+        code = TSDB_CODE_OUT_OF_MEMORY;
+        break;
+      }
+    }
+
+    if (IS_VAR_DATA_TYPE(pTagVal->type)) {
+      tHllAdd(pSketch->sketch, pTagVal->pData, pTagVal->nData);
+    } else {
+      tHllAdd(pSketch->sketch, &pTagVal->i64, tDataTypes[pTagVal->type].bytes);
+    }
+  }
+
+  taosArrayDestroy(pTagVals);
+  return code;
+}
+
+int32_t metaTagSketchCacheGet(SMeta* pMeta, tb_uid_t suid, SArray* aSketch) {
+  SArray** pp = taosHashGet(pMeta->pCache->sTagSketchCache.pStbs, &suid, sizeof(suid));
+  if (pp == NULL) {
+    return TSDB_CODE_NOT_FOUND;
+  }
+
+  if (taosArrayAddAll(aSketch, *pp) == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t metaTagSketchCachePut(SMeta* pMeta, tb_uid_t suid, SArray* aSketch) {
+  SArray* pSketch = taosArrayDup(aSketch, NULL);
+  if (pSketch == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  if (taosHashPut(pMeta->pCache->sTagSketchCache.pStbs, &suid, sizeof(suid), &pSketch, POINTER_BYTES) != 0) {
+    taosArrayDestroy(pSketch);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+// values are only added, the sketches of a super table are rebuilt when its tags are altered or after a restart
+void metaTagSketchCacheUpdate(SMeta* pMeta, tb_uid_t suid, const STag* pTag) {
+  SArray** pp = taosHashGet(pMeta->pCache->sTagSketchCache.pStbs, &suid, sizeof(suid));
+  if (pp != NULL && metaTagSketchAdd(*pp, pTag) != TSDB_CODE_SUCCESS) {
+    taosHashRemove(pMeta->pCache->sTagSketchCache.pStbs, &suid, sizeof(suid));
+  }
+}
+
+void metaTagSketchCacheDrop(SMeta* pMeta, tb_uid_t suid) {
+  taosHashRemove(pMeta->pCache->sTagSketchCache.pStbs, &suid, sizeof(suid));
+}
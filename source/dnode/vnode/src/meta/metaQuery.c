@@ -1491,6 +1491,47 @@ _exit:
   return code;
 }
 
+int32_t metaGetTagSketches(SMeta *pMeta, tb_uid_t suid, SArray *aSketch) {
+  int32_t code = 0;
+
+  metaRLock(pMeta);
+  code = metaTagSketchCacheGet(pMeta, suid, aSketch);
+  metaULock(pMeta);
+  if (code != TSDB_CODE_NOT_FOUND) {
+    return code;
+  }
+
+  // slow path: go through the tags of all the child tables
+  SArray *pSketch = taosArrayInit(4, sizeof(STagSketch));
+  if (pSketch == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  code = 0;
+  SMCtbCursor *pCur = metaOpenCtbCursor(pMeta, suid, 1);
+  if (pCur == NULL) {
+    taosArrayDestroy(pSketch);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  while (code == 0 && metaCtbCursorNext(pCur) != 0) {
+    code = metaTagSketchAdd(pSketch, (const STag *)pCur->pVal);
+  }
+  metaCloseCtbCursor(pCur, 1);
+
+  if (code == 0) {
+    metaWLock(pMeta);
+    code = metaTagSketchCachePut(pMeta, suid, pSketch);
+    metaULock(pMeta);
+  }
+
+  if (code == 0 && taosArrayAddAll(aSketch, pSketch) == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  taosArrayDestroy(pSketch);
+  return code;
+}
+
 void metaUpdateStbStats(SMeta *pMeta, int64_t uid, int64_t delta) {
   SMetaStbStats stats = {0};
 
@@ -372,6 +372,9 @@ int metaAlterSTable(SMeta *pMeta, int64_t version, SVCreateStbReq *pReq) {
   metaUpdateUidIdx(pMeta, &nStbEntry);
 
   // metaStatsCacheDrop(pMeta, nStbEntry.uid);
+  if (oStbEntry.stbEntry.schemaTag.version != pReq->schemaTag.version) {
+    metaTagSketchCacheDrop(pMeta, nStbEntry.uid);
+  }
 
   metaULock(pMeta);
 
@@ -459,6 +462,7 @@ int metaCreateTable(SMeta *pMeta, int64_t version, SVCreateTbReq *pReq, STableMe
     metaWLock(pMeta);
     metaUpdateStbStats(pMeta, me.ctbEntry.suid, 1);
     metaUidCacheClear(pMeta, me.ctbEntry.suid);
+    metaTagSketchCacheUpdate(pMeta, me.ctbEntry.suid, (const STag *)me.ctbEntry.pTags);
     metaULock(pMeta);
   } else {
     me.ntbEntry.ctime = pReq->ctime;
@@ -694,6 +698,7 @@ static int metaDropTableByUid(SMeta *pMeta, tb_uid_t uid, int *type) {
 
     metaStatsCacheDrop(pMeta, uid);
     metaUidCacheClear(pMeta, uid);
+    metaTagSketchCacheDrop(pMeta, uid);
     --pMeta->pVnode->config.vndStats.numOfSTables;
   }
 
@@ -1078,6 +1083,7 @@ static int metaUpdateTableTagVal(SMeta *pMeta, int64_t version, SVAlterTbReq *pA
               ((STag *)(ctbEntry.ctbEntry.pTags))->len, pMeta->txn);
 
   metaUidCacheClear(pMeta, ctbEntry.ctbEntry.suid);
+  metaTagSketchCacheUpdate(pMeta, ctbEntry.ctbEntry.suid, (const STag *)ctbEntry.ctbEntry.pTags);
 
   metaULock(pMeta);
 
@@ -42,7 +42,7 @@ static void       tdReleaseRSmaInfo(SSma *pSma, SRSmaInfo *pInfo);
 static void       tdFreeRSmaSubmitItems(SArray *pItems);
 static int32_t    tdRSmaFetchAllResult(SSma *pSma, SRSmaInfo *pInfo);
 static int32_t    tdRSmaExecAndSubmitResult(SSma *pSma, qTaskInfo_t taskInfo, SRSmaInfoItem *pItem, STSchema *pTSchema,
-                                            int64_t suid);
+                                            int64_t suid, bool fetchAll);
 static void       tdRSmaFetchTrigger(void *param, void *tmrId);
 static int32_t    tdRSmaInfoClone(SSma *pSma, SRSmaInfo *pInfo);
 static void       tdRSmaQTaskInfoFree(qTaskInfo_t *taskHandle, int32_t vgId, int32_t level);
@@ -667,8 +667,20 @@ static void tdBlockDataDestroy(SArray *pBlockArr) {
   taosArrayDestroy(pBlockArr);
 }
 
+static TSKEY tdRSmaGetResultEndKey(SSma *pSma, SRSmaInfoItem *pItem, SSDataBlock *pBlock) {
+  TSKEY            maxKey = TSKEY_MIN;
+  SColumnInfoData *pTsCol = taosArrayGet(pBlock->pDataBlock, PRIMARYKEY_TIMESTAMP_COL_ID - 1);
+  for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+    maxKey = TMAX(maxKey, *(TSKEY *)colDataGetData(pTsCol, i));
+  }
+  return (maxKey == TSKEY_MIN) ? maxKey : maxKey + SMA_RETENTION(pSma)[pItem->level].freq - 1;
+}
+
+// The windows not closed yet are also written if fetchAll, which may be written again later.
 static int32_t tdRSmaExecAndSubmitResult(SSma *pSma, qTaskInfo_t taskInfo, SRSmaInfoItem *pItem, STSchema *pTSchema,
-                                         int64_t suid) {
+                                         int64_t suid, bool fetchAll) {
+  TSKEY   rollupKey = TSKEY_MIN;  // the end of the last closed window written
+  STsdb  *sinkTsdb = (pItem->level == TSDB_RETENTION_L1 ? pSma->pRSmaTsdb[0] : pSma->pRSmaTsdb[1]);
   SArray *pResList = taosArrayInit(1, POINTER_BYTES);
   if (pResList == NULL) {
     terrno = TSDB_CODE_OUT_OF_MEMORY;
@@ -711,7 +723,6 @@ static int32_t tdRSmaExecAndSubmitResult(SSma *pSma, qTaskInfo_t taskInfo, SRSma
       smaDebug("result block, uid:%" PRIu64 ", groupid:%" PRIu64 ", rows:%d", output->info.id.uid, output->info.id.groupId,
                output->info.rows);
 
-      STsdb      *sinkTsdb = (pItem->level == TSDB_RETENTION_L1 ? pSma->pRSmaTsdb[0] : pSma->pRSmaTsdb[1]);
       SSubmitReq *pReq = NULL;
 
       // TODO: the schema update should be handled later(TD-17965)
@@ -736,9 +747,17 @@ static int32_t tdRSmaExecAndSubmitResult(SSma *pSma, qTaskInfo_t taskInfo, SRSma
                htonl(pReq->header.contLen));
 
       taosMemoryFreeClear(pReq);
+      if (!fetchAll && output->info.type == STREAM_NORMAL) {
+        rollupKey = TMAX(rollupKey, tdRSmaGetResultEndKey(pSma, pItem, output));
+      }
     }
   }
 
+  // the windows are closed for all tables at the same time, which are all written now
+  if (rollupKey != TSKEY_MIN) {
+    tsdbSetRollupKey(sinkTsdb, suid, rollupKey);
+  }
+
   taosArrayDestroy(pResList);
   qCleanExecTaskBlockBuf(taskInfo);
   return TSDB_CODE_SUCCESS;
@@ -860,7 +879,7 @@ static int32_t tdExecuteRSmaImpl(SSma *pSma, const void *pMsg, int32_t msgSize,
   }
 
   SRSmaInfoItem *pItem = RSMA_INFO_ITEM(pInfo, idx);
-  tdRSmaExecAndSubmitResult(pSma, qTaskInfo, pItem, pInfo->pTSchema, pInfo->suid);
+  tdRSmaExecAndSubmitResult(pSma, qTaskInfo, pItem, pInfo->pTSchema, pInfo->suid, false);
 
   return TSDB_CODE_SUCCESS;
 }
@@ -1422,7 +1441,7 @@ static int32_t tdRSmaFetchAllResult(SSma *pSma, SRSmaInfo *pInfo) {
       if ((terrno = qSetSMAInput(taskInfo, &dataBlock, 1, STREAM_INPUT__DATA_BLOCK)) < 0) {
         goto _err;
       }
-      if (tdRSmaExecAndSubmitResult(pSma, taskInfo, pItem, pInfo->pTSchema, pInfo->suid) < 0) {
+      if (tdRSmaExecAndSubmitResult(pSma, taskInfo, pItem, pInfo->pTSchema, pInfo->suid, true) < 0) {
         goto _err;
       }
 
@@ -15,6 +15,13 @@
 
 #include "tsdb.h"
 
+static int32_t tsdbCacheFileOpen(STsdb *pTsdb);
+static void    tsdbCacheFileClose(STsdbCacheFile *pFile);
+static void    tsdbCacheCkptDestroy(STsdbCacheCkpt *pCkpt);
+static int32_t tsdbCacheColOpen(STsdb *pTsdb);
+static void    tsdbCacheColClose(STsdbColCache *pColCache);
+static void    tsdbCacheColClear(STsdbColCache *pColCache);
+
 int32_t tsdbOpenCache(STsdb *pTsdb) {
   int32_t    code = 0;
   SLRUCache *pCache = NULL;
@@ -30,6 +37,13 @@ int32_t tsdbOpenCache(STsdb *pTsdb) {
 
   taosThreadMutexInit(&pTsdb->lruMutex, NULL);
 
+  pTsdb->lruCache = pCache;
+
+  code = tsdbCacheColOpen(pTsdb);
+  if (code) goto _err;
+
+  return tsdbCacheFileOpen(pTsdb);
+
 _err:
   pTsdb->lruCache = pCache;
   return code;
@@ -44,6 +58,13 @@ void tsdbCloseCache(STsdb *pTsdb) {
 
     taosThreadMutexDestroy(&pTsdb->lruMutex);
   }
+
+  tsdbCacheFileClose(pTsdb->pCacheFile);
+  pTsdb->pCacheFile = NULL;
+  tsdbCacheCkptDestroy(pTsdb->pCacheCkpt);
+  pTsdb->pCacheCkpt = NULL;
+  tsdbCacheColClose(pTsdb->pColCache);
+  pTsdb->pColCache = NULL;
 }
 
 static void getTableCacheKey(tb_uid_t uid, int cacheType, char *key, int *len) {
@@ -69,6 +90,1409 @@ static void deleteTableCacheLast(const void *key, size_t keyLen, void *value) {
   taosArrayDestroy(value);
 }
 
+// last cache file ==============================================================================================
+// The entries of the lru cache are persisted in the last cache file, a log of segments, one appended by each commit:
+//
+//   | entry | ... | index | footer | entry | ... | index | footer | ...
+//
+// An entry is an encoded SArray<SLastCol> with its checksum. The index of a segment holds the key, offset and size of
+// each entry the segment writes, sorted by key, a size of 0 removing the key from the file. The footer records the
+// committed version, the digest of the file system the entries are valid for and the offset of the footer of the
+// previous segment. When the vnode is opened, the segments are replayed into one index, a file whose last footer does
+// not match the vnode is dropped, and the entries of the wal not committed yet are replayed through the cache as usual.
+//
+// Only the entries changed since the last commit are dumped when a commit is prepared, at which time the cache holds
+// exactly the data of the version being committed: the ones of the tables in the memory table being committed, whose
+// entries in the file are out of date, and the ones queries built from the data files. They are appended when the
+// commit finishes, unless most of the file is garbage or it has too many segments, then the live entries are written
+// into a new file. A crash while a segment is appended leaves a broken footer, so the file is dropped at the next open.
+#define TSDB_CACHE_FILE_MAGIC    0x4C535443  // "LSTC"
+#define TSDB_CACHE_FILE_IDX_SIZE (sizeof(uint64_t) + sizeof(int64_t) + sizeof(int32_t))
+#define TSDB_CACHE_FILE_FOOTER   (sizeof(uint32_t) * 3 + sizeof(int64_t) * 4)
+#define TSDB_CACHE_FILE_WBUF     (1024 * 1024)
+#define TSDB_CACHE_FILE_RBUF     (4 * 1024 * 1024)
+#define TSDB_CACHE_FILE_MAX_SEGS 64
+
+typedef struct {
+  uint64_t key;
+  int64_t  offset;
+  int32_t  size;  // 0 once the entry is dropped, it is removed from the file at the next commit
+} SCacheFileIdx;
+
+typedef struct {
+  int64_t  version;
+  uint32_t digest;
+  int64_t  nEntry;
+  int64_t  idxOffset;
+  int64_t  prevOffset;  // offset of the footer of the previous segment, -1 for the first one
+} SCacheFileFooter;
+
+// The index keeps the entries loaded into the lru cache too, so it has the keys of the file exactly, and an entry
+// evicted from the lru cache is loaded again from the file.
+struct STsdbCacheFile {
+  TdThreadMutex mutex;
+  TdFilePtr     pFD;
+  SArray       *aIdx;     // SArray<SCacheFileIdx>, sorted by key
+  int64_t       nLeft;    // number of entries not dropped
+  int64_t       size;     // 0 if there is no file
+  int32_t       nSeg;     // number of segments in the file
+  SArray       *aDirty;   // SArray<uint64_t>, keys of the entries queries put into the lru cache from the data files
+  int8_t        dumpAll;  // the changes since the last commit are lost, the next commit dumps the whole lru cache
+};
+
+struct STsdbCacheCkpt {
+  int64_t  version;
+  int32_t  code;
+  int64_t  size;
+  uint8_t *pBuf;
+  SArray  *aIdx;  // SArray<SCacheFileIdx>, entries dumped from the lru cache into pBuf
+};
+
+static void tsdbCacheFileName(STsdb *pTsdb, char *fname, char *fname_t) {
+  SVnode *pVnode = pTsdb->pVnode;
+  if (pVnode->pTfs) {
+    snprintf(fname, TSDB_FILENAME_LEN - 1, "%s%s%s%sLASTCACHE", tfsGetPrimaryPath(pVnode->pTfs), TD_DIRSEP,
+             pTsdb->path, TD_DIRSEP);
+    snprintf(fname_t, TSDB_FILENAME_LEN - 1, "%s%s%s%sLASTCACHE.t", tfsGetPrimaryPath(pVnode->pTfs), TD_DIRSEP,
+             pTsdb->path, TD_DIRSEP);
+  } else {
+    snprintf(fname, TSDB_FILENAME_LEN - 1, "%s%sLASTCACHE", pTsdb->path, TD_DIRSEP);
+    snprintf(fname_t, TSDB_FILENAME_LEN - 1, "%s%sLASTCACHE.t", pTsdb->path, TD_DIRSEP);
+  }
+}
+
+static int32_t tsdbCacheFileIdxCmprFn(const void *p1, const void *p2) {
+  uint64_t key1 = ((SCacheFileIdx *)p1)->key;
+  uint64_t key2 = ((SCacheFileIdx *)p2)->key;
+
+  if (key1 < key2) {
+    return -1;
+  } else if (key1 > key2) {
+    return 1;
+  }
+  return 0;
+}
+
+static int32_t tsdbCacheFileIdxOffsetCmprFn(const void *p1, const void *p2) {
+  int64_t offset1 = ((SCacheFileIdx *)p1)->offset;
+  int64_t offset2 = ((SCacheFileIdx *)p2)->offset;
+
+  if (offset1 < offset2) {
+    return -1;
+  } else if (offset1 > offset2) {
+    return 1;
+  }
+  return 0;
+}
+
+static int32_t tsdbCacheKeyCmprFn(const void *p1, const void *p2) {
+  uint64_t key1 = *(uint64_t *)p1;
+  uint64_t key2 = *(uint64_t *)p2;
+
+  if (key1 < key2) {
+    return -1;
+  } else if (key1 > key2) {
+    return 1;
+  }
+  return 0;
+}
+
+static uint32_t tsdbCacheFSDigest(STsdbFS *pFS) {
+  TSCKSUM digest = 0;
+  int64_t aVal[4];
+
+  if (pFS->pDelFile) {
+    aVal[0] = pFS->pDelFile->commitID;
+    aVal[1] = pFS->pDelFile->size;
+    digest = taosCalcChecksum(digest, (uint8_t *)aVal, sizeof(int64_t) * 2);
+  }
+
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(pFS->aDFileSet); iSet++) {
+    SDFileSet *pSet = (SDFileSet *)taosArrayGet(pFS->aDFileSet, iSet);
+
+    aVal[0] = pSet->fid;
+    aVal[1] = pSet->pHeadF->commitID;
+    aVal[2] = pSet->pDataF->commitID;
+    aVal[3] = pSet->pSmaF->commitID;
+    digest = taosCalcChecksum(digest, (uint8_t *)aVal, sizeof(aVal));
+    for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+      aVal[0] = pSet->aSttF[iStt]->commitID;
+      aVal[1] = pSet->aSttF[iStt]->size;
+      digest = taosCalcChecksum(digest, (uint8_t *)aVal, sizeof(int64_t) * 2);
+    }
+  }
+
+  return digest;
+}
+
+static int32_t tsdbCacheEncodeLast(uint8_t *p, SArray *pLastArray) {
+  int32_t n = 0;
+  int16_t nCol = taosArrayGetSize(pLastArray);
+
+  n += tPutI16v(p ? p + n : p, nCol);
+  for (int16_t iCol = 0; iCol < nCol; ++iCol) {
+    SLastCol *pLastCol = (SLastCol *)taosArrayGet(pLastArray, iCol);
+    SColVal  *pColVal = &pLastCol->colVal;
+
+    n += tPutI64(p ? p + n : p, pLastCol->ts);
+    n += tPutI16v(p ? p + n : p, pColVal->cid);
+    n += tPutI8(p ? p + n : p, pColVal->type);
+    n += tPutI8(p ? p + n : p, pColVal->flag);
+    if (IS_VAR_DATA_TYPE(pColVal->type)) {
+      n += tPutBinary(p ? p + n : p, pColVal->value.pData, pColVal->value.nData);
+    } else {
+      n += tPutI64(p ? p + n : p, pColVal->value.val);
+    }
+  }
+
+  return n;
+}
+
+static int32_t tsdbCacheDecodeLast(uint8_t *p, int32_t size, SArray **ppLastArray) {
+  int32_t code = 0;
+  int32_t n = 0;
+  int16_t nCol = 0;
+  SArray *pLastArray = NULL;
+
+  if (size <= sizeof(TSCKSUM) || !taosCheckChecksumWhole(p, size)) {
+    code = TSDB_CODE_FILE_CORRUPTED;
+    goto _err;
+  }
+
+  n += tGetI16v(p + n, &nCol);
+  pLastArray = taosArrayInit(nCol, sizeof(SLastCol));
+  if (pLastArray == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  for (int16_t iCol = 0; iCol < nCol; ++iCol) {
+    SLastCol lastCol = {0};
+    SColVal *pColVal = &lastCol.colVal;
+
+    n += tGetI64(p + n, &lastCol.ts);
+    n += tGetI16v(p + n, &pColVal->cid);
+    n += tGetI8(p + n, &pColVal->type);
+    n += tGetI8(p + n, &pColVal->flag);
+    if (IS_VAR_DATA_TYPE(pColVal->type)) {
+      uint8_t *pData = NULL;
+      n += tGetBinary(p + n, &pData, &pColVal->value.nData);
+      if (pColVal->value.nData > 0) {
+        pColVal->value.pData = taosMemoryMalloc(pColVal->value.nData);
+        if (pColVal->value.pData == NULL) {
+          code = TSDB_CODE_OUT_OF_MEMORY;
+          goto _err;
+        }
+        memcpy(pColVal->value.pData, pData, pColVal->value.nData);
+      } else {
+        pColVal->value.pData = NULL;
+      }
+    } else {
+      n += tGetI64(p + n, &pColVal->value.val);
+    }
+
+    if (taosArrayPush(pLastArray, &lastCol) == NULL) {
+      if (IS_VAR_DATA_TYPE(pColVal->type)) taosMemoryFree(pColVal->value.pData);
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      goto _err;
+    }
+  }
+
+  *ppLastArray = pLastArray;
+  return code;
+
+_err:
+  if (pLastArray) deleteTableCacheLast(NULL, 0, pLastArray);
+  *ppLastArray = NULL;
+  return code;
+}
+
+// the persisted entry is only used if it was built with the current schema of the table
+static bool tsdbCacheLastMatchSchema(SArray *pLastArray, STSchema *pTSchema) {
+  if (pTSchema == NULL || taosArrayGetSize(pLastArray) != pTSchema->numOfCols) {
+    return false;
+  }
+
+  for (int32_t iCol = 0; iCol < pTSchema->numOfCols; ++iCol) {
+    SColVal *pColVal = &((SLastCol *)taosArrayGet(pLastArray, iCol))->colVal;
+    if (pColVal->cid != pTSchema->columns[iCol].colId || pColVal->type != pTSchema->columns[iCol].type) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static size_t tsdbCacheLastCharge(SArray *pLastArray) {
+  return pLastArray->capacity * pLastArray->elemSize + sizeof(*pLastArray);
+}
+
+static void tsdbCacheCkptDestroy(STsdbCacheCkpt *pCkpt) {
+  if (pCkpt) {
+    tFree(pCkpt->pBuf);
+    taosArrayDestroy(pCkpt->aIdx);
+    taosMemoryFree(pCkpt);
+  }
+}
+
+static void tsdbCacheFileClose(STsdbCacheFile *pFile) {
+  if (pFile) {
+    taosCloseFile(&pFile->pFD);
+    taosArrayDestroy(pFile->aIdx);
+    taosArrayDestroy(pFile->aDirty);
+    taosThreadMutexDestroy(&pFile->mutex);
+    taosMemoryFree(pFile);
+  }
+}
+
+// the file is removed, so the entries written into it before are dumped again at the next commit
+static void tsdbCacheFileReset(STsdbCacheFile *pFile) {
+  taosThreadMutexLock(&pFile->mutex);
+  taosCloseFile(&pFile->pFD);
+  taosArrayClear(pFile->aIdx);
+  pFile->nLeft = 0;
+  pFile->size = 0;
+  pFile->nSeg = 0;
+  pFile->dumpAll = 1;
+  taosThreadMutexUnlock(&pFile->mutex);
+}
+
+// a query put an entry built from the data files into the lru cache, it is written into the file at the next commit
+static void tsdbCacheFileSetDirty(STsdb *pTsdb, const char *key) {
+  STsdbCacheFile *pFile = pTsdb->pCacheFile;
+  if (pFile == NULL) return;
+
+  taosThreadMutexLock(&pFile->mutex);
+  if (taosArrayPush(pFile->aDirty, key) == NULL) {
+    pFile->dumpAll = 1;
+  }
+  taosThreadMutexUnlock(&pFile->mutex);
+}
+
+// The entries of the last cache file are not dropped when their tables are written, instead an entry is out of date
+// once its table is in the memory tables: in imem, or in mem with a version before the given one, which is the version
+// of the write loading the entry to update it, or VERSION_MAX for a query. The entries of the tables in imem are
+// dropped when the commit is prepared, so the file never carries them forward.
+static bool tsdbCacheFileIsStale(STsdb *pTsdb, tb_uid_t uid, int64_t version) {
+  bool     stale = false;
+  STbData *pTbData = NULL;
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  if (pTsdb->imem && tsdbGetTbDataFromMemTable(pTsdb->imem, 0, uid)) {
+    stale = true;
+  } else if (pTsdb->mem && (pTbData = tsdbGetTbDataFromMemTable(pTsdb->mem, 0, uid))) {
+    stale = pTbData->minVer < version;
+  }
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+
+  return stale;
+}
+
+static void tsdbCacheFileDropIdx(STsdbCacheFile *pFile, SCacheFileIdx *pIdx) {
+  pIdx->size = 0;
+  atomic_sub_fetch_64(&pFile->nLeft, 1);
+}
+
+// read the entry of the key out of the last cache file, an entry out of date or failing to be read is dropped
+static int32_t tsdbCacheFileGet(STsdb *pTsdb, tb_uid_t uid, int64_t version, uint64_t key, SArray **ppLastArray) {
+  int32_t         code = 0;
+  STsdbCacheFile *pFile = pTsdb->pCacheFile;
+  uint8_t        *pBuf = NULL;
+
+  *ppLastArray = NULL;
+  if (pFile == NULL || atomic_load_64(&pFile->nLeft) == 0) {
+    return code;
+  }
+
+  taosThreadMutexLock(&pFile->mutex);
+
+  SCacheFileIdx *pIdx = (SCacheFileIdx *)taosArraySearch(pFile->aIdx, &(SCacheFileIdx){.key = key},
+                                                         tsdbCacheFileIdxCmprFn, TD_EQ);
+  if (pIdx == NULL || pIdx->size == 0) {
+    goto _exit;
+  }
+
+  if (tsdbCacheFileIsStale(pTsdb, uid, version)) {
+    tsdbCacheFileDropIdx(pFile, pIdx);
+    goto _exit;
+  }
+
+  pBuf = taosMemoryMalloc(pIdx->size);
+  if (pBuf == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  if (taosPReadFile(pFile->pFD, pBuf, pIdx->size, pIdx->offset) != pIdx->size) {
+    code = TAOS_SYSTEM_ERROR(errno);
+  } else {
+    code = tsdbCacheDecodeLast(pBuf, pIdx->size, ppLastArray);
+  }
+  if (code) {
+    tsdbCacheFileDropIdx(pFile, pIdx);
+  }
+
+_exit:
+  taosThreadMutexUnlock(&pFile->mutex);
+  taosMemoryFree(pBuf);
+  if (code) {
+    tsdbError("vgId:%d, %s failed since %s, key:%" PRIu64, TD_VID(pTsdb->pVnode), __func__, tstrerror(code), key);
+  }
+  return code;
+}
+
+// move the entry of the key from the last cache file into the lru cache, so that a new row can update it in place
+static LRUHandle *tsdbCacheFileLoadH(STsdb *pTsdb, tb_uid_t uid, int64_t version, const char *key, int keyLen) {
+  SArray    *pLastArray = NULL;
+  LRUHandle *h = NULL;
+
+  tsdbCacheFileGet(pTsdb, uid, version, *(uint64_t *)key, &pLastArray);
+  if (pLastArray == NULL) {
+    return NULL;
+  }
+
+  STSchema *pTSchema = metaGetTbTSchema(pTsdb->pVnode->pMeta, uid, -1, 1);
+  if (tsdbCacheLastMatchSchema(pLastArray, pTSchema)) {
+    if (taosLRUCacheInsert(pTsdb->lruCache, key, keyLen, pLastArray, tsdbCacheLastCharge(pLastArray),
+                           deleteTableCacheLast, &h, TAOS_LRU_PRIORITY_LOW) != TAOS_LRU_STATUS_OK) {
+      h = NULL;
+    }
+  } else {
+    deleteTableCacheLast(NULL, 0, pLastArray);
+  }
+  taosMemoryFree(pTSchema);
+
+  return h;
+}
+
+// insert the entries into the lru cache in file order until the cache is full, the rest are loaded on demand
+static int32_t tsdbCacheFileLoadAll(STsdb *pTsdb, STsdbCacheFile *pFile, int64_t *nLoaded) {
+  int32_t  code = 0;
+  int32_t  lino = 0;
+  uint8_t *pBuf = NULL;
+  int64_t  bufOffset = 0;
+  int64_t  bufSize = 0;
+  size_t   capacity = taosLRUCacheGetCapacity(pTsdb->lruCache);
+  SArray  *aIdx = NULL;
+
+  *nLoaded = 0;
+  aIdx = taosArrayDup(pFile->aIdx, NULL);
+  if (aIdx == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  taosArraySort(aIdx, tsdbCacheFileIdxOffsetCmprFn);
+
+  for (int32_t iIdx = 0; iIdx < taosArrayGetSize(aIdx); iIdx++) {
+    SCacheFileIdx *pIdx = (SCacheFileIdx *)taosArrayGet(aIdx, iIdx);
+    SArray        *pLastArray = NULL;
+
+    if (pIdx->offset < bufOffset || pIdx->offset + pIdx->size > bufOffset + bufSize) {
+      bufOffset = pIdx->offset;
+      bufSize = TMAX(pIdx->size, TSDB_CACHE_FILE_RBUF);
+      code = tRealloc(&pBuf, bufSize);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      bufSize = taosPReadFile(pFile->pFD, pBuf, bufSize, bufOffset);
+      if (bufSize < pIdx->size) {
+        code = bufSize < 0 ? TAOS_SYSTEM_ERROR(errno) : TSDB_CODE_FILE_CORRUPTED;
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+    }
+
+    code = tsdbCacheDecodeLast(pBuf + pIdx->offset - bufOffset, pIdx->size, &pLastArray);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    size_t charge = tsdbCacheLastCharge(pLastArray);
+    if (taosLRUCacheGetUsage(pTsdb->lruCache) + charge > capacity) {
+      deleteTableCacheLast(NULL, 0, pLastArray);
+      break;
+    }
+
+    if (taosLRUCacheInsert(pTsdb->lruCache, &pIdx->key, sizeof(pIdx->key), pLastArray, charge, deleteTableCacheLast,
+                           NULL, TAOS_LRU_PRIORITY_LOW) != TAOS_LRU_STATUS_OK) {
+      break;
+    }
+    (*nLoaded)++;
+  }
+
+_exit:
+  tFree(pBuf);
+  taosArrayDestroy(aIdx);
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
+// read the index and the footer of the segment ending at the footer offset, the index is checked by its checksum
+static int32_t tsdbCacheFileReadSeg(TdFilePtr pFD, int64_t footerOffset, uint8_t **ppBuf, SCacheFileFooter *pFooter) {
+  uint8_t  footer[TSDB_CACHE_FILE_FOOTER];
+  uint32_t magic = 0;
+  int32_t  n = 0;
+
+  if (footerOffset < 0 ||
+      taosPReadFile(pFD, footer, TSDB_CACHE_FILE_FOOTER, footerOffset) != TSDB_CACHE_FILE_FOOTER) {
+    return TSDB_CODE_FILE_CORRUPTED;
+  }
+  n += tGetU32(footer + n, &magic);
+  n += tGetI64(footer + n, &pFooter->version);
+  n += tGetU32(footer + n, &pFooter->digest);
+  n += tGetI64(footer + n, &pFooter->nEntry);
+  n += tGetI64(footer + n, &pFooter->idxOffset);
+  n += tGetI64(footer + n, &pFooter->prevOffset);
+  if (magic != TSDB_CACHE_FILE_MAGIC || pFooter->nEntry < 0 || pFooter->idxOffset < 0 ||
+      footerOffset - pFooter->idxOffset != pFooter->nEntry * TSDB_CACHE_FILE_IDX_SIZE ||
+      pFooter->prevOffset < -1 || pFooter->prevOffset >= pFooter->idxOffset) {
+    return TSDB_CODE_FILE_CORRUPTED;
+  }
+
+  int64_t size = footerOffset + TSDB_CACHE_FILE_FOOTER - pFooter->idxOffset;
+  int32_t code = tRealloc(ppBuf, size);
+  if (code) return code;
+  if (taosPReadFile(pFD, *ppBuf, size, pFooter->idxOffset) != size || !taosCheckChecksumWhole(*ppBuf, size)) {
+    return TSDB_CODE_FILE_CORRUPTED;
+  }
+
+  return 0;
+}
+
+typedef struct {
+  SCacheFileIdx idx;
+  int32_t       iSeg;  // 0 for the last segment
+} SCacheFileRec;
+
+static int32_t tsdbCacheFileRecCmprFn(const void *p1, const void *p2) {
+  const SCacheFileRec *pRec1 = (const SCacheFileRec *)p1;
+  const SCacheFileRec *pRec2 = (const SCacheFileRec *)p2;
+
+  int32_t c = tsdbCacheFileIdxCmprFn(&pRec1->idx, &pRec2->idx);
+  if (c) return c;
+  return pRec1->iSeg - pRec2->iSeg;
+}
+
+// replay the segments of the file into its index, the last one of each key wins
+static int32_t tsdbCacheFileReadIdx(STsdb *pTsdb, STsdbCacheFile *pFile, int64_t size, bool *valid) {
+  int32_t          code = 0;
+  int32_t          lino = 0;
+  uint8_t         *pBuf = NULL;
+  SArray          *aRec = NULL;
+  SCacheFileFooter footer = {0};
+  int64_t          footerOffset = size - TSDB_CACHE_FILE_FOOTER;
+
+  *valid = false;
+  aRec = taosArrayInit(1024, sizeof(SCacheFileRec));
+  if (aRec == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  for (int32_t iSeg = 0; footerOffset >= 0; iSeg++) {
+    code = tsdbCacheFileReadSeg(pFile->pFD, footerOffset, &pBuf, &footer);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    // the entries are only valid for the data they were built from
+    if (iSeg == 0 &&
+        (footer.version != pTsdb->pVnode->state.committed || footer.digest != tsdbCacheFSDigest(&pTsdb->fs))) {
+      tsdbInfo("vgId:%d, last cache file is dropped since it is out of date, version:%" PRId64 " committed:%" PRId64,
+               TD_VID(pTsdb->pVnode), footer.version, pTsdb->pVnode->state.committed);
+      goto _exit;
+    }
+
+    int32_t n = 0;
+    for (int64_t iEntry = 0; iEntry < footer.nEntry; iEntry++) {
+      SCacheFileRec rec = {.iSeg = iSeg};
+      n += tGetU64(pBuf + n, &rec.idx.key);
+      n += tGetI64(pBuf + n, &rec.idx.offset);
+      n += tGetI32(pBuf + n, &rec.idx.size);
+      if (rec.idx.size < 0 || rec.idx.offset < 0 || rec.idx.offset + rec.idx.size > footer.idxOffset) {
+        code = TSDB_CODE_FILE_CORRUPTED;
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+      if (taosArrayPush(aRec, &rec) == NULL) {
+        code = TSDB_CODE_OUT_OF_MEMORY;
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+    }
+
+    pFile->nSeg++;
+    footerOffset = footer.prevOffset;
+  }
+
+  taosArraySort(aRec, tsdbCacheFileRecCmprFn);
+  for (int32_t iRec = 0; iRec < taosArrayGetSize(aRec); iRec++) {
+    SCacheFileRec *pRec = (SCacheFileRec *)taosArrayGet(aRec, iRec);
+    if (iRec > 0 && ((SCacheFileRec *)taosArrayGet(aRec, iRec - 1))->idx.key == pRec->idx.key) continue;
+    if (pRec->idx.size == 0) continue;
+
+    if (taosArrayPush(pFile->aIdx, &pRec->idx) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+  pFile->nLeft = taosArrayGetSize(pFile->aIdx);
+  pFile->size = size;
+  *valid = true;
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  tFree(pBuf);
+  taosArrayDestroy(aRec);
+  return code;
+}
+
+static int32_t tsdbCacheFileOpen(STsdb *pTsdb) {
+  int32_t         code = 0;
+  int32_t         lino = 0;
+  STsdbCacheFile *pFile = NULL;
+  bool            valid = false;
+  char            fname[TSDB_FILENAME_LEN] = {0};
+  char            fname_t[TSDB_FILENAME_LEN] = {0};
+  int64_t         stime = taosGetTimestampMs();
+
+  tsdbCacheFileName(pTsdb, fname, fname_t);
+  (void)taosRemoveFile(fname_t);
+  if (tsCacheLastLoad == 0 || TSDB_CACHE_NO(pTsdb->pVnode->config)) {
+    (void)taosRemoveFile(fname);
+    goto _exit;
+  }
+
+  pFile = (STsdbCacheFile *)taosMemoryCalloc(1, sizeof(*pFile));
+  if (pFile == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  taosThreadMutexInit(&pFile->mutex, NULL);
+  pFile->aIdx = taosArrayInit(1024, sizeof(SCacheFileIdx));
+  pFile->aDirty = taosArrayInit(16, sizeof(uint64_t));
+  if (pFile->aIdx == NULL || pFile->aDirty == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  pTsdb->pCacheFile = pFile;
+  pFile = NULL;
+
+  if (!taosCheckExistFile(fname)) {
+    goto _exit;
+  }
+
+  // the cache is rebuilt from the data files, so a file out of date or failing to be read is dropped
+  pFile = pTsdb->pCacheFile;
+  pFile->pFD = taosOpenFile(fname, TD_FILE_READ);
+  int64_t size = 0;
+  if (pFile->pFD == NULL || taosFStatFile(pFile->pFD, &size, NULL) < 0) {
+    tsdbError("vgId:%d, failed to open last cache file since %s, file:%s", TD_VID(pTsdb->pVnode),
+              tstrerror(TAOS_SYSTEM_ERROR(errno)), fname);
+  } else if (tsdbCacheFileReadIdx(pTsdb, pFile, size, &valid) == 0 && valid) {
+    int64_t nLoaded = 0;
+    if (tsCacheLastLoad == 2) {
+      (void)tsdbCacheFileLoadAll(pTsdb, pFile, &nLoaded);
+    }
+    tsdbInfo("vgId:%d, last cache file is opened, entries:%" PRId64 " segments:%d loaded:%" PRId64
+             " elapsed:%" PRId64 "ms",
+             TD_VID(pTsdb->pVnode), pFile->nLeft, pFile->nSeg, nLoaded, taosGetTimestampMs() - stime);
+  }
+  if (!valid) {
+    tsdbCacheFileReset(pFile);
+    pFile->dumpAll = 0;
+    (void)taosRemoveFile(fname);
+  }
+  pFile = NULL;
+
+_exit:
+  if (code) {
+    // the last cache is not persisted then, which fails no query
+    tsdbError("vgId:%d, %s failed at line %d since %s, file:%s", TD_VID(pTsdb->pVnode), __func__, lino,
+              tstrerror(code), fname);
+    code = 0;
+  }
+  tsdbCacheFileClose(pFile);
+  return code;
+}
+
+static bool tsdbCacheDumpEntry(const void *key, size_t keyLen, void *value, void *ud) {
+  STsdbCacheCkpt *pCkpt = (STsdbCacheCkpt *)ud;
+  SArray         *pLastArray = (SArray *)value;
+  int32_t         size = tsdbCacheEncodeLast(NULL, pLastArray) + sizeof(TSCKSUM);
+
+  pCkpt->code = tRealloc(&pCkpt->pBuf, pCkpt->size + size);
+  if (pCkpt->code) {
+    return false;
+  }
+
+  uint8_t *p = pCkpt->pBuf + pCkpt->size;
+  tsdbCacheEncodeLast(p, pLastArray);
+  taosCalcChecksumAppend(0, p, size);
+
+  if (taosArrayPush(pCkpt->aIdx, &(SCacheFileIdx){.key = *(uint64_t *)key, .offset = pCkpt->size, .size = size}) ==
+      NULL) {
+    pCkpt->code = TSDB_CODE_OUT_OF_MEMORY;
+    return false;
+  }
+  pCkpt->size += size;
+
+  return true;
+}
+
+// dump the entries of the keys still in the lru cache
+static int32_t tsdbCacheDumpKeys(STsdb *pTsdb, STsdbCacheCkpt *pCkpt, SArray *aKey) {
+  taosArraySort(aKey, tsdbCacheKeyCmprFn);
+  taosArrayRemoveDuplicate(aKey, tsdbCacheKeyCmprFn, NULL);
+
+  for (int32_t iKey = 0; iKey < taosArrayGetSize(aKey) && pCkpt->code == 0; iKey++) {
+    uint64_t   *pKey = (uint64_t *)taosArrayGet(aKey, iKey);
+    LRUHandle *h = taosLRUCacheLookup(pTsdb->lruCache, pKey, sizeof(*pKey));
+    if (h) {
+      (void)tsdbCacheDumpEntry(pKey, sizeof(*pKey), taosLRUCacheValue(pTsdb->lruCache, h), pCkpt);
+      taosLRUCacheRelease(pTsdb->lruCache, h, false);
+    }
+  }
+
+  return pCkpt->code;
+}
+
+int32_t tsdbCachePrepareCheckpoint(STsdb *pTsdb) {
+  int32_t         code = 0;
+  int32_t         lino = 0;
+  STsdbCacheCkpt *pCkpt = NULL;
+  STsdbCacheFile *pFile = pTsdb->pCacheFile;
+  SArray         *aKey = NULL;
+  SArray         *aTbDataP = NULL;
+  int8_t          dumpAll = 0;
+
+  tsdbCacheCkptDestroy(pTsdb->pCacheCkpt);
+  pTsdb->pCacheCkpt = NULL;
+  if (pFile == NULL) {
+    goto _exit;
+  }
+
+  pCkpt = (STsdbCacheCkpt *)taosMemoryCalloc(1, sizeof(*pCkpt));
+  if (pCkpt == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  pCkpt->version = pTsdb->pVnode->state.applied;
+  pCkpt->aIdx = taosArrayInit(1024, sizeof(SCacheFileIdx));
+  if (pCkpt->aIdx == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  taosThreadMutexLock(&pFile->mutex);
+  aKey = taosArrayInit(16, sizeof(uint64_t));
+  if (aKey) {
+    TSWAP(aKey, pFile->aDirty);
+  }
+  dumpAll = pFile->dumpAll;
+  pFile->dumpAll = 0;
+  taosThreadMutexUnlock(&pFile->mutex);
+  if (aKey == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  if (pTsdb->imem) {
+    aTbDataP = tsdbMemTableGetTbDataArray(pTsdb->imem);
+    if (aTbDataP == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+  // called in the write thread, so no entry is updated meanwhile
+  if (dumpAll) {
+    taosLRUCacheApply(pTsdb->lruCache, tsdbCacheDumpEntry, pCkpt);
+    code = pCkpt->code;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  } else {
+    // the entries of the tables written since the last commit, and the ones queries built
+    for (int32_t iTbData = 0; iTbData < taosArrayGetSize(aTbDataP); iTbData++) {
+      STbData *pTbData = *(STbData **)taosArrayGet(aTbDataP, iTbData);
+      for (int32_t cacheType = 0; cacheType < 2; cacheType++) {
+        char key[32] = {0};
+        int  keyLen = 0;
+        getTableCacheKey(pTbData->uid, cacheType, key, &keyLen);
+        if (taosArrayPush(aKey, key) == NULL) {
+          code = TSDB_CODE_OUT_OF_MEMORY;
+          TSDB_CHECK_CODE(code, lino, _exit);
+        }
+      }
+    }
+
+    code = tsdbCacheDumpKeys(pTsdb, pCkpt, aKey);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  taosArraySort(pCkpt->aIdx, tsdbCacheFileIdxCmprFn);
+
+  // the entries in the file of the tables written are out of date, they are removed from the file by this commit
+  taosThreadMutexLock(&pFile->mutex);
+  for (int32_t iTbData = 0; iTbData < taosArrayGetSize(aTbDataP) && pFile->nLeft > 0; iTbData++) {
+    STbData *pTbData = *(STbData **)taosArrayGet(aTbDataP, iTbData);
+    for (int32_t cacheType = 0; cacheType < 2; cacheType++) {
+      SCacheFileIdx idx = {0};
+      int           keyLen = 0;
+      getTableCacheKey(pTbData->uid, cacheType, (char *)&idx.key, &keyLen);
+
+      SCacheFileIdx *pIdx = (SCacheFileIdx *)taosArraySearch(pFile->aIdx, &idx, tsdbCacheFileIdxCmprFn, TD_EQ);
+      if (pIdx && pIdx->size > 0) {
+        tsdbCacheFileDropIdx(pFile, pIdx);
+      }
+    }
+  }
+  taosThreadMutexUnlock(&pFile->mutex);
+
+  pTsdb->pCacheCkpt = pCkpt;
+  pCkpt = NULL;
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  tsdbCacheCkptDestroy(pCkpt);
+  taosArrayDestroy(aKey);
+  taosArrayDestroy(aTbDataP);
+  return code;
+}
+
+static int32_t tsdbCacheFileWrite(TdFilePtr pFD, uint8_t **ppBuf, int64_t *pnBuf, const uint8_t *p, int64_t n) {
+  int32_t code = 0;
+
+  if (*pnBuf > 0 && (p == NULL || *pnBuf + n > TSDB_CACHE_FILE_WBUF)) {
+    if (taosWriteFile(pFD, *ppBuf, *pnBuf) != *pnBuf) {
+      return TAOS_SYSTEM_ERROR(errno);
+    }
+    *pnBuf = 0;
+  }
+
+  if (p) {
+    code = tRealloc(ppBuf, *pnBuf + n);
+    if (code) return code;
+    memcpy(*ppBuf + *pnBuf, p, n);
+    *pnBuf += n;
+  }
+
+  return code;
+}
+
+// read the encoded entry in the last cache file
+static int32_t tsdbCacheFileReadRaw(STsdbCacheFile *pFile, const SCacheFileIdx *pIdx, uint8_t **ppBuf, bool *exist) {
+  int32_t code = 0;
+
+  *exist = false;
+  taosThreadMutexLock(&pFile->mutex);
+  if (pFile->pFD) {
+    code = tRealloc(ppBuf, pIdx->size);
+    if (code == 0) {
+      if (taosPReadFile(pFile->pFD, *ppBuf, pIdx->size, pIdx->offset) != pIdx->size) {
+        code = TAOS_SYSTEM_ERROR(errno);
+      } else {
+        *exist = true;
+      }
+    }
+  }
+  taosThreadMutexUnlock(&pFile->mutex);
+
+  return code;
+}
+
+// Writes the entries dumped when the commit was prepared, appended as a segment, or along with the live entries of the
+// file into a new one. The entries dropped since then are kept in the file, their tables are in the memory table, so
+// they are found out of date again when they are read, and removed at the next commit.
+int32_t tsdbCacheCheckpoint(STsdb *pTsdb) {
+  int32_t         code = 0;
+  int32_t         lino = 0;
+  STsdbCacheCkpt *pCkpt = pTsdb->pCacheCkpt;
+  STsdbCacheFile *pFile = pTsdb->pCacheFile;
+  TdFilePtr       pFD = NULL;
+  TdFilePtr       pReadFD = NULL;
+  SArray         *aOldIdx = NULL;
+  SArray         *aIdx = NULL;
+  SArray         *aSegIdx = NULL;
+  uint8_t        *pWBuf = NULL;
+  uint8_t        *pRBuf = NULL;
+  uint8_t        *pIdxBuf = NULL;
+  int64_t         nWBuf = 0;
+  bool            rewrite = false;
+  char            fname[TSDB_FILENAME_LEN] = {0};
+  char            fname_t[TSDB_FILENAME_LEN] = {0};
+
+  pTsdb->pCacheCkpt = NULL;
+  tsdbCacheFileName(pTsdb, fname, fname_t);
+  if (pCkpt == NULL) {
+    (void)taosRemoveFile(fname);
+    if (pFile) tsdbCacheFileReset(pFile);
+    goto _exit;
+  }
+
+  // only this thread changes the keys of the index
+  taosThreadMutexLock(&pFile->mutex);
+  aOldIdx = taosArrayDup(pFile->aIdx, NULL);
+  int64_t size = pFile->size;
+  int32_t nSeg = pFile->nSeg;
+  taosThreadMutexUnlock(&pFile->mutex);
+  if (aOldIdx == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  // the live entries after the commit, and the records the segment appends
+  int32_t nIdx = taosArrayGetSize(pCkpt->aIdx);
+  int32_t nOldIdx = taosArrayGetSize(aOldIdx);
+  int64_t nLive = nIdx;
+  int64_t liveSize = pCkpt->size;
+  int64_t nSegIdx = nIdx;
+  for (int32_t iOldIdx = 0; iOldIdx < nOldIdx; iOldIdx++) {
+    SCacheFileIdx *pOldIdx = (SCacheFileIdx *)taosArrayGet(aOldIdx, iOldIdx);
+    if (taosArraySearch(pCkpt->aIdx, pOldIdx, tsdbCacheFileIdxCmprFn, TD_EQ)) continue;
+    if (pOldIdx->size > 0) {
+      nLive++;
+      liveSize += pOldIdx->size;
+    } else {
+      nSegIdx++;
+    }
+  }
+  liveSize += nLive * TSDB_CACHE_FILE_IDX_SIZE + TSDB_CACHE_FILE_FOOTER;
+  int64_t appendSize = pCkpt->size + nSegIdx * TSDB_CACHE_FILE_IDX_SIZE + TSDB_CACHE_FILE_FOOTER;
+  rewrite = (size == 0 || nSeg >= TSDB_CACHE_FILE_MAX_SEGS || size + appendSize > liveSize * 2);
+
+  if (rewrite) {
+    pFD = taosOpenFile(fname_t, TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC);
+  } else {
+    pFD = taosOpenFile(fname, TD_FILE_WRITE);
+    if (pFD && taosLSeekFile(pFD, size, SEEK_SET) != size) {
+      taosCloseFile(&pFD);
+    }
+  }
+  if (pFD == NULL) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  aIdx = taosArrayInit(nLive + 1, sizeof(SCacheFileIdx));
+  aSegIdx = rewrite ? aIdx : taosArrayInit(nSegIdx + 1, sizeof(SCacheFileIdx));
+  if (aIdx == NULL || aSegIdx == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  // merge the dumped entries and the ones in the file by key, both sorted
+  int64_t offset = rewrite ? 0 : size;
+  int32_t iIdx = 0;
+  int32_t iOldIdx = 0;
+  while (iIdx < nIdx || iOldIdx < nOldIdx) {
+    SCacheFileIdx *pIdx = iIdx < nIdx ? (SCacheFileIdx *)taosArrayGet(pCkpt->aIdx, iIdx) : NULL;
+    SCacheFileIdx *pOldIdx = iOldIdx < nOldIdx ? (SCacheFileIdx *)taosArrayGet(aOldIdx, iOldIdx) : NULL;
+
+    if (pOldIdx == NULL || (pIdx && pIdx->key <= pOldIdx->key)) {
+      if (pOldIdx && pIdx->key == pOldIdx->key) iOldIdx++;
+      iIdx++;
+
+      code = tsdbCacheFileWrite(pFD, &pWBuf, &nWBuf, pCkpt->pBuf + pIdx->offset, pIdx->size);
+      TSDB_CHECK_CODE(code, lino, _exit);
+      SCacheFileIdx idx = {.key = pIdx->key, .offset = offset, .size = pIdx->size};
+      taosArrayPush(aIdx, &idx);
+      if (!rewrite) taosArrayPush(aSegIdx, &idx);
+      offset += pIdx->size;
+    } else if (pOldIdx->size == 0) {
+      iOldIdx++;
+      if (!rewrite) taosArrayPush(aSegIdx, &(SCacheFileIdx){.key = pOldIdx->key});
+    } else if (!rewrite) {
+      iOldIdx++;
+      taosArrayPush(aIdx, pOldIdx);
+    } else {
+      iOldIdx++;
+      bool exist = false;
+      code = tsdbCacheFileReadRaw(pFile, pOldIdx, &pRBuf, &exist);
+      TSDB_CHECK_CODE(code, lino, _exit);
+      if (!exist) continue;
+
+      code = tsdbCacheFileWrite(pFD, &pWBuf, &nWBuf, pRBuf, pOldIdx->size);
+      TSDB_CHECK_CODE(code, lino, _exit);
+      taosArrayPush(aIdx, &(SCacheFileIdx){.key = pOldIdx->key, .offset = offset, .size = pOldIdx->size});
+      offset += pOldIdx->size;
+    }
+  }
+  code = tsdbCacheFileWrite(pFD, &pWBuf, &nWBuf, NULL, 0);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // index of the segment and footer
+  int64_t nEntry = taosArrayGetSize(aSegIdx);
+  int64_t idxSize = nEntry * TSDB_CACHE_FILE_IDX_SIZE + TSDB_CACHE_FILE_FOOTER;
+  int64_t n = 0;
+
+  code = tRealloc(&pIdxBuf, idxSize);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  for (int64_t iEntry = 0; iEntry < nEntry; iEntry++) {
+    SCacheFileIdx *pSegIdx = (SCacheFileIdx *)taosArrayGet(aSegIdx, iEntry);
+    n += tPutU64(pIdxBuf + n, pSegIdx->key);
+    n += tPutI64(pIdxBuf + n, pSegIdx->offset);
+    n += tPutI32(pIdxBuf + n, pSegIdx->size);
+  }
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  uint32_t digest = tsdbCacheFSDigest(&pTsdb->fs);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+
+  n += tPutU32(pIdxBuf + n, TSDB_CACHE_FILE_MAGIC);
+  n += tPutI64(pIdxBuf + n, pCkpt->version);
+  n += tPutU32(pIdxBuf + n, digest);
+  n += tPutI64(pIdxBuf + n, nEntry);
+  n += tPutI64(pIdxBuf + n, offset);
+  n += tPutI64(pIdxBuf + n, rewrite ? -1 : size - TSDB_CACHE_FILE_FOOTER);
+  taosCalcChecksumAppend(0, pIdxBuf, idxSize);
+
+  if (taosWriteFile(pFD, pIdxBuf, idxSize) != idxSize) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  if (taosFsyncFile(pFD) < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  taosCloseFile(&pFD);
+
+  if (rewrite) {
+    if (taosRenameFile(fname_t, fname) < 0) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+    pReadFD = taosOpenFile(fname, TD_FILE_READ);
+    if (pReadFD == NULL) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+  // read the entries from the file written from now on
+  taosThreadMutexLock(&pFile->mutex);
+  if (rewrite) {
+    taosCloseFile(&pFile->pFD);
+    pFile->pFD = pReadFD;
+    pReadFD = NULL;
+    pFile->nSeg = 1;
+  } else {
+    pFile->nSeg++;
+  }
+  TSWAP(pFile->aIdx, aIdx);
+  pFile->nLeft = taosArrayGetSize(pFile->aIdx);
+  pFile->size = offset + idxSize;
+  taosThreadMutexUnlock(&pFile->mutex);
+
+  tsdbDebug("vgId:%d, last cache file is %s, version:%" PRId64 " entries:%" PRId64 " written:%" PRId64
+            " size:%" PRId64,
+            TD_VID(pTsdb->pVnode), rewrite ? "written" : "appended", pCkpt->version, nEntry,
+            offset + idxSize - (rewrite ? 0 : size), offset + idxSize);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+    taosCloseFile(&pFD);
+    (void)taosRemoveFile(fname_t);
+    (void)taosRemoveFile(fname);
+    tsdbCacheFileReset(pFile);
+  }
+  taosCloseFile(&pReadFD);
+  if (!rewrite) taosArrayDestroy(aSegIdx);
+  taosArrayDestroy(aIdx);
+  taosArrayDestroy(aOldIdx);
+  tFree(pWBuf);
+  tFree(pRBuf);
+  tFree(pIdxBuf);
+  tsdbCacheCkptDestroy(pCkpt);
+  return code;
+}
+
+// columnar last cache ==========================================================================================
+// The last/last_row values of the child tables of a super table are also kept in a columnar table, an array per
+// column indexed by the row of each child table, so that scanning the cache of all the child tables copies the values
+// into the result block column by column instead of converting the cached row of each table. A row is filled from the
+// lru entry of its table when it is scanned, and then updated in place along with the lru entry. A change the row can
+// not follow, e.g. a delete or an update of a table not in the lru, invalidates it until it is filled again. The memory
+// of the columnar tables is bounded by the capacity of the lru cache too; a super table not fitting in is scanned
+// table by table.
+typedef struct {
+  SCacheColTable *pTable;
+  int32_t         iRow;
+} SCacheColRow;
+
+static int32_t tsdbCacheColOpen(STsdb *pTsdb) {
+  STsdbColCache *pColCache = taosMemoryCalloc(1, sizeof(*pColCache));
+  if (pColCache == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pColCache->pTables = taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT), true, HASH_NO_LOCK);
+  pColCache->pRows = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT), true, HASH_NO_LOCK);
+  if (pColCache->pTables == NULL || pColCache->pRows == NULL) {
+    taosHashCleanup(pColCache->pTables);
+    taosHashCleanup(pColCache->pRows);
+    taosMemoryFree(pColCache);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  taosThreadRwlockInit(&pColCache->lock, NULL);
+  pTsdb->pColCache = pColCache;
+  return 0;
+}
+
+static void tsdbCacheColTableDestroy(STsdbColCache *pColCache, SCacheColTable *pTable) {
+  char key[32] = {0};
+  int  keyLen = 0;
+
+  for (int32_t iRow = 0; iRow < pTable->numOfRows; ++iRow) {
+    getTableCacheKey(pTable->aUid[iRow], pTable->cacheType, key, &keyLen);
+    SCacheColRow *pRow = taosHashGet(pColCache->pRows, key, keyLen);
+    if (pRow && pRow->pTable == pTable) {
+      taosHashRemove(pColCache->pRows, key, keyLen);
+      atomic_sub_fetch_32(&pColCache->nRow, 1);
+    }
+  }
+  pColCache->size -= pTable->size;
+
+  for (int32_t iCol = 0; iCol < pTable->pTSchema->numOfCols; ++iCol) {
+    taosMemoryFree(pTable->aFlag[iCol]);
+    if (pTable->aTs) {
+      taosMemoryFree(pTable->aTs[iCol]);
+    }
+    taosMemoryFree(pTable->aData[iCol]);
+  }
+  taosMemoryFree(pTable->aFlag);
+  taosMemoryFree(pTable->aTs);
+  taosMemoryFree(pTable->aData);
+  taosMemoryFree(pTable->aUid);
+  taosMemoryFree(pTable->aState);
+  taosMemoryFree(pTable->aVer);
+  taosMemoryFree(pTable->pTSchema);
+  taosMemoryFree(pTable);
+}
+
+static void tsdbCacheColClear(STsdbColCache *pColCache) {
+  void *pIter = taosHashIterate(pColCache->pTables, NULL);
+  while (pIter) {
+    tsdbCacheColTableDestroy(pColCache, *(SCacheColTable **)pIter);
+    pIter = taosHashIterate(pColCache->pTables, pIter);
+  }
+  taosHashClear(pColCache->pTables);
+}
+
+static void tsdbCacheColClose(STsdbColCache *pColCache) {
+  if (pColCache == NULL) return;
+
+  tsdbCacheColClear(pColCache);
+  taosHashCleanup(pColCache->pTables);
+  taosHashCleanup(pColCache->pRows);
+  taosThreadRwlockDestroy(&pColCache->lock);
+  taosMemoryFree(pColCache);
+}
+
+static int64_t tsdbCacheColRowSize(STSchema *pTSchema, int8_t cacheType) {
+  int64_t size = sizeof(tb_uid_t) + sizeof(int8_t) + sizeof(uint32_t);
+  for (int32_t iCol = 0; iCol < pTSchema->numOfCols; ++iCol) {
+    size += sizeof(int8_t) + pTSchema->columns[iCol].bytes + (cacheType ? sizeof(TSKEY) : 0);
+  }
+  return size;
+}
+
+static int32_t tsdbCacheColTableCreate(STsdbColCache *pColCache, tb_uid_t suid, int8_t cacheType, STSchema *pTSchema,
+                                       SCacheColTable **ppTable) {
+  int32_t         code = 0;
+  int32_t         nCol = pTSchema->numOfCols;
+  int64_t         schemaSize = sizeof(STSchema) + sizeof(STColumn) * nCol;
+  SCacheColTable *pTable = taosMemoryCalloc(1, sizeof(*pTable));
+  if (pTable == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pTable->gen = ++pColCache->gen;
+  pTable->suid = suid;
+  pTable->cacheType = cacheType;
+  pTable->pTSchema = taosMemoryMalloc(schemaSize);
+  pTable->aFlag = taosMemoryCalloc(nCol, POINTER_BYTES);
+  pTable->aData = taosMemoryCalloc(nCol, POINTER_BYTES);
+  if (cacheType) {
+    pTable->aTs = taosMemoryCalloc(nCol, POINTER_BYTES);
+  }
+  if (pTable->pTSchema == NULL || pTable->aFlag == NULL || pTable->aData == NULL || (cacheType && !pTable->aTs)) {
+    taosMemoryFree(pTable->pTSchema);
+    taosMemoryFree(pTable->aFlag);
+    taosMemoryFree(pTable->aData);
+    taosMemoryFree(pTable->aTs);
+    taosMemoryFree(pTable);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  memcpy(pTable->pTSchema, pTSchema, schemaSize);
+
+  *ppTable = pTable;
+  return code;
+}
+
+static int32_t tsdbCacheColTableGrow(SCacheColTable *pTable, int32_t capacity) {
+  STSchema *pTSchema = pTable->pTSchema;
+  void     *p = NULL;
+
+#define TSDB_CACHE_COL_REALLOC(_a, _size)           \
+  do {                                              \
+    p = taosMemoryRealloc((_a), (_size)*capacity);  \
+    if (p == NULL) return TSDB_CODE_OUT_OF_MEMORY;  \
+    (_a) = p;                                       \
+  } while (0)
+
+  TSDB_CACHE_COL_REALLOC(pTable->aUid, sizeof(tb_uid_t));
+  TSDB_CACHE_COL_REALLOC(pTable->aState, sizeof(int8_t));
+  TSDB_CACHE_COL_REALLOC(pTable->aVer, sizeof(uint32_t));
+  for (int32_t iCol = 0; iCol < pTSchema->numOfCols; ++iCol) {
+    TSDB_CACHE_COL_REALLOC(pTable->aFlag[iCol], sizeof(int8_t));
+    TSDB_CACHE_COL_REALLOC(pTable->aData[iCol], pTSchema->columns[iCol].bytes);
+    if (pTable->aTs) {
+      TSDB_CACHE_COL_REALLOC(pTable->aTs[iCol], sizeof(TSKEY));
+    }
+  }
+
+#undef TSDB_CACHE_COL_REALLOC
+
+  pTable->capacity = capacity;
+  return 0;
+}
+
+// make room for nRow more rows in the capacity of the lru cache, dropping the other tables if needed
+static int32_t tsdbCacheColTableReserve(STsdb *pTsdb, SCacheColTable *pTable, int32_t nRow, bool *fit) {
+  STsdbColCache *pColCache = pTsdb->pColCache;
+  int64_t        limit = taosLRUCacheGetCapacity(pTsdb->lruCache);
+
+  *fit = true;
+  if (pTable->numOfRows + nRow <= pTable->capacity) {
+    return 0;
+  }
+
+  int32_t capacity = TMAX(pTable->capacity, 64);
+  while (capacity < pTable->numOfRows + nRow) {
+    capacity *= 2;
+  }
+
+  int64_t size = tsdbCacheColRowSize(pTable->pTSchema, pTable->cacheType) * capacity;
+  if (pColCache->size - pTable->size + size > limit) {
+    SArray *aOther = taosArrayInit(taosHashGetSize(pColCache->pTables), POINTER_BYTES);
+    if (aOther == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+
+    void *pIter = taosHashIterate(pColCache->pTables, NULL);
+    while (pIter) {
+      if (*(SCacheColTable **)pIter != pTable) {
+        taosArrayPush(aOther, pIter);
+      }
+      pIter = taosHashIterate(pColCache->pTables, pIter);
+    }
+
+    for (int32_t i = 0; i < taosArrayGetSize(aOther); ++i) {
+      SCacheColTable *pOther = *(SCacheColTable **)taosArrayGet(aOther, i);
+      char            key[32] = {0};
+      int             keyLen = 0;
+
+      getTableCacheKey(pOther->suid, pOther->cacheType, key, &keyLen);
+      taosHashRemove(pColCache->pTables, key, keyLen);
+      tsdbCacheColTableDestroy(pColCache, pOther);
+    }
+    taosArrayDestroy(aOther);
+
+    if (pColCache->size - pTable->size + size > limit) {
+      *fit = false;
+      return 0;
+    }
+  }
+
+  int32_t code = tsdbCacheColTableGrow(pTable, capacity);
+  if (code) return code;
+
+  pColCache->size += size - pTable->size;
+  pTable->size = size;
+  return 0;
+}
+
+static int32_t tsdbCacheColSetRow(SCacheColTable *pTable, int32_t iRow, SArray *pLastArray) {
+  STSchema *pTSchema = pTable->pTSchema;
+
+  if (taosArrayGetSize(pLastArray) != pTSchema->numOfCols) {
+    return -1;
+  }
+  for (int32_t iCol = 0; iCol < pTSchema->numOfCols; ++iCol) {
+    STColumn *pTColumn = &pTSchema->columns[iCol];
+    SColVal  *pColVal = &((SLastCol *)taosArrayGet(pLastArray, iCol))->colVal;
+    if (pColVal->cid != pTColumn->colId || pColVal->type != pTColumn->type) {
+      return -1;
+    }
+    if (IS_VAR_DATA_TYPE(pColVal->type) && COL_VAL_IS_VALUE(pColVal) &&
+        pColVal->value.nData + VARSTR_HEADER_SIZE > pTColumn->bytes) {
+      return -1;
+    }
+  }
+
+  for (int32_t iCol = 0; iCol < pTSchema->numOfCols; ++iCol) {
+    STColumn *pTColumn = &pTSchema->columns[iCol];
+    SLastCol *pLastCol = (SLastCol *)taosArrayGet(pLastArray, iCol);
+    SColVal  *pColVal = &pLastCol->colVal;
+    char     *pSlot = pTable->aData[iCol] + (int64_t)iRow * pTColumn->bytes;
+
+    pTable->aFlag[iCol][iRow] = COL_VAL_IS_VALUE(pColVal);
+    if (pTable->aTs) {
+      pTable->aTs[iCol][iRow] = pLastCol->ts;
+    }
+    if (!COL_VAL_IS_VALUE(pColVal)) {
+      continue;
+    }
+
+    if (IS_VAR_DATA_TYPE(pColVal->type)) {
+      varDataSetLen(pSlot, pColVal->value.nData);
+      if (pColVal->value.nData > 0) {
+        memcpy(varDataVal(pSlot), pColVal->value.pData, pColVal->value.nData);
+      }
+    } else {
+      memcpy(pSlot, &pColVal->value.val, pTColumn->bytes);
+    }
+  }
+
+  pTable->aState[iRow] = TSDB_CACHE_COL_ROW_VALID;
+  return 0;
+}
+
+// follow the change of the lru entry of a table, which is invalidated if pLastArray is NULL
+static void tsdbCacheColUpdate(STsdb *pTsdb, int8_t cacheType, tb_uid_t uid, SArray *pLastArray) {
+  STsdbColCache *pColCache = pTsdb->pColCache;
+  char           key[32] = {0};
+  int            keyLen = 0;
+
+  if (pColCache == NULL || atomic_load_32(&pColCache->nRow) == 0) {
+    return;
+  }
+
+  getTableCacheKey(uid, cacheType, key, &keyLen);
+  taosThreadRwlockWrlock(&pColCache->lock);
+  SCacheColRow *pRow = taosHashGet(pColCache->pRows, key, keyLen);
+  if (pRow) {
+    SCacheColTable *pTable = pRow->pTable;
+    pTable->aVer[pRow->iRow]++;
+    if (pLastArray == NULL || tsdbCacheColSetRow(pTable, pRow->iRow, pLastArray) != 0) {
+      pTable->aState[pRow->iRow] = TSDB_CACHE_COL_ROW_INVALID;
+    }
+  }
+  taosThreadRwlockUnlock(&pColCache->lock);
+}
+
+void tsdbCacheColDelete(STsdb *pTsdb, tb_uid_t uid, int8_t cacheType) {
+  tsdbCacheColUpdate(pTsdb, cacheType, uid, NULL);
+}
+
+int32_t tsdbCacheColAcquire(STsdb *pTsdb, SCacheRowsReader *pr, int8_t cacheType) {
+  int32_t         code = 0;
+  STsdbColCache  *pColCache = pTsdb->pColCache;
+  SCacheColTable *pTable = NULL;
+  char            key[32] = {0};
+  int             keyLen = 0;
+  bool            fit = true;
+
+  pr->colGen = -1;
+  if (pr->aColRow == NULL) {
+    pr->aColRow = taosMemoryMalloc(sizeof(int32_t) * pr->numOfTables);
+    if (pr->aColRow == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+
+  taosThreadRwlockWrlock(&pColCache->lock);
+
+  getTableCacheKey(pr->suid, cacheType, key, &keyLen);
+  SCacheColTable **ppTable = taosHashGet(pColCache->pTables, key, keyLen);
+  if (ppTable) {
+    pTable = *ppTable;
+    if (pTable->pTSchema->version != pr->pSchema->version) {
+      tsdbCacheColTableDestroy(pColCache, pTable);
+      taosHashRemove(pColCache->pTables, key, keyLen);
+      pTable = NULL;
+    }
+  }
+  if (pTable == NULL) {
+    code = tsdbCacheColTableCreate(pColCache, pr->suid, cacheType, pr->pSchema, &pTable);
+    if (code) goto _exit;
+
+    code = taosHashPut(pColCache->pTables, key, keyLen, &pTable, POINTER_BYTES);
+    if (code) {
+      tsdbCacheColTableDestroy(pColCache, pTable);
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      goto _exit;
+    }
+  }
+
+  for (int32_t i = 0; i < pr->numOfTables; ++i) {
+    tb_uid_t uid = pr->pTableList[i].uid;
+
+    getTableCacheKey(uid, cacheType, key, &keyLen);
+    SCacheColRow *pRow = taosHashGet(pColCache->pRows, key, keyLen);
+    if (pRow && pRow->pTable == pTable) {
+      pr->aColRow[i] = pRow->iRow;
+      continue;
+    }
+
+    code = tsdbCacheColTableReserve(pTsdb, pTable, pr->numOfTables - i, &fit);
+    if (code || !fit) goto _exit;
+
+    SCacheColRow row = {.pTable = pTable, .iRow = pTable->numOfRows};
+    code = taosHashPut(pColCache->pRows, key, keyLen, &row, sizeof(row));
+    if (code) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      goto _exit;
+    }
+    if (pRow == NULL) {
+      atomic_add_fetch_32(&pColCache->nRow, 1);
+    }
+
+    pTable->aUid[row.iRow] = uid;
+    pTable->aState[row.iRow] = TSDB_CACHE_COL_ROW_INVALID;
+    pTable->aVer[row.iRow] = 0;
+    pTable->numOfRows++;
+    pr->aColRow[i] = row.iRow;
+  }
+
+  pr->colGen = pTable->gen;
+
+_exit:
+  taosThreadRwlockUnlock(&pColCache->lock);
+  return code;
+}
+
+// get the columnar table the rows of the reader are resolved in, with the lock of the columnar cache held
+SCacheColTable *tsdbCacheColGet(STsdb *pTsdb, SCacheRowsReader *pr, int8_t cacheType) {
+  char key[32] = {0};
+  int  keyLen = 0;
+
+  getTableCacheKey(pr->suid, cacheType, key, &keyLen);
+  SCacheColTable **ppTable = taosHashGet(pTsdb->pColCache->pTables, key, keyLen);
+  if (ppTable == NULL || (*ppTable)->gen != pr->colGen) {
+    return NULL;
+  }
+
+  return *ppTable;
+}
+
+// fill a row with the lru entry pLastArray got by a reader, unless the row is changed after ver is read
+void tsdbCacheColFill(STsdb *pTsdb, SCacheRowsReader *pr, int8_t cacheType, int32_t iRow, uint32_t ver,
+                      SArray *pLastArray) {
+  STsdbColCache *pColCache = pTsdb->pColCache;
+
+  taosThreadRwlockWrlock(&pColCache->lock);
+  SCacheColTable *pTable = tsdbCacheColGet(pTsdb, pr, cacheType);
+  if (pTable && pTable->aVer[iRow] == ver && pTable->aState[iRow] == TSDB_CACHE_COL_ROW_INVALID) {
+    if (pLastArray == NULL) {
+      pTable->aState[iRow] = TSDB_CACHE_COL_ROW_EMPTY;
+    } else {
+      (void)tsdbCacheColSetRow(pTable, iRow, pLastArray);
+    }
+  }
+  taosThreadRwlockUnlock(&pColCache->lock);
+}
+
 int32_t tsdbCacheDeleteLastrow(SLRUCache *pCache, tb_uid_t uid, TSKEY eKey) {
   int32_t code = 0;
 
@@ -190,7 +1614,7 @@ int32_t tsdbCacheDelete(SLRUCache *pCache, tb_uid_t uid, TSKEY eKey) {
   return code;
 }
 
-int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, STSRow *row, bool dup) {
+int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, int64_t version, STSRow *row, bool dup) {
   int32_t code = 0;
   STSRow *cacheRow = NULL;
   char    key[32] = {0};
@@ -199,6 +1623,9 @@ int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, ST
   // getTableCacheKey(uid, "lr", key, &keyLen);
   getTableCacheKey(uid, 0, key, &keyLen);
   LRUHandle *h = taosLRUCacheLookup(pCache, key, keyLen);
+  if (!h) {
+    h = tsdbCacheFileLoadH(pTsdb, uid, version, key, keyLen);
+  }
   if (h) {
     STSchema *pTSchema = metaGetTbTSchema(pTsdb->pVnode->pMeta, uid, -1, 1);
     TSKEY     keyTs = row->ts;
@@ -252,16 +1679,19 @@ int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, ST
   _invalidate:
     taosMemoryFreeClear(pTSchema);
 
+    tsdbCacheColUpdate(pTsdb, 0, uid, invalidate ? NULL : pLast);
     taosLRUCacheRelease(pCache, h, invalidate);
     if (invalidate) {
       taosLRUCacheErase(pCache, key, keyLen);
     }
+  } else {
+    tsdbCacheColUpdate(pTsdb, 0, uid, NULL);
   }
 
   return code;
 }
 
-int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, STSRow *row, STsdb *pTsdb) {
+int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, int64_t version, STSRow *row, STsdb *pTsdb) {
   int32_t code = 0;
   STSRow *cacheRow = NULL;
   char    key[32] = {0};
@@ -270,6 +1700,9 @@ int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, STSRow *row, STsdb
   // getTableCacheKey(uid, "l", key, &keyLen);
   getTableCacheKey(uid, 1, key, &keyLen);
   LRUHandle *h = taosLRUCacheLookup(pCache, key, keyLen);
+  if (!h) {
+    h = tsdbCacheFileLoadH(pTsdb, uid, version, key, keyLen);
+  }
   if (h) {
     STSchema *pTSchema = metaGetTbTSchema(pTsdb->pVnode->pMeta, uid, -1, 1);
     TSKEY     keyTs = row->ts;
@@ -323,10 +1756,13 @@ int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, STSRow *row, STsdb
   _invalidate:
     taosMemoryFreeClear(pTSchema);
 
+    tsdbCacheColUpdate(pTsdb, 1, uid, invalidate ? NULL : pLast);
     taosLRUCacheRelease(pCache, h, invalidate);
     if (invalidate) {
       taosLRUCacheErase(pCache, key, keyLen);
     }
+  } else {
+    tsdbCacheColUpdate(pTsdb, 1, uid, NULL);
   }
 
   return code;
@@ -1372,7 +2808,16 @@ int32_t tsdbCacheGetLastrowH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *
     if (!h) {
       SArray *pArray = NULL;
       bool    dup = false;  // which is always false for now
-      code = mergeLastRow(uid, pTsdb, &dup, &pArray, pr);
+      bool    merged = false;
+      tsdbCacheFileGet(pTsdb, uid, VERSION_MAX, *(uint64_t *)key, &pArray);
+      if (pArray && !tsdbCacheLastMatchSchema(pArray, pr->pSchema)) {
+        deleteTableCacheLast(NULL, 0, pArray);
+        pArray = NULL;
+      }
+      if (pArray == NULL) {
+        code = mergeLastRow(uid, pTsdb, &dup, &pArray, pr);
+        merged = true;
+      }
       // if table's empty or error, return code of -1
       if (code < 0 || pArray == NULL) {
         if (!dup && pArray) {
@@ -1386,11 +2831,13 @@ int32_t tsdbCacheGetLastrowH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *
         return 0;
       }
 
-      size_t              charge = pArray->capacity * pArray->elemSize + sizeof(*pArray);
+      size_t              charge = tsdbCacheLastCharge(pArray);
       _taos_lru_deleter_t deleter = deleteTableCacheLast;
       LRUStatus status = taosLRUCacheInsert(pCache, key, keyLen, pArray, charge, deleter, &h, TAOS_LRU_PRIORITY_LOW);
       if (status != TAOS_LRU_STATUS_OK) {
         code = -1;
+      } else if (merged) {
+        tsdbCacheFileSetDirty(pTsdb, key);
       }
 
       // taosThreadMutexUnlock(&pTsdb->lruMutex);
@@ -1445,7 +2892,16 @@ int32_t tsdbCacheGetLastH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *pr,
     h = taosLRUCacheLookup(pCache, key, keyLen);
     if (!h) {
       SArray *pLastArray = NULL;
-      code = mergeLast(uid, pTsdb, &pLastArray, pr);
+      bool    merged = false;
+      tsdbCacheFileGet(pTsdb, uid, VERSION_MAX, *(uint64_t *)key, &pLastArray);
+      if (pLastArray && !tsdbCacheLastMatchSchema(pLastArray, pr->pSchema)) {
+        deleteTableCacheLast(NULL, 0, pLastArray);
+        pLastArray = NULL;
+      }
+      if (pLastArray == NULL) {
+        code = mergeLast(uid, pTsdb, &pLastArray, pr);
+        merged = true;
+      }
       // if table's empty or error, return code of -1
       if (code < 0 || pLastArray == NULL) {
         taosThreadMutexUnlock(&pTsdb->lruMutex);
@@ -1454,12 +2910,14 @@ int32_t tsdbCacheGetLastH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *pr,
         return 0;
       }
 
-      size_t              charge = pLastArray->capacity * pLastArray->elemSize + sizeof(*pLastArray);
+      size_t              charge = tsdbCacheLastCharge(pLastArray);
       _taos_lru_deleter_t deleter = deleteTableCacheLast;
       LRUStatus           status =
           taosLRUCacheInsert(pCache, key, keyLen, pLastArray, charge, deleter, &h, TAOS_LRU_PRIORITY_LOW);
       if (status != TAOS_LRU_STATUS_OK) {
         code = -1;
+      } else if (merged) {
+        tsdbCacheFileSetDirty(pTsdb, key);
       }
 
       // taosThreadMutexUnlock(&pTsdb->lruMutex);
@@ -1484,7 +2942,13 @@ int32_t tsdbCacheRelease(SLRUCache *pCache, LRUHandle *h) {
 }
 
 void tsdbCacheSetCapacity(SVnode *pVnode, size_t capacity) {
+  STsdbColCache *pColCache = pVnode->pTsdb->pColCache;
+
   taosLRUCacheSetCapacity(pVnode->pTsdb->lruCache, capacity);
+
+  taosThreadRwlockWrlock(&pColCache->lock);
+  tsdbCacheColClear(pColCache);
+  taosThreadRwlockUnlock(&pColCache->lock);
 }
 
 size_t tsdbCacheGetCapacity(SVnode *pVnode) { return taosLRUCacheGetCapacity(pVnode->pTsdb->lruCache); }
@@ -1493,6 +2957,9 @@ size_t tsdbCacheGetUsage(SVnode *pVnode) {
   size_t usage = 0;
   if (pVnode->pTsdb != NULL) {
     usage = taosLRUCacheGetUsage(pVnode->pTsdb->lruCache);
+    if (pVnode->pTsdb->pColCache != NULL) {
+      usage += atomic_load_64(&pVnode->pTsdb->pColCache->size);
+    }
   }
 
   return usage;
@@ -159,6 +159,7 @@ void* tsdbCacherowsReaderClose(void* pReader) {
   }
 
   destroyLastBlockLoadInfo(p->pLoadInfo);
+  taosMemoryFree(p->aColRow);
 
   taosMemoryFree(pReader);
   return NULL;
@@ -194,6 +195,178 @@ static void freeItem(void* pItem) {
   }
 }
 
+static bool colTableRowAllNull(SCacheColTable* pTable, int32_t iRow, const int32_t* slotIds, int32_t numOfCols) {
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    if (slotIds[i] == -1 || pTable->aFlag[slotIds[i]][iRow]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// copy the rows aOut of the columnar table to the result block column by column
+static void saveColTableRows(SCacheColTable* pTable, const int32_t* aOut, int32_t nOut, SSDataBlock* pBlock,
+                             SCacheRowsReader* pReader, const int32_t* slotIds, void** pRes) {
+  int32_t numOfRows = pBlock->info.rows;
+
+  for (int32_t i = 0; i < pReader->numOfCols; ++i) {
+    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, i);
+    int32_t          iCol = (slotIds[i] == -1) ? 0 : slotIds[i];
+    STColumn*        pTColumn = &pTable->pTSchema->columns[iCol];
+    const int8_t*    aFlag = pTable->aFlag[iCol];
+    const char*      pData = pTable->aData[iCol];
+
+    if (HASTYPE(pReader->type, CACHESCAN_RETRIEVE_LAST)) {
+      SFirstLastRes* p = (SFirstLastRes*)varDataVal(pRes[i]);
+
+      for (int32_t j = 0; j < nOut; ++j) {
+        int32_t     iRow = aOut[j];
+        const char* pSlot = pData + (int64_t)iRow * pTColumn->bytes;
+
+        p->ts = pTable->aTs[iCol][iRow];
+        if (slotIds[i] == -1) {  // the primary timestamp
+          p->bytes = TSDB_KEYSIZE;
+          *(int64_t*)p->buf = p->ts;
+        } else {
+          p->isNull = !aFlag[iRow];
+          if (!p->isNull) {
+            p->bytes = IS_VAR_DATA_TYPE(pTColumn->type) ? varDataTLen(pSlot) : pTColumn->bytes;
+            memcpy(p->buf, pSlot, p->bytes);
+          }
+        }
+
+        p->hasResult = true;
+        varDataSetLen(pRes[i], pColInfoData->info.bytes - VARSTR_HEADER_SIZE);
+        colDataAppend(pColInfoData, numOfRows + j, (const char*)pRes[i], false);
+      }
+    } else if (IS_VAR_DATA_TYPE(pTColumn->type) || pColInfoData->info.bytes != pTColumn->bytes) {
+      for (int32_t j = 0; j < nOut; ++j) {
+        int32_t iRow = aOut[j];
+        colDataAppend(pColInfoData, numOfRows + j, pData + (int64_t)iRow * pTColumn->bytes, !aFlag[iRow]);
+      }
+    } else {
+      // the rows of the tables are mostly in the order of the table list, copy them in runs
+      int32_t bytes = pTColumn->bytes;
+      for (int32_t j = 0; j < nOut;) {
+        int32_t k = j + 1;
+        while (k < nOut && aOut[k] == aOut[k - 1] + 1) {
+          ++k;
+        }
+
+        memcpy(pColInfoData->pData + (int64_t)(numOfRows + j) * bytes, pData + (int64_t)aOut[j] * bytes,
+               (int64_t)(k - j) * bytes);
+        j = k;
+      }
+
+      for (int32_t j = 0; j < nOut; ++j) {
+        if (!aFlag[aOut[j]]) {
+          colDataSetNull_f(pColInfoData->nullbitmap, numOfRows + j);
+          pColInfoData->hasNull = true;
+        }
+      }
+    }
+  }
+
+  pBlock->info.rows += nOut;
+}
+
+// retrieve the rows of all the tables from the columnar table of the super table, starting from pr->tableIndex. The
+// rows not filled yet are got from the lru cache one by one and filled for the following scans.
+static int32_t retrieveColTableRows(SCacheRowsReader* pr, SSDataBlock* pResBlock, const int32_t* slotIds, void** pRes,
+                                    SArray* pTableUidList) {
+  int32_t        code = TSDB_CODE_SUCCESS;
+  STsdb*         pTsdb = pr->pVnode->pTsdb;
+  STsdbColCache* pColCache = pTsdb->pColCache;
+  SLRUCache*     lruCache = pTsdb->lruCache;
+  int8_t         cacheType = HASTYPE(pr->type, CACHESCAN_RETRIEVE_LAST_ROW) ? 0 : 1;
+  int32_t*       aOut = NULL;
+
+  if (pr->suid == 0 || pr->numOfTables <= 1 || pr->colGen < 0) {
+    return code;
+  }
+
+  if (pr->colGen == 0) {
+    code = tsdbCacheColAcquire(pTsdb, pr, cacheType);
+    if (code != TSDB_CODE_SUCCESS || pr->colGen < 0) {
+      return code;
+    }
+  }
+
+  aOut = taosMemoryMalloc(sizeof(int32_t) * pResBlock->info.capacity);
+  if (aOut == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  while (pr->tableIndex < pr->numOfTables && pResBlock->info.rows < pResBlock->info.capacity) {
+    int32_t nOut = 0;
+    int32_t nLeft = pResBlock->info.capacity - pResBlock->info.rows;
+    int32_t iTable = pr->tableIndex;
+    int32_t iRow = -1;
+    int8_t  state = TSDB_CACHE_COL_ROW_INVALID;
+
+    taosThreadRwlockRdlock(&pColCache->lock);
+
+    SCacheColTable* pTable = tsdbCacheColGet(pTsdb, pr, cacheType);
+    if (pTable == NULL) {  // rebuilt by a scan of another schema version, or dropped
+      taosThreadRwlockUnlock(&pColCache->lock);
+      pr->colGen = 0;
+      break;
+    }
+
+    for (; iTable < pr->numOfTables && nOut < nLeft; ++iTable) {
+      iRow = pr->aColRow[iTable];
+      state = pTable->aState[iRow];
+      if (state == TSDB_CACHE_COL_ROW_INVALID) {
+        break;
+      }
+
+      if (state == TSDB_CACHE_COL_ROW_VALID &&
+          (cacheType == 0 || !colTableRowAllNull(pTable, iRow, slotIds, pr->numOfCols))) {
+        aOut[nOut++] = iRow;
+        taosArrayPush(pTableUidList, &pr->pTableList[iTable].uid);
+      }
+    }
+
+    if (nOut > 0) {
+      saveColTableRows(pTable, aOut, nOut, pResBlock, pr, slotIds, pRes);
+    }
+    pr->tableIndex = iTable;
+
+    if (iTable >= pr->numOfTables || state != TSDB_CACHE_COL_ROW_INVALID ||
+        pResBlock->info.rows >= pResBlock->info.capacity) {
+      taosThreadRwlockUnlock(&pColCache->lock);
+      continue;
+    }
+
+    // fill the row from the lru cache, which may load the table, outside of the lock
+    uint32_t ver = pTable->aVer[iRow];
+    taosThreadRwlockUnlock(&pColCache->lock);
+
+    LRUHandle* h = NULL;
+    SArray*    pRow = NULL;
+    uint64_t   uid = pr->pTableList[iTable].uid;
+
+    code = doExtractCacheRow(pr, lruCache, uid, &pRow, &h);
+    if (code != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    tsdbCacheColFill(pTsdb, pr, cacheType, iRow, ver, pRow);
+    if (h != NULL) {
+      int32_t numOfRows = pResBlock->info.rows;
+      saveOneRow(pRow, pResBlock, pr, slotIds, pRes);
+      if (pResBlock->info.rows > numOfRows) {
+        taosArrayPush(pTableUidList, &uid);
+      }
+      tsdbCacheRelease(lruCache, h);
+    }
+    pr->tableIndex += 1;
+  }
+
+  taosMemoryFree(aOut);
+  return code;
+}
+
 int32_t tsdbRetrieveCacheRows(void* pReader, SSDataBlock* pResBlock, const int32_t* slotIds, SArray* pTableUidList) {
   if (pReader == NULL || pResBlock == NULL) {
     return TSDB_CODE_INVALID_PARA;
@@ -312,6 +485,11 @@ int32_t tsdbRetrieveCacheRows(void* pReader, SSDataBlock* pResBlock, const int32
     }
 
   } else if (HASTYPE(pr->type, CACHESCAN_RETRIEVE_TYPE_ALL)) {
+    code = retrieveColTableRows(pr, pResBlock, slotIds, pRes, pTableUidList);
+    if (code != TSDB_CODE_SUCCESS || pResBlock->info.rows >= pResBlock->info.capacity) {
+      goto _end;
+    }
+
     for (int32_t i = pr->tableIndex; i < pr->numOfTables; ++i) {
       STableKeyInfo* pKeyInfo = &pr->pTableList[i];
       code = doExtractCacheRow(pr, lruCache, pKeyInfo->uid, &pRow, &h);
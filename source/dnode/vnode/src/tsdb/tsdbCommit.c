@@ -76,6 +76,7 @@ typedef struct {
     SDataFWriter *pWriter;
     SArray       *aBlockIdx;  // SArray<SBlockIdx>
     SArray       *aSttBlk;    // SArray<SSttBlk>
+    SArray       *aStbStats;  // SArray<STsdbStbStats>, of the data blocks indexed by the .head file
     SMapData      mBlock;     // SMapData<SDataBlk>
     SBlockData    bData;
 #if USE_STREAM_COMPRESSION
@@ -158,6 +159,9 @@ int32_t tsdbPrepareCommit(STsdb *pTsdb) {
   pTsdb->mem = NULL;
   taosThreadRwlockUnlock(&pTsdb->rwLock);
 
+  // the last cache holds exactly the data to commit now, a failed dump only skips the last cache file
+  (void)tsdbCachePrepareCheckpoint(pTsdb);
+
   return 0;
 }
 
@@ -572,6 +576,7 @@ static int32_t tsdbCommitFileDataStart(SCommitter *pCommitter) {
 
   taosArrayClear(pCommitter->dWriter.aBlockIdx);
   taosArrayClear(pCommitter->dWriter.aSttBlk);
+  taosArrayClear(pCommitter->dWriter.aStbStats);
   tMapDataReset(&pCommitter->dWriter.mBlock);
   tBlockDataReset(&pCommitter->dWriter.bData);
 #if USE_STREAM_COMPRESSION
@@ -745,6 +750,11 @@ static int32_t tsdbCommitFileDataEnd(SCommitter *pCommitter) {
   code = tsdbUpdateDFileSetHeader(pCommitter->dWriter.pWriter);
   TSDB_CHECK_CODE(code, lino, _exit);
 
+  // the stats of the super tables in the files written, so that they are not read again after the commit
+  code = tsdbStatsPutCommitted(pCommitter->pTsdb, &pCommitter->dWriter.pWriter->wSet, pCommitter->dWriter.aStbStats,
+                               pCommitter->dWriter.aSttBlk);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
   // upsert SDFileSet
   code = tsdbFSUpsertFSet(&pCommitter->fs, &pCommitter->dWriter.pWriter->wSet);
   TSDB_CHECK_CODE(code, lino, _exit);
@@ -775,6 +785,10 @@ static int32_t tsdbMoveCommitData(SCommitter *pCommitter, TABLEID toTable) {
     code = tsdbWriteDataBlk(pCommitter->dWriter.pWriter, &pCommitter->dReader.mBlock, &blockIdx);
     TSDB_CHECK_CODE(code, lino, _exit);
 
+    code =
+        tsdbStatsAddDataBlk(pCommitter->pTsdb, pCommitter->dWriter.aStbStats, &blockIdx, &pCommitter->dReader.mBlock);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
     if (taosArrayPush(pCommitter->dWriter.aBlockIdx, &blockIdx) == NULL) {
       code = TSDB_CODE_OUT_OF_MEMORY;
       TSDB_CHECK_CODE(code, lino, _exit);
@@ -830,6 +844,7 @@ static int32_t tsdbStartCommit(STsdb *pTsdb, SCommitter *pCommitter, SCommitInfo
 
   pCommitter->pTsdb = pTsdb;
   pCommitter->commitID = pInfo->info.state.commitID;
+  tsdbStatsBeginCommit(pTsdb);
   pCommitter->minutes = pTsdb->keepCfg.days;
   pCommitter->precision = pTsdb->keepCfg.precision;
   pCommitter->minRow = pInfo->info.config.tsdbCfg.minRows;
@@ -891,6 +906,12 @@ static int32_t tsdbCommitDataStart(SCommitter *pCommitter) {
     TSDB_CHECK_CODE(code, lino, _exit);
   }
 
+  pCommitter->dWriter.aStbStats = taosArrayInit(0, sizeof(STsdbStbStats));
+  if (pCommitter->dWriter.aStbStats == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
   code = tBlockDataCreate(&pCommitter->dWriter.bData);
   TSDB_CHECK_CODE(code, lino, _exit);
 
@@ -925,6 +946,7 @@ static void tsdbCommitDataEnd(SCommitter *pCommitter) {
   // writer
   taosArrayDestroy(pCommitter->dWriter.aBlockIdx);
   taosArrayDestroy(pCommitter->dWriter.aSttBlk);
+  taosArrayDestroy(pCommitter->dWriter.aStbStats);
   tMapDataClear(&pCommitter->dWriter.mBlock);
   tBlockDataDestroy(&pCommitter->dWriter.bData, 1);
 #if USE_STREAM_COMPRESSION
@@ -1619,6 +1641,10 @@ static int32_t tsdbCommitFileDataImpl(SCommitter *pCommitter) {
       code = tsdbWriteDataBlk(pCommitter->dWriter.pWriter, &pCommitter->dWriter.mBlock, &blockIdx);
       TSDB_CHECK_CODE(code, lino, _exit);
 
+      code =
+          tsdbStatsAddDataBlk(pCommitter->pTsdb, pCommitter->dWriter.aStbStats, &blockIdx, &pCommitter->dWriter.mBlock);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
       if (taosArrayPush(pCommitter->dWriter.aBlockIdx, &blockIdx) == NULL) {
         code = TSDB_CODE_OUT_OF_MEMORY;
         TSDB_CHECK_CODE(code, lino, _exit);
@@ -1669,6 +1695,9 @@ int32_t tsdbFinishCommit(STsdb *pTsdb) {
     tsdbUnrefMemTable(pMemTable);
   }
 
+  (void)tsdbCacheCheckpoint(pTsdb);
+  (void)tsdbStatsFinishCommit(pTsdb);
+
 _exit:
   if (code) {
     tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
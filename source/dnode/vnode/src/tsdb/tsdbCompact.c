@@ -15,13 +15,1131 @@
 
 #include "tsdb.h"
 
+// a file set is compacted when its fragmentation score reaches this value, see tsdbCompactScore()
+#define TSDB_COMPACT_MIN_SCORE    0.5
+#define TSDB_COMPACT_STT_WEIGHT   0.25
+#define TSDB_COMPACT_READ_AMP(ST) ((double)((ST)->nDataBlk + (ST)->nSttBlk) / TMAX((ST)->nMinBlk, 1))
+#define TSDB_COMPACT_MAX_SLEEP_MS 100  // the throttle sleeps in slices, so a closing vnode is not kept waiting
+
+extern int32_t tRowInfoCmprFn(const void *p1, const void *p2);
+extern int32_t tsdbReadDataBlockEx(SDataFReader *pReader, SDataBlk *pDataBlk, SBlockData *pBlockData);
+extern int32_t tsdbUpdateTableSchema(SMeta *pMeta, int64_t suid, int64_t uid, SSkmInfo *pSkmInfo);
+extern int32_t tsdbWriteDataBlock(SDataFWriter *pWriter, SBlockData *pBlockData, SMapData *mDataBlk, int8_t cmprAlg);
+
+typedef enum { COMPACT_DATA_FILE_ITER = 0, COMPACT_STT_FILE_ITER } ECompactIterT;
+
+typedef struct {
+  SRBTreeNode   n;
+  SRowInfo      rInfo;
+  ECompactIterT type;
+  union {
+    struct {
+      SArray    *aBlockIdx;  // SArray<SBlockIdx>
+      int32_t    iBlockIdx;
+      SBlockIdx *pBlockIdx;
+      SMapData   mDataBlk;  // SMapData<SDataBlk>
+      int32_t    iDataBlk;
+    };  // .data file
+    struct {
+      int32_t iStt;
+      SArray *aSttBlk;  // SArray<SSttBlk>
+      int32_t iSttBlk;
+    };  // .stt file
+  };
+  // blocks are loaded into the two buffers in turn, so the row returned before the last move stays valid
+  SBlockData aBData[2];
+  int32_t    iBData;
+  int32_t    iRow;
+} SCompactIter;
+
+typedef struct {
+  int64_t nRow;
+  int32_t nTable;
+  int32_t nDataBlk;
+  int32_t nSmallBlk;  // data blocks below minRows which are not the last block of their table
+  int32_t nSttBlk;
+  int32_t nMinBlk;   // blocks needed to hold the same rows if every table were written in full blocks
+  int32_t nDelData;  // tombstones overlapping the file set
+} SCompactStat;
+
+typedef struct {
+  SDFileSet   *pSet;  // file set in the snapshot compacted from
+  double       score;
+  SCompactStat before;
+  SCompactStat after;
+  int8_t       written;
+  int8_t       applied;
+  SHeadFile    fHead;
+  SDataFile    fData;
+  SSmaFile     fSma;
+  SSttFile     fStt;
+} SCompactFSet;
+
 typedef struct {
   STsdb  *pTsdb;
-  STsdbFS fs;
+  int64_t commitID;
+  int32_t minutes;
+  int8_t  precision;
+  int32_t minRow;
+  int32_t maxRow;
+  int8_t  cmprAlg;
+  STsdbFS fs;     // referenced snapshot of the file system
+  SArray *aFSet;  // SArray<SCompactFSet>, ordered by score
+  // I/O budget
+  int64_t startUs;
+  int64_t nBytes;
+  // tombstones
+  SArray  *aDelIdx;    // SArray<SDelIdx>
+  SArray  *aDelDataP;  // SArray<SArray<SDelData> *>, one for each SDelIdx
+  SArray  *aDelData;   // SArray<SDelData>, tombstones of the table in the file set being compacted
+  int64_t  nDelRow;
+  int32_t  nDelPurged;
+  int8_t   delWritten;
+  int8_t   delApplied;
+  SDelFile fDel;
+  // reader
+  SDataFReader *pReader;
+  SCompactIter *pIter;
+  SRBTree       rbt;
+  SCompactIter  aIter[TSDB_MAX_STT_TRIGGER + 1];
+  // writer
+  SDataFWriter *pWriter;
+  SArray       *aBlockIdx;  // SArray<SBlockIdx>
+  SArray       *aSttBlk;    // SArray<SSttBlk>
+  SMapData      mDataBlk;   // SMapData<SDataBlk>
+  SBlockData    bData;
+  SSkmInfo      skmTable;
 } STsdbCompactor;
 
-int32_t tsdbCompact(STsdb *pTsdb) {
+static int32_t tCompactIterCmprFn(const SRBTreeNode *n1, const SRBTreeNode *n2) {
+  SCompactIter *pIter1 = (SCompactIter *)((uint8_t *)n1 - offsetof(SCompactIter, n));
+  SCompactIter *pIter2 = (SCompactIter *)((uint8_t *)n2 - offsetof(SCompactIter, n));
+
+  return tRowInfoCmprFn(&pIter1->rInfo, &pIter2->rInfo);
+}
+
+static int32_t tCompactFSetCmprFn(const void *p1, const void *p2) {
+  double s1 = ((SCompactFSet *)p1)->score;
+  double s2 = ((SCompactFSet *)p2)->score;
+
+  if (s1 > s2) {
+    return -1;
+  } else if (s1 < s2) {
+    return 1;
+  }
+  return 0;
+}
+
+static FORCE_INLINE bool tsdbCompactIsStopped(STsdbCompactor *pCompactor) {
+  return atomic_load_8(&pCompactor->pTsdb->pVnode->stopCompact) != 0;
+}
+
+static void tsdbCompactThrottle(STsdbCompactor *pCompactor, int64_t nBytes) {
+  pCompactor->nBytes += nBytes;
+  if (tsCompactMaxSpeed <= 0) return;
+
+  int64_t expectUs = (int64_t)((double)pCompactor->nBytes / ((double)tsCompactMaxSpeed * 1024 * 1024) * 1000000);
+  int64_t sleepMs;
+  while (!tsdbCompactIsStopped(pCompactor) &&
+         (sleepMs = (expectUs - (taosGetTimestampUs() - pCompactor->startUs)) / 1000) > 0) {
+    taosMsleep((int32_t)TMIN(sleepMs, TSDB_COMPACT_MAX_SLEEP_MS));
+  }
+}
+
+// Tables may have several versions of a row with the same timestamp, a row is dropped when a tombstone of a higher
+// or equal version covers it
+static bool tsdbCompactRowIsDeleted(SArray *aDelData, TSDBROW *pRow) {
+  TSDBKEY key = TSDBROW_KEY(pRow);
+
+  for (int32_t iDelData = 0; iDelData < taosArrayGetSize(aDelData); iDelData++) {
+    SDelData *pDelData = (SDelData *)taosArrayGet(aDelData, iDelData);
+    if (pDelData->version >= key.version && pDelData->sKey <= key.ts && pDelData->eKey >= key.ts) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// tombstones ==============================================================================================
+static int32_t tsdbCompactReadDel(STsdbCompactor *pCompactor) {
+  int32_t      code = 0;
+  int32_t      lino = 0;
+  STsdb       *pTsdb = pCompactor->pTsdb;
+  SDelFReader *pDelFReader = NULL;
+
+  if (pCompactor->fs.pDelFile == NULL) goto _exit;
+
+  code = tsdbDelFReaderOpen(&pDelFReader, pCompactor->fs.pDelFile, pTsdb);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbReadDelIdx(pDelFReader, pCompactor->aDelIdx);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  for (int32_t iDelIdx = 0; iDelIdx < taosArrayGetSize(pCompactor->aDelIdx); iDelIdx++) {
+    SDelIdx *pDelIdx = (SDelIdx *)taosArrayGet(pCompactor->aDelIdx, iDelIdx);
+    SArray  *aDelData = taosArrayInit(0, sizeof(SDelData));
+    if (aDelData == NULL || taosArrayPush(pCompactor->aDelDataP, &aDelData) == NULL) {
+      taosArrayDestroy(aDelData);
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    code = tsdbReadDelData(pDelFReader, pDelIdx, aDelData);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    pCompactor->nDelRow += taosArrayGetSize(aDelData);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  tsdbDelFReaderClose(&pDelFReader);
+  return code;
+}
+
+static int32_t tsdbCompactCountDel(STsdbCompactor *pCompactor, TSKEY minKey, TSKEY maxKey) {
+  int32_t nDelData = 0;
+
+  for (int32_t iDelIdx = 0; iDelIdx < taosArrayGetSize(pCompactor->aDelDataP); iDelIdx++) {
+    SArray *aDelData = (SArray *)taosArrayGetP(pCompactor->aDelDataP, iDelIdx);
+    for (int32_t iDelData = 0; iDelData < taosArrayGetSize(aDelData); iDelData++) {
+      SDelData *pDelData = (SDelData *)taosArrayGet(aDelData, iDelData);
+      if (pDelData->sKey <= maxKey && pDelData->eKey >= minKey) nDelData++;
+    }
+  }
+
+  return nDelData;
+}
+
+// collect the tombstones of a table which overlap the file set being compacted
+static int32_t tsdbCompactSetTableDel(STsdbCompactor *pCompactor, TABLEID *pId, TSKEY minKey, TSKEY maxKey) {
+  taosArrayClear(pCompactor->aDelData);
+
+  SDelIdx delIdx = {.suid = pId->suid, .uid = pId->uid};
+  int32_t idx = taosArraySearchIdx(pCompactor->aDelIdx, &delIdx, tCmprDelIdx, TD_EQ);
+  if (idx < 0) return 0;
+
+  SArray *aDelData = (SArray *)taosArrayGetP(pCompactor->aDelDataP, idx);
+  for (int32_t iDelData = 0; iDelData < taosArrayGetSize(aDelData); iDelData++) {
+    SDelData *pDelData = (SDelData *)taosArrayGet(aDelData, iDelData);
+    if (pDelData->sKey <= maxKey && pDelData->eKey >= minKey) {
+      if (taosArrayPush(pCompactor->aDelData, pDelData) == NULL) return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+
+  return 0;
+}
+
+// A tombstone is no longer needed once every file set it overlaps has been rewritten without the rows it covers.
+// Rows older than a tombstone are always committed together with or before it, so the memory tables never hold any.
+static bool tsdbCompactDelIsPurgeable(STsdbCompactor *pCompactor, SDelData *pDelData) {
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(pCompactor->fs.aDFileSet); iSet++) {
+    SDFileSet *pSet = (SDFileSet *)taosArrayGet(pCompactor->fs.aDFileSet, iSet);
+    TSKEY      minKey, maxKey;
+
+    tsdbFidKeyRange(pSet->fid, pCompactor->minutes, pCompactor->precision, &minKey, &maxKey);
+    if (pDelData->sKey > maxKey || pDelData->eKey < minKey) continue;
+
+    bool written = false;
+    for (int32_t iFSet = 0; iFSet < taosArrayGetSize(pCompactor->aFSet); iFSet++) {
+      SCompactFSet *pCSet = (SCompactFSet *)taosArrayGet(pCompactor->aFSet, iFSet);
+      if (pCSet->pSet->fid == pSet->fid) {
+        written = pCSet->written;
+        break;
+      }
+    }
+    if (!written) return false;
+  }
+
+  return true;
+}
+
+static int32_t tsdbCompactDel(STsdbCompactor *pCompactor) {
+  int32_t      code = 0;
+  int32_t      lino = 0;
+  STsdb       *pTsdb = pCompactor->pTsdb;
+  SDelFWriter *pDelFWriter = NULL;
+  SArray      *aDelIdx = NULL;
+  SArray      *aDelData = NULL;
+
+  if (pCompactor->nDelRow == 0) goto _exit;
+
+  int32_t nPurged = 0;
+  for (int32_t iDelIdx = 0; iDelIdx < taosArrayGetSize(pCompactor->aDelDataP); iDelIdx++) {
+    SArray *aTbDelData = (SArray *)taosArrayGetP(pCompactor->aDelDataP, iDelIdx);
+    for (int32_t iDelData = 0; iDelData < taosArrayGetSize(aTbDelData); iDelData++) {
+      if (tsdbCompactDelIsPurgeable(pCompactor, (SDelData *)taosArrayGet(aTbDelData, iDelData))) nPurged++;
+    }
+  }
+  if (nPurged == 0) goto _exit;
+
+  aDelIdx = taosArrayInit(0, sizeof(SDelIdx));
+  aDelData = taosArrayInit(0, sizeof(SDelData));
+  if (aDelIdx == NULL || aDelData == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  SDelFile fDel = {.commitID = pCompactor->commitID, .size = 0, .offset = 0};
+  code = tsdbDelFWriterOpen(&pDelFWriter, &fDel, pTsdb);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  pCompactor->delWritten = 1;
+  pCompactor->fDel = fDel;
+
+  for (int32_t iDelIdx = 0; iDelIdx < taosArrayGetSize(pCompactor->aDelIdx); iDelIdx++) {
+    SDelIdx *pDelIdx = (SDelIdx *)taosArrayGet(pCompactor->aDelIdx, iDelIdx);
+    SArray  *aTbDelData = (SArray *)taosArrayGetP(pCompactor->aDelDataP, iDelIdx);
+
+    taosArrayClear(aDelData);
+    for (int32_t iDelData = 0; iDelData < taosArrayGetSize(aTbDelData); iDelData++) {
+      SDelData *pDelData = (SDelData *)taosArrayGet(aTbDelData, iDelData);
+      if (tsdbCompactDelIsPurgeable(pCompactor, pDelData)) continue;
+
+      if (taosArrayPush(aDelData, pDelData) == NULL) {
+        code = TSDB_CODE_OUT_OF_MEMORY;
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+    }
+    if (taosArrayGetSize(aDelData) == 0) continue;
+
+    SDelIdx delIdx = {.suid = pDelIdx->suid, .uid = pDelIdx->uid};
+    code = tsdbWriteDelData(pDelFWriter, aDelData, &delIdx);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (taosArrayPush(aDelIdx, &delIdx) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+  code = tsdbWriteDelIdx(pDelFWriter, aDelIdx);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbUpdateDelFileHdr(pDelFWriter);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  pCompactor->fDel = pDelFWriter->fDel;
+  pCompactor->nDelPurged = nPurged;
+
+  code = tsdbDelFWriterClose(&pDelFWriter, 1);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+    tsdbDelFWriterClose(&pDelFWriter, 0);
+  }
+  taosArrayDestroy(aDelIdx);
+  taosArrayDestroy(aDelData);
+  return code;
+}
+
+// pick ==============================================================================================
+static int32_t tsdbCompactStatFSet(STsdbCompactor *pCompactor, SDFileSet *pSet, SCompactStat *pStat) {
+  int32_t       code = 0;
+  int32_t       lino = 0;
+  STsdb        *pTsdb = pCompactor->pTsdb;
+  SDataFReader *pReader = NULL;
+  TSKEY         minKey, maxKey;
+
+  memset(pStat, 0, sizeof(*pStat));
+
+  code = tsdbDataFReaderOpen(&pReader, pTsdb, pSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // .data file
+  code = tsdbReadBlockIdx(pReader, pCompactor->aBlockIdx);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  for (int32_t iBlockIdx = 0; iBlockIdx < taosArrayGetSize(pCompactor->aBlockIdx); iBlockIdx++) {
+    SBlockIdx *pBlockIdx = (SBlockIdx *)taosArrayGet(pCompactor->aBlockIdx, iBlockIdx);
+
+    code = tsdbReadDataBlk(pReader, pBlockIdx, &pCompactor->mDataBlk);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    tsdbCompactThrottle(pCompactor, pBlockIdx->size);
+
+    int64_t nRow = 0;
+    for (int32_t iDataBlk = 0; iDataBlk < pCompactor->mDataBlk.nItem; iDataBlk++) {
+      SDataBlk dataBlk;
+      tMapDataGetItemByIdx(&pCompactor->mDataBlk, iDataBlk, &dataBlk, tGetDataBlk);
+
+      nRow += dataBlk.nRow;
+      pStat->nDataBlk++;
+      if (dataBlk.nRow < pCompactor->minRow && iDataBlk < pCompactor->mDataBlk.nItem - 1) {
+        pStat->nSmallBlk++;
+      }
+    }
+
+    pStat->nRow += nRow;
+    pStat->nTable++;
+    pStat->nMinBlk += (nRow + pCompactor->maxRow - 1) / pCompactor->maxRow;
+  }
+
+  // .stt files, rows of a table in them could have filled up its last data block
+  int64_t nSttRow = 0;
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    code = tsdbReadSttBlk(pReader, iStt, pCompactor->aSttBlk);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    for (int32_t iSttBlk = 0; iSttBlk < taosArrayGetSize(pCompactor->aSttBlk); iSttBlk++) {
+      SSttBlk *pSttBlk = (SSttBlk *)taosArrayGet(pCompactor->aSttBlk, iSttBlk);
+      nSttRow += pSttBlk->nRow;
+      pStat->nSttBlk++;
+    }
+  }
+  pStat->nRow += nSttRow;
+  pStat->nMinBlk += (nSttRow + pCompactor->maxRow - 1) / pCompactor->maxRow;
+
+  // tombstones
+  tsdbFidKeyRange(pSet->fid, pCompactor->minutes, pCompactor->precision, &minKey, &maxKey);
+  pStat->nDelData = tsdbCompactCountDel(pCompactor, minKey, maxKey);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  tsdbDataFReaderClose(&pReader);
+  return code;
+}
+
+/*
+ * The score adds up what a query pays for the layout of a file set:
+ * 1. every .stt file is one more input to merge for each table;
+ * 2. small data blocks and .stt blocks are read and decompressed with a higher cost per row;
+ * 3. tombstones are checked against each row read, and hold the space of the rows they delete.
+ */
+static double tsdbCompactScore(SCompactStat *pStat, int32_t nSttF) {
+  int32_t nBlk = pStat->nDataBlk + pStat->nSttBlk;
+  if (nBlk == 0) return 0;
+
+  double score = TSDB_COMPACT_STT_WEIGHT * (nSttF - 1);
+  score += (double)(pStat->nSmallBlk + pStat->nSttBlk) / nBlk;
+  score += (double)pStat->nDelData / TMAX(pStat->nTable, 1);
+  return score;
+}
+
+static int32_t tsdbCompactPick(STsdbCompactor *pCompactor) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  STsdb  *pTsdb = pCompactor->pTsdb;
+  int64_t now = taosGetTimestampSec();
+
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(pCompactor->fs.aDFileSet); iSet++) {
+    SDFileSet   *pSet = (SDFileSet *)taosArrayGet(pCompactor->fs.aDFileSet, iSet);
+    SCompactFSet cSet = {.pSet = pSet};
+
+    // expired file sets are removed by retention
+    if (tsdbFidLevel(pSet->fid, &pTsdb->keepCfg, now) < 0) continue;
+
+    code = tsdbCompactStatFSet(pCompactor, pSet, &cSet.before);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    cSet.score = tsdbCompactScore(&cSet.before, pSet->nSttF);
+    tsdbDebug("vgId:%d, fid:%d compact score:%.2f, read amplification:%.2f nSttF:%d nDataBlk:%d nSmallBlk:%d "
+              "nSttBlk:%d nDelData:%d",
+              TD_VID(pTsdb->pVnode), pSet->fid, cSet.score, TSDB_COMPACT_READ_AMP(&cSet.before), pSet->nSttF,
+              cSet.before.nDataBlk, cSet.before.nSmallBlk, cSet.before.nSttBlk, cSet.before.nDelData);
+
+    if (cSet.score < TSDB_COMPACT_MIN_SCORE) continue;
+
+    if (taosArrayPush(pCompactor->aFSet, &cSet) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+  taosArraySort(pCompactor->aFSet, tCompactFSetCmprFn);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
+// merge ==============================================================================================
+static int32_t tsdbCompactIterNext(STsdbCompactor *pCompactor, SCompactIter *pIter, int8_t *hasRow) {
+  int32_t     code = 0;
+  int32_t     lino = 0;
+  SBlockData *pBData = &pIter->aBData[pIter->iBData];
+
+  *hasRow = 1;
+  pIter->iRow++;
+  if (pIter->iRow < pBData->nRow) goto _set_row;
+
+  if (pIter->type == COMPACT_DATA_FILE_ITER) {
+    while (pIter->pBlockIdx == NULL || pIter->iDataBlk + 1 >= pIter->mDataBlk.nItem) {
+      pIter->iBlockIdx++;
+      if (pIter->iBlockIdx >= taosArrayGetSize(pIter->aBlockIdx)) {
+        *hasRow = 0;
+        goto _exit;
+      }
+
+      pIter->pBlockIdx = (SBlockIdx *)taosArrayGet(pIter->aBlockIdx, pIter->iBlockIdx);
+      code = tsdbReadDataBlk(pCompactor->pReader, pIter->pBlockIdx, &pIter->mDataBlk);
+      TSDB_CHECK_CODE(code, lino, _exit);
+      tsdbCompactThrottle(pCompactor, pIter->pBlockIdx->size);
+
+      pIter->iDataBlk = -1;
+    }
+
+    SDataBlk dataBlk;
+    pIter->iDataBlk++;
+    tMapDataGetItemByIdx(&pIter->mDataBlk, pIter->iDataBlk, &dataBlk, tGetDataBlk);
+
+    pIter->iBData ^= 1;
+    pBData = &pIter->aBData[pIter->iBData];
+    code = tsdbReadDataBlockEx(pCompactor->pReader, &dataBlk, pBData);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    tsdbCompactThrottle(pCompactor, dataBlk.aSubBlock[0].szBlock);
+  } else {
+    pIter->iSttBlk++;
+    if (pIter->iSttBlk >= taosArrayGetSize(pIter->aSttBlk)) {
+      *hasRow = 0;
+      goto _exit;
+    }
+
+    SSttBlk *pSttBlk = (SSttBlk *)taosArrayGet(pIter->aSttBlk, pIter->iSttBlk);
+
+    pIter->iBData ^= 1;
+    pBData = &pIter->aBData[pIter->iBData];
+    code = tsdbReadSttBlockEx(pCompactor->pReader, pIter->iStt, pSttBlk, pBData);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    tsdbCompactThrottle(pCompactor, pSttBlk->bInfo.szBlock);
+  }
+
+  ASSERT(pBData->nRow > 0);
+  pIter->iRow = 0;
+
+_set_row:
+  pIter->rInfo.suid = pBData->suid;
+  pIter->rInfo.uid = pBData->uid ? pBData->uid : pBData->aUid[pIter->iRow];
+  pIter->rInfo.row = tsdbRowFromBlockData(pBData, pIter->iRow);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactNextRow(STsdbCompactor *pCompactor) {
   int32_t code = 0;
-  // TODO
+  int32_t lino = 0;
+  int8_t  hasRow;
+
+  if (pCompactor->pIter) {
+    code = tsdbCompactIterNext(pCompactor, pCompactor->pIter, &hasRow);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (!hasRow) {
+      pCompactor->pIter = NULL;
+    }
+
+    // compare with min in RB Tree
+    SCompactIter *pIter = (SCompactIter *)tRBTreeMin(&pCompactor->rbt);
+    if (pCompactor->pIter && pIter) {
+      int32_t c = tRowInfoCmprFn(&pCompactor->pIter->rInfo, &pIter->rInfo);
+      if (c > 0) {
+        tRBTreePut(&pCompactor->rbt, (SRBTreeNode *)pCompactor->pIter);
+        pCompactor->pIter = NULL;
+      } else {
+        ASSERT(c);
+      }
+    }
+  }
+
+  if (pCompactor->pIter == NULL) {
+    pCompactor->pIter = (SCompactIter *)tRBTreeMin(&pCompactor->rbt);
+    if (pCompactor->pIter) {
+      tRBTreeDrop(&pCompactor->rbt, (SRBTreeNode *)pCompactor->pIter);
+    }
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static FORCE_INLINE SRowInfo *tsdbCompactGetRow(STsdbCompactor *pCompactor, TABLEID *pId) {
+  if (pCompactor->pIter == NULL) return NULL;
+
+  SRowInfo *pRowInfo = &pCompactor->pIter->rInfo;
+  if (pId && (pRowInfo->suid != pId->suid || pRowInfo->uid != pId->uid)) return NULL;
+  return pRowInfo;
+}
+
+static int32_t tsdbCompactOpenIter(STsdbCompactor *pCompactor, SDFileSet *pSet) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  int8_t  hasRow;
+
+  pCompactor->pIter = NULL;
+  tRBTreeCreate(&pCompactor->rbt, tCompactIterCmprFn);
+
+  // .data file
+  SCompactIter *pIter = &pCompactor->aIter[0];
+  pIter->type = COMPACT_DATA_FILE_ITER;
+  pIter->iBlockIdx = -1;
+  pIter->pBlockIdx = NULL;
+  pIter->iRow = -1;
+  tBlockDataReset(&pIter->aBData[pIter->iBData]);
+
+  code = tsdbReadBlockIdx(pCompactor->pReader, pIter->aBlockIdx);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactIterNext(pCompactor, pIter, &hasRow);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  if (hasRow) {
+    tRBTreePut(&pCompactor->rbt, (SRBTreeNode *)pIter);
+  }
+
+  // .stt files
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    pIter = &pCompactor->aIter[iStt + 1];
+    pIter->type = COMPACT_STT_FILE_ITER;
+    pIter->iStt = iStt;
+    pIter->iSttBlk = -1;
+    pIter->iRow = -1;
+    tBlockDataReset(&pIter->aBData[pIter->iBData]);
+
+    code = tsdbReadSttBlk(pCompactor->pReader, iStt, pIter->aSttBlk);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tsdbCompactIterNext(pCompactor, pIter, &hasRow);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    if (hasRow) {
+      tRBTreePut(&pCompactor->rbt, (SRBTreeNode *)pIter);
+    }
+  }
+
+  code = tsdbCompactNextRow(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactWriteBlock(STsdbCompactor *pCompactor) {
+  SDataFWriter *pWriter = pCompactor->pWriter;
+  int64_t       size = pWriter->fData.size + pWriter->fSma.size;
+
+  int32_t code = tsdbWriteDataBlock(pWriter, &pCompactor->bData, &pCompactor->mDataBlk, pCompactor->cmprAlg);
+  if (code == 0) {
+    tsdbCompactThrottle(pCompactor, pWriter->fData.size + pWriter->fSma.size - size);
+  }
+  return code;
+}
+
+static int32_t tsdbCompactTableData(STsdbCompactor *pCompactor, SCompactFSet *pCSet, TABLEID id) {
+  int32_t    code = 0;
+  int32_t    lino = 0;
+  STsdb     *pTsdb = pCompactor->pTsdb;
+  STSRow    *pTSRow = NULL;
+  SRowMerger merger = {0};
+  int64_t    nRow = 0;
+  TSKEY      minKey, maxKey;
+
+  code = tsdbUpdateTableSchema(pTsdb->pVnode->pMeta, id.suid, id.uid, &pCompactor->skmTable);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  STSchema *pTSchema = pCompactor->skmTable.pTSchema;
+  code = tBlockDataInit(&pCompactor->bData, &id, pTSchema, NULL, 0);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  tMapDataReset(&pCompactor->mDataBlk);
+
+  tsdbFidKeyRange(pCSet->pSet->fid, pCompactor->minutes, pCompactor->precision, &minKey, &maxKey);
+  code = tsdbCompactSetTableDel(pCompactor, &id, minKey, maxKey);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  SRowInfo *pRowInfo = tsdbCompactGetRow(pCompactor, &id);
+  while (pRowInfo) {
+    TSDBROW row = pRowInfo->row;
+    if (tsdbCompactRowIsDeleted(pCompactor->aDelData, &row)) {
+      code = tsdbCompactNextRow(pCompactor);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      pRowInfo = tsdbCompactGetRow(pCompactor, &id);
+      continue;
+    }
+
+    // the row stays valid after one move, see SCompactIter
+    code = tsdbCompactNextRow(pCompactor);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    pRowInfo = tsdbCompactGetRow(pCompactor, &id);
+
+    // merge versions of the same timestamp into one row
+    while (pRowInfo && TSDBROW_TS(&pRowInfo->row) == TSDBROW_TS(&row)) {
+      if (!tsdbCompactRowIsDeleted(pCompactor->aDelData, &pRowInfo->row)) {
+        STSRow *pMerged = NULL;
+
+        code = tRowMergerInit(&merger, &row, pTSchema);
+        TSDB_CHECK_CODE(code, lino, _exit);
+        code = tRowMerge(&merger, &pRowInfo->row);
+        TSDB_CHECK_CODE(code, lino, _exit);
+        code = tRowMergerGetRow(&merger, &pMerged);
+        TSDB_CHECK_CODE(code, lino, _exit);
+        tRowMergerClear(&merger);
+        merger.pArray = NULL;
+
+        taosMemoryFree(pTSRow);
+        pTSRow = pMerged;
+        row = tsdbRowFromTSRow(TSDBROW_VERSION(&pRowInfo->row), pTSRow);
+      }
+
+      code = tsdbCompactNextRow(pCompactor);
+      TSDB_CHECK_CODE(code, lino, _exit);
+      pRowInfo = tsdbCompactGetRow(pCompactor, &id);
+    }
+
+    code = tBlockDataAppendRow(&pCompactor->bData, &row, pTSRow ? pTSchema : NULL, id.uid);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    nRow++;
+
+    if (pTSRow) {
+      taosMemoryFree(pTSRow);
+      pTSRow = NULL;
+    }
+
+    if (pCompactor->bData.nRow >= pCompactor->maxRow) {
+      code = tsdbCompactWriteBlock(pCompactor);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      if (tsdbCompactIsStopped(pCompactor)) {
+        code = TSDB_CODE_VND_STOPPED;
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+    }
+  }
+
+  if (pCompactor->bData.nRow > 0) {
+    code = tsdbCompactWriteBlock(pCompactor);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  if (pCompactor->mDataBlk.nItem > 0) {
+    SBlockIdx blockIdx = {.suid = id.suid, .uid = id.uid};
+    code = tsdbWriteDataBlk(pCompactor->pWriter, &pCompactor->mDataBlk, &blockIdx);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (taosArrayPush(pCompactor->aBlockIdx, &blockIdx) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    pCSet->after.nRow += nRow;
+    pCSet->after.nTable++;
+    pCSet->after.nDataBlk += pCompactor->mDataBlk.nItem;
+    pCSet->after.nMinBlk += (nRow + pCompactor->maxRow - 1) / pCompactor->maxRow;
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, suid:%" PRId64 " uid:%" PRId64, TD_VID(pTsdb->pVnode),
+              __func__, lino, tstrerror(code), id.suid, id.uid);
+  }
+  if (merger.pArray) tRowMergerClear(&merger);
+  taosMemoryFree(pTSRow);
+  return code;
+}
+
+static int32_t tsdbCompactFSet(STsdbCompactor *pCompactor, SCompactFSet *pCSet) {
+  int32_t    code = 0;
+  int32_t    lino = 0;
+  STsdb     *pTsdb = pCompactor->pTsdb;
+  SDFileSet *pSet = pCSet->pSet;
+  TSKEY      minKey, maxKey;
+
+  // reader
+  code = tsdbDataFReaderOpen(&pCompactor->pReader, pTsdb, pSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // writer, all rows go to the .data file and the new .stt file is left empty
+  pCSet->fHead = (SHeadFile){.commitID = pCompactor->commitID};
+  pCSet->fData = (SDataFile){.commitID = pCompactor->commitID};
+  pCSet->fSma = (SSmaFile){.commitID = pCompactor->commitID};
+  pCSet->fStt = (SSttFile){.commitID = pCompactor->commitID};
+  SDFileSet wSet = {.diskId = pSet->diskId,
+                    .fid = pSet->fid,
+                    .pHeadF = &pCSet->fHead,
+                    .pDataF = &pCSet->fData,
+                    .pSmaF = &pCSet->fSma,
+                    .nSttF = 1,
+                    .aSttF = {&pCSet->fStt}};
+  pCSet->written = 1;
+  code = tsdbDataFWriterOpen(&pCompactor->pWriter, pTsdb, &wSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  taosArrayClear(pCompactor->aBlockIdx);
+  taosArrayClear(pCompactor->aSttBlk);
+  memset(&pCSet->after, 0, sizeof(pCSet->after));
+
+  // merge
+  code = tsdbCompactOpenIter(pCompactor, pSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  SRowInfo *pRowInfo;
+  while ((pRowInfo = tsdbCompactGetRow(pCompactor, NULL)) != NULL) {
+    TABLEID id = {.suid = pRowInfo->suid, .uid = pRowInfo->uid};
+
+    if (tsdbCompactIsStopped(pCompactor)) {
+      code = TSDB_CODE_VND_STOPPED;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    code = tsdbCompactTableData(pCompactor, pCSet, id);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  code = tsdbWriteBlockIdx(pCompactor->pWriter, pCompactor->aBlockIdx);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbWriteSttBlk(pCompactor->pWriter, pCompactor->aSttBlk);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbUpdateDFileSetHeader(pCompactor->pWriter);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  pCSet->fHead = *pCompactor->pWriter->wSet.pHeadF;
+  pCSet->fData = *pCompactor->pWriter->wSet.pDataF;
+  pCSet->fSma = *pCompactor->pWriter->wSet.pSmaF;
+  pCSet->fStt = *pCompactor->pWriter->wSet.aSttF[0];
+
+  code = tsdbDataFWriterClose(&pCompactor->pWriter, 1);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  tsdbFidKeyRange(pSet->fid, pCompactor->minutes, pCompactor->precision, &minKey, &maxKey);
+  pCSet->after.nDelData = tsdbCompactCountDel(pCompactor, minKey, maxKey);
+
+  tsdbInfo("vgId:%d, fid:%d compacted, score:%.2f, read amplification:%.2f -> %.2f, nSttF:%d -> 1, nDataBlk:%d -> %d, "
+           "nSttBlk:%d -> 0, nRow:%" PRId64 " -> %" PRId64,
+           TD_VID(pTsdb->pVnode), pSet->fid, pCSet->score, TSDB_COMPACT_READ_AMP(&pCSet->before),
+           TSDB_COMPACT_READ_AMP(&pCSet->after), pSet->nSttF, pCSet->before.nDataBlk, pCSet->after.nDataBlk,
+           pCSet->before.nSttBlk, pCSet->before.nRow, pCSet->after.nRow);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, fid:%d", TD_VID(pTsdb->pVnode), __func__, lino,
+              tstrerror(code), pSet->fid);
+    tsdbDataFWriterClose(&pCompactor->pWriter, 0);
+  }
+  tsdbDataFReaderClose(&pCompactor->pReader);
+  return code;
+}
+
+// commit ==============================================================================================
+// Commits keep running while the file sets are rewritten, so the new files replace a file set only if it has not
+// been changed since the snapshot was taken. The skipped file sets are picked up again by the next compaction.
+static int32_t tsdbCompactCommit(STsdbCompactor *pCompactor) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  STsdb  *pTsdb = pCompactor->pTsdb;
+  STsdbFS fs = {0};
+  int32_t nApplied = 0;
+  bool    allApplied = true;
+
+  tsem_wait(&pTsdb->pVnode->canCommit);
+
+  code = tsdbFSCopy(pTsdb, &fs);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  for (int32_t iFSet = 0; iFSet < taosArrayGetSize(pCompactor->aFSet); iFSet++) {
+    SCompactFSet *pCSet = (SCompactFSet *)taosArrayGet(pCompactor->aFSet, iFSet);
+    SDFileSet    *pSet = (SDFileSet *)taosArraySearch(pTsdb->fs.aDFileSet, pCSet->pSet, tDFileSetCmprFn, TD_EQ);
+
+    if (!pCSet->written) continue;
+    if (pSet == NULL || !tDFileSetIsSame(pSet, pCSet->pSet)) {
+      tsdbInfo("vgId:%d, fid:%d changed during compaction, skip it", TD_VID(pTsdb->pVnode), pCSet->pSet->fid);
+      allApplied = false;
+      continue;
+    }
+
+    SDFileSet wSet = {.diskId = pCSet->pSet->diskId,
+                      .fid = pCSet->pSet->fid,
+                      .pHeadF = &pCSet->fHead,
+                      .pDataF = &pCSet->fData,
+                      .pSmaF = &pCSet->fSma,
+                      .nSttF = 1,
+                      .aSttF = {&pCSet->fStt}};
+    code = tsdbFSUpsertFSet(&fs, &wSet);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    pCSet->applied = 1;
+    nApplied++;
+  }
+
+  // tombstones were purged assuming all file sets are replaced, and only the del file of the snapshot is rewritten
+  if (pCompactor->delWritten && allApplied && pTsdb->fs.pDelFile &&
+      pTsdb->fs.pDelFile->commitID == pCompactor->fs.pDelFile->commitID) {
+    code = tsdbFSUpsertDelFile(&fs, &pCompactor->fDel);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    pCompactor->delApplied = 1;
+  }
+
+  if (nApplied == 0 && !pCompactor->delApplied) goto _exit;
+
+  code = tsdbFSPrepareCommit(pTsdb, &fs);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  taosThreadRwlockWrlock(&pTsdb->rwLock);
+  code = tsdbFSCommit(pTsdb);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  if (code) {
+    tsdbFSRollback(pTsdb);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+    for (int32_t iFSet = 0; iFSet < taosArrayGetSize(pCompactor->aFSet); iFSet++) {
+      ((SCompactFSet *)taosArrayGet(pCompactor->aFSet, iFSet))->applied = 0;
+    }
+    pCompactor->delApplied = 0;
+  }
+  tsem_post(&pTsdb->pVnode->canCommit);
+  tsdbFSDestroy(&fs);
+  return code;
+}
+
+// open/close ==============================================================================================
+static int32_t tsdbCompactOpen(STsdb *pTsdb, int64_t commitID, STsdbCompactor **ppCompactor) {
+  int32_t         code = 0;
+  int32_t         lino = 0;
+  STsdbCompactor *pCompactor = NULL;
+  SVnodeCfg      *pCfg = &pTsdb->pVnode->config;
+
+  pCompactor = (STsdbCompactor *)taosMemoryCalloc(1, sizeof(*pCompactor));
+  if (pCompactor == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  pCompactor->pTsdb = pTsdb;
+  pCompactor->commitID = commitID;
+  pCompactor->minutes = pTsdb->keepCfg.days;
+  pCompactor->precision = pTsdb->keepCfg.precision;
+  pCompactor->minRow = pCfg->tsdbCfg.minRows;
+  pCompactor->maxRow = pCfg->tsdbCfg.maxRows;
+  pCompactor->cmprAlg = pCfg->tsdbCfg.compression;
+  pCompactor->startUs = taosGetTimestampUs();
+
+  if ((pCompactor->aFSet = taosArrayInit(0, sizeof(SCompactFSet))) == NULL ||
+      (pCompactor->aDelIdx = taosArrayInit(0, sizeof(SDelIdx))) == NULL ||
+      (pCompactor->aDelDataP = taosArrayInit(0, sizeof(SArray *))) == NULL ||
+      (pCompactor->aDelData = taosArrayInit(0, sizeof(SDelData))) == NULL ||
+      (pCompactor->aBlockIdx = taosArrayInit(0, sizeof(SBlockIdx))) == NULL ||
+      (pCompactor->aSttBlk = taosArrayInit(0, sizeof(SSttBlk))) == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  for (int32_t iIter = 0; iIter < TSDB_MAX_STT_TRIGGER + 1; iIter++) {
+    SCompactIter *pIter = &pCompactor->aIter[iIter];
+    if (iIter == 0) {
+      pIter->aBlockIdx = taosArrayInit(0, sizeof(SBlockIdx));
+      if (pIter->aBlockIdx == NULL) code = TSDB_CODE_OUT_OF_MEMORY;
+    } else {
+      pIter->aSttBlk = taosArrayInit(0, sizeof(SSttBlk));
+      if (pIter->aSttBlk == NULL) code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tBlockDataCreate(&pIter->aBData[0]);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    code = tBlockDataCreate(&pIter->aBData[1]);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  code = tBlockDataCreate(&pCompactor->bData);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // snapshot
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  code = tsdbFSRef(pTsdb, &pCompactor->fs);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  *ppCompactor = pCompactor;
+  return code;
+}
+
+static void tsdbCompactClose(STsdbCompactor **ppCompactor) {
+  STsdbCompactor *pCompactor = *ppCompactor;
+  STsdb          *pTsdb;
+  char            fname[TSDB_FILENAME_LEN];
+
+  if (pCompactor == NULL) return;
+  pTsdb = pCompactor->pTsdb;
+
+  // remove the files not taken by the file system
+  for (int32_t iFSet = 0; iFSet < taosArrayGetSize(pCompactor->aFSet); iFSet++) {
+    SCompactFSet *pCSet = (SCompactFSet *)taosArrayGet(pCompactor->aFSet, iFSet);
+    if (!pCSet->written || pCSet->applied) continue;
+
+    tsdbHeadFileName(pTsdb, pCSet->pSet->diskId, pCSet->pSet->fid, &pCSet->fHead, fname);
+    (void)taosRemoveFile(fname);
+    tsdbDataFileName(pTsdb, pCSet->pSet->diskId, pCSet->pSet->fid, &pCSet->fData, fname);
+    (void)taosRemoveFile(fname);
+    tsdbSmaFileName(pTsdb, pCSet->pSet->diskId, pCSet->pSet->fid, &pCSet->fSma, fname);
+    (void)taosRemoveFile(fname);
+    tsdbSttFileName(pTsdb, pCSet->pSet->diskId, pCSet->pSet->fid, &pCSet->fStt, fname);
+    (void)taosRemoveFile(fname);
+  }
+  if (pCompactor->delWritten && !pCompactor->delApplied) {
+    tsdbDelFileName(pTsdb, &pCompactor->fDel, fname);
+    (void)taosRemoveFile(fname);
+  }
+
+  if (pCompactor->fs.aDFileSet) {
+    tsdbFSUnref(pTsdb, &pCompactor->fs);
+  }
+
+  for (int32_t iIter = 0; iIter < TSDB_MAX_STT_TRIGGER + 1; iIter++) {
+    SCompactIter *pIter = &pCompactor->aIter[iIter];
+    if (iIter == 0) {
+      taosArrayDestroy(pIter->aBlockIdx);
+      tMapDataClear(&pIter->mDataBlk);
+    } else {
+      taosArrayDestroy(pIter->aSttBlk);
+    }
+    tBlockDataDestroy(&pIter->aBData[0], 1);
+    tBlockDataDestroy(&pIter->aBData[1], 1);
+  }
+
+  for (int32_t iDelIdx = 0; iDelIdx < taosArrayGetSize(pCompactor->aDelDataP); iDelIdx++) {
+    taosArrayDestroy((SArray *)taosArrayGetP(pCompactor->aDelDataP, iDelIdx));
+  }
+  taosArrayDestroy(pCompactor->aDelDataP);
+  taosArrayDestroy(pCompactor->aDelIdx);
+  taosArrayDestroy(pCompactor->aDelData);
+  taosArrayDestroy(pCompactor->aFSet);
+  taosArrayDestroy(pCompactor->aBlockIdx);
+  taosArrayDestroy(pCompactor->aSttBlk);
+  tMapDataClear(&pCompactor->mDataBlk);
+  tBlockDataDestroy(&pCompactor->bData, 1);
+  tDestroyTSchema(pCompactor->skmTable.pTSchema);
+  taosMemoryFree(pCompactor);
+  *ppCompactor = NULL;
+}
+
+/*
+ * An estimate of tsdbCompactScore from the file sizes kept in memory, so a commit can tell whether a compaction is
+ * worth reading the block indexes: the share of .stt bytes stands for the share of small and .stt blocks. Only the
+ * file sets with files written after sinceCommitID count, a file set passed over by a compaction is not picked again
+ * until it changes.
+ */
+bool tsdbShouldCompact(STsdb *pTsdb, int64_t sinceCommitID) {
+  bool    should = false;
+  int64_t now = taosGetTimestampSec();
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(pTsdb->fs.aDFileSet) && !should; iSet++) {
+    SDFileSet *pSet = (SDFileSet *)taosArrayGet(pTsdb->fs.aDFileSet, iSet);
+    if (tsdbFidLevel(pSet->fid, &pTsdb->keepCfg, now) < 0) continue;
+
+    int64_t commitID = pSet->pDataF->commitID;
+    int64_t nSttByte = 0;
+    for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+      commitID = TMAX(commitID, pSet->aSttF[iStt]->commitID);
+      nSttByte += pSet->aSttF[iStt]->size;
+    }
+    if (commitID <= sinceCommitID) continue;
+
+    double score = TSDB_COMPACT_STT_WEIGHT * (pSet->nSttF - 1);
+    score += (double)nSttByte / TMAX(nSttByte + pSet->pDataF->size, 1);
+    should = score >= TSDB_COMPACT_MIN_SCORE;
+  }
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+
+  return should;
+}
+
+/*
+ * Rewrite the fragmented file sets of the tsdb: rows in the .data and .stt files are merged into full blocks of
+ * the .data file, versions of the same timestamp are merged into one row, and rows covered by tombstones are
+ * dropped physically. The new files are named after commitID, which is reserved by the caller.
+ *
+ * When the vnode is closing, TSDB_CODE_VND_STOPPED is returned at the next block or file set and nothing is applied.
+ */
+int32_t tsdbCompact(STsdb *pTsdb, int64_t commitID) {
+  int32_t         code = 0;
+  int32_t         lino = 0;
+  STsdbCompactor *pCompactor = NULL;
+
+  code = tsdbCompactOpen(pTsdb, commitID, &pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactReadDel(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactPick(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (taosArrayGetSize(pCompactor->aFSet) == 0) {
+    tsdbInfo("vgId:%d, no file set needs compaction, nFSet:%d", TD_VID(pTsdb->pVnode),
+             (int32_t)taosArrayGetSize(pCompactor->fs.aDFileSet));
+    goto _exit;
+  }
+
+  SCompactStat before = {0};
+  SCompactStat after = {0};
+  for (int32_t iFSet = 0; iFSet < taosArrayGetSize(pCompactor->aFSet); iFSet++) {
+    SCompactFSet *pCSet = (SCompactFSet *)taosArrayGet(pCompactor->aFSet, iFSet);
+
+    if (tsdbCompactIsStopped(pCompactor)) {
+      code = TSDB_CODE_VND_STOPPED;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    code = tsdbCompactFSet(pCompactor, pCSet);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    before.nDataBlk += pCSet->before.nDataBlk;
+    before.nSttBlk += pCSet->before.nSttBlk;
+    before.nMinBlk += pCSet->before.nMinBlk;
+    after.nDataBlk += pCSet->after.nDataBlk;
+    after.nMinBlk += pCSet->after.nMinBlk;
+  }
+
+  code = tsdbCompactDel(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactCommit(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  int32_t nApplied = 0;
+  for (int32_t iFSet = 0; iFSet < taosArrayGetSize(pCompactor->aFSet); iFSet++) {
+    nApplied += ((SCompactFSet *)taosArrayGet(pCompactor->aFSet, iFSet))->applied;
+  }
+
+  tsdbInfo("vgId:%d, tsdb compact done, nFSet:%d applied:%d, read amplification:%.2f -> %.2f, tombstones purged:%d, "
+           "bytes:%" PRId64 " elapsed:%" PRId64 "ms",
+           TD_VID(pTsdb->pVnode), (int32_t)taosArrayGetSize(pCompactor->aFSet), nApplied,
+           TSDB_COMPACT_READ_AMP(&before), TSDB_COMPACT_READ_AMP(&after),
+           pCompactor->delApplied ? pCompactor->nDelPurged : 0, pCompactor->nBytes,
+           (taosGetTimestampUs() - pCompactor->startUs) / 1000);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  tsdbCompactClose(&pCompactor);
   return code;
 }
@@ -269,6 +269,19 @@ int32_t tDFileSetCmprFn(const void *p1, const void *p2) {
   return 0;
 }
 
+// whether two file sets refer to the same files, used to find out if a file set changed since a snapshot was taken
+bool tDFileSetIsSame(SDFileSet *pSet1, SDFileSet *pSet2) {
+  if (pSet1->diskId.level != pSet2->diskId.level || pSet1->diskId.id != pSet2->diskId.id) return false;
+  if (pSet1->pHeadF->commitID != pSet2->pHeadF->commitID) return false;
+  if (pSet1->pDataF->commitID != pSet2->pDataF->commitID) return false;
+  if (pSet1->pSmaF->commitID != pSet2->pSmaF->commitID) return false;
+  if (pSet1->nSttF != pSet2->nSttF) return false;
+  for (int32_t iStt = 0; iStt < pSet1->nSttF; iStt++) {
+    if (pSet1->aSttF[iStt]->commitID != pSet2->aSttF[iStt]->commitID) return false;
+  }
+  return true;
+}
+
 static void tsdbGetCurrentFName(STsdb *pTsdb, char *current, char *current_t) {
   SVnode *pVnode = pTsdb->pVnode;
   if (pVnode->pTfs) {
@@ -56,6 +56,13 @@ int32_t tsdbMemTableCreate(STsdb *pTsdb, SMemTable **ppMemTable) {
     taosMemoryFree(pMemTable);
     goto _err;
   }
+  pMemTable->pStbNRow = taosHashInit(4, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, HASH_ENTRY_LOCK);
+  if (pMemTable->pStbNRow == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    taosMemoryFree(pMemTable->aBucket);
+    taosMemoryFree(pMemTable);
+    goto _err;
+  }
   vnodeBufPoolRef(pMemTable->pPool);
 
   *ppMemTable = pMemTable;
@@ -69,6 +76,7 @@ _err:
 void tsdbMemTableDestroy(SMemTable *pMemTable) {
   if (pMemTable) {
     vnodeBufPoolUnRef(pMemTable->pPool);
+    taosHashCleanup(pMemTable->pStbNRow);
     taosMemoryFree(pMemTable->aBucket);
     taosMemoryFree(pMemTable);
   }
@@ -95,6 +103,46 @@ STbData *tsdbGetTbDataFromMemTable(SMemTable *pMemTable, tb_uid_t suid, tb_uid_t
   return pTbData;
 }
 
+// The rows of the child tables are summed up per super table on insertion, so that the block distribution of a super
+// table gets the rows in memory without walking the tables.
+static int32_t tsdbMemTableAddStbNRow(SMemTable *pMemTable, tb_uid_t suid, int64_t nRow) {
+  int64_t *pNRow = taosHashGet(pMemTable->pStbNRow, &suid, sizeof(suid));
+  if (pNRow) {
+    atomic_add_fetch_64(pNRow, nRow);
+    return 0;
+  }
+
+  if (taosHashPut(pMemTable->pStbNRow, &suid, sizeof(suid), &nRow, sizeof(nRow)) < 0) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  return 0;
+}
+
+int64_t tsdbMemTableGetStbNRow(SMemTable *pMemTable, tb_uid_t suid) {
+  int64_t *pNRow = taosHashGet(pMemTable->pStbNRow, &suid, sizeof(suid));
+  return pNRow ? atomic_load_64(pNRow) : 0;
+}
+
+// the rows of a dropped child table are taken off its super table, whose suid is returned, 0 if it has no rows here
+int64_t tsdbMemTableDropTbNRow(SMemTable *pMemTable, tb_uid_t uid) {
+  STbData *pTbData = tsdbGetTbDataFromMemTable(pMemTable, 0, uid);
+  if (pTbData == NULL || pTbData->suid == 0) return 0;
+
+  int64_t *pNRow = taosHashGet(pMemTable->pStbNRow, &pTbData->suid, sizeof(pTbData->suid));
+  if (pNRow) {
+    atomic_sub_fetch_64(pNRow, tsdbGetNRowsInTbData(pTbData));
+  }
+  return pTbData->suid;
+}
+
+// the counter is kept, and reset, as the readers may hold it
+void tsdbMemTableDropStbNRow(SMemTable *pMemTable, tb_uid_t suid) {
+  int64_t *pNRow = taosHashGet(pMemTable->pStbNRow, &suid, sizeof(suid));
+  if (pNRow) {
+    atomic_store_64(pNRow, 0);
+  }
+}
+
 int32_t tsdbInsertTableData(STsdb *pTsdb, int64_t version, SSubmitMsgIter *pMsgIter, SSubmitBlk *pBlock,
                             SSubmitBlkRsp *pRsp) {
   int32_t    code = 0;
@@ -130,6 +178,7 @@ int32_t tsdbInsertTableData(STsdb *pTsdb, int64_t version, SSubmitMsgIter *pMsgI
   if (code) {
     goto _err;
   }
+  pTbData->minVer = TMIN(pTbData->minVer, version);
 
   // do insert impl
   code = tsdbInsertTableDataImpl(pMemTable, pTbData, version, pMsgIter, pBlock, pRsp);
@@ -167,6 +216,7 @@ int32_t tsdbDeleteTableData(STsdb *pTsdb, int64_t version, tb_uid_t suid, tb_uid
   if (code) {
     goto _err;
   }
+  pTbData->minVer = TMIN(pTbData->minVer, version);
 
   ASSERT(pPool != NULL);
   // do delete
@@ -197,6 +247,9 @@ int32_t tsdbDeleteTableData(STsdb *pTsdb, int64_t version, tb_uid_t suid, tb_uid
     tsdbCacheDeleteLast(pTsdb->lruCache, pTbData->uid, eKey);
   }
 
+  tsdbCacheColDelete(pTsdb, pTbData->uid, 0);
+  tsdbCacheColDelete(pTsdb, pTbData->uid, 1);
+
   tsdbInfo("vgId:%d, delete data from table suid:%" PRId64 " uid:%" PRId64 " skey:%" PRId64 " eKey:%" PRId64
            " at version %" PRId64 " since %s",
            TD_VID(pTsdb->pVnode), suid, uid, sKey, eKey, version, tstrerror(code));
@@ -344,6 +397,7 @@ static int32_t tsdbGetOrCreateTbData(SMemTable *pMemTable, tb_uid_t suid, tb_uid
   pTbData->uid = uid;
   pTbData->minKey = TSKEY_MAX;
   pTbData->maxKey = TSKEY_MIN;
+  pTbData->minVer = VERSION_MAX;
   pTbData->pHead = NULL;
   pTbData->pTail = NULL;
   pTbData->sl.seed = taosRand();
@@ -594,18 +648,30 @@ static int32_t tsdbInsertTableDataImpl(SMemTable *pMemTable, STbData *pTbData, i
     }
 
     if (TSDB_CACHE_LAST_ROW(pMemTable->pTsdb->pVnode->config) && pLastRow != NULL) {
-      tsdbCacheInsertLastrow(pMemTable->pTsdb->lruCache, pMemTable->pTsdb, pTbData->uid, pLastRow, true);
+      tsdbCacheInsertLastrow(pMemTable->pTsdb->lruCache, pMemTable->pTsdb, pTbData->uid, version, pLastRow, true);
     }
   }
 
   if (TSDB_CACHE_LAST(pMemTable->pTsdb->pVnode->config)) {
-    tsdbCacheInsertLast(pMemTable->pTsdb->lruCache, pTbData->uid, pLastRow, pMemTable->pTsdb);
+    tsdbCacheInsertLast(pMemTable->pTsdb->lruCache, pTbData->uid, version, pLastRow, pMemTable->pTsdb);
+  } else {
+    tsdbCacheColDelete(pMemTable->pTsdb, pTbData->uid, 1);
+  }
+
+  if (!TSDB_CACHE_LAST_ROW(pMemTable->pTsdb->pVnode->config)) {
+    tsdbCacheColDelete(pMemTable->pTsdb, pTbData->uid, 0);
   }
 
   // SMemTable
   pMemTable->minKey = TMIN(pMemTable->minKey, pTbData->minKey);
   pMemTable->maxKey = TMAX(pMemTable->maxKey, pTbData->maxKey);
   pMemTable->nRow += nRow;
+  if (pTbData->suid) {
+    code = tsdbMemTableAddStbNRow(pMemTable, pTbData->suid, nRow);
+    if (code) {
+      goto _err;
+    }
+  }
 
   pRsp->numOfRows = nRow;
   pRsp->affectedRows = nRow;
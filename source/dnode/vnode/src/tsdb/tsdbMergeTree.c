@@ -17,13 +17,14 @@
 
 // SLDataIter =================================================
 struct SLDataIter {
-  SRBTreeNode        node;
   SSttBlk           *pSttBlk;
   SDataFReader      *pReader;
   int32_t            iStt;
   int8_t             backward;
   int32_t            iSttBlk;
   int32_t            iRow;
+  int32_t            iRunEnd;  // rows of the current stt block up to this one are qualified, -1 if unknown
+  bool               exhausted;
   SRowInfo           rInfo;
   uint64_t           uid;
   STimeWindow        timeWindow;
@@ -161,6 +162,7 @@ static SBlockData *loadLastBlock(SLDataIter *pIter, const char *idStr) {
   tsdbDebug("last block index list:%d, %d, %s", pInfo->blockIndex[0], pInfo->blockIndex[1], idStr);
 
   pIter->iRow = (pIter->backward) ? pInfo->blockData[pInfo->currentLoadBlockIndex].nRow : -1;
+  pIter->iRunEnd = -1;
   return &pInfo->blockData[pInfo->currentLoadBlockIndex];
 
 _exit:
@@ -276,6 +278,7 @@ int32_t tLDataIterOpen(struct SLDataIter **pIter, SDataFReader *pReader, int32_t
   (*pIter)->backward = backward;
   (*pIter)->verRange = *pRange;
   (*pIter)->timeWindow = *pTimeWindow;
+  (*pIter)->iRunEnd = -1;
 
   (*pIter)->pBlockLoadInfo = pBlockLoadInfo;
 
@@ -396,6 +399,7 @@ void tLDataIterNextBlock(SLDataIter *pIter, const char *idStr) {
   }
 
   pIter->pSttBlk = NULL;
+  pIter->iRunEnd = -1;
   if (index != -1) {
     pIter->iSttBlk = index;
     pIter->pSttBlk = (SSttBlk *)taosArrayGet(pIter->pBlockLoadInfo->aSttBlk, pIter->iSttBlk);
@@ -406,6 +410,24 @@ void tLDataIterNextBlock(SLDataIter *pIter, const char *idStr) {
   }
 }
 
+// If all rows of the current stt block are in the time window and the version range, the rows of the table are
+// qualified up to the last one of the table in the block, and they are returned without being checked one by one.
+static void setQualifiedRun(SLDataIter *pIter, SBlockData *pBlockData) {
+  SSttBlk *pSttBlk = pIter->pSttBlk;
+  if (pSttBlk->minKey < pIter->timeWindow.skey || pSttBlk->maxKey > pIter->timeWindow.ekey ||
+      pSttBlk->minVer < pIter->verRange.minVer || pSttBlk->maxVer > pIter->verRange.maxVer) {
+    return;
+  }
+
+  if (pBlockData->aUid == NULL) {
+    pIter->iRunEnd = pIter->backward ? 0 : pBlockData->nRow - 1;
+  } else {
+    // the earliest row of the table in the opposite direction is the last one in the scan direction
+    pIter->iRunEnd =
+        binarySearchForStartRowIndex((uint64_t *)pBlockData->aUid, pBlockData->nRow, pIter->uid, !pIter->backward);
+  }
+}
+
 static void findNextValidRow(SLDataIter *pIter, const char *idStr) {
   int32_t step = pIter->backward ? -1 : 1;
 
@@ -467,6 +489,9 @@ static void findNextValidRow(SLDataIter *pIter, const char *idStr) {
   }
 
   pIter->iRow = (hasVal) ? i : -1;
+  if (hasVal && pIter->iRunEnd == -1) {
+    setQualifiedRun(pIter, pBlockData);
+  }
 }
 
 bool tLDataIterNextRow(SLDataIter *pIter, const char *idStr) {
@@ -486,6 +511,12 @@ bool tLDataIterNextRow(SLDataIter *pIter, const char *idStr) {
 
   pIter->iRow += step;
 
+  if (pIter->iRunEnd != -1 &&
+      ((!pIter->backward && pIter->iRow <= pIter->iRunEnd) || (pIter->backward && pIter->iRow >= pIter->iRunEnd))) {
+    pIter->rInfo.row = tsdbRowFromBlockData(pBlockData, pIter->iRow);
+    return true;
+  }
+
   while (1) {
     findNextValidRow(pIter, idStr);
 
@@ -515,10 +546,7 @@ _exit:
 SRowInfo *tLDataIterGet(SLDataIter *pIter) { return &pIter->rInfo; }
 
 // SMergeTree =================================================
-static FORCE_INLINE int32_t tLDataIterCmprFn(const SRBTreeNode *p1, const SRBTreeNode *p2) {
-  SLDataIter *pIter1 = (SLDataIter *)(((uint8_t *)p1) - offsetof(SLDataIter, node));
-  SLDataIter *pIter2 = (SLDataIter *)(((uint8_t *)p2) - offsetof(SLDataIter, node));
-
+static FORCE_INLINE int32_t tLDataIterCmprFn(const SLDataIter *pIter1, const SLDataIter *pIter2) {
   TSDBKEY key1 = TSDBROW_KEY(&pIter1->rInfo.row);
   TSDBKEY key2 = TSDBROW_KEY(&pIter2->rInfo.row);
 
@@ -537,8 +565,48 @@ static FORCE_INLINE int32_t tLDataIterCmprFn(const SRBTreeNode *p1, const SRBTre
   }
 }
 
-static FORCE_INLINE int32_t tLDataIterDescCmprFn(const SRBTreeNode *p1, const SRBTreeNode *p2) {
-  return -1 * tLDataIterCmprFn(p1, p2);
+static FORCE_INLINE int32_t tMergeTreeCmprIter(const SMergeTree *pMTree, const SLDataIter *pIter1,
+                                               const SLDataIter *pIter2) {
+  int32_t ret = tLDataIterCmprFn(pIter1, pIter2);
+  return pMTree->backward ? -ret : ret;
+}
+
+// the exhausted iterators are placed after all others in the loser tree
+static int32_t tMergeTreeCmprFn(const void *pLeft, const void *pRight, void *param) {
+  SMergeTree *pMTree = (SMergeTree *)param;
+  SLDataIter *pIter1 = taosArrayGetP(pMTree->pIterList, *(int32_t *)pLeft);
+  SLDataIter *pIter2 = taosArrayGetP(pMTree->pIterList, *(int32_t *)pRight);
+
+  if (pIter1->exhausted || pIter2->exhausted) {
+    return (int32_t)pIter1->exhausted - (int32_t)pIter2->exhausted;
+  }
+
+  return tMergeTreeCmprIter(pMTree, pIter1, pIter2);
+}
+
+// The runner-up is the iterator that loses only to the winner, so it is one of the losers kept on the path from the
+// leaf of the winner to the root.
+static SLDataIter *tMergeTreeGetRunnerUp(SMergeTree *pMTree) {
+  SMultiwayMergeTreeInfo *pTree = pMTree->pLoserTree;
+  SLDataIter             *pRunnerUp = NULL;
+
+  for (int32_t i = tMergeTreeGetAdjustIndex(pTree) >> 1; i > 0; i >>= 1) {
+    int32_t index = pTree->pNode[i].index;
+    if (index < 0) {
+      continue;
+    }
+
+    SLDataIter *pIter = taosArrayGetP(pMTree->pIterList, index);
+    if (pIter->exhausted) {
+      continue;
+    }
+
+    if (pRunnerUp == NULL || tMergeTreeCmprIter(pMTree, pIter, pRunnerUp) < 0) {
+      pRunnerUp = pIter;
+    }
+  }
+
+  return pRunnerUp;
 }
 
 int32_t tMergeTreeOpen(SMergeTree *pMTree, int8_t backward, SDataFReader *pFReader, uint64_t suid, uint64_t uid,
@@ -546,17 +614,14 @@ int32_t tMergeTreeOpen(SMergeTree *pMTree, int8_t backward, SDataFReader *pFRead
                        bool destroyLoadInfo, const char *idStr) {
   pMTree->backward = backward;
   pMTree->pIter = NULL;
+  pMTree->pRunnerUp = NULL;
+  pMTree->pLoserTree = NULL;
   pMTree->pIterList = taosArrayInit(4, POINTER_BYTES);
   if (pMTree->pIterList == NULL) {
     return TSDB_CODE_OUT_OF_MEMORY;
   }
 
   pMTree->idStr = idStr;
-  if (!pMTree->backward) { // asc
-    tRBTreeCreate(&pMTree->rbt, tLDataIterCmprFn);
-  } else { // desc
-    tRBTreeCreate(&pMTree->rbt, tLDataIterDescCmprFn);
-  }
   int32_t code = TSDB_CODE_SUCCESS;
 
   pMTree->pLoadInfo = pBlockLoadInfo;
@@ -574,12 +639,19 @@ int32_t tMergeTreeOpen(SMergeTree *pMTree, int8_t backward, SDataFReader *pFRead
     bool hasVal = tLDataIterNextRow(pIter, pMTree->idStr);
     if (hasVal) {
       taosArrayPush(pMTree->pIterList, &pIter);
-      tMergeTreeAddIter(pMTree, pIter);
     } else {
       tLDataIterClose(pIter);
     }
   }
 
+  size_t numOfIters = taosArrayGetSize(pMTree->pIterList);
+  if (numOfIters > 0) {
+    code = tMergeTreeCreate(&pMTree->pLoserTree, numOfIters, pMTree, tMergeTreeCmprFn);
+    if (code != TSDB_CODE_SUCCESS) {
+      goto _end;
+    }
+  }
+
   return code;
 
 _end:
@@ -587,36 +659,32 @@ _end:
   return code;
 }
 
-void tMergeTreeAddIter(SMergeTree *pMTree, SLDataIter *pIter) { tRBTreePut(&pMTree->rbt, (SRBTreeNode *)pIter); }
-
 bool tMergeTreeNext(SMergeTree *pMTree) {
-  int32_t code = TSDB_CODE_SUCCESS;
+  SMultiwayMergeTreeInfo *pTree = pMTree->pLoserTree;
+  if (pTree == NULL) {
+    return false;
+  }
+
   if (pMTree->pIter) {
     SLDataIter *pIter = pMTree->pIter;
 
     bool hasVal = tLDataIterNextRow(pIter, pMTree->idStr);
     if (!hasVal) {
-      pMTree->pIter = NULL;
+      pIter->exhausted = true;
+    } else if (pMTree->pRunnerUp == NULL || tMergeTreeCmprIter(pMTree, pIter, pMTree->pRunnerUp) < 0) {
+      // no overlap with the other iterators yet, the run of the current iterator goes on
+      return true;
     }
 
-    // compare with min in RB Tree
-    pIter = (SLDataIter *)tRBTreeMin(&pMTree->rbt);
-    if (pMTree->pIter && pIter) {
-      int32_t c = pMTree->rbt.cmprFn(&pMTree->pIter->node, &pIter->node);
-      if (c > 0) {
-        tRBTreePut(&pMTree->rbt, (SRBTreeNode *)pMTree->pIter);
-        pMTree->pIter = NULL;
-      } else {
-        ASSERT(c);
-      }
-    }
+    tMergeTreeAdjust(pTree, tMergeTreeGetAdjustIndex(pTree));
   }
 
-  if (pMTree->pIter == NULL) {
-    pMTree->pIter = (SLDataIter *)tRBTreeMin(&pMTree->rbt);
-    if (pMTree->pIter) {
-      tRBTreeDrop(&pMTree->rbt, (SRBTreeNode *)pMTree->pIter);
-    }
+  pMTree->pIter = taosArrayGetP(pMTree->pIterList, tMergeTreeGetChosenIndex(pTree));
+  if (pMTree->pIter->exhausted) {
+    pMTree->pIter = NULL;
+    pMTree->pRunnerUp = NULL;
+  } else {
+    pMTree->pRunnerUp = tMergeTreeGetRunnerUp(pMTree);
   }
 
   return pMTree->pIter != NULL;
@@ -633,6 +701,10 @@ void tMergeTreeClose(SMergeTree *pMTree) {
 
   pMTree->pIterList = taosArrayDestroy(pMTree->pIterList);
   pMTree->pIter = NULL;
+  pMTree->pRunnerUp = NULL;
+
+  tMergeTreeDestroy(pMTree->pLoserTree);
+  pMTree->pLoserTree = NULL;
 
   if (pMTree->destroyLoadInfo) {
     pMTree->pLoadInfo = destroyLastBlockLoadInfo(pMTree->pLoadInfo);
@@ -74,6 +74,16 @@ int tsdbOpen(SVnode *pVnode, STsdb **ppTsdb, const char *dir, STsdbKeepCfg *pKee
     goto _err;
   }
 
+  if (tsdbOpenStats(pTsdb) < 0) {
+    goto _err;
+  }
+
+  pTsdb->pRollupKeys = taosHashInit(8, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, HASH_ENTRY_LOCK);
+  if (pTsdb->pRollupKeys == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err;
+  }
+
   tsdbDebug("vgId:%d, tsdb is opened at %s, days:%d, keep:%d,%d,%d", TD_VID(pVnode), pTsdb->path, pTsdb->keepCfg.days,
             pTsdb->keepCfg.keep0, pTsdb->keepCfg.keep1, pTsdb->keepCfg.keep2);
 
@@ -87,6 +97,8 @@ _err:
 
 int tsdbClose(STsdb **pTsdb) {
   if (*pTsdb) {
+    tsdbStopMigration(*pTsdb);
+
     taosThreadRwlockWrlock(&(*pTsdb)->rwLock);
     tsdbMemTableDestroy((*pTsdb)->mem);
     (*pTsdb)->mem = NULL;
@@ -96,7 +108,27 @@ int tsdbClose(STsdb **pTsdb) {
 
     tsdbFSClose(*pTsdb);
     tsdbCloseCache(*pTsdb);
+    tsdbCloseStats(*pTsdb);
+    taosHashCleanup((*pTsdb)->pRollupKeys);
     taosMemoryFreeClear(*pTsdb);
   }
   return 0;
 }
+
+// The rsma windows are closed in the order of time for all tables of the super table, so the data until the end of the
+// last window written into a level is rolled up. It is kept in memory only, and nothing is known after a restart until
+// the next window is closed.
+void tsdbSetRollupKey(STsdb *pTsdb, tb_uid_t suid, TSKEY key) {
+  TSKEY lastKey = TSKEY_MIN;
+  taosHashGetDup(pTsdb->pRollupKeys, &suid, sizeof(suid), &lastKey);
+  if (lastKey >= key) {
+    return;
+  }
+  taosHashPut(pTsdb->pRollupKeys, &suid, sizeof(suid), &key, sizeof(key));
+}
+
+TSKEY tsdbGetRollupKey(STsdb *pTsdb, tb_uid_t suid) {
+  TSKEY key = TSKEY_MIN;
+  taosHashGetDup(pTsdb->pRollupKeys, &suid, sizeof(suid), &key);
+  return key;
+}
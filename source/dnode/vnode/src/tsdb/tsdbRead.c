@@ -177,6 +177,9 @@ struct STsdbReader {
   SBlockInfoBuf      blockInfoBuf;
   int32_t            step;
   STsdbReader*       innerReader[2];
+  STsdbReader*       pRawReader;    // reads the raw data that is not rolled up yet, if a rollup level is queried
+  bool               readRaw;       // the raw reader is in use
+  TSKEY              rollupEndKey;  // the data until it is read from the rollup level, if pRawReader is not NULL
 };
 
 static SFileDataBlockInfo* getCurrentBlockInfo(SDataBlockIter* pBlockIter);
@@ -206,8 +209,8 @@ static int32_t mergeRowsInFileBlocks(SBlockData* pBlockData, STableBlockScanInfo
 
 static int32_t initDelSkylineIterator(STableBlockScanInfo* pBlockScanInfo, STsdbReader* pReader, STbData* pMemTbData,
                                       STbData* piMemTbData);
-static STsdb*  getTsdbByRetentions(SVnode* pVnode, TSKEY winSKey, SRetention* retentions, const char* idstr,
-                                   int8_t* pLevel);
+static STsdb*  getTsdbByRetentions(SVnode* pVnode, TSKEY winSKey, SRetention* retentions, int8_t minLevel,
+                                   const char* idstr, int8_t* pLevel);
 static SVersionRange getQueryVerRange(SVnode* pVnode, SQueryTableDataCond* pCond, int8_t level);
 static int64_t       getCurrentKeyInLastBlock(SLastBlockReader* pLastBlockReader);
 static bool          hasDataInLastBlock(SLastBlockReader* pLastBlockReader);
@@ -585,7 +588,8 @@ static int32_t tsdbReaderCreate(SVnode* pVnode, SQueryTableDataCond* pCond, STsd
 
   initReaderStatus(&pReader->status);
 
-  pReader->pTsdb = getTsdbByRetentions(pVnode, pCond->twindows.skey, pVnode->config.tsdbCfg.retentions, idstr, &level);
+  pReader->pTsdb = getTsdbByRetentions(pVnode, pCond->twindows.skey, pVnode->config.tsdbCfg.retentions,
+                                       pCond->rollupLevel, idstr, &level);
   pReader->suid = pCond->suid;
   pReader->order = pCond->order;
   pReader->capacity = capacity;
@@ -3056,8 +3060,8 @@ static int32_t buildBlockFromFiles(STsdbReader* pReader) {
   }
 }
 
-static STsdb* getTsdbByRetentions(SVnode* pVnode, TSKEY winSKey, SRetention* retentions, const char* idStr,
-                                  int8_t* pLevel) {
+static STsdb* getTsdbByRetentions(SVnode* pVnode, TSKEY winSKey, SRetention* retentions, int8_t minLevel,
+                                  const char* idStr, int8_t* pLevel) {
   if (VND_IS_RSMA(pVnode)) {
     int8_t  level = 0;
     int8_t  precision = pVnode->config.tsdbCfg.precision;
@@ -3080,6 +3084,9 @@ static STsdb* getTsdbByRetentions(SVnode* pVnode, TSKEY winSKey, SRetention* ret
       ++level;
     }
 
+    // the level chosen by the planner for the query interval and functions
+    level = TMAX(level, minLevel);
+
     const char* str = (idStr != NULL) ? idStr : "";
 
     if (level == TSDB_RETENTION_L0) {
@@ -3712,6 +3719,10 @@ int32_t buildDataBlockFromBufImpl(STableBlockScanInfo* pBlockScanInfo, int64_t e
 // TODO refactor: with createDataBlockScanInfo
 int32_t tsdbSetTableList(STsdbReader* pReader, const void* pTableList, int32_t num) {
   ASSERT(pReader != NULL);
+  if (pReader->pRawReader != NULL) {
+    tsdbSetTableList(pReader->pRawReader, pTableList, num);
+  }
+
   int32_t size = taosHashGetSize(pReader->status.pTableMap);
 
   STableBlockScanInfo** p = NULL;
@@ -3765,9 +3776,8 @@ static int32_t doOpenReaderImpl(STsdbReader* pReader) {
   }
 }
 
-// ====================================== EXPOSED APIs ======================================
-int32_t tsdbReaderOpen(SVnode* pVnode, SQueryTableDataCond* pCond, void* pTableList, int32_t numOfTables,
-                       SSDataBlock* pResBlock, STsdbReader** ppReader, const char* idstr) {
+static int32_t doTsdbReaderOpen(SVnode* pVnode, SQueryTableDataCond* pCond, void* pTableList, int32_t numOfTables,
+                                SSDataBlock* pResBlock, STsdbReader** ppReader, const char* idstr) {
   STimeWindow window = pCond->twindows;
   if (pCond->type == TIMEWINDOW_RANGE_EXTERNAL) {
     pCond->twindows.skey += 1;
@@ -3901,11 +3911,75 @@ _err:
   return code;
 }
 
+// The rollup level holds the data up to endKey, and the rest of the query time window is read from the raw data by
+// another reader.
+static int32_t tsdbRollupReaderOpen(SVnode* pVnode, SQueryTableDataCond* pCond, void* pTableList, int32_t numOfTables,
+                                    SSDataBlock* pResBlock, STsdbReader** ppReader, const char* idstr, TSKEY endKey) {
+  STimeWindow window = pCond->twindows;
+  int8_t      level = pCond->rollupLevel;
+
+  pCond->twindows.ekey = endKey;
+  int32_t code = doTsdbReaderOpen(pVnode, pCond, pTableList, numOfTables, pResBlock, ppReader, idstr);
+  pCond->twindows = window;
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  STsdbReader* pReader = *ppReader;
+  pCond->twindows.skey = endKey + 1;
+  pCond->rollupLevel = TSDB_RETENTION_L0;
+  code = doTsdbReaderOpen(pVnode, pCond, pTableList, numOfTables, pResBlock, &pReader->pRawReader, idstr);
+  pCond->twindows = window;
+  pCond->rollupLevel = level;
+  if (code != TSDB_CODE_SUCCESS) {
+    tsdbReaderClose(pReader);
+    *ppReader = NULL;
+    return code;
+  }
+
+  pReader->rollupEndKey = endKey;
+  pReader->readRaw = !ASCENDING_TRAVERSE(pCond->order);
+  tsdbDebug("%p rollup level:%d is queried until %" PRId64 ", raw data after it, %s", pReader, level, endKey,
+            pReader->idStr);
+  return code;
+}
+
+// ====================================== EXPOSED APIs ======================================
+int32_t tsdbReaderOpen(SVnode* pVnode, SQueryTableDataCond* pCond, void* pTableList, int32_t numOfTables,
+                       SSDataBlock* pResBlock, STsdbReader** ppReader, const char* idstr) {
+  if (pCond->rollupLevel == TSDB_RETENTION_L0 || !VND_IS_RSMA(pVnode) ||
+      pCond->type != TIMEWINDOW_RANGE_CONTAINED) {
+    return doTsdbReaderOpen(pVnode, pCond, pTableList, numOfTables, pResBlock, ppReader, idstr);
+  }
+
+  // the progress of the level which is read, which may be coarser than the level chosen by the planner for old data
+  int8_t level = 0;
+  STsdb* pTsdb = getTsdbByRetentions(pVnode, pCond->twindows.skey, pVnode->config.tsdbCfg.retentions,
+                                     pCond->rollupLevel, idstr, &level);
+  TSKEY  endKey = tsdbGetRollupKey(pTsdb, pCond->suid);
+  if (endKey >= pCond->twindows.ekey) {
+    return doTsdbReaderOpen(pVnode, pCond, pTableList, numOfTables, pResBlock, ppReader, idstr);
+  }
+
+  if (endKey < pCond->twindows.skey) {
+    // nothing of the query time window is rolled up yet
+    level = pCond->rollupLevel;
+    pCond->rollupLevel = TSDB_RETENTION_L0;
+    int32_t code = doTsdbReaderOpen(pVnode, pCond, pTableList, numOfTables, pResBlock, ppReader, idstr);
+    pCond->rollupLevel = level;
+    return code;
+  }
+
+  return tsdbRollupReaderOpen(pVnode, pCond, pTableList, numOfTables, pResBlock, ppReader, idstr, endKey);
+}
+
 void tsdbReaderClose(STsdbReader* pReader) {
   if (pReader == NULL) {
     return;
   }
 
+  tsdbReaderClose(pReader->pRawReader);
+
   {
     if (pReader->innerReader[0] != NULL || pReader->innerReader[1] != NULL) {
       STsdbReader* p = pReader->innerReader[0];
@@ -4026,7 +4100,35 @@ static bool doTsdbNextDataBlock(STsdbReader* pReader) {
   }
 }
 
+// In ascending order the rollup level is read before the raw data after it, and the other way in descending order.
+static bool tsdbNextRollupDataBlock(STsdbReader* pReader) {
+  bool asc = ASCENDING_TRAVERSE(pReader->order);
+  if (!pReader->readRaw) {
+    if (!isEmptyQueryTimeWindow(&pReader->window) && doTsdbNextDataBlock(pReader)) {
+      return true;
+    }
+    if (!asc) {
+      return false;
+    }
+    pReader->readRaw = true;
+    return tsdbNextDataBlock(pReader->pRawReader);
+  }
+
+  if (tsdbNextDataBlock(pReader->pRawReader)) {
+    return true;
+  }
+  if (asc) {
+    return false;
+  }
+  pReader->readRaw = false;
+  return !isEmptyQueryTimeWindow(&pReader->window) && doTsdbNextDataBlock(pReader);
+}
+
 bool tsdbNextDataBlock(STsdbReader* pReader) {
+  if (pReader->pRawReader != NULL) {
+    return tsdbNextRollupDataBlock(pReader);
+  }
+
   if (isEmptyQueryTimeWindow(&pReader->window)) {
     return false;
   }
@@ -4082,7 +4184,9 @@ static void setBlockInfo(const STsdbReader* pReader, int32_t* rows, uint64_t* ui
 }
 
 void tsdbRetrieveDataBlockInfo(const STsdbReader* pReader, int32_t* rows, uint64_t* uid, STimeWindow* pWindow) {
-  if (pReader->type == TIMEWINDOW_RANGE_EXTERNAL) {
+  if (pReader->readRaw) {
+    tsdbRetrieveDataBlockInfo(pReader->pRawReader, rows, uid, pWindow);
+  } else if (pReader->type == TIMEWINDOW_RANGE_EXTERNAL) {
     if (pReader->step == EXTERNAL_ROWS_MAIN) {
       setBlockInfo(pReader, rows, uid, pWindow);
     } else if (pReader->step == EXTERNAL_ROWS_PREV) {
@@ -4125,6 +4229,10 @@ int32_t tsdbRetrieveDatablockSMA(STsdbReader* pReader, SSDataBlock* pDataBlock,
   SColumnDataAgg ***pBlockSMA = &pDataBlock->pBlockAgg;
   *allHave = false;
 
+  if (pReader->readRaw) {
+    return tsdbRetrieveDatablockSMA(pReader->pRawReader, pDataBlock, allHave);
+  }
+
   if (pReader->type == TIMEWINDOW_RANGE_EXTERNAL) {
     *pBlockSMA = NULL;
     return TSDB_CODE_SUCCESS;
@@ -4237,6 +4345,10 @@ static SSDataBlock* doRetrieveDataBlock(STsdbReader* pReader) {
 }
 
 SSDataBlock* tsdbRetrieveDataBlock(STsdbReader* pReader, SArray* pIdList) {
+  if (pReader->readRaw) {
+    return tsdbRetrieveDataBlock(pReader->pRawReader, pIdList);
+  }
+
   if (pReader->type == TIMEWINDOW_RANGE_EXTERNAL) {
     if (pReader->step == EXTERNAL_ROWS_PREV) {
       return doRetrieveDataBlock(pReader->innerReader[0]);
@@ -4248,7 +4360,32 @@ SSDataBlock* tsdbRetrieveDataBlock(STsdbReader* pReader, SArray* pIdList) {
   return doRetrieveDataBlock(pReader);
 }
 
+// The query time window is split at the same key as when the reader is opened, for the rollup level and the raw data.
+static int32_t tsdbRollupReaderReset(STsdbReader* pReader, SQueryTableDataCond* pCond) {
+  STimeWindow  window = pCond->twindows;
+  STsdbReader* pRawReader = pReader->pRawReader;
+
+  pReader->pRawReader = NULL;
+  pCond->twindows.ekey = TMIN(window.ekey, pReader->rollupEndKey);
+  int32_t code = tsdbReaderReset(pReader, pCond);
+  pReader->pRawReader = pRawReader;
+
+  if (code == TSDB_CODE_SUCCESS) {
+    pCond->twindows.skey = TMAX(window.skey, pReader->rollupEndKey + 1);
+    pCond->twindows.ekey = window.ekey;
+    code = tsdbReaderReset(pRawReader, pCond);
+  }
+
+  pCond->twindows = window;
+  pReader->readRaw = !ASCENDING_TRAVERSE(pCond->order);
+  return code;
+}
+
 int32_t tsdbReaderReset(STsdbReader* pReader, SQueryTableDataCond* pCond) {
+  if (pReader->pRawReader != NULL) {
+    return tsdbRollupReaderReset(pReader, pCond);
+  }
+
   if (isEmptyQueryTimeWindow(&pReader->window) || pReader->pReadSnap == NULL) {
     return TSDB_CODE_SUCCESS;
   }
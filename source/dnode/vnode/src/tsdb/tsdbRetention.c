@@ -15,6 +15,38 @@
 
 #include "tsdb.h"
 
+#define TSDB_MIGRATE_MAX_THREADS  4
+#define TSDB_MIGRATE_STEP         (16 * 1024 * 1024)
+#define TSDB_MIGRATE_MAX_SLEEP_MS 100
+
+typedef struct {
+  SDFileSet *pSet;  // file set in the snapshot
+  SDiskID    did;   // disk to move to
+  int64_t    size;
+  int8_t     copied;
+  int8_t     applied;
+} SMigrateFSet;
+
+// Moves file sets to the tier they belong to with a few threads, each copying one file set at a time. Queries and
+// commits keep using the old copy, which is replaced in one fs commit after all copies are done.
+struct STsdbMigrator {
+  STsdb   *pTsdb;
+  int64_t  now;
+  STsdbFS  fs;     // referenced snapshot of the file system
+  SArray  *aFSet;  // SArray<SMigrateFSet>
+  int32_t  nThread;
+  TdThread aThread[TSDB_MIGRATE_MAX_THREADS];
+  int64_t  startUs;
+  int64_t  nBytes;
+  // updated by the threads
+  int32_t iFSet;  // next file set to copy
+  int32_t nFSetDone;
+  int32_t nThreadRunning;
+  int64_t nBytesDone;
+  int8_t  stop;
+  int8_t  done;
+};
+
 static bool tsdbShouldDoRetention(STsdb *pTsdb, int64_t now) {
   for (int32_t iSet = 0; iSet < taosArrayGetSize(pTsdb->fs.aDFileSet); iSet++) {
     SDFileSet *pSet = (SDFileSet *)taosArrayGet(pTsdb->fs.aDFileSet, iSet);
@@ -39,74 +71,435 @@ static bool tsdbShouldDoRetention(STsdb *pTsdb, int64_t now) {
   return false;
 }
 
-int32_t tsdbDoRetention(STsdb *pTsdb, int64_t now) {
-  int32_t code = 0;
+// copy ==============================================================================================
+// Charges the bytes to the I/O budget of the disk and waits for it in short sleeps, so a stop is not held up.
+static void tsdbMigrateThrottle(STsdbMigrator *pMigrator, SDiskID did, int64_t nBytes) {
+  int64_t speed = (int64_t)tsMigrateMaxSpeed * 1024 * 1024;
+  if (speed <= 0) return;
 
-  if (!tsdbShouldDoRetention(pTsdb, now)) {
-    return code;
+  int64_t nowUs = taosGetTimestampUs();
+  int64_t endUs = nowUs + tfsThrottleAt(pMigrator->pTsdb->pVnode->pTfs, did, nBytes, speed, nowUs);
+  int64_t sleepMs;
+  while (!atomic_load_8(&pMigrator->stop) && (sleepMs = (endUs - taosGetTimestampUs()) / 1000) > 0) {
+    taosMsleep((int32_t)TMIN(sleepMs, TSDB_MIGRATE_MAX_SLEEP_MS));
+  }
+}
+
+static int32_t tsdbMigrateFile(STsdbMigrator *pMigrator, SDiskID didFrom, const char *fNameFrom, SDiskID didTo,
+                               const char *fNameTo, int64_t size) {
+  int32_t   code = 0;
+  int32_t   lino = 0;
+  TdFilePtr pOutFD = NULL;
+  TdFilePtr pInFD = NULL;
+  int64_t   offset = 0;
+
+  pOutFD = taosOpenFile(fNameTo, TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC);
+  if (pOutFD == NULL) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  pInFD = taosOpenFile(fNameFrom, TD_FILE_READ);
+  if (pInFD == NULL) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  while (offset < size) {
+    if (atomic_load_8(&pMigrator->stop)) {
+      code = TSDB_CODE_VND_STOPPED;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    int64_t n = TMIN(size - offset, TSDB_MIGRATE_STEP);
+    if (taosFCopyFile(pOutFD, pInFD, &offset, n) != n) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    tsdbMigrateThrottle(pMigrator, didFrom, n);
+    tsdbMigrateThrottle(pMigrator, didTo, n);
+    atomic_add_fetch_64(&pMigrator->nBytesDone, n);
   }
 
-  // do retention
+  if (taosFsyncFile(pOutFD) < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, file:%s", TD_VID(pMigrator->pTsdb->pVnode), __func__, lino,
+              tstrerror(code), fNameFrom);
+  }
+  taosCloseFile(&pOutFD);
+  taosCloseFile(&pInFD);
+  return code;
+}
+
+static void tsdbMigrateRemoveFSet(STsdbMigrator *pMigrator, SMigrateFSet *pMSet) {
+  STsdb     *pTsdb = pMigrator->pTsdb;
+  SDFileSet *pSet = pMSet->pSet;
+  char       fname[TSDB_FILENAME_LEN];
+
+  tsdbHeadFileName(pTsdb, pMSet->did, pSet->fid, pSet->pHeadF, fname);
+  (void)taosRemoveFile(fname);
+  tsdbDataFileName(pTsdb, pMSet->did, pSet->fid, pSet->pDataF, fname);
+  (void)taosRemoveFile(fname);
+  tsdbSmaFileName(pTsdb, pMSet->did, pSet->fid, pSet->pSmaF, fname);
+  (void)taosRemoveFile(fname);
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    tsdbSttFileName(pTsdb, pMSet->did, pSet->fid, pSet->aSttF[iStt], fname);
+    (void)taosRemoveFile(fname);
+  }
+}
+
+static int32_t tsdbMigrateFSet(STsdbMigrator *pMigrator, SMigrateFSet *pMSet) {
+  int32_t    code = 0;
+  int32_t    lino = 0;
+  STsdb     *pTsdb = pMigrator->pTsdb;
+  SDFileSet *pSet = pMSet->pSet;
+  int32_t    szPage = pTsdb->pVnode->config.tsdbPageSize;
+  char       fNameFrom[TSDB_FILENAME_LEN];
+  char       fNameTo[TSDB_FILENAME_LEN];
+
+  // head
+  tsdbHeadFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pHeadF, fNameFrom);
+  tsdbHeadFileName(pTsdb, pMSet->did, pSet->fid, pSet->pHeadF, fNameTo);
+  code = tsdbMigrateFile(pMigrator, pSet->diskId, fNameFrom, pMSet->did, fNameTo,
+                         tsdbLogicToFileSize(pSet->pHeadF->size, szPage));
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // data
+  tsdbDataFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pDataF, fNameFrom);
+  tsdbDataFileName(pTsdb, pMSet->did, pSet->fid, pSet->pDataF, fNameTo);
+  code = tsdbMigrateFile(pMigrator, pSet->diskId, fNameFrom, pMSet->did, fNameTo,
+                         tsdbLogicToFileSize(pSet->pDataF->size, szPage));
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // sma
+  tsdbSmaFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pSmaF, fNameFrom);
+  tsdbSmaFileName(pTsdb, pMSet->did, pSet->fid, pSet->pSmaF, fNameTo);
+  code = tsdbMigrateFile(pMigrator, pSet->diskId, fNameFrom, pMSet->did, fNameTo,
+                         tsdbLogicToFileSize(pSet->pSmaF->size, szPage));
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // stt
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    tsdbSttFileName(pTsdb, pSet->diskId, pSet->fid, pSet->aSttF[iStt], fNameFrom);
+    tsdbSttFileName(pTsdb, pMSet->did, pSet->fid, pSet->aSttF[iStt], fNameTo);
+    code = tsdbMigrateFile(pMigrator, pSet->diskId, fNameFrom, pMSet->did, fNameTo,
+                           tsdbLogicToFileSize(pSet->aSttF[iStt]->size, szPage));
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  pMSet->copied = 1;
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, fid:%d", TD_VID(pTsdb->pVnode), __func__, lino,
+              tstrerror(code), pSet->fid);
+    tsdbMigrateRemoveFSet(pMigrator, pMSet);
+  }
+  return code;
+}
+
+// commit ==============================================================================================
+// Removes the expired file sets right away, they are not copied.
+static int32_t tsdbRemoveExpiredFSets(STsdb *pTsdb, int64_t now) {
+  int32_t code = 0;
+  int32_t lino = 0;
   STsdbFS fs = {0};
+  int32_t nRemoved = 0;
+
+  tsem_wait(&pTsdb->pVnode->canCommit);
 
   code = tsdbFSCopy(pTsdb, &fs);
-  if (code) goto _err;
+  TSDB_CHECK_CODE(code, lino, _exit);
 
   for (int32_t iSet = 0; iSet < taosArrayGetSize(fs.aDFileSet); iSet++) {
     SDFileSet *pSet = (SDFileSet *)taosArrayGet(fs.aDFileSet, iSet);
-    int32_t    expLevel = tsdbFidLevel(pSet->fid, &pTsdb->keepCfg, now);
-    SDiskID    did;
+    if (tsdbFidLevel(pSet->fid, &pTsdb->keepCfg, now) >= 0) continue;
 
-    if (expLevel < 0) {
-      taosMemoryFree(pSet->pHeadF);
-      taosMemoryFree(pSet->pDataF);
-      taosMemoryFree(pSet->aSttF[0]);
-      taosMemoryFree(pSet->pSmaF);
-      taosArrayRemove(fs.aDFileSet, iSet);
-      iSet--;
-    } else {
-      if (expLevel == 0) continue;
-      if (tfsAllocDisk(pTsdb->pVnode->pTfs, expLevel, &did) < 0) {
-        code = terrno;
-        goto _exit;
-      }
+    taosMemoryFree(pSet->pHeadF);
+    taosMemoryFree(pSet->pDataF);
+    taosMemoryFree(pSet->pSmaF);
+    for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+      taosMemoryFree(pSet->aSttF[iStt]);
+    }
+    taosArrayRemove(fs.aDFileSet, iSet);
+    iSet--;
+    nRemoved++;
+  }
+  if (nRemoved == 0) goto _exit;
 
-      if (did.level == pSet->diskId.level) continue;
+  code = tsdbFSPrepareCommit(pTsdb, &fs);
+  TSDB_CHECK_CODE(code, lino, _exit);
 
-      // copy file to new disk (todo)
-      SDFileSet fSet = *pSet;
-      fSet.diskId = did;
+  taosThreadRwlockWrlock(&pTsdb->rwLock);
+  code = tsdbFSCommit(pTsdb);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  if (code) {
+    tsdbFSRollback(pTsdb);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  tsdbInfo("vgId:%d, %d expired file sets removed", TD_VID(pTsdb->pVnode), nRemoved);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  tsem_post(&pTsdb->pVnode->canCommit);
+  tsdbFSDestroy(&fs);
+  return code;
+}
+
+// Switches the copied file sets to the new disks unless a commit changed or removed them meanwhile.
+static int32_t tsdbMigrateCommit(STsdbMigrator *pMigrator) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  STsdb  *pTsdb = pMigrator->pTsdb;
+  STsdbFS fs = {0};
+
+  tsem_wait(&pTsdb->pVnode->canCommit);
+
+  code = tsdbFSCopy(pTsdb, &fs);
+  TSDB_CHECK_CODE(code, lino, _exit);
 
-      code = tsdbDFileSetCopy(pTsdb, pSet, &fSet);
-      if (code) goto _err;
+  for (int32_t iFSet = 0; iFSet < taosArrayGetSize(pMigrator->aFSet); iFSet++) {
+    SMigrateFSet *pMSet = (SMigrateFSet *)taosArrayGet(pMigrator->aFSet, iFSet);
+    if (!pMSet->copied) continue;
 
-      code = tsdbFSUpsertFSet(&fs, &fSet);
-      if (code) goto _err;
+    SDFileSet *pSet = (SDFileSet *)taosArraySearch(fs.aDFileSet, pMSet->pSet, tDFileSetCmprFn, TD_EQ);
+    if (pSet == NULL || !tDFileSetIsSame(pSet, pMSet->pSet)) {
+      tsdbInfo("vgId:%d, fid:%d changed during migration, skip it", TD_VID(pTsdb->pVnode), pMSet->pSet->fid);
+      continue;
     }
+
+    SDFileSet fSet = *pMSet->pSet;
+    fSet.diskId = pMSet->did;
+    code = tsdbFSUpsertFSet(&fs, &fSet);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    pMSet->applied = 1;
   }
 
-  // do change fs
   code = tsdbFSPrepareCommit(pTsdb, &fs);
-  if (code) goto _err;
+  TSDB_CHECK_CODE(code, lino, _exit);
 
   taosThreadRwlockWrlock(&pTsdb->rwLock);
-
   code = tsdbFSCommit(pTsdb);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  if (code) {
+    tsdbFSRollback(pTsdb);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
   if (code) {
-    taosThreadRwlockUnlock(&pTsdb->rwLock);
-    goto _err;
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+    for (int32_t iFSet = 0; iFSet < taosArrayGetSize(pMigrator->aFSet); iFSet++) {
+      ((SMigrateFSet *)taosArrayGet(pMigrator->aFSet, iFSet))->applied = 0;
+    }
+  }
+  tsem_post(&pTsdb->pVnode->canCommit);
+  tsdbFSDestroy(&fs);
+  return code;
+}
+
+// the last one to release switches all copied file sets at once
+static void tsdbMigrateRelease(STsdbMigrator *pMigrator) {
+  STsdb  *pTsdb = pMigrator->pTsdb;
+  int32_t nFSet = taosArrayGetSize(pMigrator->aFSet);
+
+  if (atomic_sub_fetch_32(&pMigrator->nThreadRunning, 1) > 0) return;
+
+  if (tsdbMigrateCommit(pMigrator) == 0) {
+    int32_t nApplied = 0;
+    for (int32_t iFSet = 0; iFSet < nFSet; iFSet++) {
+      nApplied += ((SMigrateFSet *)taosArrayGet(pMigrator->aFSet, iFSet))->applied;
+    }
+    tsdbInfo("vgId:%d, tsdb migration done, nFSet:%d applied:%d, bytes:%" PRId64 " elapsed:%" PRId64 "ms",
+             TD_VID(pTsdb->pVnode), nFSet, nApplied, atomic_load_64(&pMigrator->nBytesDone),
+             (taosGetTimestampUs() - pMigrator->startUs) / 1000);
+  }
+  atomic_store_8(&pMigrator->done, 1);
+}
+
+static void *tsdbMigrateThreadFp(void *arg) {
+  STsdbMigrator *pMigrator = (STsdbMigrator *)arg;
+  STsdb         *pTsdb = pMigrator->pTsdb;
+  int32_t        nFSet = taosArrayGetSize(pMigrator->aFSet);
+
+  setThreadName("tsdb-migrate");
+
+  for (;;) {
+    int32_t iFSet = atomic_fetch_add_32(&pMigrator->iFSet, 1);
+    if (iFSet >= nFSet || atomic_load_8(&pMigrator->stop)) break;
+
+    SMigrateFSet *pMSet = (SMigrateFSet *)taosArrayGet(pMigrator->aFSet, iFSet);
+    if (tsdbMigrateFSet(pMigrator, pMSet) == 0) {
+      int32_t nFSetDone = atomic_add_fetch_32(&pMigrator->nFSetDone, 1);
+      int64_t nBytesDone = atomic_load_64(&pMigrator->nBytesDone);
+      tsdbInfo("vgId:%d, fid:%d copied to disk level:%d id:%d, size:%" PRId64 ", progress: %d/%d file sets, %.1f%%",
+               TD_VID(pTsdb->pVnode), pMSet->pSet->fid, pMSet->did.level, pMSet->did.id, pMSet->size, nFSetDone,
+               nFSet, pMigrator->nBytes ? nBytesDone * 100.0 / pMigrator->nBytes : 100.0);
+    }
+  }
+
+  tsdbMigrateRelease(pMigrator);
+  return NULL;
+}
+
+// open/close ==============================================================================================
+static void tsdbMigratorClose(STsdbMigrator **ppMigrator) {
+  STsdbMigrator *pMigrator = *ppMigrator;
+  if (pMigrator == NULL) return;
+
+  atomic_store_8(&pMigrator->stop, 1);
+  for (int32_t iThread = 0; iThread < pMigrator->nThread; iThread++) {
+    taosThreadJoin(pMigrator->aThread[iThread], NULL);
+    taosThreadClear(&pMigrator->aThread[iThread]);
+  }
+
+  for (int32_t iFSet = 0; iFSet < taosArrayGetSize(pMigrator->aFSet); iFSet++) {
+    SMigrateFSet *pMSet = (SMigrateFSet *)taosArrayGet(pMigrator->aFSet, iFSet);
+    if (pMSet->copied && !pMSet->applied) {
+      tsdbMigrateRemoveFSet(pMigrator, pMSet);
+    }
+  }
+
+  if (pMigrator->fs.aDFileSet) {
+    tsdbFSUnref(pMigrator->pTsdb, &pMigrator->fs);
+  }
+  taosArrayDestroy(pMigrator->aFSet);
+  taosMemoryFree(pMigrator);
+  *ppMigrator = NULL;
+}
+
+static int32_t tsdbMigratorOpen(STsdb *pTsdb, int64_t now, STsdbMigrator **ppMigrator) {
+  int32_t        code = 0;
+  int32_t        lino = 0;
+  int32_t        szPage = pTsdb->pVnode->config.tsdbPageSize;
+  STsdbMigrator *pMigrator = NULL;
+
+  pMigrator = (STsdbMigrator *)taosMemoryCalloc(1, sizeof(*pMigrator));
+  if (pMigrator == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
   }
+  pMigrator->pTsdb = pTsdb;
+  pMigrator->now = now;
+  pMigrator->startUs = taosGetTimestampUs();
 
+  pMigrator->aFSet = taosArrayInit(0, sizeof(SMigrateFSet));
+  if (pMigrator->aFSet == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  code = tsdbFSRef(pTsdb, &pMigrator->fs);
   taosThreadRwlockUnlock(&pTsdb->rwLock);
+  TSDB_CHECK_CODE(code, lino, _exit);
 
-  tsdbFSDestroy(&fs);
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(pMigrator->fs.aDFileSet); iSet++) {
+    SDFileSet   *pSet = (SDFileSet *)taosArrayGet(pMigrator->fs.aDFileSet, iSet);
+    int32_t      expLevel = tsdbFidLevel(pSet->fid, &pTsdb->keepCfg, now);
+    SMigrateFSet mSet = {.pSet = pSet};
+
+    if (expLevel <= 0) continue;
+    if (tfsAllocDisk(pTsdb->pVnode->pTfs, expLevel, &mSet.did) < 0) {
+      code = terrno;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+    if (mSet.did.level == pSet->diskId.level) continue;
+
+    mSet.size = tsdbLogicToFileSize(pSet->pHeadF->size, szPage) + tsdbLogicToFileSize(pSet->pDataF->size, szPage) +
+                tsdbLogicToFileSize(pSet->pSmaF->size, szPage);
+    for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+      mSet.size += tsdbLogicToFileSize(pSet->aSttF[iStt]->size, szPage);
+    }
+    pMigrator->nBytes += mSet.size;
+
+    if (taosArrayPush(pMigrator->aFSet, &mSet) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
 
 _exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+    tsdbMigratorClose(&pMigrator);
+  }
+  *ppMigrator = pMigrator;
   return code;
+}
 
-_err:
-  tsdbError("vgId:%d, tsdb do retention failed since %s", TD_VID(pTsdb->pVnode), tstrerror(code));
-  ASSERT(0);
-  // tsdbFSRollback(pTsdb->pFS);
+void tsdbStopMigration(STsdb *pTsdb) { tsdbMigratorClose(&pTsdb->pMigrator); }
+
+/*
+ * Expired file sets are removed at once, also while a migration is running. File sets belonging to another tier are
+ * copied in the background and switched when that finishes. A new migration is not started while the last one is
+ * still running.
+ */
+int32_t tsdbDoRetention(STsdb *pTsdb, int64_t now) {
+  int32_t        code = 0;
+  int32_t        lino = 0;
+  STsdbMigrator *pMigrator = NULL;
+
+  if (!tsdbShouldDoRetention(pTsdb, now)) {
+    return code;
+  }
+
+  code = tsdbRemoveExpiredFSets(pTsdb, now);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (pTsdb->pMigrator) {
+    if (!atomic_load_8(&pTsdb->pMigrator->done)) {
+      tsdbInfo("vgId:%d, tsdb migration is in progress, %" PRId64 "/%" PRId64 " bytes, skip migration",
+               TD_VID(pTsdb->pVnode), atomic_load_64(&pTsdb->pMigrator->nBytesDone), pTsdb->pMigrator->nBytes);
+      return code;
+    }
+    tsdbMigratorClose(&pTsdb->pMigrator);
+  }
+
+  code = tsdbMigratorOpen(pTsdb, now, &pMigrator);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  int32_t nFSet = taosArrayGetSize(pMigrator->aFSet);
+  if (nFSet == 0) {
+    tsdbMigratorClose(&pMigrator);
+    goto _exit;
+  }
+
+  tsdbInfo("vgId:%d, tsdb migration started, nFSet:%d bytes:%" PRId64, TD_VID(pTsdb->pVnode), nFSet,
+           pMigrator->nBytes);
+
+  // the caller holds one reference until all threads are started
+  pMigrator->nThreadRunning = 1;
+  for (int32_t iThread = 0; iThread < TMIN(nFSet, TSDB_MIGRATE_MAX_THREADS); iThread++) {
+    TdThreadAttr thAttr;
+    taosThreadAttrInit(&thAttr);
+    taosThreadAttrSetDetachState(&thAttr, PTHREAD_CREATE_JOINABLE);
+    atomic_add_fetch_32(&pMigrator->nThreadRunning, 1);
+    int32_t ret = taosThreadCreate(&pMigrator->aThread[iThread], &thAttr, tsdbMigrateThreadFp, pMigrator);
+    taosThreadAttrDestroy(&thAttr);
+    if (ret != 0) {
+      atomic_sub_fetch_32(&pMigrator->nThreadRunning, 1);
+      tsdbError("vgId:%d, failed to create tsdb migration thread since %s", TD_VID(pTsdb->pVnode), strerror(ret));
+      break;
+    }
+    pMigrator->nThread++;
+  }
+  pTsdb->pMigrator = pMigrator;
+  tsdbMigrateRelease(pMigrator);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
   return code;
-}
\ No newline at end of file
+}
@@ -0,0 +1,572 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdb.h"
+
+#define TSDB_BLOCK_DIST_SMALL_ROWS 4096
+
+typedef struct {
+  int64_t commitID;   // the file is summarized again once it is rewritten
+  SArray *aStbStats;  // SArray<STsdbStbStats>, sorted by suid, NULL if the file is not summarized
+} STsdbFileStats;
+
+typedef struct {
+  int32_t        fid;
+  STsdbFileStats headStats;  // the data blocks indexed by the .head file
+  int32_t        nSttF;
+  STsdbFileStats aSttStats[TSDB_MAX_STT_TRIGGER];
+} STsdbFSetStats;
+
+// Rows, time range and block distribution of each super table per file, summed up from the SDataBlk and SSttBlk
+// index of the files only. The committer summarizes the files it writes from the index it builds, the files written
+// otherwise, e.g. by compaction or retention, are read when the stats are asked for. Rows still in the memtable are not
+// counted and rows of duplicated keys may be counted more than once.
+//
+// The blocks of dropped tables stay in the files until they are rewritten, they are left out of the summaries: the
+// summaries with a dropped child table are read again, the ones of a dropped super table lose it. A .stt block holding
+// rows of several tables is counted as long as any of them may still exist.
+struct STsdbStats {
+  TdThreadMutex mutex;
+  SArray       *aFSetStats;  // SArray<STsdbFSetStats>, sorted by fid
+  SArray       *aCommitted;  // SArray<STsdbFSetStats>, the files written by the ongoing commit
+  int64_t       nDrop;       // the tables dropped, the summaries of a commit running across a drop are not taken
+  int64_t       nDropCommit;
+};
+
+int32_t tsdbStbStatsCmprFn(const void *p1, const void *p2) {
+  int64_t suid1 = ((STsdbStbStats *)p1)->suid;
+  int64_t suid2 = ((STsdbStbStats *)p2)->suid;
+  if (suid1 < suid2) {
+    return -1;
+  } else if (suid1 > suid2) {
+    return 1;
+  }
+  return 0;
+}
+
+static int32_t tsdbFSetStatsCmprFn(const void *p1, const void *p2) {
+  int32_t fid1 = ((STsdbFSetStats *)p1)->fid;
+  int32_t fid2 = ((STsdbFSetStats *)p2)->fid;
+  if (fid1 < fid2) {
+    return -1;
+  } else if (fid1 > fid2) {
+    return 1;
+  }
+  return 0;
+}
+
+static STsdbStbStats *tsdbStbStatsGet(SArray *aStbStats, int64_t suid) {
+  STsdbStbStats  stats = {.suid = suid, .minKey = TSKEY_MAX, .maxKey = TSKEY_MIN};
+  STsdbStbStats *pStats = NULL;
+
+  int32_t n = taosArrayGetSize(aStbStats);
+  if (n > 0 && ((STsdbStbStats *)taosArrayGet(aStbStats, n - 1))->suid == suid) {
+    return taosArrayGet(aStbStats, n - 1);
+  }
+
+  pStats = taosArraySearch(aStbStats, &stats, tsdbStbStatsCmprFn, TD_EQ);
+  if (pStats) {
+    return pStats;
+  }
+
+  stats.blockDist.minRows = INT32_MAX;
+  stats.blockDist.maxRows = INT32_MIN;
+
+  int32_t idx = taosArraySearchIdx(aStbStats, &stats, tsdbStbStatsCmprFn, TD_GT);
+  if (idx < 0) idx = n;
+  return taosArrayInsert(aStbStats, idx, &stats);
+}
+
+static int32_t tsdbStbStatsAdd(SArray *aStbStats, int64_t suid, int64_t nRow, TSKEY minKey, TSKEY maxKey) {
+  STsdbStbStats *pStats = tsdbStbStatsGet(aStbStats, suid);
+  if (pStats == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pStats->nRow += nRow;
+  pStats->minKey = TMIN(pStats->minKey, minKey);
+  pStats->maxKey = TMAX(pStats->maxKey, maxKey);
+  return 0;
+}
+
+// the same bucketing as the block distribution collected by tsdbGetFileBlocksDistInfo
+static void tsdbBlockDistAddBlock(STableBlockDistInfo *pDist, SDataBlk *pDataBlk, STsdbCfg *pCfg) {
+  int32_t nRow = pDataBlk->nRow;
+  int32_t bucketRange = ceil((pCfg->maxRows - pCfg->minRows) / 20.0);
+  int32_t bucketIndex = (nRow - pCfg->minRows) / TMAX(bucketRange, 1);
+
+  pDist->numOfBlocks += 1;
+  pDist->totalRows += nRow;
+  for (int32_t iSubBlock = 0; iSubBlock < pDataBlk->nSubBlock; iSubBlock++) {
+    pDist->totalSize += pDataBlk->aSubBlock[iSubBlock].szBlock;
+  }
+  pDist->maxRows = TMAX(pDist->maxRows, nRow);
+  pDist->minRows = TMIN(pDist->minRows, nRow);
+  if (nRow < TSDB_BLOCK_DIST_SMALL_ROWS) {
+    pDist->numOfSmallBlocks += 1;
+  }
+  bucketIndex = TMAX(TMIN(bucketIndex, tListLen(pDist->blockRowsHisto) - 1), 0);
+  pDist->blockRowsHisto[bucketIndex]++;
+}
+
+static void tsdbBlockDistMerge(STableBlockDistInfo *pDist, const STableBlockDistInfo *pOther) {
+  pDist->numOfBlocks += pOther->numOfBlocks;
+  pDist->totalRows += pOther->totalRows;
+  pDist->totalSize += pOther->totalSize;
+  pDist->maxRows = TMAX(pDist->maxRows, pOther->maxRows);
+  pDist->minRows = TMIN(pDist->minRows, pOther->minRows);
+  pDist->numOfSmallBlocks += pOther->numOfSmallBlocks;
+  for (int32_t i = 0; i < tListLen(pDist->blockRowsHisto); i++) {
+    pDist->blockRowsHisto[i] += pOther->blockRowsHisto[i];
+  }
+}
+
+static bool tsdbStatsTableExists(STsdb *pTsdb, int64_t uid) {
+  SMetaInfo info;
+  return metaGetInfo(pTsdb->pVnode->pMeta, uid, &info, NULL) == 0;
+}
+
+int32_t tsdbStatsAddDataBlk(STsdb *pTsdb, SArray *aStbStats, const SBlockIdx *pBlockIdx, SMapData *mDataBlk) {
+  if (pBlockIdx->suid == 0 || !tsdbStatsTableExists(pTsdb, pBlockIdx->uid)) return 0;
+
+  STsdbCfg      *pCfg = &pTsdb->pVnode->config.tsdbCfg;
+  STsdbStbStats *pStbStats = tsdbStbStatsGet(aStbStats, pBlockIdx->suid);
+  if (pStbStats == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  SDataBlk dataBlk;
+  for (int32_t iDataBlk = 0; iDataBlk < mDataBlk->nItem; iDataBlk++) {
+    tMapDataGetItemByIdx(mDataBlk, iDataBlk, &dataBlk, tGetDataBlk);
+    pStbStats->nRow += dataBlk.nRow;
+    pStbStats->minKey = TMIN(pStbStats->minKey, dataBlk.minKey.ts);
+    pStbStats->maxKey = TMAX(pStbStats->maxKey, dataBlk.maxKey.ts);
+    tsdbBlockDistAddBlock(&pStbStats->blockDist, &dataBlk, pCfg);
+  }
+  return 0;
+}
+
+int32_t tsdbStatsAddSttBlk(STsdb *pTsdb, SArray *aStbStats, SArray *aSttBlk) {
+  for (int32_t iSttBlk = 0; iSttBlk < taosArrayGetSize(aSttBlk); iSttBlk++) {
+    SSttBlk *pSttBlk = (SSttBlk *)taosArrayGet(aSttBlk, iSttBlk);
+    if (pSttBlk->suid == 0) continue;
+    if (pSttBlk->minUid == pSttBlk->maxUid && !tsdbStatsTableExists(pTsdb, pSttBlk->minUid)) continue;
+
+    int32_t code = tsdbStbStatsAdd(aStbStats, pSttBlk->suid, pSttBlk->nRow, pSttBlk->minKey, pSttBlk->maxKey);
+    if (code) return code;
+  }
+  return 0;
+}
+
+static int32_t tsdbSummarizeHeadFile(STsdb *pTsdb, SDataFReader *pReader, SArray *aStbStats) {
+  int32_t  code = 0;
+  SArray  *aBlockIdx = taosArrayInit(0, sizeof(SBlockIdx));
+  SMapData mDataBlk = {0};
+  if (aBlockIdx == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  code = tsdbReadBlockIdx(pReader, aBlockIdx);
+  for (int32_t iBlockIdx = 0; code == 0 && iBlockIdx < taosArrayGetSize(aBlockIdx); iBlockIdx++) {
+    SBlockIdx *pBlockIdx = (SBlockIdx *)taosArrayGet(aBlockIdx, iBlockIdx);
+    if (pBlockIdx->suid == 0 || !tsdbStatsTableExists(pTsdb, pBlockIdx->uid)) continue;
+
+    code = tsdbReadDataBlk(pReader, pBlockIdx, &mDataBlk);
+    if (code == 0) {
+      code = tsdbStatsAddDataBlk(pTsdb, aStbStats, pBlockIdx, &mDataBlk);
+    }
+  }
+
+  tMapDataClear(&mDataBlk);
+  taosArrayDestroy(aBlockIdx);
+  return code;
+}
+
+static int32_t tsdbSummarizeSttFile(STsdb *pTsdb, SDataFReader *pReader, int32_t iStt, SArray *aStbStats) {
+  SArray *aSttBlk = taosArrayInit(0, sizeof(SSttBlk));
+  if (aSttBlk == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  int32_t code = tsdbReadSttBlk(pReader, iStt, aSttBlk);
+  if (code == 0) {
+    code = tsdbStatsAddSttBlk(pTsdb, aStbStats, aSttBlk);
+  }
+  taosArrayDestroy(aSttBlk);
+  return code;
+}
+
+static void tsdbFSetStatsClear(void *p) {
+  STsdbFSetStats *pStats = (STsdbFSetStats *)p;
+  taosArrayDestroy(pStats->headStats.aStbStats);
+  for (int32_t iStt = 0; iStt < pStats->nSttF; iStt++) {
+    taosArrayDestroy(pStats->aSttStats[iStt].aStbStats);
+  }
+}
+
+// the summary of a file kept in the stats or given by the committer, which is moved out of them
+static bool tsdbFileStatsTake(STsdbFileStats *pDst, SArray *aFSetStats, int32_t fid, int64_t commitID, bool isStt) {
+  STsdbFSetStats  key = {.fid = fid};
+  STsdbFSetStats *pFSetStats = taosArraySearch(aFSetStats, &key, tsdbFSetStatsCmprFn, TD_EQ);
+  if (pFSetStats == NULL) return false;
+
+  int32_t         nFile = isStt ? pFSetStats->nSttF : 1;
+  STsdbFileStats *aFileStats = isStt ? pFSetStats->aSttStats : &pFSetStats->headStats;
+  for (int32_t iFile = 0; iFile < nFile; iFile++) {
+    if (aFileStats[iFile].aStbStats && aFileStats[iFile].commitID == commitID) {
+      *pDst = aFileStats[iFile];
+      aFileStats[iFile].aStbStats = NULL;
+      return true;
+    }
+  }
+  return false;
+}
+
+static int32_t tsdbSummarizeFSet(STsdb *pTsdb, SDFileSet *pSet, STsdbFSetStats *pFSetStats) {
+  int32_t       code = 0;
+  int32_t       lino = 0;
+  SDataFReader *pReader = NULL;
+
+  code = tsdbDataFReaderOpen(&pReader, pTsdb, pSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (pFSetStats->headStats.aStbStats == NULL) {
+    SArray *aStbStats = taosArrayInit(0, sizeof(STsdbStbStats));
+    if (aStbStats == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+    pFSetStats->headStats.aStbStats = aStbStats;
+
+    code = tsdbSummarizeHeadFile(pTsdb, pReader, aStbStats);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    if (pFSetStats->aSttStats[iStt].aStbStats) continue;
+
+    SArray *aStbStats = taosArrayInit(0, sizeof(STsdbStbStats));
+    if (aStbStats == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+    pFSetStats->aSttStats[iStt].aStbStats = aStbStats;
+
+    code = tsdbSummarizeSttFile(pTsdb, pReader, iStt, aStbStats);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, fid:%d", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code),
+              pSet->fid);
+  }
+  if (pReader) tsdbDataFReaderClose(&pReader);
+  return code;
+}
+
+int32_t tsdbOpenStats(STsdb *pTsdb) {
+  STsdbStats *pStats = taosMemoryCalloc(1, sizeof(STsdbStats));
+  if (pStats == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pStats->aFSetStats = taosArrayInit(0, sizeof(STsdbFSetStats));
+  pStats->aCommitted = taosArrayInit(0, sizeof(STsdbFSetStats));
+  if (pStats->aFSetStats == NULL || pStats->aCommitted == NULL) {
+    taosArrayDestroy(pStats->aFSetStats);
+    taosArrayDestroy(pStats->aCommitted);
+    taosMemoryFree(pStats);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  taosThreadMutexInit(&pStats->mutex, NULL);
+
+  pTsdb->pStats = pStats;
+  return 0;
+}
+
+void tsdbCloseStats(STsdb *pTsdb) {
+  STsdbStats *pStats = pTsdb->pStats;
+  if (pStats == NULL) return;
+
+  taosArrayDestroyEx(pStats->aFSetStats, tsdbFSetStatsClear);
+  taosArrayDestroyEx(pStats->aCommitted, tsdbFSetStatsClear);
+  taosThreadMutexDestroy(&pStats->mutex);
+  taosMemoryFree(pStats);
+  pTsdb->pStats = NULL;
+}
+
+// Match the summaries with the files of the file system, the ones of files no longer there are dropped. The files not
+// summarized yet are read if toRead, or left out until the next refresh which reads them.
+static int32_t tsdbRefreshStatsImpl(STsdb *pTsdb, STsdbFS *pFS, bool toRead) {
+  int32_t     code = 0;
+  int32_t     lino = 0;
+  STsdbStats *pStats = pTsdb->pStats;
+  SArray     *aFSetStats = NULL;
+
+  aFSetStats = taosArrayInit(taosArrayGetSize(pFS->aDFileSet), sizeof(STsdbFSetStats));
+  if (aFSetStats == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(pFS->aDFileSet); iSet++) {
+    SDFileSet     *pSet = (SDFileSet *)taosArrayGet(pFS->aDFileSet, iSet);
+    STsdbFSetStats fsetStats = {.fid = pSet->fid, .nSttF = pSet->nSttF};
+    bool           complete = true;
+
+    STsdbFileStats *pFileStats = &fsetStats.headStats;
+    pFileStats->commitID = pSet->pHeadF->commitID;
+    if (!tsdbFileStatsTake(pFileStats, pStats->aFSetStats, pSet->fid, pFileStats->commitID, false) &&
+        !tsdbFileStatsTake(pFileStats, pStats->aCommitted, pSet->fid, pFileStats->commitID, false)) {
+      complete = false;
+    }
+    for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+      pFileStats = &fsetStats.aSttStats[iStt];
+      pFileStats->commitID = pSet->aSttF[iStt]->commitID;
+      if (!tsdbFileStatsTake(pFileStats, pStats->aFSetStats, pSet->fid, pFileStats->commitID, true) &&
+          !tsdbFileStatsTake(pFileStats, pStats->aCommitted, pSet->fid, pFileStats->commitID, true)) {
+        complete = false;
+      }
+    }
+
+    if (taosArrayPush(aFSetStats, &fsetStats) == NULL) {
+      tsdbFSetStatsClear(&fsetStats);
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    if (!complete && toRead) {
+      code = tsdbSummarizeFSet(pTsdb, pSet, (STsdbFSetStats *)taosArrayGetLast(aFSetStats));
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+  TSWAP(pStats->aFSetStats, aFSetStats);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  taosArrayDestroyEx(aFSetStats, tsdbFSetStatsClear);
+  return code;
+}
+
+static int32_t tsdbRefreshStatsWithFS(STsdb *pTsdb, bool toRead) {
+  STsdbFS fs = {0};
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  int32_t code = tsdbFSRef(pTsdb, &fs);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  if (code) return code;
+
+  code = tsdbRefreshStatsImpl(pTsdb, &fs, toRead);
+  tsdbFSUnref(pTsdb, &fs);
+  return code;
+}
+
+void tsdbStatsBeginCommit(STsdb *pTsdb) {
+  STsdbStats *pStats = pTsdb->pStats;
+  if (pStats == NULL) return;
+
+  taosThreadMutexLock(&pStats->mutex);
+  taosArrayClearEx(pStats->aCommitted, tsdbFSetStatsClear);
+  pStats->nDropCommit = pStats->nDrop;
+  taosThreadMutexUnlock(&pStats->mutex);
+}
+
+// the summaries of the .head file and the new .stt file of a file set written by the commit
+int32_t tsdbStatsPutCommitted(STsdb *pTsdb, SDFileSet *pSet, SArray *aHeadStbStats, SArray *aSttBlk) {
+  int32_t        code = 0;
+  STsdbStats    *pStats = pTsdb->pStats;
+  STsdbFSetStats fsetStats = {.fid = pSet->fid, .nSttF = 1};
+  if (pStats == NULL) return 0;
+
+  fsetStats.headStats.commitID = pSet->pHeadF->commitID;
+  fsetStats.headStats.aStbStats = taosArrayDup(aHeadStbStats, NULL);
+  fsetStats.aSttStats[0].commitID = pSet->aSttF[pSet->nSttF - 1]->commitID;
+  fsetStats.aSttStats[0].aStbStats = taosArrayInit(0, sizeof(STsdbStbStats));
+  if (fsetStats.headStats.aStbStats == NULL || fsetStats.aSttStats[0].aStbStats == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  code = tsdbStatsAddSttBlk(pTsdb, fsetStats.aSttStats[0].aStbStats, aSttBlk);
+  if (code) goto _exit;
+
+  taosThreadMutexLock(&pStats->mutex);
+  if (pStats->nDrop == pStats->nDropCommit) {
+    int32_t idx = taosArraySearchIdx(pStats->aCommitted, &fsetStats, tsdbFSetStatsCmprFn, TD_GT);
+    if (taosArrayInsert(pStats->aCommitted, idx < 0 ? taosArrayGetSize(pStats->aCommitted) : idx, &fsetStats) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+  } else {
+    // a table dropped since the commit began may be in the summaries, the files are read instead
+    tsdbFSetStatsClear(&fsetStats);
+  }
+  taosThreadMutexUnlock(&pStats->mutex);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed since %s, fid:%d", TD_VID(pTsdb->pVnode), __func__, tstrerror(code), pSet->fid);
+    tsdbFSetStatsClear(&fsetStats);
+  }
+  return code;
+}
+
+// Without reading any file: the file sets written by the commit take the summaries of the committer, and the others
+// keep theirs.
+int32_t tsdbStatsFinishCommit(STsdb *pTsdb) {
+  STsdbStats *pStats = pTsdb->pStats;
+  if (pStats == NULL) return 0;
+
+  taosThreadMutexLock(&pStats->mutex);
+  int32_t code = tsdbRefreshStatsWithFS(pTsdb, false);
+  taosArrayClearEx(pStats->aCommitted, tsdbFSetStatsClear);
+  taosThreadMutexUnlock(&pStats->mutex);
+  return code;
+}
+
+// the summaries with the super table suid, or with any super table if suid is 0, are dropped to be read again
+static void tsdbFSetStatsForget(SArray *aFSetStats, int64_t suid) {
+  STsdbStbStats key = {.suid = suid};
+
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(aFSetStats); iSet++) {
+    STsdbFSetStats *pFSetStats = (STsdbFSetStats *)taosArrayGet(aFSetStats, iSet);
+    for (int32_t iFile = -1; iFile < pFSetStats->nSttF; iFile++) {
+      STsdbFileStats *pFileStats = iFile < 0 ? &pFSetStats->headStats : &pFSetStats->aSttStats[iFile];
+      if (taosArrayGetSize(pFileStats->aStbStats) == 0) continue;
+      if (suid && taosArraySearch(pFileStats->aStbStats, &key, tsdbStbStatsCmprFn, TD_EQ) == NULL) continue;
+
+      taosArrayDestroy(pFileStats->aStbStats);
+      pFileStats->aStbStats = NULL;
+    }
+  }
+}
+
+static void tsdbFSetStatsRemoveStb(SArray *aFSetStats, int64_t suid) {
+  STsdbStbStats key = {.suid = suid};
+
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(aFSetStats); iSet++) {
+    STsdbFSetStats *pFSetStats = (STsdbFSetStats *)taosArrayGet(aFSetStats, iSet);
+    for (int32_t iFile = -1; iFile < pFSetStats->nSttF; iFile++) {
+      STsdbFileStats *pFileStats = iFile < 0 ? &pFSetStats->headStats : &pFSetStats->aSttStats[iFile];
+      int32_t         idx = taosArraySearchIdx(pFileStats->aStbStats, &key, tsdbStbStatsCmprFn, TD_EQ);
+      if (idx >= 0) taosArrayRemove(pFileStats->aStbStats, idx);
+    }
+  }
+}
+
+// A child table is dropped, suid is 0 if not known. Its rows in the memtables are no longer counted, and the summaries
+// which may have its blocks are read again when asked for.
+void tsdbStatsDropTable(STsdb *pTsdb, int64_t suid, int64_t uid) {
+  STsdbStats *pStats = pTsdb->pStats;
+  if (pStats == NULL) return;
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  int64_t memSuid = pTsdb->mem ? tsdbMemTableDropTbNRow(pTsdb->mem, uid) : 0;
+  int64_t imemSuid = pTsdb->imem ? tsdbMemTableDropTbNRow(pTsdb->imem, uid) : 0;
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  if (suid == 0) suid = memSuid ? memSuid : imemSuid;
+
+  taosThreadMutexLock(&pStats->mutex);
+  pStats->nDrop++;
+  tsdbFSetStatsForget(pStats->aFSetStats, suid);
+  tsdbFSetStatsForget(pStats->aCommitted, suid);
+  taosThreadMutexUnlock(&pStats->mutex);
+}
+
+// a super table is dropped with all its child tables, which leaves it out of all the summaries
+void tsdbStatsDropStb(STsdb *pTsdb, int64_t suid) {
+  STsdbStats *pStats = pTsdb->pStats;
+  if (pStats == NULL) return;
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  if (pTsdb->mem) tsdbMemTableDropStbNRow(pTsdb->mem, suid);
+  if (pTsdb->imem) tsdbMemTableDropStbNRow(pTsdb->imem, suid);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+
+  taosThreadMutexLock(&pStats->mutex);
+  pStats->nDrop++;
+  tsdbFSetStatsRemoveStb(pStats->aFSetStats, suid);
+  tsdbFSetStatsRemoveStb(pStats->aCommitted, suid);
+  taosThreadMutexUnlock(&pStats->mutex);
+}
+
+int32_t tsdbGetStbStats(STsdb *pTsdb, SArray *aStbStats) {
+  int32_t     code = 0;
+  STsdbStats *pStats = pTsdb->pStats;
+  if (pStats == NULL) return 0;
+
+  taosThreadMutexLock(&pStats->mutex);
+  code = tsdbRefreshStatsWithFS(pTsdb, true);
+
+  for (int32_t iSet = 0; code == 0 && iSet < taosArrayGetSize(pStats->aFSetStats); iSet++) {
+    STsdbFSetStats *pFSetStats = (STsdbFSetStats *)taosArrayGet(pStats->aFSetStats, iSet);
+    for (int32_t iFile = -1; code == 0 && iFile < pFSetStats->nSttF; iFile++) {
+      STsdbFileStats *pFileStats = iFile < 0 ? &pFSetStats->headStats : &pFSetStats->aSttStats[iFile];
+      for (int32_t i = 0; i < taosArrayGetSize(pFileStats->aStbStats); i++) {
+        STsdbStbStats *pStbStats = (STsdbStbStats *)taosArrayGet(pFileStats->aStbStats, i);
+        code = tsdbStbStatsAdd(aStbStats, pStbStats->suid, pStbStats->nRow, pStbStats->minKey, pStbStats->maxKey);
+        if (code) break;
+      }
+    }
+  }
+  taosThreadMutexUnlock(&pStats->mutex);
+
+  return code;
+}
+
+// The block distribution of a super table from the summaries of the .head files and the row counters of the memtables,
+// without reading any block index. The files rewritten since the last commit, e.g. by compaction, are summarized first,
+// and the memtables are taken together with the file sets so that no rows are counted twice.
+int32_t tsdbGetStbBlockDistInfo(STsdb *pTsdb, int64_t suid, STableBlockDistInfo *pInfo) {
+  int32_t     code = 0;
+  STsdbStats *pStats = pTsdb->pStats;
+  STsdbFS     fs = {0};
+  int64_t     nInmemRow = 0;
+
+  if (pStats == NULL) {
+    return TSDB_CODE_FAILED;
+  }
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  code = tsdbFSRef(pTsdb, &fs);
+  if (code == 0) {
+    if (pTsdb->mem) nInmemRow += tsdbMemTableGetStbNRow(pTsdb->mem, suid);
+    if (pTsdb->imem) nInmemRow += tsdbMemTableGetStbNRow(pTsdb->imem, suid);
+  }
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  if (code) return code;
+
+  taosThreadMutexLock(&pStats->mutex);
+  code = tsdbRefreshStatsImpl(pTsdb, &fs, true);
+  for (int32_t iSet = 0; code == 0 && iSet < taosArrayGetSize(pStats->aFSetStats); iSet++) {
+    STsdbFSetStats *pFSetStats = (STsdbFSetStats *)taosArrayGet(pStats->aFSetStats, iSet);
+    STsdbStbStats   key = {.suid = suid};
+    STsdbStbStats  *pStbStats = taosArraySearch(pFSetStats->headStats.aStbStats, &key, tsdbStbStatsCmprFn, TD_EQ);
+    if (pStbStats && pStbStats->blockDist.numOfBlocks > 0) {
+      tsdbBlockDistMerge(pInfo, &pStbStats->blockDist);
+      pInfo->numOfFiles += 1;
+    }
+  }
+  taosThreadMutexUnlock(&pStats->mutex);
+  tsdbFSUnref(pTsdb, &fs);
+
+  pInfo->defMinRows = pTsdb->pVnode->config.tsdbCfg.minRows;
+  pInfo->defMaxRows = pTsdb->pVnode->config.tsdbCfg.maxRows;
+  pInfo->numOfInmemRows = (uint32_t)nInmemRow;
+  return code;
+}
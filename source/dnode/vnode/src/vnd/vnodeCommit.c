@@ -333,6 +333,113 @@ _exit:
   return 0;
 }
 
+typedef struct {
+  SVnode *pVnode;
+  int64_t commitID;
+} SCompactInfo;
+
+// wake up vnodeClose() waiting for the compaction
+static void vnodeCompactEnd(SVnode *pVnode) {
+  taosThreadMutexLock(&pVnode->mutex);
+  pVnode->compacting = 0;
+  taosThreadCondSignal(&pVnode->compactDone);
+  taosThreadMutexUnlock(&pVnode->mutex);
+}
+
+static int32_t vnodeCompactTask(void *arg) {
+  int32_t       code = 0;
+  int32_t       lino = 0;
+  SCompactInfo *pInfo = (SCompactInfo *)arg;
+  SVnode       *pVnode = pInfo->pVnode;
+  char          dir[TSDB_FILENAME_LEN] = {0};
+  SVnodeInfo    info = {0};
+
+  if (pVnode->pTfs) {
+    snprintf(dir, TSDB_FILENAME_LEN, "%s%s%s", tfsGetPrimaryPath(pVnode->pTfs), TD_DIRSEP, pVnode->path);
+  } else {
+    snprintf(dir, TSDB_FILENAME_LEN, "%s", pVnode->path);
+  }
+
+  // persist the reserved commit ID, so it is not reused after a restart
+  tsem_wait(&pVnode->canCommit);
+  code = vnodeLoadInfo(dir, &info);
+  if (code == 0 && info.state.commitID < pInfo->commitID) {
+    info.state.commitID = pInfo->commitID;
+    code = vnodeSaveInfo(dir, &info);
+    if (code == 0) code = vnodeCommitInfo(dir, &info);
+  }
+  tsem_post(&pVnode->canCommit);
+  if (code) {
+    code = terrno ? terrno : TSDB_CODE_FAILED;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  code = tsdbCompact(pVnode->pTsdb, pInfo->commitID);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    vError("vgId:%d, %s failed at line %d since %s, commit id:%" PRId64, TD_VID(pVnode), __func__, lino,
+           tstrerror(code), pInfo->commitID);
+  } else {
+    vInfo("vgId:%d, compact end, commit id:%" PRId64, TD_VID(pVnode), pInfo->commitID);
+  }
+  taosMemoryFree(pInfo);
+  vnodeCompactEnd(pVnode);
+  return code;
+}
+
+/*
+ * Compaction runs in the background with its own commit ID, taken from the vnode state so the memory table being
+ * written and the ones after it commit with higher IDs. It runs on the compaction threads, so its throttling does
+ * not delay the commits of other vnodes.
+ */
+int32_t vnodeAsyncCompact(SVnode *pVnode) {
+  taosThreadMutexLock(&pVnode->mutex);
+  if (pVnode->compacting || pVnode->stopCompact) {
+    taosThreadMutexUnlock(&pVnode->mutex);
+    vInfo("vgId:%d, vnode is already compacting or closing", TD_VID(pVnode));
+    return 0;
+  }
+  pVnode->compacting = 1;
+  taosThreadMutexUnlock(&pVnode->mutex);
+
+  SCompactInfo *pInfo = (SCompactInfo *)taosMemoryCalloc(1, sizeof(*pInfo));
+  if (pInfo == NULL) {
+    vnodeCompactEnd(pVnode);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pInfo->pVnode = pVnode;
+  pInfo->commitID = pVnode->state.commitID++;
+  pVnode->compactCommitID = pInfo->commitID;
+
+  vInfo("vgId:%d, start to compact, commit id:%" PRId64, TD_VID(pVnode), pInfo->commitID);
+  if (vnodeScheduleCompactTask(vnodeCompactTask, pInfo) < 0) {
+    taosMemoryFree(pInfo);
+    vnodeCompactEnd(pVnode);
+    return terrno;
+  }
+  return 0;
+}
+
+/*
+ * Called on the write thread after a commit is scheduled: starts a compaction when a file set written since the
+ * last one looks fragmented, at most once every tsCompactInterval seconds.
+ */
+void vnodeCompactIfNeeded(SVnode *pVnode) {
+  if (tsCompactInterval <= 0) return;
+
+  int64_t now = taosGetTimestampSec();
+  if (now - pVnode->compactTs < tsCompactInterval) return;
+  if (!tsdbShouldCompact(pVnode->pTsdb, pVnode->compactCommitID)) return;
+
+  pVnode->compactTs = now;
+  int32_t code = vnodeAsyncCompact(pVnode);
+  if (code) {
+    vError("vgId:%d, failed to start the automatic compaction since %s", TD_VID(pVnode), tstrerror(code));
+  }
+}
+
 bool vnodeShouldRollback(SVnode *pVnode) {
   char tFName[TSDB_FILENAME_LEN] = {0};
   snprintf(tFName, TSDB_FILENAME_LEN, "%s%s%s%s%s", tfsGetPrimaryPath(pVnode->pTfs), TD_DIRSEP, pVnode->path, TD_DIRSEP,
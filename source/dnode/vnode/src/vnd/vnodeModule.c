@@ -23,16 +23,25 @@ struct SVnodeTask {
   void* arg;
 };
 
-struct SVnodeGlobal {
-  int8_t        init;
-  int8_t        stop;
+typedef struct {
+  const char*   name;
   int           nthreads;
   TdThread*     threads;
   TdThreadMutex mutex;
   TdThreadCond  hasTask;
   SVnodeTask    queue;
+} SVnodeTaskPool;
+
+struct SVnodeGlobal {
+  int8_t         init;
+  int8_t         stop;
+  SVnodeTaskPool commitPool;
+  // compaction is throttled and runs for long, so it has its own threads and never holds back a commit
+  SVnodeTaskPool compactPool;
 };
 
+#define VNODE_COMPACT_THREADS 1
+
 struct SVnodeGlobal vnodeGlobal;
 
 static void* loop(void* arg);
@@ -43,6 +52,73 @@ static void vnodeInitCommit() { tsem_init(&canCommit, 0, 4); };
 void        vnode_wait_commit() { tsem_wait(&canCommit); }
 void        vnode_done_commit() { tsem_wait(&canCommit); }
 
+static int vnodeOpenTaskPool(SVnodeTaskPool* pPool, const char* name, int nthreads) {
+  taosThreadMutexInit(&pPool->mutex, NULL);
+  taosThreadCondInit(&pPool->hasTask, NULL);
+
+  taosThreadMutexLock(&pPool->mutex);
+  pPool->name = name;
+  pPool->queue.next = &pPool->queue;
+  pPool->queue.prev = &pPool->queue;
+  taosThreadMutexUnlock(&pPool->mutex);
+
+  pPool->nthreads = nthreads;
+  pPool->threads = taosMemoryCalloc(nthreads, sizeof(TdThread));
+  if (pPool->threads == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  for (int i = 0; i < nthreads; i++) {
+    taosThreadCreate(&(pPool->threads[i]), NULL, loop, pPool);
+  }
+
+  return 0;
+}
+
+static void vnodeCloseTaskPool(SVnodeTaskPool* pPool) {
+  if (pPool->threads == NULL) return;
+
+  taosThreadMutexLock(&pPool->mutex);
+  taosThreadCondBroadcast(&pPool->hasTask);
+  taosThreadMutexUnlock(&pPool->mutex);
+
+  // wait for threads
+  for (int i = 0; i < pPool->nthreads; i++) {
+    taosThreadJoin(pPool->threads[i], NULL);
+  }
+
+  // clear source
+  taosMemoryFreeClear(pPool->threads);
+  taosThreadCondDestroy(&pPool->hasTask);
+  taosThreadMutexDestroy(&pPool->mutex);
+}
+
+static int vnodeScheduleTaskImpl(SVnodeTaskPool* pPool, int (*execute)(void*), void* arg) {
+  SVnodeTask* pTask;
+
+  ASSERT(!vnodeGlobal.stop);
+
+  pTask = taosMemoryMalloc(sizeof(*pTask));
+  if (pTask == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  pTask->execute = execute;
+  pTask->arg = arg;
+
+  taosThreadMutexLock(&pPool->mutex);
+  pTask->next = &pPool->queue;
+  pTask->prev = pPool->queue.prev;
+  pPool->queue.prev->next = pTask;
+  pPool->queue.prev = pTask;
+  taosThreadCondSignal(&pPool->hasTask);
+  taosThreadMutexUnlock(&pPool->mutex);
+
+  return 0;
+}
+
 int vnodeInit(int nthreads) {
   int8_t init;
   int    ret;
@@ -52,29 +128,14 @@ int vnodeInit(int nthreads) {
     return 0;
   }
 
-  taosThreadMutexInit(&vnodeGlobal.mutex, NULL);
-  taosThreadCondInit(&vnodeGlobal.hasTask, NULL);
-
-  taosThreadMutexLock(&vnodeGlobal.mutex);
-
   vnodeGlobal.stop = 0;
-  vnodeGlobal.queue.next = &vnodeGlobal.queue;
-  vnodeGlobal.queue.prev = &vnodeGlobal.queue;
-
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
 
-  vnodeGlobal.nthreads = nthreads;
-  vnodeGlobal.threads = taosMemoryCalloc(nthreads, sizeof(TdThread));
-  if (vnodeGlobal.threads == NULL) {
-    terrno = TSDB_CODE_OUT_OF_MEMORY;
+  if (vnodeOpenTaskPool(&vnodeGlobal.commitPool, "vnode-commit", nthreads) < 0 ||
+      vnodeOpenTaskPool(&vnodeGlobal.compactPool, "vnode-compact", VNODE_COMPACT_THREADS) < 0) {
     vError("failed to init vnode module since:%s", tstrerror(terrno));
     return -1;
   }
 
-  for (int i = 0; i < nthreads; i++) {
-    taosThreadCreate(&(vnodeGlobal.threads[i]), NULL, loop, NULL);
-  }
-
   if (walInit() < 0) {
     return -1;
   }
@@ -92,20 +153,9 @@ void vnodeCleanup() {
   if (init == 0) return;
 
   // set stop
-  taosThreadMutexLock(&(vnodeGlobal.mutex));
   vnodeGlobal.stop = 1;
-  taosThreadCondBroadcast(&(vnodeGlobal.hasTask));
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
-
-  // wait for threads
-  for (int i = 0; i < vnodeGlobal.nthreads; i++) {
-    taosThreadJoin(vnodeGlobal.threads[i], NULL);
-  }
-
-  // clear source
-  taosMemoryFreeClear(vnodeGlobal.threads);
-  taosThreadCondDestroy(&(vnodeGlobal.hasTask));
-  taosThreadMutexDestroy(&(vnodeGlobal.mutex));
+  vnodeCloseTaskPool(&vnodeGlobal.commitPool);
+  vnodeCloseTaskPool(&vnodeGlobal.compactPool);
 
   walCleanUp();
   tqCleanUp();
@@ -113,48 +163,32 @@ void vnodeCleanup() {
 }
 
 int vnodeScheduleTask(int (*execute)(void*), void* arg) {
-  SVnodeTask* pTask;
-
-  ASSERT(!vnodeGlobal.stop);
-
-  pTask = taosMemoryMalloc(sizeof(*pTask));
-  if (pTask == NULL) {
-    terrno = TSDB_CODE_OUT_OF_MEMORY;
-    return -1;
-  }
-
-  pTask->execute = execute;
-  pTask->arg = arg;
-
-  taosThreadMutexLock(&(vnodeGlobal.mutex));
-  pTask->next = &vnodeGlobal.queue;
-  pTask->prev = vnodeGlobal.queue.prev;
-  vnodeGlobal.queue.prev->next = pTask;
-  vnodeGlobal.queue.prev = pTask;
-  taosThreadCondSignal(&(vnodeGlobal.hasTask));
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+  return vnodeScheduleTaskImpl(&vnodeGlobal.commitPool, execute, arg);
+}
 
-  return 0;
+int vnodeScheduleCompactTask(int (*execute)(void*), void* arg) {
+  return vnodeScheduleTaskImpl(&vnodeGlobal.compactPool, execute, arg);
 }
 
 /* ------------------------ STATIC METHODS ------------------------ */
 static void* loop(void* arg) {
-  SVnodeTask* pTask;
-  int         ret;
+  SVnodeTaskPool* pPool = (SVnodeTaskPool*)arg;
+  SVnodeTask*     pTask;
+  int             ret;
 
-  setThreadName("vnode-commit");
+  setThreadName(pPool->name);
 
   for (;;) {
-    taosThreadMutexLock(&(vnodeGlobal.mutex));
+    taosThreadMutexLock(&pPool->mutex);
     for (;;) {
-      pTask = vnodeGlobal.queue.next;
-      if (pTask == &vnodeGlobal.queue) {
+      pTask = pPool->queue.next;
+      if (pTask == &pPool->queue) {
         // no task
         if (vnodeGlobal.stop) {
-          taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+          taosThreadMutexUnlock(&pPool->mutex);
           return NULL;
         } else {
-          taosThreadCondWait(&(vnodeGlobal.hasTask), &(vnodeGlobal.mutex));
+          taosThreadCondWait(&pPool->hasTask, &pPool->mutex);
         }
       } else {
         // has task
@@ -164,7 +198,7 @@ static void* loop(void* arg) {
       }
     }
 
-    taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+    taosThreadMutexUnlock(&pPool->mutex);
 
     pTask->execute(pTask->arg);
     taosMemoryFree(pTask);
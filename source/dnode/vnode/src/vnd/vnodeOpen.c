@@ -156,6 +156,8 @@ SVnode *vnodeOpen(const char *path, STfs *pTfs, SMsgCb msgCb) {
   tsem_init(&(pVnode->canCommit), 0, 1);
   taosThreadMutexInit(&pVnode->mutex, NULL);
   taosThreadCondInit(&pVnode->poolNotEmpty, NULL);
+  taosThreadCondInit(&pVnode->compactDone, NULL);
+  taosThreadCondInit(&pVnode->statsDone, NULL);
 
   int8_t rollback = vnodeShouldRollback(pVnode);
 
@@ -249,6 +251,16 @@ void vnodePreClose(SVnode *pVnode) {
 
 void vnodeClose(SVnode *pVnode) {
   if (pVnode) {
+    // the compaction stops at the next block or file set, and no more stats collection is started
+    taosThreadMutexLock(&pVnode->mutex);
+    atomic_store_8(&pVnode->stopCompact, 1);
+    while (pVnode->compacting) {
+      taosThreadCondWait(&pVnode->compactDone, &pVnode->mutex);
+    }
+    while (pVnode->statsLoading) {
+      taosThreadCondWait(&pVnode->statsDone, &pVnode->mutex);
+    }
+    taosThreadMutexUnlock(&pVnode->mutex);
     vnodeSyncCommit(pVnode);
     vnodeSyncClose(pVnode);
     vnodeQueryClose(pVnode);
@@ -262,6 +274,9 @@ void vnodeClose(SVnode *pVnode) {
     tsem_destroy(&(pVnode->canCommit));
     tsem_destroy(&pVnode->syncSem);
     taosThreadCondDestroy(&pVnode->poolNotEmpty);
+    taosThreadCondDestroy(&pVnode->compactDone);
+    taosThreadCondDestroy(&pVnode->statsDone);
+    taosArrayDestroyEx(pVnode->aStbStatsLoad, tFreeSStbStatsLoad);
     taosThreadMutexDestroy(&pVnode->mutex);
     taosThreadMutexDestroy(&pVnode->lock);
     taosMemoryFree(pVnode);
@@ -395,6 +395,135 @@ int32_t vnodeGetLoad(SVnode *pVnode, SVnodeLoad *pLoad) {
   return 0;
 }
 
+static int32_t vnodeCollectStbStatsLoad(SVnode *pVnode, SArray *pLoads) {
+  int32_t code = 0;
+  SArray *suidList = NULL;
+  SArray *aStbStats = NULL;
+
+  suidList = taosArrayInit(1, sizeof(tb_uid_t));
+  aStbStats = taosArrayInit(1, sizeof(STsdbStbStats));
+  if (suidList == NULL || aStbStats == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  if (vnodeGetStbIdList(pVnode, 0, suidList) < 0) {
+    code = terrno;
+    goto _exit;
+  }
+
+  code = tsdbGetStbStats(pVnode->pTsdb, aStbStats);
+  if (code) goto _exit;
+
+  for (int32_t i = 0; i < taosArrayGetSize(suidList); ++i) {
+    tb_uid_t      suid = *(tb_uid_t *)taosArrayGet(suidList, i);
+    SStbStatsLoad load = {.vgId = TD_VID(pVnode), .suid = suid, .skey = TSKEY_MAX, .ekey = TSKEY_MIN};
+
+    SMetaStbStats ctbStats = {0};
+    metaGetStbStats(pVnode->pMeta, suid, &ctbStats);
+    load.numOfTables = ctbStats.ctbNum;
+
+    STsdbStbStats  key = {.suid = suid};
+    STsdbStbStats *pStbStats = taosArraySearch(aStbStats, &key, tsdbStbStatsCmprFn, TD_EQ);
+    if (pStbStats) {
+      load.numOfRows = pStbStats->nRow;
+      load.skey = pStbStats->minKey;
+      load.ekey = pStbStats->maxKey;
+    }
+
+    load.pTagSketches = taosArrayInit(4, sizeof(STagSketch));
+    if (load.pTagSketches == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      goto _exit;
+    }
+
+    code = metaGetTagSketches(pVnode->pMeta, suid, load.pTagSketches);
+    if (code == 0 && taosArrayPush(pLoads, &load) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+    if (code) {
+      taosArrayDestroy(load.pTagSketches);
+      goto _exit;
+    }
+  }
+
+_exit:
+  if (code) {
+    qError("vgId:%d, failed to get stb stats since %s", TD_VID(pVnode), tstrerror(code));
+  }
+  taosArrayDestroy(aStbStats);
+  taosArrayDestroy(suidList);
+  return code;
+}
+
+// wake up vnodeClose() waiting for the collection, and keep the stats collected if any
+static void vnodeStbStatsLoadEnd(SVnode *pVnode, SArray *pLoads) {
+  taosThreadMutexLock(&pVnode->mutex);
+  if (pLoads) {
+    TSWAP(pVnode->aStbStatsLoad, pLoads);
+  }
+  pVnode->statsLoading = 0;
+  taosThreadCondSignal(&pVnode->statsDone);
+  taosThreadMutexUnlock(&pVnode->mutex);
+
+  taosArrayDestroyEx(pLoads, tFreeSStbStatsLoad);
+}
+
+static int32_t vnodeStbStatsLoadTask(void *arg) {
+  SVnode *pVnode = (SVnode *)arg;
+  int32_t code = 0;
+  SArray *pLoads = taosArrayInit(4, sizeof(SStbStatsLoad));
+
+  if (pLoads == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+  } else {
+    code = vnodeCollectStbStatsLoad(pVnode, pLoads);
+  }
+  if (code) {
+    taosArrayDestroyEx(pLoads, tFreeSStbStatsLoad);
+    pLoads = NULL;
+  }
+
+  vnodeStbStatsLoadEnd(pVnode, pLoads);
+  return code;
+}
+
+/*
+ * Called on the status thread of the dnode, so the stats are not collected here: the ones of the last collection are
+ * copied, and the next collection is started in the background. Nothing is reported until the first one is done.
+ */
+int32_t vnodeGetStbStatsLoad(SVnode *pVnode, SArray *pLoads) {
+  int32_t code = 0;
+  bool    toCollect = false;
+
+  // the replicas hold the same data, only the leader reports
+  if (syncGetState(pVnode->sync).state != TAOS_SYNC_STATE_LEADER) {
+    return 0;
+  }
+
+  taosThreadMutexLock(&pVnode->mutex);
+  for (int32_t i = 0; i < taosArrayGetSize(pVnode->aStbStatsLoad); ++i) {
+    SStbStatsLoad *pLoad = (SStbStatsLoad *)taosArrayGet(pVnode->aStbStatsLoad, i);
+    SStbStatsLoad  load = *pLoad;
+    load.pTagSketches = pLoad->pTagSketches ? taosArrayDup(pLoad->pTagSketches, NULL) : NULL;
+    if ((pLoad->pTagSketches && load.pTagSketches == NULL) || taosArrayPush(pLoads, &load) == NULL) {
+      taosArrayDestroy(load.pTagSketches);
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      break;
+    }
+  }
+  if (!pVnode->statsLoading && !pVnode->stopCompact) {
+    pVnode->statsLoading = 1;
+    toCollect = true;
+  }
+  taosThreadMutexUnlock(&pVnode->mutex);
+
+  if (toCollect && vnodeScheduleTask(vnodeStbStatsLoadTask, pVnode) < 0) {
+    vnodeStbStatsLoadEnd(pVnode, NULL);
+  }
+  return code;
+}
+
 /**
  * @brief Reset the statistics value by monitor interval
  *
@@ -473,6 +602,15 @@ int32_t vnodeGetStbIdList(SVnode *pVnode, int64_t suid, SArray *list) {
   return TSDB_CODE_SUCCESS;
 }
 
+int32_t vnodeGetStbBlockDistInfo(SVnode *pVnode, int64_t suid, STableBlockDistInfo *pInfo) {
+  SMetaStbStats ctbStats = {0};
+  int32_t       code = metaGetStbStats(pVnode->pMeta, suid, &ctbStats);
+  if (code) return code;
+
+  pInfo->numOfTables = ctbStats.ctbNum;
+  return tsdbGetStbBlockDistInfo(pVnode->pTsdb, suid, pInfo);
+}
+
 int32_t vnodeGetCtbNum(SVnode *pVnode, int64_t suid, int64_t *num) {
   SMCtbCursor *pCur = metaOpenCtbCursor(pVnode->pMeta, suid, 0);
   if (!pCur) {
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tsdbTestUtil.h"
+
+#include "executorimpl.h"
+#include "systable.h"
+
+namespace {
+
+// the output columns of the scans, which are in both ins_tables and ins_tags
+const char *kCols[] = {"table_name", "db_name", "stable_name"};
+const int32_t kNumOfCols = sizeof(kCols) / sizeof(kCols[0]);
+const int16_t kDataBlockId = 1;
+
+typedef std::vector<std::string> STableNames;
+
+const SSysTableMeta *getSysTableMeta(const char *tbName) {
+  size_t               size = 0;
+  const SSysTableMeta *pMeta = NULL;
+  getInfosDbMeta(&pMeta, &size);
+  for (size_t i = 0; i < size; ++i) {
+    if (strcmp(pMeta[i].name, tbName) == 0) return &pMeta[i];
+  }
+  return NULL;
+}
+
+SColumnNode *createColumn(const SSysTableMeta *pMeta, int32_t slotId) {
+  SColumnNode *pCol = (SColumnNode *)nodesMakeNode(QUERY_NODE_COLUMN);
+  for (int32_t i = 0; i < pMeta->colNum; ++i) {
+    if (strcmp(pMeta->schema[i].name, kCols[slotId]) == 0) {
+      pCol->colId = i + 1;
+      pCol->node.resType.type = pMeta->schema[i].type;
+      pCol->node.resType.bytes = pMeta->schema[i].bytes;
+    }
+  }
+  pCol->colType = COLUMN_TYPE_COLUMN;
+  pCol->dataBlockId = kDataBlockId;
+  pCol->slotId = slotId;
+  strcpy(pCol->colName, kCols[slotId]);
+  return pCol;
+}
+
+SNode *createEqual(const SSysTableMeta *pMeta, int32_t slotId, const std::string &value) {
+  SValueNode *pVal = (SValueNode *)nodesMakeNode(QUERY_NODE_VALUE);
+  pVal->node.resType.type = TSDB_DATA_TYPE_VARCHAR;
+  pVal->node.resType.bytes = value.size() + VARSTR_HEADER_SIZE;
+  pVal->literal = strdup(value.c_str());
+  pVal->datum.p = (char *)taosMemoryCalloc(1, value.size() + VARSTR_HEADER_SIZE + 1);
+  STR_TO_VARSTR(pVal->datum.p, value.c_str());
+  pVal->translate = true;
+
+  SOperatorNode *pOp = (SOperatorNode *)nodesMakeNode(QUERY_NODE_OPERATOR);
+  pOp->opType = OP_TYPE_EQUAL;
+  pOp->node.resType.type = TSDB_DATA_TYPE_BOOL;
+  pOp->node.resType.bytes = sizeof(bool);
+  pOp->pLeft = (SNode *)createColumn(pMeta, slotId);
+  pOp->pRight = (SNode *)pVal;
+  return (SNode *)pOp;
+}
+
+SNode *createAnd(SNode *pLeft, SNode *pRight) {
+  SLogicConditionNode *pCond = (SLogicConditionNode *)nodesMakeNode(QUERY_NODE_LOGIC_CONDITION);
+  pCond->condType = LOGIC_COND_TYPE_AND;
+  pCond->node.resType.type = TSDB_DATA_TYPE_BOOL;
+  pCond->node.resType.bytes = sizeof(bool);
+  nodesListMakeStrictAppend(&pCond->pParameterList, pLeft);
+  nodesListStrictAppend(pCond->pParameterList, pRight);
+  return (SNode *)pCond;
+}
+
+// the system table scan physical node with the columns of kCols as the output
+SSystemTableScanPhysiNode *createScanNode(const SSysTableMeta *pMeta, SNode *pCond, int64_t limit, int64_t offset) {
+  SSystemTableScanPhysiNode *pNode =
+      (SSystemTableScanPhysiNode *)nodesMakeNode(QUERY_NODE_PHYSICAL_PLAN_SYSTABLE_SCAN);
+  SDataBlockDescNode *pDesc = (SDataBlockDescNode *)nodesMakeNode(QUERY_NODE_DATABLOCK_DESC);
+  pDesc->dataBlockId = kDataBlockId;
+  for (int32_t i = 0; i < kNumOfCols; ++i) {
+    SColumnNode  *pCol = createColumn(pMeta, i);
+    SSlotDescNode *pSlot = (SSlotDescNode *)nodesMakeNode(QUERY_NODE_SLOT_DESC);
+    pSlot->slotId = i;
+    pSlot->dataType = pCol->node.resType;
+    pSlot->output = true;
+    nodesListMakeStrictAppend(&pDesc->pSlots, (SNode *)pSlot);
+    pDesc->totalRowSize += pCol->node.resType.bytes;
+    pDesc->outputRowSize += pCol->node.resType.bytes;
+
+    STargetNode *pTarget = (STargetNode *)nodesMakeNode(QUERY_NODE_TARGET);
+    pTarget->dataBlockId = kDataBlockId;
+    pTarget->slotId = i;
+    pTarget->pExpr = (SNode *)pCol;
+    nodesListMakeStrictAppend(&pNode->scan.pScanCols, (SNode *)pTarget);
+  }
+  pNode->scan.node.pOutputDataBlockDesc = pDesc;
+  pNode->scan.node.pConditions = pCond;
+  if (limit >= 0) {
+    SLimitNode *pLimit = (SLimitNode *)nodesMakeNode(QUERY_NODE_LIMIT);
+    pLimit->limit = limit;
+    pLimit->offset = offset;
+    pNode->scan.node.pLimit = (SNode *)pLimit;
+  }
+  tNameFromString(&pNode->scan.tableName, TSDB_INFORMATION_SCHEMA_DB, T_NAME_DB);
+  tstrncpy(pNode->scan.tableName.tname, pMeta->name, sizeof(pNode->scan.tableName.tname));
+  pNode->scan.tableName.type = TSDB_TABLE_NAME_T;
+  pNode->accountId = 1;
+  pNode->sysInfo = true;
+  return pNode;
+}
+
+std::string getString(SSDataBlock *pBlock, int32_t slotId, int32_t row) {
+  SColumnInfoData *pCol = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, slotId);
+  char            *p = colDataGetData(pCol, row);
+  return std::string(varDataVal(p), varDataLen(p));
+}
+
+}  // namespace
+
+class SysTableScanTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    env.open("sysTableScanTest");
+    tstrncpy(env.pVnode->config.dbname, "1.sysdb", sizeof(env.pVnode->config.dbname));
+  }
+
+  void TearDown() override { env.close(); }
+
+  // the table names of the rows of ins_tables or ins_tags of this vnode, in the order of the scan
+  STableNames scan(const char *tbName, SNode *pCond = NULL, int64_t limit = -1, int64_t offset = 0,
+                   int32_t *pNumOfBlocks = NULL) {
+    STableNames                names;
+    const SSysTableMeta       *pMeta = getSysTableMeta(tbName);
+    SSystemTableScanPhysiNode *pNode = createScanNode(pMeta, pCond, limit, offset);
+    SReadHandle                handle = {.meta = env.pVnode->pMeta, .vnode = env.pVnode};
+    SExecTaskInfo              taskInfo = {0};
+    taskInfo.id.str = "sysTableScanTest";
+
+    SOperatorInfo *pOperator = createSysTableScanOperatorInfo(&handle, pNode, "root", &taskInfo);
+    EXPECT_NE(pOperator, nullptr);
+    if (pOperator == NULL) {
+      nodesDestroyNode((SNode *)pNode);
+      return names;
+    }
+
+    int32_t numOfBlocks = 0;
+    for (SSDataBlock *pBlock = pOperator->fpSet.getNextFn(pOperator); pBlock != NULL;
+         pBlock = pOperator->fpSet.getNextFn(pOperator)) {
+      EXPECT_GT(pBlock->info.rows, 0);
+      EXPECT_LE(pBlock->info.rows, pOperator->resultInfo.capacity);
+      for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+        EXPECT_EQ(getString(pBlock, 1, i), "sysdb");
+        names.push_back(getString(pBlock, 0, i));
+      }
+      numOfBlocks++;
+    }
+    if (pNumOfBlocks != NULL) *pNumOfBlocks = numOfBlocks;
+
+    destroyOperatorInfo(pOperator);
+    nodesDestroyNode((SNode *)pNode);
+    return names;
+  }
+
+  SNode *equal(const char *tbName, int32_t slotId, const std::string &value) {
+    return createEqual(getSysTableMeta(tbName), slotId, value);
+  }
+
+  std::string tableName(int64_t uid) { return "t" + std::to_string(uid); }
+  std::string stableName(int64_t suid) { return "st" + std::to_string(suid); }
+
+  TsdbTestEnv env;
+};
+
+TEST_F(SysTableScanTest, resolvedByIndex) {
+  int64_t     suid1 = env.createSuperTable();
+  int64_t     suid2 = env.createSuperTable();
+  STableNames ctbs1, ctbs2;
+  for (int32_t i = 0; i < 5; ++i) ctbs1.push_back(tableName(env.createTable(suid1)));
+  for (int32_t i = 0; i < 3; ++i) ctbs2.push_back(tableName(env.createTable(suid2)));
+  std::string ntb = tableName(env.createTable());
+  std::set<std::string> expect1(ctbs1.begin(), ctbs1.end());
+
+  for (const char *tbName : {TSDB_INS_TABLE_TABLES, TSDB_INS_TABLE_TAGS}) {
+    SCOPED_TRACE(tbName);
+
+    // by the name index
+    EXPECT_EQ(scan(tbName, equal(tbName, 0, ctbs1[2])), STableNames{ctbs1[2]});
+    EXPECT_EQ(scan(tbName, equal(tbName, 0, "nonexistent")), STableNames{});
+
+    // by the name index of the super table and its ctb index
+    STableNames names = scan(tbName, equal(tbName, 2, stableName(suid1)));
+    EXPECT_EQ(std::set<std::string>(names.begin(), names.end()), expect1);
+    EXPECT_EQ(names.size(), expect1.size());
+    EXPECT_EQ(scan(tbName, equal(tbName, 2, "nonexistent")), STableNames{});
+
+    // the conjuncts are intersected
+    EXPECT_EQ(scan(tbName, createAnd(equal(tbName, 0, ctbs1[1]), equal(tbName, 2, stableName(suid1)))),
+              STableNames{ctbs1[1]});
+    EXPECT_EQ(scan(tbName, createAnd(equal(tbName, 0, ctbs1[1]), equal(tbName, 2, stableName(suid2)))),
+              STableNames{});
+
+    // the db of the vnode
+    names = scan(tbName, createAnd(equal(tbName, 1, "sysdb"), equal(tbName, 2, stableName(suid1))));
+    EXPECT_EQ(names.size(), expect1.size());
+    EXPECT_EQ(scan(tbName, createAnd(equal(tbName, 1, "otherdb"), equal(tbName, 2, stableName(suid1)))),
+              STableNames{});
+  }
+
+  // a normal table has no tags
+  EXPECT_EQ(scan(TSDB_INS_TABLE_TABLES, equal(TSDB_INS_TABLE_TABLES, 0, ntb)), STableNames{ntb});
+  EXPECT_EQ(scan(TSDB_INS_TABLE_TAGS, equal(TSDB_INS_TABLE_TAGS, 0, ntb)), STableNames{});
+  EXPECT_EQ(scan(TSDB_INS_TABLE_TABLES).size(), ctbs1.size() + ctbs2.size() + 1);
+  EXPECT_EQ(scan(TSDB_INS_TABLE_TAGS).size(), ctbs1.size() + ctbs2.size());
+}
+
+TEST_F(SysTableScanTest, limitAcrossBlocks) {
+  // more rows than a result block holds
+  const int32_t numOfTables = 4500;
+  int64_t       suid = env.createSuperTable();
+  for (int32_t i = 0; i < numOfTables; ++i) env.createTable(suid);
+
+  for (const char *tbName : {TSDB_INS_TABLE_TABLES, TSDB_INS_TABLE_TAGS}) {
+    SCOPED_TRACE(tbName);
+
+    int32_t     numOfBlocks = 0;
+    STableNames all = scan(tbName, equal(tbName, 2, stableName(suid)), -1, 0, &numOfBlocks);
+    ASSERT_EQ(all.size(), numOfTables);
+    EXPECT_GT(numOfBlocks, 1);
+    EXPECT_EQ(std::set<std::string>(all.begin(), all.end()).size(), numOfTables);
+    EXPECT_EQ(scan(tbName).size(), numOfTables);
+
+    // the offset and the limit over the rows of the index resolved scan, within a block and across the blocks
+    for (int64_t offset : {0, 10, 3960, 4090, 4495, 4600}) {
+      SCOPED_TRACE(offset);
+      STableNames names = scan(tbName, equal(tbName, 2, stableName(suid)), 20, offset, &numOfBlocks);
+      STableNames expect(all.begin() + std::min<int64_t>(offset, all.size()),
+                         all.begin() + std::min<int64_t>(offset + 20, all.size()));
+      EXPECT_EQ(names, expect);
+    }
+
+    // the limit without the index, which stops the meta scan
+    STableNames unresolved = scan(tbName);
+    STableNames names = scan(tbName, NULL, 5, 100, &numOfBlocks);
+    EXPECT_EQ(names, STableNames(unresolved.begin() + 100, unresolved.begin() + 105));
+    EXPECT_EQ(numOfBlocks, 1);
+  }
+}
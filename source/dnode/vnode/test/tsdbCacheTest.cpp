@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbTestUtil.h"
+
+#include "tdatablock.h"
+
+namespace {
+
+const int64_t kSecond = 1000;
+
+typedef std::map<int64_t, std::pair<TSKEY, int64_t>> SLastRows;  // uid -> (ts, value)
+
+}  // namespace
+
+class TsdbCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    cacheLastLoad = tsCacheLastLoad;
+    tsCacheLastLoad = 1;
+    env.open("tsdbCacheTest", 4, 3);
+  }
+
+  void TearDown() override {
+    env.close();
+    tsCacheLastLoad = cacheLastLoad;
+  }
+
+  void insert(int64_t uid, int64_t from, int64_t to, int64_t base) {
+    TsdbTestEnv::SRows rows;
+    for (int64_t i = from; i < to; i++) rows[env.baseTs + i * kSecond] = base + i;
+    env.insert(uid, rows);
+    for (auto &row : rows) data[uid][row.first] = row.second;
+  }
+
+  void deleteRange(int64_t uid, int64_t from, int64_t to) {
+    env.deleteRange(uid, env.baseTs + from * kSecond, env.baseTs + to * kSecond);
+    auto &rows = data[uid];
+    rows.erase(rows.lower_bound(env.baseTs + from * kSecond), rows.upper_bound(env.baseTs + to * kSecond));
+  }
+
+  // no column is null, so the last and the last_row of a table are the same row
+  SLastRows expected(const std::vector<int64_t> &uids) {
+    SLastRows lastRows;
+    for (int64_t uid : uids) {
+      auto &rows = data[uid];
+      if (!rows.empty()) lastRows[uid] = *rows.rbegin();
+    }
+    return lastRows;
+  }
+
+  // the last_row or the last of each table, as a cache scan of the tables gets them
+  SLastRows readCache(int32_t type, int64_t suid, const std::vector<int64_t> &uids) {
+    SLastRows                  lastRows;
+    std::vector<STableKeyInfo> keys;
+    for (int64_t uid : uids) keys.push_back({.uid = (uint64_t)uid, .groupId = 0});
+
+    void *pReader = NULL;
+    EXPECT_EQ(tsdbCacherowsReaderOpen(env.pVnode, CACHESCAN_RETRIEVE_TYPE_ALL | type, keys.data(), keys.size(),
+                                      TsdbTestEnv::kNumOfCols, suid, &pReader),
+              0);
+    if (pReader == NULL) return lastRows;
+
+    bool         last = (type == CACHESCAN_RETRIEVE_LAST);
+    int32_t      bytes = last ? sizeof(SFirstLastRes) + sizeof(int64_t) + VARSTR_HEADER_SIZE : sizeof(int64_t);
+    SSDataBlock *pBlock = createDataBlock();
+    for (int16_t iCol = 0; iCol < TsdbTestEnv::kNumOfCols; iCol++) {
+      SColumnInfoData colInfo = createColumnInfoData(
+          last ? TSDB_DATA_TYPE_BINARY : (iCol == 0 ? TSDB_DATA_TYPE_TIMESTAMP : TSDB_DATA_TYPE_BIGINT), bytes,
+          iCol + 1);
+      blockDataAppendColInfo(pBlock, &colInfo);
+    }
+    blockDataEnsureCapacity(pBlock, 4);  // several retrievals for the tables
+
+    int32_t slotIds[TsdbTestEnv::kNumOfCols] = {-1, 1};
+    SArray *pUids = taosArrayInit(4, sizeof(uint64_t));
+    while (true) {
+      blockDataCleanup(pBlock);
+      taosArrayClear(pUids);
+      EXPECT_EQ(tsdbRetrieveCacheRows(pReader, pBlock, slotIds, pUids), 0);
+      if (pBlock->info.rows == 0) break;
+
+      EXPECT_EQ(taosArrayGetSize(pUids), pBlock->info.rows);
+      SColumnInfoData *pTs = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 0);
+      SColumnInfoData *pVal = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 1);
+      for (int32_t i = 0; i < pBlock->info.rows; i++) {
+        int64_t uid = *(int64_t *)taosArrayGet(pUids, i);
+        EXPECT_EQ(lastRows.count(uid), 0) << "duplicate uid:" << uid;
+        if (last) {
+          SFirstLastRes *pTsRes = (SFirstLastRes *)varDataVal(colDataGetData(pTs, i));
+          SFirstLastRes *pValRes = (SFirstLastRes *)varDataVal(colDataGetData(pVal, i));
+          EXPECT_FALSE(pValRes->isNull);
+          EXPECT_EQ(pValRes->ts, *(TSKEY *)pTsRes->buf);
+          lastRows[uid] = std::make_pair(*(TSKEY *)pTsRes->buf, *(int64_t *)pValRes->buf);
+        } else {
+          EXPECT_FALSE(colDataIsNull_s(pVal, i));
+          lastRows[uid] = std::make_pair(*(TSKEY *)colDataGetData(pTs, i), *(int64_t *)colDataGetData(pVal, i));
+        }
+      }
+    }
+
+    taosArrayDestroy(pUids);
+    blockDataDestroy(pBlock);
+    tsdbCacherowsReaderClose(pReader);
+    return lastRows;
+  }
+
+  void checkCache(int64_t suid, const std::vector<int64_t> &uids) {
+    SLastRows expect = expected(uids);
+    EXPECT_EQ(readCache(CACHESCAN_RETRIEVE_LAST_ROW, suid, uids), expect);
+    EXPECT_EQ(readCache(CACHESCAN_RETRIEVE_LAST, suid, uids), expect);
+  }
+
+  bool cacheFileExists() {
+    char fname[TSDB_FILENAME_LEN];
+    snprintf(fname, sizeof(fname), "%s%s%s%sLASTCACHE", tfsGetPrimaryPath(env.pTfs), TD_DIRSEP,
+             env.pVnode->pTsdb->path, TD_DIRSEP);
+    return taosCheckExistFile(fname);
+  }
+
+  int64_t cacheFileSize() {
+    char    fname[TSDB_FILENAME_LEN];
+    int64_t size = 0;
+    snprintf(fname, sizeof(fname), "%s%s%s%sLASTCACHE", tfsGetPrimaryPath(env.pTfs), TD_DIRSEP,
+             env.pVnode->pTsdb->path, TD_DIRSEP);
+    EXPECT_EQ(taosStatFile(fname, &size, NULL), 0);
+    return size;
+  }
+
+  bool inLruCache(uint64_t key) {
+    LRUHandle *h = taosLRUCacheLookup(env.pVnode->pTsdb->lruCache, &key, sizeof(key));
+    if (h == NULL) return false;
+    taosLRUCacheRelease(env.pVnode->pTsdb->lruCache, h, false);
+    return true;
+  }
+
+  TsdbTestEnv                           env;
+  std::map<int64_t, TsdbTestEnv::SRows> data;  // uid -> rows written and not deleted
+  int32_t                               cacheLastLoad = 0;
+};
+
+TEST_F(TsdbCacheTest, persistAndLoad) {
+  std::vector<int64_t> uids;
+  for (int32_t i = 0; i < 3; i++) uids.push_back(env.createTable());
+
+  for (int64_t uid : uids) insert(uid, 0, 100, uid * 1000);
+  checkCache(0, uids);
+
+  // the entries are written into the last cache file on commit, and loaded on demand after a restart
+  env.commit();
+  EXPECT_TRUE(cacheFileExists());
+  env.reopen();
+  EXPECT_EQ(taosLRUCacheGetUsage(env.pVnode->pTsdb->lruCache), 0);
+  checkCache(0, uids);
+
+  // or loaded all when the vnode is opened
+  tsCacheLastLoad = 2;
+  env.reopen();
+  EXPECT_GT(taosLRUCacheGetUsage(env.pVnode->pTsdb->lruCache), 0);
+  checkCache(0, uids);
+
+  // not persisted at all
+  tsCacheLastLoad = 0;
+  env.reopen();
+  EXPECT_FALSE(cacheFileExists());
+  EXPECT_EQ(taosLRUCacheGetUsage(env.pVnode->pTsdb->lruCache), 0);
+  checkCache(0, uids);
+}
+
+TEST_F(TsdbCacheTest, invalidateOnWrite) {
+  std::vector<int64_t> uids;
+  for (int32_t i = 0; i < 6; i++) uids.push_back(env.createTable());
+
+  for (int64_t uid : uids) insert(uid, 0, 100, uid * 1000);
+  checkCache(0, uids);
+  env.commit();
+  env.reopen();
+
+  // the entries are in the file only, and the tables are written without loading them
+  deleteRange(uids[0], 90, 99);  // the last rows deleted
+  insert(uids[1], 100, 110, 0);  // newer rows
+  insert(uids[2], 50, 60, -1000);  // older rows only, the last row stays
+  deleteRange(uids[3], 95, 99);  // deleted, and not scanned before the commit
+  insert(uids[4], 100, 101, 0);  // written twice in the same memory table
+  insert(uids[4], 101, 102, 0);
+  checkCache(0, {uids[0], uids[1], uids[2], uids[4], uids[5]});
+
+  // the entry of the table deleted from is not carried into the new file
+  env.commit();
+  checkCache(0, uids);
+  env.reopen();
+  checkCache(0, uids);
+
+  // and it is the same once more while the entries are in the lru cache
+  deleteRange(uids[5], 99, 99);
+  insert(uids[0], 200, 201, 7);
+  checkCache(0, uids);
+  env.reopen();
+  checkCache(0, uids);
+}
+
+TEST_F(TsdbCacheTest, columnarCache) {
+  int64_t              suid = env.createSuperTable();
+  std::vector<int64_t> uids;
+  for (int32_t i = 0; i < 20; i++) uids.push_back(env.createTable(suid));
+
+  for (int64_t uid : uids) insert(uid, 0, 50, uid * 1000);
+
+  // the rows of the child tables are filled into the columnar table of the super table by the first scan
+  checkCache(suid, uids);
+  EXPECT_EQ(env.pVnode->pTsdb->pColCache->nRow, (int32_t)uids.size() * 2);
+  checkCache(suid, uids);
+
+  // updated in place with the lru entries, or invalidated and filled again
+  insert(uids[0], 50, 60, 0);
+  deleteRange(uids[1], 40, 49);
+  deleteRange(uids[2], 0, 49);
+  checkCache(suid, uids);
+
+  env.commit();
+  env.reopen();
+  EXPECT_EQ(env.pVnode->pTsdb->pColCache->nRow, 0);
+  insert(uids[3], 60, 61, 0);
+  deleteRange(uids[4], 49, 49);
+  checkCache(suid, uids);
+  EXPECT_GT(env.pVnode->pTsdb->pColCache->nRow, 0);
+  checkCache(suid, uids);
+}
+
+TEST_F(TsdbCacheTest, incrementalCheckpoint) {
+  std::vector<int64_t> uids;
+  for (int32_t i = 0; i < 50; i++) uids.push_back(env.createTable());
+
+  for (int64_t uid : uids) insert(uid, 0, 100, uid * 1000);
+  checkCache(0, uids);
+  env.commit();
+  int64_t size = cacheFileSize();
+  ASSERT_GT(size, 0);
+
+  // a commit writing one table only appends the entries of the table
+  insert(uids[0], 100, 110, 0);
+  checkCache(0, uids);
+  env.commit();
+  EXPECT_GT(cacheFileSize(), size);
+  EXPECT_LT(cacheFileSize() - size, size / 10);
+  env.reopen();
+  checkCache(0, uids);
+
+  // the entries a query builds from the data files are appended by the next commit, even without writes
+  int64_t uid = env.createTable();
+  uids.push_back(uid);
+  insert(uid, 0, 10, 0);
+  env.commit();
+  size = cacheFileSize();
+  checkCache(0, {uid});
+  env.commit();
+  EXPECT_GT(cacheFileSize(), size);
+
+  tsCacheLastLoad = 2;
+  env.reopen();
+  EXPECT_TRUE(inLruCache((uint64_t)uid));
+  EXPECT_TRUE(inLruCache((uint64_t)uid | 0x8000000000000000));
+  checkCache(0, uids);
+
+  // the file is written again with the live entries only once most of it is garbage
+  size = cacheFileSize();
+  for (int32_t i = 0; i < 6; i++) {
+    for (int64_t uid : uids) insert(uid, 200 + i, 201 + i, i);
+    checkCache(0, uids);
+    env.commit();
+    EXPECT_LT(cacheFileSize(), size * 3);
+  }
+  env.reopen();
+  checkCache(0, uids);
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <random>
+#include <thread>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int64_t kSecond = 1000;
+
+struct SFSetLayout {
+  int32_t nSttF = 0;
+  int64_t nRow = 0;  // rows in the data blocks of the .data file
+  int32_t nDataBlk = 0;
+  int32_t nSttBlk = 0;
+};
+
+SFSetLayout getLayout(STsdb *pTsdb, SDFileSet *pSet) {
+  SFSetLayout   layout;
+  SDataFReader *pReader = NULL;
+  SArray       *aBlockIdx = taosArrayInit(0, sizeof(SBlockIdx));
+  SArray       *aSttBlk = taosArrayInit(0, sizeof(SSttBlk));
+  SMapData      mDataBlk = {0};
+
+  layout.nSttF = pSet->nSttF;
+  EXPECT_EQ(tsdbDataFReaderOpen(&pReader, pTsdb, pSet), 0);
+  EXPECT_EQ(tsdbReadBlockIdx(pReader, aBlockIdx), 0);
+  for (int32_t i = 0; i < taosArrayGetSize(aBlockIdx); i++) {
+    EXPECT_EQ(tsdbReadDataBlk(pReader, (SBlockIdx *)taosArrayGet(aBlockIdx, i), &mDataBlk), 0);
+    for (int32_t j = 0; j < mDataBlk.nItem; j++) {
+      SDataBlk dataBlk;
+      tMapDataGetItemByIdx(&mDataBlk, j, &dataBlk, tGetDataBlk);
+      layout.nRow += dataBlk.nRow;
+      layout.nDataBlk++;
+    }
+  }
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    EXPECT_EQ(tsdbReadSttBlk(pReader, iStt, aSttBlk), 0);
+    layout.nSttBlk += taosArrayGetSize(aSttBlk);
+  }
+
+  tsdbDataFReaderClose(&pReader);
+  tMapDataClear(&mDataBlk);
+  taosArrayDestroy(aSttBlk);
+  taosArrayDestroy(aBlockIdx);
+  return layout;
+}
+
+int64_t countFiles(const char *path) {
+  int64_t    n = 0;
+  TdDirPtr   pDir = taosOpenDir(path);
+  TdDirEntryPtr pEntry;
+  while ((pEntry = taosReadDir(pDir)) != NULL) {
+    if (!taosDirEntryIsDir(pEntry)) n++;
+  }
+  taosCloseDir(&pDir);
+  return n;
+}
+
+}  // namespace
+
+class TsdbCompactTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tsCompactMaxSpeed = 0;
+    env.open("tsdbCompactTest");
+  }
+
+  void TearDown() override {
+    tsCompactMaxSpeed = 0;
+    env.close();
+  }
+
+  int32_t compact() {
+    int64_t commitID = env.pVnode->state.commitID++;
+    return tsdbCompact(env.pVnode->pTsdb, commitID);
+  }
+
+  TsdbTestEnv env;
+};
+
+TEST_F(TsdbCompactTest, mergeVersionsAndDeletes) {
+  int64_t uid1 = env.createTable();
+  int64_t uid2 = env.createTable();
+
+  TsdbTestEnv::SRows expect1, expect2, rows;
+
+  // the first commit
+  for (int64_t i = 0; i < 1000; i++) rows[env.baseTs + i * kSecond] = i;
+  env.insert(uid1, rows);
+  env.insert(uid2, rows);
+  expect1 = expect2 = rows;
+  env.commit();
+
+  // newer versions of the same timestamps in the next commit
+  rows.clear();
+  for (int64_t i = 100; i < 200; i++) rows[env.baseTs + i * kSecond] = i + 10000;
+  env.insert(uid1, rows);
+  for (auto &row : rows) expect1[row.first] = row.second;
+
+  rows.clear();
+  for (int64_t i = 1000; i < 1100; i++) rows[env.baseTs + i * kSecond] = i;
+  env.insert(uid2, rows);
+  for (auto &row : rows) expect2[row.first] = row.second;
+  env.commit();
+
+  // a tombstone, and rows written again after it, which stay
+  env.deleteRange(uid1, env.baseTs + 500 * kSecond, env.baseTs + 599 * kSecond);
+  for (int64_t i = 500; i < 600; i++) expect1.erase(env.baseTs + i * kSecond);
+  rows.clear();
+  for (int64_t i = 550; i < 560; i++) rows[env.baseTs + i * kSecond] = -i;
+  env.insert(uid1, rows);
+  for (auto &row : rows) expect1[row.first] = row.second;
+  env.commit();
+
+  SDFileSet *pSet = env.getFSet(env.baseTs);
+  ASSERT_NE(pSet, nullptr);
+  SFSetLayout before = getLayout(env.pVnode->pTsdb, pSet);
+  EXPECT_EQ(before.nSttF, 3);
+  // the overwritten and the deleted rows are still in the files
+  EXPECT_GT(before.nRow, (int64_t)(expect1.size() + expect2.size()));
+  EXPECT_EQ(env.scan(uid1), expect1);
+  EXPECT_EQ(env.scan(uid2), expect2);
+
+  ASSERT_EQ(compact(), 0);
+
+  // every row is in full blocks of the .data file once, the deleted and the overwritten rows are gone
+  pSet = env.getFSet(env.baseTs);
+  ASSERT_NE(pSet, nullptr);
+  SFSetLayout after = getLayout(env.pVnode->pTsdb, pSet);
+  EXPECT_EQ(after.nSttF, 1);
+  EXPECT_EQ(after.nSttBlk, 0);
+  EXPECT_EQ(after.nRow, (int64_t)(expect1.size() + expect2.size()));
+  EXPECT_EQ(after.nDataBlk, (int32_t)((expect1.size() + 199) / 200 + (expect2.size() + 199) / 200));
+  EXPECT_EQ(env.scan(uid1), expect1);
+  EXPECT_EQ(env.scan(uid2), expect2);
+
+  // the file system is persisted
+  env.reopen();
+  EXPECT_EQ(env.scan(uid1), expect1);
+  EXPECT_EQ(env.scan(uid2), expect2);
+
+  // nothing left to compact
+  int32_t nSttF = env.getFSet(env.baseTs)->nSttF;
+  ASSERT_EQ(compact(), 0);
+  EXPECT_EQ(env.getFSet(env.baseTs)->nSttF, nSttF);
+}
+
+TEST_F(TsdbCompactTest, throttleAndStop) {
+  std::vector<int64_t>  uids;
+  TsdbTestEnv::SRows    rows;
+
+  for (int32_t i = 0; i < 10; i++) uids.push_back(env.createTable());
+
+  // values which do not compress, several MB of blocks in three .stt files
+  std::mt19937_64 rng(1);
+  for (int32_t iCommit = 0; iCommit < 3; iCommit++) {
+    for (int64_t uid : uids) {
+      rows.clear();
+      for (int64_t i = 0; i < 20000; i++) {
+        rows[env.baseTs + (i * 3 + iCommit) * kSecond] = (int64_t)rng();
+      }
+      env.insert(uid, rows);
+    }
+    env.commit();
+  }
+
+  SDFileSet *pSet = env.getFSet(env.baseTs);
+  ASSERT_NE(pSet, nullptr);
+  ASSERT_EQ(pSet->nSttF, 3);
+  TsdbTestEnv::SRows expect = env.scan(uids[0]);
+
+  char path[TSDB_FILENAME_LEN];
+  snprintf(path, sizeof(path), "%s%s%s", tfsGetPrimaryPath(env.pTfs), TD_DIRSEP, env.pVnode->pTsdb->path);
+  int64_t nFile = countFiles(path);
+
+  // unthrottled it is done well within a second, at 1MB/s it is still sleeping in the throttle when the vnode closes
+  tsCompactMaxSpeed = 1;
+  std::thread closer([this]() {
+    taosMsleep(2000);
+    atomic_store_8(&env.pVnode->stopCompact, 1);
+  });
+  EXPECT_EQ(compact(), TSDB_CODE_VND_STOPPED);
+  closer.join();
+
+  // nothing is applied and the files written are removed
+  pSet = env.getFSet(env.baseTs);
+  ASSERT_NE(pSet, nullptr);
+  EXPECT_EQ(pSet->nSttF, 3);
+  EXPECT_EQ(countFiles(path), nFile);
+  EXPECT_EQ(env.scan(uids[0]), expect);
+
+  // without the limit and the stop flag, it completes
+  tsCompactMaxSpeed = 0;
+  atomic_store_8(&env.pVnode->stopCompact, 0);
+  ASSERT_EQ(compact(), 0);
+  EXPECT_EQ(env.getFSet(env.baseTs)->nSttF, 1);
+  EXPECT_EQ(env.scan(uids[0]), expect);
+}
+
+TEST_F(TsdbCompactTest, compactAfterCommit) {
+  ASSERT_EQ(vnodeInit(1), 0);
+
+  // the compaction persists the commit ID it reserves in the vnode info
+  char       dir[TSDB_FILENAME_LEN];
+  SVnodeInfo info = {0};
+  info.config = env.pVnode->config;
+  snprintf(dir, sizeof(dir), "%s%s%s", tfsGetPrimaryPath(env.pTfs), TD_DIRSEP, env.pVnode->path);
+  ASSERT_EQ(vnodeSaveInfo(dir, &info), 0);
+  ASSERT_EQ(vnodeCommitInfo(dir, &info), 0);
+
+  auto waitCompact = [this]() {
+    taosThreadMutexLock(&env.pVnode->mutex);
+    while (env.pVnode->compacting) {
+      taosThreadCondWait(&env.pVnode->compactDone, &env.pVnode->mutex);
+    }
+    taosThreadMutexUnlock(&env.pVnode->mutex);
+  };
+
+  int64_t            uid = env.createTable();
+  TsdbTestEnv::SRows rows;
+  std::mt19937_64    rng(1);
+  for (int32_t iCommit = 0; iCommit < 3; iCommit++) {
+    rows.clear();
+    for (int64_t i = 0; i < 10000; i++) rows[env.baseTs + (i * 3 + iCommit) * kSecond] = (int64_t)rng();
+    env.insert(uid, rows);
+    env.commit();
+  }
+  ASSERT_EQ(env.getFSet(env.baseTs)->nSttF, 3);
+  TsdbTestEnv::SRows expect = env.scan(uid);
+
+  // disabled
+  tsCompactInterval = 0;
+  vnodeCompactIfNeeded(env.pVnode);
+  waitCompact();
+  EXPECT_EQ(env.getFSet(env.baseTs)->nSttF, 3);
+
+  // the file set with three .stt files is compacted in the background
+  tsCompactInterval = 3600;
+  EXPECT_TRUE(tsdbShouldCompact(env.pVnode->pTsdb, env.pVnode->compactCommitID));
+  vnodeCompactIfNeeded(env.pVnode);
+  waitCompact();
+  EXPECT_EQ(env.getFSet(env.baseTs)->nSttF, 1);
+  EXPECT_EQ(env.scan(uid), expect);
+  int64_t compactCommitID = env.pVnode->compactCommitID;
+  EXPECT_GT(compactCommitID, 0);
+
+  // a file set is not looked at again until a commit writes to it
+  EXPECT_FALSE(tsdbShouldCompact(env.pVnode->pTsdb, compactCommitID));
+
+  // a small commit after it does not make the file set fragmented
+  rows.clear();
+  for (int64_t i = 0; i < 10; i++) rows[env.baseTs + (i * 3 + 1) * kSecond] = -i;
+  env.insert(uid, rows);
+  env.commit();
+  EXPECT_EQ(env.getFSet(env.baseTs)->nSttF, 2);
+  EXPECT_FALSE(tsdbShouldCompact(env.pVnode->pTsdb, compactCommitID));
+
+  // another .stt file makes it worth compacting, but not before the interval since the last one has passed
+  env.insert(uid, rows);
+  env.commit();
+  EXPECT_EQ(env.getFSet(env.baseTs)->nSttF, 3);
+  EXPECT_TRUE(tsdbShouldCompact(env.pVnode->pTsdb, compactCommitID));
+  vnodeCompactIfNeeded(env.pVnode);
+  waitCompact();
+  EXPECT_EQ(env.pVnode->compactCommitID, compactCommitID);
+  EXPECT_EQ(env.getFSet(env.baseTs)->nSttF, 3);
+
+  env.pVnode->compactTs -= tsCompactInterval;
+  vnodeCompactIfNeeded(env.pVnode);
+  waitCompact();
+  EXPECT_GT(env.pVnode->compactCommitID, compactCommitID);
+  EXPECT_EQ(env.getFSet(env.baseTs)->nSttF, 1);
+  for (auto &row : rows) expect[row.first] = row.second;
+  EXPECT_EQ(env.scan(uid), expect);
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <tuple>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int64_t kSecond = 1000;
+
+typedef std::tuple<TSKEY, int64_t, int64_t> SMergeRow;  // ts, version, value
+
+}  // namespace
+
+class TsdbMergeTreeTest : public ::testing::Test {
+ protected:
+  // A commit writes the rows into the .data file unless there is a .stt file with rows already, so the first one
+  // holds a few rows of another table. Every later commit is written into a new .stt file, up to 8 of them.
+  void SetUp() override {
+    env.open("tsdbMergeTreeTest", 8);
+    insert(env.createTable(), 0, 5, 1, 0, 0);
+    env.commit();
+  }
+
+  void TearDown() override { env.close(); }
+
+  // the rows i * step + offset for i in [from, to)
+  void insert(int64_t uid, int64_t from, int64_t to, int64_t step, int64_t offset, int64_t base) {
+    TsdbTestEnv::SRows rows;
+    for (int64_t i = from; i < to; i++) rows[env.baseTs + (i * step + offset) * kSecond] = base + i;
+    env.insert(uid, rows);
+    for (auto &row : rows) written[uid].push_back(std::make_tuple(row.first, env.version, row.second));
+  }
+
+  // what the merge tree of the .stt files gives, every version of every row in the window and the version range
+  std::vector<SMergeRow> expected(int64_t uid, bool backward, STimeWindow window, SVersionRange verRange) {
+    std::vector<SMergeRow> rows;
+    for (auto &row : written[uid]) {
+      if (std::get<0>(row) >= window.skey && std::get<0>(row) <= window.ekey &&
+          (uint64_t)std::get<1>(row) >= verRange.minVer && (uint64_t)std::get<1>(row) <= verRange.maxVer) {
+        rows.push_back(row);
+      }
+    }
+    std::sort(rows.begin(), rows.end());
+    if (backward) std::reverse(rows.begin(), rows.end());
+    return rows;
+  }
+
+  std::vector<SMergeRow> merge(int64_t suid, int64_t uid, bool backward, STimeWindow window, SVersionRange verRange) {
+    std::vector<SMergeRow> rows;
+    SDFileSet             *pSet = env.getFSet(env.baseTs);
+    EXPECT_NE(pSet, nullptr);
+    if (pSet == NULL) return rows;
+
+    SDataFReader *pReader = NULL;
+    EXPECT_EQ(tsdbDataFReaderOpen(&pReader, env.pVnode->pTsdb, pSet), 0);
+    STSchema          *pSchema = metaGetTbTSchema(env.pVnode->pMeta, uid, 1, 1);
+    int16_t            colId = 2;
+    SSttBlockLoadInfo *pLoadInfo = tCreateLastBlockLoadInfo(pSchema, &colId, 1);
+
+    SMergeTree mTree = {0};
+    EXPECT_EQ(tMergeTreeOpen(&mTree, backward, pReader, suid, uid, &window, &verRange, pLoadInfo, true, "test"), 0);
+    while (tMergeTreeNext(&mTree)) {
+      TSDBROW row = tMergeTreeGetRow(&mTree);
+      SColVal cv;
+      tsdbRowGetColVal(&row, pSchema, 1, &cv);
+      EXPECT_TRUE(COL_VAL_IS_VALUE(&cv));
+      rows.push_back(std::make_tuple(TSDBROW_TS(&row), TSDBROW_VERSION(&row), cv.value.val));
+    }
+
+    tMergeTreeClose(&mTree);
+    tsdbDataFReaderClose(&pReader);
+    taosMemoryFree(pSchema);
+    return rows;
+  }
+
+  void checkMerge(int64_t suid, int64_t uid, STimeWindow window, SVersionRange verRange) {
+    EXPECT_EQ(merge(suid, uid, false, window, verRange), expected(uid, false, window, verRange));
+    EXPECT_EQ(merge(suid, uid, true, window, verRange), expected(uid, true, window, verRange));
+  }
+
+  // the last version of each timestamp, as the reader keeps it
+  TsdbTestEnv::SRows lastVersions(int64_t uid) {
+    TsdbTestEnv::SRows rows;
+    std::vector<SMergeRow> all = expected(uid, false, {INT64_MIN, INT64_MAX}, {0, UINT64_MAX});
+    for (auto &row : all) rows[std::get<0>(row)] = std::get<2>(row);
+    return rows;
+  }
+
+  TsdbTestEnv                              env;
+  std::map<int64_t, std::vector<SMergeRow>> written;  // uid -> every row written
+};
+
+TEST_F(TsdbMergeTreeTest, overlapAndVersions) {
+  int64_t              suid = env.createSuperTable();
+  std::vector<int64_t> uids;
+  for (int32_t i = 0; i < 3; i++) uids.push_back(env.createTable(suid));
+
+  // three files whose rows interleave one by one, so the winner changes on every row
+  for (int64_t k = 0; k < 3; k++) {
+    for (int64_t uid : uids) insert(uid, 0, 300, 3, k, k * 100000);
+    env.commit();
+  }
+
+  // the same keys as in the first file, in two newer versions of two files
+  for (int64_t uid : uids) insert(uid, 100, 150, 3, 0, 300000);
+  env.commit();
+  for (int64_t uid : uids) insert(uid, 120, 130, 3, 0, 400000);
+  env.commit();
+
+  // a file after all others, which is merged as a single run, and rows overlapping it in a block of the last file
+  for (int64_t uid : uids) insert(uid, 0, 500, 1, 1000, 500000);
+  env.commit();
+  insert(uids[1], 0, 100, 5, 1002, 600000);
+  insert(uids[1], 0, 100, 5, 1004, 700000);  // two versions of the table in the same blocks
+  env.commit();
+
+  SDFileSet *pSet = env.getFSet(env.baseTs);
+  ASSERT_NE(pSet, nullptr);
+  ASSERT_EQ(pSet->nSttF, 8);
+
+  STimeWindow   all = {INT64_MIN, INT64_MAX};
+  SVersionRange allVer = {0, UINT64_MAX};
+  for (int64_t uid : uids) {
+    checkMerge(suid, uid, all, allVer);
+
+    // part of the rows of the blocks and of the files
+    checkMerge(suid, uid, {env.baseTs + 200 * kSecond, env.baseTs + 1200 * kSecond}, allVer);
+    checkMerge(suid, uid, {env.baseTs + 301 * kSecond, env.baseTs + 301 * kSecond}, allVer);
+
+    // the newer versions are left out, or only they are taken
+    int64_t maxVer = std::get<1>(written[uid][300 * 3]);  // the version of the fourth file
+    checkMerge(suid, uid, all, {0, (uint64_t)maxVer - 1});
+    checkMerge(suid, uid, all, {(uint64_t)maxVer, UINT64_MAX});
+    checkMerge(suid, uid, {env.baseTs + 360 * kSecond, env.baseTs + 390 * kSecond}, {(uint64_t)maxVer, UINT64_MAX});
+
+    // and the reader keeps the last version of each key
+    EXPECT_EQ(env.scan(uid), lastVersions(uid));
+  }
+
+  // the blocks of the last file are only partly in the version range
+  int64_t lastVer = std::get<1>(written[uids[1]].back());
+  checkMerge(suid, uids[1], all, {0, (uint64_t)lastVer - 1});
+  checkMerge(suid, uids[1], all, {(uint64_t)lastVer - 1, (uint64_t)lastVer - 1});
+  checkMerge(suid, uids[1], all, {(uint64_t)lastVer, (uint64_t)lastVer});
+
+  // a table with no rows in the files
+  int64_t uid = env.createTable(suid);
+  EXPECT_TRUE(merge(suid, uid, false, all, allVer).empty());
+  EXPECT_TRUE(merge(suid, uid, true, all, allVer).empty());
+}
+
+TEST_F(TsdbMergeTreeTest, sameKeyInAllFiles) {
+  int64_t uid = env.createTable();
+
+  // every key in every file, each time in a newer version
+  for (int64_t k = 0; k < 5; k++) {
+    insert(uid, 0, 400, 1, 0, k * 1000);
+    env.commit();
+  }
+  ASSERT_EQ(env.getFSet(env.baseTs)->nSttF, 6);
+
+  checkMerge(0, uid, {INT64_MIN, INT64_MAX}, {0, UINT64_MAX});
+  int64_t ver = std::get<1>(written[uid][2 * 400]);  // the third file
+  checkMerge(0, uid, {INT64_MIN, INT64_MAX}, {(uint64_t)ver, (uint64_t)ver});
+  checkMerge(0, uid, {env.baseTs + 199 * kSecond, env.baseTs + 201 * kSecond}, {0, (uint64_t)ver});
+  EXPECT_EQ(env.scan(uid), lastVersions(uid));
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <random>
+#include <vector>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int64_t kSecond = 1000;
+
+int64_t countFiles(const char *path) {
+  int64_t       n = 0;
+  TdDirPtr      pDir = taosOpenDir(path);
+  TdDirEntryPtr pEntry;
+  if (pDir == NULL) return 0;
+  while ((pEntry = taosReadDir(pDir)) != NULL) {
+    if (!taosDirEntryIsDir(pEntry)) n++;
+  }
+  taosCloseDir(&pDir);
+  return n;
+}
+
+}  // namespace
+
+class TsdbRetentionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tsMigrateMaxSpeed = 0;
+    env.open("tsdbRetentionTest", 4, 0, 2);
+  }
+
+  void TearDown() override {
+    tsMigrateMaxSpeed = 0;
+    env.close();
+  }
+
+  // the disk level of the file set holding ts
+  int32_t getFSetLevel(TSKEY ts) {
+    STsdb *pTsdb = env.pVnode->pTsdb;
+    taosThreadRwlockRdlock(&pTsdb->rwLock);
+    SDFileSet *pSet = env.getFSet(ts);
+    int32_t    level = pSet ? pSet->diskId.level : -1;
+    taosThreadRwlockUnlock(&pTsdb->rwLock);
+    return level;
+  }
+
+  std::string tsdbPathAt(int32_t level) {
+    SDiskID did = {.level = level, .id = 0};
+    return std::string(tfsGetDiskPath(env.pTfs, did)) + TD_DIRSEP + env.pVnode->pTsdb->path;
+  }
+
+  TsdbTestEnv env;
+};
+
+TEST_F(TsdbRetentionTest, migrateThrottleAndStop) {
+  std::vector<int64_t> uids;
+  TsdbTestEnv::SRows   rows;
+
+  for (int32_t i = 0; i < 10; i++) uids.push_back(env.createTable());
+
+  // values which do not compress, a few MB in the file set ten days ago
+  std::mt19937_64 rng(1);
+  for (int64_t uid : uids) {
+    rows.clear();
+    for (int64_t i = 0; i < 20000; i++) rows[env.baseTs + i * kSecond] = (int64_t)rng();
+    env.insert(uid, rows);
+  }
+  env.commit();
+  ASSERT_EQ(getFSetLevel(env.baseTs), 0);
+  TsdbTestEnv::SRows expect = env.scan(uids[0]);
+
+  // data older than five days belongs to the second level
+  env.pVnode->pTsdb->keepCfg.keep0 = 5 * 1440;
+
+  // at 1MB/s the copy is still sleeping in the throttle when the vnode stops it
+  tsMigrateMaxSpeed = 1;
+  ASSERT_EQ(tsdbDoRetention(env.pVnode->pTsdb, taosGetTimestampSec()), 0);
+  ASSERT_NE(env.pVnode->pTsdb->pMigrator, nullptr);
+  taosMsleep(500);
+  EXPECT_EQ(getFSetLevel(env.baseTs), 0);
+
+  int64_t startMs = taosGetTimestampMs();
+  tsdbStopMigration(env.pVnode->pTsdb);
+  EXPECT_LT(taosGetTimestampMs() - startMs, 1000);
+  EXPECT_EQ(env.pVnode->pTsdb->pMigrator, nullptr);
+
+  // nothing is applied and the copies are removed
+  EXPECT_EQ(getFSetLevel(env.baseTs), 0);
+  EXPECT_EQ(countFiles(tsdbPathAt(1).c_str()), 0);
+  EXPECT_EQ(env.scan(uids[0]), expect);
+
+  // without the limit, the file set is switched to the second level in the background
+  tsMigrateMaxSpeed = 0;
+  ASSERT_EQ(tsdbDoRetention(env.pVnode->pTsdb, taosGetTimestampSec()), 0);
+  for (int32_t i = 0; i < 1000 && getFSetLevel(env.baseTs) != 1; i++) {
+    taosMsleep(10);
+  }
+  EXPECT_EQ(getFSetLevel(env.baseTs), 1);
+  EXPECT_GT(countFiles(tsdbPathAt(1).c_str()), 0);
+  EXPECT_EQ(env.scan(uids[0]), expect);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int64_t kSecond = 1000;
+const int64_t kFreq = 10 * kSecond;  // granularity of the first rollup level
+const int64_t kRollupValue = 1000;   // added to the values of the rolled-up rows
+
+typedef std::vector<std::pair<TSKEY, int64_t>> SRowList;
+
+}  // namespace
+
+class TsdbRollupReadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    env.open("tsdbRollupReadTest");
+    pVnode = env.pVnode;
+    pVnode->pSma = (SSma *)taosMemoryCalloc(1, sizeof(SSma));
+    ASSERT_NE(pVnode->pSma, nullptr);
+    pVnode->pSma->pVnode = pVnode;
+    ASSERT_EQ(tsdbOpen(pVnode, &VND_RSMA1(pVnode), VNODE_RSMA1_DIR, NULL, 0), 0);
+    ASSERT_EQ(tsdbBegin(VND_RSMA1(pVnode)), 0);
+    pVnode->config.isRsma = 1;
+  }
+
+  void TearDown() override {
+    pVnode->config.isRsma = 0;
+    tsdbClose(&VND_RSMA1(pVnode));
+    taosMemoryFreeClear(pVnode->pSma);
+    env.close();
+  }
+
+  // the rows of the table in the query time window, read with the first rollup level chosen
+  SRowList read(int64_t suid, int64_t uid, STimeWindow window, int32_t order) {
+    SRowList            rows;
+    SColumnInfo         aCol[TsdbTestEnv::kNumOfCols] = {{.colId = 1, .bytes = 8, .type = TSDB_DATA_TYPE_TIMESTAMP},
+                                                         {.colId = 2, .bytes = 8, .type = TSDB_DATA_TYPE_BIGINT}};
+    int32_t             aSlot[TsdbTestEnv::kNumOfCols] = {0, 1};
+    SQueryTableDataCond cond = {0};
+    cond.suid = suid;
+    cond.order = order;
+    cond.numOfCols = TsdbTestEnv::kNumOfCols;
+    cond.colList = aCol;
+    cond.pSlotList = aSlot;
+    cond.type = TIMEWINDOW_RANGE_CONTAINED;
+    cond.twindows = window;
+    cond.startVersion = -1;
+    cond.endVersion = -1;
+    cond.rollupLevel = TSDB_RETENTION_L1;
+
+    STableKeyInfo keyInfo = {.uid = (uint64_t)uid, .groupId = 0};
+    STsdbReader  *pReader = NULL;
+    EXPECT_EQ(tsdbReaderOpen(pVnode, &cond, &keyInfo, 1, NULL, &pReader, "test"), 0);
+    if (pReader == NULL) return rows;
+
+    while (tsdbNextDataBlock(pReader)) {
+      SSDataBlock     *pBlock = tsdbRetrieveDataBlock(pReader, NULL);
+      SColumnInfoData *pTs = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 0);
+      SColumnInfoData *pVal = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 1);
+      for (int32_t i = 0; i < pBlock->info.rows; i++) {
+        rows.push_back({*(TSKEY *)colDataGetData(pTs, i), *(int64_t *)colDataGetData(pVal, i)});
+      }
+    }
+    tsdbReaderClose(pReader);
+    return rows;
+  }
+
+  // the rolled-up rows of the level until endKey, then the raw rows after it
+  SRowList expect(TSKEY endKey, STimeWindow window, int32_t order) {
+    SRowList rows;
+    for (TSKEY ts = window.skey; ts <= window.ekey; ts += kSecond) {
+      if (ts > endKey) {
+        rows.push_back({ts, ts - env.baseTs});
+      } else if ((ts - env.baseTs) % kFreq == 0) {
+        rows.push_back({ts, kRollupValue + ts - env.baseTs});
+      }
+    }
+    if (order == TSDB_ORDER_DESC) std::reverse(rows.begin(), rows.end());
+    return rows;
+  }
+
+  TsdbTestEnv env;
+  SVnode     *pVnode = nullptr;
+};
+
+TEST_F(TsdbRollupReadTest, splitAtRollupKey) {
+  int64_t suid = env.createSuperTable();
+  int64_t uid = env.createTable(suid);
+
+  // a minute of raw rows every second, and the periods of the level over them
+  TsdbTestEnv::SRows raw, rollup;
+  for (int64_t i = 0; i < 60; i++) {
+    raw[env.baseTs + i * kSecond] = i * kSecond;
+  }
+  for (int64_t i = 0; i < 6; i++) {
+    rollup[env.baseTs + i * kFreq] = kRollupValue + i * kFreq;
+  }
+  env.insert(uid, raw);
+  env.insert(uid, rollup, VND_RSMA1(pVnode));
+
+  STimeWindow window = {.skey = env.baseTs, .ekey = env.baseTs + 59 * kSecond};
+
+  // nothing is rolled up yet, all is read from the raw data
+  EXPECT_EQ(tsdbGetRollupKey(VND_RSMA1(pVnode), suid), TSKEY_MIN);
+  EXPECT_EQ(read(suid, uid, window, TSDB_ORDER_ASC), expect(TSKEY_MIN, window, TSDB_ORDER_ASC));
+
+  // the first three periods are closed
+  TSKEY endKey = env.baseTs + 3 * kFreq - 1;
+  tsdbSetRollupKey(VND_RSMA1(pVnode), suid, endKey);
+  EXPECT_EQ(read(suid, uid, window, TSDB_ORDER_ASC), expect(endKey, window, TSDB_ORDER_ASC));
+  EXPECT_EQ(read(suid, uid, window, TSDB_ORDER_DESC), expect(endKey, window, TSDB_ORDER_DESC));
+
+  // the progress never goes back
+  tsdbSetRollupKey(VND_RSMA1(pVnode), suid, env.baseTs + kFreq - 1);
+  EXPECT_EQ(tsdbGetRollupKey(VND_RSMA1(pVnode), suid), endKey);
+
+  // a query time window after the progress is read from the raw data only
+  STimeWindow newer = {.skey = env.baseTs + 4 * kFreq, .ekey = window.ekey};
+  EXPECT_EQ(read(suid, uid, newer, TSDB_ORDER_ASC), expect(endKey, newer, TSDB_ORDER_ASC));
+
+  // all periods are closed
+  endKey = env.baseTs + 6 * kFreq - 1;
+  tsdbSetRollupKey(VND_RSMA1(pVnode), suid, endKey);
+  EXPECT_EQ(read(suid, uid, window, TSDB_ORDER_ASC), expect(endKey, window, TSDB_ORDER_ASC));
+  EXPECT_EQ(read(suid, uid, window, TSDB_ORDER_DESC), expect(endKey, window, TSDB_ORDER_DESC));
+
+  // the progress of another super table is not shared
+  EXPECT_EQ(tsdbGetRollupKey(VND_RSMA1(pVnode), suid + 1), TSKEY_MIN);
+}
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <tuple>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int64_t kSecond = 1000;
+const int64_t kDay = 86400 * kSecond;
+
+typedef std::tuple<int64_t, TSKEY, TSKEY>   SStats;    // nRow, minKey, maxKey
+typedef std::map<int64_t, SStats>           SStbStats;  // suid -> stats
+typedef std::tuple<uint32_t, uint64_t, uint64_t, int32_t, int32_t, uint32_t, uint16_t, uint32_t> SBlockDist;
+
+}  // namespace
+
+class TsdbStatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tsCompactMaxSpeed = 0;
+    env.open("tsdbStatsTest", 3);
+  }
+
+  void TearDown() override { env.close(); }
+
+  // the rows [from, to) seconds after the start of the day, which are not written twice unless a test wants it so
+  void insert(int64_t uid, int64_t day, int64_t from, int64_t to) {
+    TsdbTestEnv::SRows rows;
+    for (int64_t i = from; i < to; i++) rows[env.baseTs + day * kDay + i * kSecond] = i;
+    env.insert(uid, rows);
+    for (auto &row : rows) inMem[uid].push_back(row.first);
+  }
+
+  void commit() {
+    env.commit();
+    for (auto &rows : inMem) {
+      committed[rows.first].insert(committed[rows.first].end(), rows.second.begin(), rows.second.end());
+    }
+    inMem.clear();
+  }
+
+  // the rows committed into the files, each version counted
+  SStbStats expected() {
+    SStbStats stats;
+    for (auto &rows : committed) {
+      int64_t suid = suids[rows.first];
+      if (suid == 0 || rows.second.empty()) continue;
+
+      auto it = stats.find(suid);
+      if (it == stats.end()) it = stats.emplace(suid, SStats(0, INT64_MAX, INT64_MIN)).first;
+      for (TSKEY ts : rows.second) {
+        std::get<0>(it->second) += 1;
+        std::get<1>(it->second) = std::min(std::get<1>(it->second), ts);
+        std::get<2>(it->second) = std::max(std::get<2>(it->second), ts);
+      }
+    }
+    return stats;
+  }
+
+  SStbStats stats() {
+    SStbStats stats;
+    SArray   *aStbStats = taosArrayInit(0, sizeof(STsdbStbStats));
+    EXPECT_EQ(tsdbGetStbStats(env.pVnode->pTsdb, aStbStats), 0);
+    for (int32_t i = 0; i < taosArrayGetSize(aStbStats); i++) {
+      STsdbStbStats *pStbStats = (STsdbStbStats *)taosArrayGet(aStbStats, i);
+      stats[pStbStats->suid] = SStats(pStbStats->nRow, pStbStats->minKey, pStbStats->maxKey);
+    }
+    taosArrayDestroy(aStbStats);
+    return stats;
+  }
+
+  SBlockDist blockDist(int64_t suid) {
+    STableBlockDistInfo info = {.maxRows = INT_MIN, .minRows = INT_MAX};
+    EXPECT_EQ(tsdbGetStbBlockDistInfo(env.pVnode->pTsdb, suid, &info), 0);
+    for (int32_t i = 0; i < tListLen(info.blockRowsHisto); i++) histo[suid][i] = info.blockRowsHisto[i];
+    return SBlockDist(info.numOfBlocks, info.totalRows, info.totalSize, info.maxRows, info.minRows,
+                      info.numOfSmallBlocks, info.numOfFiles, info.numOfInmemRows);
+  }
+
+  // the block distribution collected by a reader of the child tables in the meta, as for a child table before the
+  // stats, in the same fields but the size and the number of files which the reader does not count the same way
+  SBlockDist readerBlockDist(int64_t suid) {
+    std::vector<STableKeyInfo> keys;
+    for (auto &table : suids) {
+      SMetaInfo info;
+      if (table.second == suid && metaGetInfo(env.pVnode->pMeta, table.first, &info, NULL) == 0) {
+        keys.push_back({.uid = (uint64_t)table.first, .groupId = 0});
+      }
+    }
+
+    SColumnInfo         col = {.colId = 1, .bytes = sizeof(TSKEY), .type = TSDB_DATA_TYPE_TIMESTAMP};
+    int32_t             slot = 0;
+    SQueryTableDataCond cond = {0};
+    cond.suid = suid;
+    cond.order = TSDB_ORDER_ASC;
+    cond.numOfCols = 1;
+    cond.colList = &col;
+    cond.pSlotList = &slot;
+    cond.type = TIMEWINDOW_RANGE_CONTAINED;
+    cond.twindows = (STimeWindow){.skey = INT64_MIN, .ekey = INT64_MAX};
+    cond.startVersion = -1;
+    cond.endVersion = -1;
+
+    STableBlockDistInfo info = {.maxRows = INT_MIN, .minRows = INT_MAX};
+    STsdbReader        *pReader = NULL;
+    EXPECT_EQ(tsdbReaderOpen(env.pVnode, &cond, keys.data(), keys.size(), NULL, &pReader, "test"), 0);
+    if (pReader) {
+      EXPECT_EQ(tsdbGetFileBlocksDistInfo(pReader, &info), 0);
+      info.numOfInmemRows = tsdbGetNumOfRowsInMemTable(pReader);
+      tsdbReaderClose(pReader);
+    }
+    for (int32_t i = 0; i < tListLen(info.blockRowsHisto); i++) histo[suid][i] = info.blockRowsHisto[i];
+    return SBlockDist(info.numOfBlocks, info.totalRows, 0, info.maxRows, info.minRows, info.numOfSmallBlocks, 0,
+                      info.numOfInmemRows);
+  }
+
+  void checkReader(int64_t suid) {
+    SBlockDist dist = blockDist(suid);
+    auto       histoStats = histo[suid];
+    std::get<2>(dist) = 0;
+    std::get<6>(dist) = 0;
+    EXPECT_EQ(dist, readerBlockDist(suid));
+    EXPECT_EQ(histo[suid], histoStats);
+  }
+
+  // what the committer summarized is the same as what is read from the files once the vnode is opened again
+  void checkReopen(const std::vector<int64_t> &stbs) {
+    SStbStats                     before = stats();
+    std::map<int64_t, SBlockDist> distBefore;
+    for (int64_t suid : stbs) distBefore[suid] = blockDist(suid);
+    auto histoBefore = histo;
+
+    env.reopen();
+    EXPECT_EQ(stats(), before);
+    for (int64_t suid : stbs) EXPECT_EQ(blockDist(suid), distBefore[suid]) << "suid:" << suid;
+    EXPECT_EQ(histo, histoBefore);
+  }
+
+  int64_t createTable(int64_t suid) {
+    int64_t uid = env.createTable(suid);
+    suids[uid] = suid;
+    return uid;
+  }
+
+  TsdbTestEnv                                   env;
+  std::map<int64_t, int64_t>                    suids;      // uid -> suid
+  std::map<int64_t, std::vector<TSKEY>>         inMem;      // uid -> keys written since the last commit
+  std::map<int64_t, std::vector<TSKEY>>         committed;  // uid -> keys committed
+  std::map<int64_t, std::map<int32_t, int32_t>> histo;      // suid -> block rows histogram of the last blockDist()
+};
+
+TEST_F(TsdbStatsTest, summarizeCommitted) {
+  std::vector<int64_t> stbs = {env.createSuperTable(), env.createSuperTable()};
+  std::vector<int64_t> uids;
+  for (int64_t suid : stbs) {
+    for (int32_t i = 0; i < 3; i++) uids.push_back(createTable(suid));
+  }
+  int64_t ntb = createTable(0);
+
+  EXPECT_TRUE(stats().empty());
+
+  // data blocks in the first commit of each file set, then .stt files until they are merged
+  for (int64_t k = 0; k < 6; k++) {
+    for (size_t i = 0; i < uids.size(); i++) {
+      insert(uids[i], k % 2, k * 1000, k * 1000 + (k == 0 ? 500 : 50) + i * 10);
+    }
+    insert(ntb, 0, k * 1000, k * 1000 + 100);
+    commit();
+    EXPECT_EQ(stats(), expected()) << "commit:" << k;
+  }
+
+  // the rows of the memtable are not in the files, but they are in the block distribution
+  insert(uids[0], 2, 0, 30);
+  EXPECT_EQ(stats(), expected());
+  EXPECT_EQ(std::get<7>(blockDist(stbs[0])), 30);
+  EXPECT_EQ(std::get<7>(blockDist(stbs[1])), 0);
+
+  SBlockDist dist = blockDist(stbs[0]);
+  EXPECT_GT(std::get<0>(dist), 0);
+  EXPECT_EQ(std::get<6>(dist), 2);  // the file set of the memtable rows is not committed yet
+
+  commit();
+  EXPECT_EQ(stats(), expected());
+  EXPECT_EQ(std::get<6>(blockDist(stbs[0])), 3);
+  checkReopen(stbs);
+}
+
+TEST_F(TsdbStatsTest, compactAndReread) {
+  int64_t              suid = env.createSuperTable();
+  std::vector<int64_t> uids;
+  for (int32_t i = 0; i < 4; i++) uids.push_back(createTable(suid));
+
+  // the same keys in every commit, counted once per version until they are merged
+  for (int64_t k = 0; k < 3; k++) {
+    for (int64_t uid : uids) insert(uid, 0, 0, 300);
+    commit();
+  }
+  EXPECT_EQ(stats(), expected());
+
+  // the files rewritten by the compaction are summarized when the stats are asked for next
+  int64_t commitID = env.pVnode->state.commitID++;
+  ASSERT_EQ(tsdbCompact(env.pVnode->pTsdb, commitID), 0);
+  for (int64_t uid : uids) committed[uid].resize(300);
+  EXPECT_EQ(stats(), expected());
+  EXPECT_EQ(std::get<1>(blockDist(suid)), 300 * uids.size());
+
+  // and the commit after it takes the summaries of the files it keeps
+  insert(uids[0], 0, 300, 400);
+  insert(uids[1], 1, 0, 100);
+  commit();
+  EXPECT_EQ(stats(), expected());
+  checkReopen({suid});
+}
+
+TEST_F(TsdbStatsTest, blockDistOfReader) {
+  std::vector<int64_t> stbs = {env.createSuperTable(), env.createSuperTable()};
+  std::vector<int64_t> uids;
+  for (int32_t i = 0; i < 5; i++) uids.push_back(createTable(stbs[0]));
+  int64_t other = createTable(stbs[1]);
+  int64_t ntb = createTable(0);
+
+  // data blocks of several sizes in two file sets, and the .stt files of the commits after the first
+  for (int64_t k = 0; k < 3; k++) {
+    for (size_t i = 0; i < uids.size(); i++) insert(uids[i], k % 2, k * 1000, k * 1000 + 50 + i * 150);
+    insert(other, 0, k * 1000, k * 1000 + 100);
+    insert(ntb, 0, k * 1000, k * 1000 + 100);
+    commit();
+    checkReader(stbs[0]);
+  }
+
+  // the rows of the memtable
+  insert(uids[0], 2, 0, 30);
+  insert(uids[1], 0, 5000, 5040);
+  insert(other, 0, 5000, 5040);
+  checkReader(stbs[0]);
+  EXPECT_EQ(std::get<7>(blockDist(stbs[0])), 70);
+
+  // a dropped child table is neither in the files nor in the memtable, before and after its rows are committed
+  env.dropTable(uids[1]);
+  checkReader(stbs[0]);
+  EXPECT_EQ(std::get<7>(blockDist(stbs[0])), 30);
+  commit();
+  checkReader(stbs[0]);
+  insert(uids[2], 0, 6000, 6100);
+  commit();
+  checkReader(stbs[0]);
+
+  env.reopen();
+  checkReader(stbs[0]);
+  checkReader(stbs[1]);
+
+  // and a dropped super table is nowhere
+  insert(other, 0, 7000, 7010);
+  env.dropSuperTable(stbs[1]);
+  EXPECT_EQ(blockDist(stbs[1]), SBlockDist(0, 0, 0, INT_MIN, INT_MAX, 0, 0, 0));
+  EXPECT_EQ(stats().count(stbs[1]), 0);
+  commit();
+  EXPECT_EQ(stats().count(stbs[1]), 0);
+}
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_TEST_UTIL_H_
+#define _TD_TSDB_TEST_UTIL_H_
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "meta.h"
+#include "tsdb.h"
+#include "vnd.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+
+/*
+ * A vnode with only the meta and the tsdb opened, under TD_TMP_DIR_PATH. The tables have a timestamp column and a
+ * bigint column, every write gets its own version, and commit() runs the same steps as a vnode commit.
+ */
+class TsdbTestEnv {
+ public:
+  typedef std::map<TSKEY, int64_t> SRows;  // ts -> value
+
+  static const int16_t kNumOfCols = 2;
+
+  SVnode *pVnode = nullptr;
+  STfs   *pTfs = nullptr;
+  int64_t version = 0;
+  int64_t nextUid = 1000;
+  TSKEY   baseTs = 0;  // start of a file set near now, so rows are within keep
+
+  // with nLevel > 1, one more disk on each level is put under the primary one
+  void open(const char *name, int32_t sttTrigger = 4, int32_t cacheLast = 0, int32_t nLevel = 1) {
+    snprintf(dir, sizeof(dir), "%s%s%s", TD_TMP_DIR_PATH, TD_DIRSEP, name);
+    taosRemoveDir(dir);
+    taosMkDir(dir);
+
+    SDiskCfg aDiskCfg[TFS_MAX_TIERS] = {0};
+    for (int32_t level = 0; level < nLevel; level++) {
+      if (level == 0) {
+        tstrncpy(aDiskCfg[level].dir, dir, sizeof(aDiskCfg[level].dir));
+        aDiskCfg[level].primary = 1;
+      } else {
+        snprintf(aDiskCfg[level].dir, sizeof(aDiskCfg[level].dir), "%s%slevel%d", dir, TD_DIRSEP, level);
+        taosMkDir(aDiskCfg[level].dir);
+      }
+      aDiskCfg[level].level = level;
+    }
+    pTfs = tfsOpen(aDiskCfg, nLevel);
+    ASSERT_NE(pTfs, nullptr);
+
+    cfg = vnodeCfgDefault;
+    cfg.vgId = 2;
+    cfg.szBuf = 16 * 1024 * 1024;
+    cfg.cacheLast = cacheLast;
+    cfg.sttTrigger = sttTrigger;
+    cfg.tsdbCfg.days = 1440;
+    cfg.tsdbCfg.minRows = 10;
+    cfg.tsdbCfg.maxRows = 200;
+
+    TSKEY now = taosGetTimestampMs();
+    baseTs = now - now % (86400LL * 1000) - 10 * 86400LL * 1000;
+
+    reopen(false);
+  }
+
+  void reopen(bool closeFirst = true) {
+    if (closeFirst) closeVnode();
+
+    pVnode = (SVnode *)taosMemoryCalloc(1, sizeof(*pVnode) + strlen(VNODE_PATH) + 1);
+    ASSERT_NE(pVnode, nullptr);
+    pVnode->path = (char *)&pVnode[1];
+    strcpy(pVnode->path, VNODE_PATH);
+    pVnode->config = cfg;
+    pVnode->pTfs = pTfs;
+    pVnode->state.commitID = commitID;
+    pVnode->state.committed = pVnode->state.applied = version;
+    taosThreadMutexInit(&pVnode->mutex, NULL);
+    taosThreadCondInit(&pVnode->poolNotEmpty, NULL);
+    taosThreadCondInit(&pVnode->compactDone, NULL);
+    tsem_init(&pVnode->canCommit, 0, 1);
+    tfsMkdir(pTfs, VNODE_PATH);
+
+    ASSERT_EQ(vnodeOpenBufPool(pVnode), 0);
+    ASSERT_EQ(metaOpen(pVnode, &pVnode->pMeta, 0), 0);
+    ASSERT_EQ(tsdbOpen(pVnode, &pVnode->pTsdb, VNODE_TSDB_DIR, NULL, 0), 0);
+    ASSERT_EQ(vnodeBegin(pVnode), 0);
+  }
+
+  void close() {
+    closeVnode();
+    if (pTfs) {
+      tfsClose(pTfs);
+      pTfs = nullptr;
+    }
+    taosRemoveDir(dir);
+  }
+
+  int64_t createSuperTable() {
+    SSchema aSchema[kNumOfCols] = {{.type = TSDB_DATA_TYPE_TIMESTAMP, .colId = 1, .bytes = 8},
+                                   {.type = TSDB_DATA_TYPE_BIGINT, .colId = 2, .bytes = 8}};
+    SSchema tagSchema = {.type = TSDB_DATA_TYPE_BIGINT, .colId = kNumOfCols + 1, .bytes = 8};
+    strcpy(aSchema[0].name, "ts");
+    strcpy(aSchema[1].name, "v");
+    strcpy(tagSchema.name, "tg");
+
+    int64_t        suid = nextUid++;
+    std::string    name = "st" + std::to_string(suid);
+    SVCreateStbReq req = {0};
+    req.name = (char *)name.c_str();
+    req.suid = suid;
+    req.schemaRow.nCols = kNumOfCols;
+    req.schemaRow.version = 1;
+    req.schemaRow.pSchema = aSchema;
+    req.schemaTag.nCols = 1;
+    req.schemaTag.version = 1;
+    req.schemaTag.pSchema = &tagSchema;
+    EXPECT_EQ(metaCreateSTable(pVnode->pMeta, ++version, &req), 0);
+    return suid;
+  }
+
+  // a normal table, or a child table of the super table suid, whose tag is its uid
+  int64_t createTable(int64_t suid = 0) {
+    SSchema aSchema[kNumOfCols] = {{.type = TSDB_DATA_TYPE_TIMESTAMP, .colId = 1, .bytes = 8},
+                                   {.type = TSDB_DATA_TYPE_BIGINT, .colId = 2, .bytes = 8}};
+    strcpy(aSchema[0].name, "ts");
+    strcpy(aSchema[1].name, "v");
+
+    int64_t       uid = nextUid++;
+    std::string   name = "t" + std::to_string(uid);
+    std::string   stbName = "st" + std::to_string(suid);
+    STag         *pTag = NULL;
+    SVCreateTbReq req = {0};
+    req.name = (char *)name.c_str();
+    req.uid = uid;
+    req.ctime = taosGetTimestampMs();
+    if (suid) {
+      SArray *aTagVal = taosArrayInit(1, sizeof(STagVal));
+      STagVal tagVal = {.cid = kNumOfCols + 1, .type = TSDB_DATA_TYPE_BIGINT, .i64 = uid};
+      taosArrayPush(aTagVal, &tagVal);
+      EXPECT_EQ(tTagNew(aTagVal, 1, false, &pTag), 0);
+      taosArrayDestroy(aTagVal);
+
+      req.type = TSDB_CHILD_TABLE;
+      req.ctb.stbName = (char *)stbName.c_str();
+      req.ctb.tagNum = 1;
+      req.ctb.suid = suid;
+      req.ctb.pTag = (uint8_t *)pTag;
+    } else {
+      req.type = TSDB_NORMAL_TABLE;
+      req.ntb.schemaRow.nCols = kNumOfCols;
+      req.ntb.schemaRow.version = 1;
+      req.ntb.schemaRow.pSchema = aSchema;
+    }
+    EXPECT_EQ(metaCreateTable(pVnode->pMeta, ++version, &req, NULL), 0);
+    tTagFree(pTag);
+    suids[uid] = suid;
+    return uid;
+  }
+
+  // insert the rows with one submit message, as one version, into the tsdb of the vnode or of a rollup level
+  void insert(int64_t uid, const SRows &rows, STsdb *pTsdb = nullptr) {
+    SSchema   aSchema[kNumOfCols] = {{.type = TSDB_DATA_TYPE_TIMESTAMP, .colId = 1, .bytes = 8},
+                                     {.type = TSDB_DATA_TYPE_BIGINT, .colId = 2, .bytes = 8}};
+    STSchema *pTSchema = tBuildTSchema(aSchema, kNumOfCols, 1);
+    SArray   *aColVal = taosArrayInit(kNumOfCols, sizeof(SColVal));
+    std::string data;
+
+    for (auto &row : rows) {
+      taosArrayClear(aColVal);
+      SColVal cv = COL_VAL_VALUE(1, TSDB_DATA_TYPE_TIMESTAMP, (SValue){.val = row.first});
+      taosArrayPush(aColVal, &cv);
+      cv = COL_VAL_VALUE(2, TSDB_DATA_TYPE_BIGINT, (SValue){.val = row.second});
+      taosArrayPush(aColVal, &cv);
+
+      STSRow *pRow = NULL;
+      ASSERT_EQ(tdSTSRowNew(aColVal, pTSchema, &pRow), 0);
+      data.append((const char *)pRow, TD_ROW_LEN(pRow));
+      taosMemoryFree(pRow);
+    }
+    taosArrayDestroy(aColVal);
+    taosMemoryFree(pTSchema);
+
+    int32_t     len = sizeof(SSubmitReq) + sizeof(SSubmitBlk) + data.size();
+    SSubmitReq *pReq = (SSubmitReq *)taosMemoryCalloc(1, len);
+    pReq->length = htonl(len);
+    pReq->numOfBlocks = htonl(1);
+    SSubmitBlk *pBlk = (SSubmitBlk *)(pReq + 1);
+    pBlk->uid = htobe64(uid);
+    pBlk->suid = htobe64(suids[uid]);
+    pBlk->sversion = htonl(1);
+    pBlk->dataLen = htonl(data.size());
+    pBlk->schemaLen = 0;
+    pBlk->numOfRows = htonl(rows.size());
+    memcpy(pBlk->data, data.data(), data.size());
+
+    EXPECT_EQ(tsdbInsertData(pTsdb ? pTsdb : pVnode->pTsdb, ++version, pReq, NULL), 0);
+    pVnode->state.applied = version;
+    taosMemoryFree(pReq);
+  }
+
+  void deleteRange(int64_t uid, TSKEY sKey, TSKEY eKey) {
+    EXPECT_EQ(tsdbDeleteTableData(pVnode->pTsdb, ++version, suids[uid], uid, sKey, eKey), 0);
+    pVnode->state.applied = version;
+  }
+
+  // the steps of vnodeProcessDropTbReq() and vnodeProcessDropStbReq() which concern the meta and the tsdb
+  void dropTable(int64_t uid) {
+    std::string name = "t" + std::to_string(uid);
+    SVDropTbReq req = {.name = (char *)name.c_str(), .suid = (uint64_t)suids[uid]};
+    tb_uid_t    tbUid = 0;
+    EXPECT_EQ(metaDropTable(pVnode->pMeta, ++version, &req, NULL, &tbUid), 0);
+    if (tbUid > 0) tsdbStatsDropTable(pVnode->pTsdb, req.suid, tbUid);
+    pVnode->state.applied = version;
+  }
+
+  void dropSuperTable(int64_t suid) {
+    std::string  name = "st" + std::to_string(suid);
+    SVDropStbReq req = {.name = (char *)name.c_str(), .suid = suid};
+    SArray      *tbUidList = taosArrayInit(8, sizeof(int64_t));
+    EXPECT_EQ(metaDropSTable(pVnode->pMeta, ++version, &req, tbUidList), 0);
+    tsdbStatsDropStb(pVnode->pTsdb, suid);
+    taosArrayDestroy(tbUidList);
+    pVnode->state.applied = version;
+  }
+
+  // the steps of vnodeAsyncCommit() and vnodeCommitImpl() which concern the meta and the tsdb
+  void commit() {
+    tsem_wait(&pVnode->canCommit);
+    tsdbPrepareCommit(pVnode->pTsdb);
+    metaPrepareAsyncCommit(pVnode->pMeta);
+    vnodeBufPoolUnRef(pVnode->inUse);
+    pVnode->inUse = NULL;
+
+    SCommitInfo info = {0};
+    info.info.config = pVnode->config;
+    info.info.state.committed = pVnode->state.applied;
+    info.info.state.commitID = pVnode->state.commitID;
+    info.pVnode = pVnode;
+    info.txn = metaGetTxn(pVnode->pMeta);
+
+    EXPECT_EQ(tsdbCommit(pVnode->pTsdb, &info), 0);
+    EXPECT_EQ(tsdbFinishCommit(pVnode->pTsdb), 0);
+    EXPECT_EQ(metaFinishCommit(pVnode->pMeta, info.txn), 0);
+    tsem_post(&pVnode->canCommit);
+
+    ASSERT_EQ(vnodeBegin(pVnode), 0);
+    commitID = pVnode->state.commitID;
+  }
+
+  // all rows of the table as a query sees them, merged from the memory tables and the files
+  SRows scan(int64_t uid) {
+    SRows               rows;
+    SColumnInfo         aCol[kNumOfCols] = {{.colId = 1, .bytes = 8, .type = TSDB_DATA_TYPE_TIMESTAMP},
+                                            {.colId = 2, .bytes = 8, .type = TSDB_DATA_TYPE_BIGINT}};
+    int32_t             aSlot[kNumOfCols] = {0, 1};
+    SQueryTableDataCond cond = {0};
+    cond.suid = suids[uid];
+    cond.order = TSDB_ORDER_ASC;
+    cond.numOfCols = kNumOfCols;
+    cond.colList = aCol;
+    cond.pSlotList = aSlot;
+    cond.type = TIMEWINDOW_RANGE_CONTAINED;
+    cond.twindows = (STimeWindow){.skey = INT64_MIN, .ekey = INT64_MAX};
+    cond.startVersion = -1;
+    cond.endVersion = -1;
+
+    STableKeyInfo keyInfo = {.uid = (uint64_t)uid, .groupId = 0};
+    STsdbReader  *pReader = NULL;
+    EXPECT_EQ(tsdbReaderOpen(pVnode, &cond, &keyInfo, 1, NULL, &pReader, "test"), 0);
+    if (pReader == NULL) return rows;
+
+    while (tsdbNextDataBlock(pReader)) {
+      SSDataBlock     *pBlock = tsdbRetrieveDataBlock(pReader, NULL);
+      SColumnInfoData *pTs = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 0);
+      SColumnInfoData *pVal = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 1);
+      for (int32_t i = 0; i < pBlock->info.rows; i++) {
+        TSKEY ts = *(TSKEY *)colDataGetData(pTs, i);
+        EXPECT_EQ(rows.count(ts), 0) << "duplicate ts:" << ts;
+        rows[ts] = *(int64_t *)colDataGetData(pVal, i);
+      }
+    }
+    tsdbReaderClose(pReader);
+    return rows;
+  }
+
+  // the committed file set holding ts
+  SDFileSet *getFSet(TSKEY ts) {
+    SDFileSet fSet = {.fid = tsdbKeyFid(ts, pVnode->pTsdb->keepCfg.days, pVnode->pTsdb->keepCfg.precision)};
+    return (SDFileSet *)taosArraySearch(pVnode->pTsdb->fs.aDFileSet, &fSet, tDFileSetCmprFn, TD_EQ);
+  }
+
+ private:
+  static constexpr const char *VNODE_PATH = "vnode2";
+
+  char      dir[TSDB_FILENAME_LEN] = {0};
+  SVnodeCfg                  cfg;
+  int64_t                    commitID = 0;
+  std::map<int64_t, int64_t> suids;  // uid -> suid
+
+  void closeVnode() {
+    if (pVnode == nullptr) return;
+
+    // as vnodeClose(), what is in the memory table is committed first
+    commit();
+    tsdbClose(&pVnode->pTsdb);
+    metaClose(pVnode->pMeta);
+    vnodeCloseBufPool(pVnode);
+    tsem_destroy(&pVnode->canCommit);
+    taosThreadCondDestroy(&pVnode->compactDone);
+    taosThreadCondDestroy(&pVnode->poolNotEmpty);
+    taosThreadMutexDestroy(&pVnode->mutex);
+    taosMemoryFree(pVnode);
+    pVnode = nullptr;
+  }
+};
+
+#pragma GCC diagnostic pop
+
+#endif /*_TD_TSDB_TEST_UTIL_H_*/
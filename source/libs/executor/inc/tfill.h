@@ -26,6 +26,8 @@ extern "C" {
 #include "tsimplehash.h"
 
 #define GET_DEST_SLOT_ID(_p) ((_p)->pExpr->base.resSchema.slotId)
+#define DO_INTERPOLATION(_v1, _v2, _k1, _k2, _k) \
+  ((_v1) + ((_v2) - (_v1)) * (((double)(_k)) - ((double)(_k1))) / (((double)(_k2)) - ((double)(_k1))))
 
 struct SSDataBlock;
 
@@ -75,6 +77,7 @@ typedef struct SFillInfo {
 
   SFillColInfo*    pFillCol;  // column info for fill operations
   SFillTagColInfo* pTags;     // tags value for filling gap
+  TSKEY*           pFillKeys; // timestamps of the rows of the gap being filled, in size of alloc
   const char*      id;
 } SFillInfo;
 
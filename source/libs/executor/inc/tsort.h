@@ -44,7 +44,10 @@ typedef struct SSortSource {
     void* param;
     bool  onlyRef;
   };
-
+  struct {
+    char*   pSortKeys;  // normalized sort keys of the rows in src.pBlock
+    int64_t keyBufLen;
+  };
 } SSortSource;
 
 typedef struct SMsortComparParam {
@@ -52,6 +55,7 @@ typedef struct SMsortComparParam {
   int32_t numOfSources;
   SArray* orderInfo;  // SArray<SBlockOrderInfo>
   bool    cmpGroupId;
+  int32_t sortKeyLen;  // rows are compared by the normalized sort keys if it is greater than 0
 } SMsortComparParam;
 
 typedef struct SSortHandle  SSortHandle;
@@ -108,6 +112,15 @@ int32_t tsortSetComparFp(SSortHandle* pHandle, _sort_merge_compar_fn_t fp);
  */
 int32_t tsortSetCompareGroupId(SSortHandle* pHandle, bool compareGroupId);
 
+/**
+ * Only the first maxRows rows of the sorted result are required. For the single source sort the rows are selected
+ * by a bounded heap while the input is consumed, so at most maxRows rows are buffered and nothing is spilled.
+ * @param pHandle
+ * @param maxRows
+ * @return
+ */
+int32_t tsortSetMaxRows(SSortHandle* pHandle, int64_t maxRows);
+
 /**
  *
  * @param pHandle
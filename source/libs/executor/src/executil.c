@@ -1404,6 +1404,14 @@ void createExprFromOneNode(SExprInfo* pExp, SNode* pNode, int16_t slotId) {
     pExp->base.resSchema =
         createResSchema(pType->type, pType->bytes, slotId, pType->scale, pType->precision, pOpNode->node.aliasName);
     pExp->pExpr->_optrRoot.pRootNode = pNode;
+
+    // the expression is calculated by the tree interpreter if it can not be compiled
+    int32_t code = scalarCompile(pNode, &pExp->pExpr->_optrRoot.pProgram);
+    if (code != TSDB_CODE_SUCCESS) {
+      qWarn("failed to compile the expression of slot:%d, reason:%s, calculate it by the node tree", slotId,
+            tstrerror(code));
+      pExp->pExpr->_optrRoot.pProgram = NULL;
+    }
   } else if (type == QUERY_NODE_CASE_WHEN) {
     pExp->pExpr->nodeType = QUERY_NODE_OPERATOR;
     SCaseWhenNode* pCaseNode = (SCaseWhenNode*)pNode;
@@ -1584,6 +1592,7 @@ SInterval extractIntervalInfo(const STableScanPhysiNode* pTableScanNode) {
       .intervalUnit = pTableScanNode->intervalUnit,
       .slidingUnit = pTableScanNode->slidingUnit,
       .offset = pTableScanNode->offset,
+      .precision = pTableScanNode->scan.node.pOutputDataBlockDesc->precision,
   };
 
   return interval;
@@ -1620,6 +1629,7 @@ int32_t initQueryTableDataCond(SQueryTableDataCond* pCond, const STableScanPhysi
   pCond->type = TIMEWINDOW_RANGE_CONTAINED;
   pCond->startVersion = -1;
   pCond->endVersion = -1;
+  pCond->rollupLevel = pTableScanNode->rollupLevel;
 
   int32_t j = 0;
   for (int32_t i = 0; i < pCond->numOfCols; ++i) {
@@ -55,9 +55,28 @@ typedef struct SPartitionOperatorInfo {
   int32_t        groupIndex;        // group index
   int32_t        pageIndex;         // page index of current group
   SExprSupp      scalarSup;
+
+  SArray*  pBlockGroups;  // SPartitionBlockGroup, the groups of the rows in current data block
+  int32_t* pRowGroup;     // index in pBlockGroups of each row in current data block
+  int32_t* pRowIndex;     // rows of current data block ordered by group
+  int32_t  rowIndexCap;   // capacity of pRowGroup and pRowIndex
 } SPartitionOperatorInfo;
 
-static void*    getCurrentDataGroupInfo(const SPartitionOperatorInfo* pInfo, SDataGroupInfo** pGroupInfo, int32_t len);
+typedef struct SPartitionBlockGroup {
+  SDataGroupInfo* pGroupInfo;
+  int32_t         numOfRows;  // number of rows of the group in current data block
+  int32_t         start;      // start position of the rows of the group in pRowIndex
+} SPartitionBlockGroup;
+
+#ifdef WINDOWS
+#define PARTITION_PREFETCH(_p)
+#else
+#define PARTITION_PREFETCH(_p) __builtin_prefetch(_p)
+#endif
+
+// number of rows that the source data is prefetched ahead of the row being copied
+#define PARTITION_PREFETCH_DIST 8
+
 static int32_t* setupColumnOffset(const SSDataBlock* pBlock, int32_t rowCapacity);
 static int32_t  setGroupResultOutputBuf(SOperatorInfo* pOperator, SOptrBasicInfo* binfo, int32_t numOfCols, char* pData,
                                         int16_t bytes, uint64_t groupId, SDiskbasedBuf* pBuf, SAggSupporter* pAggSup);
@@ -489,127 +508,267 @@ _error:
   return NULL;
 }
 
-static void doHashPartition(SOperatorInfo* pOperator, SSDataBlock* pBlock) {
-  SPartitionOperatorInfo* pInfo = pOperator->info;
-
-  for (int32_t j = 0; j < pBlock->info.rows; ++j) {
-    recordNewGroupKeys(pInfo->pGroupCols, pInfo->pGroupColVals, pBlock, j);
-    int32_t len = buildGroupKeys(pInfo->keyBuf, pInfo->pGroupColVals);
+static int32_t ensurePartitionRowIndex(SPartitionOperatorInfo* pInfo, int32_t numOfRows) {
+  if (numOfRows <= pInfo->rowIndexCap) {
+    return TSDB_CODE_SUCCESS;
+  }
 
-    SDataGroupInfo* pGroupInfo = NULL;
-    void*           pPage = getCurrentDataGroupInfo(pInfo, &pGroupInfo, len);
+  int32_t* p = taosMemoryRealloc(pInfo->pRowGroup, numOfRows * sizeof(int32_t));
+  if (p == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pInfo->pRowGroup = p;
 
-    pGroupInfo->numOfRows += 1;
+  p = taosMemoryRealloc(pInfo->pRowIndex, numOfRows * sizeof(int32_t));
+  if (p == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pInfo->pRowIndex = p;
 
-    // group id
-    if (pGroupInfo->groupId == 0) {
-      pGroupInfo->groupId = calcGroupId(pInfo->keyBuf, len);
-    }
+  pInfo->rowIndexCap = numOfRows;
+  return TSDB_CODE_SUCCESS;
+}
 
-    // number of rows
-    int32_t* rows = (int32_t*)pPage;
+static SDataGroupInfo* getDataGroupInfo(const SPartitionOperatorInfo* pInfo, int32_t len) {
+  SDataGroupInfo* p = taosHashGet(pInfo->pGroupSet, pInfo->keyBuf, len);
+  if (p != NULL) {
+    return p;
+  }
 
-    size_t numOfCols = pOperator->exprSupp.numOfExprs;
-    for (int32_t i = 0; i < numOfCols; ++i) {
-      SExprInfo* pExpr = &pOperator->exprSupp.pExprInfo[i];
-      int32_t    slotId = pExpr->base.pParam[0].pCol->slotId;
+  // it is a new group
+  SDataGroupInfo gi = {0};
+  gi.groupId = calcGroupId(pInfo->keyBuf, len);
+  gi.blockGroupIndex = -1;
+  gi.pPageList = taosArrayInit(100, sizeof(int32_t));
+  if (gi.pPageList == NULL || taosHashPut(pInfo->pGroupSet, pInfo->keyBuf, len, &gi, sizeof(SDataGroupInfo)) != 0) {
+    taosArrayDestroy(gi.pPageList);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
 
-      SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, slotId);
+  return taosHashGet(pInfo->pGroupSet, pInfo->keyBuf, len);
+}
 
-      int32_t bytes = pColInfoData->info.bytes;
-      int32_t startOffset = pInfo->columnOffset[i];
+// the last page of the group, or a new page if the last one is full
+static void* getDataGroupPage(const SPartitionOperatorInfo* pInfo, SDataGroupInfo* pGroupInfo) {
+  if (taosArrayGetSize(pGroupInfo->pPageList) > 0) {
+    int32_t* curId = taosArrayGetLast(pGroupInfo->pPageList);
+    void*    pPage = getBufPage(pInfo->pBuf, *curId);
+    if (pPage == NULL || *(int32_t*)pPage < pInfo->rowCapacity) {
+      return pPage;
+    }
 
-      int32_t* columnLen = NULL;
-      int32_t  contentLen = 0;
+    releaseBufPage(pInfo->pBuf, pPage);
+  }
 
-      if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
-        int32_t* offset = (int32_t*)((char*)pPage + startOffset);
-        columnLen = (int32_t*)((char*)pPage + startOffset + sizeof(int32_t) * pInfo->rowCapacity);
-        char* data = (char*)((char*)columnLen + sizeof(int32_t));
+  int32_t pageId = 0;
+  void*   pPage = getNewBufPage(pInfo->pBuf, &pageId);
+  if (pPage == NULL) {
+    return NULL;
+  }
 
-        if (colDataIsNull_s(pColInfoData, j)) {
-          offset[(*rows)] = -1;
-          contentLen = 0;
-        } else if (pColInfoData->info.type == TSDB_DATA_TYPE_JSON) {
-          offset[*rows] = (*columnLen);
-          char*   src = colDataGetData(pColInfoData, j);
-          int32_t dataLen = getJsonValueLen(src);
+  taosArrayPush(pGroupInfo->pPageList, &pageId);
+  memset(pPage, 0, getBufPageSize(pInfo->pBuf));
+  return pPage;
+}
 
-          memcpy(data + (*columnLen), src, dataLen);
-          int32_t v = (data + (*columnLen) + dataLen - (char*)pPage);
-          ASSERT(v > 0);
+// The first pass: find the group of each row, and count the rows of each group in the data block.
+static int32_t assignRowsToGroups(SPartitionOperatorInfo* pInfo, SSDataBlock* pBlock) {
+  int32_t numOfGroupCols = taosArrayGetSize(pInfo->pGroupCols);
+  int32_t index = -1;
 
-          contentLen = dataLen;
-        } else {
-          offset[*rows] = (*columnLen);
-          char* src = colDataGetData(pColInfoData, j);
-          memcpy(data + (*columnLen), src, varDataTLen(src));
-          int32_t v = (data + (*columnLen) + varDataTLen(src) - (char*)pPage);
-          ASSERT(v > 0);
+  for (int32_t j = 0; j < pBlock->info.rows; ++j) {
+    // the adjacent rows are likely to be in the same group, e.g. partition by tbname, so the group key is built and
+    // hashed only when it changes.
+    if (index == -1 || !groupKeyCompare(pInfo->pGroupCols, pInfo->pGroupColVals, pBlock, j, numOfGroupCols)) {
+      recordNewGroupKeys(pInfo->pGroupCols, pInfo->pGroupColVals, pBlock, j);
+      if (terrno != TSDB_CODE_SUCCESS) {  // group by json error
+        return terrno;
+      }
 
-          contentLen = varDataTLen(src);
-        }
-      } else {
-        char* bitmap = (char*)pPage + startOffset;
-        columnLen = (int32_t*)((char*)pPage + startOffset + BitmapLen(pInfo->rowCapacity));
-        char* data = (char*)columnLen + sizeof(int32_t);
+      int32_t         len = buildGroupKeys(pInfo->keyBuf, pInfo->pGroupColVals);
+      SDataGroupInfo* pGroupInfo = getDataGroupInfo(pInfo, len);
+      if (pGroupInfo == NULL) {
+        return terrno;
+      }
 
-        bool isNull = colDataIsNull_f(pColInfoData->nullbitmap, j);
-        if (isNull) {
-          colDataSetNull_f(bitmap, (*rows));
-        } else {
-          memcpy(data + (*columnLen), colDataGetData(pColInfoData, j), bytes);
-          ASSERT((data + (*columnLen) + bytes - (char*)pPage) <= getBufPageSize(pInfo->pBuf));
+      if (pGroupInfo->blockGroupIndex == -1) {
+        SPartitionBlockGroup group = {.pGroupInfo = pGroupInfo};
+        if (taosArrayPush(pInfo->pBlockGroups, &group) == NULL) {
+          return TSDB_CODE_OUT_OF_MEMORY;
         }
-        contentLen = bytes;
+        pGroupInfo->blockGroupIndex = taosArrayGetSize(pInfo->pBlockGroups) - 1;
       }
 
-      (*columnLen) += contentLen;
-      ASSERT(*columnLen >= 0);
+      index = pGroupInfo->blockGroupIndex;
     }
 
-    (*rows) += 1;
-
-    setBufPageDirty(pPage, true);
-    releaseBufPage(pInfo->pBuf, pPage);
+    pInfo->pRowGroup[j] = index;
+    ((SPartitionBlockGroup*)TARRAY_GET_ELEM(pInfo->pBlockGroups, index))->numOfRows += 1;
   }
+
+  return TSDB_CODE_SUCCESS;
 }
 
-void* getCurrentDataGroupInfo(const SPartitionOperatorInfo* pInfo, SDataGroupInfo** pGroupInfo, int32_t len) {
-  SDataGroupInfo* p = taosHashGet(pInfo->pGroupSet, pInfo->keyBuf, len);
+// Order the rows by group with the histogram of the groups, keeping the original order of rows in each group.
+static void buildGroupRowIndex(SPartitionOperatorInfo* pInfo, int32_t numOfRows) {
+  SPartitionBlockGroup* pGroups = TARRAY_GET_ELEM(pInfo->pBlockGroups, 0);
+  int32_t               numOfGroups = taosArrayGetSize(pInfo->pBlockGroups);
+
+  // the end position of each group first, which is moved to the start position when the rows are filled backwards
+  int32_t end = 0;
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    end += pGroups[i].numOfRows;
+    pGroups[i].start = end;
+    pGroups[i].pGroupInfo->numOfRows += pGroups[i].numOfRows;
+  }
 
-  void* pPage = NULL;
-  if (p == NULL) {  // it is a new group
-    SDataGroupInfo gi = {0};
-    gi.pPageList = taosArrayInit(100, sizeof(int32_t));
-    taosHashPut(pInfo->pGroupSet, pInfo->keyBuf, len, &gi, sizeof(SDataGroupInfo));
+  for (int32_t j = numOfRows - 1; j >= 0; --j) {
+    pInfo->pRowIndex[--pGroups[pInfo->pRowGroup[j]].start] = j;
+  }
+}
 
-    p = taosHashGet(pInfo->pGroupSet, pInfo->keyBuf, len);
+#define PARTITION_COPY_FIXED_ROWS(_dst, _src, _rowIndex, _num, _bytes)                    \
+  do {                                                                                    \
+    for (int32_t k = 0; k < (_num); ++k) {                                                \
+      if (k + PARTITION_PREFETCH_DIST < (_num)) {                                         \
+        PARTITION_PREFETCH((_src) + (_rowIndex)[k + PARTITION_PREFETCH_DIST] * (_bytes)); \
+      }                                                                                   \
+      memcpy((_dst) + k * (_bytes), (_src) + (_rowIndex)[k] * (_bytes), (_bytes));        \
+    }                                                                                     \
+  } while (0)
+
+// copy the rows of a column given by the row index into the page, after the existing numOfRows rows
+static void copyColumnToPage(const SPartitionOperatorInfo* pInfo, void* pPage, int32_t startOffset,
+                             const SColumnInfoData* pColInfoData, const int32_t* pRowIndex, int32_t num,
+                             int32_t numOfRows) {
+  if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
+    int32_t*       offset = (int32_t*)((char*)pPage + startOffset) + numOfRows;
+    int32_t*       columnLen = (int32_t*)((char*)pPage + startOffset + sizeof(int32_t) * pInfo->rowCapacity);
+    char*          data = (char*)columnLen + sizeof(int32_t);
+    const int32_t* srcOffset = pColInfoData->varmeta.offset;
+    bool           isJson = (pColInfoData->info.type == TSDB_DATA_TYPE_JSON);
+
+    for (int32_t k = 0; k < num; ++k) {
+      if (k + PARTITION_PREFETCH_DIST < num) {
+        PARTITION_PREFETCH(pColInfoData->pData + srcOffset[pRowIndex[k + PARTITION_PREFETCH_DIST]]);
+      }
 
-    int32_t pageId = 0;
-    pPage = getNewBufPage(pInfo->pBuf, &pageId);
-    taosArrayPush(p->pPageList, &pageId);
+      int32_t row = pRowIndex[k];
+      if (srcOffset[row] == -1) {
+        offset[k] = -1;
+        continue;
+      }
 
-    *(int32_t*)pPage = 0;
+      char*   src = pColInfoData->pData + srcOffset[row];
+      int32_t dataLen = isJson ? getJsonValueLen(src) : varDataTLen(src);
+      offset[k] = (*columnLen);
+      memcpy(data + (*columnLen), src, dataLen);
+      (*columnLen) += dataLen;
+    }
   } else {
-    int32_t* curId = taosArrayGetLast(p->pPageList);
-    pPage = getBufPage(pInfo->pBuf, *curId);
+    char*    bitmap = (char*)pPage + startOffset;
+    int32_t* columnLen = (int32_t*)((char*)pPage + startOffset + BitmapLen(pInfo->rowCapacity));
+    char*    data = (char*)columnLen + sizeof(int32_t) + (*columnLen);
+    int32_t  bytes = pColInfoData->info.bytes;
+
+    // the values of NULL are copied as well, which are masked by the bitmap
+    switch (bytes) {
+      case sizeof(int64_t):
+        PARTITION_COPY_FIXED_ROWS(data, pColInfoData->pData, pRowIndex, num, sizeof(int64_t));
+        break;
+      case sizeof(int32_t):
+        PARTITION_COPY_FIXED_ROWS(data, pColInfoData->pData, pRowIndex, num, sizeof(int32_t));
+        break;
+      case sizeof(int16_t):
+        PARTITION_COPY_FIXED_ROWS(data, pColInfoData->pData, pRowIndex, num, sizeof(int16_t));
+        break;
+      case sizeof(int8_t):
+        PARTITION_COPY_FIXED_ROWS(data, pColInfoData->pData, pRowIndex, num, sizeof(int8_t));
+        break;
+      default:
+        PARTITION_COPY_FIXED_ROWS(data, pColInfoData->pData, pRowIndex, num, bytes);
+        break;
+    }
 
-    int32_t* rows = (int32_t*)pPage;
-    if (*rows >= pInfo->rowCapacity) {
-      // release buffer
-      releaseBufPage(pInfo->pBuf, pPage);
+    for (int32_t k = 0; k < num; ++k) {
+      if (colDataIsNull_f(pColInfoData->nullbitmap, pRowIndex[k])) {
+        colDataSetNull_f(bitmap, numOfRows + k);
+      }
+    }
+
+    (*columnLen) += bytes * num;
+    ASSERT((data + bytes * num - (char*)pPage) <= getBufPageSize(pInfo->pBuf));
+  }
+}
+
+// The second pass: append the rows of each group to the pages of the group, column by column.
+static int32_t copyGroupRowsToPages(SOperatorInfo* pOperator, SSDataBlock* pBlock) {
+  SPartitionOperatorInfo* pInfo = pOperator->info;
+  SPartitionBlockGroup*   pGroups = TARRAY_GET_ELEM(pInfo->pBlockGroups, 0);
+  int32_t                 numOfGroups = taosArrayGetSize(pInfo->pBlockGroups);
+  size_t                  numOfCols = pOperator->exprSupp.numOfExprs;
+
+  for (int32_t g = 0; g < numOfGroups; ++g) {
+    const int32_t* pRowIndex = pInfo->pRowIndex + pGroups[g].start;
+    int32_t        remain = pGroups[g].numOfRows;
+
+    while (remain > 0) {
+      void* pPage = getDataGroupPage(pInfo, pGroups[g].pGroupInfo);
+      if (pPage == NULL) {
+        return terrno;
+      }
+
+      // number of rows
+      int32_t* rows = (int32_t*)pPage;
+      int32_t  num = TMIN(remain, pInfo->rowCapacity - (*rows));
+
+      for (int32_t i = 0; i < numOfCols; ++i) {
+        SExprInfo*       pExpr = &pOperator->exprSupp.pExprInfo[i];
+        int32_t          slotId = pExpr->base.pParam[0].pCol->slotId;
+        SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, slotId);
+        copyColumnToPage(pInfo, pPage, pInfo->columnOffset[i], pColInfoData, pRowIndex, num, *rows);
+      }
 
-      // add a new page for current group
-      int32_t pageId = 0;
-      pPage = getNewBufPage(pInfo->pBuf, &pageId);
-      taosArrayPush(p->pPageList, &pageId);
-      memset(pPage, 0, getBufPageSize(pInfo->pBuf));
+      (*rows) += num;
+      pRowIndex += num;
+      remain -= num;
+
+      setBufPageDirty(pPage, true);
+      releaseBufPage(pInfo->pBuf, pPage);
     }
   }
 
-  *pGroupInfo = p;
-  return pPage;
+  return TSDB_CODE_SUCCESS;
+}
+
+// Partition the data block in two passes instead of row by row: the group of each row is found first, and then the
+// rows of each group are copied column by column, which keeps the copy of a column in a tight loop over one source
+// column and one destination page.
+static void doHashPartition(SOperatorInfo* pOperator, SSDataBlock* pBlock) {
+  SPartitionOperatorInfo* pInfo = pOperator->info;
+
+  int32_t code = ensurePartitionRowIndex(pInfo, pBlock->info.rows);
+  if (code != TSDB_CODE_SUCCESS) {
+    terrno = code;
+    return;
+  }
+
+  taosArrayClear(pInfo->pBlockGroups);
+  code = assignRowsToGroups(pInfo, pBlock);
+  if (code == TSDB_CODE_SUCCESS) {
+    buildGroupRowIndex(pInfo, pBlock->info.rows);
+    code = copyGroupRowsToPages(pOperator, pBlock);
+  }
+
+  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pBlockGroups); ++i) {
+    SPartitionBlockGroup* pGroup = taosArrayGet(pInfo->pBlockGroups, i);
+    pGroup->pGroupInfo->blockGroupIndex = -1;
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    terrno = code;
+  }
 }
 
 uint64_t calcGroupId(char* pData, int32_t len) {
@@ -797,6 +956,10 @@ static void destroyPartitionOperatorInfo(void* param) {
   taosHashCleanup(pInfo->pGroupSet);
   taosMemoryFree(pInfo->columnOffset);
 
+  taosArrayDestroy(pInfo->pBlockGroups);
+  taosMemoryFree(pInfo->pRowGroup);
+  taosMemoryFree(pInfo->pRowIndex);
+
   cleanupExprSupp(&pInfo->scalarSup);
   destroyDiskbasedBuf(pInfo->pBuf);
   taosMemoryFreeClear(param);
@@ -829,6 +992,11 @@ SOperatorInfo* createPartitionOperatorInfo(SOperatorInfo* downstream, SPartition
     goto _error;
   }
 
+  pInfo->pBlockGroups = taosArrayInit(16, sizeof(SPartitionBlockGroup));
+  if (pInfo->pBlockGroups == NULL) {
+    goto _error;
+  }
+
   uint32_t defaultPgsz = 0;
   uint32_t defaultBufsz = 0;
 
@@ -75,6 +75,30 @@ static void extractTimeCondition(SJoinOperatorInfo* pInfo, SOperatorInfo** pDown
     ASSERT(false);
   }}
 
+// the on conditions and the where conditions are both applied to the joined rows
+static int32_t createJoinCondition(SNode* pOnConditions, SNode* pConditions, SNode** pCond) {
+  if (pOnConditions != NULL && pConditions != NULL) {
+    SLogicConditionNode* pLogicCond = (SLogicConditionNode*)nodesMakeNode(QUERY_NODE_LOGIC_CONDITION);
+    if (pLogicCond == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+
+    *pCond = (SNode*)pLogicCond;
+    pLogicCond->condType = LOGIC_COND_TYPE_AND;
+    if (nodesListMakeStrictAppend(&pLogicCond->pParameterList, nodesCloneNode(pOnConditions)) != TSDB_CODE_SUCCESS ||
+        nodesListMakeStrictAppend(&pLogicCond->pParameterList, nodesCloneNode(pConditions)) != TSDB_CODE_SUCCESS) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  } else if (pOnConditions != NULL) {
+    *pCond = nodesCloneNode(pOnConditions);
+  } else if (pConditions != NULL) {
+    *pCond = nodesCloneNode(pConditions);
+  } else {
+    *pCond = NULL;
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
 SOperatorInfo* createMergeJoinOperatorInfo(SOperatorInfo** pDownstream, int32_t numOfDownstream,
                                            SSortMergeJoinPhysiNode* pJoinNode, SExecTaskInfo* pTaskInfo) {
   SJoinOperatorInfo* pInfo = taosMemoryCalloc(1, sizeof(SJoinOperatorInfo));
@@ -99,29 +123,9 @@ SOperatorInfo* createMergeJoinOperatorInfo(SOperatorInfo** pDownstream, int32_t
 
   extractTimeCondition(pInfo, pDownstream, numOfDownstream, pJoinNode);
 
-  if (pJoinNode->pOnConditions != NULL && pJoinNode->node.pConditions != NULL) {
-    pInfo->pCondAfterMerge = nodesMakeNode(QUERY_NODE_LOGIC_CONDITION);
-    if (pInfo->pCondAfterMerge == NULL) {
-      code = TSDB_CODE_OUT_OF_MEMORY;
-      goto _error;
-    }
-
-    SLogicConditionNode* pLogicCond = (SLogicConditionNode*)(pInfo->pCondAfterMerge);
-    pLogicCond->pParameterList = nodesMakeList();
-    if (pLogicCond->pParameterList == NULL) {
-      code = TSDB_CODE_OUT_OF_MEMORY;
-      goto _error;
-    }
-
-    nodesListMakeAppend(&pLogicCond->pParameterList, nodesCloneNode(pJoinNode->pOnConditions));
-    nodesListMakeAppend(&pLogicCond->pParameterList, nodesCloneNode(pJoinNode->node.pConditions));
-    pLogicCond->condType = LOGIC_COND_TYPE_AND;
-  } else if (pJoinNode->pOnConditions != NULL) {
-    pInfo->pCondAfterMerge = nodesCloneNode(pJoinNode->pOnConditions);
-  } else if (pJoinNode->node.pConditions != NULL) {
-    pInfo->pCondAfterMerge = nodesCloneNode(pJoinNode->node.pConditions);
-  } else {
-    pInfo->pCondAfterMerge = NULL;
+  code = createJoinCondition(pJoinNode->pOnConditions, pJoinNode->node.pConditions, &pInfo->pCondAfterMerge);
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
   }
 
   code = filterInitFromNode(pInfo->pCondAfterMerge, &pOperator->exprSupp.pFilterInfo, 0);
@@ -430,3 +434,460 @@ SSDataBlock* doMergeJoin(struct SOperatorInfo* pOperator) {
   }
   return (pRes->info.rows > 0) ? pRes : NULL;
 }
+
+typedef struct SHJoinRowPos {
+  int32_t pageId;
+  int32_t offset;
+} SHJoinRowPos;
+
+// the build rows are kept in the paged buffer, the hash table only maps the join key to the latest row of the key,
+// and the rows of the same key are linked by the position stored in the row header:
+// | SHJoinRowPos next | null flag | col 0 | null flag | col 1 | ...
+typedef struct SHJoinRowHeader {
+  SHJoinRowPos next;
+} SHJoinRowHeader;
+
+typedef struct SHashJoinOperatorInfo {
+  SSDataBlock*   pRes;
+  int32_t        buildIdx;
+  int32_t        probeIdx;
+  SArray*        pBuildKeys;     // SColumnInfo, the key columns of the build side
+  SArray*        pProbeKeys;     // SColumnInfo, the key columns of the probe side
+  SArray*        pBuildCols;     // SColumnInfo, the build side columns kept in the build rows
+  int32_t*       pBuildColIndex; // the index of the build column for each output expr, -1 for the probe side
+  char**         pBuildColData;
+  char*          keyBuf;
+  int32_t        keyBufLen;
+  int32_t        rowSize;
+  SHashObj*      pHashTable;
+  SDiskbasedBuf* pBuf;
+  void*          pWritePage;
+  SHJoinRowPos   writePos;
+  void*          pReadPage;
+  int32_t        readPageId;
+  SSDataBlock*   pProbeBlock;
+  int32_t        probePos;
+  SHJoinRowPos   nextPos;
+  SNode*         pCondAfterJoin;
+} SHashJoinOperatorInfo;
+
+static SSDataBlock* doHashJoin(struct SOperatorInfo* pOperator);
+static void         destroyHashJoinOperator(void* param);
+
+static int32_t hashJoinInitKeys(SArray** pKeys, SNodeList* pKeyList, int32_t* pKeyLen) {
+  *pKeys = taosArrayInit(LIST_LENGTH(pKeyList), sizeof(SColumnInfo));
+  if (*pKeys == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  int32_t keyLen = 0;
+  SNode*  pNode = NULL;
+  FOREACH(pNode, pKeyList) {
+    SColumnInfo col = {0};
+    setJoinColumnInfo(&col, (SColumnNode*)pNode);
+    taosArrayPush(*pKeys, &col);
+    keyLen += col.bytes;
+  }
+
+  *pKeyLen = keyLen;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t hashJoinInitBuildCols(SHashJoinOperatorInfo* pInfo, SExprSupp* pSup, int32_t buildBlockId) {
+  pInfo->pBuildCols = taosArrayInit(pSup->numOfExprs, sizeof(SColumnInfo));
+  pInfo->pBuildColIndex = taosMemoryCalloc(pSup->numOfExprs, sizeof(int32_t));
+  pInfo->pBuildColData = taosMemoryCalloc(pSup->numOfExprs, POINTER_BYTES);
+  if (pInfo->pBuildCols == NULL || pInfo->pBuildColIndex == NULL || pInfo->pBuildColData == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pInfo->rowSize = sizeof(SHJoinRowHeader);
+  for (int32_t i = 0; i < pSup->numOfExprs; ++i) {
+    SColumn* pCol = pSup->pExprInfo[i].base.pParam[0].pCol;
+    if (pCol->dataBlockId != buildBlockId) {
+      pInfo->pBuildColIndex[i] = -1;
+      continue;
+    }
+
+    SColumnInfo col = {.slotId = pCol->slotId, .type = pCol->type, .bytes = pCol->bytes};
+    pInfo->pBuildColIndex[i] = taosArrayGetSize(pInfo->pBuildCols);
+    taosArrayPush(pInfo->pBuildCols, &col);
+    pInfo->rowSize += sizeof(int8_t) + col.bytes;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+SOperatorInfo* createHashJoinOperatorInfo(SOperatorInfo** pDownstream, int32_t numOfDownstream,
+                                          SHashJoinPhysiNode* pJoinNode, SExecTaskInfo* pTaskInfo) {
+  SHashJoinOperatorInfo* pInfo = taosMemoryCalloc(1, sizeof(SHashJoinOperatorInfo));
+  SOperatorInfo*         pOperator = taosMemoryCalloc(1, sizeof(SOperatorInfo));
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (pOperator == NULL || pInfo == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _error;
+  }
+
+  int32_t numOfCols = 0;
+  pInfo->pRes = createDataBlockFromDescNode(pJoinNode->node.pOutputDataBlockDesc);
+
+  SExprInfo* pExprInfo = createExprInfo(pJoinNode->pTargets, NULL, &numOfCols);
+  initResultSizeInfo(&pOperator->resultInfo, 4096);
+  blockDataEnsureCapacity(pInfo->pRes, pOperator->resultInfo.capacity);
+
+  setOperatorInfo(pOperator, "HashJoinOperator", QUERY_NODE_PHYSICAL_PLAN_HASH_JOIN, false, OP_NOT_OPENED, pInfo,
+                  pTaskInfo);
+  pOperator->exprSupp.pExprInfo = pExprInfo;
+  pOperator->exprSupp.numOfExprs = numOfCols;
+
+  pInfo->buildIdx = (pJoinNode->buildSide == 0) ? 0 : 1;
+  pInfo->probeIdx = 1 - pInfo->buildIdx;
+  pInfo->nextPos.pageId = -1;
+  pInfo->readPageId = -1;
+
+  int32_t probeKeyLen = 0;
+  code = hashJoinInitKeys(&pInfo->pBuildKeys, (0 == pInfo->buildIdx) ? pJoinNode->pLeftKeys : pJoinNode->pRightKeys,
+                          &pInfo->keyBufLen);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = hashJoinInitKeys(&pInfo->pProbeKeys, (0 == pInfo->buildIdx) ? pJoinNode->pRightKeys : pJoinNode->pLeftKeys,
+                            &probeKeyLen);
+  }
+  if (code == TSDB_CODE_SUCCESS) {
+    code = hashJoinInitBuildCols(pInfo, &pOperator->exprSupp, pDownstream[pInfo->buildIdx]->resultDataBlockId);
+  }
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  pInfo->keyBufLen = TMAX(pInfo->keyBufLen, probeKeyLen);
+  pInfo->keyBuf = taosMemoryCalloc(1, pInfo->keyBufLen);
+  pInfo->pHashTable = taosHashInit(4096, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
+  if (pInfo->keyBuf == NULL || pInfo->pHashTable == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _error;
+  }
+
+  if (!osTempSpaceAvailable()) {
+    code = TSDB_CODE_NO_AVAIL_DISK;
+    qError("Create hash join operator info failed since %s", tstrerror(code));
+    goto _error;
+  }
+
+  uint32_t defaultPgsz = 0;
+  uint32_t defaultBufsz = 0;
+  getBufferPgSize(pInfo->rowSize, &defaultPgsz, &defaultBufsz);
+  code = createDiskbasedBuf(&pInfo->pBuf, defaultPgsz, defaultBufsz, pTaskInfo->id.str, tsTempDir);
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  code = createJoinCondition(pJoinNode->pOnConditions, pJoinNode->node.pConditions, &pInfo->pCondAfterJoin);
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  code = filterInitFromNode(pInfo->pCondAfterJoin, &pOperator->exprSupp.pFilterInfo, 0);
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  pOperator->fpSet =
+      createOperatorFpSet(optrDummyOpenFn, doHashJoin, NULL, destroyHashJoinOperator, optrDefaultBufFn, NULL);
+  code = appendDownstream(pOperator, pDownstream, numOfDownstream);
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  return pOperator;
+
+_error:
+  if (pInfo != NULL) {
+    destroyHashJoinOperator(pInfo);
+  }
+
+  taosMemoryFree(pOperator);
+  pTaskInfo->code = code;
+  return NULL;
+}
+
+void destroyHashJoinOperator(void* param) {
+  SHashJoinOperatorInfo* pInfo = (SHashJoinOperatorInfo*)param;
+  nodesDestroyNode(pInfo->pCondAfterJoin);
+  taosArrayDestroy(pInfo->pBuildKeys);
+  taosArrayDestroy(pInfo->pProbeKeys);
+  taosArrayDestroy(pInfo->pBuildCols);
+  taosMemoryFree(pInfo->pBuildColIndex);
+  taosMemoryFree(pInfo->pBuildColData);
+  taosMemoryFree(pInfo->keyBuf);
+  taosHashCleanup(pInfo->pHashTable);
+  destroyDiskbasedBuf(pInfo->pBuf);
+
+  pInfo->pRes = blockDataDestroy(pInfo->pRes);
+  taosMemoryFreeClear(param);
+}
+
+// the key of a row is the concatenation of the key columns, rows with NULL key never match
+static bool hashJoinBuildKey(SHashJoinOperatorInfo* pInfo, SArray* pKeys, SSDataBlock* pBlock, int32_t rowIndex,
+                             int32_t* pKeyLen) {
+  char* p = pInfo->keyBuf;
+  for (int32_t i = 0; i < taosArrayGetSize(pKeys); ++i) {
+    SColumnInfo*     pKey = taosArrayGet(pKeys, i);
+    SColumnInfoData* pCol = taosArrayGet(pBlock->pDataBlock, pKey->slotId);
+    if (colDataIsNull_s(pCol, rowIndex)) {
+      return false;
+    }
+
+    char* pData = colDataGetData(pCol, rowIndex);
+    if (IS_VAR_DATA_TYPE(pKey->type)) {
+      varDataCopy(p, pData);
+      p += varDataTLen(pData);
+    } else {
+      memcpy(p, pData, pKey->bytes);
+      p += pKey->bytes;
+    }
+  }
+
+  *pKeyLen = (int32_t)(p - pInfo->keyBuf);
+  return true;
+}
+
+static int32_t hashJoinAddBuildRow(SHashJoinOperatorInfo* pInfo, SSDataBlock* pBlock, int32_t rowIndex,
+                                   int32_t keyLen) {
+  int32_t pageSize = getBufPageSize(pInfo->pBuf);
+  if (pInfo->pWritePage == NULL || pInfo->writePos.offset + pInfo->rowSize > pageSize) {
+    if (pInfo->pWritePage != NULL) {
+      setBufPageDirty(pInfo->pWritePage, true);
+      releaseBufPage(pInfo->pBuf, pInfo->pWritePage);
+    }
+
+    pInfo->pWritePage = getNewBufPage(pInfo->pBuf, &pInfo->writePos.pageId);
+    if (pInfo->pWritePage == NULL) {
+      return terrno;
+    }
+    pInfo->writePos.offset = 0;
+  }
+
+  SHJoinRowHeader* pHeader = (SHJoinRowHeader*)((char*)pInfo->pWritePage + pInfo->writePos.offset);
+  char*            p = (char*)pHeader + sizeof(SHJoinRowHeader);
+  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pBuildCols); ++i) {
+    SColumnInfo*     pColInfo = taosArrayGet(pInfo->pBuildCols, i);
+    SColumnInfoData* pCol = taosArrayGet(pBlock->pDataBlock, pColInfo->slotId);
+    if (colDataIsNull_s(pCol, rowIndex)) {
+      *(int8_t*)p = 1;
+      p += sizeof(int8_t);
+      continue;
+    }
+
+    *(int8_t*)p = 0;
+    p += sizeof(int8_t);
+
+    char* pData = colDataGetData(pCol, rowIndex);
+    if (IS_VAR_DATA_TYPE(pColInfo->type)) {
+      varDataCopy(p, pData);
+      p += varDataTLen(pData);
+    } else {
+      memcpy(p, pData, pColInfo->bytes);
+      p += pColInfo->bytes;
+    }
+  }
+
+  SHJoinRowPos* pHead = taosHashGet(pInfo->pHashTable, pInfo->keyBuf, keyLen);
+  if (pHead != NULL) {
+    pHeader->next = *pHead;
+    *pHead = pInfo->writePos;
+  } else {
+    pHeader->next.pageId = -1;
+    pHeader->next.offset = 0;
+    if (taosHashPut(pInfo->pHashTable, pInfo->keyBuf, keyLen, &pInfo->writePos, sizeof(SHJoinRowPos)) != 0) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+
+  pInfo->writePos.offset += (int32_t)(p - (char*)pHeader);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t hashJoinBuildHashTable(SOperatorInfo* pOperator) {
+  SHashJoinOperatorInfo* pInfo = pOperator->info;
+  SOperatorInfo*         pBuildOperator = pOperator->pDownstream[pInfo->buildIdx];
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  while (code == TSDB_CODE_SUCCESS) {
+    SSDataBlock* pBlock = pBuildOperator->fpSet.getNextFn(pBuildOperator);
+    if (pBlock == NULL) {
+      break;
+    }
+
+    for (int32_t i = 0; i < pBlock->info.rows && code == TSDB_CODE_SUCCESS; ++i) {
+      int32_t keyLen = 0;
+      if (hashJoinBuildKey(pInfo, pInfo->pBuildKeys, pBlock, i, &keyLen)) {
+        code = hashJoinAddBuildRow(pInfo, pBlock, i, keyLen);
+      }
+    }
+  }
+
+  if (pInfo->pWritePage != NULL) {
+    setBufPageDirty(pInfo->pWritePage, true);
+    releaseBufPage(pInfo->pBuf, pInfo->pWritePage);
+    pInfo->pWritePage = NULL;
+  }
+
+  return code;
+}
+
+static SHJoinRowHeader* hashJoinGetBuildRow(SHashJoinOperatorInfo* pInfo, SHJoinRowPos* pPos) {
+  if (pInfo->readPageId != pPos->pageId) {
+    if (pInfo->pReadPage != NULL) {
+      releaseBufPage(pInfo->pBuf, pInfo->pReadPage);
+    }
+
+    pInfo->pReadPage = getBufPage(pInfo->pBuf, pPos->pageId);
+    if (pInfo->pReadPage == NULL) {
+      pInfo->readPageId = -1;
+      return NULL;
+    }
+    pInfo->readPageId = pPos->pageId;
+  }
+
+  return (SHJoinRowHeader*)((char*)pInfo->pReadPage + pPos->offset);
+}
+
+static void hashJoinAppendRow(SOperatorInfo* pOperator, SHJoinRowHeader* pBuildRow, int32_t currRow) {
+  SHashJoinOperatorInfo* pInfo = pOperator->info;
+
+  char* p = (char*)pBuildRow + sizeof(SHJoinRowHeader);
+  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pBuildCols); ++i) {
+    SColumnInfo* pColInfo = taosArrayGet(pInfo->pBuildCols, i);
+    bool         isNull = (*(int8_t*)p == 1);
+    p += sizeof(int8_t);
+    if (isNull) {
+      pInfo->pBuildColData[i] = NULL;
+      continue;
+    }
+
+    pInfo->pBuildColData[i] = p;
+    p += IS_VAR_DATA_TYPE(pColInfo->type) ? varDataTLen(p) : pColInfo->bytes;
+  }
+
+  for (int32_t i = 0; i < pOperator->exprSupp.numOfExprs; ++i) {
+    SExprInfo*       pExprInfo = &pOperator->exprSupp.pExprInfo[i];
+    SColumnInfoData* pDst = taosArrayGet(pInfo->pRes->pDataBlock, pExprInfo->base.resSchema.slotId);
+
+    char* pData = NULL;
+    if (pInfo->pBuildColIndex[i] >= 0) {
+      pData = pInfo->pBuildColData[pInfo->pBuildColIndex[i]];
+    } else {
+      SColumnInfoData* pSrc = taosArrayGet(pInfo->pProbeBlock->pDataBlock, pExprInfo->base.pParam[0].pCol->slotId);
+      if (!colDataIsNull_s(pSrc, pInfo->probePos)) {
+        pData = colDataGetData(pSrc, pInfo->probePos);
+      }
+    }
+
+    if (pData == NULL) {
+      colDataAppendNULL(pDst, currRow);
+    } else {
+      colDataAppend(pDst, currRow, pData, false);
+    }
+  }
+}
+
+// probe the hash table with the rows of the probe side until the result block is full, the position in the probe
+// block and in the chain of the matched build rows are kept for the next call
+static int32_t doHashJoinImpl(SOperatorInfo* pOperator, SSDataBlock* pRes) {
+  SHashJoinOperatorInfo* pInfo = pOperator->info;
+  SOperatorInfo*         pProbeOperator = pOperator->pDownstream[pInfo->probeIdx];
+
+  int32_t nrows = pRes->info.rows;
+  while (nrows < pOperator->resultInfo.threshold) {
+    if (pInfo->nextPos.pageId != -1) {
+      SHJoinRowHeader* pBuildRow = hashJoinGetBuildRow(pInfo, &pInfo->nextPos);
+      if (pBuildRow == NULL) {
+        return terrno;
+      }
+
+      hashJoinAppendRow(pOperator, pBuildRow, nrows++);
+      pInfo->nextPos = pBuildRow->next;
+      if (pInfo->nextPos.pageId == -1) {
+        pInfo->probePos += 1;
+      }
+      continue;
+    }
+
+    if (pInfo->pProbeBlock == NULL || pInfo->probePos >= pInfo->pProbeBlock->info.rows) {
+      pInfo->pProbeBlock = pProbeOperator->fpSet.getNextFn(pProbeOperator);
+      pInfo->probePos = 0;
+      if (pInfo->pProbeBlock == NULL) {
+        setOperatorCompleted(pOperator);
+        break;
+      }
+      continue;
+    }
+
+    int32_t       keyLen = 0;
+    SHJoinRowPos* pHead = NULL;
+    if (hashJoinBuildKey(pInfo, pInfo->pProbeKeys, pInfo->pProbeBlock, pInfo->probePos, &keyLen)) {
+      pHead = taosHashGet(pInfo->pHashTable, pInfo->keyBuf, keyLen);
+    }
+
+    if (pHead != NULL) {
+      pInfo->nextPos = *pHead;
+    } else {
+      pInfo->probePos += 1;
+    }
+  }
+
+  pRes->info.rows = nrows;
+  pRes->info.dataLoad = 1;
+  return TSDB_CODE_SUCCESS;
+}
+
+SSDataBlock* doHashJoin(struct SOperatorInfo* pOperator) {
+  SHashJoinOperatorInfo* pInfo = pOperator->info;
+  SExecTaskInfo*         pTaskInfo = pOperator->pTaskInfo;
+
+  if (pOperator->status == OP_EXEC_DONE) {
+    return NULL;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (pOperator->status == OP_NOT_OPENED) {
+    int64_t st = taosGetTimestampUs();
+    code = hashJoinBuildHashTable(pOperator);
+    if (code != TSDB_CODE_SUCCESS) {
+      T_LONG_JMP(pTaskInfo->env, code);
+    }
+
+    pOperator->cost.openCost = (taosGetTimestampUs() - st) / 1000.0;
+    pOperator->status = OP_RES_TO_RETURN;
+    if (taosHashGetSize(pInfo->pHashTable) == 0) {
+      setOperatorCompleted(pOperator);
+      return NULL;
+    }
+  }
+
+  SSDataBlock* pRes = pInfo->pRes;
+  blockDataCleanup(pRes);
+
+  while (pOperator->status != OP_EXEC_DONE) {
+    code = doHashJoinImpl(pOperator, pRes);
+    if (code != TSDB_CODE_SUCCESS) {
+      T_LONG_JMP(pTaskInfo->env, code);
+    }
+
+    if (pOperator->exprSupp.pFilterInfo != NULL) {
+      doFilter(pRes, pOperator->exprSupp.pFilterInfo, NULL);
+    }
+    if (pRes->info.rows >= pOperator->resultInfo.threshold) {
+      break;
+    }
+  }
+
+  if (pInfo->pReadPage != NULL) {
+    releaseBufPage(pInfo->pBuf, pInfo->pReadPage);
+    pInfo->pReadPage = NULL;
+    pInfo->readPageId = -1;
+  }
+
+  return (pRes->info.rows > 0) ? pRes : NULL;
+}
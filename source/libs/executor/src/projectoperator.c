@@ -719,6 +719,20 @@ int32_t projectApplyFunctions(SExprInfo* pExpr, SSDataBlock* pResult, SSDataBloc
         }
       }
 
+      numOfRows = pSrcBlock->info.rows;
+    } else if (pExpr[k].pExpr->nodeType == QUERY_NODE_OPERATOR && pExpr[k].pExpr->_optrRoot.pProgram != NULL) {
+      // the result is computed into the output column directly
+      SColumnInfoData* pResColData = taosArrayGet(pResult->pDataBlock, outputSlotId);
+      int32_t          startOffset = createNewColModel ? 0 : pResult->info.rows;
+
+      int32_t code = blockDataEnsureCapacity(pResult, startOffset + pSrcBlock->info.rows);
+      if (code == TSDB_CODE_SUCCESS) {
+        code = scalarExecute(pExpr[k].pExpr->_optrRoot.pProgram, pSrcBlock, pResColData, startOffset);
+      }
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+
       numOfRows = pSrcBlock->info.rows;
     } else if (pExpr[k].pExpr->nodeType == QUERY_NODE_OPERATOR) {
       SArray* pBlockList = taosArrayInit(4, POINTER_BYTES);
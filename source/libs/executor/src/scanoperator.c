@@ -313,8 +313,12 @@ static int32_t loadDataBlock(SOperatorInfo* pOperator, STableScanBase* pTableSca
 
   bool loadSMA = false;
   *status = pTableScanInfo->dataBlockLoadFlag;
-  if (pOperator->exprSupp.pFilterInfo != NULL ||
-      overlapWithTimeWindow(&pTableScanInfo->pdInfo.interval, &pBlock->info, pTableScanInfo->cond.order)) {
+
+  // the SMA of a block is consumed by the upstream interval operator only if the block lies within a single window,
+  // the blocks across the window border are loaded, and split by rows.
+  if (*status != FUNC_DATA_REQUIRED_DATA_LOAD &&
+      (pOperator->exprSupp.pFilterInfo != NULL ||
+       overlapWithTimeWindow(&pTableScanInfo->pdInfo.interval, &pBlock->info, pTableScanInfo->cond.order))) {
     (*status) = FUNC_DATA_REQUIRED_DATA_LOAD;
   }
 
@@ -35,7 +35,6 @@ static int32_t      getExplainExecInfo(SOperatorInfo* pOptr, void** pOptrExplain
 
 static void destroySortOperatorInfo(void* param);
 
-// todo add limit/offset impl
 SOperatorInfo* createSortOperatorInfo(SOperatorInfo* downstream, SSortPhysiNode* pSortNode, SExecTaskInfo* pTaskInfo) {
   SSortOperatorInfo* pInfo = taosMemoryCalloc(1, sizeof(SSortOperatorInfo));
   SOperatorInfo*     pOperator = taosMemoryCalloc(1, sizeof(SOperatorInfo));
@@ -187,6 +186,12 @@ int32_t doOpenSortOperator(SOperatorInfo* pOperator) {
 
   tsortSetFetchRawDataFp(pInfo->pSortHandle, loadNextDataBlock, applyScalarFunction, pOperator);
 
+  // the filter is applied to the sorted rows, so the first offset + limit rows are enough only without it
+  SLimit* pLimit = &pInfo->limitInfo.limit;
+  if (pOperator->exprSupp.pFilterInfo == NULL && pLimit->limit > 0) {
+    tsortSetMaxRows(pInfo->pSortHandle, pLimit->limit + pLimit->offset);
+  }
+
   SSortSource* ps = taosMemoryCalloc(1, sizeof(SSortSource));
   ps->param = pOperator->pDownstream[0];
   ps->onlyRef = true;
@@ -65,6 +65,7 @@ typedef struct SSysTableScanInfo {
   SSDataBlock*           pRes;
   int64_t                numOfBlocks;  // extract basic running information.
   SLoadRemoteDataInfo    loadInfo;
+  SLimitInfo             limitInfo;
 } SSysTableScanInfo;
 
 typedef struct {
@@ -141,6 +142,12 @@ static int32_t sysTableUserTagsFillOneTableTags(const SSysTableScanInfo* pInfo,
 static void relocateAndFilterSysTagsScanResult(SSysTableScanInfo* pInfo, int32_t numOfRows, SSDataBlock* dataBlock,
                                                SFilterInfo* pFilterInfo);
 
+static void sysFilteGetTableName(SValueNode* pVal, char* name) {
+  int32_t len = TMIN(varDataLen(pVal->datum.p), TSDB_TABLE_NAME_LEN - 1);
+  memcpy(name, varDataVal(pVal->datum.p), len);
+  name[len] = 0;
+}
+
 int32_t sysFilte__DbName(void* arg, SNode* pNode, SArray* result) {
   void* pVnode = ((SSTabFltArg*)arg)->pVnode;
 
@@ -192,18 +199,18 @@ int32_t sysFilte__TableName(void* arg, SNode* pNode, SArray* result) {
 
   SOperatorNode* pOper = (SOperatorNode*)pNode;
   SValueNode*    pVal = (SValueNode*)pOper->pRight;
-  bool           reverse = false;
 
-  __optSysFilter func = optSysGetFilterFunc(pOper->opType, &reverse);
-  if (func == NULL) return -1;
+  // only the equal condition can be resolved by the name index
+  if (pOper->opType != OP_TYPE_EQUAL) return -1;
 
-  SMetaFltParam param = {.suid = 0,
-      .cid = 0,
-      .type = TSDB_DATA_TYPE_VARCHAR,
-      .val = pVal->datum.p,
-      .reverse = reverse,
-      .filterFunc = func};
-  return -1;
+  char name[TSDB_TABLE_NAME_LEN] = {0};
+  sysFilteGetTableName(pVal, name);
+
+  tb_uid_t uid = metaGetTableEntryUidByName(pMeta, name);
+  if (uid != 0) {
+    taosArrayPush(result, &uid);
+  }
+  return 0;
 }
 
 int32_t sysFilte__CreateTime(void* arg, SNode* pNode, SArray* result) {
@@ -253,14 +260,22 @@ int32_t sysFilte__Ttl(void* arg, SNode* pNode, SArray* result) {
 
 int32_t sysFilte__STableName(void* arg, SNode* pNode, SArray* result) {
   void* pMeta = ((SSTabFltArg*)arg)->pMeta;
+  void* pVnode = ((SSTabFltArg*)arg)->pVnode;
 
   SOperatorNode* pOper = (SOperatorNode*)pNode;
   SValueNode*    pVal = (SValueNode*)pOper->pRight;
-  bool           reverse = false;
 
-  __optSysFilter func = optSysGetFilterFunc(pOper->opType, &reverse);
-  if (func == NULL) return -1;
-  return -1;
+  // resolve the super table by the name index, and then its child tables by the ctb index
+  if (pOper->opType != OP_TYPE_EQUAL) return -1;
+
+  char name[TSDB_TABLE_NAME_LEN] = {0};
+  sysFilteGetTableName(pVal, name);
+
+  tb_uid_t suid = metaGetTableEntryUidByName(pMeta, name);
+  if (suid != 0) {
+    vnodeGetCtbIdList(pVnode, suid, result);
+  }
+  return 0;
 }
 
 int32_t sysFilte__Uid(void* arg, SNode* pNode, SArray* result) {
@@ -365,45 +380,96 @@ __optSysFilter optSysGetFilterFunc(int32_t ctype, bool* reverse) {
   return NULL;
 }
 
-static bool sysTableIsOperatorCondOnOneTable(SNode* pCond, char* condTable) {
-  SOperatorNode* node = (SOperatorNode*)pCond;
-  if (node->opType == OP_TYPE_EQUAL) {
-    if (nodeType(node->pLeft) == QUERY_NODE_COLUMN &&
-        strcasecmp(nodesGetNameFromColumnNode(node->pLeft), "table_name") == 0 &&
-        nodeType(node->pRight) == QUERY_NODE_VALUE) {
-      SValueNode* pValue = (SValueNode*)node->pRight;
-      if (pValue->node.resType.type == TSDB_DATA_TYPE_NCHAR || pValue->node.resType.type == TSDB_DATA_TYPE_VARCHAR ||
-          pValue->node.resType.type == TSDB_DATA_TYPE_BINARY) {
-        char* value = nodesGetValueFromNode(pValue);
-        strncpy(condTable, varDataVal(value), TSDB_TABLE_NAME_LEN);
-        return true;
-      }
-    }
+// Build the uid list of the qualified tables by the meta indexes, see optSysTabFilte for the return value.
+static int32_t sysTableBuildIdx(SOperatorInfo* pOperator) {
+  SExecTaskInfo*     pTaskInfo = pOperator->pTaskInfo;
+  SSysTableScanInfo* pInfo = pOperator->info;
+  SSTabFltArg        arg = {.pMeta = pInfo->readHandle.meta, .pVnode = pInfo->readHandle.vnode};
+
+  SSysTableIndex* idx = taosMemoryMalloc(sizeof(SSysTableIndex));
+  idx->init = 0;
+  idx->uids = taosArrayInit(128, sizeof(int64_t));
+  idx->lastIdx = 0;
+
+  pInfo->pIdx = idx;  // set idx arg
+
+  int64_t st = taosGetTimestampUs();
+  int32_t flt = optSysTabFilte(&arg, pInfo->pCondition, idx->uids);
+  if (flt == 0) {
+    idx->init = 1;
   }
-  return false;
+
+  qDebug("%s build sys table idx, code:%d, tables:%d, elapsed time:%.2f ms", GET_TASKID(pTaskInfo), flt,
+         (int32_t)taosArrayGetSize(idx->uids), (taosGetTimestampUs() - st) / 1000.0);
+  return flt;
 }
 
-static bool sysTableIsCondOnOneTable(SNode* pCond, char* condTable) {
-  if (pCond == NULL) {
-    return false;
-  }
-  if (nodeType(pCond) == QUERY_NODE_LOGIC_CONDITION) {
-    SLogicConditionNode* node = (SLogicConditionNode*)pCond;
-    if (LOGIC_COND_TYPE_AND == node->condType) {
-      SNode* pChild = NULL;
-      FOREACH(pChild, node->pParameterList) {
-        if (QUERY_NODE_OPERATOR == nodeType(pChild) && sysTableIsOperatorCondOnOneTable(pChild, condTable)) {
-          return true;
-        }
+static void sysTableScanUserTagsByUids(SOperatorInfo* pOperator, const char* dbname, SSDataBlock* dataBlock) {
+  SExecTaskInfo*     pTaskInfo = pOperator->pTaskInfo;
+  SSysTableScanInfo* pInfo = pOperator->info;
+  SSysTableIndex*    pIdx = pInfo->pIdx;
+  int32_t            numOfRows = 0;
+
+  // the super table is kept across the child tables, which usually share the same one
+  SMetaReader smrSuperTable = {0};
+  metaReaderInit(&smrSuperTable, pInfo->readHandle.meta, META_READER_NOLOCK);
+
+  int32_t i = pIdx->lastIdx;
+  for (; i < taosArrayGetSize(pIdx->uids); i++) {
+    tb_uid_t* uid = taosArrayGet(pIdx->uids, i);
+
+    SMetaReader smrChildTable = {0};
+    metaReaderInit(&smrChildTable, pInfo->readHandle.meta, 0);
+    int32_t code = metaGetTableEntryByUid(&smrChildTable, *uid);
+    if (code != TSDB_CODE_SUCCESS || smrChildTable.me.type != TSDB_CHILD_TABLE) {
+      metaReaderClear(&smrChildTable);
+      continue;
+    }
+
+    uint64_t suid = smrChildTable.me.ctbEntry.suid;
+    if (smrSuperTable.me.uid != suid) {
+      metaReaderClear(&smrSuperTable);
+      metaReaderInit(&smrSuperTable, pInfo->readHandle.meta, META_READER_NOLOCK);
+      code = metaGetTableEntryByUid(&smrSuperTable, suid);
+      if (code != TSDB_CODE_SUCCESS) {
+        qError("failed to get super table meta, uid:0x%" PRIx64 ", code:%s, %s", suid, tstrerror(terrno),
+               GET_TASKID(pTaskInfo));
+        metaReaderClear(&smrSuperTable);
+        metaReaderClear(&smrChildTable);
+        blockDataDestroy(dataBlock);
+        T_LONG_JMP(pTaskInfo->env, terrno);
+      }
+    }
+
+    char tableName[TSDB_TABLE_NAME_LEN + VARSTR_HEADER_SIZE] = {0};
+    STR_TO_VARSTR(tableName, smrChildTable.me.name);
+
+    sysTableUserTagsFillOneTableTags(pInfo, &smrSuperTable, &smrChildTable, dbname, tableName, &numOfRows, dataBlock);
+    metaReaderClear(&smrChildTable);
+
+    // no room left for the tags of next table
+    if (numOfRows + TSDB_MAX_TAGS > pOperator->resultInfo.capacity) {
+      relocateAndFilterSysTagsScanResult(pInfo, numOfRows, dataBlock, pOperator->exprSupp.pFilterInfo);
+      numOfRows = 0;
+
+      if (pInfo->pRes->info.rows > 0) {
+        break;
       }
     }
   }
 
-  if (QUERY_NODE_OPERATOR == nodeType(pCond)) {
-    return sysTableIsOperatorCondOnOneTable(pCond, condTable);
+  metaReaderClear(&smrSuperTable);
+
+  if (numOfRows > 0) {
+    relocateAndFilterSysTagsScanResult(pInfo, numOfRows, dataBlock, pOperator->exprSupp.pFilterInfo);
+    numOfRows = 0;
   }
 
-  return false;
+  if (i >= taosArrayGetSize(pIdx->uids)) {
+    setOperatorCompleted(pOperator);
+  } else {
+    pIdx->lastIdx = i + 1;
+  }
 }
 
 static SSDataBlock* sysTableScanUserTags(SOperatorInfo* pOperator) {
@@ -413,6 +479,12 @@ static SSDataBlock* sysTableScanUserTags(SOperatorInfo* pOperator) {
     return NULL;
   }
 
+  if (pInfo->pCondition != NULL && pInfo->pIdx == NULL && sysTableBuildIdx(pOperator) == -2) {
+    qDebug("%s no qualified table in current vnode by idx, empty result", GET_TASKID(pTaskInfo));
+    setOperatorCompleted(pOperator);
+    return NULL;
+  }
+
   blockDataCleanup(pInfo->pRes);
   int32_t numOfRows = 0;
 
@@ -430,52 +502,11 @@ static SSDataBlock* sysTableScanUserTags(SOperatorInfo* pOperator) {
   tNameGetDbName(&sn, varDataVal(dbname));
   varDataSetLen(dbname, strlen(varDataVal(dbname)));
 
-  char condTableName[TSDB_TABLE_NAME_LEN] = {0};
-  // optimize when sql like where table_name='tablename' and xxx.
-  if (pInfo->pCondition && sysTableIsCondOnOneTable(pInfo->pCondition, condTableName)) {
-    char tableName[TSDB_TABLE_NAME_LEN + VARSTR_HEADER_SIZE] = {0};
-    STR_TO_VARSTR(tableName, condTableName);
-
-    SMetaReader smrChildTable = {0};
-    metaReaderInit(&smrChildTable, pInfo->readHandle.meta, 0);
-    int32_t code = metaGetTableEntryByName(&smrChildTable, condTableName);
-    if (code != TSDB_CODE_SUCCESS) {
-      // terrno has been set by metaGetTableEntryByName, therefore, return directly
-      metaReaderClear(&smrChildTable);
-      blockDataDestroy(dataBlock);
-      pInfo->loadInfo.totalRows = 0;
-      return NULL;
-    }
-
-    if (smrChildTable.me.type != TSDB_CHILD_TABLE) {
-      metaReaderClear(&smrChildTable);
-      blockDataDestroy(dataBlock);
-      pInfo->loadInfo.totalRows = 0;
-      return NULL;
-    }
-
-    SMetaReader smrSuperTable = {0};
-    metaReaderInit(&smrSuperTable, pInfo->readHandle.meta, META_READER_NOLOCK);
-    code = metaGetTableEntryByUid(&smrSuperTable, smrChildTable.me.ctbEntry.suid);
-    if (code != TSDB_CODE_SUCCESS) {
-      // terrno has been set by metaGetTableEntryByUid
-      metaReaderClear(&smrSuperTable);
-      metaReaderClear(&smrChildTable);
-      blockDataDestroy(dataBlock);
-      return NULL;
-    }
-
-    sysTableUserTagsFillOneTableTags(pInfo, &smrSuperTable, &smrChildTable, dbname, tableName, &numOfRows, dataBlock);
-    metaReaderClear(&smrSuperTable);
-    metaReaderClear(&smrChildTable);
-
-    if (numOfRows > 0) {
-      relocateAndFilterSysTagsScanResult(pInfo, numOfRows, dataBlock, pOperator->exprSupp.pFilterInfo);
-      numOfRows = 0;
-    }
+  // the qualified child tables are resolved by the name/ctb index, e.g. where table_name='t1' or stable_name='st1'
+  if (pInfo->pIdx != NULL && pInfo->pIdx->init == 1) {
+    sysTableScanUserTagsByUids(pOperator, dbname, dataBlock);
     blockDataDestroy(dataBlock);
     pInfo->loadInfo.totalRows += pInfo->pRes->info.rows;
-    setOperatorCompleted(pOperator);
     return (pInfo->pRes->info.rows == 0) ? NULL : pInfo->pRes;
   }
 
@@ -509,7 +540,8 @@ static SSDataBlock* sysTableScanUserTags(SOperatorInfo* pOperator) {
 
     metaReaderClear(&smrSuperTable);
 
-    if (numOfRows >= pOperator->resultInfo.capacity) {
+    // no room left for the tags of next table
+    if (numOfRows + TSDB_MAX_TAGS > pOperator->resultInfo.capacity) {
       relocateAndFilterSysTagsScanResult(pInfo, numOfRows, dataBlock, pOperator->exprSupp.pFilterInfo);
       numOfRows = 0;
 
@@ -841,7 +873,7 @@ static SSDataBlock* sysTableBuildUserTablesByUids(SOperatorInfo* pOperator) {
     SMetaReader mr = {0};
     metaReaderInit(&mr, pInfo->readHandle.meta, 0);
     ret = metaGetTableEntryByUid(&mr, *uid);
-    if (ret < 0) {
+    if (ret < 0 || (mr.me.type != TSDB_CHILD_TABLE && mr.me.type != TSDB_NORMAL_TABLE)) {
       metaReaderClear(&mr);
       continue;
     }
@@ -872,10 +904,11 @@ static SSDataBlock* sysTableBuildUserTablesByUids(SOperatorInfo* pOperator) {
       int64_t suid = mr.me.ctbEntry.suid;
       int32_t code = metaGetTableEntryByUid(&mr1, suid);
       if (code != TSDB_CODE_SUCCESS) {
-        qError("failed to get super table meta, cname:%s, suid:0x%" PRIx64 ", code:%s, %s", pInfo->pCur->mr.me.name,
-               suid, tstrerror(terrno), GET_TASKID(pTaskInfo));
+        qError("failed to get super table meta, cname:%s, suid:0x%" PRIx64 ", code:%s, %s", mr.me.name, suid,
+               tstrerror(terrno), GET_TASKID(pTaskInfo));
         metaReaderClear(&mr1);
         metaReaderClear(&mr);
+        blockDataDestroy(p);
         T_LONG_JMP(pTaskInfo->env, terrno);
       }
       pColInfoData = taosArrayGet(p->pDataBlock, 3);
@@ -914,11 +947,11 @@ static SSDataBlock* sysTableBuildUserTablesByUids(SOperatorInfo* pOperator) {
     } else if (tableType == TSDB_NORMAL_TABLE) {
       // create time
       pColInfoData = taosArrayGet(p->pDataBlock, 2);
-      colDataAppend(pColInfoData, numOfRows, (char*)&pInfo->pCur->mr.me.ntbEntry.ctime, false);
+      colDataAppend(pColInfoData, numOfRows, (char*)&mr.me.ntbEntry.ctime, false);
 
       // number of columns
       pColInfoData = taosArrayGet(p->pDataBlock, 3);
-      colDataAppend(pColInfoData, numOfRows, (char*)&pInfo->pCur->mr.me.ntbEntry.schemaRow.nCols, false);
+      colDataAppend(pColInfoData, numOfRows, (char*)&mr.me.ntbEntry.schemaRow.nCols, false);
 
       // super table name
       pColInfoData = taosArrayGet(p->pDataBlock, 4);
@@ -1190,32 +1223,21 @@ static SSDataBlock* sysTableScanUserTables(SOperatorInfo* pOperator) {
     setOperatorCompleted(pOperator);
     return (pInfo->pRes->info.rows == 0) ? NULL : pInfo->pRes;
   } else {
-    if (pInfo->showRewrite == false) {
-      if (pCondition != NULL && pInfo->pIdx == NULL) {
-        SSTabFltArg arg = {.pMeta = pInfo->readHandle.meta, .pVnode = pInfo->readHandle.vnode};
-
-        SSysTableIndex* idx = taosMemoryMalloc(sizeof(SSysTableIndex));
-        idx->init = 0;
-        idx->uids = taosArrayInit(128, sizeof(int64_t));
-        idx->lastIdx = 0;
-
-        pInfo->pIdx = idx;  // set idx arg
-
-        int flt = optSysTabFilte(&arg, pCondition, idx->uids);
-        if (flt == 0) {
-          pInfo->pIdx->init = 1;
-          SSDataBlock* blk = sysTableBuildUserTablesByUids(pOperator);
-          return blk;
-        } else if (flt == -2) {
-          qDebug("%s failed to get sys table info by idx, empty result", GET_TASKID(pTaskInfo));
+    if (pInfo->showRewrite == false && pCondition != NULL) {
+      if (pInfo->pIdx == NULL) {
+        int32_t flt = sysTableBuildIdx(pOperator);
+        if (flt == -2) {
+          qDebug("%s no qualified table in current vnode by idx, empty result", GET_TASKID(pTaskInfo));
+          setOperatorCompleted(pOperator);
           return NULL;
         } else if (flt == -1) {
           // not idx
           qDebug("%s failed to get sys table info by idx, scan sys table one by one", GET_TASKID(pTaskInfo));
         }
-      } else if (pCondition != NULL && (pInfo->pIdx != NULL && pInfo->pIdx->init == 1)) {
-        SSDataBlock* blk = sysTableBuildUserTablesByUids(pOperator);
-        return blk;
+      }
+
+      if (pInfo->pIdx->init == 1) {
+        return sysTableBuildUserTablesByUids(pOperator);
       }
     }
 
@@ -1298,6 +1320,45 @@ static void getDBNameFromCondition(SNode* pCondition, const char* dbName) {
   nodesWalkExpr(pCondition, getDBNameFromConditionWalker, (char*)dbName);
 }
 
+// Scan the system table from the meta store of current vnode, and stop the scan as soon as the limit is reached, since
+// the upstream operators do not need more rows.
+static SSDataBlock* sysTableScanLocal(SOperatorInfo* pOperator, __optr_fn_t fp) {
+  SExecTaskInfo*     pTaskInfo = pOperator->pTaskInfo;
+  SSysTableScanInfo* pInfo = pOperator->info;
+  if (pOperator->status == OP_EXEC_DONE) {
+    return NULL;
+  }
+
+  int64_t      st = taosGetTimestampUs();
+  SSDataBlock* pBlock = NULL;
+  while (pOperator->status != OP_EXEC_DONE) {
+    pBlock = fp(pOperator);
+    if (pBlock == NULL) {
+      break;
+    }
+
+    int32_t rows = pBlock->info.rows;
+    applyLimitOffset(&pInfo->limitInfo, pBlock, pTaskInfo, pOperator);
+    pInfo->limitInfo.numOfOutputRows += pBlock->info.rows;
+    pInfo->loadInfo.totalRows -= (rows - pBlock->info.rows);
+    if (pBlock->info.rows > 0) {
+      break;
+    }
+    pBlock = NULL;
+  }
+
+  pInfo->numOfBlocks += (pBlock != NULL);
+  pInfo->loadInfo.totalElapsed += (taosGetTimestampUs() - st);
+  if (pOperator->status == OP_EXEC_DONE) {
+    qDebug("%s scan sys table:%s completed, by idx:%d, blocks:%" PRId64 ", totalRows:%" PRIu64
+           ", elapsed time:%.2f ms",
+           GET_TASKID(pTaskInfo), tNameGetTableName(&pInfo->name), (pInfo->pIdx != NULL && pInfo->pIdx->init == 1),
+           pInfo->numOfBlocks, pInfo->loadInfo.totalRows, pInfo->loadInfo.totalElapsed / 1000.0);
+  }
+
+  return pBlock;
+}
+
 static SSDataBlock* doSysTableScan(SOperatorInfo* pOperator) {
   // build message and send to mnode to fetch the content of system tables.
   SExecTaskInfo*     pTaskInfo = pOperator->pTaskInfo;
@@ -1311,9 +1372,9 @@ static SSDataBlock* doSysTableScan(SOperatorInfo* pOperator) {
   }
 
   if (strncasecmp(name, TSDB_INS_TABLE_TABLES, TSDB_TABLE_FNAME_LEN) == 0) {
-    return sysTableScanUserTables(pOperator);
+    return sysTableScanLocal(pOperator, sysTableScanUserTables);
   } else if (strncasecmp(name, TSDB_INS_TABLE_TAGS, TSDB_TABLE_FNAME_LEN) == 0) {
-    return sysTableScanUserTags(pOperator);
+    return sysTableScanLocal(pOperator, sysTableScanUserTags);
   } else if (strncasecmp(name, TSDB_INS_TABLE_STABLES, TSDB_TABLE_FNAME_LEN) == 0 && pInfo->showRewrite &&
              IS_SYS_DBNAME(dbName)) {
     return sysTableScanUserSTables(pOperator);
@@ -1421,6 +1482,7 @@ SOperatorInfo* createSysTableScanOperatorInfo(void* readHandle, SSystemTableScan
 
   initResultSizeInfo(&pOperator->resultInfo, 4096);
   blockDataEnsureCapacity(pInfo->pRes, pOperator->resultInfo.capacity);
+  initLimitInfo(pScanNode->node.pLimit, pScanNode->node.pSlimit, &pInfo->limitInfo);
 
   tNameAssign(&pInfo->name, &pScanNode->tableName);
   const char* name = tNameGetTableName(&pInfo->name);
@@ -1704,16 +1766,14 @@ static int32_t optSysSpecialColumn(SNode* cond) {
   return 0;
 }
 
+// Resolve the conditions into the uid list of the qualified tables by the meta indexes. Returns 0 if the uid list is
+// built, -1 if the meta store needs to be scanned one by one, and -2 if no table in current vnode is qualified.
 static int32_t optSysTabFilte(void* arg, SNode* cond, SArray* result) {
   int ret = -1;
   if (nodeType(cond) == QUERY_NODE_OPERATOR) {
     ret = optSysTabFilteImpl(arg, cond, result);
-    if (ret == 0) {
-      SOperatorNode* pOper = (SOperatorNode*)cond;
-      SColumnNode*   pCol = (SColumnNode*)pOper->pLeft;
-      if (0 == strcmp(pCol->colName, "create_time")) {
-        return 0;
-      }
+    if (ret == 0 && optSysSpecialColumn(cond) != 0) {
+      // db_name/vgroup_id matches current vnode, all tables are qualified
       return -1;
     }
     return ret;
@@ -1728,7 +1788,6 @@ static int32_t optSysTabFilte(void* arg, SNode* cond, SArray* result) {
 
   int32_t len = LIST_LENGTH(pList);
 
-  bool    hasIdx = false;
   bool    hasRslt = true;
   SArray* mRslt = taosArrayInit(len, POINTER_BYTES);
 
@@ -1739,26 +1798,22 @@ static int32_t optSysTabFilte(void* arg, SNode* cond, SArray* result) {
     SArray* aRslt = taosArrayInit(16, sizeof(int64_t));
 
     ret = optSysTabFilteImpl(arg, cell->pNode, aRslt);
-    if (ret == 0) {
+    if (ret == 0 && optSysSpecialColumn(cell->pNode) == 0) {
       // has index
-      hasIdx = true;
-      if (optSysSpecialColumn(cell->pNode) == 0) {
-        taosArrayPush(mRslt, &aRslt);
-      } else {
-        // db_name/vgroup not result
-        taosArrayDestroy(aRslt);
-      }
+      taosArrayPush(mRslt, &aRslt);
     } else if (ret == -2) {
       // current vg
-      hasIdx = true;
       hasRslt = false;
       taosArrayDestroy(aRslt);
       break;
     } else {
+      // db_name/vgroup not result
       taosArrayDestroy(aRslt);
     }
     cell = cell->pNext;
   }
+
+  bool hasIdx = taosArrayGetSize(mRslt) > 0;
   if (hasRslt && hasIdx) {
     optSysMergeRslt(mRslt, result);
   }
@@ -1771,20 +1826,7 @@ static int32_t optSysTabFilte(void* arg, SNode* cond, SArray* result) {
   if (hasRslt == false) {
     return -2;
   }
-  if (hasRslt && hasIdx) {
-    cell = pList->pHead;
-    for (int i = 0; i < len; i++) {
-      if (cell == NULL) break;
-      SOperatorNode* pOper = (SOperatorNode*)cell->pNode;
-      SColumnNode*   pCol = (SColumnNode*)pOper->pLeft;
-      if (0 == strcmp(pCol->colName, "create_time")) {
-        return 0;
-      }
-      cell = cell->pNext;
-    }
-    return -1;
-  }
-  return -1;
+  return hasIdx ? 0 : -1;
 }
 
 static int32_t doGetTableRowSize(void* pMeta, uint64_t uid, int32_t* rowLen, const char* idstr) {
@@ -1845,8 +1887,18 @@ static SSDataBlock* doBlockInfoScan(SOperatorInfo* pOperator) {
     T_LONG_JMP(pTaskInfo->env, code);
   }
 
-  tsdbGetFileBlocksDistInfo(pBlockScanInfo->pHandle, &blockDistInfo);
-  blockDistInfo.numOfInmemRows = (int32_t)tsdbGetNumOfRowsInMemTable(pBlockScanInfo->pHandle);
+  if (pBlockScanInfo->pHandle == NULL) {
+    int64_t st = taosGetTimestampUs();
+    code = vnodeGetStbBlockDistInfo(pBlockScanInfo->readHandle.vnode, pBlockScanInfo->uid, &blockDistInfo);
+    if (code != TSDB_CODE_SUCCESS) {
+      T_LONG_JMP(pTaskInfo->env, code);
+    }
+    qDebug("%s block dist of super table:0x%" PRIx64 " from stats, blocks:%u, elapsed time:%.2f ms",
+           GET_TASKID(pTaskInfo), pBlockScanInfo->uid, blockDistInfo.numOfBlocks, (taosGetTimestampUs() - st) / 1000.0);
+  } else {
+    tsdbGetFileBlocksDistInfo(pBlockScanInfo->pHandle, &blockDistInfo);
+    blockDistInfo.numOfInmemRows = (int32_t)tsdbGetNumOfRowsInMemTable(pBlockScanInfo->pHandle);
+  }
 
   SSDataBlock* pBlock = pBlockScanInfo->pResBlock;
 
@@ -1912,7 +1964,8 @@ SOperatorInfo* createDataBlockInfoScanOperator(SReadHandle* readHandle, SBlockDi
   pInfo->pResBlock = createDataBlockFromDescNode(pBlockScanNode->node.pOutputDataBlockDesc);
   blockDataEnsureCapacity(pInfo->pResBlock, 1);
 
-  {
+  // the block distribution of a super table is summed up from the stats maintained by the vnode, no reader is needed
+  if (pBlockScanNode->tableType != TSDB_SUPER_TABLE) {
     SQueryTableDataCond cond = {0};
     int32_t             code = initTableblockDistQueryCond(pBlockScanNode->suid, &cond);
     if (code != TSDB_CODE_SUCCESS) {
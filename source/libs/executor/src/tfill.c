@@ -32,39 +32,9 @@
 #include "tfill.h"
 
 #define FILL_IS_ASC_FILL(_f) ((_f)->order == TSDB_ORDER_ASC)
-#define DO_INTERPOLATION(_v1, _v2, _k1, _k2, _k) \
-  ((_v1) + ((_v2) - (_v1)) * (((double)(_k)) - ((double)(_k1))) / (((double)(_k2)) - ((double)(_k1))))
 
 static void doSetVal(SColumnInfoData* pDstColInfoData, int32_t rowIndex, const SGroupKeys* pKey);
 
-static void setNullRow(SSDataBlock* pBlock, SFillInfo* pFillInfo, int32_t rowIndex) {
-  for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-    SFillColInfo*    pCol = &pFillInfo->pFillCol[i];
-    int32_t          dstSlotId = GET_DEST_SLOT_ID(pCol);
-    SColumnInfoData* pDstColInfo = taosArrayGet(pBlock->pDataBlock, dstSlotId);
-    if (pCol->notFillCol) {
-      bool filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDstColInfo, rowIndex);
-      if (!filled) {
-        SRowVal* p = NULL;
-        if (FILL_IS_ASC_FILL(pFillInfo)) {
-          if (pFillInfo->prev.key != 0) {
-            p = &pFillInfo->prev;  // prev has been set value
-          } else { // otherwise, use the value in the next row
-            p = &pFillInfo->next;
-          }
-        } else {
-          p = &pFillInfo->next;
-        }
-
-        SGroupKeys* pKey = taosArrayGet(p->pRowVal, i);
-        doSetVal(pDstColInfo, rowIndex, pKey);
-      }
-    } else {
-      colDataAppendNULL(pDstColInfo, rowIndex);
-    }
-  }
-}
-
 static void doSetUserSpecifiedValue(SColumnInfoData* pDst, SVariant* pVar, int32_t rowIndex, int64_t currentKey) {
   if (pDst->info.type == TSDB_DATA_TYPE_FLOAT) {
     float v = 0;
@@ -114,114 +84,240 @@ bool fillIfWindowPseudoColumn(SFillInfo* pFillInfo, SFillColInfo* pCol, SColumnI
   return false;
 }
 
-static void doFillOneRow(SFillInfo* pFillInfo, SSDataBlock* pBlock, SSDataBlock* pSrcBlock, int64_t ts,
-                         bool outOfBound) {
-  SPoint  point1, point2, point;
-  int32_t step = GET_FORWARD_DIRECTION_FACTOR(pFillInfo->order);
+// Set the rows [start, start + numOfRows) of a fixed length column to the same value, doubling the copied range.
+static void fillSetFixedValues(SColumnInfoData* pDst, int32_t start, int32_t numOfRows, const char* pData) {
+  int32_t bytes = pDst->info.bytes;
+  char*   p = pDst->pData + (int64_t)start * bytes;
+
+  memcpy(p, pData, bytes);
+  int32_t filled = 1;
+  while (filled < numOfRows) {
+    int32_t n = TMIN(filled, numOfRows - filled);
+    memcpy(p + (int64_t)filled * bytes, p, (int64_t)n * bytes);
+    filled += n;
+  }
+}
 
-  // set the primary timestamp column value
-  int32_t index = pBlock->info.rows;
+static void fillSetValues(SColumnInfoData* pDst, int32_t start, int32_t numOfRows, const char* pData, bool isNull) {
+  if (isNull) {
+    colDataAppendNNULL(pDst, start, numOfRows);
+  } else if (IS_VAR_DATA_TYPE(pDst->info.type)) {
+    for (int32_t j = 0; j < numOfRows; ++j) {
+      colDataAppend(pDst, start + j, pData, false);
+    }
+  } else {
+    fillSetFixedValues(pDst, start, numOfRows, pData);
+  }
+}
 
-  // set the other values
-  if (pFillInfo->type == TSDB_FILL_PREV) {
-    SArray* p = FILL_IS_ASC_FILL(pFillInfo) ? pFillInfo->prev.pRowVal : pFillInfo->next.pRowVal;
+// Same conversion of the user specified value as doSetUserSpecifiedValue, for all the rows of a gap.
+static void fillSetUserSpecifiedValues(SFillInfo* pFillInfo, SColumnInfoData* pDst, SVariant* pVar, int32_t start,
+                                       int32_t numOfRows) {
+  int16_t type = pDst->info.type;
+  if (type == TSDB_DATA_TYPE_FLOAT) {
+    float v = 0;
+    GET_TYPED_DATA(v, float, pVar->nType, &pVar->i);
+    fillSetFixedValues(pDst, start, numOfRows, (const char*)&v);
+  } else if (type == TSDB_DATA_TYPE_DOUBLE) {
+    double v = 0;
+    GET_TYPED_DATA(v, double, pVar->nType, &pVar->i);
+    fillSetFixedValues(pDst, start, numOfRows, (const char*)&v);
+  } else if (IS_SIGNED_NUMERIC_TYPE(type)) {
+    int64_t v = 0;
+    GET_TYPED_DATA(v, int64_t, pVar->nType, &pVar->i);
+    fillSetFixedValues(pDst, start, numOfRows, (const char*)&v);
+  } else if (type == TSDB_DATA_TYPE_TIMESTAMP) {
+    memcpy(pDst->pData + (int64_t)start * sizeof(TSKEY), pFillInfo->pFillKeys, numOfRows * sizeof(TSKEY));
+  } else {  // varchar/nchar data
+    colDataAppendNNULL(pDst, start, numOfRows);
+  }
+}
 
-    for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-      SFillColInfo* pCol = &pFillInfo->pFillCol[i];
+static bool fillWindowPseudoColumn(SFillInfo* pFillInfo, SFillColInfo* pCol, SColumnInfoData* pDst, int32_t start,
+                                   int32_t numOfRows) {
+  if (pCol->pExpr->pExpr->nodeType != QUERY_NODE_COLUMN || pCol->pExpr->base.numOfParams != 1) {
+    return false;
+  }
 
-      SColumnInfoData* pDstColInfoData = taosArrayGet(pBlock->pDataBlock, GET_DEST_SLOT_ID(pCol));
-      bool             filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDstColInfoData, index);
-      if (!filled) {
-        SGroupKeys* pKey = taosArrayGet(p, i);
-        doSetVal(pDstColInfoData, index, pKey);
-      }
-    }
-  } else if (pFillInfo->type == TSDB_FILL_NEXT) {
-    SArray* p = FILL_IS_ASC_FILL(pFillInfo) ? pFillInfo->next.pRowVal : pFillInfo->prev.pRowVal;
-    // todo  refactor: start from 0 not 1
-    for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-      SFillColInfo*    pCol = &pFillInfo->pFillCol[i];
-      SColumnInfoData* pDstColInfoData = taosArrayGet(pBlock->pDataBlock, GET_DEST_SLOT_ID(pCol));
-      bool             filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDstColInfoData, index);
-      if (!filled) {
-        SGroupKeys* pKey = taosArrayGet(p, i);
-        doSetVal(pDstColInfoData, index, pKey);
+  TSKEY*     keys = pFillInfo->pFillKeys;
+  SInterval* pInterval = &pFillInfo->interval;
+  TSKEY*     pDstKeys = (TSKEY*)pDst->pData + start;
+  switch (pCol->pExpr->base.pParam[0].pCol->colType) {
+    case COLUMN_TYPE_WINDOW_START:
+      memcpy(pDstKeys, keys, numOfRows * sizeof(TSKEY));
+      return true;
+    case COLUMN_TYPE_WINDOW_END:
+      for (int32_t j = 0; j < numOfRows; ++j) {
+        pDstKeys[j] = taosTimeAdd(keys[j], pInterval->interval, pInterval->intervalUnit, pInterval->precision);
       }
+      return true;
+    case COLUMN_TYPE_WINDOW_DURATION:
+      fillSetFixedValues(pDst, start, numOfRows, (const char*)&pInterval->sliding);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// The row that gives the values of the columns that are not filled, e.g. the group keys.
+static SArray* fillGetNotFillColRow(SFillInfo* pFillInfo, bool outOfBound) {
+  bool ascFill = FILL_IS_ASC_FILL(pFillInfo);
+  if (pFillInfo->type == TSDB_FILL_NEXT) {
+    return ascFill ? pFillInfo->next.pRowVal : pFillInfo->prev.pRowVal;
+  }
+  if (pFillInfo->type == TSDB_FILL_NULL || (pFillInfo->type == TSDB_FILL_LINEAR && outOfBound)) {
+    if (ascFill && pFillInfo->prev.key != 0) {
+      return pFillInfo->prev.pRowVal;  // prev has been set value
     }
-  } else if (pFillInfo->type == TSDB_FILL_LINEAR) {
-    // TODO : linear interpolation supports NULL value
-    if (outOfBound) {
-      setNullRow(pBlock, pFillInfo, index);
-    } else {
-      for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-        SFillColInfo* pCol = &pFillInfo->pFillCol[i];
+    return pFillInfo->next.pRowVal;  // otherwise, use the value in the next row
+  }
+  return ascFill ? pFillInfo->prev.pRowVal : pFillInfo->next.pRowVal;
+}
 
-        int32_t          dstSlotId = GET_DEST_SLOT_ID(pCol);
-        SColumnInfoData* pDstCol = taosArrayGet(pBlock->pDataBlock, dstSlotId);
-        int16_t          type = pDstCol->info.type;
+#define FILL_LINEAR_KERNEL(_type, _pData, _keys, _numOfRows, _v1, _v2, _k1, _k2)  \
+  do {                                                                            \
+    _type* _d = (_type*)(_pData);                                                 \
+    for (int32_t _j = 0; _j < (_numOfRows); ++_j) {                               \
+      _d[_j] = (_type)DO_INTERPOLATION((_v1), (_v2), (_k1), (_k2), (_keys)[_j]);  \
+    }                                                                             \
+  } while (0)
+
+// Interpolate the rows of a gap between the previous row and the row at the current index of the source block.
+static void fillLinearValues(SFillInfo* pFillInfo, int32_t colIndex, SColumnInfoData* pDst, int32_t start,
+                             int32_t numOfRows) {
+  SFillColInfo*    pCol = &pFillInfo->pFillCol[colIndex];
+  SGroupKeys*      pKey = taosArrayGet(pFillInfo->prev.pRowVal, colIndex);
+  SColumnInfoData* pSrcCol = taosArrayGet(pFillInfo->pSrcBlock->pDataBlock, GET_DEST_SLOT_ID(pCol));
+  int16_t          type = pDst->info.type;
+
+  // TODO : linear interpolation supports NULL value
+  if (IS_VAR_DATA_TYPE(type) || type == TSDB_DATA_TYPE_BOOL || pKey->isNull ||
+      colDataIsNull_s(pSrcCol, pFillInfo->index)) {
+    colDataAppendNNULL(pDst, start, numOfRows);
+    return;
+  }
 
-        if (pCol->notFillCol) {
-          bool filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDstCol, index);
-          if (!filled) {
-            SArray*     p = FILL_IS_ASC_FILL(pFillInfo) ? pFillInfo->prev.pRowVal : pFillInfo->next.pRowVal;
-            SGroupKeys* pKey = taosArrayGet(p, i);
-            doSetVal(pDstCol, index, pKey);
-          }
-        } else {
-          SGroupKeys* pKey = taosArrayGet(pFillInfo->prev.pRowVal, i);
-          if (IS_VAR_DATA_TYPE(type) || type == TSDB_DATA_TYPE_BOOL || pKey->isNull) {
-            colDataAppendNULL(pDstCol, index);
-            continue;
-          }
+  SGroupKeys*      pTsKey = taosArrayGet(pFillInfo->prev.pRowVal, pFillInfo->tsSlotId);
+  SColumnInfoData* pTsCol = taosArrayGet(pFillInfo->pSrcBlock->pDataBlock, pFillInfo->srcTsSlotId);
 
-          SGroupKeys* pKey1 = taosArrayGet(pFillInfo->prev.pRowVal, pFillInfo->tsSlotId);
+  int64_t k1 = *(int64_t*)pTsKey->pData;
+  int64_t k2 = ((int64_t*)pTsCol->pData)[pFillInfo->index];
+  double  v1 = 0, v2 = 0;
+  GET_TYPED_DATA(v1, double, type, pKey->pData);
+  GET_TYPED_DATA(v2, double, type, colDataGetData(pSrcCol, pFillInfo->index));
+
+  TSKEY* keys = pFillInfo->pFillKeys;
+  char*  p = pDst->pData + (int64_t)start * pDst->info.bytes;
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      FILL_LINEAR_KERNEL(int8_t, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      FILL_LINEAR_KERNEL(uint8_t, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      FILL_LINEAR_KERNEL(int16_t, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      FILL_LINEAR_KERNEL(uint16_t, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      FILL_LINEAR_KERNEL(int32_t, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      FILL_LINEAR_KERNEL(uint32_t, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      FILL_LINEAR_KERNEL(int64_t, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      FILL_LINEAR_KERNEL(uint64_t, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      FILL_LINEAR_KERNEL(float, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      FILL_LINEAR_KERNEL(double, p, keys, numOfRows, v1, v2, k1, k2);
+      break;
+    default:
+      colDataAppendNNULL(pDst, start, numOfRows);
+      break;
+  }
+}
 
-          int64_t prevTs = *(int64_t*)pKey1->pData;
-          int32_t srcSlotId = GET_DEST_SLOT_ID(pCol);
+// Generate the timestamps of the rows of the gap before ts, at most maxRows of them, and move the current key after
+// them. Out of the bound of the input data there is no end of the gap.
+static int32_t fillGenerateKeys(SFillInfo* pFillInfo, int64_t ts, bool outOfBound, int32_t maxRows) {
+  SInterval* pInterval = &pFillInfo->interval;
+  int64_t    sliding = pInterval->sliding * GET_FORWARD_DIRECTION_FACTOR(pFillInfo->order);
+  bool       ascFill = FILL_IS_ASC_FILL(pFillInfo);
+  bool       varDuration = TIME_IS_VAR_DURATION(pInterval->slidingUnit);
+  TSKEY*     keys = pFillInfo->pFillKeys;
+  TSKEY      key = pFillInfo->currentKey;
+
+  int32_t numOfRows = 0;
+  while (numOfRows < maxRows && (outOfBound || (ascFill ? key < ts : key > ts))) {
+    keys[numOfRows++] = key;
+    key = varDuration ? taosTimeAdd(key, sliding, pInterval->slidingUnit, pInterval->precision) : key + sliding;
+  }
 
-          SColumnInfoData* pSrcCol = taosArrayGet(pSrcBlock->pDataBlock, srcSlotId);
-          char*            data = colDataGetData(pSrcCol, pFillInfo->index);
+  pFillInfo->currentKey = key;
+  return numOfRows;
+}
 
-          point1 = (SPoint){.key = prevTs, .val = pKey->pData};
-          point2 = (SPoint){.key = ts, .val = data};
+// Fill the rows of a gap one column after another, instead of one row after another.
+static int32_t doFillGap(SFillInfo* pFillInfo, SSDataBlock* pBlock, int64_t ts, bool outOfBound, int32_t maxRows) {
+  int32_t start = pBlock->info.rows;
+  int32_t numOfRows = fillGenerateKeys(pFillInfo, ts, outOfBound, maxRows);
+  if (numOfRows == 0) {
+    return 0;
+  }
 
-          int64_t out = 0;
-          point = (SPoint){.key = pFillInfo->currentKey, .val = &out};
-          taosGetLinearInterpolationVal(&point, type, &point1, &point2, type);
+  for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
+    SFillColInfo*    pCol = &pFillInfo->pFillCol[i];
+    SColumnInfoData* pDst = taosArrayGet(pBlock->pDataBlock, GET_DEST_SLOT_ID(pCol));
 
-          colDataAppend(pDstCol, index, (const char*)&out, false);
-        }
+    if (pCol->notFillCol) {
+      if (!fillWindowPseudoColumn(pFillInfo, pCol, pDst, start, numOfRows)) {
+        SGroupKeys* pKey = taosArrayGet(fillGetNotFillColRow(pFillInfo, outOfBound), i);
+        fillSetValues(pDst, start, numOfRows, pKey->pData, pKey->isNull);
       }
+      continue;
     }
-  } else if (pFillInfo->type == TSDB_FILL_NULL) {  // fill with NULL
-    setNullRow(pBlock, pFillInfo, index);
-  } else {  // fill with user specified value for each column
-    for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-      SFillColInfo* pCol = &pFillInfo->pFillCol[i];
 
-      int32_t          slotId = GET_DEST_SLOT_ID(pCol);
-      SColumnInfoData* pDst = taosArrayGet(pBlock->pDataBlock, slotId);
-
-      if (pCol->notFillCol) {
-        bool filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDst, index);
-        if (!filled) {
-          SArray*     p = FILL_IS_ASC_FILL(pFillInfo) ? pFillInfo->prev.pRowVal : pFillInfo->next.pRowVal;
-          SGroupKeys* pKey = taosArrayGet(p, i);
-          doSetVal(pDst, index, pKey);
-        }
-      } else {
-        SVariant* pVar = &pFillInfo->pFillCol[i].fillVal;
-        doSetUserSpecifiedValue(pDst, pVar, index, pFillInfo->currentKey);
+    switch (pFillInfo->type) {
+      case TSDB_FILL_PREV: {
+        SArray*     p = FILL_IS_ASC_FILL(pFillInfo) ? pFillInfo->prev.pRowVal : pFillInfo->next.pRowVal;
+        SGroupKeys* pKey = taosArrayGet(p, i);
+        fillSetValues(pDst, start, numOfRows, pKey->pData, pKey->isNull);
+        break;
       }
+      case TSDB_FILL_NEXT: {
+        SArray*     p = FILL_IS_ASC_FILL(pFillInfo) ? pFillInfo->next.pRowVal : pFillInfo->prev.pRowVal;
+        SGroupKeys* pKey = taosArrayGet(p, i);
+        fillSetValues(pDst, start, numOfRows, pKey->pData, pKey->isNull);
+        break;
+      }
+      case TSDB_FILL_LINEAR:
+        if (outOfBound) {
+          colDataAppendNNULL(pDst, start, numOfRows);
+        } else {
+          fillLinearValues(pFillInfo, i, pDst, start, numOfRows);
+        }
+        break;
+      case TSDB_FILL_NULL:
+        colDataAppendNNULL(pDst, start, numOfRows);
+        break;
+      default:  // fill with user specified value for each column
+        fillSetUserSpecifiedValues(pFillInfo, pDst, &pCol->fillVal, start, numOfRows);
+        break;
     }
   }
 
-  //  setTagsValue(pFillInfo, data, index);
-  SInterval* pInterval = &pFillInfo->interval;
-  pFillInfo->currentKey =
-      taosTimeAdd(pFillInfo->currentKey, pInterval->sliding * step, pInterval->slidingUnit, pInterval->precision);
-  pBlock->info.rows += 1;
-  pFillInfo->numOfCurrent++;
+  pBlock->info.rows += numOfRows;
+  pFillInfo->numOfCurrent += numOfRows;
+  return numOfRows;
 }
 
 void doSetVal(SColumnInfoData* pDstCol, int32_t rowIndex, const SGroupKeys* pKey) {
@@ -300,10 +396,7 @@ static int32_t fillResultImpl(SFillInfo* pFillInfo, SSDataBlock* pBlock, int32_t
     if (((pFillInfo->currentKey < ts && ascFill) || (pFillInfo->currentKey > ts && !ascFill)) &&
         pFillInfo->numOfCurrent < outputRows) {
       // fill the gap between two input rows
-      while (((pFillInfo->currentKey < ts && ascFill) || (pFillInfo->currentKey > ts && !ascFill)) &&
-             pFillInfo->numOfCurrent < outputRows) {
-        doFillOneRow(pFillInfo, pBlock, pFillInfo->pSrcBlock, ts, false);
-      }
+      doFillGap(pFillInfo, pBlock, ts, false, outputRows - pFillInfo->numOfCurrent);
 
       // output buffer is full, abort
       if (pFillInfo->numOfCurrent == outputRows) {
@@ -400,9 +493,7 @@ static int64_t appendFilledResult(SFillInfo* pFillInfo, SSDataBlock* pBlock, int
    * real result set. Note that we need to keep the direct previous result rows, to generated the filled data.
    */
   pFillInfo->numOfCurrent = 0;
-  while (pFillInfo->numOfCurrent < resultCapacity) {
-    doFillOneRow(pFillInfo, pBlock, pFillInfo->pSrcBlock, pFillInfo->start, true);
-  }
+  doFillGap(pFillInfo, pBlock, pFillInfo->start, true, (int32_t)resultCapacity);
 
   pFillInfo->numOfTotal += pFillInfo->numOfCurrent;
 
@@ -478,6 +569,13 @@ struct SFillInfo* taosCreateFillInfo(TSKEY skey, int32_t numOfFillCols, int32_t
   pFillInfo->id = id;
   pFillInfo->interval = *pInterval;
 
+  pFillInfo->pFillKeys = taosMemoryMalloc(capacity * sizeof(TSKEY));
+  if (pFillInfo->pFillKeys == NULL) {
+    taosMemoryFree(pFillInfo);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+
   pFillInfo->next.pRowVal = taosArrayInit(pFillInfo->numOfCols, sizeof(SGroupKeys));
   pFillInfo->prev.pRowVal = taosArrayInit(pFillInfo->numOfCols, sizeof(SGroupKeys));
 
@@ -531,6 +629,7 @@ void* taosDestroyFillInfo(SFillInfo* pFillInfo) {
   }
 
   taosMemoryFreeClear(pFillInfo->pTags);
+  taosMemoryFreeClear(pFillInfo->pFillKeys);
   taosMemoryFreeClear(pFillInfo->pFillCol);
   taosMemoryFreeClear(pFillInfo);
   return NULL;
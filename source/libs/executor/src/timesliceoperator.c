@@ -27,17 +27,23 @@ typedef struct STimeSliceOperatorInfo {
   STimeWindow          win;
   SInterval            interval;
   int64_t              current;
-  SArray*              pPrevRow;     // SArray<SGroupValue>
-  SArray*              pNextRow;     // SArray<SGroupValue>
-  SArray*              pLinearInfo;  // SArray<SFillLinearInfo>
+  SArray*              pPrevRow;      // SArray<SGroupValue>, the last row of the previous input block
+  int64_t              prevKey;       // timestamp of pPrevRow
   bool                 isPrevRowSet;
-  bool                 isNextRowSet;
   int32_t              fillType;      // fill type
   SColumn              tsCol;         // primary timestamp column
   SExprSupp            scalarSup;     // scalar calculation
   struct SFillColInfo* pFillColInfo;  // fill column info
+  int32_t              slotCapacity;  // max number of the output slots generated in one batch
+  int64_t*             pSlotKeys;     // timestamps of the output slots of the current batch
+  int32_t*             pSlotIndex;    // index of the first row of the input block not before each slot
+  int32_t*             pSlotRows;     // source row of each slot for the column being filled
 } STimeSliceOperatorInfo;
 
+// source rows of the slots other than the rows of the input block
+#define TIMESLICE_PREV_ROW (-1)  // the last row of the previous input block
+#define TIMESLICE_FILL_ROW (-2)  // the value is generated by the fill mode
+
 static void destroyTimeSliceOperatorInfo(void* param);
 
 static void doKeepPrevRows(STimeSliceOperatorInfo* pSliceInfo, const SSDataBlock* pBlock, int32_t rowIndex) {
@@ -50,7 +56,7 @@ static void doKeepPrevRows(STimeSliceOperatorInfo* pSliceInfo, const SSDataBlock
       pkey->isNull = false;
       char* val = colDataGetData(pColInfoData, rowIndex);
       if (IS_VAR_DATA_TYPE(pkey->type)) {
-        memcpy(pkey->pData, val, varDataLen(val));
+        memcpy(pkey->pData, val, varDataTLen(val));
       } else {
         memcpy(pkey->pData, val, pkey->bytes);
       }
@@ -59,341 +65,407 @@ static void doKeepPrevRows(STimeSliceOperatorInfo* pSliceInfo, const SSDataBlock
     }
   }
 
+  SColumnInfoData* pTsCol = taosArrayGet(pBlock->pDataBlock, pSliceInfo->tsCol.slotId);
+  pSliceInfo->prevKey = *(int64_t*)colDataGetData(pTsCol, rowIndex);
   pSliceInfo->isPrevRowSet = true;
 }
 
-static void doKeepNextRows(STimeSliceOperatorInfo* pSliceInfo, const SSDataBlock* pBlock, int32_t rowIndex) {
-  int32_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
-  for (int32_t i = 0; i < numOfCols; ++i) {
-    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, i);
-
-    SGroupKeys* pkey = taosArrayGet(pSliceInfo->pNextRow, i);
-    if (!colDataIsNull_s(pColInfoData, rowIndex)) {
-      pkey->isNull = false;
-      char* val = colDataGetData(pColInfoData, rowIndex);
-      if (!IS_VAR_DATA_TYPE(pkey->type)) {
-        memcpy(pkey->pData, val, pkey->bytes);
-      } else {
-        memcpy(pkey->pData, val, varDataLen(val));
-      }
-    } else {
-      pkey->isNull = true;
-    }
+static int32_t initPrevRowsKeeper(STimeSliceOperatorInfo* pInfo, SSDataBlock* pBlock) {
+  if (pInfo->pPrevRow != NULL) {
+    return TSDB_CODE_SUCCESS;
   }
 
-  pSliceInfo->isNextRowSet = true;
-}
+  pInfo->pPrevRow = taosArrayInit(4, sizeof(SGroupKeys));
+  if (pInfo->pPrevRow == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
 
-static void doKeepLinearInfo(STimeSliceOperatorInfo* pSliceInfo, const SSDataBlock* pBlock, int32_t rowIndex) {
   int32_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
   for (int32_t i = 0; i < numOfCols; ++i) {
-    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, i);
-    SColumnInfoData* pTsCol = taosArrayGet(pBlock->pDataBlock, pSliceInfo->tsCol.slotId);
-    SFillLinearInfo* pLinearInfo = taosArrayGet(pSliceInfo->pLinearInfo, i);
+    SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, i);
+
+    SGroupKeys key = {0};
+    key.bytes = pColInfo->info.bytes;
+    key.type = pColInfo->info.type;
+    key.isNull = false;
+    key.pData = taosMemoryCalloc(1, pColInfo->info.bytes);
+    taosArrayPush(pInfo->pPrevRow, &key);
+  }
 
+  pInfo->isPrevRowSet = false;
 
-    if (!IS_MATHABLE_TYPE(pColInfoData->info.type)) {
-      continue;
-    }
+  return TSDB_CODE_SUCCESS;
+}
 
-    // null value is represented by using key = INT64_MIN for now.
-    // TODO: optimize to ignore null values for linear interpolation.
-    if (!pLinearInfo->isStartSet) {
-      if (!colDataIsNull_s(pColInfoData, rowIndex)) {
-
-        pLinearInfo->start.key = *(int64_t*)colDataGetData(pTsCol, rowIndex);
-        char* p = colDataGetData(pColInfoData, rowIndex);
-        if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
-          ASSERT(varDataTLen(p) <= pColInfoData->info.bytes);
-          memcpy(pLinearInfo->start.val, p, varDataTLen(p));
-        } else {
-          memcpy(pLinearInfo->start.val, p, pLinearInfo->bytes);
-        }
-      }
-      pLinearInfo->isStartSet = true;
-    } else if (!pLinearInfo->isEndSet) {
-      if (!colDataIsNull_s(pColInfoData, rowIndex)) {
-        pLinearInfo->end.key = *(int64_t*)colDataGetData(pTsCol, rowIndex);
-
-        char* p = colDataGetData(pColInfoData, rowIndex);
-        if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
-          ASSERT(varDataTLen(p) <= pColInfoData->info.bytes);
-          memcpy(pLinearInfo->end.val, p, varDataTLen(p));
-        } else {
-          memcpy(pLinearInfo->end.val, p, pLinearInfo->bytes);
-        }
-      }
-      pLinearInfo->isEndSet = true;
+// Index of the first row in [start, end) whose timestamp is not less than key, or end if there is none.
+static int32_t timeSliceSearchRow(const int64_t* pTs, int32_t start, int32_t end, int64_t key) {
+  while (start < end) {
+    int32_t mid = start + ((end - start) >> 1);
+    if (pTs[mid] < key) {
+      start = mid + 1;
     } else {
-      pLinearInfo->start.key = pLinearInfo->end.key;
-      memcpy(pLinearInfo->start.val, pLinearInfo->end.val, pLinearInfo->bytes);
-
-      if (!colDataIsNull_s(pColInfoData, rowIndex)) {
-        pLinearInfo->end.key = *(int64_t*)colDataGetData(pTsCol, rowIndex);
-
-        char* p = colDataGetData(pColInfoData, rowIndex);
-        if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
-          ASSERT(varDataTLen(p) <= pColInfoData->info.bytes);
-          memcpy(pLinearInfo->end.val, p, varDataTLen(p));
-        } else {
-          memcpy(pLinearInfo->end.val, p, pLinearInfo->bytes);
-        }
-
-      } else {
-        pLinearInfo->end.key = INT64_MIN;
-      }
+      end = mid;
     }
   }
 
+  return start;
 }
 
-static bool genInterpolationResult(STimeSliceOperatorInfo* pSliceInfo, SExprSupp* pExprSup, SSDataBlock* pResBlock, bool beforeTs) {
-  int32_t rows = pResBlock->info.rows;
-  blockDataEnsureCapacity(pResBlock, rows + 1);
-  // todo set the correct primary timestamp column
+// Check if the fill mode generates a value for the slot between the rows index - 1 and index of the input block.
+static bool timeSliceHasFillValue(const STimeSliceOperatorInfo* pInfo, int32_t index, int32_t rows) {
+  bool hasPrev = (index > 0) || pInfo->isPrevRowSet;
+  bool hasNext = (index < rows);
+
+  switch (pInfo->fillType) {
+    case TSDB_FILL_NULL:
+    case TSDB_FILL_SET_VALUE:
+      return true;
+    case TSDB_FILL_PREV:
+      return hasPrev;
+    case TSDB_FILL_NEXT:
+      return hasNext;
+    case TSDB_FILL_LINEAR:
+      return hasPrev && hasNext;
+    case TSDB_FILL_NONE:
+    default:
+      return false;
+  }
+}
 
-  // output the result
-  bool hasInterp = true;
-  for (int32_t j = 0; j < pExprSup->numOfExprs; ++j) {
-    SExprInfo* pExprInfo = &pExprSup->pExprInfo[j];
+// Generate the output slots from the current key up to endKey, at most slotCapacity of them, and binary search the
+// first row of the input block not before each of them. The slots that have neither a row on them nor a fill value
+// are skipped. The current key is moved after the generated slots.
+static int32_t timeSliceGenSlots(STimeSliceOperatorInfo* pInfo, const int64_t* pTs, int32_t rows, int64_t endKey) {
+  SInterval* pInterval = &pInfo->interval;
+  bool       varDuration = TIME_IS_VAR_DURATION(pInterval->intervalUnit);
+  int64_t    key = pInfo->current;
+  int32_t    index = 0;
+
+  int32_t numOfSlots = 0;
+  while (numOfSlots < pInfo->slotCapacity && key <= endKey) {
+    index = timeSliceSearchRow(pTs, index, rows, key);
+    if ((index < rows && pTs[index] == key) || timeSliceHasFillValue(pInfo, index, rows)) {
+      pInfo->pSlotKeys[numOfSlots] = key;
+      pInfo->pSlotIndex[numOfSlots] = index;
+      numOfSlots += 1;
+    }
 
-    int32_t          dstSlot = pExprInfo->base.resSchema.slotId;
-    SColumnInfoData* pDst = taosArrayGet(pResBlock->pDataBlock, dstSlot);
+    key = varDuration ? taosTimeAdd(key, pInterval->interval, pInterval->intervalUnit, pInterval->precision)
+                      : key + pInterval->interval;
+  }
 
-    if (IS_TIMESTAMP_TYPE(pExprInfo->base.resSchema.type)) {
-      colDataAppend(pDst, rows, (char*)&pSliceInfo->current, false);
-      continue;
-    }
+  pInfo->current = key;
+  return numOfSlots;
+}
 
-    int32_t srcSlot = pExprInfo->base.pParam[0].pCol->slotId;
-    switch (pSliceInfo->fillType) {
-      case TSDB_FILL_NULL: {
-        colDataAppendNULL(pDst, rows);
-        break;
+#define TIMESLICE_COPY_KERNEL(_type, _pDst, _pSrc, _pRows, _numOfSlots) \
+  do {                                                                \
+    _type*       _d = (_type*)(_pDst);                                \
+    const _type* _s = (const _type*)(_pSrc);                          \
+    for (int32_t _j = 0; _j < (_numOfSlots); ++_j) {                  \
+      if ((_pRows)[_j] >= 0) {                                        \
+        _d[_j] = _s[(_pRows)[_j]];                                    \
+      }                                                               \
+    }                                                                 \
+  } while (0)
+
+// Copy the values of the slots whose source row is a row of the input block or the last row of the previous block.
+static void timeSliceCopyRows(STimeSliceOperatorInfo* pInfo, SColumnInfoData* pDst, int32_t offset,
+                              const SColumnInfoData* pSrc, const SGroupKeys* pPrevKey, int32_t numOfSlots) {
+  const int32_t* pRows = pInfo->pSlotRows;
+
+  if (IS_VAR_DATA_TYPE(pDst->info.type)) {
+    for (int32_t j = 0; j < numOfSlots; ++j) {
+      if (pRows[j] >= 0) {
+        bool isNull = colDataIsNull_s(pSrc, pRows[j]);
+        colDataAppend(pDst, offset + j, isNull ? NULL : colDataGetData(pSrc, pRows[j]), isNull);
+      } else if (pRows[j] == TIMESLICE_PREV_ROW) {
+        colDataAppend(pDst, offset + j, pPrevKey->pData, pPrevKey->isNull);
       }
+    }
+    return;
+  }
 
-      case TSDB_FILL_SET_VALUE: {
-        SVariant* pVar = &pSliceInfo->pFillColInfo[j].fillVal;
-
-        if (pDst->info.type == TSDB_DATA_TYPE_FLOAT) {
-          float v = 0;
-          GET_TYPED_DATA(v, float, pVar->nType, &pVar->i);
-          colDataAppend(pDst, rows, (char*)&v, false);
-        } else if (pDst->info.type == TSDB_DATA_TYPE_DOUBLE) {
-          double v = 0;
-          GET_TYPED_DATA(v, double, pVar->nType, &pVar->i);
-          colDataAppend(pDst, rows, (char*)&v, false);
-        } else if (IS_SIGNED_NUMERIC_TYPE(pDst->info.type)) {
-          int64_t v = 0;
-          GET_TYPED_DATA(v, int64_t, pVar->nType, &pVar->i);
-          colDataAppend(pDst, rows, (char*)&v, false);
-        }
+  int32_t bytes = pDst->info.bytes;
+  char*   p = pDst->pData + (int64_t)offset * bytes;
+  if (pSrc != NULL) {
+    switch (bytes) {
+      case sizeof(int8_t):
+        TIMESLICE_COPY_KERNEL(int8_t, p, pSrc->pData, pRows, numOfSlots);
         break;
-      }
-
-      case TSDB_FILL_LINEAR: {
-        SFillLinearInfo* pLinearInfo = taosArrayGet(pSliceInfo->pLinearInfo, srcSlot);
-
-        SPoint start = pLinearInfo->start;
-        SPoint end = pLinearInfo->end;
-        SPoint current = {.key = pSliceInfo->current};
-
-        // do not interpolate before ts range, only increate pSliceInfo->current
-        if (beforeTs && !pLinearInfo->isEndSet) {
-          return true;
-        }
-
-        if (!pLinearInfo->isStartSet || !pLinearInfo->isEndSet) {
-          hasInterp = false;
-          break;
-        }
-
-        if (start.key == INT64_MIN || end.key == INT64_MIN) {
-          colDataAppendNULL(pDst, rows);
-          break;
-        }
-
-        current.val = taosMemoryCalloc(pLinearInfo->bytes, 1);
-        taosGetLinearInterpolationVal(&current, pLinearInfo->type, &start, &end, pLinearInfo->type);
-        colDataAppend(pDst, rows, (char*)current.val, false);
-
-        taosMemoryFree(current.val);
+      case sizeof(int16_t):
+        TIMESLICE_COPY_KERNEL(int16_t, p, pSrc->pData, pRows, numOfSlots);
         break;
-      }
-      case TSDB_FILL_PREV: {
-        if (!pSliceInfo->isPrevRowSet) {
-          hasInterp = false;
-          break;
-        }
-
-        SGroupKeys* pkey = taosArrayGet(pSliceInfo->pPrevRow, srcSlot);
-        if (pkey->isNull == false) {
-          colDataAppend(pDst, rows, pkey->pData, false);
-        } else {
-          colDataAppendNULL(pDst, rows);
-        }
+      case sizeof(int32_t):
+        TIMESLICE_COPY_KERNEL(int32_t, p, pSrc->pData, pRows, numOfSlots);
         break;
-      }
-
-      case TSDB_FILL_NEXT: {
-        if (!pSliceInfo->isNextRowSet) {
-          hasInterp = false;
-          break;
+      case sizeof(int64_t):
+        TIMESLICE_COPY_KERNEL(int64_t, p, pSrc->pData, pRows, numOfSlots);
+        break;
+      default:
+        for (int32_t j = 0; j < numOfSlots; ++j) {
+          if (pRows[j] >= 0) {
+            memcpy(p + (int64_t)j * bytes, pSrc->pData + (int64_t)pRows[j] * bytes, bytes);
+          }
         }
+        break;
+    }
 
-        SGroupKeys* pkey = taosArrayGet(pSliceInfo->pNextRow, srcSlot);
-        if (pkey->isNull == false) {
-          colDataAppend(pDst, rows, pkey->pData, false);
-        } else {
-          colDataAppendNULL(pDst, rows);
+    if (pSrc->hasNull) {
+      for (int32_t j = 0; j < numOfSlots; ++j) {
+        if (pRows[j] >= 0 && colDataIsNull_f(pSrc->nullbitmap, pRows[j])) {
+          colDataAppendNULL(pDst, offset + j);
         }
-        break;
       }
-
-      case TSDB_FILL_NONE:
-      default:
-        break;
     }
   }
 
-  if (hasInterp) {
-    pResBlock->info.rows += 1;
+  // only the slots before the first row of the input block come from the previous block
+  for (int32_t j = 0; j < numOfSlots && pInfo->pSlotIndex[j] == 0; ++j) {
+    if (pRows[j] == TIMESLICE_PREV_ROW) {
+      colDataAppend(pDst, offset + j, pPrevKey->pData, pPrevKey->isNull);
+    }
   }
-
-  return hasInterp;
 }
 
-static void addCurrentRowToResult(STimeSliceOperatorInfo* pSliceInfo, SExprSupp* pExprSup, SSDataBlock* pResBlock,
-                                  SSDataBlock* pSrcBlock, int32_t index) {
-  blockDataEnsureCapacity(pResBlock, pResBlock->info.rows + 1);
-  for (int32_t j = 0; j < pExprSup->numOfExprs; ++j) {
-    SExprInfo* pExprInfo = &pExprSup->pExprInfo[j];
-
-    int32_t          dstSlot = pExprInfo->base.resSchema.slotId;
-    SColumnInfoData* pDst = taosArrayGet(pResBlock->pDataBlock, dstSlot);
-
-    if (IS_TIMESTAMP_TYPE(pExprInfo->base.resSchema.type)) {
-      colDataAppend(pDst, pResBlock->info.rows, (char*)&pSliceInfo->current, false);
-    } else {
-      int32_t          srcSlot = pExprInfo->base.pParam[0].pCol->slotId;
-      SColumnInfoData* pSrc = taosArrayGet(pSrcBlock->pDataBlock, srcSlot);
-
-      if (colDataIsNull_s(pSrc, index)) {
-        colDataAppendNULL(pDst, pResBlock->info.rows);
-        continue;
+// Same conversion of the user specified value as fill(value) of the interval query.
+static void timeSliceSetValues(STimeSliceOperatorInfo* pInfo, SColumnInfoData* pDst, int32_t offset, SVariant* pVar,
+                               int32_t numOfSlots) {
+  const int32_t* pRows = pInfo->pSlotRows;
+  char           buf[sizeof(int64_t)] = {0};
+  int16_t        type = pDst->info.type;
+
+  if (type == TSDB_DATA_TYPE_FLOAT) {
+    float v = 0;
+    GET_TYPED_DATA(v, float, pVar->nType, &pVar->i);
+    memcpy(buf, &v, sizeof(v));
+  } else if (type == TSDB_DATA_TYPE_DOUBLE) {
+    double v = 0;
+    GET_TYPED_DATA(v, double, pVar->nType, &pVar->i);
+    memcpy(buf, &v, sizeof(v));
+  } else if (IS_SIGNED_NUMERIC_TYPE(type)) {
+    int64_t v = 0;
+    GET_TYPED_DATA(v, int64_t, pVar->nType, &pVar->i);
+    memcpy(buf, &v, sizeof(v));
+  } else {
+    for (int32_t j = 0; j < numOfSlots; ++j) {
+      if (pRows[j] == TIMESLICE_FILL_ROW) {
+        colDataAppendNULL(pDst, offset + j);
       }
-
-      char* v = colDataGetData(pSrc, index);
-      colDataAppend(pDst, pResBlock->info.rows, v, false);
     }
+    return;
   }
 
-  pResBlock->info.rows += 1;
-  return;
+  int32_t bytes = pDst->info.bytes;
+  for (int32_t j = 0; j < numOfSlots; ++j) {
+    if (pRows[j] == TIMESLICE_FILL_ROW) {
+      memcpy(pDst->pData + (int64_t)(offset + j) * bytes, buf, bytes);
+    }
+  }
 }
 
-
-static int32_t initPrevRowsKeeper(STimeSliceOperatorInfo* pInfo, SSDataBlock* pBlock) {
-  if (pInfo->pPrevRow != NULL) {
-    return TSDB_CODE_SUCCESS;
+#define TIMESLICE_LINEAR_KERNEL(_type, _pDst, _pSrc, _pTs, _pKeys, _pIndex, _pRows, _numOfSlots)                  \
+  do {                                                                                                          \
+    _type*       _d = (_type*)(_pDst);                                                                          \
+    const _type* _s = (const _type*)(_pSrc);                                                                    \
+    for (int32_t _j = 0; _j < (_numOfSlots); ++_j) {                                                            \
+      int32_t _i = (_pIndex)[_j];                                                                               \
+      if ((_pRows)[_j] == TIMESLICE_FILL_ROW && _i > 0) {                                                       \
+        _d[_j] = (_type)DO_INTERPOLATION((double)_s[_i - 1], (double)_s[_i], (_pTs)[_i - 1], (_pTs)[_i],        \
+                                         (_pKeys)[_j]);                                                         \
+      }                                                                                                         \
+    }                                                                                                           \
+  } while (0)
+
+// Interpolate the slots between two rows, in a tight loop for each numeric type. The slots before the first row of
+// the input block are interpolated between the last row of the previous block and the first row.
+static void timeSliceLinearValues(STimeSliceOperatorInfo* pInfo, SColumnInfoData* pDst, int32_t offset,
+                                  const SColumnInfoData* pSrc, const SGroupKeys* pPrevKey, const int64_t* pTs,
+                                  int32_t numOfSlots) {
+  const int32_t* pRows = pInfo->pSlotRows;
+  const int32_t* pIndex = pInfo->pSlotIndex;
+  const int64_t* pKeys = pInfo->pSlotKeys;
+  int16_t        type = pDst->info.type;
+
+  if (!IS_MATHABLE_TYPE(type)) {
+    for (int32_t j = 0; j < numOfSlots; ++j) {
+      if (pRows[j] == TIMESLICE_FILL_ROW) {
+        colDataAppendNULL(pDst, offset + j);
+      }
+    }
+    return;
   }
 
-  pInfo->pPrevRow = taosArrayInit(4, sizeof(SGroupKeys));
-  if (pInfo->pPrevRow == NULL) {
-    return TSDB_CODE_OUT_OF_MEMORY;
-  }
+  for (int32_t j = 0; j < numOfSlots && pIndex[j] == 0; ++j) {
+    if (pRows[j] != TIMESLICE_FILL_ROW) {
+      continue;
+    }
 
-  int32_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
-  for (int32_t i = 0; i < numOfCols; ++i) {
-    SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, i);
+    if (pPrevKey->isNull || colDataIsNull_s(pSrc, 0)) {
+      colDataAppendNULL(pDst, offset + j);
+      continue;
+    }
 
-    SGroupKeys key = {0};
-    key.bytes = pColInfo->info.bytes;
-    key.type = pColInfo->info.type;
-    key.isNull = false;
-    key.pData = taosMemoryCalloc(1, pColInfo->info.bytes);
-    taosArrayPush(pInfo->pPrevRow, &key);
+    SPoint start = {.key = pInfo->prevKey, .val = pPrevKey->pData};
+    SPoint end = {.key = pTs[0], .val = pSrc->pData};
+    SPoint current = {.key = pKeys[j], .val = pDst->pData + (int64_t)(offset + j) * pDst->info.bytes};
+    taosGetLinearInterpolationVal(&current, type, &start, &end, type);
   }
 
-  pInfo->isPrevRowSet = false;
+  char* p = pDst->pData + (int64_t)offset * pDst->info.bytes;
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      TIMESLICE_LINEAR_KERNEL(int8_t, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      TIMESLICE_LINEAR_KERNEL(uint8_t, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      TIMESLICE_LINEAR_KERNEL(int16_t, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      TIMESLICE_LINEAR_KERNEL(uint16_t, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      TIMESLICE_LINEAR_KERNEL(int32_t, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      TIMESLICE_LINEAR_KERNEL(uint32_t, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      TIMESLICE_LINEAR_KERNEL(int64_t, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      TIMESLICE_LINEAR_KERNEL(uint64_t, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      TIMESLICE_LINEAR_KERNEL(float, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      TIMESLICE_LINEAR_KERNEL(double, p, pSrc->pData, pTs, pKeys, pIndex, pRows, numOfSlots);
+      break;
+    default:  // bool
+      for (int32_t j = 0; j < numOfSlots; ++j) {
+        int32_t i = pIndex[j];
+        if (pRows[j] == TIMESLICE_FILL_ROW && i > 0) {
+          SPoint start = {.key = pTs[i - 1], .val = colDataGetData(pSrc, i - 1)};
+          SPoint end = {.key = pTs[i], .val = colDataGetData(pSrc, i)};
+          SPoint current = {.key = pKeys[j], .val = p + (int64_t)j * pDst->info.bytes};
+          taosGetLinearInterpolationVal(&current, type, &start, &end, type);
+        }
+      }
+      break;
+  }
 
-  return TSDB_CODE_SUCCESS;
+  if (pSrc->hasNull) {
+    for (int32_t j = 0; j < numOfSlots; ++j) {
+      int32_t i = pIndex[j];
+      if (pRows[j] == TIMESLICE_FILL_ROW && i > 0 &&
+          (colDataIsNull_f(pSrc->nullbitmap, i - 1) || colDataIsNull_f(pSrc->nullbitmap, i))) {
+        colDataAppendNULL(pDst, offset + j);
+      }
+    }
+  }
 }
 
-static int32_t initNextRowsKeeper(STimeSliceOperatorInfo* pInfo, SSDataBlock* pBlock) {
-  if (pInfo->pNextRow != NULL) {
-    return TSDB_CODE_SUCCESS;
+// Fill one output column of the slots of the current batch: the slots on a row of the input block take the values of
+// the row, the others take the values generated by the fill mode. pBlock is NULL after the last input block.
+static void timeSliceFillColumn(STimeSliceOperatorInfo* pInfo, SExprInfo* pExprInfo, SFillColInfo* pFillCol,
+                                SColumnInfoData* pDst, const SSDataBlock* pBlock, int32_t offset,
+                                int32_t numOfSlots) {
+  if (IS_TIMESTAMP_TYPE(pExprInfo->base.resSchema.type)) {
+    memcpy((int64_t*)pDst->pData + offset, pInfo->pSlotKeys, numOfSlots * sizeof(int64_t));
+    return;
   }
 
-  pInfo->pNextRow = taosArrayInit(4, sizeof(SGroupKeys));
-  if (pInfo->pNextRow == NULL) {
-    return TSDB_CODE_OUT_OF_MEMORY;
+  int32_t          srcSlot = pExprInfo->base.pParam[0].pCol->slotId;
+  SColumnInfoData* pSrc = NULL;
+  const int64_t*   pTs = NULL;
+  int32_t          rows = 0;
+  if (pBlock != NULL) {
+    pSrc = taosArrayGet(pBlock->pDataBlock, srcSlot);
+    pTs = (const int64_t*)((SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, pInfo->tsCol.slotId))->pData;
+    rows = pBlock->info.rows;
   }
 
-  int32_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
-  for (int32_t i = 0; i < numOfCols; ++i) {
-    SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, i);
+  const SGroupKeys* pPrevKey = pInfo->isPrevRowSet ? taosArrayGet(pInfo->pPrevRow, srcSlot) : NULL;
+  int32_t           fillType = pInfo->fillType;
 
-    SGroupKeys key = {0};
-    key.bytes = pColInfo->info.bytes;
-    key.type = pColInfo->info.type;
-    key.isNull = false;
-    key.pData = taosMemoryCalloc(1, pColInfo->info.bytes);
-    taosArrayPush(pInfo->pNextRow, &key);
+  for (int32_t j = 0; j < numOfSlots; ++j) {
+    int32_t index = pInfo->pSlotIndex[j];
+    if ((index < rows && pTs[index] == pInfo->pSlotKeys[j]) || fillType == TSDB_FILL_NEXT) {
+      pInfo->pSlotRows[j] = index;
+    } else if (fillType == TSDB_FILL_PREV) {
+      pInfo->pSlotRows[j] = index - 1;  // TIMESLICE_PREV_ROW before the first row
+    } else {
+      pInfo->pSlotRows[j] = TIMESLICE_FILL_ROW;
+    }
   }
 
-  pInfo->isNextRowSet = false;
+  timeSliceCopyRows(pInfo, pDst, offset, pSrc, pPrevKey, numOfSlots);
 
-  return TSDB_CODE_SUCCESS;
+  switch (fillType) {
+    case TSDB_FILL_NULL: {
+      for (int32_t j = 0; j < numOfSlots; ++j) {
+        if (pInfo->pSlotRows[j] == TIMESLICE_FILL_ROW) {
+          colDataAppendNULL(pDst, offset + j);
+        }
+      }
+      break;
+    }
+    case TSDB_FILL_SET_VALUE:
+      timeSliceSetValues(pInfo, pDst, offset, &pFillCol->fillVal, numOfSlots);
+      break;
+    case TSDB_FILL_LINEAR:
+      timeSliceLinearValues(pInfo, pDst, offset, pSrc, pPrevKey, pTs, numOfSlots);
+      break;
+    default:
+      break;
+  }
 }
 
-static int32_t initFillLinearInfo(STimeSliceOperatorInfo* pInfo, SSDataBlock* pBlock) {
-  if (pInfo->pLinearInfo != NULL) {
+static int32_t timeSliceEnsureCapacity(SSDataBlock* pRes, int32_t numOfRows) {
+  if (numOfRows <= pRes->info.capacity) {
     return TSDB_CODE_SUCCESS;
   }
 
-  pInfo->pLinearInfo = taosArrayInit(4, sizeof(SFillLinearInfo));
-  if (pInfo->pLinearInfo == NULL) {
-    return TSDB_CODE_OUT_OF_MEMORY;
-  }
+  return blockDataEnsureCapacity(pRes, TMAX(numOfRows, pRes->info.capacity * 2));
+}
 
-  int32_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
-  for (int32_t i = 0; i < numOfCols; ++i) {
-    SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, i);
+// Output the slots up to endKey in batches, column by column. pBlock is NULL after the last input block.
+static void timeSliceProcessSlots(SOperatorInfo* pOperator, const SSDataBlock* pBlock, int64_t endKey) {
+  STimeSliceOperatorInfo* pSliceInfo = pOperator->info;
+  SExprSupp*              pSup = &pOperator->exprSupp;
+  SSDataBlock*            pResBlock = pSliceInfo->pRes;
 
-    SFillLinearInfo linearInfo = {0};
-    linearInfo.start.key = INT64_MIN;
-    linearInfo.end.key = INT64_MIN;
-    linearInfo.start.val = taosMemoryCalloc(1, pColInfo->info.bytes);
-    linearInfo.end.val = taosMemoryCalloc(1, pColInfo->info.bytes);
-    linearInfo.isStartSet = false;
-    linearInfo.isEndSet = false;
-    linearInfo.type = pColInfo->info.type;
-    linearInfo.bytes = pColInfo->info.bytes;
-    taosArrayPush(pInfo->pLinearInfo, &linearInfo);
+  const int64_t* pTs = NULL;
+  int32_t        rows = 0;
+  if (pBlock != NULL) {
+    pTs = (const int64_t*)((SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, pSliceInfo->tsCol.slotId))->pData;
+    rows = pBlock->info.rows;
   }
 
-  return TSDB_CODE_SUCCESS;
-}
+  while (pSliceInfo->current <= endKey) {
+    int32_t numOfSlots = timeSliceGenSlots(pSliceInfo, pTs, rows, endKey);
+    if (numOfSlots == 0) {
+      continue;
+    }
 
-static int32_t initKeeperInfo(STimeSliceOperatorInfo* pInfo, SSDataBlock* pBlock) {
-  int32_t code;
-  code = initPrevRowsKeeper(pInfo, pBlock);
-  if (code != TSDB_CODE_SUCCESS) {
-    return TSDB_CODE_FAILED;
-  }
+    int32_t code = timeSliceEnsureCapacity(pResBlock, pResBlock->info.rows + numOfSlots);
+    if (code != TSDB_CODE_SUCCESS) {
+      T_LONG_JMP(pOperator->pTaskInfo->env, code);
+    }
 
-  code = initNextRowsKeeper(pInfo, pBlock);
-  if (code != TSDB_CODE_SUCCESS) {
-    return TSDB_CODE_FAILED;
-  }
+    for (int32_t j = 0; j < pSup->numOfExprs; ++j) {
+      SExprInfo*       pExprInfo = &pSup->pExprInfo[j];
+      SColumnInfoData* pDst = taosArrayGet(pResBlock->pDataBlock, pExprInfo->base.resSchema.slotId);
+      timeSliceFillColumn(pSliceInfo, pExprInfo, &pSliceInfo->pFillColInfo[j], pDst, pBlock, pResBlock->info.rows,
+                          numOfSlots);
+    }
 
-  code = initFillLinearInfo(pInfo, pBlock);
-  if (code != TSDB_CODE_SUCCESS) {
-    return TSDB_CODE_FAILED;
+    pResBlock->info.rows += numOfSlots;
   }
-
-  return TSDB_CODE_SUCCESS;
 }
 
 static SSDataBlock* doTimeslice(SOperatorInfo* pOperator) {
@@ -408,7 +480,6 @@ static SSDataBlock* doTimeslice(SOperatorInfo* pOperator) {
   SExprSupp*              pSup = &pOperator->exprSupp;
 
   int32_t        order = TSDB_ORDER_ASC;
-  SInterval*     pInterval = &pSliceInfo->interval;
   SOperatorInfo* downstream = pOperator->pDownstream[0];
 
   blockDataCleanup(pResBlock);
@@ -419,7 +490,7 @@ static SSDataBlock* doTimeslice(SOperatorInfo* pOperator) {
       break;
     }
 
-    int32_t code = initKeeperInfo(pSliceInfo, pBlock);
+    int32_t code = initPrevRowsKeeper(pSliceInfo, pBlock);
     if (code != TSDB_CODE_SUCCESS) {
       T_LONG_JMP(pTaskInfo->env, code);
     }
@@ -427,94 +498,27 @@ static SSDataBlock* doTimeslice(SOperatorInfo* pOperator) {
     // the pDataBlock are always the same one, no need to call this again
     setInputDataBlock(pSup, pBlock, order, MAIN_SCAN, true);
 
-    SColumnInfoData* pTsCol = taosArrayGet(pBlock->pDataBlock, pSliceInfo->tsCol.slotId);
-    for (int32_t i = 0; i < pBlock->info.rows; ++i) {
-      int64_t ts = *(int64_t*)colDataGetData(pTsCol, i);
-
-      if (pSliceInfo->current > pSliceInfo->win.ekey) {
-        setOperatorCompleted(pOperator);
-        break;
-      }
-
-      if (ts == pSliceInfo->current) {
-        addCurrentRowToResult(pSliceInfo, &pOperator->exprSupp, pResBlock, pBlock, i);
-
-        doKeepPrevRows(pSliceInfo, pBlock, i);
-        doKeepLinearInfo(pSliceInfo, pBlock, i);
-
-        pSliceInfo->current =
-            taosTimeAdd(pSliceInfo->current, pInterval->interval, pInterval->intervalUnit, pInterval->precision);
-        if (pSliceInfo->current > pSliceInfo->win.ekey) {
-          setOperatorCompleted(pOperator);
-          break;
-        }
-      } else if (ts < pSliceInfo->current) {
-        // in case of interpolation window starts and ends between two datapoints, fill(prev) need to interpolate
-        doKeepPrevRows(pSliceInfo, pBlock, i);
-        doKeepLinearInfo(pSliceInfo, pBlock, i);
-
-        if (i < pBlock->info.rows - 1) {
-          // in case of interpolation window starts and ends between two datapoints, fill(next) need to interpolate
-          doKeepNextRows(pSliceInfo, pBlock, i + 1);
-          int64_t nextTs = *(int64_t*)colDataGetData(pTsCol, i + 1);
-          if (nextTs > pSliceInfo->current) {
-            while (pSliceInfo->current < nextTs && pSliceInfo->current <= pSliceInfo->win.ekey) {
-              if (!genInterpolationResult(pSliceInfo, &pOperator->exprSupp, pResBlock, false) && pSliceInfo->fillType == TSDB_FILL_LINEAR) {
-                break;
-              } else {
-                pSliceInfo->current =
-                    taosTimeAdd(pSliceInfo->current, pInterval->interval, pInterval->intervalUnit, pInterval->precision);
-              }
-            }
-
-            if (pSliceInfo->current > pSliceInfo->win.ekey) {
-              setOperatorCompleted(pOperator);
-              break;
-            }
-          } else {
-            // ignore current row, and do nothing
-          }
-        } else {  // it is the last row of current block
-          doKeepPrevRows(pSliceInfo, pBlock, i);
-        }
-      } else {  // ts > pSliceInfo->current
-        // in case of interpolation window starts and ends between two datapoints, fill(next) need to interpolate
-        doKeepNextRows(pSliceInfo, pBlock, i);
-        doKeepLinearInfo(pSliceInfo, pBlock, i);
-
-        while (pSliceInfo->current < ts && pSliceInfo->current <= pSliceInfo->win.ekey) {
-          if (!genInterpolationResult(pSliceInfo, &pOperator->exprSupp, pResBlock, true) && pSliceInfo->fillType == TSDB_FILL_LINEAR) {
-            break;
-          } else {
-            pSliceInfo->current =
-                taosTimeAdd(pSliceInfo->current, pInterval->interval, pInterval->intervalUnit, pInterval->precision);
-          }
-        }
-
-        // add current row if timestamp match
-        if (ts == pSliceInfo->current && pSliceInfo->current <= pSliceInfo->win.ekey) {
-          addCurrentRowToResult(pSliceInfo, &pOperator->exprSupp, pResBlock, pBlock, i);
+    int32_t rows = pBlock->info.rows;
+    if (rows == 0) {
+      continue;
+    }
 
-          pSliceInfo->current =
-              taosTimeAdd(pSliceInfo->current, pInterval->interval, pInterval->intervalUnit, pInterval->precision);
-        }
-        doKeepPrevRows(pSliceInfo, pBlock, i);
+    // the slots after the last row of the block are left to the next block, which has their next row
+    SColumnInfoData* pTsCol = taosArrayGet(pBlock->pDataBlock, pSliceInfo->tsCol.slotId);
+    int64_t          lastKey = *(int64_t*)colDataGetData(pTsCol, rows - 1);
+    timeSliceProcessSlots(pOperator, pBlock, TMIN(lastKey, pSliceInfo->win.ekey));
+    doKeepPrevRows(pSliceInfo, pBlock, rows - 1);
 
-        if (pSliceInfo->current > pSliceInfo->win.ekey) {
-          setOperatorCompleted(pOperator);
-          break;
-        }
-      }
+    if (pSliceInfo->current > pSliceInfo->win.ekey) {
+      setOperatorCompleted(pOperator);
+      break;
     }
   }
 
   // check if need to interpolate after last datablock
   // except for fill(next), fill(linear)
-  while (pSliceInfo->current <= pSliceInfo->win.ekey && pSliceInfo->fillType != TSDB_FILL_NEXT &&
-         pSliceInfo->fillType != TSDB_FILL_LINEAR) {
-    genInterpolationResult(pSliceInfo, &pOperator->exprSupp, pResBlock, false);
-    pSliceInfo->current =
-        taosTimeAdd(pSliceInfo->current, pInterval->interval, pInterval->intervalUnit, pInterval->precision);
+  if (pSliceInfo->fillType != TSDB_FILL_NEXT && pSliceInfo->fillType != TSDB_FILL_LINEAR) {
+    timeSliceProcessSlots(pOperator, NULL, pSliceInfo->win.ekey);
   }
 
   // restore the value
@@ -557,12 +561,19 @@ SOperatorInfo* createTimeSliceOperatorInfo(SOperatorInfo* downstream, SPhysiNode
   initResultSizeInfo(&pOperator->resultInfo, 4096);
 
   pInfo->pFillColInfo = createFillColInfo(pExprInfo, numOfExprs, NULL, 0, (SNodeListNode*)pInterpPhyNode->pFillValues);
-  pInfo->pLinearInfo = NULL;
   pInfo->pRes = createDataBlockFromDescNode(pPhyNode->pOutputDataBlockDesc);
   pInfo->win = pInterpPhyNode->timeRange;
   pInfo->interval.interval = pInterpPhyNode->interval;
   pInfo->current = pInfo->win.skey;
 
+  pInfo->slotCapacity = pOperator->resultInfo.capacity;
+  pInfo->pSlotKeys = taosMemoryMalloc(pInfo->slotCapacity * sizeof(int64_t));
+  pInfo->pSlotIndex = taosMemoryMalloc(pInfo->slotCapacity * sizeof(int32_t));
+  pInfo->pSlotRows = taosMemoryMalloc(pInfo->slotCapacity * sizeof(int32_t));
+  if (pInfo->pSlotKeys == NULL || pInfo->pSlotIndex == NULL || pInfo->pSlotRows == NULL) {
+    goto _error;
+  }
+
   if (downstream->operatorType == QUERY_NODE_PHYSICAL_PLAN_TABLE_SCAN) {
     STableScanInfo* pScanInfo = (STableScanInfo*)downstream->info;
     pScanInfo->base.cond.twindows = pInfo->win;
@@ -596,19 +607,9 @@ void destroyTimeSliceOperatorInfo(void* param) {
   }
   taosArrayDestroy(pInfo->pPrevRow);
 
-  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pNextRow); ++i) {
-    SGroupKeys* pKey = taosArrayGet(pInfo->pNextRow, i);
-    taosMemoryFree(pKey->pData);
-  }
-  taosArrayDestroy(pInfo->pNextRow);
-
-  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pLinearInfo); ++i) {
-    SFillLinearInfo* pKey = taosArrayGet(pInfo->pLinearInfo, i);
-    taosMemoryFree(pKey->start.val);
-    taosMemoryFree(pKey->end.val);
-  }
-  taosArrayDestroy(pInfo->pLinearInfo);
-
+  taosMemoryFree(pInfo->pSlotKeys);
+  taosMemoryFree(pInfo->pSlotIndex);
+  taosMemoryFree(pInfo->pSlotRows);
   taosMemoryFree(pInfo->pFillColInfo);
   taosMemoryFreeClear(param);
 }
@@ -939,6 +939,17 @@ static void hashIntervalAgg(SOperatorInfo* pOperatorInfo, SResultRowInfo* pResul
   if (ret != TSDB_CODE_SUCCESS || pResult == NULL) {
     T_LONG_JMP(pTaskInfo->env, TSDB_CODE_OUT_OF_MEMORY);
   }
+
+  // only the SMA of the block is loaded, since the table scan guarantees it lies within this single window
+  if (tsCols == NULL && pBlock->pBlockAgg != NULL) {
+    ASSERT(pBlock->info.window.skey >= win.skey && pBlock->info.window.ekey <= win.ekey);
+    updateTimeWindowInfo(&pInfo->twAggSup.timeWindowData, &win, true);
+    applyAggFunctionOnPartialTuples(pTaskInfo, pSup->pCtx, &pInfo->twAggSup.timeWindowData, 0, pBlock->info.rows,
+                                    pBlock->info.rows, numOfOutput);
+    doCloseWindow(pResultRowInfo, pInfo, pResult);
+    return;
+  }
+
   TSKEY   ekey = ascScan ? win.ekey : win.skey;
   int32_t forwardRows =
       getNumOfRowsInTimeWindow(&pBlock->info, tsCols, startPos, ekey, binarySearchForKey, NULL, pInfo->inputOrder);
@@ -4144,21 +4155,22 @@ static void doMergeAlignedIntervalAggImpl(SOperatorInfo* pOperatorInfo, SResultR
 
   TSKEY ts = getStartTsKey(&pBlock->info.window, tsCols);
 
+  // The input is sorted by timestamp in each group, either the partial results of which the timestamp is the start of
+  // the window already, or the rows of all tables in the group from the table merge scan. The rows in
+  // [skey, skey + sliding) fall into the window starting from skey, so the window is done once a row out of it arrives.
+  STimeWindow win = getAlignQueryTimeWindow(pInterval, pInterval->precision, ts);
+
   // there is an result exists
   if (miaInfo->curTs != INT64_MIN) {
-    if (ts != miaInfo->curTs) {
+    if (win.skey != miaInfo->curTs) {
       finalizeResultRows(iaInfo->aggSup.pResultBuf, &pResultRowInfo->cur, pSup, pResultBlock, pTaskInfo);
       resetResultRow(miaInfo->pResultRow, iaInfo->aggSup.resultRowSize - sizeof(SResultRow));
-      miaInfo->curTs = ts;
+      miaInfo->curTs = win.skey;
     }
   } else {
-    miaInfo->curTs = ts;
+    miaInfo->curTs = win.skey;
   }
 
-  STimeWindow win = {0};
-  win.skey = miaInfo->curTs;
-  win.ekey = taosTimeAdd(win.skey, pInterval->interval, pInterval->intervalUnit, pInterval->precision) - 1;
-
   int32_t ret = setSingleOutputTupleBuf(pResultRowInfo, &win, &miaInfo->pResultRow, pSup, &iaInfo->aggSup);
   if (ret != TSDB_CODE_SUCCESS || miaInfo->pResultRow == NULL) {
     T_LONG_JMP(pTaskInfo->env, ret);
@@ -4167,8 +4179,9 @@ static void doMergeAlignedIntervalAggImpl(SOperatorInfo* pOperatorInfo, SResultR
   int32_t currPos = startPos;
 
   STimeWindow currWin = win;
+  TSKEY       nextSkey = taosTimeAdd(currWin.skey, pInterval->sliding, pInterval->slidingUnit, pInterval->precision);
   while (++currPos < pBlock->info.rows) {
-    if (tsCols[currPos] == miaInfo->curTs) {
+    if (tsCols[currPos] >= currWin.skey && tsCols[currPos] < nextSkey) {
       continue;
     }
 
@@ -4178,13 +4191,12 @@ static void doMergeAlignedIntervalAggImpl(SOperatorInfo* pOperatorInfo, SResultR
 
     finalizeResultRows(iaInfo->aggSup.pResultBuf, &pResultRowInfo->cur, pSup, pResultBlock, pTaskInfo);
     resetResultRow(miaInfo->pResultRow, iaInfo->aggSup.resultRowSize - sizeof(SResultRow));
-    miaInfo->curTs = tsCols[currPos];
 
-    currWin.skey = miaInfo->curTs;
-    currWin.ekey = taosTimeAdd(currWin.skey, pInterval->interval, pInterval->intervalUnit, pInterval->precision) - 1;
+    currWin = getAlignQueryTimeWindow(pInterval, pInterval->precision, tsCols[currPos]);
+    nextSkey = taosTimeAdd(currWin.skey, pInterval->sliding, pInterval->slidingUnit, pInterval->precision);
 
     startPos = currPos;
-    ret = setSingleOutputTupleBuf(pResultRowInfo, &win, &miaInfo->pResultRow, pSup, &iaInfo->aggSup);
+    ret = setSingleOutputTupleBuf(pResultRowInfo, &currWin, &miaInfo->pResultRow, pSup, &iaInfo->aggSup);
     if (ret != TSDB_CODE_SUCCESS || miaInfo->pResultRow == NULL) {
       T_LONG_JMP(pTaskInfo->env, ret);
     }
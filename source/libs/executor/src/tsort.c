@@ -19,6 +19,7 @@
 #include "tcompare.h"
 #include "tdatablock.h"
 #include "tdef.h"
+#include "theap.h"
 #include "tlosertree.h"
 #include "tpagedbuf.h"
 #include "tsort.h"
@@ -49,6 +50,8 @@ struct SSortHandle {
   const char*       idStr;
   bool              inMemSort;
   bool              needAdjust;
+  bool              topK;
+  int64_t           maxRows;
   STupleHandle      tupleHandle;
   void*             param;
   void (*beforeFp)(SSDataBlock* pBlock, void* param);
@@ -58,6 +61,25 @@ struct SSortHandle {
   SMultiwayMergeTreeInfo* pMergeTree;
 };
 
+typedef struct STopKInfo STopKInfo;
+
+typedef struct STopKNode {
+  HeapNode   node;
+  STopKInfo* pInfo;
+  int32_t    rowIndex;
+} STopKNode;
+
+// The candidate rows are kept in pHandle->pDataBlock in arbitrary order, the root of the heap is the candidate that
+// sorts last, i.e., the one to be evicted when a better row arrives.
+struct STopKInfo {
+  SSortHandle* pHandle;
+  Heap*        pHeap;
+  STopKNode*   pNodes;
+  int32_t      maxRows;
+  int32_t      numOfReplaced;
+  bool         hasVarCol;
+};
+
 static int32_t msortComparFn(const void* pLeft, const void* pRight, void* param);
 
 SSDataBlock* tsortGetSortedDataBlock(const SSortHandle* pSortHandle) {
@@ -101,6 +123,7 @@ static int32_t sortComparCleanup(SMsortComparParam* cmpParam) {
   for (int32_t i = 0; i < cmpParam->numOfSources; ++i) {
     SSortSource* pSource = cmpParam->pSources[i];
     blockDataDestroy(pSource->src.pBlock);
+    taosMemoryFree(pSource->pSortKeys);
     taosMemoryFreeClear(pSource);
   }
 
@@ -121,6 +144,7 @@ void tsortClearOrderdSource(SArray *pOrderedSource) {
     if ((*pSource)->param && !(*pSource)->onlyRef) {
       taosMemoryFree((*pSource)->param);
     }
+    taosMemoryFree((*pSource)->pSortKeys);
     taosMemoryFreeClear(*pSource);
   }
 
@@ -234,6 +258,51 @@ static void setCurrentSourceDone(SSortSource* pSource, SSortHandle* pHandle) {
   ++pHandle->numOfCompletedSources;
 }
 
+static int32_t sortSourceBuildKeys(SMsortComparParam* pParam, SSortSource* pSource) {
+  SSDataBlock* pBlock = pSource->src.pBlock;
+  int64_t      len = (int64_t)pBlock->info.rows * pParam->sortKeyLen;
+  if (len > pSource->keyBufLen) {
+    char* p = taosMemoryRealloc(pSource->pSortKeys, len);
+    if (p == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+    pSource->pSortKeys = p;
+    pSource->keyBufLen = len;
+  }
+
+  blockDataBuildSortKeys(pBlock, pParam->orderInfo, pSource->pSortKeys, pParam->sortKeyLen);
+  return TSDB_CODE_SUCCESS;
+}
+
+// The rows of the sources are compared by the normalized sort keys in the merge, if the default compare function is
+// used and all the order columns are of fixed length. The keys of a block are built once it is loaded.
+static int32_t sortComparInitKeys(SMsortComparParam* pParam, SSortHandle* pHandle) {
+  pParam->sortKeyLen = 0;
+  if (pHandle->comparFn != msortComparFn) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  for (int32_t i = 0; i < pParam->numOfSources; ++i) {
+    SSortSource* pSource = pParam->pSources[i];
+    if (pSource->src.pBlock != NULL && pSource->src.rowIndex != -1) {
+      pParam->sortKeyLen = blockDataGetSortKeyLen(pSource->src.pBlock, pParam->orderInfo);
+      break;
+    }
+  }
+
+  for (int32_t i = 0; i < pParam->numOfSources && pParam->sortKeyLen > 0; ++i) {
+    SSortSource* pSource = pParam->pSources[i];
+    if (pSource->src.pBlock != NULL && pSource->src.rowIndex != -1) {
+      int32_t code = sortSourceBuildKeys(pParam, pSource);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static int32_t sortComparInit(SMsortComparParam* pParam, SArray* pSources, int32_t startIndex, int32_t endIndex,
                               SSortHandle* pHandle) {
   pParam->pSources = taosArrayGet(pSources, startIndex);
@@ -295,7 +364,7 @@ static int32_t sortComparInit(SMsortComparParam* pParam, SArray* pSources, int32
     qDebug("init for merge sort completed, elapsed time:%.2f ms, %s", (et - st) / 1000.0, pHandle->idStr);
   }
 
-  return code;
+  return sortComparInitKeys(pParam, pHandle);
 }
 
 static void appendOneRowToDataBlock(SSDataBlock* pBlock, const SSDataBlock* pSource, int32_t* rowIndex) {
@@ -351,6 +420,13 @@ static int32_t adjustMergeTreeForNextTuple(SSortSource* pSource, SMultiwayMergeT
         pSource->src.rowIndex = -1;
       }
     }
+
+    if (pHandle->cmpParam.sortKeyLen > 0 && pSource->src.rowIndex != -1) {
+      int32_t code = sortSourceBuildKeys(&pHandle->cmpParam, pSource);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
   }
 
   /*
@@ -429,6 +505,12 @@ int32_t msortComparFn(const void* pLeft, const void* pRight, void* param) {
     }
   }
 
+  if (pParam->sortKeyLen > 0) {
+    int32_t len = pParam->sortKeyLen;
+    return memcmp(pLeftSource->pSortKeys + (int64_t)pLeftSource->src.rowIndex * len,
+                  pRightSource->pSortKeys + (int64_t)pRightSource->src.rowIndex * len, len);
+  }
+
   for (int32_t i = 0; i < pInfo->size; ++i) {
     SBlockOrderInfo* pOrder = TARRAY_GET_ELEM(pInfo, i);
     SColumnInfoData* pLeftColInfoData = TARRAY_GET_ELEM(pLeftBlock->pDataBlock, pOrder->slotId);
@@ -615,6 +697,172 @@ int32_t getProperSortPageSize(size_t rowSize, uint32_t numOfCols) {
   return pgSize;
 }
 
+static int32_t tsortCompareRow(SArray* pOrderInfo, const SSDataBlock* pLeftBlock, int32_t leftIndex,
+                               const SSDataBlock* pRightBlock, int32_t rightIndex) {
+  for (int32_t i = 0; i < pOrderInfo->size; ++i) {
+    SBlockOrderInfo* pOrder = TARRAY_GET_ELEM(pOrderInfo, i);
+    SColumnInfoData* pLeftColInfoData = TARRAY_GET_ELEM(pLeftBlock->pDataBlock, pOrder->slotId);
+    SColumnInfoData* pRightColInfoData = TARRAY_GET_ELEM(pRightBlock->pDataBlock, pOrder->slotId);
+
+    bool leftNull = colDataIsNull_s(pLeftColInfoData, leftIndex);
+    bool rightNull = colDataIsNull_s(pRightColInfoData, rightIndex);
+    if (leftNull && rightNull) {
+      continue;  // continue to next slot
+    }
+
+    if (rightNull) {
+      return pOrder->nullFirst ? 1 : -1;
+    }
+
+    if (leftNull) {
+      return pOrder->nullFirst ? -1 : 1;
+    }
+
+    void* left1 = colDataGetData(pLeftColInfoData, leftIndex);
+    void* right1 = colDataGetData(pRightColInfoData, rightIndex);
+
+    __compar_fn_t fn = getKeyComparFunc(pLeftColInfoData->info.type, pOrder->order);
+
+    int ret = fn(left1, right1);
+    if (ret != 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+static int32_t topKNodeComparFn(const HeapNode* a, const HeapNode* b) {
+  const STopKNode* pLeft = (const STopKNode*)a;
+  const STopKNode* pRight = (const STopKNode*)b;
+  SSortHandle*     pHandle = pLeft->pInfo->pHandle;
+
+  return tsortCompareRow(pHandle->pSortInfo, pHandle->pDataBlock, pLeft->rowIndex, pHandle->pDataBlock,
+                         pRight->rowIndex) > 0;
+}
+
+static int32_t topKSetRow(SSDataBlock* pBlock, int32_t rowIndex, const SSDataBlock* pSource, int32_t srcIndex) {
+  for (int32_t i = 0; i < taosArrayGetSize(pBlock->pDataBlock); ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, i);
+    SColumnInfoData* pSrcColInfo = taosArrayGet(pSource->pDataBlock, i);
+
+    if (colDataIsNull_s(pSrcColInfo, srcIndex)) {
+      colDataAppendNULL(pColInfo, rowIndex);
+      continue;
+    }
+
+    int32_t code = colDataAppend(pColInfo, rowIndex, colDataGetData(pSrcColInfo, srcIndex), false);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+
+    // the slot may be reused from an evicted null value
+    if (!IS_VAR_DATA_TYPE(pColInfo->info.type)) {
+      colDataClearNull_f(pColInfo->nullbitmap, rowIndex);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t topKInfoCreate(SSortHandle* pHandle, STopKInfo** pTopK) {
+  STopKInfo* pInfo = taosMemoryCalloc(1, sizeof(STopKInfo));
+  if (pInfo == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pInfo->pHandle = pHandle;
+  pInfo->maxRows = pHandle->maxRows;
+  pInfo->pHeap = heapCreate(topKNodeComparFn);
+  pInfo->pNodes = taosMemoryCalloc(pInfo->maxRows, sizeof(STopKNode));
+  if (pInfo->pHeap == NULL || pInfo->pNodes == NULL ||
+      blockDataEnsureCapacity(pHandle->pDataBlock, pInfo->maxRows) != TSDB_CODE_SUCCESS) {
+    heapDestroy(pInfo->pHeap);
+    taosMemoryFree(pInfo->pNodes);
+    taosMemoryFree(pInfo);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < taosArrayGetSize(pHandle->pDataBlock->pDataBlock); ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pHandle->pDataBlock->pDataBlock, i);
+    if (IS_VAR_DATA_TYPE(pColInfo->info.type)) {
+      pInfo->hasVarCol = true;
+    }
+  }
+
+  *pTopK = pInfo;
+  return TSDB_CODE_SUCCESS;
+}
+
+static void topKInfoDestroy(STopKInfo* pInfo) {
+  if (pInfo == NULL) {
+    return;
+  }
+
+  heapDestroy(pInfo->pHeap);
+  taosMemoryFree(pInfo->pNodes);
+  taosMemoryFree(pInfo);
+}
+
+// The values of the evicted rows are left in the buffer of the var type columns, so the candidate block is rebuilt
+// once as many rows as it holds have been replaced. The row indexes are kept by the rebuilding.
+static int32_t topKCompactBlock(STopKInfo* pInfo) {
+  SSortHandle* pHandle = pInfo->pHandle;
+  SSDataBlock* pBlock = blockDataExtractBlock(pHandle->pDataBlock, 0, pHandle->pDataBlock->info.rows);
+  if (pBlock == NULL || blockDataEnsureCapacity(pBlock, pInfo->maxRows) != TSDB_CODE_SUCCESS) {
+    blockDataDestroy(pBlock);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  blockDataDestroy(pHandle->pDataBlock);
+  pHandle->pDataBlock = pBlock;
+  pInfo->numOfReplaced = 0;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t topKAddBlock(STopKInfo* pInfo, const SSDataBlock* pBlock) {
+  SSortHandle* pHandle = pInfo->pHandle;
+
+  for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+    SSDataBlock* pDataBlock = pHandle->pDataBlock;
+    int32_t      code = TSDB_CODE_SUCCESS;
+
+    if (pDataBlock->info.rows < pInfo->maxRows) {
+      STopKNode* pNode = &pInfo->pNodes[pDataBlock->info.rows];
+      code = topKSetRow(pDataBlock, pDataBlock->info.rows, pBlock, i);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+
+      pNode->pInfo = pInfo;
+      pNode->rowIndex = pDataBlock->info.rows;
+      pDataBlock->info.rows += 1;
+      heapInsert(pInfo->pHeap, &pNode->node);
+      continue;
+    }
+
+    STopKNode* pWorst = (STopKNode*)heapMin(pInfo->pHeap);
+    if (tsortCompareRow(pHandle->pSortInfo, pBlock, i, pDataBlock, pWorst->rowIndex) >= 0) {
+      continue;
+    }
+
+    // the node must be out of the heap before its row is overwritten
+    heapDequeue(pInfo->pHeap);
+    code = topKSetRow(pDataBlock, pWorst->rowIndex, pBlock, i);
+    heapInsert(pInfo->pHeap, &pWorst->node);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+
+    pInfo->numOfReplaced += 1;
+  }
+
+  if (pInfo->hasVarCol && pInfo->numOfReplaced >= pInfo->maxRows) {
+    return topKCompactBlock(pInfo);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static int32_t createInitialSources(SSortHandle* pHandle) {
   size_t sortBufSize = pHandle->numOfPages * pHandle->pageSize;
 
@@ -625,12 +873,14 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
     
     tsortClearOrderdSource(pHandle->pOrderedSource);
 
+    STopKInfo* pTopK = NULL;
     while (1) {
       SSDataBlock* pBlock = pHandle->fetchfp(source->param);
       if (pBlock == NULL) {
         break;
       }
 
+      int32_t code = TSDB_CODE_SUCCESS;
       if (pHandle->pDataBlock == NULL) {
         uint32_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
         pHandle->pageSize = getProperSortPageSize(blockDataGetRowSize(pBlock), numOfCols);
@@ -639,14 +889,29 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
         pHandle->numOfPages = 1024;
         sortBufSize = pHandle->numOfPages * pHandle->pageSize;
         pHandle->pDataBlock = createOneDataBlock(pBlock, false);
+
+        // the top k rows always fit in the sort buffer, so they are selected by a bounded heap without spilling
+        if (pHandle->maxRows > 0 && pHandle->maxRows * blockDataGetRowSize(pBlock) <= sortBufSize) {
+          code = topKInfoCreate(pHandle, &pTopK);
+        }
       }
 
       if (pHandle->beforeFp != NULL) {
         pHandle->beforeFp(pBlock, pHandle->param);
       }
 
-      int32_t code = blockDataMerge(pHandle->pDataBlock, pBlock);
+      if (code == TSDB_CODE_SUCCESS) {
+        if (pTopK != NULL) {
+          int64_t p = taosGetTimestampUs();
+          code = topKAddBlock(pTopK, pBlock);
+          pHandle->sortElapsed += (taosGetTimestampUs() - p);
+        } else {
+          code = blockDataMerge(pHandle->pDataBlock, pBlock);
+        }
+      }
+
       if (code != 0) {
+        topKInfoDestroy(pTopK);
         if (source->param && !source->onlyRef) {
           taosMemoryFree(source->param);
         }
@@ -654,6 +919,10 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
         return code;
       }
 
+      if (pTopK != NULL) {
+        continue;
+      }
+
       size_t size = blockDataGetSize(pHandle->pDataBlock);
       if (size > sortBufSize) {
         // Perform the in-memory sort and then flush data in the buffer into disk.
@@ -670,7 +939,14 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
         int64_t el = taosGetTimestampUs() - p;
         pHandle->sortElapsed += el;
 
-        doAddToBuf(pHandle->pDataBlock, pHandle);
+        code = doAddToBuf(pHandle->pDataBlock, pHandle);
+        if (code != 0) {
+          if (source->param && !source->onlyRef) {
+            taosMemoryFree(source->param);
+          }
+          taosMemoryFree(source);
+          return code;
+        }
       }
     }
 
@@ -679,6 +955,11 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
     }
     taosMemoryFree(source);
 
+    if (pTopK != NULL) {
+      topKInfoDestroy(pTopK);
+      pHandle->topK = true;
+    }
+
     if (pHandle->pDataBlock != NULL && pHandle->pDataBlock->info.rows > 0) {
       size_t size = blockDataGetSize(pHandle->pDataBlock);
 
@@ -694,7 +975,7 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
       pHandle->sortElapsed += el;
 
       // All sorted data can fit in memory, external memory sort is not needed. Return to directly
-      if (size <= sortBufSize && pHandle->pBuf == NULL) {
+      if ((size <= sortBufSize || pHandle->topK) && pHandle->pBuf == NULL) {
         pHandle->cmpParam.numOfSources = 1;
         pHandle->inMemSort = true;
 
@@ -703,7 +984,10 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
         pHandle->tupleHandle.pBlock = pHandle->pDataBlock;
         return 0;
       } else {
-        doAddToBuf(pHandle->pDataBlock, pHandle);
+        code = doAddToBuf(pHandle->pDataBlock, pHandle);
+        if (code != 0) {
+          return code;
+        }
       }
     }
   }
@@ -773,6 +1057,11 @@ int32_t tsortSetCompareGroupId(SSortHandle* pHandle, bool compareGroupId) {
   return TSDB_CODE_SUCCESS;
 }
 
+int32_t tsortSetMaxRows(SSortHandle* pHandle, int64_t maxRows) {
+  pHandle->maxRows = (maxRows > 0 && maxRows <= INT32_MAX) ? maxRows : 0;
+  return TSDB_CODE_SUCCESS;
+}
+
 STupleHandle* tsortNextTuple(SSortHandle* pHandle) {
   if (pHandle->cmpParam.numOfSources == pHandle->numOfCompletedSources) {
     return NULL;
@@ -843,7 +1132,11 @@ SSortExecInfo tsortGetSortExecInfo(SSortHandle* pHandle) {
     info.sortBuffer = 2 * 1048576;  // 2mb by default
   } else {
     info.sortBuffer = pHandle->pageSize * pHandle->numOfPages;
-    info.sortMethod = pHandle->inMemSort ? SORT_QSORT_T : SORT_SPILLED_MERGE_SORT_T;
+    if (pHandle->topK) {
+      info.sortMethod = SORT_TOPK_T;
+    } else {
+      info.sortMethod = pHandle->inMemSort ? SORT_QSORT_T : SORT_SPILLED_MERGE_SORT_T;
+    }
     info.loops = pHandle->loops;
 
     if (pHandle->pBuf != NULL) {
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "function.h"
+#include "tdatablock.h"
+#include "tfill.h"
+
+// Fill sparse interval results, one input row every 100 windows like interval(1s) over data of every 100s, with each
+// fill mode, and check the values of the filled rows.
+
+namespace {
+
+const int64_t kFillTestTsStart = 1600000000000;
+const int64_t kFillTestInterval = 1000;
+const int32_t kFillTestGap = 100;
+const int32_t kFillTestCapacity = 4096;
+const int64_t kFillTestValue = 7;
+
+// col 0: timestamp, col 1: int, col 2: double
+SSDataBlock* createFillTestBlock(int32_t capacity) {
+  SSDataBlock*    pBlock = createDataBlock();
+  SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 1);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  colInfo = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 2);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  colInfo = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 3);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  blockDataEnsureCapacity(pBlock, capacity);
+  return pBlock;
+}
+
+// the values of the row of the k-th window are k
+SSDataBlock* createFillTestInput(int32_t rows) {
+  SSDataBlock*     pBlock = createFillTestBlock(rows);
+  SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pIntCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  SColumnInfoData* pDoubleCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2);
+  for (int32_t i = 0; i < rows; ++i) {
+    int32_t k = i * kFillTestGap;
+    int64_t ts = kFillTestTsStart + k * kFillTestInterval;
+    double  d = k;
+    colDataAppend(pTsCol, i, (const char*)&ts, false);
+    colDataAppend(pIntCol, i, (const char*)&k, false);
+    colDataAppend(pDoubleCol, i, (const char*)&d, false);
+  }
+  pBlock->info.rows = rows;
+  return pBlock;
+}
+
+void initFillTestExpr(SExprInfo* pExpr, int16_t slotId, int8_t type, int32_t bytes, int16_t colType) {
+  pExpr->base.resSchema.slotId = slotId;
+  pExpr->base.resSchema.type = type;
+  pExpr->base.resSchema.bytes = bytes;
+  pExpr->pExpr = (tExprNode*)taosMemoryCalloc(1, sizeof(tExprNode));
+  pExpr->pExpr->nodeType = QUERY_NODE_COLUMN;
+  pExpr->base.numOfParams = 1;
+  pExpr->base.pParam = (SFunctParam*)taosMemoryCalloc(1, sizeof(SFunctParam));
+  pExpr->base.pParam[0].pCol = (SColumn*)taosMemoryCalloc(1, sizeof(SColumn));
+  pExpr->base.pParam[0].pCol->colType = colType;
+}
+
+void cleanupFillTestExpr(SExprInfo* pExpr) {
+  taosMemoryFree(pExpr->base.pParam[0].pCol);
+  taosMemoryFree(pExpr->base.pParam);
+  taosMemoryFree(pExpr->pExpr);
+}
+
+// the expected int value of the k-th window, or false if it is NULL
+bool getFillTestExpect(int32_t fillType, int32_t k, int64_t* pVal) {
+  if (k % kFillTestGap == 0) {
+    *pVal = k;
+    return true;
+  }
+  switch (fillType) {
+    case TSDB_FILL_PREV:
+      *pVal = k / kFillTestGap * kFillTestGap;
+      return true;
+    case TSDB_FILL_NEXT:
+      *pVal = (k / kFillTestGap + 1) * kFillTestGap;
+      return true;
+    case TSDB_FILL_LINEAR:
+      *pVal = k;
+      return true;
+    case TSDB_FILL_SET_VALUE:
+      *pVal = kFillTestValue;
+      return true;
+    default:
+      return false;
+  }
+}
+
+void runFillTest(int32_t fillType) {
+  const int32_t rows = 10000;
+  SSDataBlock*  pInput = createFillTestInput(rows);
+  SSDataBlock*  pRes = createFillTestBlock(kFillTestCapacity);
+
+  SExprInfo exprs[3] = {0};
+  initFillTestExpr(&exprs[0], 1, TSDB_DATA_TYPE_INT, sizeof(int32_t), COLUMN_TYPE_COLUMN);
+  initFillTestExpr(&exprs[1], 2, TSDB_DATA_TYPE_DOUBLE, sizeof(double), COLUMN_TYPE_COLUMN);
+  initFillTestExpr(&exprs[2], 0, TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), COLUMN_TYPE_WINDOW_START);
+
+  SFillColInfo* pCols = (SFillColInfo*)taosMemoryCalloc(3, sizeof(SFillColInfo));
+  for (int32_t i = 0; i < 3; ++i) {
+    pCols[i].pExpr = &exprs[i];
+    pCols[i].notFillCol = (i == 2);
+    pCols[i].fillVal.nType = TSDB_DATA_TYPE_BIGINT;
+    pCols[i].fillVal.i = kFillTestValue;
+  }
+
+  SInterval interval = {0};
+  interval.interval = kFillTestInterval;
+  interval.sliding = kFillTestInterval;
+  interval.intervalUnit = 'a';
+  interval.slidingUnit = 'a';
+  interval.precision = TSDB_TIME_PRECISION_MILLI;
+
+  SFillInfo* pFillInfo = taosCreateFillInfo(kFillTestTsStart, 2, 1, kFillTestCapacity, &interval, fillType, pCols, 0,
+                                            TSDB_ORDER_ASC, "fillTest");
+  ASSERT_NE(pFillInfo, nullptr);
+
+  int64_t lastTs = *(int64_t*)colDataGetData((SColumnInfoData*)taosArrayGet(pInput->pDataBlock, 0), rows - 1);
+  taosFillSetStartInfo(pFillInfo, rows, lastTs);
+  taosFillSetInputDataBlock(pFillInfo, pInput);
+
+  int64_t total = 0;
+  while (taosFillHasMoreResults(pFillInfo)) {
+    blockDataCleanup(pRes);
+    taosFillResultDataBlock(pFillInfo, pRes, kFillTestCapacity);
+
+    SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 0);
+    SColumnInfoData* pIntCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 1);
+    SColumnInfoData* pDoubleCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 2);
+    for (int32_t i = 0; i < pRes->info.rows; ++i) {
+      int32_t k = (int32_t)(total + i);
+      ASSERT_EQ(*(int64_t*)colDataGetData(pTsCol, i), kFillTestTsStart + k * kFillTestInterval);
+
+      int64_t expect = 0;
+      bool    notNull = getFillTestExpect(fillType, k, &expect);
+      ASSERT_EQ(colDataIsNull_f(pIntCol->nullbitmap, i), !notNull);
+      ASSERT_EQ(colDataIsNull_f(pDoubleCol->nullbitmap, i), !notNull);
+      if (notNull) {
+        ASSERT_EQ(*(int32_t*)colDataGetData(pIntCol, i), expect);
+        ASSERT_DOUBLE_EQ(*(double*)colDataGetData(pDoubleCol, i), (double)expect);
+      }
+    }
+    total += pRes->info.rows;
+  }
+
+  ASSERT_EQ(total, (int64_t)(rows - 1) * kFillTestGap + 1);
+
+  taosDestroyFillInfo(pFillInfo);
+  for (int32_t i = 0; i < 3; ++i) {
+    cleanupFillTestExpr(&exprs[i]);
+  }
+  blockDataDestroy(pInput);
+  blockDataDestroy(pRes);
+}
+
+}  // namespace
+
+TEST(fillTest, sparseInterval) {
+  runFillTest(TSDB_FILL_NULL);
+  runFillTest(TSDB_FILL_SET_VALUE);
+  runFillTest(TSDB_FILL_PREV);
+  runFillTest(TSDB_FILL_NEXT);
+  runFillTest(TSDB_FILL_LINEAR);
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,450 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "functionMgt.h"
+#include "plannodes.h"
+#include "tdatablock.h"
+#include "tglobal.h"
+
+// Aggregate generated rows with the interval operator, like select _wstart, count(v), sum(v), min(v), max(v) ...
+// interval(1s), once with every block loaded, and once with the blocks within a single window given as block SMA
+// only, as the table scan does when the functions are computed from SMA, and check both against the rows.
+// Also aggregate the rows of several tables of each partition merged by timestamp, as the table merge scan gives them,
+// with the merge aligned interval operator, like ... partition by tbname interval(1s).
+
+namespace {
+
+const int64_t kIntervalTsStart = 1600000000000;
+const int64_t kIntervalGap = 10;
+const int64_t kInterval = 1000;
+
+typedef std::tuple<int64_t, int64_t, int64_t, int64_t> SIntervalRes;  // count, sum, min, max
+
+typedef struct SIntervalTestSource {
+  std::vector<int32_t> blockRows;
+  int32_t              iBlock;
+  int64_t              seq;
+  bool                 smaOnly;  // the blocks within a single window are given as SMA only
+  SColumnDataAgg       agg;
+  SColumnDataAgg*      pAgg[2];
+  SSDataBlock*         pBlock;
+} SIntervalTestSource;
+
+// NULL for every 9th row
+bool intervalTestValue(int64_t seq, int64_t* pVal) {
+  if (seq % 9 == 0) {
+    return false;
+  }
+  *pVal = (seq * 37) % 1001 - 500;
+  return true;
+}
+
+// col 0: timestamp, col 1: bigint
+SSDataBlock* getIntervalTestBlock(SOperatorInfo* pOperator) {
+  SIntervalTestSource* pSource = (SIntervalTestSource*)pOperator->info;
+  if (pSource->iBlock >= (int32_t)pSource->blockRows.size()) {
+    return NULL;
+  }
+
+  if (pSource->pBlock == NULL) {
+    pSource->pBlock = createDataBlock();
+    SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 1);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+    colInfo = createColumnInfoData(TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), 2);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+  } else {
+    blockDataCleanup(pSource->pBlock);
+  }
+
+  SSDataBlock* pBlock = pSource->pBlock;
+  int32_t      rows = pSource->blockRows[pSource->iBlock++];
+  int64_t      skey = kIntervalTsStart + pSource->seq * kIntervalGap;
+  int64_t      ekey = skey + (rows - 1) * kIntervalGap;
+
+  pBlock->info.window.skey = skey;
+  pBlock->info.window.ekey = ekey;
+  pBlock->pBlockAgg = NULL;
+  blockDataEnsureCapacity(pBlock, rows);
+
+  if (pSource->smaOnly && (skey - kIntervalTsStart) / kInterval == (ekey - kIntervalTsStart) / kInterval) {
+    SColumnDataAgg* pAgg = &pSource->agg;
+    *pAgg = (SColumnDataAgg){.colId = 2, .numOfNull = 0, .sum = 0, .max = INT64_MIN, .min = INT64_MAX};
+    for (int32_t i = 0; i < rows; ++i) {
+      int64_t v = 0;
+      if (!intervalTestValue(pSource->seq++, &v)) {
+        pAgg->numOfNull++;
+        continue;
+      }
+      pAgg->sum += v;
+      pAgg->min = TMIN(pAgg->min, v);
+      pAgg->max = TMAX(pAgg->max, v);
+    }
+
+    pSource->pAgg[0] = NULL;
+    pSource->pAgg[1] = pAgg;
+    pBlock->pBlockAgg = pSource->pAgg;
+    pBlock->info.dataLoad = 0;
+    pBlock->info.rows = rows;
+    return pBlock;
+  }
+
+  SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pValCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  for (int32_t i = 0; i < rows; ++i) {
+    int64_t seq = pSource->seq++;
+    int64_t ts = kIntervalTsStart + seq * kIntervalGap;
+    int64_t v = 0;
+    bool    isNull = !intervalTestValue(seq, &v);
+    colDataAppend(pTsCol, i, (const char*)&ts, false);
+    colDataAppend(pValCol, i, (const char*)&v, isNull);
+  }
+
+  pBlock->info.dataLoad = 1;
+  pBlock->info.rows = rows;
+  return pBlock;
+}
+
+SNode* createIntervalTestColumn(int16_t slotId, uint8_t type) {
+  SColumnNode* pCol = (SColumnNode*)nodesMakeNode(QUERY_NODE_COLUMN);
+  pCol->dataBlockId = 1;
+  pCol->slotId = slotId;
+  pCol->colId = slotId + 1;
+  pCol->node.resType.type = type;
+  pCol->node.resType.bytes = tDataTypes[type].bytes;
+  pCol->node.resType.precision = TSDB_TIME_PRECISION_MILLI;
+  return (SNode*)pCol;
+}
+
+// output: _wstart, count(v), sum(v), min(v), max(v)
+SIntervalPhysiNode* createIntervalTestNode(ENodeType type = QUERY_NODE_PHYSICAL_PLAN_HASH_INTERVAL) {
+  SIntervalPhysiNode* pNode = (SIntervalPhysiNode*)nodesMakeNode(type);
+  SDataBlockDescNode* pDesc = (SDataBlockDescNode*)nodesMakeNode(QUERY_NODE_DATABLOCK_DESC);
+
+  const char* funcs[] = {"_wstart", "count", "sum", "min", "max"};
+  for (int16_t i = 0; i < 5; ++i) {
+    SFunctionNode* pFunc = (SFunctionNode*)nodesMakeNode(QUERY_NODE_FUNCTION);
+    strcpy(pFunc->functionName, funcs[i]);
+    if (i > 0) {
+      nodesListMakeAppend(&pFunc->pParameterList, createIntervalTestColumn(1, TSDB_DATA_TYPE_BIGINT));
+    }
+    char msg[128] = {0};
+    EXPECT_EQ(fmGetFuncInfo(pFunc, msg, sizeof(msg)), TSDB_CODE_SUCCESS) << msg;
+
+    SSlotDescNode* pSlot = (SSlotDescNode*)nodesMakeNode(QUERY_NODE_SLOT_DESC);
+    pSlot->slotId = i;
+    pSlot->dataType = pFunc->node.resType;
+    pSlot->output = true;
+    nodesListMakeAppend(&pDesc->pSlots, (SNode*)pSlot);
+    pDesc->totalRowSize += pSlot->dataType.bytes;
+    pDesc->outputRowSize += pSlot->dataType.bytes;
+
+    STargetNode* pTarget = (STargetNode*)nodesMakeNode(QUERY_NODE_TARGET);
+    pTarget->dataBlockId = 2;
+    pTarget->slotId = i;
+    pTarget->pExpr = (SNode*)pFunc;
+    nodesListMakeAppend(&pNode->window.pFuncs, (SNode*)pTarget);
+  }
+
+  pNode->window.node.pOutputDataBlockDesc = pDesc;
+  pNode->window.pTspk = createIntervalTestColumn(0, TSDB_DATA_TYPE_TIMESTAMP);
+  pNode->window.inputTsOrder = ORDER_ASC;
+  pNode->window.outputTsOrder = ORDER_ASC;
+  pNode->window.triggerType = STREAM_TRIGGER_AT_ONCE;
+  pNode->interval = kInterval;
+  pNode->sliding = kInterval;
+  pNode->intervalUnit = 'a';
+  pNode->slidingUnit = 'a';
+  return pNode;
+}
+
+std::map<int64_t, SIntervalRes> runIntervalTest(const std::vector<int32_t>& blockRows, bool smaOnly) {
+  std::map<int64_t, SIntervalRes> res;
+
+  SIntervalTestSource source = {blockRows, 0, 0, smaOnly, {0}, {NULL, NULL}, NULL};
+  SOperatorInfo*      pDownstream = (SOperatorInfo*)taosMemoryCalloc(1, sizeof(SOperatorInfo));
+  pDownstream->name = "intervalTestSource";
+  pDownstream->operatorType = QUERY_NODE_PHYSICAL_PLAN_EXCHANGE;
+  pDownstream->info = &source;
+  pDownstream->resultDataBlockId = 1;
+  pDownstream->fpSet.getNextFn = getIntervalTestBlock;
+
+  SExecTaskInfo       taskInfo = {0};
+  SIntervalPhysiNode* pNode = createIntervalTestNode();
+  taskInfo.id.str = "intervalTest";
+  taskInfo.window = (STimeWindow){.skey = INT64_MIN, .ekey = INT64_MAX};
+
+  SOperatorInfo* pOperator = createIntervalOperatorInfo(pDownstream, pNode, &taskInfo, false);
+  EXPECT_NE(pOperator, nullptr);
+  if (pOperator == NULL) {
+    nodesDestroyNode((SNode*)pNode);
+    return res;
+  }
+
+  for (SSDataBlock* pRes = pOperator->fpSet.getNextFn(pOperator); pRes != NULL;
+       pRes = pOperator->fpSet.getNextFn(pOperator)) {
+    for (int32_t i = 0; i < pRes->info.rows; ++i) {
+      int64_t v[5] = {0};
+      for (int32_t iCol = 0; iCol < 5; ++iCol) {
+        SColumnInfoData* pCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, iCol);
+        EXPECT_FALSE(colDataIsNull_s(pCol, i));
+        v[iCol] = *(int64_t*)colDataGetData(pCol, i);
+      }
+      EXPECT_EQ(res.count(v[0]), 0) << "duplicate window:" << v[0];
+      res[v[0]] = std::make_tuple(v[1], v[2], v[3], v[4]);
+    }
+  }
+
+  destroyOperatorInfo(pOperator);
+  if (source.pBlock != NULL) {
+    source.pBlock->pBlockAgg = NULL;  // owned by the source
+  }
+  blockDataDestroy(source.pBlock);
+  nodesDestroyNode((SNode*)pNode);
+  return res;
+}
+
+std::map<int64_t, SIntervalRes> getIntervalExpect(int64_t numOfRows) {
+  std::map<int64_t, SIntervalRes> res;
+  for (int64_t seq = 0; seq < numOfRows; ++seq) {
+    int64_t ts = kIntervalTsStart + seq * kIntervalGap;
+    int64_t wstart = ts - ts % kInterval;
+    int64_t v = 0;
+    if (res.count(wstart) == 0) {
+      res[wstart] = std::make_tuple(0, 0, INT64_MAX, INT64_MIN);
+    }
+    if (!intervalTestValue(seq, &v)) {
+      continue;
+    }
+    auto& r = res[wstart];
+    std::get<0>(r) += 1;
+    std::get<1>(r) += v;
+    std::get<2>(r) = TMIN(std::get<2>(r), v);
+    std::get<3>(r) = TMAX(std::get<3>(r), v);
+  }
+  return res;
+}
+
+typedef std::pair<uint64_t, int64_t> SMergeIntervalKey;  // groupId, _wstart
+
+typedef struct SMergeIntervalTestBlock {
+  uint64_t             groupId;
+  std::vector<int64_t> ts;
+  std::vector<int64_t> val;  // INT64_MIN for NULL
+} SMergeIntervalTestBlock;
+
+typedef struct SMergeIntervalTestSource {
+  const std::vector<SMergeIntervalTestBlock>* pBlocks;
+  int32_t                                     iBlock;
+  SSDataBlock*                                pBlock;
+} SMergeIntervalTestSource;
+
+SSDataBlock* getMergeIntervalTestBlock(SOperatorInfo* pOperator) {
+  SMergeIntervalTestSource* pSource = (SMergeIntervalTestSource*)pOperator->info;
+  if (pSource->iBlock >= (int32_t)pSource->pBlocks->size()) {
+    return NULL;
+  }
+
+  if (pSource->pBlock == NULL) {
+    pSource->pBlock = createDataBlock();
+    SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 1);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+    colInfo = createColumnInfoData(TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), 2);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+  } else {
+    blockDataCleanup(pSource->pBlock);
+  }
+
+  const SMergeIntervalTestBlock& block = (*pSource->pBlocks)[pSource->iBlock++];
+  SSDataBlock*                   pBlock = pSource->pBlock;
+  int32_t                        rows = block.ts.size();
+  blockDataEnsureCapacity(pBlock, rows);
+
+  SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pValCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  for (int32_t i = 0; i < rows; ++i) {
+    colDataAppend(pTsCol, i, (const char*)&block.ts[i], false);
+    colDataAppend(pValCol, i, (const char*)&block.val[i], block.val[i] == INT64_MIN);
+  }
+
+  pBlock->info.id.groupId = block.groupId;
+  pBlock->info.window.skey = block.ts.front();
+  pBlock->info.window.ekey = block.ts.back();
+  pBlock->info.dataLoad = 1;
+  pBlock->info.rows = rows;
+  return pBlock;
+}
+
+// The rows of two tables of each partition merged by timestamp, with duplicated timestamps and a few empty windows,
+// cut into blocks that end within a window, at the end of a window and across windows. All partitions cover the same
+// windows, so that the same window of the next partition follows right after the last window of a partition.
+std::vector<SMergeIntervalTestBlock> getMergeIntervalTestBlocks() {
+  std::vector<SMergeIntervalTestBlock> blocks;
+  const uint64_t                       groupIds[] = {1001, 2002, 3003};
+  const int32_t                        pattern[] = {1, 37, 250, 100, 512, 3, 64, 199};
+
+  for (int32_t iGroup = 0; iGroup < 3; ++iGroup) {
+    std::vector<std::pair<int64_t, int64_t>> rows;
+    for (int64_t seq = 0; seq < 800; ++seq) {
+      int64_t t1 = seq * 7;
+      int64_t t2 = seq * 13 + 3;
+      if (t1 / kInterval == 2 || t1 / kInterval == 5) {  // nothing in the 3rd and 6th windows
+        t1 += kInterval;
+      }
+      int64_t v = 0;
+      int64_t val1 = intervalTestValue(seq + iGroup, &v) ? v : INT64_MIN;
+      int64_t val2 = intervalTestValue(seq * 3 + iGroup, &v) ? v : INT64_MIN;
+      rows.push_back(std::make_pair(kIntervalTsStart + t1, val1));
+      if (t2 / kInterval != 2 && t2 / kInterval != 5) {
+        rows.push_back(std::make_pair(kIntervalTsStart + t2, val2));
+      }
+    }
+    std::stable_sort(rows.begin(), rows.end(),
+                     [](const std::pair<int64_t, int64_t>& a, const std::pair<int64_t, int64_t>& b) {
+                       return a.first < b.first;
+                     });
+
+    for (size_t i = 0, iPattern = iGroup; i < rows.size(); ++iPattern) {
+      SMergeIntervalTestBlock block = {groupIds[iGroup]};
+      size_t                  end = TMIN(rows.size(), i + pattern[iPattern % 8]);
+      for (; i < end; ++i) {
+        block.ts.push_back(rows[i].first);
+        block.val.push_back(rows[i].second);
+      }
+      blocks.push_back(block);
+    }
+  }
+  return blocks;
+}
+
+std::map<SMergeIntervalKey, SIntervalRes> getMergeIntervalExpect(const std::vector<SMergeIntervalTestBlock>& blocks) {
+  std::map<SMergeIntervalKey, SIntervalRes> res;
+  for (const SMergeIntervalTestBlock& block : blocks) {
+    for (size_t i = 0; i < block.ts.size(); ++i) {
+      SMergeIntervalKey key = std::make_pair(block.groupId, block.ts[i] - block.ts[i] % kInterval);
+      if (res.count(key) == 0) {
+        res[key] = std::make_tuple(0, 0, INT64_MAX, INT64_MIN);
+      }
+      int64_t v = block.val[i];
+      if (v == INT64_MIN) {
+        continue;
+      }
+      auto& r = res[key];
+      std::get<0>(r) += 1;
+      std::get<1>(r) += v;
+      std::get<2>(r) = TMIN(std::get<2>(r), v);
+      std::get<3>(r) = TMAX(std::get<3>(r), v);
+    }
+  }
+  return res;
+}
+
+std::map<SMergeIntervalKey, SIntervalRes> runMergeIntervalTest(const std::vector<SMergeIntervalTestBlock>& blocks) {
+  std::map<SMergeIntervalKey, SIntervalRes> res;
+
+  SMergeIntervalTestSource source = {&blocks, 0, NULL};
+  SOperatorInfo*           pDownstream = (SOperatorInfo*)taosMemoryCalloc(1, sizeof(SOperatorInfo));
+  pDownstream->name = "mergeIntervalTestSource";
+  pDownstream->operatorType = QUERY_NODE_PHYSICAL_PLAN_EXCHANGE;
+  pDownstream->info = &source;
+  pDownstream->resultDataBlockId = 1;
+  pDownstream->fpSet.getNextFn = getMergeIntervalTestBlock;
+
+  SExecTaskInfo       taskInfo = {0};
+  SIntervalPhysiNode* pNode = createIntervalTestNode(QUERY_NODE_PHYSICAL_PLAN_MERGE_ALIGNED_INTERVAL);
+  taskInfo.id.str = "mergeIntervalTest";
+  taskInfo.window = (STimeWindow){.skey = INT64_MIN, .ekey = INT64_MAX};
+
+  SOperatorInfo* pOperator = createMergeAlignedIntervalOperatorInfo(pDownstream, pNode, &taskInfo);
+  EXPECT_NE(pOperator, nullptr);
+  if (pOperator == NULL) {
+    nodesDestroyNode((SNode*)pNode);
+    return res;
+  }
+
+  // each result block holds the windows of a single partition
+  for (SSDataBlock* pRes = pOperator->fpSet.getNextFn(pOperator); pRes != NULL;
+       pRes = pOperator->fpSet.getNextFn(pOperator)) {
+    for (int32_t i = 0; i < pRes->info.rows; ++i) {
+      int64_t v[5] = {0};
+      for (int32_t iCol = 0; iCol < 5; ++iCol) {
+        SColumnInfoData* pCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, iCol);
+        if (colDataIsNull_s(pCol, i)) {  // min/max of a window of NULL only
+          v[iCol] = iCol == 3 ? INT64_MAX : INT64_MIN;
+          continue;
+        }
+        v[iCol] = *(int64_t*)colDataGetData(pCol, i);
+      }
+      SMergeIntervalKey key = std::make_pair(pRes->info.id.groupId, v[0]);
+      EXPECT_EQ(res.count(key), 0) << "duplicate window:" << key.first << "," << key.second;
+      res[key] = std::make_tuple(v[1], v[2], v[3], v[4]);
+    }
+  }
+
+  destroyOperatorInfo(pOperator);
+  blockDataDestroy(source.pBlock);
+  nodesDestroyNode((SNode*)pNode);
+  return res;
+}
+
+}  // namespace
+
+TEST(intervalTest, blockSmaFastPath) {
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+  ASSERT_EQ(fmFuncMgtInit(), TSDB_CODE_SUCCESS);
+
+  // 100 rows in a window: blocks within a window, filling a whole window, and crossing one or more windows
+  std::vector<int32_t> blockRows;
+  int32_t              pattern[] = {40, 60, 100, 30, 170, 100, 7, 93, 1, 250, 49, 50};
+  int64_t              numOfRows = 0;
+  for (int32_t i = 0; i < 20; ++i) {
+    for (int32_t rows : pattern) {
+      blockRows.push_back(rows);
+      numOfRows += rows;
+    }
+  }
+
+  std::map<int64_t, SIntervalRes> expect = getIntervalExpect(numOfRows);
+  std::map<int64_t, SIntervalRes> loaded = runIntervalTest(blockRows, false);
+  std::map<int64_t, SIntervalRes> sma = runIntervalTest(blockRows, true);
+  EXPECT_EQ(loaded, expect);
+  EXPECT_EQ(sma, expect);
+}
+
+TEST(intervalTest, mergeAlignedRawRows) {
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+  ASSERT_EQ(fmFuncMgtInit(), TSDB_CODE_SUCCESS);
+
+  std::vector<SMergeIntervalTestBlock>      blocks = getMergeIntervalTestBlocks();
+  std::map<SMergeIntervalKey, SIntervalRes> expect = getMergeIntervalExpect(blocks);
+  std::map<SMergeIntervalKey, SIntervalRes> res = runMergeIntervalTest(blocks);
+  EXPECT_EQ(expect.size(), 3 * 9);
+  EXPECT_EQ(res, expect);
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "plannodes.h"
+#include "tdatablock.h"
+#include "tglobal.h"
+
+// Join two generated inputs with the hash join operator on an int key and check the joined rows against the rows
+// counted from the generator.
+
+namespace {
+
+const int32_t kJoinNameBytes = 16 + VARSTR_HEADER_SIZE;
+const int32_t kLeftBlockId = 1;
+const int32_t kRightBlockId = 2;
+
+typedef struct SJoinTestSource {
+  int32_t      numOfBlocks;
+  int32_t      rows;
+  int32_t      numOfKeys;
+  int64_t      seq;
+  SSDataBlock* pBlock;
+} SJoinTestSource;
+
+// NULL for every 7th row of the key column
+bool joinTestKey(int64_t seq, int32_t numOfKeys, int32_t* pKey) {
+  if (seq % 7 == 0) {
+    return false;
+  }
+  *pKey = (int32_t)((seq * 31) % numOfKeys);
+  return true;
+}
+
+// col 0: timestamp, col 1: int key, col 2: varchar derived from the sequence
+SSDataBlock* getJoinTestBlock(SOperatorInfo* pOperator) {
+  SJoinTestSource* pSource = (SJoinTestSource*)pOperator->info;
+  if (pSource->numOfBlocks-- <= 0) {
+    return NULL;
+  }
+
+  if (pSource->pBlock == NULL) {
+    pSource->pBlock = createDataBlock();
+    SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 1);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+    colInfo = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 2);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+    colInfo = createColumnInfoData(TSDB_DATA_TYPE_VARCHAR, kJoinNameBytes, 3);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+  } else {
+    blockDataCleanup(pSource->pBlock);
+  }
+
+  SSDataBlock* pBlock = pSource->pBlock;
+  blockDataEnsureCapacity(pBlock, pSource->rows);
+
+  SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pKeyCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  SColumnInfoData* pNameCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2);
+
+  char name[kJoinNameBytes] = {0};
+  for (int32_t i = 0; i < pSource->rows; ++i) {
+    int64_t seq = pSource->seq++;
+    int32_t key = 0;
+
+    colDataAppend(pTsCol, i, (const char*)&seq, false);
+    if (joinTestKey(seq, pSource->numOfKeys, &key)) {
+      colDataAppend(pKeyCol, i, (const char*)&key, false);
+    } else {
+      colDataAppendNULL(pKeyCol, i);
+    }
+
+    int32_t len = snprintf(varDataVal(name), kJoinNameBytes - VARSTR_HEADER_SIZE, "n_%" PRId64, seq);
+    varDataSetLen(name, len);
+    colDataAppend(pNameCol, i, name, false);
+  }
+
+  pBlock->info.rows = pSource->rows;
+  return pBlock;
+}
+
+SNode* createJoinTestColumn(int32_t blockId, int16_t slotId, uint8_t type, int32_t bytes) {
+  SColumnNode* pCol = (SColumnNode*)nodesMakeNode(QUERY_NODE_COLUMN);
+  pCol->dataBlockId = blockId;
+  pCol->slotId = slotId;
+  pCol->colId = slotId + 1;
+  pCol->node.resType.type = type;
+  pCol->node.resType.bytes = bytes;
+  return (SNode*)pCol;
+}
+
+// output: left ts, left key, right ts, right name
+SHashJoinPhysiNode* createJoinTestNode(int8_t buildSide) {
+  SHashJoinPhysiNode* pNode = (SHashJoinPhysiNode*)nodesMakeNode(QUERY_NODE_PHYSICAL_PLAN_HASH_JOIN);
+  SDataBlockDescNode* pDesc = (SDataBlockDescNode*)nodesMakeNode(QUERY_NODE_DATABLOCK_DESC);
+
+  int32_t blockIds[] = {kLeftBlockId, kLeftBlockId, kRightBlockId, kRightBlockId};
+  int16_t srcSlots[] = {0, 1, 0, 2};
+  uint8_t types[] = {TSDB_DATA_TYPE_TIMESTAMP, TSDB_DATA_TYPE_INT, TSDB_DATA_TYPE_TIMESTAMP, TSDB_DATA_TYPE_VARCHAR};
+  int32_t bytes[] = {sizeof(int64_t), sizeof(int32_t), sizeof(int64_t), kJoinNameBytes};
+  for (int16_t i = 0; i < 4; ++i) {
+    SSlotDescNode* pSlot = (SSlotDescNode*)nodesMakeNode(QUERY_NODE_SLOT_DESC);
+    pSlot->slotId = i;
+    pSlot->dataType.type = types[i];
+    pSlot->dataType.bytes = bytes[i];
+    pSlot->output = true;
+    nodesListMakeAppend(&pDesc->pSlots, (SNode*)pSlot);
+    pDesc->totalRowSize += bytes[i];
+    pDesc->outputRowSize += bytes[i];
+
+    STargetNode* pTarget = (STargetNode*)nodesMakeNode(QUERY_NODE_TARGET);
+    pTarget->slotId = i;
+    pTarget->pExpr = createJoinTestColumn(blockIds[i], srcSlots[i], types[i], bytes[i]);
+    nodesListMakeAppend(&pNode->pTargets, (SNode*)pTarget);
+  }
+
+  pNode->node.pOutputDataBlockDesc = pDesc;
+  pNode->joinType = JOIN_TYPE_INNER;
+  pNode->buildSide = buildSide;
+  nodesListMakeAppend(&pNode->pLeftKeys, createJoinTestColumn(kLeftBlockId, 1, TSDB_DATA_TYPE_INT, sizeof(int32_t)));
+  nodesListMakeAppend(&pNode->pRightKeys, createJoinTestColumn(kRightBlockId, 1, TSDB_DATA_TYPE_INT, sizeof(int32_t)));
+  return pNode;
+}
+
+SOperatorInfo* createJoinTestSource(SJoinTestSource* pSource, int32_t blockId) {
+  SOperatorInfo* pOperator = (SOperatorInfo*)taosMemoryCalloc(1, sizeof(SOperatorInfo));
+  pOperator->name = "joinTestSource";
+  pOperator->info = pSource;
+  pOperator->resultDataBlockId = blockId;
+  pOperator->fpSet.getNextFn = getJoinTestBlock;
+  return pOperator;
+}
+
+void runHashJoinTest(int8_t buildSide, int32_t leftBlocks, int32_t rightBlocks, int32_t numOfKeys) {
+  const int32_t rows = 4096;
+
+  SJoinTestSource left = {leftBlocks, rows, numOfKeys, 0, NULL};
+  SJoinTestSource right = {rightBlocks, rows, numOfKeys, 1000000000, NULL};
+  SOperatorInfo*  pDownstream[2] = {createJoinTestSource(&left, kLeftBlockId),
+                                    createJoinTestSource(&right, kRightBlockId)};
+
+  SExecTaskInfo       taskInfo = {0};
+  SHashJoinPhysiNode* pNode = createJoinTestNode(buildSide);
+  taskInfo.id.str = "hashJoinTest";
+
+  SOperatorInfo* pOperator = createHashJoinOperatorInfo(pDownstream, 2, pNode, &taskInfo);
+  ASSERT_NE(pOperator, nullptr);
+
+  std::map<int32_t, int64_t> rightRowsOfKey;
+  std::map<int32_t, int64_t> rowsOfKey;
+
+  for (SSDataBlock* pRes = pOperator->fpSet.getNextFn(pOperator); pRes != NULL;
+       pRes = pOperator->fpSet.getNextFn(pOperator)) {
+    SColumnInfoData* pLeftTsCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 0);
+    SColumnInfoData* pLeftKeyCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 1);
+    SColumnInfoData* pRightTsCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 2);
+    SColumnInfoData* pNameCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 3);
+
+    for (int32_t i = 0; i < pRes->info.rows; ++i) {
+      int64_t leftSeq = *(int64_t*)colDataGetData(pLeftTsCol, i);
+      int64_t rightSeq = *(int64_t*)colDataGetData(pRightTsCol, i);
+      int32_t key = *(int32_t*)colDataGetData(pLeftKeyCol, i);
+
+      int32_t leftKey = 0;
+      int32_t rightKey = 0;
+      ASSERT_TRUE(joinTestKey(leftSeq, numOfKeys, &leftKey));
+      ASSERT_TRUE(joinTestKey(rightSeq, numOfKeys, &rightKey));
+      ASSERT_EQ(key, leftKey);
+      ASSERT_EQ(key, rightKey);
+
+      char* p = colDataGetData(pNameCol, i);
+      ASSERT_EQ(std::string(varDataVal(p), varDataLen(p)), "n_" + std::to_string(rightSeq));
+      rowsOfKey[key] += 1;
+    }
+  }
+
+  // every pair of rows with the same not NULL key is joined
+  std::map<int32_t, int64_t> leftExpect;
+  std::map<int32_t, int64_t> rightExpect;
+  for (int64_t seq = 0; seq < leftBlocks * rows; ++seq) {
+    int32_t key = 0;
+    if (joinTestKey(seq, numOfKeys, &key)) {
+      leftExpect[key] += 1;
+    }
+  }
+  for (int64_t seq = 1000000000; seq < 1000000000 + rightBlocks * rows; ++seq) {
+    int32_t key = 0;
+    if (joinTestKey(seq, numOfKeys, &key)) {
+      rightExpect[key] += 1;
+    }
+  }
+
+  std::map<int32_t, int64_t> expect;
+  for (auto& kv : leftExpect) {
+    if (rightExpect.find(kv.first) != rightExpect.end()) {
+      expect[kv.first] = kv.second * rightExpect[kv.first];
+    }
+  }
+  ASSERT_EQ(rowsOfKey, expect);
+
+  destroyOperatorInfo(pOperator);
+  blockDataDestroy(left.pBlock);
+  blockDataDestroy(right.pBlock);
+  nodesDestroyNode((SNode*)pNode);
+}
+
+}  // namespace
+
+TEST(hashJoinTest, buildRight) {
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+
+  runHashJoinTest(1, 10, 2, 100);
+  runHashJoinTest(1, 2, 10, 100000);
+}
+
+TEST(hashJoinTest, buildLeft) {
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+
+  runHashJoinTest(0, 2, 10, 1000);
+  runHashJoinTest(0, 1, 1, 5);
+}
+
+// the build rows exceed the in memory pages of the buffer and are read back from the disk
+TEST(hashJoinTest, buildSpill) {
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+
+  runHashJoinTest(1, 10, 100, 1000000);
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "plannodes.h"
+#include "tdatablock.h"
+#include "tglobal.h"
+
+// Run the partition operator over blocks of rows in randomly ordered partitions, partition by a varchar column like
+// tbname, and check that each result block holds the rows of a single partition in the original order. The timing
+// case is disabled by default, run it with --gtest_also_run_disabled_tests.
+
+namespace {
+
+const int32_t kBenchKeyBytes = 32 + VARSTR_HEADER_SIZE;
+const int64_t kBenchTsStart = 1600000000000;
+
+typedef struct SPartBenchSource {
+  int32_t      numOfBlocks;
+  int32_t      rows;
+  int32_t      numOfPartitions;
+  uint32_t     seed;
+  int64_t      ts;
+  SSDataBlock* pBlock;
+} SPartBenchSource;
+
+int32_t nextBenchPartition(uint32_t* seed, int32_t numOfPartitions) { return taosRandR(seed) % numOfPartitions; }
+
+// col 0: varchar partition key, col 1: timestamp, col 2: int with 10% NULL derived from the timestamp
+SSDataBlock* getPartBenchBlock(SOperatorInfo* pOperator) {
+  SPartBenchSource* pSource = (SPartBenchSource*)pOperator->info;
+  if (pSource->numOfBlocks-- <= 0) {
+    return NULL;
+  }
+
+  if (pSource->pBlock == NULL) {
+    pSource->pBlock = createDataBlock();
+    SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_VARCHAR, kBenchKeyBytes, 1);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+    colInfo = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 2);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+    colInfo = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 3);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+  } else {
+    blockDataCleanup(pSource->pBlock);
+  }
+
+  SSDataBlock* pBlock = pSource->pBlock;
+  blockDataEnsureCapacity(pBlock, pSource->rows);
+
+  SColumnInfoData* pKeyCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  SColumnInfoData* pValCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2);
+
+  char key[kBenchKeyBytes] = {0};
+  for (int32_t i = 0; i < pSource->rows; ++i) {
+    int32_t partition = nextBenchPartition(&pSource->seed, pSource->numOfPartitions);
+    int64_t ts = pSource->ts++;
+    int32_t v = (int32_t)(ts % 1000);
+
+    int32_t len = snprintf(varDataVal(key), kBenchKeyBytes - VARSTR_HEADER_SIZE, "t_%d", partition);
+    varDataSetLen(key, len);
+    colDataAppend(pKeyCol, i, key, false);
+    colDataAppend(pTsCol, i, (const char*)&ts, false);
+    if (v % 10 == 0) {
+      colDataAppendNULL(pValCol, i);
+    } else {
+      colDataAppend(pValCol, i, (const char*)&v, false);
+    }
+  }
+
+  pBlock->info.rows = pSource->rows;
+  return pBlock;
+}
+
+SNode* createBenchColumn(int16_t slotId, uint8_t type, int32_t bytes) {
+  SColumnNode* pCol = (SColumnNode*)nodesMakeNode(QUERY_NODE_COLUMN);
+  pCol->slotId = slotId;
+  pCol->colId = slotId + 1;
+  pCol->node.resType.type = type;
+  pCol->node.resType.bytes = bytes;
+  return (SNode*)pCol;
+}
+
+SPartitionPhysiNode* createBenchPartitionNode() {
+  SPartitionPhysiNode* pNode = (SPartitionPhysiNode*)nodesMakeNode(QUERY_NODE_PHYSICAL_PLAN_PARTITION);
+  SDataBlockDescNode*  pDesc = (SDataBlockDescNode*)nodesMakeNode(QUERY_NODE_DATABLOCK_DESC);
+
+  uint8_t types[] = {TSDB_DATA_TYPE_VARCHAR, TSDB_DATA_TYPE_TIMESTAMP, TSDB_DATA_TYPE_INT};
+  int32_t bytes[] = {kBenchKeyBytes, sizeof(int64_t), sizeof(int32_t)};
+  for (int16_t i = 0; i < 3; ++i) {
+    SSlotDescNode* pSlot = (SSlotDescNode*)nodesMakeNode(QUERY_NODE_SLOT_DESC);
+    pSlot->slotId = i;
+    pSlot->dataType.type = types[i];
+    pSlot->dataType.bytes = bytes[i];
+    pSlot->output = true;
+    nodesListMakeAppend(&pDesc->pSlots, (SNode*)pSlot);
+    pDesc->totalRowSize += bytes[i];
+    pDesc->outputRowSize += bytes[i];
+
+    STargetNode* pTarget = (STargetNode*)nodesMakeNode(QUERY_NODE_TARGET);
+    pTarget->slotId = i;
+    pTarget->pExpr = createBenchColumn(i, types[i], bytes[i]);
+    nodesListMakeAppend(&pNode->pTargets, (SNode*)pTarget);
+  }
+
+  pNode->node.pOutputDataBlockDesc = pDesc;
+  nodesListMakeAppend(&pNode->pPartitionKeys, createBenchColumn(0, TSDB_DATA_TYPE_VARCHAR, kBenchKeyBytes));
+  return pNode;
+}
+
+// returns the time to partition all of the input
+int64_t runPartition(int32_t numOfPartitions, int32_t numOfBlocks) {
+  const int32_t rows = 4096;
+
+  SPartBenchSource source = {numOfBlocks, rows, numOfPartitions, 1, kBenchTsStart, NULL};
+  SOperatorInfo*   pDownstream = (SOperatorInfo*)taosMemoryCalloc(1, sizeof(SOperatorInfo));
+  pDownstream->name = "partitionBenchSource";
+  pDownstream->info = &source;
+  pDownstream->fpSet.getNextFn = getPartBenchBlock;
+
+  SExecTaskInfo        taskInfo = {0};
+  SPartitionPhysiNode* pNode = createBenchPartitionNode();
+  taskInfo.id.str = "partitionBench";
+
+  SOperatorInfo* pOperator = createPartitionOperatorInfo(pDownstream, pNode, &taskInfo);
+  EXPECT_NE(pOperator, nullptr);
+  if (pOperator == NULL) return 0;
+
+  std::map<std::string, int64_t>  lastTs;
+  std::map<std::string, uint64_t> groupIds;
+  std::map<std::string, int64_t>  rowsOfKey;
+
+  // all of the input blocks are partitioned when the first result block is fetched
+  int64_t      st = taosGetTimestampUs();
+  SSDataBlock* pRes = pOperator->fpSet.getNextFn(pOperator);
+  int64_t      el = taosGetTimestampUs() - st;
+
+  for (; pRes != NULL; pRes = pOperator->fpSet.getNextFn(pOperator)) {
+    SColumnInfoData* pKeyCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 0);
+    SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 1);
+    SColumnInfoData* pValCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 2);
+
+    char*       first = colDataGetData(pKeyCol, 0);
+    std::string key(varDataVal(first), varDataLen(first));
+    if (groupIds.find(key) == groupIds.end()) {
+      groupIds[key] = pRes->info.id.groupId;
+      lastTs[key] = kBenchTsStart - 1;
+    }
+    EXPECT_EQ(groupIds[key], pRes->info.id.groupId);
+
+    for (int32_t i = 0; i < pRes->info.rows; ++i) {
+      char* p = colDataGetData(pKeyCol, i);
+      EXPECT_EQ(std::string(varDataVal(p), varDataLen(p)), key);
+
+      int64_t ts = *(int64_t*)colDataGetData(pTsCol, i);
+      EXPECT_GT(ts, lastTs[key]);
+      lastTs[key] = ts;
+
+      int32_t v = (int32_t)(ts % 1000);
+      EXPECT_EQ(colDataIsNull_s(pValCol, i), v % 10 == 0);
+      if (v % 10 != 0) {
+        EXPECT_EQ(*(int32_t*)colDataGetData(pValCol, i), v);
+      }
+    }
+    rowsOfKey[key] += pRes->info.rows;
+  }
+
+  // replay the partitions of the rows
+  std::map<std::string, int64_t> expect;
+  uint32_t                       seed = 1;
+  for (int32_t i = 0; i < numOfBlocks * rows; ++i) {
+    expect["t_" + std::to_string(nextBenchPartition(&seed, numOfPartitions))] += 1;
+  }
+  EXPECT_EQ(rowsOfKey, expect);
+
+  destroyOperatorInfo(pOperator);
+  blockDataDestroy(source.pBlock);
+  nodesDestroyNode((SNode*)pNode);
+  return el;
+}
+
+}  // namespace
+
+TEST(partitionTest, hashPartition) {
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+
+  runPartition(10, 20);
+  runPartition(1000, 20);
+}
+
+TEST(partitionBench, DISABLED_hashPartition) {
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+
+  RecordProperty("10PartitionsUs", (int)runPartition(10, 200));
+  RecordProperty("1kPartitionsUs", (int)runPartition(1000, 200));
+  RecordProperty("100kPartitionsUs", (int)runPartition(100000, 200));
+}
+
+#pragma GCC diagnostic pop
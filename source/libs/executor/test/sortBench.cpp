@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "talgo.h"
+#include "tcompare.h"
+#include "tdatablock.h"
+#include "tglobal.h"
+#include "tsort.h"
+
+// Timing of the sort on the normalized keys against the sort by the row compare function, in memory and with the
+// external merge sort. Disabled by default, run with --gtest_also_run_disabled_tests, the timings are recorded as test
+// properties.
+
+namespace {
+
+typedef struct {
+  SSDataBlock* pBlock;
+  SArray*      pOrderInfo;
+} SBenchSortParam;
+
+// col 0: int with 10% NULL, col 1: timestamp, col 2: double
+SSDataBlock* createBenchBlock(int32_t rows, uint32_t seed) {
+  SSDataBlock*    pBlock = createDataBlock();
+  SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 1);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  colInfo = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 2);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  colInfo = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 3);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  blockDataEnsureCapacity(pBlock, rows);
+
+  SColumnInfoData* pCol0 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pCol1 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  SColumnInfoData* pCol2 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2);
+  for (int32_t i = 0; i < rows; ++i) {
+    int32_t v0 = taosRandR(&seed) % 1000;
+    int64_t v1 = 1600000000000 + taosRandR(&seed) % 100000000;
+    double  v2 = (double)(taosRandR(&seed) % 65536) / 7;
+
+    if (v0 < 100) {
+      colDataAppendNULL(pCol0, i);
+    } else {
+      colDataAppend(pCol0, i, (const char*)&v0, false);
+    }
+    colDataAppend(pCol1, i, (const char*)&v1, false);
+    colDataAppend(pCol2, i, (const char*)&v2, false);
+  }
+
+  pBlock->info.rows = rows;
+  return pBlock;
+}
+
+SArray* createBenchOrderInfo() {
+  SArray*         pOrderInfo = taosArrayInit(2, sizeof(SBlockOrderInfo));
+  SBlockOrderInfo oi = {0};
+  oi.slotId = 0;
+  oi.order = TSDB_ORDER_ASC;
+  oi.nullFirst = true;
+  taosArrayPush(pOrderInfo, &oi);
+  oi.slotId = 1;
+  oi.order = TSDB_ORDER_DESC;
+  oi.nullFirst = false;
+  taosArrayPush(pOrderInfo, &oi);
+  return pOrderInfo;
+}
+
+int32_t compareBenchRow(SArray* pOrderInfo, const SSDataBlock* pLeft, int32_t l, const SSDataBlock* pRight,
+                        int32_t r) {
+  for (int32_t i = 0; i < taosArrayGetSize(pOrderInfo); ++i) {
+    SBlockOrderInfo* pOrder = (SBlockOrderInfo*)taosArrayGet(pOrderInfo, i);
+    SColumnInfoData* pLeftCol = (SColumnInfoData*)taosArrayGet(pLeft->pDataBlock, pOrder->slotId);
+    SColumnInfoData* pRightCol = (SColumnInfoData*)taosArrayGet(pRight->pDataBlock, pOrder->slotId);
+
+    bool leftNull = colDataIsNull_s(pLeftCol, l);
+    bool rightNull = colDataIsNull_s(pRightCol, r);
+    if (leftNull && rightNull) {
+      continue;
+    }
+    if (leftNull || rightNull) {
+      return (leftNull == pOrder->nullFirst) ? -1 : 1;
+    }
+
+    __compar_fn_t fn = getKeyComparFunc(pLeftCol->info.type, pOrder->order);
+    int32_t       ret = fn(colDataGetData(pLeftCol, l), colDataGetData(pRightCol, r));
+    if (ret != 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+int32_t benchIndexCompar(const void* p1, const void* p2, const void* param) {
+  const SBenchSortParam* pParam = (const SBenchSortParam*)param;
+  return compareBenchRow(pParam->pOrderInfo, pParam->pBlock, *(int32_t*)p1, pParam->pBlock, *(int32_t*)p2);
+}
+
+// the same as the default compare function of the merge, except that it compares the row values
+int32_t benchMergeCompar(const void* pLeft, const void* pRight, void* param) {
+  SMsortComparParam* pParam = (SMsortComparParam*)param;
+  SSortSource*       pLeftSource = (SSortSource*)pParam->pSources[*(int32_t*)pLeft];
+  SSortSource*       pRightSource = (SSortSource*)pParam->pSources[*(int32_t*)pRight];
+
+  if (pLeftSource->src.rowIndex == -1) {
+    return 1;
+  }
+  if (pRightSource->src.rowIndex == -1) {
+    return -1;
+  }
+
+  return compareBenchRow(pParam->orderInfo, pLeftSource->src.pBlock, pLeftSource->src.rowIndex,
+                         pRightSource->src.pBlock, pRightSource->src.rowIndex);
+}
+
+typedef struct {
+  int32_t      count;
+  int32_t      rows;
+  uint32_t     seed;
+  SSDataBlock* pBlock;
+} SBenchSource;
+
+SSDataBlock* fetchBenchBlock(void* param) {
+  SBenchSource* pSource = (SBenchSource*)param;
+  blockDataDestroy(pSource->pBlock);
+  pSource->pBlock = NULL;
+  if (pSource->count-- <= 0) {
+    return NULL;
+  }
+  pSource->pBlock = createBenchBlock(pSource->rows, pSource->seed++);
+  return pSource->pBlock;
+}
+
+int64_t runMergeSort(SArray* pOrderInfo, bool normalizedKey, int32_t* pRows) {
+  SBenchSource source = {64, 16384, 1, NULL};
+  SSortHandle* pHandle = tsortCreateSortHandle(pOrderInfo, SORT_SINGLESOURCE_SORT, -1, -1, NULL, "sortBench");
+  tsortSetFetchRawDataFp(pHandle, fetchBenchBlock, NULL, NULL);
+  if (!normalizedKey) {
+    tsortSetComparFp(pHandle, benchMergeCompar);
+  }
+
+  SSortSource* ps = (SSortSource*)taosMemoryCalloc(1, sizeof(SSortSource));
+  ps->param = &source;
+  ps->onlyRef = true;
+  tsortAddSource(pHandle, ps);
+
+  int64_t st = taosGetTimestampUs();
+  *pRows = 0;
+  if (tsortOpen(pHandle) == 0) {
+    while (tsortNextTuple(pHandle) != NULL) {
+      (*pRows) += 1;
+    }
+  }
+  int64_t el = taosGetTimestampUs() - st;
+
+  tsortDestroySortHandle(pHandle);
+  return el;
+}
+
+}  // namespace
+
+TEST(sortBench, DISABLED_inMemSort) {
+  const int32_t rows = 1000000;
+  SArray*       pOrderInfo = createBenchOrderInfo();
+  SSDataBlock*  pBlock = createBenchBlock(rows, 1);
+
+  std::vector<int32_t> index(rows);
+  for (int32_t i = 0; i < rows; ++i) {
+    index[i] = i;
+  }
+  SBenchSortParam param = {pBlock, pOrderInfo};
+  int64_t         st = taosGetTimestampUs();
+  taosqsort(index.data(), rows, sizeof(int32_t), &param, benchIndexCompar);
+  int64_t qsortEl = taosGetTimestampUs() - st;
+
+  st = taosGetTimestampUs();
+  ASSERT_EQ(blockDataSort(pBlock, pOrderInfo), 0);
+  int64_t sortEl = taosGetTimestampUs() - st;
+
+  ::testing::Test::RecordProperty("rowCompareQsortUs", (int)qsortEl);
+  ::testing::Test::RecordProperty("normalizedKeySortUs", (int)sortEl);
+
+  for (int32_t i = 1; i < rows; ++i) {
+    ASSERT_LE(compareBenchRow(pOrderInfo, pBlock, i - 1, pBlock, i), 0);
+  }
+
+  blockDataDestroy(pBlock);
+  taosArrayDestroy(pOrderInfo);
+}
+
+TEST(sortBench, DISABLED_externalMergeSort) {
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+
+  SArray* pOrderInfo = createBenchOrderInfo();
+  int32_t rows = 0;
+  int32_t normRows = 0;
+
+  int64_t rowEl = runMergeSort(pOrderInfo, false, &rows);
+  int64_t normEl = runMergeSort(pOrderInfo, true, &normRows);
+  ::testing::Test::RecordProperty("rowCompareUs", (int)rowEl);
+  ::testing::Test::RecordProperty("normalizedKeyUs", (int)normEl);
+
+  ASSERT_EQ(rows, 64 * 16384);
+  ASSERT_EQ(normRows, rows);
+  taosArrayDestroy(pOrderInfo);
+}
+
+#pragma GCC diagnostic pop
@@ -14,6 +14,9 @@
  */
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 #include <tglobal.h>
 #include <tsort.h>
 #include <iostream>
@@ -393,4 +396,271 @@ TEST(testCase, ordered_merge_sort_Test) {
 
 #endif
 
+namespace {
+typedef struct {
+  int32_t      count;
+  int32_t      pageRows;
+  int32_t      startVal;
+  SSDataBlock* pBlock;  // the sort handle does not take the ownership of the fetched block
+} _topKInfo;
+
+// col 0: int, every 7th row is NULL; col 1: binary, the text form of col 0
+SSDataBlock* getTopKDummyBlock(void* param) {
+  _topKInfo* pInfo = (_topKInfo*)param;
+  blockDataDestroy(pInfo->pBlock);
+  pInfo->pBlock = NULL;
+  if (--pInfo->count < 0) {
+    return NULL;
+  }
+
+  SSDataBlock*    pBlock = createDataBlock();
+  pInfo->pBlock = pBlock;
+  SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 1);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  colInfo = createColumnInfoData(TSDB_DATA_TYPE_BINARY, 16 + VARSTR_HEADER_SIZE, 2);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  blockDataEnsureCapacity(pBlock, pInfo->pageRows);
+
+  SColumnInfoData* pIntCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pStrCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  for (int32_t i = 0; i < pInfo->pageRows; ++i) {
+    // spread the values over the blocks so that the candidates are replaced all the time
+    int32_t v = (pInfo->startVal++ * 7919) % 100000;
+    char    str[32] = {0};
+    if (v % 7 == 0) {
+      colDataAppendNULL(pIntCol, i);
+      colDataAppendNULL(pStrCol, i);
+      continue;
+    }
+    colDataAppend(pIntCol, i, (const char*)&v, false);
+    varDataSetLen(str, sprintf(varDataVal(str), "%d", v));
+    colDataAppend(pStrCol, i, str, false);
+  }
+
+  pBlock->info.rows = pInfo->pageRows;
+  return pBlock;
+}
+}  // namespace
+
+TEST(testCase, topK_sort_Test) {
+  SBlockOrderInfo oi = {0};
+  oi.order = TSDB_ORDER_DESC;
+  oi.slotId = 0;
+  oi.nullFirst = false;
+  SArray* orderInfo = taosArrayInit(1, sizeof(SBlockOrderInfo));
+  taosArrayPush(orderInfo, &oi);
+
+  _topKInfo info = {20, 1000, 0, NULL};
+
+  // all the values in [0, 20000) * 7919 % 100000 are different, take the largest 100 non-null ones as expected
+  std::vector<int32_t> expect;
+  for (int32_t i = 0; i < info.count * info.pageRows; ++i) {
+    int32_t v = (i * 7919) % 100000;
+    if (v % 7 != 0) {
+      expect.push_back(v);
+    }
+  }
+  std::sort(expect.begin(), expect.end(), std::greater<int32_t>());
+
+  SSortHandle* phandle = tsortCreateSortHandle(orderInfo, SORT_SINGLESOURCE_SORT, -1, -1, NULL, "test_topk");
+  tsortSetFetchRawDataFp(phandle, getTopKDummyBlock, NULL, NULL);
+  tsortSetMaxRows(phandle, 100);
+
+  SSortSource* ps = static_cast<SSortSource*>(taosMemoryCalloc(1, sizeof(SSortSource)));
+  ps->param = &info;
+  ps->onlyRef = true;
+  tsortAddSource(phandle, ps);
+  ASSERT_EQ(tsortOpen(phandle), 0);
+
+  int32_t row = 0;
+  while (1) {
+    STupleHandle* pTupleHandle = tsortNextTuple(phandle);
+    if (pTupleHandle == NULL) {
+      break;
+    }
+
+    ASSERT_FALSE(tsortIsNullVal(pTupleHandle, 0));
+    int32_t v = *(int32_t*)tsortGetValue(pTupleHandle, 0);
+    ASSERT_EQ(v, expect[row]);
+
+    char* str = (char*)tsortGetValue(pTupleHandle, 1);
+    ASSERT_EQ(std::string(varDataVal(str), varDataLen(str)), std::to_string(v));
+    row++;
+  }
+  ASSERT_EQ(row, 100);
+  ASSERT_EQ(tsortGetSortExecInfo(phandle).sortMethod, SORT_TOPK_T);
+
+  taosArrayDestroy(orderInfo);
+  tsortDestroySortHandle(phandle);
+}
+
+namespace {
+// col 0: int, col 1: double, col 2: bigint (the original row index)
+SSDataBlock* createNormKeyBlock(int32_t rows, int32_t seed) {
+  const double dv[] = {-DBL_MAX, -2.5, -0.0, 0.0, 1e-300, 3.25, DBL_MAX, NAN};
+
+  SSDataBlock*    pBlock = createDataBlock();
+  SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 1);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  colInfo = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 2);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  colInfo = createColumnInfoData(TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), 3);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  blockDataEnsureCapacity(pBlock, rows);
+
+  SColumnInfoData* pCol0 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pCol1 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  SColumnInfoData* pCol2 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2);
+  for (int32_t i = 0; i < rows; ++i) {
+    int64_t id = (int64_t)seed * rows + i;
+    int32_t v0 = (int32_t)((id * 2654435761u) % 41) - 20;
+    if (id % 5 == 0) {
+      colDataAppendNULL(pCol0, i);
+    } else {
+      colDataAppend(pCol0, i, (const char*)&v0, false);
+    }
+
+    if (id % 7 == 0) {
+      colDataAppendNULL(pCol1, i);
+    } else {
+      colDataAppend(pCol1, i, (const char*)&dv[(id * 40503u) % 8], false);
+    }
+    colDataAppend(pCol2, i, (const char*)&id, false);
+  }
+
+  pBlock->info.rows = rows;
+  return pBlock;
+}
+
+int32_t compareNormKeyRow(SArray* pOrderInfo, SSDataBlock* pLeft, int32_t l, SSDataBlock* pRight, int32_t r) {
+  for (int32_t i = 0; i < taosArrayGetSize(pOrderInfo); ++i) {
+    SBlockOrderInfo* pOrder = (SBlockOrderInfo*)taosArrayGet(pOrderInfo, i);
+    SColumnInfoData* pLeftCol = (SColumnInfoData*)taosArrayGet(pLeft->pDataBlock, pOrder->slotId);
+    SColumnInfoData* pRightCol = (SColumnInfoData*)taosArrayGet(pRight->pDataBlock, pOrder->slotId);
+    bool             leftNull = colDataIsNull_s(pLeftCol, l);
+    bool             rightNull = colDataIsNull_s(pRightCol, r);
+    if (leftNull && rightNull) {
+      continue;
+    }
+    if (leftNull || rightNull) {
+      return (leftNull == pOrder->nullFirst) ? -1 : 1;
+    }
+    __compar_fn_t fn = getKeyComparFunc(pLeftCol->info.type, pOrder->order);
+    int32_t       ret = fn(colDataGetData(pLeftCol, l), colDataGetData(pRightCol, r));
+    if (ret != 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+SArray* createNormKeyOrderInfo(int32_t order0, bool nullFirst0, int32_t order1, bool nullFirst1) {
+  SArray*         pOrderInfo = taosArrayInit(2, sizeof(SBlockOrderInfo));
+  SBlockOrderInfo oi = {0};
+  oi.slotId = 0;
+  oi.order = order0;
+  oi.nullFirst = nullFirst0;
+  taosArrayPush(pOrderInfo, &oi);
+  oi.slotId = 1;
+  oi.order = order1;
+  oi.nullFirst = nullFirst1;
+  taosArrayPush(pOrderInfo, &oi);
+  return pOrderInfo;
+}
+
+typedef struct {
+  int32_t      count;
+  int32_t      rows;
+  int32_t      seed;
+  SSDataBlock* pBlock;
+} _normKeyInfo;
+
+SSDataBlock* getNormKeyBlock(void* param) {
+  _normKeyInfo* pInfo = (_normKeyInfo*)param;
+  blockDataDestroy(pInfo->pBlock);
+  pInfo->pBlock = NULL;
+  if (pInfo->seed >= pInfo->count) {
+    return NULL;
+  }
+  pInfo->pBlock = createNormKeyBlock(pInfo->rows, pInfo->seed++);
+  return pInfo->pBlock;
+}
+}  // namespace
+
+TEST(testCase, normalized_key_sort_Test) {
+  const int32_t rows = 5000;
+  for (int32_t k = 0; k < 16; ++k) {
+    SArray* pOrderInfo = createNormKeyOrderInfo((k & 1) ? TSDB_ORDER_DESC : TSDB_ORDER_ASC, (k & 2) != 0,
+                                                (k & 4) ? TSDB_ORDER_DESC : TSDB_ORDER_ASC, (k & 8) != 0);
+    SSDataBlock* pOrigin = createNormKeyBlock(rows, 0);
+    SSDataBlock* pBlock = createNormKeyBlock(rows, 0);
+    ASSERT_EQ(blockDataGetSortKeyLen(pBlock, pOrderInfo), 1 + sizeof(int32_t) + 1 + sizeof(double));
+    ASSERT_EQ(blockDataSort(pBlock, pOrderInfo), 0);
+
+    SColumnInfoData* pIdCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2);
+    for (int32_t i = 0; i < rows; ++i) {
+      // the columns are moved together, and the rows are in order
+      int32_t id = *(int64_t*)colDataGetData(pIdCol, i);
+      ASSERT_EQ(compareNormKeyRow(pOrderInfo, pBlock, i, pOrigin, id), 0);
+      if (i > 0) {
+        ASSERT_LE(compareNormKeyRow(pOrderInfo, pBlock, i - 1, pBlock, i), 0);
+      }
+    }
+
+    blockDataDestroy(pOrigin);
+    blockDataDestroy(pBlock);
+    taosArrayDestroy(pOrderInfo);
+  }
+}
+
+TEST(testCase, normalized_key_merge_Test) {
+  SArray* pOrderInfo = createNormKeyOrderInfo(TSDB_ORDER_DESC, false, TSDB_ORDER_ASC, true);
+
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+
+  // large enough to be spilled into the disk and merged
+  _normKeyInfo info = {40, 10000, 0, NULL};
+  SSortHandle* phandle = tsortCreateSortHandle(pOrderInfo, SORT_SINGLESOURCE_SORT, -1, -1, NULL, "test_normkey");
+  tsortSetFetchRawDataFp(phandle, getNormKeyBlock, NULL, NULL);
+
+  SSortSource* ps = static_cast<SSortSource*>(taosMemoryCalloc(1, sizeof(SSortSource)));
+  ps->param = &info;
+  ps->onlyRef = true;
+  tsortAddSource(phandle, ps);
+  ASSERT_EQ(tsortOpen(phandle), 0);
+  ASSERT_EQ(tsortGetSortExecInfo(phandle).sortMethod, SORT_SPILLED_MERGE_SORT_T);
+
+  SSDataBlock* pPrev = createNormKeyBlock(1, 0);
+  SSDataBlock* pCurr = createNormKeyBlock(1, 0);
+  int32_t      row = 0;
+  while (1) {
+    STupleHandle* pTupleHandle = tsortNextTuple(phandle);
+    if (pTupleHandle == NULL) {
+      break;
+    }
+
+    for (int32_t i = 0; i < 3; ++i) {
+      SColumnInfoData* pCol = (SColumnInfoData*)taosArrayGet(pCurr->pDataBlock, i);
+      if (tsortIsNullVal(pTupleHandle, i)) {
+        colDataAppendNULL(pCol, 0);
+      } else {
+        colDataAppend(pCol, 0, (const char*)tsortGetValue(pTupleHandle, i), false);
+        colDataClearNull_f(pCol->nullbitmap, 0);
+      }
+    }
+
+    if (row++ > 0) {
+      ASSERT_LE(compareNormKeyRow(pOrderInfo, pPrev, 0, pCurr, 0), 0);
+    }
+    std::swap(pPrev, pCurr);
+  }
+  ASSERT_EQ(row, info.count * info.rows);
+
+  blockDataDestroy(pPrev);
+  blockDataDestroy(pCurr);
+  tsortDestroySortHandle(phandle);
+  taosArrayDestroy(pOrderInfo);
+}
+
 #pragma GCC diagnostic pop
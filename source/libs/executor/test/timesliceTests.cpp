@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "plannodes.h"
+#include "tdatablock.h"
+
+// Interpolate generated rows of every 10ms at every 3ms with the time slice operator, like interp(v) every(3a) with
+// each fill mode, and check the values of every slot.
+
+namespace {
+
+const int64_t kSliceTsStart = 1600000000000;
+const int64_t kSliceGap = 10;
+const int64_t kSliceInterval = 3;
+const int64_t kSliceValue = 7;
+
+typedef struct STimeSliceTestSource {
+  int32_t      numOfBlocks;
+  int32_t      rows;
+  int64_t      seq;
+  SSDataBlock* pBlock;
+} STimeSliceTestSource;
+
+// col 0: timestamp, col 1: int of the sequence, col 2: double of the sequence, NULL for every 7th row
+SSDataBlock* getTimeSliceTestBlock(SOperatorInfo* pOperator) {
+  STimeSliceTestSource* pSource = (STimeSliceTestSource*)pOperator->info;
+  if (pSource->numOfBlocks-- <= 0) {
+    return NULL;
+  }
+
+  if (pSource->pBlock == NULL) {
+    pSource->pBlock = createDataBlock();
+    SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 1);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+    colInfo = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 2);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+    colInfo = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 3);
+    blockDataAppendColInfo(pSource->pBlock, &colInfo);
+  } else {
+    blockDataCleanup(pSource->pBlock);
+  }
+
+  SSDataBlock* pBlock = pSource->pBlock;
+  blockDataEnsureCapacity(pBlock, pSource->rows);
+
+  SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pIntCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  SColumnInfoData* pDoubleCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2);
+  for (int32_t i = 0; i < pSource->rows; ++i) {
+    int64_t seq = pSource->seq++;
+    int64_t ts = kSliceTsStart + seq * kSliceGap;
+    int32_t v = (int32_t)seq;
+    double  d = (double)seq;
+    colDataAppend(pTsCol, i, (const char*)&ts, false);
+    colDataAppend(pIntCol, i, (const char*)&v, false);
+    colDataAppend(pDoubleCol, i, (const char*)&d, seq % 7 == 0);
+  }
+
+  pBlock->info.rows = pSource->rows;
+  return pBlock;
+}
+
+SNode* createTimeSliceTestColumn(int16_t slotId, uint8_t type, int32_t bytes) {
+  SColumnNode* pCol = (SColumnNode*)nodesMakeNode(QUERY_NODE_COLUMN);
+  pCol->dataBlockId = 1;
+  pCol->slotId = slotId;
+  pCol->colId = slotId + 1;
+  pCol->node.resType.type = type;
+  pCol->node.resType.bytes = bytes;
+  return (SNode*)pCol;
+}
+
+// output: slot timestamp, int, double
+SInterpFuncPhysiNode* createTimeSliceTestNode(EFillMode fillMode, int64_t skey, int64_t ekey) {
+  SInterpFuncPhysiNode* pNode = (SInterpFuncPhysiNode*)nodesMakeNode(QUERY_NODE_PHYSICAL_PLAN_INTERP_FUNC);
+  SDataBlockDescNode*   pDesc = (SDataBlockDescNode*)nodesMakeNode(QUERY_NODE_DATABLOCK_DESC);
+
+  uint8_t types[] = {TSDB_DATA_TYPE_TIMESTAMP, TSDB_DATA_TYPE_INT, TSDB_DATA_TYPE_DOUBLE};
+  int32_t bytes[] = {sizeof(int64_t), sizeof(int32_t), sizeof(double)};
+  for (int16_t i = 0; i < 3; ++i) {
+    SSlotDescNode* pSlot = (SSlotDescNode*)nodesMakeNode(QUERY_NODE_SLOT_DESC);
+    pSlot->slotId = i;
+    pSlot->dataType.type = types[i];
+    pSlot->dataType.bytes = bytes[i];
+    pSlot->output = true;
+    nodesListMakeAppend(&pDesc->pSlots, (SNode*)pSlot);
+    pDesc->totalRowSize += bytes[i];
+    pDesc->outputRowSize += bytes[i];
+
+    STargetNode* pTarget = (STargetNode*)nodesMakeNode(QUERY_NODE_TARGET);
+    pTarget->slotId = i;
+    pTarget->pExpr = createTimeSliceTestColumn(i, types[i], bytes[i]);
+    nodesListMakeAppend(&pNode->pFuncs, (SNode*)pTarget);
+  }
+
+  SValueNode* pValue = (SValueNode*)nodesMakeNode(QUERY_NODE_VALUE);
+  pValue->node.resType.type = TSDB_DATA_TYPE_BIGINT;
+  pValue->node.resType.bytes = sizeof(int64_t);
+  pValue->datum.i = kSliceValue;
+  SNodeListNode* pFillValues = (SNodeListNode*)nodesMakeNode(QUERY_NODE_NODE_LIST);
+  nodesListMakeAppend(&pFillValues->pNodeList, (SNode*)pValue);
+
+  pNode->node.pOutputDataBlockDesc = pDesc;
+  pNode->timeRange.skey = skey;
+  pNode->timeRange.ekey = ekey;
+  pNode->interval = kSliceInterval;
+  pNode->fillMode = fillMode;
+  pNode->pFillValues = (SNode*)pFillValues;
+  pNode->pTimeSeries = createTimeSliceTestColumn(0, TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t));
+  return pNode;
+}
+
+typedef struct STimeSliceExpect {
+  int64_t intVal;
+  double  doubleVal;
+  bool    intNull;
+  bool    doubleNull;
+} STimeSliceExpect;
+
+// The expected values of the slot at ts, or false if the slot is not in the result. The int and the double values
+// are the same number, the double value is NULL if any row it comes from is NULL.
+bool getTimeSliceExpect(int32_t fillType, int64_t ts, int64_t numOfRows, STimeSliceExpect* pExpect) {
+  int64_t off = ts - kSliceTsStart;
+  int64_t prev = (off < 0) ? -1 : off / kSliceGap;
+  int64_t next = prev + 1;
+
+  pExpect->intNull = false;
+  if (off >= 0 && off % kSliceGap == 0 && prev < numOfRows) {
+    pExpect->intVal = prev;
+    pExpect->doubleVal = (double)prev;
+    pExpect->doubleNull = (prev % 7 == 0);
+    return true;
+  }
+
+  // after the last row the previous row is the last one
+  bool hasPrev = (prev >= 0);
+  bool hasNext = (next < numOfRows);
+  prev = TMIN(prev, numOfRows - 1);
+
+  switch (fillType) {
+    case TSDB_FILL_NULL:
+      pExpect->intNull = true;
+      pExpect->doubleNull = true;
+      return true;
+    case TSDB_FILL_SET_VALUE:
+      pExpect->intVal = kSliceValue;
+      pExpect->doubleVal = (double)kSliceValue;
+      pExpect->doubleNull = false;
+      return true;
+    case TSDB_FILL_PREV:
+      pExpect->intVal = prev;
+      pExpect->doubleVal = (double)prev;
+      pExpect->doubleNull = (prev % 7 == 0);
+      return hasPrev;
+    case TSDB_FILL_NEXT:
+      pExpect->intVal = next;
+      pExpect->doubleVal = (double)next;
+      pExpect->doubleNull = (next % 7 == 0);
+      return hasNext;
+    case TSDB_FILL_LINEAR:
+      pExpect->doubleVal = prev + (double)(ts - (kSliceTsStart + prev * kSliceGap)) / kSliceGap;
+      pExpect->intVal = (int64_t)pExpect->doubleVal;
+      pExpect->doubleNull = (prev % 7 == 0) || (next % 7 == 0);
+      return hasPrev && hasNext;
+    default:
+      return false;
+  }
+}
+
+void runTimeSliceTest(EFillMode fillMode, int32_t numOfBlocks, int32_t rows) {
+  STimeSliceTestSource source = {numOfBlocks, rows, 0, NULL};
+  SOperatorInfo*       pDownstream = (SOperatorInfo*)taosMemoryCalloc(1, sizeof(SOperatorInfo));
+  pDownstream->name = "timeSliceTestSource";
+  pDownstream->info = &source;
+  pDownstream->resultDataBlockId = 1;
+  pDownstream->fpSet.getNextFn = getTimeSliceTestBlock;
+
+  // the range starts before the first row and ends after the last row
+  int64_t numOfRows = (int64_t)numOfBlocks * rows;
+  int64_t skey = kSliceTsStart - 5 * kSliceInterval;
+  int64_t ekey = kSliceTsStart + numOfRows * kSliceGap + 5 * kSliceInterval;
+
+  SExecTaskInfo         taskInfo = {0};
+  SInterpFuncPhysiNode* pNode = createTimeSliceTestNode(fillMode, skey, ekey);
+  taskInfo.id.str = "timeSliceTest";
+
+  SOperatorInfo* pOperator = createTimeSliceOperatorInfo(pDownstream, (SPhysiNode*)pNode, &taskInfo);
+  ASSERT_NE(pOperator, nullptr);
+
+  int32_t fillType = convertFillType(fillMode);
+
+  int64_t ts = skey;
+  for (SSDataBlock* pRes = pOperator->fpSet.getNextFn(pOperator); pRes != NULL;
+       pRes = pOperator->fpSet.getNextFn(pOperator)) {
+    SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 0);
+    SColumnInfoData* pIntCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 1);
+    SColumnInfoData* pDoubleCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 2);
+
+    for (int32_t i = 0; i < pRes->info.rows; ++i) {
+      STimeSliceExpect expect = {0};
+      while (!getTimeSliceExpect(fillType, ts, numOfRows, &expect)) {
+        ts += kSliceInterval;
+      }
+
+      ASSERT_EQ(*(int64_t*)colDataGetData(pTsCol, i), ts);
+      ASSERT_EQ(colDataIsNull_f(pIntCol->nullbitmap, i), expect.intNull);
+      if (!expect.intNull) {
+        ASSERT_EQ(*(int32_t*)colDataGetData(pIntCol, i), expect.intVal);
+      }
+      ASSERT_EQ(colDataIsNull_f(pDoubleCol->nullbitmap, i), expect.doubleNull);
+      if (!expect.doubleNull) {
+        ASSERT_DOUBLE_EQ(*(double*)colDataGetData(pDoubleCol, i), expect.doubleVal);
+      }
+      ts += kSliceInterval;
+    }
+  }
+
+  // no slot left out at the end of the result
+  STimeSliceExpect expect = {0};
+  for (; ts <= ekey; ts += kSliceInterval) {
+    ASSERT_FALSE(getTimeSliceExpect(fillType, ts, numOfRows, &expect));
+  }
+
+  destroyOperatorInfo(pOperator);
+  blockDataDestroy(source.pBlock);
+  nodesDestroyNode((SNode*)pNode);
+}
+
+}  // namespace
+
+TEST(timeSliceTest, fillModes) {
+  EFillMode modes[] = {FILL_MODE_NONE, FILL_MODE_NULL, FILL_MODE_VALUE, FILL_MODE_PREV, FILL_MODE_NEXT,
+                       FILL_MODE_LINEAR};
+  for (EFillMode mode : modes) {
+    runTimeSliceTest(mode, 1, 100);
+    runTimeSliceTest(mode, 13, 1);
+    runTimeSliceTest(mode, 10, 4096);
+  }
+}
+
+#pragma GCC diagnostic pop
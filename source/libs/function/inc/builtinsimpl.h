@@ -23,6 +23,9 @@ extern "C" {
 #include "function.h"
 #include "functionMgt.h"
 
+#define PERCENTILE_MAX_NUM_OF_PERCENTS 10
+#define PERCENTILE_MULTI_RESULT_LEN    512
+
 typedef struct SSumRes {
   union {
     int64_t  isum;
@@ -23,56 +23,44 @@ extern "C" {
 #include "tpagedbuf.h"
 #include "ttszip.h"
 
-typedef struct MinMaxEntry {
-  union {
-    double   dMinVal;
-    int64_t  i64MinVal;
-    uint64_t u64MinVal;
-  };
-  union {
-    double  dMaxVal;
-    int64_t i64MaxVal;
-    int64_t u64MaxVal;
-  };
-} MinMaxEntry;
-
-typedef struct {
-  int32_t    size;
-  int32_t    pageId;
-  SFilePage *data;
-} SSlotInfo;
+#define PERCENTILE_RADIX_BITS  8
+#define PERCENTILE_NUM_OF_SLOT (1 << PERCENTILE_RADIX_BITS)
 
+/*
+ * All values are kept as order-preserving 64-bit keys, so that integer and floating point columns share the same
+ * radix partitioning. Keys are buffered in memory first; once the buffer is full they are partitioned by the most
+ * significant byte and appended to the disk based pages of the corresponding slot.
+ */
 typedef struct tMemBucketSlot {
-  SSlotInfo   info;
-  MinMaxEntry range;
+  int64_t size;
+  SArray *pPageIdList;
 } tMemBucketSlot;
 
-struct tMemBucket;
-typedef int32_t (*__perc_hash_func_t)(struct tMemBucket *pBucket, const void *value);
-
 typedef struct tMemBucket {
-  int16_t            numOfSlots;
-  int16_t            type;
-  int16_t            bytes;
-  int32_t            total;
-  int32_t            elemPerPage;  // number of elements for each object
-  int32_t            maxCapacity;  // maximum allowed number of elements that can be sort directly to get the result
-  int32_t            bufPageSize;  // disk page size
-  MinMaxEntry        range;        // value range
-  int32_t            times;        // count that has been checked for deciding the correct data value buckets.
-  __compar_fn_t      comparFn;
-  tMemBucketSlot    *pSlots;
-  SDiskbasedBuf     *pBuffer;
-  __perc_hash_func_t hashFunc;
-  SHashObj          *groupPagesMap;  // disk page map for different groups;
+  int16_t        type;
+  int16_t        bytes;
+  int64_t        total;
+  int32_t        elemPerPage;  // number of keys in each disk page
+  int32_t        maxCapacity;  // maximum number of keys that are kept in memory and selected directly
+  int32_t        bufPageSize;  // disk page size
+  uint64_t      *pKeys;        // keys not spilled yet
+  int32_t        numOfKeys;
+  int32_t        capacity;
+  SDiskbasedBuf *pBuffer;      // created when the in-memory keys are spilled for the first time
+  tMemBucketSlot pSlots[PERCENTILE_NUM_OF_SLOT];
 } tMemBucket;
 
-tMemBucket *tMemBucketCreate(int16_t nElemSize, int16_t dataType, double minval, double maxval);
+tMemBucket *tMemBucketCreate(int16_t nElemSize, int16_t dataType);
 
 void tMemBucketDestroy(tMemBucket *pBucket);
 
 int32_t tMemBucketPut(tMemBucket *pBucket, const void *data, size_t size);
 
+/*
+ * Calculate several percentiles in one selection, percents are in the range of [0, 100] and need not be ordered.
+ */
+int32_t getPercentiles(tMemBucket *pMemBucket, const double *percents, int32_t num, double *pResults);
+
 double getPercentile(tMemBucket *pMemBucket, double percent);
 
 #endif  // TDENGINE_TPERCENTILE_H
@@ -22,10 +22,40 @@ extern "C" {
 enum {
   UDF_TASK_SETUP = 0,
   UDF_TASK_CALL = 1,
-  UDF_TASK_TEARDOWN = 2
+  UDF_TASK_TEARDOWN = 2,
+  UDF_TASK_SHM_MSG = 3,  // the real request/response is in the shared memory ring of the connection
 
 };
 
+// messages not shorter than this are passed through the shared memory ring when it is available
+#define UDF_SHM_MIN_MSG_LEN 4096
+#define UDF_SHM_MAGIC       0x53484D55
+
+/*
+ * The shared memory segment of one udfc connection is created by udfc and mapped by udfd. It holds two rings, the
+ * requests are written by udfc and the responses by udfd. The pipe only carries the offset and length of each frame,
+ * the reader releases a frame after it is decoded, and the writer reclaims the released frames in order.
+ */
+typedef struct SUdfShmHead {
+  int32_t magic;
+  int32_t reserved;
+  int64_t ringSize;
+} SUdfShmHead;
+
+typedef struct SUdfShmRing {
+  char      *data;
+  int64_t    size;
+  int64_t    head;  // the oldest frame not reclaimed yet
+  int64_t    tail;  // where the next frame is allocated
+  int64_t    used;
+  uv_mutex_t mutex;
+} SUdfShmRing;
+
+typedef struct SUdfShmMsg {
+  int64_t offset;
+  int32_t len;
+} SUdfShmMsg;
+
 enum {
   TSDB_UDF_CALL_AGG_INIT = 0,
   TSDB_UDF_CALL_AGG_PROC,
@@ -35,7 +65,9 @@ enum {
 };
 
 typedef struct SUdfSetupRequest {
-  char udfName[TSDB_FUNC_NAME_LEN + 1];
+  char    udfName[TSDB_FUNC_NAME_LEN + 1];
+  char    shmName[TD_SHM_NAME_LEN];  // empty if the connection has no shared memory
+  int64_t shmSize;
 } SUdfSetupRequest;
 
 typedef struct SUdfSetupResponse {
@@ -43,6 +75,7 @@ typedef struct SUdfSetupResponse {
   int8_t  outputType;
   int32_t outputLen;
   int32_t bufSize;
+  int8_t  shmAttached;
 } SUdfSetupResponse;
 
 typedef struct SUdfCallRequest {
@@ -53,6 +86,10 @@ typedef struct SUdfCallRequest {
   SUdfInterBuf interBuf;
   SUdfInterBuf interBuf2;
   int8_t       initFirst;
+
+  // decoded in place from the shared memory, udfBlock and the inter bufs point into the frame
+  int8_t        mapped;
+  SUdfDataBlock udfBlock;
 } SUdfCallRequest;
 
 typedef struct SUdfCallResponse {
@@ -80,6 +117,7 @@ typedef struct SUdfRequest {
     SUdfSetupRequest    setup;
     SUdfCallRequest     call;
     SUdfTeardownRequest teardown;
+    SUdfShmMsg          shmMsg;
   };
 } SUdfRequest;
 
@@ -93,11 +131,17 @@ typedef struct SUdfResponse {
     SUdfSetupResponse    setupRsp;
     SUdfCallResponse     callRsp;
     SUdfTeardownResponse teardownRsp;
+    SUdfShmMsg           shmMsg;
   };
 } SUdfResponse;
 
 int32_t encodeUdfRequest(void **buf, const SUdfRequest *request);
 void   *decodeUdfRequest(const void *buf, SUdfRequest *request);
+void   *decodeUdfRequestHead(const void *buf, SUdfRequest *request);
+
+int32_t encodeUdfShmRequest(void **buf, const SUdfRequest *request);
+void   *decodeUdfShmRequest(const void *buf, SUdfRequest *request);
+int32_t udfEncodeRequestMsg(SUdfShmRing *ring, SUdfRequest *request, uv_buf_t *pMsg);
 
 int32_t encodeUdfResponse(void **buf, const SUdfResponse *response);
 void   *decodeUdfResponse(const void *buf, SUdfResponse *response);
@@ -105,11 +149,18 @@ void   *decodeUdfResponse(const void *buf, SUdfResponse *response);
 void freeUdfColumnData(SUdfColumnData *data, SUdfColumnMeta *meta);
 void freeUdfColumn(SUdfColumn *col);
 void freeUdfDataDataBlock(SUdfDataBlock *block);
+void freeUdfShmDataBlock(SUdfDataBlock *block);
 
 int32_t convertDataBlockToUdfDataBlock(SSDataBlock *block, SUdfDataBlock *udfBlock);
 int32_t convertUdfColumnToDataBlock(SUdfColumn *udfCol, SSDataBlock *block);
 
 int32_t getUdfdPipeName(char *pipeName, int32_t size);
+
+int32_t udfShmRingInit(SUdfShmRing *ring, char *data, int64_t size);
+void    udfShmRingDestroy(SUdfShmRing *ring);
+char   *udfShmRingAlloc(SUdfShmRing *ring, int32_t len, int64_t *pOffset);
+char   *udfShmRingGetFrame(char *data, int64_t size, const SUdfShmMsg *pMsg);
+void    udfShmRingRelease(char *data, int64_t offset);
 #ifdef __cplusplus
 }
 #endif
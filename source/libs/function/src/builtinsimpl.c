@@ -93,10 +93,6 @@ typedef struct SLeastSQRInfo {
 typedef struct SPercentileInfo {
   double      result;
   tMemBucket* pMemBucket;
-  int32_t     stage;
-  double      minval;
-  double      maxval;
-  int64_t     numOfElems;
 } SPercentileInfo;
 
 typedef struct SAPercentileInfo {
@@ -1541,12 +1537,9 @@ bool percentileFunctionSetup(SqlFunctionCtx* pCtx, SResultRowEntryInfo* pResultI
     return false;
   }
 
-  // in the first round, get the min-max value of all involved data
+  // the bucket is created along with the first non-null value, so that no value range is required in advance
   SPercentileInfo* pInfo = GET_ROWCELL_INTERBUF(pResultInfo);
-  SET_DOUBLE_VAL(&pInfo->minval, DBL_MAX);
-  SET_DOUBLE_VAL(&pInfo->maxval, -DBL_MAX);
-  pInfo->numOfElems = 0;
-
+  pInfo->pMemBucket = NULL;
   return true;
 }
 
@@ -1555,105 +1548,83 @@ int32_t percentileFunction(SqlFunctionCtx* pCtx) {
   SResultRowEntryInfo* pResInfo = GET_RES_INFO(pCtx);
 
   SInputColumnInfoData* pInput = &pCtx->input;
-  SColumnDataAgg*       pAgg = pInput->pColumnDataAgg[0];
-
-  SColumnInfoData* pCol = pInput->pData[0];
-  int32_t          type = pCol->info.type;
+  SColumnInfoData*      pCol = pInput->pData[0];
+  int32_t               type = pCol->info.type;
 
   SPercentileInfo* pInfo = GET_ROWCELL_INTERBUF(pResInfo);
-  if (pCtx->scanFlag == REPEAT_SCAN && pInfo->stage == 0) {
-    pInfo->stage += 1;
-
-    // all data are null, set it completed
-    if (pInfo->numOfElems == 0) {
-      pResInfo->complete = true;
-      return 0;
-    } else {
-      pInfo->pMemBucket = tMemBucketCreate(pCol->info.bytes, type, pInfo->minval, pInfo->maxval);
-    }
-  }
-
-  // the first stage, only acquire the min/max value
-  if (pInfo->stage == 0) {
-    if (pCtx->input.colDataSMAIsSet) {
-      double tmin = 0.0, tmax = 0.0;
-      if (IS_SIGNED_NUMERIC_TYPE(type)) {
-        tmin = (double)GET_INT64_VAL(&pAgg->min);
-        tmax = (double)GET_INT64_VAL(&pAgg->max);
-      } else if (IS_FLOAT_TYPE(type)) {
-        tmin = GET_DOUBLE_VAL(&pAgg->min);
-        tmax = GET_DOUBLE_VAL(&pAgg->max);
-      } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
-        tmin = (double)GET_UINT64_VAL(&pAgg->min);
-        tmax = (double)GET_UINT64_VAL(&pAgg->max);
-      }
-
-      if (GET_DOUBLE_VAL(&pInfo->minval) > tmin) {
-        SET_DOUBLE_VAL(&pInfo->minval, tmin);
-      }
-
-      if (GET_DOUBLE_VAL(&pInfo->maxval) < tmax) {
-        SET_DOUBLE_VAL(&pInfo->maxval, tmax);
-      }
-
-      pInfo->numOfElems += (pInput->numOfRows - pAgg->numOfNull);
-    } else {
-      // check the valid data one by one
-      int32_t start = pInput->startRowIndex;
-      for (int32_t i = start; i < pInput->numOfRows + start; ++i) {
-        if (colDataIsNull_f(pCol->nullbitmap, i)) {
-          continue;
-        }
-
-        char* data = colDataGetData(pCol, i);
-
-        double v = 0;
-        GET_TYPED_DATA(v, double, type, data);
-        if (v < GET_DOUBLE_VAL(&pInfo->minval)) {
-          SET_DOUBLE_VAL(&pInfo->minval, v);
-        }
-
-        if (v > GET_DOUBLE_VAL(&pInfo->maxval)) {
-          SET_DOUBLE_VAL(&pInfo->maxval, v);
-        }
+  if (pInfo->pMemBucket == NULL) {
+    pInfo->pMemBucket = tMemBucketCreate(pCol->info.bytes, type);
+    if (pInfo->pMemBucket == NULL) {
+      return terrno;
+    }
+  }
 
-        pInfo->numOfElems += 1;
-      }
+  int32_t code = TSDB_CODE_SUCCESS;
+  int32_t start = pInput->startRowIndex;
+  if (!pCol->hasNull) {
+    numOfElems = pInput->numOfRows;
+    if (numOfElems > 0) {
+      code = tMemBucketPut(pInfo->pMemBucket, colDataGetData(pCol, start), numOfElems);
     }
   } else {
-    // the second stage, calculate the true percentile value
-    int32_t start = pInput->startRowIndex;
     for (int32_t i = start; i < pInput->numOfRows + start; ++i) {
       if (colDataIsNull_f(pCol->nullbitmap, i)) {
         continue;
       }
 
-      char* data = colDataGetData(pCol, i);
       numOfElems += 1;
-      tMemBucketPut(pInfo->pMemBucket, data, 1);
+      code = tMemBucketPut(pInfo->pMemBucket, colDataGetData(pCol, i), 1);
+      if (code != TSDB_CODE_SUCCESS) {
+        break;
+      }
     }
-
-    SET_VAL(pResInfo, numOfElems, 1);
   }
 
-  return TSDB_CODE_SUCCESS;
+  SET_VAL(pResInfo, numOfElems, 1);
+  return code;
 }
 
 int32_t percentileFinalize(SqlFunctionCtx* pCtx, SSDataBlock* pBlock) {
-  SVariant* pVal = &pCtx->param[1].param;
-  double    v = 0;
-  GET_TYPED_DATA(v, double, pVal->nType, &pVal->i);
-
   SResultRowEntryInfo* pResInfo = GET_RES_INFO(pCtx);
   SPercentileInfo*     ppInfo = (SPercentileInfo*)GET_ROWCELL_INTERBUF(pResInfo);
+  tMemBucket*          pMemBucket = ppInfo->pMemBucket;
+
+  int32_t numOfPercents = pCtx->numOfParams - 1;
+  double  percents[PERCENTILE_MAX_NUM_OF_PERCENTS] = {0};
+  double  results[PERCENTILE_MAX_NUM_OF_PERCENTS] = {0};
+  for (int32_t i = 0; i < numOfPercents; ++i) {
+    SVariant* pVal = &pCtx->param[i + 1].param;
+    GET_TYPED_DATA(percents[i], double, pVal->nType, &pVal->i);
+  }
 
-  tMemBucket* pMemBucket = ppInfo->pMemBucket;
+  // all percentiles are selected in one pass over the bucket
   if (pMemBucket != NULL && pMemBucket->total > 0) {  // check for null
-    SET_DOUBLE_VAL(&ppInfo->result, getPercentile(pMemBucket, v));
+    int32_t code = getPercentiles(pMemBucket, percents, numOfPercents, results);
+    if (code != TSDB_CODE_SUCCESS) {
+      tMemBucketDestroy(pMemBucket);
+      ppInfo->pMemBucket = NULL;
+      return code;
+    }
   }
 
   tMemBucketDestroy(pMemBucket);
-  return functionFinalize(pCtx, pBlock);
+  ppInfo->pMemBucket = NULL;
+
+  if (numOfPercents == 1) {
+    SET_DOUBLE_VAL(&ppInfo->result, results[0]);
+    return functionFinalize(pCtx, pBlock);
+  }
+
+  char    buf[PERCENTILE_MULTI_RESULT_LEN + VARSTR_HEADER_SIZE] = {0};
+  int32_t len = snprintf(varDataVal(buf), PERCENTILE_MULTI_RESULT_LEN, "[");
+  for (int32_t i = 0; i < numOfPercents; ++i) {
+    len += snprintf(varDataVal(buf) + len, PERCENTILE_MULTI_RESULT_LEN - len, (i == 0) ? "%.15g" : ", %.15g",
+                    results[i]);
+  }
+  len += snprintf(varDataVal(buf) + len, PERCENTILE_MULTI_RESULT_LEN - len, "]");
+  varDataSetLen(buf, TMIN(len, PERCENTILE_MULTI_RESULT_LEN));
+
+  return functionFinalizeWithResultBuf(pCtx, pBlock, buf);
 }
 
 bool getApercentileFuncEnv(SFunctionNode* pFunc, SFuncExecEnv* pEnv) {
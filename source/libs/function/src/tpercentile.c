@@ -18,263 +18,298 @@
 #include "tglobal.h"
 
 #include "taosdef.h"
-#include "tcompare.h"
 #include "tpagedbuf.h"
 #include "tpercentile.h"
 #include "ttypes.h"
 #include "tlog.h"
 
-#define DEFAULT_NUM_OF_SLOT 1024
-
-int32_t getGroupId(int32_t numOfSlots, int32_t slotIndex, int32_t times) { return (times * numOfSlots) + slotIndex; }
-
-static SFilePage *loadDataFromFilePage(tMemBucket *pMemBucket, int32_t slotIdx) {
-  SFilePage *buffer =
-      (SFilePage *)taosMemoryCalloc(1, pMemBucket->bytes * pMemBucket->pSlots[slotIdx].info.size + sizeof(SFilePage));
-
-  int32_t groupId = getGroupId(pMemBucket->numOfSlots, slotIdx, pMemBucket->times);
-  SArray *pIdList = *(SArray **)taosHashGet(pMemBucket->groupPagesMap, &groupId, sizeof(groupId));
-
-  int32_t offset = 0;
-  for (int32_t i = 0; i < taosArrayGetSize(pIdList); ++i) {
-    int32_t *pageId = taosArrayGet(pIdList, i);
-
-    SFilePage *pg = getBufPage(pMemBucket->pBuffer, *pageId);
-    memcpy(buffer->data + offset, pg->data, (size_t)(pg->num * pMemBucket->bytes));
-
-    offset += (int32_t)(pg->num * pMemBucket->bytes);
-  }
-
-  taosSort(buffer->data, pMemBucket->pSlots[slotIdx].info.size, pMemBucket->bytes, pMemBucket->comparFn);
-  return buffer;
-}
+#define PERCENTILE_INIT_CAPACITY   1024
+#define PERCENTILE_MAX_CAPACITY    (1 << 18)
+#define PERCENTILE_SORT_THRESHOLD  64
+#define PERCENTILE_TOP_SHIFT       (64 - PERCENTILE_RADIX_BITS)
+#define PERCENTILE_SIGN_BIT        ((uint64_t)1 << 63)
+#define PERCENTILE_DIGIT(k, shift) ((int32_t)(((k) >> (shift)) & (PERCENTILE_NUM_OF_SLOT - 1)))
 
-static void resetBoundingBox(MinMaxEntry *range, int32_t type) {
+/*
+ * map the value to an unsigned key with the same order, so that the radix selection works for all numeric types
+ */
+static FORCE_INLINE uint64_t encodeKey(int16_t type, const char *data) {
   if (IS_SIGNED_NUMERIC_TYPE(type)) {
-    range->i64MaxVal = INT64_MIN;
-    range->i64MinVal = INT64_MAX;
+    int64_t v = 0;
+    GET_TYPED_DATA(v, int64_t, type, data);
+    return ((uint64_t)v) ^ PERCENTILE_SIGN_BIT;
   } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
-    range->u64MaxVal = 0;
-    range->u64MinVal = UINT64_MAX;
+    uint64_t v = 0;
+    GET_TYPED_DATA(v, uint64_t, type, data);
+    return v;
   } else {
-    range->dMaxVal = -DBL_MAX;
-    range->dMinVal = DBL_MAX;
-  }
-}
+    double v = 0;
+    GET_TYPED_DATA(v, double, type, data);
 
-static int32_t setBoundingBox(MinMaxEntry *range, int16_t type, double minval, double maxval) {
-  if (minval > maxval) {
-    return -1;
+    uint64_t k = 0;
+    memcpy(&k, &v, sizeof(k));
+    return (k & PERCENTILE_SIGN_BIT) ? ~k : (k | PERCENTILE_SIGN_BIT);
   }
+}
 
+static FORCE_INLINE double decodeKey(int16_t type, uint64_t k) {
   if (IS_SIGNED_NUMERIC_TYPE(type)) {
-    range->i64MinVal = (int64_t)minval;
-    range->i64MaxVal = (int64_t)maxval;
+    return (double)((int64_t)(k ^ PERCENTILE_SIGN_BIT));
   } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
-    range->u64MinVal = (uint64_t)minval;
-    range->u64MaxVal = (uint64_t)maxval;
+    return (double)k;
   } else {
-    range->dMinVal = minval;
-    range->dMaxVal = maxval;
-  }
+    k = (k & PERCENTILE_SIGN_BIT) ? (k & ~PERCENTILE_SIGN_BIT) : ~k;
 
-  return 0;
+    double v = 0;
+    memcpy(&v, &k, sizeof(v));
+    return v;
+  }
 }
 
-static void resetPosInfo(SSlotInfo *pInfo) {
-  pInfo->size = 0;
-  pInfo->pageId = -1;
-  pInfo->data = NULL;
+static void insertSortKeys(uint64_t *pKeys, int64_t num) {
+  for (int64_t i = 1; i < num; ++i) {
+    uint64_t k = pKeys[i];
+    int64_t  j = i - 1;
+    while (j >= 0 && pKeys[j] > k) {
+      pKeys[j + 1] = pKeys[j];
+      --j;
+    }
+    pKeys[j + 1] = k;
+  }
 }
 
-double findOnlyResult(tMemBucket *pMemBucket) {
-  assert(pMemBucket->total == 1);
-
-  for (int32_t i = 0; i < pMemBucket->numOfSlots; ++i) {
-    tMemBucketSlot *pSlot = &pMemBucket->pSlots[i];
-    if (pSlot->info.size == 0) {
-      continue;
+/*
+ * MSD radix selection of several ranks at once. The ranks are in ascending order and relative to the beginning of
+ * pKeys, only the partitions that contain a required rank are refined at the next digit.
+ */
+static void radixSelect(uint64_t *pKeys, uint64_t *pTmp, int64_t num, int32_t shift, const int64_t *pRanks,
+                        int32_t numOfRanks, int64_t base, uint64_t *pResult) {
+  if (shift < 0) {  // all keys are identical
+    for (int32_t i = 0; i < numOfRanks; ++i) {
+      pResult[i] = pKeys[0];
     }
+    return;
+  }
 
-    int32_t groupId = getGroupId(pMemBucket->numOfSlots, i, pMemBucket->times);
-    SArray **pList = taosHashGet(pMemBucket->groupPagesMap, &groupId, sizeof(groupId));
-    if (pList != NULL)  {
-      SArray *list = *pList;
-      assert(list->size == 1);
+  if (num <= PERCENTILE_SORT_THRESHOLD) {
+    insertSortKeys(pKeys, num);
+    for (int32_t i = 0; i < numOfRanks; ++i) {
+      pResult[i] = pKeys[pRanks[i] - base];
+    }
+    return;
+  }
 
-      int32_t   *pageId = taosArrayGet(list, 0);
-      SFilePage *pPage = getBufPage(pMemBucket->pBuffer, *pageId);
-      assert(pPage->num == 1);
+  int64_t count[PERCENTILE_NUM_OF_SLOT] = {0};
+  for (int64_t i = 0; i < num; ++i) {
+    count[PERCENTILE_DIGIT(pKeys[i], shift)] += 1;
+  }
 
-      double v = 0;
-      GET_TYPED_DATA(v, double, pMemBucket->type, pPage->data);
-      return v;
-    }
+  // all keys share the same digit, no need to move them
+  if (count[PERCENTILE_DIGIT(pKeys[0], shift)] == num) {
+    radixSelect(pKeys, pTmp, num, shift - PERCENTILE_RADIX_BITS, pRanks, numOfRanks, base, pResult);
+    return;
   }
 
-  return 0;
-}
+  int64_t offset[PERCENTILE_NUM_OF_SLOT] = {0};
+  int64_t pos[PERCENTILE_NUM_OF_SLOT] = {0};
+  for (int32_t i = 1; i < PERCENTILE_NUM_OF_SLOT; ++i) {
+    offset[i] = offset[i - 1] + count[i - 1];
+  }
+  memcpy(pos, offset, sizeof(pos));
 
-int32_t tBucketIntHash(tMemBucket *pBucket, const void *value) {
-  int64_t v = 0;
-  GET_TYPED_DATA(v, int64_t, pBucket->type, value);
+  for (int64_t i = 0; i < num; ++i) {
+    pTmp[pos[PERCENTILE_DIGIT(pKeys[i], shift)]++] = pKeys[i];
+  }
 
-  int32_t index = -1;
+  int32_t r = 0;
+  for (int32_t i = 0; i < PERCENTILE_NUM_OF_SLOT && r < numOfRanks; ++i) {
+    int32_t start = r;
+    while (r < numOfRanks && pRanks[r] - base < offset[i] + count[i]) {
+      ++r;
+    }
 
-  if (v > pBucket->range.i64MaxVal || v < pBucket->range.i64MinVal) {
-    return index;
+    if (r > start) {
+      radixSelect(pTmp + offset[i], pKeys + offset[i], count[i], shift - PERCENTILE_RADIX_BITS, pRanks + start,
+                  r - start, base + offset[i], pResult + start);
+    }
   }
+}
 
-  // divide the value range into 1024 buckets
-  uint64_t span = pBucket->range.i64MaxVal - pBucket->range.i64MinVal;
-  if (span < pBucket->numOfSlots) {
-    int64_t delta = v - pBucket->range.i64MinVal;
-    index = (delta % pBucket->numOfSlots);
-  } else {
-    double   slotSpan = ((double)span) / pBucket->numOfSlots;
-    uint64_t delta = v - pBucket->range.i64MinVal;
+static int32_t appendKeysToPages(tMemBucket *pBucket, tMemBucketSlot *pSlot, const uint64_t *pKeys, int64_t num) {
+  if (pSlot->pPageIdList == NULL) {
+    pSlot->pPageIdList = taosArrayInit(4, sizeof(int32_t));
+    if (pSlot->pPageIdList == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
 
-    index = (int32_t)(delta / slotSpan);
-    if (v == pBucket->range.i64MaxVal || index == pBucket->numOfSlots) {
-      index -= 1;
+  SFilePage *pPage = NULL;
+  int32_t    numOfPages = (int32_t)taosArrayGetSize(pSlot->pPageIdList);
+  if (numOfPages > 0) {
+    pPage = getBufPage(pBucket->pBuffer, *(int32_t *)taosArrayGetLast(pSlot->pPageIdList));
+    if (pPage == NULL) {
+      return terrno;
     }
   }
 
-  assert(index >= 0 && index < pBucket->numOfSlots);
-  return index;
-}
+  int64_t offset = 0;
+  while (offset < num) {
+    if (pPage == NULL || pPage->num >= pBucket->elemPerPage) {
+      if (pPage != NULL) {
+        setBufPageDirty(pPage, true);
+        releaseBufPage(pBucket->pBuffer, pPage);
+      }
 
-int32_t tBucketUintHash(tMemBucket *pBucket, const void *value) {
-  int64_t v = 0;
-  GET_TYPED_DATA(v, uint64_t, pBucket->type, value);
+      int32_t pageId = -1;
+      pPage = getNewBufPage(pBucket->pBuffer, &pageId);
+      if (pPage == NULL) {
+        return terrno;
+      }
 
-  int32_t index = -1;
+      pPage->num = 0;
+      taosArrayPush(pSlot->pPageIdList, &pageId);
+    }
 
-  if (v > pBucket->range.u64MaxVal || v < pBucket->range.u64MinVal) {
-    return index;
+    int32_t n = (int32_t)TMIN(num - offset, pBucket->elemPerPage - pPage->num);
+    memcpy(pPage->data + pPage->num * sizeof(uint64_t), pKeys + offset, n * sizeof(uint64_t));
+    pPage->num += n;
+    offset += n;
   }
 
-  // divide the value range into 1024 buckets
-  uint64_t span = pBucket->range.u64MaxVal - pBucket->range.u64MinVal;
-  if (span < pBucket->numOfSlots) {
-    int64_t delta = v - pBucket->range.u64MinVal;
-    index = (int32_t)(delta % pBucket->numOfSlots);
-  } else {
-    double slotSpan = (double)span / pBucket->numOfSlots;
-    index = (int32_t)((v - pBucket->range.u64MinVal) / slotSpan);
-    if (v == pBucket->range.u64MaxVal) {
-      index -= 1;
-    }
+  pSlot->size += num;
+
+  if (pPage != NULL) {
+    setBufPageDirty(pPage, true);
+    releaseBufPage(pBucket->pBuffer, pPage);
   }
 
-  assert(index >= 0 && index < pBucket->numOfSlots);
-  return index;
+  return TSDB_CODE_SUCCESS;
 }
 
-int32_t tBucketDoubleHash(tMemBucket *pBucket, const void *value) {
-  double v = 0;
-  if (pBucket->type == TSDB_DATA_TYPE_FLOAT) {
-    v = GET_FLOAT_VAL(value);
-  } else {
-    v = GET_DOUBLE_VAL(value);
+/*
+ * partition the keys by the digit at the given shift and append them to the pages of the slots
+ */
+static int32_t partitionKeysToSlots(tMemBucket *pBucket, tMemBucketSlot *pSlots, const uint64_t *pKeys, int64_t num,
+                                    int32_t shift, const bool *pRequired, uint64_t *pTmp) {
+  int64_t count[PERCENTILE_NUM_OF_SLOT] = {0};
+  for (int64_t i = 0; i < num; ++i) {
+    count[PERCENTILE_DIGIT(pKeys[i], shift)] += 1;
   }
 
-  int32_t index = -1;
+  int64_t offset[PERCENTILE_NUM_OF_SLOT] = {0};
+  int64_t pos[PERCENTILE_NUM_OF_SLOT] = {0};
+  for (int32_t i = 1; i < PERCENTILE_NUM_OF_SLOT; ++i) {
+    offset[i] = offset[i - 1] + count[i - 1];
+  }
+  memcpy(pos, offset, sizeof(pos));
 
-  if (v > pBucket->range.dMaxVal || v < pBucket->range.dMinVal) {
-    return index;
+  for (int64_t i = 0; i < num; ++i) {
+    pTmp[pos[PERCENTILE_DIGIT(pKeys[i], shift)]++] = pKeys[i];
   }
 
-  // divide a range of [dMinVal, dMaxVal] into 1024 buckets
-  double span = pBucket->range.dMaxVal - pBucket->range.dMinVal;
-  if (span < pBucket->numOfSlots) {
-    int32_t delta = (int32_t)(v - pBucket->range.dMinVal);
-    index = (delta % pBucket->numOfSlots);
-  } else {
-    double slotSpan = span / pBucket->numOfSlots;
-    index = (int32_t)((v - pBucket->range.dMinVal) / slotSpan);
-    if (v == pBucket->range.dMaxVal) {
-      index -= 1;
+  for (int32_t i = 0; i < PERCENTILE_NUM_OF_SLOT; ++i) {
+    if (count[i] == 0 || (pRequired != NULL && !pRequired[i])) {
+      continue;
+    }
+
+    int32_t code = appendKeysToPages(pBucket, &pSlots[i], pTmp + offset[i], count[i]);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
     }
   }
 
-  assert(index >= 0 && index < pBucket->numOfSlots);
-  return index;
+  return TSDB_CODE_SUCCESS;
 }
 
-static __perc_hash_func_t getHashFunc(int32_t type) {
-  if (IS_SIGNED_NUMERIC_TYPE(type)) {
-    return tBucketIntHash;
-  } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
-    return tBucketUintHash;
-  } else {
-    return tBucketDoubleHash;
+static int32_t spillKeys(tMemBucket *pBucket) {
+  if (pBucket->numOfKeys == 0) {
+    return TSDB_CODE_SUCCESS;
   }
-}
 
-static void resetSlotInfo(tMemBucket *pBucket) {
-  for (int32_t i = 0; i < pBucket->numOfSlots; ++i) {
-    tMemBucketSlot *pSlot = &pBucket->pSlots[i];
+  if (pBucket->pBuffer == NULL) {
+    if (!osTempSpaceAvailable()) {
+      return TSDB_CODE_NO_AVAIL_DISK;
+    }
 
-    resetBoundingBox(&pSlot->range, pBucket->type);
-    resetPosInfo(&pSlot->info);
+    int32_t code =
+        createDiskbasedBuf(&pBucket->pBuffer, pBucket->bufPageSize, pBucket->bufPageSize * 512, "percentile", tsTempDir);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
   }
-}
 
-tMemBucket *tMemBucketCreate(int16_t nElemSize, int16_t dataType, double minval, double maxval) {
-  tMemBucket *pBucket = (tMemBucket *)taosMemoryCalloc(1, sizeof(tMemBucket));
-  if (pBucket == NULL) {
-    return NULL;
+  uint64_t *pTmp = taosMemoryMalloc(sizeof(uint64_t) * pBucket->numOfKeys);
+  if (pTmp == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
   }
 
-  pBucket->numOfSlots = DEFAULT_NUM_OF_SLOT;
-  pBucket->bufPageSize = 16384 * 4;  // 16k per page
+  int32_t code = partitionKeysToSlots(pBucket, pBucket->pSlots, pBucket->pKeys, pBucket->numOfKeys,
+                                      PERCENTILE_TOP_SHIFT, NULL, pTmp);
+  taosMemoryFree(pTmp);
 
-  pBucket->type = dataType;
-  pBucket->bytes = nElemSize;
-  pBucket->total = 0;
-  pBucket->times = 1;
+  pBucket->numOfKeys = 0;
+  return code;
+}
 
-  pBucket->maxCapacity = 200000;
-  pBucket->groupPagesMap = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false, HASH_NO_LOCK);
-  if (setBoundingBox(&pBucket->range, pBucket->type, minval, maxval) != 0) {
-    //    qError("MemBucket:%p, invalid value range: %f-%f", pBucket, minval, maxval);
-    taosMemoryFree(pBucket);
-    return NULL;
+static int32_t putKeys(tMemBucket *pBucket, const uint64_t *pKeys, int64_t num) {
+  int64_t offset = 0;
+  while (offset < num) {
+    if (pBucket->numOfKeys >= pBucket->capacity) {
+      if (pBucket->capacity < pBucket->maxCapacity) {
+        int32_t   capacity = TMIN(pBucket->capacity * 2, pBucket->maxCapacity);
+        uint64_t *p = taosMemoryRealloc(pBucket->pKeys, sizeof(uint64_t) * capacity);
+        if (p == NULL) {
+          return TSDB_CODE_OUT_OF_MEMORY;
+        }
+
+        pBucket->pKeys = p;
+        pBucket->capacity = capacity;
+      } else {
+        int32_t code = spillKeys(pBucket);
+        if (code != TSDB_CODE_SUCCESS) {
+          return code;
+        }
+      }
+    }
+
+    int32_t n = (int32_t)TMIN(num - offset, pBucket->capacity - pBucket->numOfKeys);
+    memcpy(pBucket->pKeys + pBucket->numOfKeys, pKeys + offset, n * sizeof(uint64_t));
+    pBucket->numOfKeys += n;
+    offset += n;
   }
 
-  pBucket->elemPerPage = (pBucket->bufPageSize - sizeof(SFilePage)) / pBucket->bytes;
-  pBucket->comparFn = getKeyComparFunc(pBucket->type, TSDB_ORDER_ASC);
+  pBucket->total += num;
+  return TSDB_CODE_SUCCESS;
+}
 
-  pBucket->hashFunc = getHashFunc(pBucket->type);
-  if (pBucket->hashFunc == NULL) {
-    //    qError("MemBucket:%p, not support data type %d, failed", pBucket, pBucket->type);
-    taosMemoryFree(pBucket);
+tMemBucket *tMemBucketCreate(int16_t nElemSize, int16_t dataType) {
+  if (!IS_NUMERIC_TYPE(dataType)) {
+    terrno = TSDB_CODE_FUNC_FUNTION_PARA_TYPE;
     return NULL;
   }
 
-  pBucket->pSlots = (tMemBucketSlot *)taosMemoryCalloc(pBucket->numOfSlots, sizeof(tMemBucketSlot));
-  if (pBucket->pSlots == NULL) {
-    taosMemoryFree(pBucket);
+  tMemBucket *pBucket = (tMemBucket *)taosMemoryCalloc(1, sizeof(tMemBucket));
+  if (pBucket == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
     return NULL;
   }
 
-  resetSlotInfo(pBucket);
+  pBucket->bufPageSize = 16384 * 4;  // 64k per page
+  pBucket->type = dataType;
+  pBucket->bytes = nElemSize;
+  pBucket->total = 0;
 
-  if (!osTempSpaceAvailable()) {
-    terrno = TSDB_CODE_NO_AVAIL_DISK;
-    // qError("MemBucket create disk based Buf failed since %s", terrstr(terrno));
-    tMemBucketDestroy(pBucket);
-    return NULL;
-  }
+  pBucket->maxCapacity = PERCENTILE_MAX_CAPACITY;
+  pBucket->elemPerPage = (pBucket->bufPageSize - sizeof(SFilePage)) / sizeof(uint64_t);
 
-  int32_t ret = createDiskbasedBuf(&pBucket->pBuffer, pBucket->bufPageSize, pBucket->bufPageSize * 512, "1", tsTempDir);
-  if (ret != 0) {
-    tMemBucketDestroy(pBucket);
+  pBucket->capacity = PERCENTILE_INIT_CAPACITY;
+  pBucket->pKeys = taosMemoryMalloc(sizeof(uint64_t) * pBucket->capacity);
+  if (pBucket->pKeys == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    taosMemoryFree(pBucket);
     return NULL;
   }
 
-  //  qDebug("MemBucket:%p, elem size:%d", pBucket, pBucket->bytes);
   return pBucket;
 }
 
@@ -283,286 +318,273 @@ void tMemBucketDestroy(tMemBucket *pBucket) {
     return;
   }
 
-  void *p = taosHashIterate(pBucket->groupPagesMap, NULL);
-  while (p) {
-    SArray **p1 = p;
-    p = taosHashIterate(pBucket->groupPagesMap, p);
-    taosArrayDestroy(*p1);
+  for (int32_t i = 0; i < PERCENTILE_NUM_OF_SLOT; ++i) {
+    taosArrayDestroy(pBucket->pSlots[i].pPageIdList);
   }
 
   destroyDiskbasedBuf(pBucket->pBuffer);
-  taosMemoryFreeClear(pBucket->pSlots);
-  taosHashCleanup(pBucket->groupPagesMap);
+  taosMemoryFreeClear(pBucket->pKeys);
   taosMemoryFreeClear(pBucket);
 }
 
-void tMemBucketUpdateBoundingBox(MinMaxEntry *r, const char *data, int32_t dataType) {
-  if (IS_SIGNED_NUMERIC_TYPE(dataType)) {
-    int64_t v = 0;
-    GET_TYPED_DATA(v, int64_t, dataType, data);
-
-    if (r->i64MinVal > v) {
-      r->i64MinVal = v;
-    }
-
-    if (r->i64MaxVal < v) {
-      r->i64MaxVal = v;
-    }
-  } else if (IS_UNSIGNED_NUMERIC_TYPE(dataType)) {
-    uint64_t v = 0;
-    GET_TYPED_DATA(v, uint64_t, dataType, data);
-
-    if (r->i64MinVal > v) {
-      r->i64MinVal = v;
-    }
-
-    if (r->i64MaxVal < v) {
-      r->i64MaxVal = v;
-    }
-  } else if (IS_FLOAT_TYPE(dataType)) {
-    double v = 0;
-    GET_TYPED_DATA(v, double, dataType, data);
+/*
+ * in memory bucket, we only accept data array list
+ */
+int32_t tMemBucketPut(tMemBucket *pBucket, const void *data, size_t size) {
+  ASSERT(pBucket != NULL && data != NULL && size > 0);
 
-    if (r->dMinVal > v) {
-      r->dMinVal = v;
+  uint64_t keys[PERCENTILE_SORT_THRESHOLD];
+  for (size_t i = 0; i < size; i += PERCENTILE_SORT_THRESHOLD) {
+    int32_t n = (int32_t)TMIN(size - i, PERCENTILE_SORT_THRESHOLD);
+    for (int32_t j = 0; j < n; ++j) {
+      keys[j] = encodeKey(pBucket->type, (const char *)data + (i + j) * pBucket->bytes);
     }
 
-    if (r->dMaxVal < v) {
-      r->dMaxVal = v;
+    int32_t code = putKeys(pBucket, keys, n);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
     }
-  } else {
-    assert(0);
   }
+
+  return TSDB_CODE_SUCCESS;
 }
 
+static int32_t selectFromSlots(tMemBucket *pBucket, tMemBucketSlot *pSlots, int32_t shift, const int64_t *pRanks,
+                               int32_t numOfRanks, int64_t base, uint64_t *pResult);
+
 /*
- * in memory bucket, we only accept data array list
+ * select the keys from one slot on disk: load it into memory if it is small enough, otherwise split the slot by the
+ * next digit, only the sub-slots that contain a required rank are written back to disk.
  */
-int32_t tMemBucketPut(tMemBucket *pBucket, const void *data, size_t size) {
-  assert(pBucket != NULL && data != NULL && size > 0);
-
-  int32_t count = 0;
-  int32_t bytes = pBucket->bytes;
-  for (int32_t i = 0; i < size; ++i) {
-    char   *d = (char *)data + i * bytes;
-    int32_t index = (pBucket->hashFunc)(pBucket, d);
-    if (index < 0) {
-      continue;
+static int32_t selectFromSlot(tMemBucket *pBucket, tMemBucketSlot *pSlot, int32_t shift, const int64_t *pRanks,
+                              int32_t numOfRanks, int64_t base, uint64_t *pResult) {
+  SArray *pIdList = pSlot->pPageIdList;
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  if (pSlot->size <= pBucket->maxCapacity || shift < 0) {
+    int64_t   num = (shift < 0) ? 1 : pSlot->size;
+    uint64_t *pKeys = taosMemoryMalloc(sizeof(uint64_t) * num * 2);
+    if (pKeys == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
     }
 
-    count += 1;
-
-    tMemBucketSlot *pSlot = &pBucket->pSlots[index];
-    tMemBucketUpdateBoundingBox(&pSlot->range, d, pBucket->type);
-
-    // ensure available memory pages to allocate
-    int32_t groupId = getGroupId(pBucket->numOfSlots, index, pBucket->times);
-    int32_t pageId = -1;
-
-    if (pSlot->info.data == NULL || pSlot->info.data->num >= pBucket->elemPerPage) {
-      if (pSlot->info.data != NULL) {
-        assert(pSlot->info.data->num >= pBucket->elemPerPage && pSlot->info.size > 0);
-
-        // keep the pointer in memory
-        setBufPageDirty(pSlot->info.data, true);
-        releaseBufPage(pBucket->pBuffer, pSlot->info.data);
-        pSlot->info.data = NULL;
-      }
-
-      SArray *pPageIdList;
-      void *p = taosHashGet(pBucket->groupPagesMap, &groupId, sizeof(groupId));
-      if (p == NULL) {
-        pPageIdList = taosArrayInit(4, sizeof(int32_t));
-        taosHashPut(pBucket->groupPagesMap, &groupId, sizeof(groupId), &pPageIdList, POINTER_BYTES);
-      } else {
-        pPageIdList = *(SArray **)p;
+    int64_t offset = 0;
+    for (int32_t i = 0; i < taosArrayGetSize(pIdList) && offset < num; ++i) {
+      SFilePage *pPage = getBufPage(pBucket->pBuffer, *(int32_t *)taosArrayGet(pIdList, i));
+      if (pPage == NULL) {
+        taosMemoryFree(pKeys);
+        return terrno;
       }
 
-      pSlot->info.data = getNewBufPage(pBucket->pBuffer, &pageId);
-      pSlot->info.pageId = pageId;
-      taosArrayPush(pPageIdList, &pageId);
+      int64_t n = TMIN(pPage->num, num - offset);
+      memcpy(pKeys + offset, pPage->data, n * sizeof(uint64_t));
+      releaseBufPage(pBucket->pBuffer, pPage);
+      offset += n;
     }
 
-    memcpy(pSlot->info.data->data + pSlot->info.data->num * pBucket->bytes, d, pBucket->bytes);
-
-    pSlot->info.data->num += 1;
-    pSlot->info.size += 1;
+    radixSelect(pKeys, pKeys + num, num, shift, pRanks, numOfRanks, (shift < 0) ? pRanks[0] : base, pResult);
+    taosMemoryFree(pKeys);
+    return TSDB_CODE_SUCCESS;
   }
 
-  pBucket->total += count;
-  return 0;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////
-/*
- *
- * now, we need to find the minimum value of the next slot for
- * interpolating the percentile value
- * j is the last slot of current segment, we need to get the first
- * slot of the next segment.
- */
-static MinMaxEntry getMinMaxEntryOfNextSlotWithData(tMemBucket *pMemBucket, int32_t slotIdx) {
-  int32_t j = slotIdx + 1;
-  while (j < pMemBucket->numOfSlots && (pMemBucket->pSlots[j].info.size == 0)) {
-    ++j;
+  tMemBucketSlot *pSubSlots = taosMemoryCalloc(PERCENTILE_NUM_OF_SLOT, sizeof(tMemBucketSlot));
+  uint64_t       *pTmp = taosMemoryMalloc(sizeof(uint64_t) * pBucket->elemPerPage * 2);
+  if (pSubSlots == NULL || pTmp == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _end;
   }
 
-  assert(j < pMemBucket->numOfSlots);
-  return pMemBucket->pSlots[j].range;
-}
-
-static bool isIdenticalData(tMemBucket *pMemBucket, int32_t index);
-
-static double getIdenticalDataVal(tMemBucket *pMemBucket, int32_t slotIndex) {
-  assert(isIdenticalData(pMemBucket, slotIndex));
-
-  tMemBucketSlot *pSlot = &pMemBucket->pSlots[slotIndex];
+  // the first round only counts the keys of each digit to find out the sub-slots that are required
+  int64_t count[PERCENTILE_NUM_OF_SLOT] = {0};
+  for (int32_t i = 0; i < taosArrayGetSize(pIdList); ++i) {
+    SFilePage *pPage = getBufPage(pBucket->pBuffer, *(int32_t *)taosArrayGet(pIdList, i));
+    if (pPage == NULL) {
+      code = terrno;
+      goto _end;
+    }
 
-  double finalResult = 0.0;
-  if (IS_SIGNED_NUMERIC_TYPE(pMemBucket->type)) {
-    finalResult = (double)pSlot->range.i64MinVal;
-  } else if (IS_UNSIGNED_NUMERIC_TYPE(pMemBucket->type)) {
-    finalResult = (double)pSlot->range.u64MinVal;
-  } else {
-    finalResult = (double)pSlot->range.dMinVal;
+    const uint64_t *pKeys = (const uint64_t *)pPage->data;
+    for (int32_t j = 0; j < pPage->num; ++j) {
+      count[PERCENTILE_DIGIT(pKeys[j], shift)] += 1;
+    }
+    releaseBufPage(pBucket->pBuffer, pPage);
   }
 
-  return finalResult;
-}
-
-double getPercentileImpl(tMemBucket *pMemBucket, int32_t count, double fraction) {
-  int32_t num = 0;
-
-  for (int32_t i = 0; i < pMemBucket->numOfSlots; ++i) {
-    tMemBucketSlot *pSlot = &pMemBucket->pSlots[i];
-    if (pSlot->info.size == 0) {
-      continue;
+  bool    required[PERCENTILE_NUM_OF_SLOT] = {0};
+  int64_t offset = 0;
+  int32_t r = 0;
+  for (int32_t i = 0; i < PERCENTILE_NUM_OF_SLOT; ++i) {
+    while (r < numOfRanks && pRanks[r] - base < offset + count[i]) {
+      required[i] = true;
+      ++r;
     }
+    offset += count[i];
+  }
 
-    // required value in current slot
-    if (num < (count + 1) && num + pSlot->info.size >= (count + 1)) {
-      if (pSlot->info.size + num == (count + 1)) {
-        /*
-         * now, we need to find the minimum value of the next slot for interpolating the percentile value
-         * j is the last slot of current segment, we need to get the first slot of the next segment.
-         */
-        MinMaxEntry next = getMinMaxEntryOfNextSlotWithData(pMemBucket, i);
-
-        double maxOfThisSlot = 0;
-        double minOfNextSlot = 0;
-        if (IS_SIGNED_NUMERIC_TYPE(pMemBucket->type)) {
-          maxOfThisSlot = (double)pSlot->range.i64MaxVal;
-          minOfNextSlot = (double)next.i64MinVal;
-        } else if (IS_UNSIGNED_NUMERIC_TYPE(pMemBucket->type)) {
-          maxOfThisSlot = (double)pSlot->range.u64MaxVal;
-          minOfNextSlot = (double)next.u64MinVal;
-        } else {
-          maxOfThisSlot = (double)pSlot->range.dMaxVal;
-          minOfNextSlot = (double)next.dMinVal;
-        }
+  int32_t digit = -1;
+  for (int32_t i = 0; i < PERCENTILE_NUM_OF_SLOT; ++i) {
+    if (count[i] == pSlot->size) {
+      digit = i;
+    }
+  }
 
-        assert(minOfNextSlot > maxOfThisSlot);
+  // all keys share the same digit, refine the same slot by the next digit
+  if (digit >= 0) {
+    code = selectFromSlot(pBucket, pSlot, shift - PERCENTILE_RADIX_BITS, pRanks, numOfRanks, base, pResult);
+    goto _end;
+  }
 
-        double val = (1 - fraction) * maxOfThisSlot + fraction * minOfNextSlot;
-        return val;
-      }
+  for (int32_t i = 0; i < taosArrayGetSize(pIdList); ++i) {
+    SFilePage *pPage = getBufPage(pBucket->pBuffer, *(int32_t *)taosArrayGet(pIdList, i));
+    if (pPage == NULL) {
+      code = terrno;
+      goto _end;
+    }
 
-      if (pSlot->info.size <= pMemBucket->maxCapacity) {
-        // data in buffer and file are merged together to be processed.
-        SFilePage *buffer = loadDataFromFilePage(pMemBucket, i);
-        int32_t    currentIdx = count - num;
+    // copy the keys out, so that the page is released before the sub-slot pages are allocated
+    int32_t   num = pPage->num;
+    uint64_t *pKeys = pTmp + pBucket->elemPerPage;
+    memcpy(pKeys, pPage->data, sizeof(uint64_t) * num);
+    releaseBufPage(pBucket->pBuffer, pPage);
 
-        char *thisVal = buffer->data + pMemBucket->bytes * currentIdx;
-        char *nextVal = thisVal + pMemBucket->bytes;
+    code = partitionKeysToSlots(pBucket, pSubSlots, pKeys, num, shift, required, pTmp);
+    if (code != TSDB_CODE_SUCCESS) {
+      goto _end;
+    }
+  }
 
-        double td = 1.0, nd = 1.0;
-        GET_TYPED_DATA(td, double, pMemBucket->type, thisVal);
-        GET_TYPED_DATA(nd, double, pMemBucket->type, nextVal);
+  // the sizes of the skipped sub-slots are needed to locate the ranks
+  for (int32_t i = 0; i < PERCENTILE_NUM_OF_SLOT; ++i) {
+    pSubSlots[i].size = count[i];
+  }
 
-        double val = (1 - fraction) * td + fraction * nd;
-        taosMemoryFreeClear(buffer);
+  code = selectFromSlots(pBucket, pSubSlots, shift - PERCENTILE_RADIX_BITS, pRanks, numOfRanks, base, pResult);
 
-        return val;
-      } else {  // incur a second round bucket split
-        if (isIdenticalData(pMemBucket, i)) {
-          return getIdenticalDataVal(pMemBucket, i);
-        }
+_end:
+  if (pSubSlots != NULL) {
+    for (int32_t i = 0; i < PERCENTILE_NUM_OF_SLOT; ++i) {
+      taosArrayDestroy(pSubSlots[i].pPageIdList);
+    }
+  }
+  taosMemoryFree(pSubSlots);
+  taosMemoryFree(pTmp);
+  return code;
+}
 
-        // try next round
-        pMemBucket->times += 1;
-        //       qDebug("MemBucket:%p, start next round data bucketing, time:%d", pMemBucket, pMemBucket->times);
+static int32_t selectFromSlots(tMemBucket *pBucket, tMemBucketSlot *pSlots, int32_t shift, const int64_t *pRanks,
+                               int32_t numOfRanks, int64_t base, uint64_t *pResult) {
+  int64_t offset = base;
+  int32_t r = 0;
+  for (int32_t i = 0; i < PERCENTILE_NUM_OF_SLOT && r < numOfRanks; ++i) {
+    int32_t start = r;
+    while (r < numOfRanks && pRanks[r] < offset + pSlots[i].size) {
+      ++r;
+    }
 
-        pMemBucket->range = pSlot->range;
-        pMemBucket->total = 0;
+    if (r > start) {
+      int32_t code = selectFromSlot(pBucket, &pSlots[i], shift, pRanks + start, r - start, offset, pResult + start);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
 
-        resetSlotInfo(pMemBucket);
+    offset += pSlots[i].size;
+  }
 
-        int32_t groupId = getGroupId(pMemBucket->numOfSlots, i, pMemBucket->times - 1);
-        SArray* list = *(SArray **)taosHashGet(pMemBucket->groupPagesMap, &groupId, sizeof(groupId));
-        ASSERT(list != NULL && list->size > 0);
+  return TSDB_CODE_SUCCESS;
+}
 
-        for (int32_t f = 0; f < list->size; ++f) {
-          int32_t *pageId = taosArrayGet(list, f);
-          SFilePage *pg = getBufPage(pMemBucket->pBuffer, *pageId);
+/*
+ * the ranks are in ascending order, the selected keys are returned in the same order
+ */
+static int32_t selectKeys(tMemBucket *pBucket, const int64_t *pRanks, int32_t numOfRanks, uint64_t *pResult) {
+  if (pBucket->pBuffer == NULL) {
+    uint64_t *pTmp = taosMemoryMalloc(sizeof(uint64_t) * pBucket->numOfKeys);
+    if (pTmp == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
 
-          tMemBucketPut(pMemBucket, pg->data, (int32_t)pg->num);
-          setBufPageDirty(pg, true);
-          releaseBufPage(pMemBucket->pBuffer, pg);
-        }
+    radixSelect(pBucket->pKeys, pTmp, pBucket->numOfKeys, PERCENTILE_TOP_SHIFT, pRanks, numOfRanks, 0, pResult);
+    taosMemoryFree(pTmp);
+    return TSDB_CODE_SUCCESS;
+  }
 
-        return getPercentileImpl(pMemBucket, count - num, fraction);
-      }
-    } else {
-      num += pSlot->info.size;
-    }
+  int32_t code = spillKeys(pBucket);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
   }
 
-  return 0;
+  return selectFromSlots(pBucket, pBucket->pSlots, PERCENTILE_TOP_SHIFT - PERCENTILE_RADIX_BITS, pRanks, numOfRanks,
+                         0, pResult);
 }
 
-double getPercentile(tMemBucket *pMemBucket, double percent) {
+int32_t getPercentiles(tMemBucket *pMemBucket, const double *percents, int32_t num, double *pResults) {
   if (pMemBucket->total == 0) {
-    return 0.0;
+    for (int32_t i = 0; i < num; ++i) {
+      pResults[i] = 0.0;
+    }
+    return TSDB_CODE_SUCCESS;
   }
 
-  // if only one elements exists, return it
-  if (pMemBucket->total == 1) {
-    return findOnlyResult(pMemBucket);
+  // each percentile is interpolated between the keys at two adjacent ranks
+  int32_t   numOfRanks = num * 2;
+  int64_t  *pRanks = taosMemoryMalloc(sizeof(int64_t) * numOfRanks);
+  uint64_t *pKeys = taosMemoryMalloc(sizeof(uint64_t) * numOfRanks);
+  if (pRanks == NULL || pKeys == NULL) {
+    taosMemoryFree(pRanks);
+    taosMemoryFree(pKeys);
+    return TSDB_CODE_OUT_OF_MEMORY;
   }
 
-  percent = fabs(percent);
+  for (int32_t i = 0; i < num; ++i) {
+    double  percentVal = (fabs(percents[i]) * (pMemBucket->total - 1)) / ((double)100.0);
+    int64_t orderIdx = TMIN((int64_t)percentVal, pMemBucket->total - 1);
 
-  // find the min/max value, no need to scan all data in bucket
-  if (fabs(percent - 100.0) < DBL_EPSILON || (percent < DBL_EPSILON)) {
-    MinMaxEntry *pRange = &pMemBucket->range;
+    pRanks[i * 2] = orderIdx;
+    pRanks[i * 2 + 1] = TMIN(orderIdx + 1, pMemBucket->total - 1);
+  }
 
-    if (IS_SIGNED_NUMERIC_TYPE(pMemBucket->type)) {
-      double v = (double)(fabs(percent - 100) < DBL_EPSILON ? pRange->i64MaxVal : pRange->i64MinVal);
-      return v;
-    } else if (IS_UNSIGNED_NUMERIC_TYPE(pMemBucket->type)) {
-      double v = (double)(fabs(percent - 100) < DBL_EPSILON ? pRange->u64MaxVal : pRange->u64MinVal);
-      return v;
-    } else {
-      return fabs(percent - 100) < DBL_EPSILON ? pRange->dMaxVal : pRange->dMinVal;
-    }
+  int64_t *pSorted = taosMemoryMalloc(sizeof(int64_t) * numOfRanks);
+  if (pSorted == NULL) {
+    taosMemoryFree(pRanks);
+    taosMemoryFree(pKeys);
+    return TSDB_CODE_OUT_OF_MEMORY;
   }
 
-  double percentVal = (percent * (pMemBucket->total - 1)) / ((double)100.0);
+  memcpy(pSorted, pRanks, sizeof(int64_t) * numOfRanks);
+  taosSort(pSorted, numOfRanks, sizeof(int64_t), compareInt64Val);
+
+  int32_t code = selectKeys(pMemBucket, pSorted, numOfRanks, pKeys);
+  if (code == TSDB_CODE_SUCCESS) {
+    for (int32_t i = 0; i < num; ++i) {
+      double  percentVal = (fabs(percents[i]) * (pMemBucket->total - 1)) / ((double)100.0);
+      int64_t orderIdx = pRanks[i * 2];
+      double  fraction = percentVal - orderIdx;
+
+      int64_t *p = taosbsearch(&pRanks[i * 2], pSorted, numOfRanks, sizeof(int64_t), compareInt64Val, TD_EQ);
+      double   td = decodeKey(pMemBucket->type, pKeys[p - pSorted]);
+      if (fraction < DBL_EPSILON || pRanks[i * 2 + 1] == orderIdx) {
+        pResults[i] = td;
+        continue;
+      }
 
-  // do put data by using buckets
-  int32_t orderIdx = (int32_t)percentVal;
-  return getPercentileImpl(pMemBucket, orderIdx, percentVal - orderIdx);
-}
+      p = taosbsearch(&pRanks[i * 2 + 1], pSorted, numOfRanks, sizeof(int64_t), compareInt64Val, TD_EQ);
+      double nd = decodeKey(pMemBucket->type, pKeys[p - pSorted]);
+      pResults[i] = (1 - fraction) * td + fraction * nd;
+    }
+  }
 
-/*
- * check if data in one slot are all identical only need to compare with the bounding box
- */
-bool isIdenticalData(tMemBucket *pMemBucket, int32_t index) {
-  tMemBucketSlot *pSeg = &pMemBucket->pSlots[index];
+  taosMemoryFree(pSorted);
+  taosMemoryFree(pRanks);
+  taosMemoryFree(pKeys);
+  return code;
+}
 
-  if (IS_FLOAT_TYPE(pMemBucket->type)) {
-    return fabs(pSeg->range.dMaxVal - pSeg->range.dMinVal) < DBL_EPSILON;
-  } else {
-    return pSeg->range.i64MinVal == pSeg->range.i64MaxVal;
+double getPercentile(tMemBucket *pMemBucket, double percent) {
+  double v = 0.0;
+  if (getPercentiles(pMemBucket, &percent, 1, &v) != TSDB_CODE_SUCCESS) {
+    return 0.0;
   }
+
+  return v;
 }
@@ -380,6 +380,12 @@ typedef struct SUdfcUvSession {
   int32_t bufSize;
 
   char udfName[TSDB_FUNC_NAME_LEN + 1];
+
+  TdShmPtr    shm;
+  int8_t      shmAttached;
+  SUdfShmRing reqRing;
+  char       *rspRingData;
+  int64_t     rspRingSize;
 } SUdfcUvSession;
 
 typedef struct SClientUvTaskNode {
@@ -448,10 +454,12 @@ enum {
 int32_t getUdfdPipeName(char *pipeName, int32_t size);
 int32_t encodeUdfSetupRequest(void **buf, const SUdfSetupRequest *setup);
 void   *decodeUdfSetupRequest(const void *buf, SUdfSetupRequest *request);
+int32_t encodeUdfShmMsg(void **buf, const SUdfShmMsg *shmMsg);
+void   *decodeUdfShmMsg(const void *buf, SUdfShmMsg *shmMsg);
 int32_t encodeUdfInterBuf(void **buf, const SUdfInterBuf *state);
 void   *decodeUdfInterBuf(const void *buf, SUdfInterBuf *state);
-int32_t encodeUdfCallRequest(void **buf, const SUdfCallRequest *call);
-void   *decodeUdfCallRequest(const void *buf, SUdfCallRequest *call);
+int32_t encodeUdfCallRequest(void **buf, const SUdfCallRequest *call, bool inShm);
+void   *decodeUdfCallRequest(const void *buf, SUdfCallRequest *call, bool inShm);
 int32_t encodeUdfTeardownRequest(void **buf, const SUdfTeardownRequest *teardown);
 void   *decodeUdfTeardownRequest(const void *buf, SUdfTeardownRequest *teardown);
 int32_t encodeUdfRequest(void **buf, const SUdfRequest *request);
@@ -491,14 +499,148 @@ int32_t getUdfdPipeName(char *pipeName, int32_t size) {
   return 0;
 }
 
+typedef struct SUdfShmFrame {
+  int32_t state;
+  int32_t len;  // length of the whole frame, including this header
+} SUdfShmFrame;
+
+enum { UDF_SHM_FRAME_FREE = 0, UDF_SHM_FRAME_USED = 1 };
+
+#define UDF_SHM_FRAME(data, offset) ((SUdfShmFrame *)((data) + (offset)))
+#define UDF_SHM_ALIGN(len)          (((len) + 7) & ~((int64_t)7))
+
+int32_t udfShmRingInit(SUdfShmRing *ring, char *data, int64_t size) {
+  ring->data = data;
+  ring->size = size;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->used = 0;
+  return uv_mutex_init(&ring->mutex);
+}
+
+void udfShmRingDestroy(SUdfShmRing *ring) {
+  if (ring->data != NULL) {
+    uv_mutex_destroy(&ring->mutex);
+    ring->data = NULL;
+  }
+}
+
+static void udfShmRingReclaim(SUdfShmRing *ring) {
+  while (ring->used > 0) {
+    SUdfShmFrame *pFrame = UDF_SHM_FRAME(ring->data, ring->head);
+    if (atomic_load_32(&pFrame->state) != UDF_SHM_FRAME_FREE) {
+      break;
+    }
+
+    ring->used -= pFrame->len;
+    ring->head += pFrame->len;
+    if (ring->head == ring->size) {
+      ring->head = 0;
+    }
+  }
+
+  if (ring->used == 0) {
+    ring->head = 0;
+    ring->tail = 0;
+  }
+}
+
+/*
+ * allocate a frame for a message of len bytes, returns NULL if there is no room now and the caller falls back to pipe
+ */
+char *udfShmRingAlloc(SUdfShmRing *ring, int32_t len, int64_t *pOffset) {
+  if (ring->data == NULL) {
+    return NULL;
+  }
+
+  int64_t need = UDF_SHM_ALIGN(sizeof(SUdfShmFrame) + len);
+  int64_t offset = -1;
+  char   *payload = NULL;
+
+  uv_mutex_lock(&ring->mutex);
+  udfShmRingReclaim(ring);
+
+  if (ring->used == 0) {
+    offset = (ring->size >= need) ? 0 : -1;
+  } else if (ring->tail > ring->head) {
+    if (ring->size - ring->tail >= need) {
+      offset = ring->tail;
+    } else if (ring->head >= need) {
+      // pad the rest of the ring with a released frame, so that the reclaim goes back to the beginning
+      if (ring->tail < ring->size) {
+        SUdfShmFrame *pPad = UDF_SHM_FRAME(ring->data, ring->tail);
+        pPad->len = (int32_t)(ring->size - ring->tail);
+        atomic_store_32(&pPad->state, UDF_SHM_FRAME_FREE);
+        ring->used += pPad->len;
+      }
+      offset = 0;
+    }
+  } else if (ring->head - ring->tail >= need) {
+    offset = ring->tail;
+  }
+
+  if (offset >= 0) {
+    SUdfShmFrame *pFrame = UDF_SHM_FRAME(ring->data, offset);
+    pFrame->len = (int32_t)need;
+    atomic_store_32(&pFrame->state, UDF_SHM_FRAME_USED);
+
+    ring->tail = offset + need;
+    ring->used += need;
+    *pOffset = offset;
+    payload = (char *)(pFrame + 1);
+  }
+  uv_mutex_unlock(&ring->mutex);
+
+  return payload;
+}
+
+/*
+ * the frame is written by the other process, check it before use
+ */
+char *udfShmRingGetFrame(char *data, int64_t size, const SUdfShmMsg *pMsg) {
+  if (data == NULL || pMsg->offset < 0 || pMsg->len < 0 || pMsg->offset % 8 != 0 ||
+      pMsg->offset + (int64_t)sizeof(SUdfShmFrame) + pMsg->len > size) {
+    return NULL;
+  }
+
+  SUdfShmFrame *pFrame = UDF_SHM_FRAME(data, pMsg->offset);
+  if (atomic_load_32(&pFrame->state) != UDF_SHM_FRAME_USED || pFrame->len < (int64_t)sizeof(SUdfShmFrame) + pMsg->len) {
+    return NULL;
+  }
+
+  return (char *)(pFrame + 1);
+}
+
+void udfShmRingRelease(char *data, int64_t offset) {
+  SUdfShmFrame *pFrame = UDF_SHM_FRAME(data, offset);
+  atomic_store_32(&pFrame->state, UDF_SHM_FRAME_FREE);
+}
+
 int32_t encodeUdfSetupRequest(void **buf, const SUdfSetupRequest *setup) {
   int32_t len = 0;
   len += taosEncodeBinary(buf, setup->udfName, TSDB_FUNC_NAME_LEN);
+  len += taosEncodeBinary(buf, setup->shmName, TD_SHM_NAME_LEN);
+  len += taosEncodeFixedI64(buf, setup->shmSize);
   return len;
 }
 
 void *decodeUdfSetupRequest(const void *buf, SUdfSetupRequest *request) {
   buf = taosDecodeBinaryTo(buf, request->udfName, TSDB_FUNC_NAME_LEN);
+  buf = taosDecodeBinaryTo(buf, request->shmName, TD_SHM_NAME_LEN);
+  buf = taosDecodeFixedI64(buf, &request->shmSize);
+  return (void *)buf;
+}
+
+int32_t encodeUdfShmMsg(void **buf, const SUdfShmMsg *shmMsg) {
+  int32_t len = 0;
+  len += taosEncodeFixedI64(buf, shmMsg->offset);
+  len += taosEncodeFixedI32(buf, shmMsg->len);
+  return len;
+}
+
+void *decodeUdfShmMsg(const void *buf, SUdfShmMsg *shmMsg) {
+  buf = taosDecodeFixedI64(buf, &shmMsg->offset);
+  buf = taosDecodeFixedI32(buf, &shmMsg->len);
   return (void *)buf;
 }
 
@@ -517,46 +659,168 @@ void *decodeUdfInterBuf(const void *buf, SUdfInterBuf *state) {
   return (void *)buf;
 }
 
-int32_t encodeUdfCallRequest(void **buf, const SUdfCallRequest *call) {
+/*
+ * The buffers of a request in the shared memory are aligned to 8 bytes, so that udfd maps the data blocks and the
+ * inter bufs in place instead of copying them out of the frame. The padding depends on where the buffer is written,
+ * the length computed without a buffer counts the largest padding.
+ */
+#define UDF_SHM_BUF_PAD(ptr) ((8 - ((uintptr_t)(ptr)&7)) & 7)
+
+static int32_t encodeUdfShmBuf(void **buf, const void *value, int32_t valueLen) {
+  int32_t len = taosEncodeFixedI32(buf, valueLen);
+  if (buf == NULL) {
+    return len + 7 + valueLen;
+  }
+
+  int32_t pad = UDF_SHM_BUF_PAD(*buf);
+  memset(*buf, 0, pad);
+  *buf = POINTER_SHIFT(*buf, pad);
+  if (valueLen > 0) {
+    memcpy(*buf, value, valueLen);
+    *buf = POINTER_SHIFT(*buf, valueLen);
+  }
+  return len + pad + valueLen;
+}
+
+static void *decodeUdfShmBuf(const void *buf, void **value, int32_t *valueLen) {
+  buf = taosDecodeFixedI32(buf, valueLen);
+  buf = POINTER_SHIFT(buf, UDF_SHM_BUF_PAD(buf));
+  *value = (*valueLen > 0) ? (void *)buf : NULL;
+  return POINTER_SHIFT(buf, *valueLen);
+}
+
+static int32_t encodeUdfShmDataBlock(void **buf, const SSDataBlock *pBlock) {
+  int32_t rows = pBlock->info.rows;
+  int32_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
+
+  int32_t len = 0;
+  len += taosEncodeFixedI32(buf, rows);
+  len += taosEncodeFixedI32(buf, numOfCols);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData *pColData = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, i);
+    len += taosEncodeFixedI16(buf, pColData->info.type);
+    len += taosEncodeFixedI32(buf, pColData->info.bytes);
+    len += taosEncodeFixedU8(buf, pColData->info.precision);
+    len += taosEncodeFixedU8(buf, pColData->info.scale);
+    len += taosEncodeFixedBool(buf, pColData->hasNull);
+    if (IS_VAR_DATA_TYPE(pColData->info.type)) {
+      len += encodeUdfShmBuf(buf, pColData->varmeta.offset, sizeof(int32_t) * rows);
+    } else {
+      len += encodeUdfShmBuf(buf, pColData->nullbitmap, BitmapLen(rows));
+    }
+    len += encodeUdfShmBuf(buf, pColData->pData, colDataGetLength(pColData, rows));
+  }
+  return len;
+}
+
+/*
+ * the columns point into the frame, they are valid until the frame is released and freed by freeUdfShmDataBlock
+ */
+static void *decodeUdfShmDataBlock(const void *buf, SUdfDataBlock *pBlock) {
+  buf = taosDecodeFixedI32(buf, &pBlock->numOfRows);
+  buf = taosDecodeFixedI32(buf, &pBlock->numOfCols);
+  pBlock->udfCols = taosMemoryCalloc(pBlock->numOfCols, sizeof(SUdfColumn *));
+  for (int32_t i = 0; i < pBlock->numOfCols; ++i) {
+    SUdfColumn *udfCol = taosMemoryCalloc(1, sizeof(SUdfColumn));
+    pBlock->udfCols[i] = udfCol;
+    buf = taosDecodeFixedI16(buf, &udfCol->colMeta.type);
+    buf = taosDecodeFixedI32(buf, &udfCol->colMeta.bytes);
+    buf = taosDecodeFixedU8(buf, &udfCol->colMeta.precision);
+    buf = taosDecodeFixedU8(buf, &udfCol->colMeta.scale);
+    buf = taosDecodeFixedBool(buf, &udfCol->hasNull);
+    udfCol->colData.numOfRows = pBlock->numOfRows;
+    if (IS_VAR_DATA_TYPE(udfCol->colMeta.type)) {
+      SUdfColumnData *data = &udfCol->colData;
+      buf = decodeUdfShmBuf(buf, (void **)&data->varLenCol.varOffsets, &data->varLenCol.varOffsetsLen);
+      buf = decodeUdfShmBuf(buf, (void **)&data->varLenCol.payload, &data->varLenCol.payloadLen);
+    } else {
+      SUdfColumnData *data = &udfCol->colData;
+      buf = decodeUdfShmBuf(buf, (void **)&data->fixLenCol.nullBitmap, &data->fixLenCol.nullBitmapLen);
+      buf = decodeUdfShmBuf(buf, (void **)&data->fixLenCol.data, &data->fixLenCol.dataLen);
+    }
+  }
+  return (void *)buf;
+}
+
+void freeUdfShmDataBlock(SUdfDataBlock *block) {
+  for (int32_t i = 0; i < block->numOfCols; ++i) {
+    taosMemoryFree(block->udfCols[i]);
+    block->udfCols[i] = NULL;
+  }
+  taosMemoryFree(block->udfCols);
+  block->udfCols = NULL;
+}
+
+static int32_t encodeUdfShmInterBuf(void **buf, const SUdfInterBuf *state) {
+  int32_t len = 0;
+  len += taosEncodeFixedI8(buf, state->numOfResult);
+  len += encodeUdfShmBuf(buf, state->buf, state->bufLen);
+  return len;
+}
+
+static void *decodeUdfShmInterBuf(const void *buf, SUdfInterBuf *state) {
+  buf = taosDecodeFixedI8(buf, &state->numOfResult);
+  buf = decodeUdfShmBuf(buf, (void **)&state->buf, &state->bufLen);
+  return (void *)buf;
+}
+
+static int32_t encodeUdfCallBlock(void **buf, const SSDataBlock *pBlock, bool inShm) {
+  return inShm ? encodeUdfShmDataBlock(buf, pBlock) : tEncodeDataBlock(buf, pBlock);
+}
+
+static int32_t encodeUdfCallInterBuf(void **buf, const SUdfInterBuf *state, bool inShm) {
+  return inShm ? encodeUdfShmInterBuf(buf, state) : encodeUdfInterBuf(buf, state);
+}
+
+static void *decodeUdfCallBlock(const void *buf, SUdfCallRequest *call, bool inShm) {
+  return inShm ? decodeUdfShmDataBlock(buf, &call->udfBlock) : tDecodeDataBlock(buf, &call->block);
+}
+
+static void *decodeUdfCallInterBuf(const void *buf, SUdfInterBuf *state, bool inShm) {
+  return inShm ? decodeUdfShmInterBuf(buf, state) : decodeUdfInterBuf(buf, state);
+}
+
+int32_t encodeUdfCallRequest(void **buf, const SUdfCallRequest *call, bool inShm) {
   int32_t len = 0;
   len += taosEncodeFixedI64(buf, call->udfHandle);
   len += taosEncodeFixedI8(buf, call->callType);
   if (call->callType == TSDB_UDF_CALL_SCALA_PROC) {
-    len += tEncodeDataBlock(buf, &call->block);
+    len += encodeUdfCallBlock(buf, &call->block, inShm);
   } else if (call->callType == TSDB_UDF_CALL_AGG_INIT) {
     len += taosEncodeFixedI8(buf, call->initFirst);
   } else if (call->callType == TSDB_UDF_CALL_AGG_PROC) {
-    len += tEncodeDataBlock(buf, &call->block);
-    len += encodeUdfInterBuf(buf, &call->interBuf);
+    len += encodeUdfCallBlock(buf, &call->block, inShm);
+    len += encodeUdfCallInterBuf(buf, &call->interBuf, inShm);
   } else if (call->callType == TSDB_UDF_CALL_AGG_MERGE) {
-    len += encodeUdfInterBuf(buf, &call->interBuf);
-    len += encodeUdfInterBuf(buf, &call->interBuf2);
+    len += encodeUdfCallInterBuf(buf, &call->interBuf, inShm);
+    len += encodeUdfCallInterBuf(buf, &call->interBuf2, inShm);
   } else if (call->callType == TSDB_UDF_CALL_AGG_FIN) {
-    len += encodeUdfInterBuf(buf, &call->interBuf);
+    len += encodeUdfCallInterBuf(buf, &call->interBuf, inShm);
   }
   return len;
 }
 
-void *decodeUdfCallRequest(const void *buf, SUdfCallRequest *call) {
+void *decodeUdfCallRequest(const void *buf, SUdfCallRequest *call, bool inShm) {
   buf = taosDecodeFixedI64(buf, &call->udfHandle);
   buf = taosDecodeFixedI8(buf, &call->callType);
+  call->mapped = inShm;
   switch (call->callType) {
     case TSDB_UDF_CALL_SCALA_PROC:
-      buf = tDecodeDataBlock(buf, &call->block);
+      buf = decodeUdfCallBlock(buf, call, inShm);
       break;
     case TSDB_UDF_CALL_AGG_INIT:
       buf = taosDecodeFixedI8(buf, &call->initFirst);
       break;
     case TSDB_UDF_CALL_AGG_PROC:
-      buf = tDecodeDataBlock(buf, &call->block);
-      buf = decodeUdfInterBuf(buf, &call->interBuf);
+      buf = decodeUdfCallBlock(buf, call, inShm);
+      buf = decodeUdfCallInterBuf(buf, &call->interBuf, inShm);
       break;
     case TSDB_UDF_CALL_AGG_MERGE:
-      buf = decodeUdfInterBuf(buf, &call->interBuf);
-      buf = decodeUdfInterBuf(buf, &call->interBuf2);
+      buf = decodeUdfCallInterBuf(buf, &call->interBuf, inShm);
+      buf = decodeUdfCallInterBuf(buf, &call->interBuf2, inShm);
       break;
     case TSDB_UDF_CALL_AGG_FIN:
-      buf = decodeUdfInterBuf(buf, &call->interBuf);
+      buf = decodeUdfCallInterBuf(buf, &call->interBuf, inShm);
       break;
   }
   return (void *)buf;
@@ -573,7 +837,7 @@ void *decodeUdfTeardownRequest(const void *buf, SUdfTeardownRequest *teardown) {
   return (void *)buf;
 }
 
-int32_t encodeUdfRequest(void **buf, const SUdfRequest *request) {
+static int32_t encodeUdfRequestImpl(void **buf, const SUdfRequest *request, bool inShm) {
   int32_t len = 0;
   if (buf == NULL) {
     len += sizeof(request->msgLen);
@@ -586,36 +850,90 @@ int32_t encodeUdfRequest(void **buf, const SUdfRequest *request) {
   if (request->type == UDF_TASK_SETUP) {
     len += encodeUdfSetupRequest(buf, &request->setup);
   } else if (request->type == UDF_TASK_CALL) {
-    len += encodeUdfCallRequest(buf, &request->call);
+    len += encodeUdfCallRequest(buf, &request->call, inShm);
   } else if (request->type == UDF_TASK_TEARDOWN) {
     len += encodeUdfTeardownRequest(buf, &request->teardown);
+  } else if (request->type == UDF_TASK_SHM_MSG) {
+    len += encodeUdfShmMsg(buf, &request->shmMsg);
   }
   return len;
 }
 
-void *decodeUdfRequest(const void *buf, SUdfRequest *request) {
+int32_t encodeUdfRequest(void **buf, const SUdfRequest *request) { return encodeUdfRequestImpl(buf, request, false); }
+
+int32_t encodeUdfShmRequest(void **buf, const SUdfRequest *request) { return encodeUdfRequestImpl(buf, request, true); }
+
+void *decodeUdfRequestHead(const void *buf, SUdfRequest *request) {
   request->msgLen = *(int32_t *)(buf);
   buf = POINTER_SHIFT(buf, sizeof(request->msgLen));
 
   buf = taosDecodeFixedI64(buf, &request->seqNum);
   buf = taosDecodeFixedI8(buf, &request->type);
+  return (void *)buf;
+}
+
+static void *decodeUdfRequestImpl(const void *buf, SUdfRequest *request, bool inShm) {
+  buf = decodeUdfRequestHead(buf, request);
 
   if (request->type == UDF_TASK_SETUP) {
     buf = decodeUdfSetupRequest(buf, &request->setup);
   } else if (request->type == UDF_TASK_CALL) {
-    buf = decodeUdfCallRequest(buf, &request->call);
+    buf = decodeUdfCallRequest(buf, &request->call, inShm);
   } else if (request->type == UDF_TASK_TEARDOWN) {
     buf = decodeUdfTeardownRequest(buf, &request->teardown);
+  } else if (request->type == UDF_TASK_SHM_MSG) {
+    buf = decodeUdfShmMsg(buf, &request->shmMsg);
   }
   return (void *)buf;
 }
 
+void *decodeUdfRequest(const void *buf, SUdfRequest *request) { return decodeUdfRequestImpl(buf, request, false); }
+
+void *decodeUdfShmRequest(const void *buf, SUdfRequest *request) { return decodeUdfRequestImpl(buf, request, true); }
+
+/*
+ * encode the request into a frame of the ring and the pipe message pointing to it, or the whole request into the pipe
+ * message if the ring is not attached, the request is small or the ring has no room now
+ */
+int32_t udfEncodeRequestMsg(SUdfShmRing *ring, SUdfRequest *request, uv_buf_t *pMsg) {
+  int32_t bufLen = encodeUdfRequest(NULL, request);
+  request->msgLen = bufLen;
+
+  SUdfRequest shmReq = {.seqNum = request->seqNum, .type = UDF_TASK_SHM_MSG};
+  char       *frame = NULL;
+  if (ring != NULL && bufLen >= UDF_SHM_MIN_MSG_LEN) {
+    int32_t shmLen = encodeUdfShmRequest(NULL, request);
+    frame = udfShmRingAlloc(ring, shmLen, &shmReq.shmMsg.offset);
+    if (frame != NULL) {
+      request->msgLen = shmLen;
+      void *buf = frame;
+      encodeUdfShmRequest(&buf, request);
+
+      // only the position of the frame goes through the pipe
+      shmReq.shmMsg.len = shmLen;
+      request = &shmReq;
+      bufLen = encodeUdfRequest(NULL, request);
+      request->msgLen = bufLen;
+    }
+  }
+
+  void *bufBegin = taosMemoryMalloc(bufLen);
+  if (bufBegin == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  void *buf = bufBegin;
+  encodeUdfRequest(&buf, request);
+  *pMsg = uv_buf_init(bufBegin, bufLen);
+  return TSDB_CODE_SUCCESS;
+}
+
 int32_t encodeUdfSetupResponse(void **buf, const SUdfSetupResponse *setupRsp) {
   int32_t len = 0;
   len += taosEncodeFixedI64(buf, setupRsp->udfHandle);
   len += taosEncodeFixedI8(buf, setupRsp->outputType);
   len += taosEncodeFixedI32(buf, setupRsp->outputLen);
   len += taosEncodeFixedI32(buf, setupRsp->bufSize);
+  len += taosEncodeFixedI8(buf, setupRsp->shmAttached);
   return len;
 }
 
@@ -624,6 +942,7 @@ void *decodeUdfSetupResponse(const void *buf, SUdfSetupResponse *setupRsp) {
   buf = taosDecodeFixedI8(buf, &setupRsp->outputType);
   buf = taosDecodeFixedI32(buf, &setupRsp->outputLen);
   buf = taosDecodeFixedI32(buf, &setupRsp->bufSize);
+  buf = taosDecodeFixedI8(buf, &setupRsp->shmAttached);
   return (void *)buf;
 }
 
@@ -706,6 +1025,9 @@ int32_t encodeUdfResponse(void **buf, const SUdfResponse *rsp) {
     case UDF_TASK_TEARDOWN:
       len += encodeUdfTeardownResponse(buf, &rsp->teardownRsp);
       break;
+    case UDF_TASK_SHM_MSG:
+      len += encodeUdfShmMsg(buf, &rsp->shmMsg);
+      break;
     default:
       fnError("encode udf response, invalid udf response type %d", rsp->type);
       break;
@@ -732,6 +1054,9 @@ void *decodeUdfResponse(const void *buf, SUdfResponse *rsp) {
     case UDF_TASK_TEARDOWN:
       buf = decodeUdfTeardownResponse(buf, &rsp->teardownRsp);
       break;
+    case UDF_TASK_SHM_MSG:
+      buf = decodeUdfShmMsg(buf, &rsp->shmMsg);
+      break;
     default:
       fnError("decode udf response, invalid udf response type %d", rsp->type);
       break;
@@ -1218,6 +1543,26 @@ void onUdfcPipeClose(uv_handle_t *handle) {
   taosMemoryFree((uv_pipe_t *)handle);
 }
 
+static void udfcDecodeShmResponse(SUdfcUvSession *session, SUdfResponse *rsp) {
+  SUdfShmMsg shmMsg = rsp->shmMsg;
+  char      *frame = udfShmRingGetFrame(session->rspRingData, session->rspRingSize, &shmMsg);
+  if (frame == NULL) {
+    fnError("udfc invalid response frame in shared memory. offset: %" PRId64 ", len: %d", shmMsg.offset, shmMsg.len);
+    int64_t seqNum = rsp->seqNum;
+    memset(rsp, 0, sizeof(SUdfResponse));
+    rsp->seqNum = seqNum;
+    rsp->type = UDF_TASK_SHM_MSG;
+    rsp->code = TSDB_CODE_UDF_PIPE_READ_ERR;
+    return;
+  }
+
+  void *buf = decodeUdfResponse(frame, rsp);
+  if (POINTER_DISTANCE(buf, frame) != shmMsg.len) {
+    fnError("udfc response length mismatch in shared memory. expected: %d", shmMsg.len);
+  }
+  udfShmRingRelease(session->rspRingData, shmMsg.offset);
+}
+
 int32_t udfcGetUdfTaskResultFromUvTask(SClientUdfTask *task, SClientUvTaskNode *uvTask) {
   fnDebug("udfc get uv task result. task: %p, uvTask: %p", task, uvTask);
   if (uvTask->type == UV_TASK_REQ_RSP) {
@@ -1225,6 +1570,9 @@ int32_t udfcGetUdfTaskResultFromUvTask(SClientUdfTask *task, SClientUvTaskNode *
       SUdfResponse rsp = {0};
       void        *buf = decodeUdfResponse(uvTask->rspBuf.base, &rsp);
       assert(uvTask->rspBuf.len == POINTER_DISTANCE(buf, uvTask->rspBuf.base));
+      if (rsp.type == UDF_TASK_SHM_MSG) {
+        udfcDecodeShmResponse(task->session, &rsp);
+      }
       task->errCode = rsp.code;
 
       switch (task->type) {
@@ -1432,12 +1780,11 @@ int32_t udfcInitializeUvTask(SClientUdfTask *task, int8_t uvTaskType, SClientUvT
     } else {
       fnError("udfc create uv task, invalid task type : %d", task->type);
     }
-    int32_t bufLen = encodeUdfRequest(NULL, &request);
-    request.msgLen = bufLen;
-    void *bufBegin = taosMemoryMalloc(bufLen);
-    void *buf = bufBegin;
-    encodeUdfRequest(&buf, &request);
-    uvTask->reqBuf = uv_buf_init(bufBegin, bufLen);
+    SUdfShmRing *ring = task->session->shmAttached ? &task->session->reqRing : NULL;
+    int32_t      code = udfEncodeRequestMsg(ring, &request, &uvTask->reqBuf);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
     uvTask->seqNum = request.seqNum;
   } else if (uvTaskType == UV_TASK_DISCONNECT) {
     uvTask->pipe = task->session->udfUvPipe;
@@ -1648,7 +1995,12 @@ int32_t udfcRunUdfUvTask(SClientUdfTask *task, int8_t uvTaskType) {
   SClientUvTaskNode *uvTask = taosMemoryCalloc(1, sizeof(SClientUvTaskNode));
   fnDebug("udfc client task: %p created uvTask: %p. pipe: %p", task, uvTask, task->session->udfUvPipe);
 
-  udfcInitializeUvTask(task, uvTaskType, uvTask);
+  int32_t code = udfcInitializeUvTask(task, uvTaskType, uvTask);
+  if (code != TSDB_CODE_SUCCESS) {
+    taosMemoryFree(uvTask);
+    task->errCode = code;
+    return code;
+  }
   udfcQueueUvTask(uvTask);
   udfcGetUdfTaskResultFromUvTask(task, uvTask);
   if (uvTaskType == UV_TASK_CONNECT) {
@@ -1665,6 +2017,48 @@ int32_t udfcRunUdfUvTask(SClientUdfTask *task, int8_t uvTaskType) {
   return task->errCode;
 }
 
+static int32_t udfcCreateSessionShm(SUdfcUvSession *session, SUdfSetupRequest *req) {
+  static int32_t shmSeq = 0;
+
+  if (tsUdfShmSize <= 0) {
+    return 0;
+  }
+
+  int64_t ringSize = (int64_t)tsUdfShmSize * 1024 * 1024 / 2;
+  int64_t shmSize = sizeof(SUdfShmHead) + ringSize * 2;
+  char    shmName[TD_SHM_NAME_LEN] = {0};
+  snprintf(shmName, sizeof(shmName), "/taosudf-%d-%d", taosGetPId(), atomic_add_fetch_32(&shmSeq, 1));
+
+  session->shm = taosCreateShm(shmName, shmSize);
+  if (session->shm == NULL) {
+    fnWarn("udfc failed to create shared memory %s, use pipe only. code: %s", shmName, tstrerror(terrno));
+    return terrno;
+  }
+
+  char        *addr = taosShmAddr(session->shm);
+  SUdfShmHead *pHead = (SUdfShmHead *)addr;
+  pHead->ringSize = ringSize;
+  pHead->magic = UDF_SHM_MAGIC;
+
+  udfShmRingInit(&session->reqRing, addr + sizeof(SUdfShmHead), ringSize);
+  session->rspRingData = addr + sizeof(SUdfShmHead) + ringSize;
+  session->rspRingSize = ringSize;
+
+  tstrncpy(req->shmName, shmName, sizeof(req->shmName));
+  req->shmSize = shmSize;
+  return 0;
+}
+
+static void udfcCloseSessionShm(SUdfcUvSession *session) {
+  session->shmAttached = 0;
+  if (session->shm != NULL) {
+    udfShmRingDestroy(&session->reqRing);
+    session->rspRingData = NULL;
+    session->rspRingSize = 0;
+    taosCloseShm(&session->shm);
+  }
+}
+
 int32_t doSetupUdf(char udfName[], UdfcFuncHandle *funcHandle) {
   if (gUdfcProxy.udfcState != UDFC_STATE_READY) {
     return TSDB_CODE_UDF_INVALID_STATE;
@@ -1686,6 +2080,7 @@ int32_t doSetupUdf(char udfName[], UdfcFuncHandle *funcHandle) {
     return TSDB_CODE_UDF_PIPE_CONNECT_ERR;
   }
 
+  udfcCreateSessionShm(task->session, req);
   udfcRunUdfUvTask(task, UV_TASK_REQ_RSP);
 
   SUdfSetupResponse *rsp = &task->_setup.rsp;
@@ -1694,6 +2089,11 @@ int32_t doSetupUdf(char udfName[], UdfcFuncHandle *funcHandle) {
   task->session->outputLen = rsp->outputLen;
   task->session->bufSize = rsp->bufSize;
   strncpy(task->session->udfName, udfName, TSDB_FUNC_NAME_LEN);
+  if (task->errCode == 0 && rsp->shmAttached) {
+    task->session->shmAttached = 1;
+  } else {
+    udfcCloseSessionShm(task->session);
+  }
   if (task->errCode != 0) {
     fnError("failed to setup udf. udfname: %s, err: %d", udfName, task->errCode)
   } else {
@@ -1834,6 +2234,7 @@ int32_t doTeardownUdf(UdfcFuncHandle handle) {
 
   if (session->udfUvPipe == NULL) {
     fnError("tear down udf. pipe to udfd does not exist. udf name: %s", session->udfName);
+    udfcCloseSessionShm(session);
     taosMemoryFree(session);
     return TSDB_CODE_UDF_PIPE_NO_PIPE;
   }
@@ -1860,6 +2261,7 @@ int32_t doTeardownUdf(UdfcFuncHandle handle) {
     conn->session = NULL;
   }
   uv_mutex_unlock(&gUdfcProxy.udfcUvMutex);
+  udfcCloseSessionShm(session);
   taosMemoryFree(session);
   taosMemoryFree(task);
 
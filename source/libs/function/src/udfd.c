@@ -52,6 +52,15 @@ SUdfdContext global;
 struct SUdfdUvConn;
 struct SUvUdfWork;
 
+// shared memory mapped from udfc, referenced by the connection and each of its works
+typedef struct SUdfdShm {
+  int32_t     refCount;
+  TdShmPtr    shm;
+  char       *reqRingData;
+  int64_t     reqRingSize;
+  SUdfShmRing rspRing;
+} SUdfdShm;
+
 typedef struct SUdfdUvConn {
   uv_stream_t *client;
   char        *inputBuf;
@@ -59,11 +68,13 @@ typedef struct SUdfdUvConn {
   int32_t      inputCap;
   int32_t      inputTotal;
 
+  SUdfdShm          *shm;
   struct SUvUdfWork *pWorkList;  // head of work list
 } SUdfdUvConn;
 
 typedef struct SUvUdfWork {
   SUdfdUvConn *conn;
+  SUdfdShm    *shm;
   uv_buf_t     input;
   uv_buf_t     output;
 
@@ -155,11 +166,110 @@ static void    udfdCloseWalkCb(uv_handle_t *handle, void *arg);
 static int32_t udfdRun();
 static void    udfdConnectMnodeThreadFunc(void *args);
 
+static SUdfdShm *udfdAcquireShm(SUdfdShm *pShm) {
+  if (pShm != NULL) {
+    atomic_add_fetch_32(&pShm->refCount, 1);
+  }
+  return pShm;
+}
+
+static void udfdReleaseShm(SUdfdShm *pShm) {
+  if (pShm != NULL && atomic_sub_fetch_32(&pShm->refCount, 1) == 0) {
+    udfShmRingDestroy(&pShm->rspRing);
+    taosCloseShm(&pShm->shm);
+    taosMemoryFree(pShm);
+  }
+}
+
+static void udfdAttachShm(SUdfdUvConn *conn, const char *shmName, int64_t shmSize) {
+  TdShmPtr shm = taosOpenShm(shmName, shmSize);
+  if (shm == NULL) {
+    fnWarn("udfd failed to open shared memory %s, use pipe only. code: %s", shmName, tstrerror(terrno));
+    return;
+  }
+  // nobody else opens it by name, the mapping lives until both sides close it
+  taosUnlinkShm(shm);
+
+  char        *addr = taosShmAddr(shm);
+  SUdfShmHead *pHead = (SUdfShmHead *)addr;
+  if (pHead->magic != UDF_SHM_MAGIC || pHead->ringSize <= 0 ||
+      sizeof(SUdfShmHead) + pHead->ringSize * 2 != taosShmSize(shm)) {
+    fnError("udfd invalid shared memory %s, size: %" PRId64, shmName, shmSize);
+    taosCloseShm(&shm);
+    return;
+  }
+
+  SUdfdShm *pShm = taosMemoryCalloc(1, sizeof(SUdfdShm));
+  if (pShm == NULL) {
+    taosCloseShm(&shm);
+    return;
+  }
+  pShm->refCount = 1;
+  pShm->shm = shm;
+  pShm->reqRingData = addr + sizeof(SUdfShmHead);
+  pShm->reqRingSize = pHead->ringSize;
+  udfShmRingInit(&pShm->rspRing, addr + sizeof(SUdfShmHead) + pHead->ringSize, pHead->ringSize);
+  conn->shm = pShm;
+  fnInfo("udfd attached shared memory %s, ring size: %" PRId64, shmName, pHead->ringSize);
+}
+
+static void udfdEncodeResponse(SUvUdfWork *uvUdf, SUdfResponse *rsp) {
+  int32_t len = encodeUdfResponse(NULL, rsp);
+  rsp->msgLen = len;
+
+  SUdfResponse shmRsp = {0};
+  int64_t      offset = 0;
+  char        *frame = NULL;
+  if (uvUdf->shm != NULL && len >= UDF_SHM_MIN_MSG_LEN) {
+    frame = udfShmRingAlloc(&uvUdf->shm->rspRing, len, &offset);
+  }
+  if (frame != NULL) {
+    void *buf = frame;
+    encodeUdfResponse(&buf, rsp);
+
+    // only the position of the frame goes through the pipe
+    shmRsp.seqNum = rsp->seqNum;
+    shmRsp.type = UDF_TASK_SHM_MSG;
+    shmRsp.code = rsp->code;
+    shmRsp.shmMsg.offset = offset;
+    shmRsp.shmMsg.len = len;
+    rsp = &shmRsp;
+    len = encodeUdfResponse(NULL, rsp);
+    rsp->msgLen = len;
+  }
+
+  void *bufBegin = taosMemoryMalloc(len);
+  void *buf = bufBegin;
+  encodeUdfResponse(&buf, rsp);
+  uvUdf->output = uv_buf_init(bufBegin, len);
+}
+
 void udfdProcessRequest(uv_work_t *req) {
   SUvUdfWork *uvUdf = (SUvUdfWork *)(req->data);
   SUdfRequest request = {0};
+  int64_t     frameOffset = -1;
   decodeUdfRequest(uvUdf->input.base, &request);
 
+  if (request.type == UDF_TASK_SHM_MSG) {
+    SUdfShmMsg shmMsg = request.shmMsg;
+    char      *frame = NULL;
+    if (uvUdf->shm != NULL) {
+      frame = udfShmRingGetFrame(uvUdf->shm->reqRingData, uvUdf->shm->reqRingSize, &shmMsg);
+    }
+    if (frame == NULL) {
+      fnError("udfd invalid request frame in shared memory. seq num: %" PRId64 ", offset: %" PRId64, request.seqNum,
+              shmMsg.offset);
+      SUdfResponse rsp = {.seqNum = request.seqNum, .type = UDF_TASK_SHM_MSG, .code = TSDB_CODE_UDF_PIPE_READ_ERR};
+      rsp.shmMsg.offset = -1;
+      udfdEncodeResponse(uvUdf, &rsp);
+      taosMemoryFree(uvUdf->input.base);
+      return;
+    }
+    // the data blocks are mapped in place, the frame is released after the request is processed
+    decodeUdfShmRequest(frame, &request);
+    frameOffset = shmMsg.offset;
+  }
+
   switch (request.type) {
     case UDF_TASK_SETUP: {
       udfdProcessSetupRequest(uvUdf, &request);
@@ -178,6 +288,10 @@ void udfdProcessRequest(uv_work_t *req) {
       break;
     }
   }
+
+  if (frameOffset >= 0) {
+    udfShmRingRelease(uvUdf->shm->reqRingData, frameOffset);
+  }
 }
 
 void udfdProcessSetupRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
@@ -240,19 +354,37 @@ void udfdProcessSetupRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
   rsp.setupRsp.outputType = udf->outputType;
   rsp.setupRsp.outputLen = udf->outputLen;
   rsp.setupRsp.bufSize = udf->bufSize;
+  rsp.setupRsp.shmAttached = (uvUdf->shm != NULL && setup->shmName[0] != 0);
 
-  int32_t len = encodeUdfResponse(NULL, &rsp);
-  rsp.msgLen = len;
-  void *bufBegin = taosMemoryMalloc(len);
-  void *buf = bufBegin;
-  encodeUdfResponse(&buf, &rsp);
-
-  uvUdf->output = uv_buf_init(bufBegin, len);
+  udfdEncodeResponse(uvUdf, &rsp);
 
   taosMemoryFree(uvUdf->input.base);
   return;
 }
 
+// the block decoded from the shared memory is passed to the udf in place, otherwise it is converted
+static void udfdGetCallInput(SUdfCallRequest *call, SUdfDataBlock *input) {
+  if (call->mapped) {
+    *input = call->udfBlock;
+  } else {
+    convertDataBlockToUdfDataBlock(&call->block, input);
+  }
+}
+
+static void udfdFreeCallInput(SUdfCallRequest *call, SUdfDataBlock *input) {
+  if (call->mapped) {
+    freeUdfShmDataBlock(input);
+  } else {
+    freeUdfDataDataBlock(input);
+  }
+}
+
+static void udfdFreeCallInterBuf(SUdfCallRequest *call, SUdfInterBuf *buf) {
+  if (!call->mapped) {
+    freeUdfInterBuf(buf);
+  }
+}
+
 void udfdProcessCallRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
   SUdfCallRequest *call = &request->call;
   fnDebug("call request. call type %d, handle: %" PRIx64 ", seq num %" PRId64, call->callType, call->udfHandle,
@@ -269,9 +401,9 @@ void udfdProcessCallRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
       SUdfColumn output = {0};
 
       SUdfDataBlock input = {0};
-      convertDataBlockToUdfDataBlock(&call->block, &input);
+      udfdGetCallInput(call, &input);
       code = udf->scalarProcFunc(&input, &output);
-      freeUdfDataDataBlock(&input);
+      udfdFreeCallInput(call, &input);
       convertUdfColumnToDataBlock(&output, &response.callRsp.resultData);
       freeUdfColumn(&output);
       break;
@@ -284,11 +416,11 @@ void udfdProcessCallRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
     }
     case TSDB_UDF_CALL_AGG_PROC: {
       SUdfDataBlock input = {0};
-      convertDataBlockToUdfDataBlock(&call->block, &input);
+      udfdGetCallInput(call, &input);
       SUdfInterBuf outBuf = {.buf = taosMemoryMalloc(udf->bufSize), .bufLen = udf->bufSize, .numOfResult = 0};
       code = udf->aggProcFunc(&input, &call->interBuf, &outBuf);
-      freeUdfInterBuf(&call->interBuf);
-      freeUdfDataDataBlock(&input);
+      udfdFreeCallInterBuf(call, &call->interBuf);
+      udfdFreeCallInput(call, &input);
       subRsp->resultBuf = outBuf;
 
       break;
@@ -296,8 +428,8 @@ void udfdProcessCallRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
     case TSDB_UDF_CALL_AGG_MERGE: {
       SUdfInterBuf outBuf = {.buf = taosMemoryMalloc(udf->bufSize), .bufLen = udf->bufSize, .numOfResult = 0};
       code = udf->aggMergeFunc(&call->interBuf, &call->interBuf2, &outBuf);
-      freeUdfInterBuf(&call->interBuf);
-      freeUdfInterBuf(&call->interBuf2);
+      udfdFreeCallInterBuf(call, &call->interBuf);
+      udfdFreeCallInterBuf(call, &call->interBuf2);
       subRsp->resultBuf = outBuf;
 
       break;
@@ -305,7 +437,7 @@ void udfdProcessCallRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
     case TSDB_UDF_CALL_AGG_FIN: {
       SUdfInterBuf outBuf = {.buf = taosMemoryMalloc(udf->bufSize), .bufLen = udf->bufSize, .numOfResult = 0};
       code = udf->aggFinishFunc(&call->interBuf, &outBuf);
-      freeUdfInterBuf(&call->interBuf);
+      udfdFreeCallInterBuf(call, &call->interBuf);
       subRsp->resultBuf = outBuf;
       break;
     }
@@ -318,12 +450,7 @@ void udfdProcessCallRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
   rsp->code = code;
   subRsp->callType = call->callType;
 
-  int32_t len = encodeUdfResponse(NULL, rsp);
-  rsp->msgLen = len;
-  void *bufBegin = taosMemoryMalloc(len);
-  void *buf = bufBegin;
-  encodeUdfResponse(&buf, rsp);
-  uvUdf->output = uv_buf_init(bufBegin, len);
+  udfdEncodeResponse(uvUdf, rsp);
 
   switch (call->callType) {
     case TSDB_UDF_CALL_SCALA_PROC: {
@@ -387,12 +514,7 @@ void udfdProcessTeardownRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
   rsp->seqNum = request->seqNum;
   rsp->type = request->type;
   rsp->code = code;
-  int32_t len = encodeUdfResponse(NULL, rsp);
-  rsp->msgLen = len;
-  void *bufBegin = taosMemoryMalloc(len);
-  void *buf = bufBegin;
-  encodeUdfResponse(&buf, rsp);
-  uvUdf->output = uv_buf_init(bufBegin, len);
+  udfdEncodeResponse(uvUdf, rsp);
 
   taosMemoryFree(uvUdf->input.base);
   return;
@@ -703,6 +825,7 @@ void udfdOnWrite(uv_write_t *req, int status) {
       fnError("work not in conn any more");
     }
   }
+  udfdReleaseShm(work->shm);
   taosMemoryFree(work->output.base);
   taosMemoryFree(work);
   taosMemoryFree(req);
@@ -715,6 +838,10 @@ void udfdSendResponse(uv_work_t *work, int status) {
     uv_write_t *write_req = taosMemoryMalloc(sizeof(uv_write_t));
     write_req->data = udfWork;
     uv_write(write_req, udfWork->conn->client, &udfWork->output, 1, udfdOnWrite);
+  } else {
+    udfdReleaseShm(udfWork->shm);
+    taosMemoryFree(udfWork->output.base);
+    taosMemoryFree(udfWork);
   }
   taosMemoryFree(work);
 }
@@ -767,9 +894,22 @@ void udfdHandleRequest(SUdfdUvConn *conn) {
   char *inputBuf = conn->inputBuf;
   int32_t inputLen = conn->inputLen;
 
+  // the shared memory is attached before the setup request is processed, so that its response can report it
+  if (conn->shm == NULL && inputLen > sizeof(int32_t) + sizeof(int64_t)) {
+    SUdfRequest request = {0};
+    decodeUdfRequestHead(inputBuf, &request);
+    if (request.type == UDF_TASK_SETUP) {
+      decodeUdfRequest(inputBuf, &request);
+      if (request.setup.shmName[0] != 0) {
+        udfdAttachShm(conn, request.setup.shmName, request.setup.shmSize);
+      }
+    }
+  }
+
   uv_work_t  *work = taosMemoryMalloc(sizeof(uv_work_t));
   SUvUdfWork *udfWork = taosMemoryMalloc(sizeof(SUvUdfWork));
   udfWork->conn = conn;
+  udfWork->shm = udfdAcquireShm(conn->shm);
   udfWork->pWorkNext = conn->pWorkList;
   conn->pWorkList = udfWork;
   udfWork->input = uv_buf_init(inputBuf, inputLen);
@@ -789,6 +929,7 @@ void udfdPipeCloseCb(uv_handle_t *pipe) {
     pWork = pWork->pWorkNext;
   }
 
+  udfdReleaseShm(conn->shm);
   taosMemoryFree(conn->client);
   taosMemoryFree(conn->inputBuf);
   taosMemoryFree(conn);
@@ -831,6 +972,7 @@ void udfdOnNewConnection(uv_stream_t *server, int status) {
   if (uv_accept(server, (uv_stream_t *)client) == 0) {
     SUdfdUvConn *ctx = taosMemoryMalloc(sizeof(SUdfdUvConn));
     ctx->pWorkList = NULL;
+    ctx->shm = NULL;
     ctx->client = (uv_stream_t *)client;
     ctx->inputBuf = 0;
     ctx->inputLen = 0;
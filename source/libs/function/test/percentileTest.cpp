@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include "taosdef.h"
+#include "taoserror.h"
+#include "tglobal.h"
+#include "tpercentile.h"
+
+namespace {
+
+// the same definition as getPercentiles: linear interpolation between the two adjacent ranks of the sorted values
+double expectedPercentile(std::vector<double> values, double percent) {
+  std::sort(values.begin(), values.end());
+  double  percentVal = percent * (values.size() - 1) / 100.0;
+  int64_t idx = std::min((int64_t)percentVal, (int64_t)values.size() - 1);
+  double  fraction = percentVal - idx;
+  if (idx + 1 >= (int64_t)values.size() || fraction < DBL_EPSILON) {
+    return values[idx];
+  }
+  return (1 - fraction) * values[idx] + fraction * values[idx + 1];
+}
+
+template <typename T>
+void checkPercentiles(tMemBucket *pBucket, const std::vector<T> &data, const std::vector<double> &percents) {
+  std::vector<double> values(data.begin(), data.end());
+  std::vector<double> results(percents.size());
+  ASSERT_EQ(getPercentiles(pBucket, percents.data(), percents.size(), results.data()), TSDB_CODE_SUCCESS);
+  for (size_t i = 0; i < percents.size(); ++i) {
+    EXPECT_DOUBLE_EQ(results[i], expectedPercentile(values, percents[i])) << "percent:" << percents[i];
+  }
+}
+
+template <typename T>
+tMemBucket *createBucket(int16_t type, const std::vector<T> &data, int32_t maxCapacity = 0) {
+  tMemBucket *pBucket = tMemBucketCreate(sizeof(T), type);
+  if (pBucket == NULL) {
+    return NULL;
+  }
+  if (maxCapacity > 0) {
+    pBucket->maxCapacity = maxCapacity;
+  }
+  // put in small batches, as the percentile function does for each data block
+  for (size_t i = 0; i < data.size(); i += 4096) {
+    size_t n = std::min(data.size() - i, (size_t)4096);
+    if (tMemBucketPut(pBucket, data.data() + i, n) != TSDB_CODE_SUCCESS) {
+      tMemBucketDestroy(pBucket);
+      return NULL;
+    }
+  }
+  return pBucket;
+}
+
+uint64_t nextRand(uint64_t *pSeed) {
+  *pSeed = *pSeed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return *pSeed >> 11;
+}
+
+const std::vector<double> testPercents = {0, 99.9, 1, 50, 25, 75, 33.3, 90, 99, 100};
+
+}  // namespace
+
+TEST(percentileTest, empty) {
+  tMemBucket *pBucket = tMemBucketCreate(sizeof(int32_t), TSDB_DATA_TYPE_INT);
+  ASSERT_NE(pBucket, nullptr);
+  EXPECT_DOUBLE_EQ(getPercentile(pBucket, 50), 0.0);
+  tMemBucketDestroy(pBucket);
+
+  EXPECT_EQ(tMemBucketCreate(10, TSDB_DATA_TYPE_BINARY), nullptr);
+}
+
+TEST(percentileTest, smallInput) {
+  std::vector<int32_t> data = {7, -3, 5, 5, 100, -3, 0};
+  tMemBucket          *pBucket = createBucket(TSDB_DATA_TYPE_INT, data);
+  ASSERT_NE(pBucket, nullptr);
+  EXPECT_DOUBLE_EQ(getPercentile(pBucket, 0), -3);
+  EXPECT_DOUBLE_EQ(getPercentile(pBucket, 50), 5);
+  EXPECT_DOUBLE_EQ(getPercentile(pBucket, 100), 100);
+  checkPercentiles(pBucket, data, testPercents);
+  tMemBucketDestroy(pBucket);
+}
+
+TEST(percentileTest, radixSelectTypes) {
+  uint64_t seed = 1;
+
+  std::vector<int8_t> i8(5000);
+  for (auto &v : i8) v = (int8_t)nextRand(&seed);
+  tMemBucket *pBucket = createBucket(TSDB_DATA_TYPE_TINYINT, i8);
+  ASSERT_NE(pBucket, nullptr);
+  checkPercentiles(pBucket, i8, testPercents);
+  tMemBucketDestroy(pBucket);
+
+  std::vector<int64_t> i64(100000);
+  for (auto &v : i64) v = (int64_t)nextRand(&seed) - (int64_t)(1LL << 52);
+  pBucket = createBucket(TSDB_DATA_TYPE_BIGINT, i64);
+  ASSERT_NE(pBucket, nullptr);
+  checkPercentiles(pBucket, i64, testPercents);
+  tMemBucketDestroy(pBucket);
+
+  std::vector<uint32_t> u32(100000);
+  for (auto &v : u32) v = (uint32_t)nextRand(&seed);
+  pBucket = createBucket(TSDB_DATA_TYPE_UINT, u32);
+  ASSERT_NE(pBucket, nullptr);
+  checkPercentiles(pBucket, u32, testPercents);
+  tMemBucketDestroy(pBucket);
+
+  // negative, positive and zero doubles share the order preserving key mapping
+  std::vector<double> f64(100000);
+  for (auto &v : f64) v = ((double)(nextRand(&seed) % 2000001) - 1000000.0) / 7.0;
+  f64[0] = 0.0;
+  f64[1] = -0.5;
+  pBucket = createBucket(TSDB_DATA_TYPE_DOUBLE, f64);
+  ASSERT_NE(pBucket, nullptr);
+  checkPercentiles(pBucket, f64, testPercents);
+  tMemBucketDestroy(pBucket);
+
+  std::vector<float> f32(3000);
+  for (auto &v : f32) v = (float)((int64_t)(nextRand(&seed) % 20001) - 10000) / 3.0f;
+  pBucket = createBucket(TSDB_DATA_TYPE_FLOAT, f32);
+  ASSERT_NE(pBucket, nullptr);
+  checkPercentiles(pBucket, f32, testPercents);
+  tMemBucketDestroy(pBucket);
+}
+
+TEST(percentileTest, duplicateValues) {
+  // all keys identical: the selection runs out of digits
+  std::vector<int64_t> same(10000, 42);
+  tMemBucket          *pBucket = createBucket(TSDB_DATA_TYPE_BIGINT, same);
+  ASSERT_NE(pBucket, nullptr);
+  checkPercentiles(pBucket, same, testPercents);
+  tMemBucketDestroy(pBucket);
+
+  // a few distinct values that share all digits but the lowest one
+  uint64_t             seed = 2;
+  std::vector<int64_t> few(50000);
+  for (auto &v : few) v = 1000000 + (int64_t)(nextRand(&seed) % 3);
+  pBucket = createBucket(TSDB_DATA_TYPE_BIGINT, few);
+  ASSERT_NE(pBucket, nullptr);
+  checkPercentiles(pBucket, few, testPercents);
+  tMemBucketDestroy(pBucket);
+}
+
+TEST(percentileTest, spillToDisk) {
+  strcpy(tsTempDir, TD_TMP_DIR_PATH);
+  osUpdate();
+
+  uint64_t seed = 3;
+
+  // more keys than the default in-memory capacity
+  std::vector<int64_t> data(400000);
+  for (auto &v : data) v = (int64_t)nextRand(&seed) % 1000000007 - 500000000;
+  tMemBucket *pBucket = createBucket(TSDB_DATA_TYPE_BIGINT, data);
+  ASSERT_NE(pBucket, nullptr);
+  ASSERT_NE(pBucket->pBuffer, nullptr);
+  checkPercentiles(pBucket, data, testPercents);
+  tMemBucketDestroy(pBucket);
+
+  // a small capacity forces the spilled slots to be split again on disk, digit by digit
+  std::vector<double> skewed(200000);
+  for (auto &v : skewed) v = 1.0 + (double)(nextRand(&seed) % 100000) / 1e9;
+  pBucket = createBucket(TSDB_DATA_TYPE_DOUBLE, skewed, 1024);
+  ASSERT_NE(pBucket, nullptr);
+  ASSERT_NE(pBucket->pBuffer, nullptr);
+  checkPercentiles(pBucket, skewed, testPercents);
+  tMemBucketDestroy(pBucket);
+
+  // identical keys on disk
+  std::vector<int32_t> same(50000, -7);
+  pBucket = createBucket(TSDB_DATA_TYPE_INT, same, 1024);
+  ASSERT_NE(pBucket, nullptr);
+  ASSERT_NE(pBucket->pBuffer, nullptr);
+  checkPercentiles(pBucket, same, testPercents);
+  tMemBucketDestroy(pBucket);
+}
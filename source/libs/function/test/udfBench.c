@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "uv.h"
+
+#include "fnLog.h"
+#include "os.h"
+#include "tdatablock.h"
+#include "tglobal.h"
+#include "tudf.h"
+
+static int32_t numOfRows = 65536;
+static int32_t numOfLoops = 1000;
+
+static int32_t parseArgs(int32_t argc, char *argv[]) {
+  for (int32_t i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-c") == 0) {
+      if (i < argc - 1) {
+        if (strlen(argv[++i]) >= PATH_MAX) {
+          printf("config file path overflow");
+          return -1;
+        }
+        tstrncpy(configDir, argv[i], PATH_MAX);
+      } else {
+        printf("'-c' requires a parameter, default is %s\n", configDir);
+        return -1;
+      }
+    } else if (strcmp(argv[i], "-r") == 0 && i < argc - 1) {
+      numOfRows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      numOfLoops = atoi(argv[++i]);
+    }
+  }
+
+  return 0;
+}
+
+static int32_t initLog() {
+  char logName[12] = {0};
+  snprintf(logName, sizeof(logName), "%slog", "udfc");
+  return taosCreateLog(logName, 1, configDir, NULL, NULL, NULL, NULL, 0);
+}
+
+// call udf1 on the same block repeatedly, the udf session is set up with the given shared memory size
+static int32_t scalarFuncBench(int32_t shmSize) {
+  UdfcFuncHandle handle;
+
+  tsUdfShmSize = shmSize;
+  if (doSetupUdf("udf1", &handle) != 0) {
+    fnError("setup udf failure");
+    return -1;
+  }
+
+  SSDataBlock     block = {0};
+  SSDataBlock    *pBlock = &block;
+  SColumnInfoData colInfo = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 1);
+  blockDataAppendColInfo(pBlock, &colInfo);
+  blockDataEnsureCapacity(pBlock, numOfRows);
+  pBlock->info.rows = numOfRows;
+
+  SColumnInfoData *pCol = taosArrayGet(pBlock->pDataBlock, 0);
+  for (int32_t j = 0; j < pBlock->info.rows; ++j) {
+    colDataAppendInt32(pCol, j, &j);
+  }
+
+  SScalarParam input = {0};
+  input.numOfRows = pBlock->info.rows;
+  input.columnData = pCol;
+
+  int64_t beg = taosGetTimestampUs();
+  for (int32_t k = 0; k < numOfLoops; ++k) {
+    SScalarParam output = {0};
+    if (doCallUdfScalarFunc(handle, &input, 1, &output) != 0) {
+      fnError("call udf failure");
+      break;
+    }
+    colDataDestroy(output.columnData);
+    taosMemoryFree(output.columnData);
+  }
+  int64_t end = taosGetTimestampUs();
+
+  double seconds = (end - beg) / 1000000.0;
+  double rows = (double)numOfRows * numOfLoops;
+  fprintf(stderr, "udfShmSize: %dMB, rows: %d, loops: %d, time: %.3fs, %.0f rows/s, %.2f MB/s\n", shmSize, numOfRows,
+          numOfLoops, seconds, rows / seconds, rows * sizeof(int32_t) * 2 / seconds / 1024 / 1024);
+
+  blockDataFreeRes(pBlock);
+  doTeardownUdf(handle);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  parseArgs(argc, argv);
+  initLog();
+  if (taosInitCfg(configDir, NULL, NULL, NULL, NULL, 0) != 0) {
+    fnError("failed to start since read config error");
+    return -1;
+  }
+
+  udfcOpen();
+  uv_sleep(1000);
+
+  int32_t shmSize = tsUdfShmSize > 0 ? tsUdfShmSize : 16;
+  scalarFuncBench(0);
+  scalarFuncBench(shmSize);
+  udfcClose();
+}
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "uv.h"
+
+#include "os.h"
+
+#include "tdatablock.h"
+#include "tudf.h"
+#include "tudfInt.h"
+
+namespace {
+
+const int64_t kRingSize = 64 * 1024;
+const int32_t kFrameHeadLen = 8;
+
+class UdfShmTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    data_ = (char *)taosMemoryCalloc(1, kRingSize);
+    ASSERT_EQ(udfShmRingInit(&ring_, data_, kRingSize), 0);
+  }
+
+  void TearDown() override {
+    udfShmRingDestroy(&ring_);
+    taosMemoryFree(data_);
+  }
+
+  char *alloc(int32_t len, int64_t *pOffset) {
+    char *payload = udfShmRingAlloc(&ring_, len, pOffset);
+    if (payload != NULL) {
+      memset(payload, 0xab, len);
+    }
+    return payload;
+  }
+
+  char       *data_ = nullptr;
+  SUdfShmRing ring_ = {0};
+};
+
+// a scalar call request with an int column and a varchar column of numOfRows rows
+void buildCallRequest(SUdfRequest *request, int32_t numOfRows) {
+  memset(request, 0, sizeof(SUdfRequest));
+  request->seqNum = 7;
+  request->type = UDF_TASK_CALL;
+  request->call.udfHandle = 42;
+  request->call.callType = TSDB_UDF_CALL_SCALA_PROC;
+
+  SSDataBlock *pBlock = &request->call.block;
+  pBlock->pDataBlock = taosArrayInit(2, sizeof(SColumnInfoData));
+  SColumnInfoData intCol = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 1);
+  taosArrayPush(pBlock->pDataBlock, &intCol);
+  SColumnInfoData strCol = createColumnInfoData(TSDB_DATA_TYPE_VARCHAR, 16 + VARSTR_HEADER_SIZE, 2);
+  taosArrayPush(pBlock->pDataBlock, &strCol);
+  ASSERT_EQ(blockDataEnsureCapacity(pBlock, numOfRows), 0);
+
+  SColumnInfoData *pIntCol = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData *pStrCol = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 1);
+  char             str[16 + VARSTR_HEADER_SIZE];
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (i % 10 == 3) {
+      colDataAppendNULL(pIntCol, i);
+    } else {
+      colDataAppend(pIntCol, i, (const char *)&i, false);
+    }
+    int32_t len = snprintf(varDataVal(str), 16, "row%d", i);
+    varDataSetLen(str, len);
+    colDataAppend(pStrCol, i, str, false);
+  }
+  pIntCol->hasNull = true;
+  pBlock->info.rows = numOfRows;
+}
+
+}  // namespace
+
+TEST_F(UdfShmTest, wraparound) {
+  int64_t offset1 = -1, offset2 = -1;
+  ASSERT_NE(alloc(24 * 1024 - kFrameHeadLen, &offset1), nullptr);
+  ASSERT_NE(alloc(24 * 1024 - kFrameHeadLen, &offset2), nullptr);
+  EXPECT_EQ(offset1, 0);
+  EXPECT_EQ(offset2, 24 * 1024);
+
+  // 16KB left at the end of the ring and the head frame is still in use
+  int64_t offset3 = -1;
+  EXPECT_EQ(alloc(20 * 1024 - kFrameHeadLen, &offset3), nullptr);
+
+  // the released head makes room at the beginning, the rest of the ring is padded and the frame wraps around
+  udfShmRingRelease(data_, offset1);
+  ASSERT_NE(alloc(20 * 1024 - kFrameHeadLen, &offset3), nullptr);
+  EXPECT_EQ(offset3, 0);
+  EXPECT_EQ(ring_.used, kRingSize - 4 * 1024);
+
+  // only 4KB between the tail and the head
+  int64_t offset4 = -1;
+  EXPECT_EQ(alloc(8 * 1024 - kFrameHeadLen, &offset4), nullptr);
+
+  // the reclaim goes over the padding back to the beginning of the ring
+  udfShmRingRelease(data_, offset2);
+  ASSERT_NE(alloc(40 * 1024 - kFrameHeadLen, &offset4), nullptr);
+  EXPECT_EQ(offset4, 20 * 1024);
+  EXPECT_EQ(ring_.head, 0);
+
+  udfShmRingRelease(data_, offset3);
+  udfShmRingRelease(data_, offset4);
+  int64_t offset5 = -1;
+  ASSERT_NE(alloc(kRingSize - kFrameHeadLen, &offset5), nullptr);
+  EXPECT_EQ(offset5, 0);
+}
+
+TEST_F(UdfShmTest, fullRing) {
+  std::vector<int64_t> offsets;
+  int64_t              offset = -1;
+  while (alloc(4096 - kFrameHeadLen, &offset) != nullptr) {
+    offsets.push_back(offset);
+  }
+  ASSERT_EQ(offsets.size(), kRingSize / 4096);
+  EXPECT_EQ(ring_.used, kRingSize);
+
+  // a message larger than the ring never fits
+  EXPECT_EQ(alloc(kRingSize, &offset), nullptr);
+
+  // the frames in the middle are not reclaimed while the head is in use
+  for (size_t i = 1; i < offsets.size(); ++i) {
+    udfShmRingRelease(data_, offsets[i]);
+  }
+  EXPECT_EQ(alloc(1, &offset), nullptr);
+
+  udfShmRingRelease(data_, offsets[0]);
+  ASSERT_NE(alloc(kRingSize - kFrameHeadLen, &offset), nullptr);
+  EXPECT_EQ(offset, 0);
+}
+
+TEST_F(UdfShmTest, requestHead) {
+  SUdfRequest request = {0};
+  request.seqNum = 12345;
+  request.type = UDF_TASK_TEARDOWN;
+  request.teardown.udfHandle = 99;
+  int32_t len = encodeUdfRequest(NULL, &request);
+  request.msgLen = len;
+
+  std::vector<char> buf(len);
+  void             *pBuf = buf.data();
+  encodeUdfRequest(&pBuf, &request);
+
+  SUdfRequest head = {0};
+  head.type = -1;
+  decodeUdfRequestHead(buf.data(), &head);
+  EXPECT_EQ(head.msgLen, len);
+  EXPECT_EQ(head.seqNum, 12345);
+  EXPECT_EQ(head.type, UDF_TASK_TEARDOWN);
+}
+
+TEST_F(UdfShmTest, mapInPlace) {
+  const int32_t numOfRows = 1000;
+  SUdfRequest   request;
+  buildCallRequest(&request, numOfRows);
+
+  uv_buf_t msg = {0};
+  ASSERT_EQ(udfEncodeRequestMsg(&ring_, &request, &msg), 0);
+
+  // only the position of the frame goes through the pipe
+  SUdfRequest pipeReq = {0};
+  decodeUdfRequest(msg.base, &pipeReq);
+  ASSERT_EQ(pipeReq.type, UDF_TASK_SHM_MSG);
+  EXPECT_EQ(pipeReq.seqNum, request.seqNum);
+  EXPECT_EQ(pipeReq.msgLen, (int32_t)msg.len);
+
+  char *frame = udfShmRingGetFrame(data_, kRingSize, &pipeReq.shmMsg);
+  ASSERT_NE(frame, nullptr);
+
+  SUdfRequest shmReq = {0};
+  decodeUdfShmRequest(frame, &shmReq);
+  ASSERT_EQ(shmReq.type, UDF_TASK_CALL);
+  EXPECT_EQ(shmReq.call.udfHandle, 42);
+  ASSERT_TRUE(shmReq.call.mapped);
+
+  SUdfDataBlock *pBlock = &shmReq.call.udfBlock;
+  ASSERT_EQ(pBlock->numOfRows, numOfRows);
+  ASSERT_EQ(pBlock->numOfCols, 2);
+
+  // the columns point into the frame and are aligned
+  SUdfColumn *pIntCol = pBlock->udfCols[0];
+  SUdfColumn *pStrCol = pBlock->udfCols[1];
+  char       *end = frame + pipeReq.shmMsg.len;
+  EXPECT_TRUE(pIntCol->colData.fixLenCol.data > frame && pIntCol->colData.fixLenCol.data < end);
+  EXPECT_TRUE(pStrCol->colData.varLenCol.payload > frame && pStrCol->colData.varLenCol.payload < end);
+  EXPECT_EQ((uintptr_t)pIntCol->colData.fixLenCol.data % 8, 0);
+  EXPECT_EQ((uintptr_t)pStrCol->colData.varLenCol.varOffsets % 8, 0);
+
+  EXPECT_EQ(pIntCol->colMeta.type, TSDB_DATA_TYPE_INT);
+  EXPECT_TRUE(pIntCol->hasNull);
+  EXPECT_EQ(pStrCol->colMeta.type, TSDB_DATA_TYPE_VARCHAR);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (i % 10 == 3) {
+      EXPECT_TRUE(udfColDataIsNull(pIntCol, i));
+    } else {
+      ASSERT_FALSE(udfColDataIsNull(pIntCol, i));
+      EXPECT_EQ(*(int32_t *)udfColDataGetData(pIntCol, i), i);
+    }
+    char  expect[16];
+    char *str = udfColDataGetData(pStrCol, i);
+    snprintf(expect, sizeof(expect), "row%d", i);
+    EXPECT_EQ(std::string(varDataVal(str), varDataLen(str)), expect);
+  }
+
+  freeUdfShmDataBlock(pBlock);
+  udfShmRingRelease(data_, pipeReq.shmMsg.offset);
+  taosMemoryFree(msg.base);
+  blockDataFreeRes(&request.call.block);
+}
+
+TEST_F(UdfShmTest, fallbackToPipe) {
+  SUdfRequest request;
+  buildCallRequest(&request, 1000);
+
+  // the ring is full, the whole request goes inline through the pipe
+  std::vector<int64_t> offsets;
+  int64_t              offset = -1;
+  while (alloc(4096 - kFrameHeadLen, &offset) != nullptr) {
+    offsets.push_back(offset);
+  }
+
+  uv_buf_t msg = {0};
+  ASSERT_EQ(udfEncodeRequestMsg(&ring_, &request, &msg), 0);
+  SUdfRequest pipeReq = {0};
+  decodeUdfRequest(msg.base, &pipeReq);
+  ASSERT_EQ(pipeReq.type, UDF_TASK_CALL);
+  EXPECT_FALSE(pipeReq.call.mapped);
+  EXPECT_EQ(pipeReq.call.block.info.rows, 1000);
+  EXPECT_EQ(taosArrayGetSize(pipeReq.call.block.pDataBlock), 2);
+  blockDataFreeRes(&pipeReq.call.block);
+  taosMemoryFree(msg.base);
+
+  // no shared memory attached
+  ASSERT_EQ(udfEncodeRequestMsg(NULL, &request, &msg), 0);
+  memset(&pipeReq, 0, sizeof(pipeReq));
+  decodeUdfRequest(msg.base, &pipeReq);
+  EXPECT_EQ(pipeReq.type, UDF_TASK_CALL);
+  blockDataFreeRes(&pipeReq.call.block);
+  taosMemoryFree(msg.base);
+
+  // a small request does not use the ring even if it has room
+  for (int64_t off : offsets) {
+    udfShmRingRelease(data_, off);
+  }
+  blockDataFreeRes(&request.call.block);
+  buildCallRequest(&request, 10);
+  ASSERT_EQ(udfEncodeRequestMsg(&ring_, &request, &msg), 0);
+  memset(&pipeReq, 0, sizeof(pipeReq));
+  decodeUdfRequest(msg.base, &pipeReq);
+  EXPECT_EQ(pipeReq.type, UDF_TASK_CALL);
+  EXPECT_EQ(pipeReq.call.block.info.rows, 10);
+  blockDataFreeRes(&pipeReq.call.block);
+  taosMemoryFree(msg.base);
+  blockDataFreeRes(&request.call.block);
+}
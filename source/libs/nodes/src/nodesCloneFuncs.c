@@ -245,6 +245,8 @@ static int32_t realTableNodeCopy(const SRealTableNode* pSrc, SRealTableNode* pDs
   CLONE_OBJECT_FIELD(pVgroupList, vgroupsInfoClone);
   COPY_CHAR_ARRAY_FIELD(qualDbName);
   COPY_SCALAR_FIELD(ratio);
+  COPY_OBJECT_FIELD(rollupInfo, sizeof(SRollupInfo));
+  CLONE_OBJECT_FIELD(pStats, tCloneTableStats);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -385,14 +387,21 @@ static int32_t logicScanCopy(const SScanLogicNode* pSrc, SScanLogicNode* pDst) {
   CLONE_NODE_LIST_FIELD(pTags);
   CLONE_NODE_FIELD(pSubtable);
   COPY_SCALAR_FIELD(igLastNull);
+  COPY_OBJECT_FIELD(rollupInfo, sizeof(SRollupInfo));
+  CLONE_OBJECT_FIELD(pStats, tCloneTableStats);
+  COPY_SCALAR_FIELD(rollupLevel);
   return TSDB_CODE_SUCCESS;
 }
 
 static int32_t logicJoinCopy(const SJoinLogicNode* pSrc, SJoinLogicNode* pDst) {
   COPY_BASE_OBJECT_FIELD(node, logicNodeCopy);
   COPY_SCALAR_FIELD(joinType);
+  COPY_SCALAR_FIELD(joinAlgo);
   CLONE_NODE_FIELD(pMergeCondition);
   CLONE_NODE_FIELD(pOnConditions);
+  CLONE_NODE_LIST_FIELD(pLeftKeys);
+  CLONE_NODE_LIST_FIELD(pRightKeys);
+  COPY_SCALAR_FIELD(buildSide);
   COPY_SCALAR_FIELD(isSingleTableJoin);
   COPY_SCALAR_FIELD(inputTsOrder);
   return TSDB_CODE_SUCCESS;
@@ -563,6 +572,7 @@ static int32_t physiTableScanCopy(const STableScanPhysiNode* pSrc, STableScanPhy
   COPY_SCALAR_FIELD(triggerType);
   COPY_SCALAR_FIELD(watermark);
   COPY_SCALAR_FIELD(igExpired);
+  COPY_SCALAR_FIELD(rollupLevel);
   return TSDB_CODE_SUCCESS;
 }
 
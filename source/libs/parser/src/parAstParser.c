@@ -120,13 +120,17 @@ static EDealRes collectMetaKeyFromFunction(SCollectMetaKeyFromExprCxt* pCxt, SFu
 }
 
 static bool needGetTableIndex(SNode* pStmt) {
-  if (QUERY_SMA_OPTIMIZE_ENABLE == tsQuerySmaOptimize && QUERY_NODE_SELECT_STMT == nodeType(pStmt)) {
+  if (QUERY_SMA_OPTIMIZE_DISABLE != tsQuerySmaOptimize && QUERY_NODE_SELECT_STMT == nodeType(pStmt)) {
     SSelectStmt* pSelect = (SSelectStmt*)pStmt;
     return (NULL != pSelect->pWindow && QUERY_NODE_INTERVAL_WINDOW == nodeType(pSelect->pWindow));
   }
   return false;
 }
 
+static bool needGetTableStats(SNode* pStmt, const char* pDb) {
+  return tsQueryStatsOptimize && QUERY_NODE_SELECT_STMT == nodeType(pStmt) && !IS_SYS_DBNAME(pDb);
+}
+
 static int32_t collectMetaKeyFromInsTagsImpl(SCollectMetaKeyCxt* pCxt, SName* pName) {
   if (0 == pName->type) {
     return TSDB_CODE_SUCCESS;
@@ -162,6 +166,9 @@ static int32_t collectMetaKeyFromRealTableImpl(SCollectMetaKeyCxt* pCxt, const c
   if (TSDB_CODE_SUCCESS == code && needGetTableIndex(pCxt->pStmt)) {
     code = reserveTableIndexInCache(pCxt->pParseCxt->acctId, pDb, pTable, pCxt->pMetaCache);
   }
+  if (TSDB_CODE_SUCCESS == code && needGetTableStats(pCxt->pStmt, pDb)) {
+    code = reserveTableCfgInCache(pCxt->pParseCxt->acctId, pDb, pTable, pCxt->pMetaCache);
+  }
   if (TSDB_CODE_SUCCESS == code && (0 == strcmp(pTable, TSDB_INS_TABLE_DNODE_VARIABLES))) {
     code = reserveDnodeRequiredInCache(pCxt->pMetaCache);
   }
@@ -223,12 +230,66 @@ static int32_t reserveDbCfgForLastRow(SCollectMetaKeyCxt* pCxt, SNode* pTable) {
   return reserveDbCfgInCache(pCxt->pParseCxt->acctId, ((SRealTableNode*)pTable)->table.dbName, pCxt->pMetaCache);
 }
 
+static bool isRollupFunc(const char* pFunc) {
+  switch (fmGetFuncType(pFunc)) {
+    case FUNCTION_TYPE_WSTART:
+    case FUNCTION_TYPE_WEND:
+    case FUNCTION_TYPE_WDURATION:
+    case FUNCTION_TYPE_SUM:
+    case FUNCTION_TYPE_MIN:
+    case FUNCTION_TYPE_MAX:
+    case FUNCTION_TYPE_FIRST:
+    case FUNCTION_TYPE_LAST:
+      return true;
+    case FUNCTION_TYPE_AVG:
+      return QUERY_SMA_OPTIMIZE_APPROX == tsQuerySmaOptimize;
+    default:
+      break;
+  }
+  return false;
+}
+
+static EDealRes isRollupFuncImpl(SNode* pNode, void* pContext) {
+  if (QUERY_NODE_FUNCTION == nodeType(pNode) && !isRollupFunc(((SFunctionNode*)pNode)->functionName)) {
+    *(bool*)pContext = false;
+    return DEAL_RES_END;
+  }
+  return DEAL_RES_CONTINUE;
+}
+
+// The rollup levels of a super table are only read by the interval queries whose functions may be rolled up.
+bool isRollupQuery(SSelectStmt* pSelect) {
+  if (!needGetTableIndex((SNode*)pSelect) || NULL == pSelect->pFromTable ||
+      QUERY_NODE_REAL_TABLE != nodeType(pSelect->pFromTable) ||
+      IS_SYS_DBNAME(((SRealTableNode*)pSelect->pFromTable)->table.dbName)) {
+    return false;
+  }
+  bool isRollupFunc = true;
+  nodesWalkExprs(pSelect->pProjectionList, isRollupFuncImpl, &isRollupFunc);
+  if (isRollupFunc) {
+    nodesWalkExpr(pSelect->pHaving, isRollupFuncImpl, &isRollupFunc);
+  }
+  return isRollupFunc;
+}
+
+static int32_t reserveRollupCfg(SCollectMetaKeyCxt* pCxt, SRealTableNode* pTable) {
+  int32_t code = reserveDbCfgInCache(pCxt->pParseCxt->acctId, pTable->table.dbName, pCxt->pMetaCache);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = reserveTableCfgInCache(pCxt->pParseCxt->acctId, pTable->table.dbName, pTable->table.tableName,
+                                  pCxt->pMetaCache);
+  }
+  return code;
+}
+
 static int32_t collectMetaKeyFromSelect(SCollectMetaKeyCxt* pCxt, SSelectStmt* pStmt) {
   SCollectMetaKeyFromExprCxt cxt = {.pComCxt = pCxt, .hasLastRowOrLast = false, .errCode = TSDB_CODE_SUCCESS};
   nodesWalkSelectStmt(pStmt, SQL_CLAUSE_FROM, collectMetaKeyFromExprImpl, &cxt);
   if (TSDB_CODE_SUCCESS == cxt.errCode && cxt.hasLastRowOrLast) {
     cxt.errCode = reserveDbCfgForLastRow(pCxt, pStmt->pFromTable);
   }
+  if (TSDB_CODE_SUCCESS == cxt.errCode && isRollupQuery(pStmt)) {
+    cxt.errCode = reserveRollupCfg(pCxt, (SRealTableNode*)pStmt->pFromTable);
+  }
   return cxt.errCode;
 }
 
@@ -1537,8 +1537,10 @@ static int32_t translateForbidStreamFunc(STranslateContext* pCxt, SFunctionNode*
   return TSDB_CODE_SUCCESS;
 }
 
+// The functions which scan the data twice, or whose partial results can not be merged across vnodes, e.g. the exact
+// percentile, whose partial results are unbounded.
 static int32_t translateRepeatScanFunc(STranslateContext* pCxt, SFunctionNode* pFunc) {
-  if (!fmIsRepeatScanFunc(pFunc->funcId)) {
+  if (!fmIsRepeatScanFunc(pFunc->funcId) && !fmIsSingleTableFunc(pFunc->funcId)) {
     return TSDB_CODE_SUCCESS;
   }
   if (!isSelectStmt(pCxt->pCurrStmt)) {
@@ -2392,6 +2394,59 @@ static int32_t setTableIndex(STranslateContext* pCxt, SName* pName, SRealTableNo
   return TSDB_CODE_SUCCESS;
 }
 
+static void setRollupLevelInfo(const SDbCfgInfo* pDbCfg, const STableCfg* pTableCfg, SRollupInfo* pInfo) {
+  for (int32_t i = 0; i < TSDB_RETENTION_L2; ++i) {
+    SRetention* pRetention = taosArrayGet(pDbCfg->pRetensions, i + 1);
+    pInfo->freq[i] = pRetention->freq;
+  }
+  strcpy(pInfo->funcName, taosArrayGet(pTableCfg->pFuncs, 0));
+}
+
+// The avg of the rolled-up averages is not weighted by the number of rows of each period, so it is only used if the
+// user accepts the approximate results.
+static bool isSuitableRollupFunc(const char* pFunc) {
+  return FUNCTION_TYPE_AVG != fmGetFuncType(pFunc) || QUERY_SMA_OPTIMIZE_APPROX == tsQuerySmaOptimize;
+}
+
+// The rollup levels are only a chance of optimization, so the errors of getting them are ignored.
+static int32_t setTableRollupInfo(STranslateContext* pCxt, SName* pName, SRealTableNode* pRealTable) {
+  if (pCxt->createStream || TSDB_SUPER_TABLE != pRealTable->pMeta->tableType || !isSelectStmt(pCxt->pCurrStmt) ||
+      !isRollupQuery((SSelectStmt*)pCxt->pCurrStmt)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SDbCfgInfo dbCfg = {0};
+  if (TSDB_CODE_SUCCESS != getDBCfg(pCxt, pRealTable->table.dbName, &dbCfg) ||
+      taosArrayGetSize(dbCfg.pRetensions) <= TSDB_RETENTION_L2) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  STableCfg* pTableCfg = NULL;
+  if (TSDB_CODE_SUCCESS == getTableCfg(pCxt, pName, &pTableCfg) && 1 == taosArrayGetSize(pTableCfg->pFuncs) &&
+      isSuitableRollupFunc(taosArrayGet(pTableCfg->pFuncs, 0))) {
+    setRollupLevelInfo(&dbCfg, pTableCfg, &pRealTable->rollupInfo);
+  }
+  tFreeSTableCfgRsp(pTableCfg);
+  taosMemoryFree(pTableCfg);
+  return TSDB_CODE_SUCCESS;
+}
+
+// The statistics only guide the choices of the planner, so the errors of getting them are ignored.
+static int32_t setTableStats(STranslateContext* pCxt, SName* pName, SRealTableNode* pRealTable) {
+  if (!tsQueryStatsOptimize || pCxt->createStream || TSDB_SUPER_TABLE != pRealTable->pMeta->tableType ||
+      !isSelectStmt(pCxt->pCurrStmt)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  STableCfg* pTableCfg = NULL;
+  if (TSDB_CODE_SUCCESS == getTableCfg(pCxt, pName, &pTableCfg) && NULL != pTableCfg->pStats) {
+    TSWAP(pRealTable->pStats, pTableCfg->pStats);
+  }
+  tFreeSTableCfgRsp(pTableCfg);
+  taosMemoryFree(pTableCfg);
+  return TSDB_CODE_SUCCESS;
+}
+
 static int32_t setTableCacheLastMode(STranslateContext* pCxt, SSelectStmt* pSelect) {
   if ((!pSelect->hasLastRowFunc && !pSelect->hasLastFunc) || QUERY_NODE_REAL_TABLE != nodeType(pSelect->pFromTable) ||
       TSDB_SYSTEM_TABLE == ((SRealTableNode*)pSelect->pFromTable)->pMeta->tableType) {
@@ -2437,6 +2492,12 @@ static int32_t translateTable(STranslateContext* pCxt, SNode* pTable) {
         if (TSDB_CODE_SUCCESS == code) {
           code = setTableIndex(pCxt, &name, pRealTable);
         }
+        if (TSDB_CODE_SUCCESS == code) {
+          code = setTableRollupInfo(pCxt, &name, pRealTable);
+        }
+        if (TSDB_CODE_SUCCESS == code) {
+          code = setTableStats(pCxt, &name, pRealTable);
+        }
       }
       if (TSDB_CODE_SUCCESS == code) {
         pRealTable->table.precision = pRealTable->pMeta->tableInfo.precision;
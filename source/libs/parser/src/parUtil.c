@@ -1017,6 +1017,7 @@ STableCfg* tableCfgDup(STableCfg* pCfg) {
     pNew->pTags = taosMemoryCalloc(pNew->tagsLen + 1, 1);
     memcpy(pNew->pTags, pCfg->pTags, pNew->tagsLen);
   }
+  pNew->pStats = tCloneTableStats(pCfg->pStats);
 
   int32_t schemaSize = (pCfg->numOfColumns + pCfg->numOfTags) * sizeof(SSchema);
 
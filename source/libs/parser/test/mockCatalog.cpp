@@ -222,6 +222,14 @@ void generateDatabases(MockCatalogService* mcs) {
   generateTestTables(g_mockCatalogService.get(), "cache_db");
   generateTestStables(g_mockCatalogService.get(), "cache_db");
   mcs->createDatabase("rollup_db", true);
+  // retentions 1s:10d,1m:30d,1h:365d
+  mcs->createRollupDatabase(
+      "rsma_db", {{1000, 864000000, 's', 'd'}, {60000, 2592000000, 'm', 'd'}, {3600000, 31536000000, 'h', 'd'}}, "avg");
+  generateTestStables(g_mockCatalogService.get(), "rsma_db");
+  mcs->createRollupDatabase(
+      "rsma_sum_db", {{1000, 864000000, 's', 'd'}, {60000, 2592000000, 'm', 'd'}, {3600000, 31536000000, 'h', 'd'}},
+      "sum");
+  generateTestStables(g_mockCatalogService.get(), "rsma_sum_db");
 }
 
 }  // namespace
@@ -308,8 +316,7 @@ int32_t __catalogGetDnodeList(SCatalog* pCatalog, SRequestConnInfo* pConn, SArra
 
 int32_t __catalogRefreshGetTableCfg(SCatalog* pCtg, SRequestConnInfo* pConn, const SName* pTableName,
                                     STableCfg** pCfg) {
-  *pCfg = (STableCfg*)taosMemoryCalloc(1, sizeof(STableCfg));
-  return 0;
+  return g_mockCatalogService->catalogGetTableCfg(pTableName, pCfg);
 }
 
 void initMetaDataEnv() {
@@ -356,6 +356,42 @@ class MockCatalogServiceImpl {
     dbCfg_.insert(std::make_pair(db, cfg));
   }
 
+  void createRollupDatabase(const string& db, const std::vector<SRetention>& retentions, const string& rollupFunc) {
+    SDbCfgInfo cfg = {0};
+    cfg.pRetensions = taosArrayInit(retentions.size(), sizeof(SRetention));
+    for (const auto& retention : retentions) {
+      taosArrayPush(cfg.pRetensions, &retention);
+    }
+    dbCfg_.insert(std::make_pair(db, cfg));
+    rollupFunc_.insert(std::make_pair(db, rollupFunc));
+  }
+
+  void setTableStats(const string& db, const string& tbname, const STableStats* pStats) {
+    if (nullptr == pStats) {
+      tableStats_.erase(db + "." + tbname);
+      return;
+    }
+    tableStats_[db + "." + tbname] = std::shared_ptr<STableStats>(tCloneTableStats(pStats), tFreeTableStats);
+  }
+
+  int32_t catalogGetTableCfg(const SName* pTableName, STableCfg** pTableCfg) const {
+    *pTableCfg = (STableCfg*)taosMemoryCalloc(1, sizeof(STableCfg));
+    auto it = rollupFunc_.find(pTableName->dbname);
+    if (rollupFunc_.end() != it) {
+      char func[TSDB_FUNC_NAME_LEN] = {0};
+      strcpy(func, it->second.c_str());
+      (*pTableCfg)->tableType = TSDB_SUPER_TABLE;
+      (*pTableCfg)->pFuncs = taosArrayInit(1, TSDB_FUNC_NAME_LEN);
+      taosArrayPush((*pTableCfg)->pFuncs, func);
+    }
+    auto stats = tableStats_.find(string(pTableName->dbname) + "." + pTableName->tname);
+    if (tableStats_.end() != stats) {
+      (*pTableCfg)->tableType = TSDB_SUPER_TABLE;
+      (*pTableCfg)->pStats = tCloneTableStats(stats->second.get());
+    }
+    return TSDB_CODE_SUCCESS;
+  }
+
  private:
   typedef std::map<string, std::shared_ptr<MockTableMeta>> TableMetaCache;
   typedef std::map<string, TableMetaCache>                 DbMetaCache;
@@ -363,6 +399,8 @@ class MockCatalogServiceImpl {
   typedef std::map<string, std::vector<STableIndexInfo>>   IndexMetaCache;
   typedef std::map<int32_t, SEpSet>                        DnodeCache;
   typedef std::map<string, SDbCfgInfo>                     DbCfgCache;
+  typedef std::map<string, string>                         RollupFuncCache;
+  typedef std::map<string, std::shared_ptr<STableStats>>   TableStatsCache;
 
   uint64_t getNextId() { return id_++; }
 
@@ -630,8 +668,7 @@ class MockCatalogServiceImpl {
       *pTableCfgData = taosArrayInit(ntables, sizeof(SMetaRes));
       for (int32_t i = 0; i < ntables; ++i) {
         SMetaRes res = {0};
-        res.pRes = taosMemoryCalloc(1, sizeof(STableCfg));
-        res.code = TSDB_CODE_SUCCESS;
+        res.code = catalogGetTableCfg((const SName*)taosArrayGet(pTableCfgReq, i), (STableCfg**)&res.pRes);
         taosArrayPush(*pTableCfgData, &res);
       }
     }
@@ -653,6 +690,8 @@ class MockCatalogServiceImpl {
   IndexMetaCache                index_;
   DnodeCache                    dnode_;
   DbCfgCache                    dbCfg_;
+  RollupFuncCache               rollupFunc_;
+  TableStatsCache               tableStats_;
   bool                          havaCache_;
 };
 
@@ -686,6 +725,15 @@ void MockCatalogService::createDatabase(const string& db, bool rollup, int8_t ca
   impl_->createDatabase(db, rollup, cacheLast);
 }
 
+void MockCatalogService::createRollupDatabase(const string& db, const std::vector<SRetention>& retentions,
+                                              const string& rollupFunc) {
+  impl_->createRollupDatabase(db, retentions, rollupFunc);
+}
+
+void MockCatalogService::setTableStats(const std::string& db, const std::string& tbname, const STableStats* pStats) {
+  impl_->setTableStats(db, tbname, pStats);
+}
+
 int32_t MockCatalogService::catalogGetTableMeta(const SName* pTableName, STableMeta** pTableMeta,
                                                 bool onlyCache) const {
   return impl_->catalogGetTableMeta(pTableName, pTableMeta, onlyCache);
@@ -718,6 +766,10 @@ int32_t MockCatalogService::catalogGetTableIndex(const SName* pTableName, SArray
 
 int32_t MockCatalogService::catalogGetDnodeList(SArray** pDnodes) const { return impl_->catalogGetDnodeList(pDnodes); }
 
+int32_t MockCatalogService::catalogGetTableCfg(const SName* pTableName, STableCfg** pTableCfg) const {
+  return impl_->catalogGetTableCfg(pTableName, pTableCfg);
+}
+
 int32_t MockCatalogService::catalogGetAllMeta(const SCatalogReq* pCatalogReq, SMetaData* pMetaData) const {
   return impl_->catalogGetAllMeta(pCatalogReq, pMetaData);
 }
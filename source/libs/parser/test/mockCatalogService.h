@@ -66,6 +66,9 @@ class MockCatalogService {
   void createSmaIndex(const SMCreateSmaReq* pReq);
   void createDnode(int32_t dnodeId, const std::string& host, int16_t port);
   void createDatabase(const std::string& db, bool rollup = false, int8_t cacheLast = 0);
+  void createRollupDatabase(const std::string& db, const std::vector<SRetention>& retentions,
+                            const std::string& rollupFunc);
+  void setTableStats(const std::string& db, const std::string& tbname, const STableStats* pStats);
 
   int32_t catalogGetTableMeta(const SName* pTableName, STableMeta** pTableMeta, bool onlyCache = false) const;
   int32_t catalogGetTableHashVgroup(const SName* pTableName, SVgroupInfo* vgInfo, bool onlyCache = false) const;
@@ -75,6 +78,7 @@ class MockCatalogService {
   int32_t catalogGetUdfInfo(const std::string& funcName, SFuncInfo* pInfo) const;
   int32_t catalogGetTableIndex(const SName* pTableName, SArray** pIndexes) const;
   int32_t catalogGetDnodeList(SArray** pDnodes) const;
+  int32_t catalogGetTableCfg(const SName* pTableName, STableCfg** pTableCfg) const;
   int32_t catalogGetAllMeta(const SCatalogReq* pCatalogReq, SMetaData* pMetaData) const;
 
  private:
@@ -93,6 +93,23 @@ TEST_F(ParserSelectTest, aggFunc) {
   useDb("root", "test");
 
   run("SELECT LEASTSQUARES(c1, -1, 1) FROM t1");
+
+  run("SELECT PERCENTILE(c1, 50), PERCENTILE(c1, 10, 50, 90) FROM t1");
+
+  run("SELECT PERCENTILE(c1, 99) FROM st1s1");
+}
+
+TEST_F(ParserSelectTest, aggFuncSemanticCheck) {
+  useDb("root", "test");
+
+  // the exact percentile is not merged across tables
+  run("SELECT PERCENTILE(c1, 50) FROM st1", TSDB_CODE_PAR_ONLY_SUPPORT_SINGLE_TABLE);
+
+  run("SELECT PERCENTILE(c1, 50) FROM t1 PARTITION BY c2", TSDB_CODE_PAR_ONLY_SUPPORT_SINGLE_TABLE);
+
+  run("SELECT PERCENTILE(c1, 50) FROM (SELECT * FROM t1)", TSDB_CODE_PAR_ONLY_SUPPORT_SINGLE_TABLE);
+
+  run("SELECT PERCENTILE(c1, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11) FROM t1", TSDB_CODE_FUNC_FUNTION_PARA_NUM);
 }
 
 TEST_F(ParserSelectTest, multiResFunc) {
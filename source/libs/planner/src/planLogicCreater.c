@@ -314,6 +314,7 @@ static int32_t makeScanLogicNode(SLogicPlanContext* pCxt, SRealTableNode* pRealT
 
   TSWAP(pScan->pVgroupList, pRealTable->pVgroupList);
   TSWAP(pScan->pSmaIndexes, pRealTable->pSmaIndexes);
+  TSWAP(pScan->pStats, pRealTable->pStats);
   pScan->tableId = pRealTable->pMeta->uid;
   pScan->stableId = pRealTable->pMeta->suid;
   pScan->tableType = pRealTable->pMeta->tableType;
@@ -328,6 +329,7 @@ static int32_t makeScanLogicNode(SLogicPlanContext* pCxt, SRealTableNode* pRealT
   pScan->ratio = pRealTable->ratio;
   pScan->dataRequired = FUNC_DATA_REQUIRED_DATA_LOAD;
   pScan->cacheLastMode = pRealTable->cacheLastMode;
+  pScan->rollupInfo = pRealTable->rollupInfo;
 
   *pLogicNode = (SLogicNode*)pScan;
 
@@ -406,6 +408,7 @@ static int32_t createJoinLogicNode(SLogicPlanContext* pCxt, SSelectStmt* pSelect
   }
 
   pJoin->joinType = pJoinTable->joinType;
+  pJoin->joinAlgo = JOIN_ALGO_MERGE;
   pJoin->isSingleTableJoin = pJoinTable->table.singleTable;
   pJoin->inputTsOrder = ORDER_ASC;
   pJoin->node.groupAction = GROUP_ACTION_CLEAR;
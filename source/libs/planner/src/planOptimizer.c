@@ -25,6 +25,18 @@
 #define OPTIMIZE_FLAG_SCAN_PATH       OPTIMIZE_FLAG_MASK(0)
 #define OPTIMIZE_FLAG_PUSH_DOWN_CONDE OPTIMIZE_FLAG_MASK(1)
 
+// above this many rows a full sort is not slower than maintaining the top-k heap
+#define OPTIMIZE_SORT_TOPK_MAX_ROWS 10000
+
+// assumed sizes used to compare the two children of a hash join when there are no statistics
+#define OPTIMIZE_JOIN_EST_TABLES_OF_STABLE 10000.0
+#define OPTIMIZE_JOIN_EST_ROWS_OF_TABLE    1000000.0
+
+// with statistics, the tag index is skipped if the tag condition is expected to keep more than this part of the
+// tables, or if there are no more tables than this, since a full tag scan is then not slower than the index lookup
+#define OPTIMIZE_TAG_INDEX_MAX_SELECTIVITY 0.3
+#define OPTIMIZE_TAG_INDEX_MIN_TABLES      1000
+
 #define OPTIMIZE_FLAG_SET_MASK(val, mask)  (val) |= (mask)
 #define OPTIMIZE_FLAG_TEST_MASK(val, mask) (((val) & (mask)) != 0)
 
@@ -168,7 +180,7 @@ static bool scanPathOptMayBeOptimized(SLogicNode* pNode) {
        WINDOW_TYPE_INTERVAL == ((SWindowLogicNode*)pNode->pParent)->winType) ||
       (QUERY_NODE_LOGIC_PLAN_PARTITION == nodeType(pNode->pParent) && pNode->pParent->pParent &&
        QUERY_NODE_LOGIC_PLAN_WINDOW == nodeType(pNode->pParent->pParent) &&
-       WINDOW_TYPE_INTERVAL == ((SWindowLogicNode*)pNode->pParent)->winType)) {
+       WINDOW_TYPE_INTERVAL == ((SWindowLogicNode*)pNode->pParent->pParent)->winType)) {
     return true;
   }
   if (QUERY_NODE_LOGIC_PLAN_AGG == nodeType(pNode->pParent)) {
@@ -446,6 +458,51 @@ static int32_t pushDownCondOptRebuildTbanme(SNode** pTagCond) {
   return code;
 }
 
+typedef struct SOptTagNdvCxt {
+  const STableStats* pStats;
+  int64_t            maxNdv;
+} SOptTagNdvCxt;
+
+static int64_t optGetTagNdv(const STableStats* pStats, col_id_t colId) {
+  for (int32_t i = 0; i < pStats->numOfTags; ++i) {
+    if (pStats->pTagNdv[i].colId == colId) {
+      return pStats->pTagNdv[i].ndv;
+    }
+  }
+  return -1;
+}
+
+static EDealRes optGetMaxTagNdvImpl(SNode* pNode, void* pContext) {
+  if (QUERY_NODE_COLUMN == nodeType(pNode) && COLUMN_TYPE_TAG == ((SColumnNode*)pNode)->colType) {
+    SOptTagNdvCxt* pCxt = pContext;
+    pCxt->maxNdv = TMAX(pCxt->maxNdv, optGetTagNdv(pCxt->pStats, ((SColumnNode*)pNode)->colId));
+  }
+  return DEAL_RES_CONTINUE;
+}
+
+// The largest number of distinct values of the tags in the condition, or -1 if none is known.
+static int64_t optGetMaxTagNdv(const STableStats* pStats, SNode* pTagCond) {
+  SOptTagNdvCxt cxt = {.pStats = pStats, .maxNdv = -1};
+  nodesWalkExpr(pTagCond, optGetMaxTagNdvImpl, &cxt);
+  return cxt.maxNdv;
+}
+
+// The tag index condition is also in the tag condition, so dropping it makes the tables filtered by a full tag scan.
+static void pushDownCondOptChooseTagIndex(SScanLogicNode* pScan) {
+  if (NULL == pScan->pStats || NULL == pScan->pTagIndexCond) {
+    return;
+  }
+  bool fullTagScan = pScan->pStats->numOfTables <= OPTIMIZE_TAG_INDEX_MIN_TABLES;
+  if (!fullTagScan) {
+    int64_t ndv = optGetMaxTagNdv(pScan->pStats, pScan->pTagIndexCond);
+    fullTagScan = (ndv > 0 && 1.0 / ndv > OPTIMIZE_TAG_INDEX_MAX_SELECTIVITY);
+  }
+  if (fullTagScan) {
+    nodesDestroyNode(pScan->pTagIndexCond);
+    pScan->pTagIndexCond = NULL;
+  }
+}
+
 static int32_t pushDownCondOptDealScan(SOptimizeContext* pCxt, SScanLogicNode* pScan) {
   if (NULL == pScan->node.pConditions ||
       OPTIMIZE_FLAG_TEST_MASK(pScan->node.optimizedFlag, OPTIMIZE_FLAG_PUSH_DOWN_CONDE) ||
@@ -460,6 +517,9 @@ static int32_t pushDownCondOptDealScan(SOptimizeContext* pCxt, SScanLogicNode* p
   if (TSDB_CODE_SUCCESS == code && NULL != pScan->pTagCond) {
     code = pushDownCondOptRebuildTbanme(&pScan->pTagCond);
   }
+  if (TSDB_CODE_SUCCESS == code) {
+    pushDownCondOptChooseTagIndex(pScan);
+  }
   if (TSDB_CODE_SUCCESS == code && NULL != pPrimaryKeyCond) {
     code = pushDownCondOptCalcTimeRange(pCxt, pScan, &pPrimaryKeyCond, &pOtherCond);
   }
@@ -727,7 +787,205 @@ static int32_t pushDownCondOptPartJoinOnCond(SJoinLogicNode* pJoin, SNode** ppMe
   }
 }
 
+// t1.c1 = t2.c1, where the columns of the same type come from different children of the join
+static bool hashJoinOptIsEquiCond(SJoinLogicNode* pJoin, SNode* pCond, SNode** pLeftKey, SNode** pRightKey) {
+  if (QUERY_NODE_OPERATOR != nodeType(pCond) || OP_TYPE_EQUAL != ((SOperatorNode*)pCond)->opType) {
+    return false;
+  }
+
+  SOperatorNode* pOper = (SOperatorNode*)pCond;
+  if (QUERY_NODE_COLUMN != nodeType(pOper->pLeft) || QUERY_NODE_COLUMN != nodeType(pOper->pRight)) {
+    return false;
+  }
+  uint8_t type = ((SColumnNode*)pOper->pLeft)->node.resType.type;
+  if (type != ((SColumnNode*)pOper->pRight)->node.resType.type || TSDB_DATA_TYPE_JSON == type) {
+    return false;
+  }
+
+  SNodeList* pLeftCols = ((SLogicNode*)nodesListGetNode(pJoin->node.pChildren, 0))->pTargets;
+  SNodeList* pRightCols = ((SLogicNode*)nodesListGetNode(pJoin->node.pChildren, 1))->pTargets;
+  if (pushDownCondOptBelongThisTable(pOper->pLeft, pLeftCols) &&
+      pushDownCondOptBelongThisTable(pOper->pRight, pRightCols)) {
+    *pLeftKey = pOper->pLeft;
+    *pRightKey = pOper->pRight;
+    return true;
+  }
+  if (pushDownCondOptBelongThisTable(pOper->pLeft, pRightCols) &&
+      pushDownCondOptBelongThisTable(pOper->pRight, pLeftCols)) {
+    *pLeftKey = pOper->pRight;
+    *pRightKey = pOper->pLeft;
+    return true;
+  }
+  return false;
+}
+
+static bool hashJoinOptContainEquiCond(SJoinLogicNode* pJoin, SNode* pCond) {
+  SNode* pLeftKey = NULL;
+  SNode* pRightKey = NULL;
+  if (QUERY_NODE_LOGIC_CONDITION == nodeType(pCond) &&
+      LOGIC_COND_TYPE_AND == ((SLogicConditionNode*)pCond)->condType) {
+    SNode* pSubCond = NULL;
+    FOREACH(pSubCond, ((SLogicConditionNode*)pCond)->pParameterList) {
+      if (hashJoinOptIsEquiCond(pJoin, pSubCond, &pLeftKey, &pRightKey)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return hashJoinOptIsEquiCond(pJoin, pCond, &pLeftKey, &pRightKey);
+}
+
+// Without an equal condition on the primary keys the join cannot be merged by timestamp. It is done by a hash join
+// if there are equal conditions on other columns and the upper operators do not need the output in time order.
+static bool hashJoinOptMayBeUsed(SOptimizeContext* pCxt, SJoinLogicNode* pJoin) {
+  if (pCxt->pPlanCxt->streamQuery || NULL == pJoin->pOnConditions ||
+      pushDownCondOptContainPriKeyEqualCond(pJoin, pJoin->pOnConditions)) {
+    return false;
+  }
+  if (NULL != pJoin->node.pParent && DATA_ORDER_LEVEL_NONE != pJoin->node.pParent->requireDataOrder) {
+    return false;
+  }
+  return hashJoinOptContainEquiCond(pJoin, pJoin->pOnConditions);
+}
+
+// Tag conditions are assumed to keep the tables of one value of their most selective tag, and the rows to be spread
+// evenly over the tables and over the reported time range.
+static double hashJoinOptEstimateScanRowsByStats(SScanLogicNode* pScan) {
+  const STableStats* pStats = pScan->pStats;
+  double             tables = TMAX(pStats->numOfTables, 1);
+  if (NULL != pScan->pTagCond) {
+    int64_t ndv = optGetMaxTagNdv(pStats, pScan->pTagCond);
+    tables = (ndv > 0 ? tables / ndv : tables / 10);
+  }
+  if (SCAN_TYPE_TAG == pScan->scanType) {
+    return tables;
+  }
+  double  rows = tables * pStats->numOfRows / TMAX(pStats->numOfTables, 1);
+  int64_t span = getScanStatsTimeSpan(pScan);
+  if (span >= 0) {
+    rows = rows * span / (pStats->ekey - pStats->skey + 1);
+  }
+  if (NULL != pScan->node.pConditions) {
+    rows /= 2;
+  }
+  return rows;
+}
+
+// A rough estimate of the rows of the subtree, only used to compare the children of a join.
+static double hashJoinOptEstimateRows(SLogicNode* pNode) {
+  double rows = 0;
+  switch (nodeType(pNode)) {
+    case QUERY_NODE_LOGIC_PLAN_SCAN: {
+      SScanLogicNode* pScan = (SScanLogicNode*)pNode;
+      if (NULL != pScan->pStats) {
+        rows = hashJoinOptEstimateScanRowsByStats(pScan);
+        break;
+      }
+      double tables = (TSDB_SUPER_TABLE == pScan->tableType ? OPTIMIZE_JOIN_EST_TABLES_OF_STABLE : 1);
+      if (NULL != pScan->pTagCond || NULL != pScan->pTagIndexCond) {
+        tables = TMAX(tables / 10, 1);
+      }
+      if (SCAN_TYPE_TAG == pScan->scanType) {
+        rows = tables;
+        break;
+      }
+      rows = tables * OPTIMIZE_JOIN_EST_ROWS_OF_TABLE;
+      if (TSKEY_MIN != pScan->scanRange.skey || TSKEY_MAX != pScan->scanRange.ekey) {
+        rows /= 10;
+      }
+      if (NULL != pScan->node.pConditions) {
+        rows /= 2;
+      }
+      break;
+    }
+    case QUERY_NODE_LOGIC_PLAN_AGG:
+      rows = (NULL == ((SAggLogicNode*)pNode)->pGroupKeys
+                  ? 1
+                  : hashJoinOptEstimateRows((SLogicNode*)nodesListGetNode(pNode->pChildren, 0)) / 10);
+      break;
+    case QUERY_NODE_LOGIC_PLAN_WINDOW:
+      rows = hashJoinOptEstimateRows((SLogicNode*)nodesListGetNode(pNode->pChildren, 0)) / 100;
+      break;
+    default: {
+      SNode* pChild = NULL;
+      FOREACH(pChild, pNode->pChildren) { rows = TMAX(rows, hashJoinOptEstimateRows((SLogicNode*)pChild)); }
+      break;
+    }
+  }
+
+  if (NULL != pNode->pLimit) {
+    SLimitNode* pLimit = (SLimitNode*)pNode->pLimit;
+    rows = TMIN(rows, (double)pLimit->limit + pLimit->offset);
+  }
+  return TMAX(rows, 1);
+}
+
+// the hash table is built from the smaller child, the right one if they are alike
+static int8_t hashJoinOptChooseBuildSide(SJoinLogicNode* pJoin) {
+  double leftRows = hashJoinOptEstimateRows((SLogicNode*)nodesListGetNode(pJoin->node.pChildren, 0));
+  double rightRows = hashJoinOptEstimateRows((SLogicNode*)nodesListGetNode(pJoin->node.pChildren, 1));
+  return leftRows < rightRows ? 0 : 1;
+}
+
+static int32_t hashJoinOptPartCond(SJoinLogicNode* pJoin, SNode* pCond, SNodeList** pOnConds) {
+  SNode* pLeftKey = NULL;
+  SNode* pRightKey = NULL;
+  if (!hashJoinOptIsEquiCond(pJoin, pCond, &pLeftKey, &pRightKey)) {
+    return nodesListMakeStrictAppend(pOnConds, nodesCloneNode(pCond));
+  }
+  int32_t code = nodesListMakeStrictAppend(&pJoin->pLeftKeys, nodesCloneNode(pLeftKey));
+  if (TSDB_CODE_SUCCESS == code) {
+    code = nodesListMakeStrictAppend(&pJoin->pRightKeys, nodesCloneNode(pRightKey));
+  }
+  return code;
+}
+
+static int32_t hashJoinOptExtractKeys(SOptimizeContext* pCxt, SJoinLogicNode* pJoin) {
+  int32_t    code = TSDB_CODE_SUCCESS;
+  SNodeList* pOnConds = NULL;
+  if (QUERY_NODE_LOGIC_CONDITION == nodeType(pJoin->pOnConditions)) {
+    SNode* pCond = NULL;
+    FOREACH(pCond, ((SLogicConditionNode*)pJoin->pOnConditions)->pParameterList) {
+      code = hashJoinOptPartCond(pJoin, pCond, &pOnConds);
+      if (TSDB_CODE_SUCCESS != code) {
+        break;
+      }
+    }
+  } else {
+    code = hashJoinOptPartCond(pJoin, pJoin->pOnConditions, &pOnConds);
+  }
+
+  SNode* pOnCond = NULL;
+  if (TSDB_CODE_SUCCESS == code) {
+    code = nodesMergeConds(&pOnCond, &pOnConds);
+  }
+  if (TSDB_CODE_SUCCESS != code) {
+    nodesDestroyList(pOnConds);
+    return code;
+  }
+
+  nodesDestroyNode(pJoin->pOnConditions);
+  pJoin->pOnConditions = pOnCond;
+  pJoin->joinAlgo = JOIN_ALGO_HASH;
+  pJoin->buildSide = hashJoinOptChooseBuildSide(pJoin);
+  pJoin->node.requireDataOrder = DATA_ORDER_LEVEL_NONE;
+  pJoin->node.resultDataOrder = DATA_ORDER_LEVEL_NONE;
+
+  SNode* pChild = NULL;
+  FOREACH(pChild, pJoin->node.pChildren) {
+    code = adjustLogicNodeDataRequirement((SLogicNode*)pChild, DATA_ORDER_LEVEL_NONE);
+    if (TSDB_CODE_SUCCESS != code) {
+      break;
+    }
+  }
+  return code;
+}
+
 static int32_t pushDownCondOptJoinExtractMergeCond(SOptimizeContext* pCxt, SJoinLogicNode* pJoin) {
+  if (hashJoinOptMayBeUsed(pCxt, pJoin)) {
+    return hashJoinOptExtractKeys(pCxt, pJoin);
+  }
+
   int32_t code = pushDownCondOptCheckJoinOnCond(pCxt, pJoin);
   SNode*  pJoinMergeCond = NULL;
   SNode*  pJoinOnCond = NULL;
@@ -1098,6 +1356,10 @@ static int32_t sortPriKeyOptGetSequencingNodesImpl(SLogicNode* pNode, bool* pNot
       return nodesListMakeAppend(pSequencingNodes, (SNode*)pNode);
     }
     case QUERY_NODE_LOGIC_PLAN_JOIN: {
+      if (JOIN_ALGO_HASH == ((SJoinLogicNode*)pNode)->joinAlgo) {
+        *pNotOptimize = true;
+        return TSDB_CODE_SUCCESS;
+      }
       int32_t code = sortPriKeyOptGetSequencingNodesImpl((SLogicNode*)nodesListGetNode(pNode->pChildren, 0),
                                                          pNotOptimize, pSequencingNodes);
       if (TSDB_CODE_SUCCESS == code) {
@@ -1371,6 +1633,79 @@ static int32_t smaIndexOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLogicSub
   return smaIndexOptimizeImpl(pCxt, pLogicSubplan, pScan);
 }
 
+static bool rollupSmaOptMayBeOptimized(SLogicNode* pNode) {
+  if (QUERY_NODE_LOGIC_PLAN_SCAN != nodeType(pNode) || NULL == pNode->pParent ||
+      QUERY_NODE_LOGIC_PLAN_WINDOW != nodeType(pNode->pParent) ||
+      WINDOW_TYPE_INTERVAL != ((SWindowLogicNode*)pNode->pParent)->winType) {
+    return false;
+  }
+
+  SScanLogicNode* pScan = (SScanLogicNode*)pNode;
+  return SCAN_TYPE_TABLE == pScan->scanType && '\0' != pScan->rollupInfo.funcName[0] &&
+         TSDB_RETENTION_L0 == pScan->rollupLevel && NULL == pScan->node.pConditions;
+}
+
+// Each rolled-up row holds the rollup function of the column over a period of the level, so the query function must
+// be the same function on a column, and each query window must be made up of the whole periods. The tags are the same
+// in the rolled-up rows, so they can still be the group keys.
+static bool rollupSmaOptIsSuitableFunc(SNode* pNode, const char* pRollupFunc) {
+  SFunctionNode* pFunc = (SFunctionNode*)pNode;
+  if (fmIsWindowPseudoColumnFunc(pFunc->funcId)) {
+    return true;
+  }
+  if (fmIsGroupKeyFunc(pFunc->funcId)) {
+    SNode* pParam = nodesListGetNode(pFunc->pParameterList, 0);
+    return QUERY_NODE_COLUMN == nodeType(pParam) && (COLUMN_TYPE_TAG == ((SColumnNode*)pParam)->colType ||
+                                                     COLUMN_TYPE_TBNAME == ((SColumnNode*)pParam)->colType);
+  }
+  if (0 != strcmp(pFunc->functionName, pRollupFunc) || 1 != LIST_LENGTH(pFunc->pParameterList)) {
+    return false;
+  }
+  SNode* pParam = nodesListGetNode(pFunc->pParameterList, 0);
+  return QUERY_NODE_COLUMN == nodeType(pParam) && COLUMN_TYPE_COLUMN == ((SColumnNode*)pParam)->colType &&
+         PRIMARYKEY_TIMESTAMP_COL_ID != ((SColumnNode*)pParam)->colId;
+}
+
+static bool rollupSmaOptIsSuitableInterval(SWindowLogicNode* pWindow, int64_t freq) {
+  return freq > 0 && TIME_UNIT_MONTH != pWindow->intervalUnit && TIME_UNIT_YEAR != pWindow->intervalUnit &&
+         TIME_UNIT_MONTH != pWindow->slidingUnit && TIME_UNIT_YEAR != pWindow->slidingUnit &&
+         0 == pWindow->interval % freq && 0 == pWindow->sliding % freq && 0 == pWindow->offset % freq;
+}
+
+static int8_t rollupSmaOptSelectLevel(SScanLogicNode* pScan, SWindowLogicNode* pWindow) {
+  SNode* pFunc = NULL;
+  FOREACH(pFunc, pWindow->pFuncs) {
+    if (!rollupSmaOptIsSuitableFunc(pFunc, pScan->rollupInfo.funcName)) {
+      return TSDB_RETENTION_L0;
+    }
+  }
+
+  for (int8_t level = TSDB_RETENTION_L2; level > TSDB_RETENTION_L0; --level) {
+    if (rollupSmaOptIsSuitableInterval(pWindow, pScan->rollupInfo.freq[level - 1])) {
+      return level;
+    }
+  }
+  return TSDB_RETENTION_L0;
+}
+
+static int32_t rollupSmaOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLogicSubplan) {
+  if (pCxt->pPlanCxt->streamQuery) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SScanLogicNode* pScan = (SScanLogicNode*)optFindPossibleNode(pLogicSubplan->pNode, rollupSmaOptMayBeOptimized);
+  if (NULL == pScan) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int8_t level = rollupSmaOptSelectLevel(pScan, (SWindowLogicNode*)pScan->node.pParent);
+  if (TSDB_RETENTION_L0 != level) {
+    pScan->rollupLevel = level;
+    pCxt->optimized = true;
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
 static EDealRes partTagsOptHasColImpl(SNode* pNode, void* pContext) {
   if (QUERY_NODE_COLUMN == nodeType(pNode)) {
     if (COLUMN_TYPE_TAG != ((SColumnNode*)pNode)->colType && COLUMN_TYPE_TBNAME != ((SColumnNode*)pNode)->colType) {
@@ -2448,7 +2783,7 @@ static int32_t tagScanOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLogicSubp
 }
 
 static bool pushDownLimitOptShouldBeOptimized(SLogicNode* pNode) {
-  if (NULL == pNode->pLimit || 1 != LIST_LENGTH(pNode->pChildren) ||
+  if (NULL == pNode->pLimit || 1 != LIST_LENGTH(pNode->pChildren) || QUERY_NODE_LOGIC_PLAN_SORT == nodeType(pNode) ||
       QUERY_NODE_LOGIC_PLAN_SCAN != nodeType(nodesListGetNode(pNode->pChildren, 0))) {
     return false;
   }
@@ -2470,6 +2805,43 @@ static int32_t pushDownLimitOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLog
   return TSDB_CODE_SUCCESS;
 }
 
+static bool sortTopKOptMayBeOptimized(SLogicNode* pNode) {
+  if (QUERY_NODE_LOGIC_PLAN_SORT != nodeType(pNode) || ((SSortLogicNode*)pNode)->groupSort || NULL != pNode->pLimit ||
+      NULL != pNode->pConditions || NULL == pNode->pParent) {
+    return false;
+  }
+
+  SLogicNode* pParent = pNode->pParent;
+  if (QUERY_NODE_LOGIC_PLAN_PROJECT != nodeType(pParent) || NULL == pParent->pLimit || NULL != pParent->pSlimit ||
+      NULL != pParent->pConditions) {
+    return false;
+  }
+
+  SLimitNode* pLimit = (SLimitNode*)pParent->pLimit;
+  return pLimit->limit > 0 && pLimit->limit + pLimit->offset <= OPTIMIZE_SORT_TOPK_MAX_ROWS;
+}
+
+// The sort node only needs to produce the first 'limit + offset' rows for the project node above it, which lets the
+// executor select them with a bounded heap. When the sort is split for a super table, the limit is copied to the sort
+// node of each vnode, so every vnode returns only its own top rows to the merge node.
+static int32_t sortTopKOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLogicSubplan) {
+  SLogicNode* pSort = optFindPossibleNode(pLogicSubplan->pNode, sortTopKOptMayBeOptimized);
+  if (NULL == pSort) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SLimitNode* pLimit = (SLimitNode*)nodesCloneNode(pSort->pParent->pLimit);
+  if (NULL == pLimit) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pLimit->limit += pLimit->offset;
+  pLimit->offset = 0;
+  pSort->pLimit = (SNode*)pLimit;
+  pCxt->optimized = true;
+
+  return TSDB_CODE_SUCCESS;
+}
+
 typedef struct STbCntScanOptInfo {
   SAggLogicNode*  pAgg;
   SScanLogicNode* pScan;
@@ -2713,6 +3085,7 @@ static const SOptimizeRule optimizeRuleSet[] = {
   {.pName = "PushDownCondition",          .optimizeFunc = pushDownCondOptimize},
   {.pName = "SortPrimaryKey",             .optimizeFunc = sortPrimaryKeyOptimize},
   {.pName = "SmaIndex",                   .optimizeFunc = smaIndexOptimize},
+  {.pName = "RollupSma",                  .optimizeFunc = rollupSmaOptimize},
   {.pName = "PartitionTags",              .optimizeFunc = partTagsOptimize},
   {.pName = "MergeProjects",              .optimizeFunc = mergeProjectsOptimize},
   {.pName = "EliminateProject",           .optimizeFunc = eliminateProjOptimize},
@@ -2722,6 +3095,7 @@ static const SOptimizeRule optimizeRuleSet[] = {
   {.pName = "LastRowScan",                .optimizeFunc = lastRowScanOptimize},
   {.pName = "TagScan",                    .optimizeFunc = tagScanOptimize},
   {.pName = "PushDownLimit",              .optimizeFunc = pushDownLimitOptimize},
+  {.pName = "SortTopK",                   .optimizeFunc = sortTopKOptimize},
   {.pName = "TableCountScan",             .optimizeFunc = tableCountScanOptimize},
 };
 // clang-format on
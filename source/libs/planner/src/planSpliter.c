@@ -16,6 +16,7 @@
 #include "functionMgt.h"
 #include "planInt.h"
 #include "tglobal.h"
+#include "ttime.h"
 
 #define SPLIT_FLAG_MASK(n) (1 << n)
 
@@ -25,6 +26,9 @@
 #define SPLIT_FLAG_SET_MASK(val, mask)  (val) |= (mask)
 #define SPLIT_FLAG_TEST_MASK(val, mask) (((val) & (mask)) != 0)
 
+// below this many windows open at once over all partitions, the hash interval does not need the merged table scan
+#define SPLIT_TUMBLE_WINDOW_MIN_OPEN_WINDOWS 100000.0
+
 typedef struct SSplitContext {
   SPlanContext* pPlanCxt;
   uint64_t      queryId;
@@ -758,12 +762,56 @@ static bool stbSplNeedSeqRecvData(SLogicNode* pNode) {
   return stbSplNeedSeqRecvData(pNode->pParent);
 }
 
+// With statistics, the number of windows the hash interval keeps open is estimated as the windows of the reported time
+// range for every table. If that is small the merge of the tables by timestamp costs more than it saves.
+static bool stbSplTumbleWindowNeedMerge(SWindowLogicNode* pWindow, SScanLogicNode* pScan) {
+  if (TIME_UNIT_MONTH == pWindow->intervalUnit || TIME_UNIT_YEAR == pWindow->intervalUnit || pWindow->interval <= 0) {
+    return true;
+  }
+  int64_t span = getScanStatsTimeSpan(pScan);
+  if (span < 0) {
+    return true;
+  }
+  double windows = (double)span / pWindow->interval + 1;
+  return windows * pScan->pStats->numOfTables >= SPLIT_TUMBLE_WINDOW_MIN_OPEN_WINDOWS;
+}
+
+// The tumbling windows of each partition can be computed one window after another on the rows of the partition merged by
+// timestamp, so that only the window open in the current partition is kept, instead of all windows of all partitions.
+static bool stbSplIsPartTableTumbleWindow(SWindowLogicNode* pWindow) {
+  if (WINDOW_TYPE_INTERVAL != pWindow->winType || pWindow->interval != pWindow->sliding ||
+      pWindow->intervalUnit != pWindow->slidingUnit) {
+    return false;
+  }
+  SNode* pChild = nodesListGetNode(pWindow->node.pChildren, 0);
+  if (QUERY_NODE_LOGIC_PLAN_SCAN != nodeType(pChild)) {
+    return false;
+  }
+  SScanLogicNode* pScan = (SScanLogicNode*)pChild;
+  if (SCAN_TYPE_TABLE != pScan->scanType || NULL == pScan->pGroupTags ||
+      (pScan->scanSeq[0] > 0 && pScan->scanSeq[1] > 0)) {
+    return false;
+  }
+  SNode* pFunc = NULL;
+  FOREACH(pFunc, pWindow->pFuncs) {
+    if (fmIsIntervalInterpoFunc(((SFunctionNode*)pFunc)->funcId)) {
+      return false;
+    }
+  }
+  return stbSplTumbleWindowNeedMerge(pWindow, pScan);
+}
+
 static int32_t stbSplSplitWindowForPartTable(SSplitContext* pCxt, SStableSplitInfo* pInfo) {
   if (pCxt->pPlanCxt->streamQuery) {
     SPLIT_FLAG_SET_MASK(pInfo->pSubplan->splitFlag, SPLIT_FLAG_STABLE_SPLIT);
     return TSDB_CODE_SUCCESS;
   }
 
+  if (stbSplIsPartTableTumbleWindow((SWindowLogicNode*)pInfo->pSplitNode)) {
+    ((SWindowLogicNode*)pInfo->pSplitNode)->windowAlgo = INTERVAL_ALGO_MERGE;
+    stbSplSetTableMergeScan((SLogicNode*)nodesListGetNode(pInfo->pSplitNode->pChildren, 0));
+  }
+
   if (NULL != pInfo->pSplitNode->pParent && QUERY_NODE_LOGIC_PLAN_FILL == nodeType(pInfo->pSplitNode->pParent)) {
     pInfo->pSplitNode = pInfo->pSplitNode->pParent;
   }
@@ -1140,11 +1188,24 @@ static int32_t stbSplSplitScanNode(SSplitContext* pCxt, SStableSplitInfo* pInfo)
   return stbSplSplitScanNodeWithoutPartTags(pCxt, pInfo);
 }
 
+// the hash join does not need its input in time order, the data of all vgroups is just exchanged
+static int32_t stbSplSplitHashJoinScanNode(SSplitContext* pCxt, SLogicSubplan* pSubplan, SScanLogicNode* pScan) {
+  int32_t code = splCreateExchangeNodeForSubplan(pCxt, pSubplan, (SLogicNode*)pScan, SUBPLAN_TYPE_MERGE);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = nodesListMakeStrictAppend(&pSubplan->pChildren,
+                                     (SNode*)splCreateScanSubplan(pCxt, (SLogicNode*)pScan, SPLIT_FLAG_STABLE_SPLIT));
+  }
+  ++(pCxt->groupId);
+  return code;
+}
+
 static int32_t stbSplSplitJoinNodeImpl(SSplitContext* pCxt, SLogicSubplan* pSubplan, SJoinLogicNode* pJoin) {
   int32_t code = TSDB_CODE_SUCCESS;
   SNode*  pChild = NULL;
   FOREACH(pChild, pJoin->node.pChildren) {
-    if (QUERY_NODE_LOGIC_PLAN_SCAN == nodeType(pChild)) {
+    if (QUERY_NODE_LOGIC_PLAN_SCAN == nodeType(pChild) && JOIN_ALGO_HASH == pJoin->joinAlgo) {
+      code = stbSplSplitHashJoinScanNode(pCxt, pSubplan, (SScanLogicNode*)pChild);
+    } else if (QUERY_NODE_LOGIC_PLAN_SCAN == nodeType(pChild)) {
       code = stbSplSplitMergeScanNode(pCxt, pSubplan, (SScanLogicNode*)pChild, false);
     } else if (QUERY_NODE_LOGIC_PLAN_JOIN == nodeType(pChild)) {
       code = stbSplSplitJoinNodeImpl(pCxt, pSubplan, (SJoinLogicNode*)pChild);
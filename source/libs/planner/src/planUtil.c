@@ -307,3 +307,14 @@ int32_t adjustLogicNodeDataRequirement(SLogicNode* pNode, EDataOrderLevel requir
   }
   return code;
 }
+
+// The time span of the reported data of the table within the scan range, or -1 if there are no statistics.
+int64_t getScanStatsTimeSpan(SScanLogicNode* pScan) {
+  STableStats* pStats = pScan->pStats;
+  if (NULL == pStats || 0 == pStats->numOfRows || pStats->skey > pStats->ekey) {
+    return -1;
+  }
+  TSKEY skey = TMAX(pStats->skey, pScan->scanRange.skey);
+  TSKEY ekey = TMIN(pStats->ekey, pScan->scanRange.ekey);
+  return skey > ekey ? 0 : ekey - skey + 1;
+}
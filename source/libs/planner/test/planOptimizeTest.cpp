@@ -15,6 +15,7 @@
 
 #include "planTestUtil.h"
 #include "planner.h"
+#include "tglobal.h"
 
 using namespace std;
 
@@ -37,6 +38,10 @@ TEST_F(PlanOptimizeTest, scanPath) {
       "FILL(LINEAR)");
 
   run("SELECT COUNT(TBNAME) FROM t1");
+
+  run("SELECT COUNT(*), SUM(c1), MIN(c1), MAX(c1) FROM t1 INTERVAL(1h)");
+
+  run("SELECT COUNT(*) FROM st1 PARTITION BY TBNAME INTERVAL(1h)");
 }
 
 TEST_F(PlanOptimizeTest, pushDownCondition) {
@@ -75,6 +80,46 @@ TEST_F(PlanOptimizeTest, sortPrimaryKey) {
       "FILL(LINEAR) ORDER BY _WSTART");
 }
 
+TEST_F(PlanOptimizeTest, rollupSma) {
+  // retentions 1s:10d,1m:30d,1h:365d
+  useDb("root", "rsma_sum_db");
+  tsQuerySmaOptimize = 1;
+
+  run("SELECT SUM(c1) FROM st1 INTERVAL(1h)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L2);
+
+  run("SELECT _WSTART, SUM(c1), tag1 FROM st1 WHERE ts > NOW - 90d PARTITION BY tag1 INTERVAL(10m) SLIDING(5m)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L1);
+
+  run("SELECT _WSTART, _WEND, SUM(c1) FROM st1 WHERE ts > NOW - 90d INTERVAL(10m) SLIDING(5m)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L1);
+
+  run("SELECT SUM(c1) FROM st1 INTERVAL(10s)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L0);
+
+  run("SELECT MAX(c1) FROM st1 INTERVAL(1h)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L0);
+
+  run("SELECT SUM(c1) FROM st1 WHERE c1 > 10 INTERVAL(1h)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L0);
+
+  run("EXPLAIN VERBOSE TRUE SELECT SUM(c1) FROM st1 INTERVAL(1h)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L2);
+
+  // the avg of the rolled-up averages is approximate, which is only used if it is accepted
+  useDb("root", "rsma_db");
+  run("SELECT AVG(c1) FROM st1 INTERVAL(1h)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L0);
+
+  tsQuerySmaOptimize = 2;
+  run("SELECT AVG(c1) FROM st1 INTERVAL(1h)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L2);
+
+  tsQuerySmaOptimize = 0;
+  run("SELECT AVG(c1) FROM st1 INTERVAL(1h)");
+  EXPECT_EQ(getRollupLevel(), TSDB_RETENTION_L0);
+}
+
 TEST_F(PlanOptimizeTest, PartitionTags) {
   useDb("root", "test");
 
@@ -151,3 +196,54 @@ TEST_F(PlanOptimizeTest, pushDownLimit) {
 
   run("SELECT c1 FROM st1 LIMIT 20 OFFSET 10");
 }
+
+TEST_F(PlanOptimizeTest, tableStats) {
+  useDb("root", "test");
+  tsQueryStatsOptimize = true;
+
+  // tag1, which is indexed, has many distinct values
+  STagNdv     tagNdv[] = {{.colId = 4, .ndv = 5000}, {.colId = 5, .ndv = 2}};
+  STableStats stats = {.numOfTables = 10000,
+                       .numOfRows = 100000000,
+                       .skey = 1656633600000,
+                       .ekey = 1659312000000,
+                       .numOfTags = 2,
+                       .pTagNdv = tagNdv};
+  setTableStats("st1", &stats);
+
+  // the tag index is kept for a selective tag condition
+  run("SELECT ts, c1 FROM st1 WHERE tag1 = 1");
+
+  run("SELECT ts, c1 FROM st1 WHERE tag1 = 1 AND tag2 = 'hello'");
+
+  // and dropped for the tags of a few tables, or for a tag of few values, which are scanned in full
+  stats.numOfTables = 100;
+  setTableStats("st1", &stats);
+  run("SELECT ts, c1 FROM st1 WHERE tag1 = 1");
+
+  stats.numOfTables = 10000;
+  tagNdv[0].ndv = 2;
+  setTableStats("st1", &stats);
+  run("SELECT ts, c1 FROM st1 WHERE tag1 = 1");
+
+  // the hash join builds on the side estimated smaller from the rows, the tag conditions and the time range
+  STableStats stats2 = {.numOfTables = 10, .numOfRows = 1000, .skey = 1656633600000, .ekey = 1659312000000};
+  setTableStats("st2", &stats2);
+  run("SELECT t1.c1, t2.c2 FROM st1 t1 JOIN st2 t2 ON t1.c1 = t2.c1");
+
+  run("SELECT t1.c1, t2.c2 FROM st2 t2 JOIN st1 t1 ON t1.c1 = t2.c1");
+
+  run("SELECT t1.c1, t2.c2 FROM st1 t1 JOIN st2 t2 ON t1.c1 = t2.c1 "
+      "WHERE t1.tag2 = 'hello' AND t1.ts > '2022-07-31 23:00:00'");
+
+  stats2.numOfRows = 1000000000000;
+  setTableStats("st2", &stats2);
+  run("SELECT t1.c1, t2.c2 FROM st1 t1 JOIN st2 t2 ON t1.c1 = t2.c1");
+
+  // a super table without stats is estimated as before
+  setTableStats("st2", NULL);
+  run("SELECT t1.c1, t2.c2 FROM st1 t1 JOIN st2 t2 ON t1.c1 = t2.c1");
+
+  setTableStats("st1", NULL);
+  tsQueryStatsOptimize = false;
+}
@@ -74,3 +74,14 @@ TEST_F(PlanOrderByTest, stable) {
 
   run("SELECT c1 AS a FROM st1 ORDER BY a");
 }
+
+TEST_F(PlanOrderByTest, topK) {
+  useDb("root", "test");
+
+  run("SELECT c1 FROM t1 ORDER BY c2 LIMIT 10");
+
+  run("SELECT c1 FROM t1 ORDER BY c2 DESC LIMIT 10 OFFSET 20");
+
+  // each vnode sorts out only its own top 'limit + offset' rows
+  run("SELECT c1 FROM st1 ORDER BY c2 LIMIT 10 OFFSET 5");
+}
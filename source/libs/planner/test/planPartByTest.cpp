@@ -15,6 +15,7 @@
 
 #include "planTestUtil.h"
 #include "planner.h"
+#include "tglobal.h"
 
 using namespace std;
 
@@ -53,6 +54,10 @@ TEST_F(PlanPartitionByTest, withInterval) {
   run("select count(*) from st1 partition by tag1, tag2 interval(10s)");
 
   run("select count(*), tag1 from st1 partition by tag1, tag2 interval(10s)");
+
+  run("select count(*), sum(c1) from st1 partition by tbname interval(10s)");
+
+  run("select count(*) from st1 partition by tbname interval(10s) fill(prev)");
 }
 
 TEST_F(PlanPartitionByTest, withGroupBy) {
@@ -78,3 +83,29 @@ TEST_F(PlanPartitionByTest, withSlimit) {
 
   run("SELECT CSUM(c1) FROM st1 PARTITION BY TBNAME SLIMIT 1");
 }
+
+TEST_F(PlanPartitionByTest, withIntervalAndStats) {
+  useDb("root", "test");
+  tsQueryStatsOptimize = true;
+
+  // a few windows open for each table, which are computed in hash on the rows of all tables
+  STableStats stats = {.numOfTables = 3, .numOfRows = 3000, .skey = 1656633600000, .ekey = 1656633660000};
+  setTableStats("st1", &stats);
+  run("SELECT _WSTART, COUNT(*) FROM st1 PARTITION BY TBNAME INTERVAL(10s)");
+
+  // the windows of natural months are always computed one after another
+  run("SELECT _WSTART, COUNT(*) FROM st1 PARTITION BY TBNAME INTERVAL(1n)");
+
+  // many windows open for each table, the rows of a partition are merged by timestamp
+  stats.numOfTables = 10000;
+  stats.ekey = 1659312000000;
+  setTableStats("st1", &stats);
+  run("SELECT _WSTART, COUNT(*) FROM st1 PARTITION BY TBNAME INTERVAL(10s)");
+
+  // unless the time range of the query keeps few of them
+  run("SELECT _WSTART, COUNT(*) FROM st1 WHERE ts > '2022-07-01 00:00:00' AND ts < '2022-07-01 00:01:00' "
+      "PARTITION BY TBNAME INTERVAL(10s)");
+
+  setTableStats("st1", NULL);
+  tsQueryStatsOptimize = false;
+}
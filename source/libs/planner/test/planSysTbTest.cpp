@@ -45,3 +45,11 @@ TEST_F(PlanSysTableTest, tableCount) {
 
   run("SELECT db_name, stable_name, COUNT(*) FROM ins_tables GROUP BY db_name, stable_name");
 }
+
+TEST_F(PlanSysTableTest, withLimit) {
+  useDb("root", "information_schema");
+
+  run("SELECT * FROM ins_tables WHERE stable_name = 'st1' LIMIT 10");
+
+  run("SELECT * FROM ins_tags WHERE table_name = 'st1s1' LIMIT 10 OFFSET 5");
+}
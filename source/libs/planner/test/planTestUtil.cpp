@@ -95,6 +95,10 @@ class PlannerTestBaseImpl {
  public:
   PlannerTestBaseImpl() : sqlNo_(0), sqlNum_(0) {}
 
+  const string& db() const { return caseEnv_.db_; }
+
+  int8_t rollupLevel() const { return res_.rollupLevel_; }
+
   void useDb(const string& user, const string& db) {
     caseEnv_.acctId_ = 0;
     caseEnv_.user_ = user;
@@ -271,6 +275,7 @@ class PlannerTestBaseImpl {
     string         scaledLogicPlan_;
     string         physiPlan_;
     vector<string> physiSubplans_;
+    int8_t         rollupLevel_;
   };
 
   static void _destroyQuery(SQuery** pQuery) {
@@ -294,6 +299,7 @@ class PlannerTestBaseImpl {
     res_.scaledLogicPlan_.clear();
     res_.physiPlan_.clear();
     res_.physiSubplans_.clear();
+    res_.rollupLevel_ = -1;
   }
 
   void dump(DumpModule module) {
@@ -425,10 +431,21 @@ class PlannerTestBaseImpl {
     SNode* pNode;
     FOREACH(pNode, (*pPlan)->pSubplans) {
       SNode* pSubplan;
-      FOREACH(pSubplan, ((SNodeListNode*)pNode)->pNodeList) { res_.physiSubplans_.push_back(toString(pSubplan)); }
+      FOREACH(pSubplan, ((SNodeListNode*)pNode)->pNodeList) {
+        res_.physiSubplans_.push_back(toString(pSubplan));
+        collectRollupLevel((SPhysiNode*)((SSubplan*)pSubplan)->pNode);
+      }
     }
   }
 
+  void collectRollupLevel(SPhysiNode* pNode) {
+    if (QUERY_NODE_PHYSICAL_PLAN_TABLE_SCAN == nodeType(pNode)) {
+      res_.rollupLevel_ = std::max(res_.rollupLevel_, ((STableScanPhysiNode*)pNode)->rollupLevel);
+    }
+    SNode* pChild;
+    FOREACH(pChild, pNode->pChildren) { collectRollupLevel((SPhysiNode*)pChild); }
+  }
+
   void setPlanContext(SQuery* pQuery, SPlanContext* pCxt) {
     pCxt->queryId = 1;
     pCxt->pUser = caseEnv_.user_.c_str();
@@ -518,6 +535,12 @@ void PlannerTestBase::useDb(const std::string& user, const std::string& db) { im
 
 void PlannerTestBase::run(const std::string& sql) { return impl_->run(sql); }
 
+void PlannerTestBase::setTableStats(const std::string& tbname, const STableStats* pStats) {
+  g_mockCatalogService->setTableStats(impl_->db(), tbname, pStats);
+}
+
+int8_t PlannerTestBase::getRollupLevel() const { return impl_->rollupLevel(); }
+
 void PlannerTestBase::prepare(const std::string& sql) { return impl_->prepare(sql); }
 
 void PlannerTestBase::bindParams(TAOS_MULTI_BIND* pParams, int32_t colIdx) {
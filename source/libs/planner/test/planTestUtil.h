@@ -32,6 +32,10 @@ class PlannerTestBase : public testing::Test {
 
   void useDb(const std::string& user, const std::string& db);
   void run(const std::string& sql);
+  // the stats the catalog returns for a super table of the current database, none if pStats is NULL
+  void setTableStats(const std::string& tbname, const STableStats* pStats);
+  // the rollup level of the table scans of the last plan, -1 if it has no table scan
+  int8_t getRollupLevel() const;
   // stmt mode APIs
   void prepare(const std::string& sql);
   void bindParams(TAOS_MULTI_BIND* pParams, int32_t colIdx);
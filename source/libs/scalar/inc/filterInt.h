@@ -228,7 +228,8 @@ typedef struct SFltTreeStat {
 } SFltTreeStat;
 
 typedef struct SFltScalarCtx {
-  SNode *node;
+  SNode    *node;
+  SHashObj *pPrograms;  // the compiled arithmetic operators of node
 } SFltScalarCtx;
 
 typedef struct SFltBuildGroupCtx {
@@ -35,6 +35,7 @@ typedef struct SScalarCtx {
   SHashObj*          pRes;       /* element is SScalarParam */
   void*              param;      // additional parameter (meta actually) for acquire value such as tbname/tags values
   SOperatorValueType type;
+  SHashObj*          pPrograms;  /* element is SScalarProgram*, NULL for the operators inside a compiled one */
 } SScalarCtx;
 
 #define SCL_DATA_TYPE_DUMMY_HASH 9000
@@ -95,6 +96,11 @@ int32_t sclConvertToTsValueNode(int8_t precision, SValueNode* valueNode);
 #define GET_PARAM_PRECISON(_c) ((_c)->columnData->info.precision)
 
 void sclFreeParam(SScalarParam* param);
+
+int32_t sclCalculate(SNode* pNode, SArray* pBlockList, SScalarParam* pDst, SHashObj* pPrograms);
+int32_t sclCompileSubtrees(SNode* pNode, SHashObj** pPrograms);
+int32_t sclExecProgram(struct SScalarProgram* pProgram, SOperatorNode* node, SScalarCtx* ctx, SScalarParam* output);
+void    sclDestroyPrograms(SHashObj* pPrograms);
 void doVectorCompare(SScalarParam* pLeft, SScalarParam* pRight, SScalarParam *pOut, int32_t startIndex, int32_t numOfRows, 
                      int32_t _ord, int32_t optr);
 void vectorCompareImpl(SScalarParam* pLeft, SScalarParam* pRight, SScalarParam *pOut, int32_t startIndex, int32_t numOfRows, 
@@ -103,6 +103,16 @@ static FORCE_INLINE _getDoubleValue_fn_t getVectorDoubleValueFn(int32_t srcType)
   return p;
 }
 
+const double *vectorGetDoubleData(SColumnInfoData *pCol, int32_t start, int32_t numOfRows, double *pBuf);
+void vectorMathAddKernel(double *pOut, const double *pLeft, const double *pRight, int32_t numOfRows, bool leftScalar,
+                         bool rightScalar);
+void vectorMathSubKernel(double *pOut, const double *pLeft, const double *pRight, int32_t numOfRows, bool leftScalar,
+                         bool rightScalar);
+void vectorMathMultiplyKernel(double *pOut, const double *pLeft, const double *pRight, int32_t numOfRows,
+                              bool leftScalar, bool rightScalar);
+void vectorMathDivideKernel(double *pOut, const double *pLeft, const double *pRight, int32_t numOfRows,
+                            bool leftScalar, bool rightScalar);
+
 typedef void (*_bufConverteFunc)(char *buf, SScalarParam *pOut, int32_t outType, int32_t *overflow);
 typedef void (*_bin_scalar_fn_t)(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *output, int32_t order);
 _bin_scalar_fn_t getBinScalarOperatorFn(int32_t binOperator);
@@ -1860,6 +1860,9 @@ void filterFreeInfo(SFilterInfo *info) {
     return;
   }
 
+  sclDestroyPrograms(info->sclCtx.pPrograms);
+  info->sclCtx.pPrograms = NULL;
+
   taosMemoryFreeClear(info->cunits);
   taosMemoryFreeClear(info->blkUnitRes);
   taosMemoryFreeClear(info->blkUnits);
@@ -4052,6 +4055,7 @@ int32_t filterInitFromNode(SNode *pNode, SFilterInfo **pInfo, uint32_t options)
   } else {
     info->sclCtx.node = pNode;
     FLT_ERR_JRET(fltOptimizeNodes(info, &info->sclCtx.node, &stat));
+    FLT_ERR_JRET(sclCompileSubtrees(info->sclCtx.node, &info->sclCtx.pPrograms));
   }
 
   return code;
@@ -4082,7 +4086,7 @@ bool filterExecute(SFilterInfo *info, SSDataBlock *pSrc, SColumnInfoData **p, SC
     SArray *pList = taosArrayInit(1, POINTER_BYTES);
     taosArrayPush(pList, &pSrc);
 
-    int32_t code = scalarCalculate(info->sclCtx.node, pList, &output);
+    int32_t code = sclCalculate(info->sclCtx.node, pList, &output, info->sclCtx.pPrograms);
     taosArrayDestroy(pList);
 
     FLT_ERR_RET(code);
@@ -1354,7 +1354,13 @@ EDealRes sclWalkOperator(SNode *pNode, SScalarCtx *ctx) {
   SOperatorNode *node = (SOperatorNode *)pNode;
   SScalarParam   output = {0};
 
-  ctx->code = sclExecOperator(node, ctx, &output);
+  SScalarProgram **pProgram = ctx->pPrograms ? taosHashGet(ctx->pPrograms, &pNode, POINTER_BYTES) : NULL;
+  if (pProgram && NULL == *pProgram) {
+    // inside a compiled operator, whose program calculates it
+    return DEAL_RES_CONTINUE;
+  }
+
+  ctx->code = pProgram ? sclExecProgram(*pProgram, node, ctx, &output) : sclExecOperator(node, ctx, &output);
   if (ctx->code) {
     sclFreeParam(&output);
     return DEAL_RES_ERROR;
@@ -1589,12 +1595,16 @@ int32_t scalarCalculateConstants(SNode *pNode, SNode **pRes) { return sclCalcCon
 int32_t scalarCalculateConstantsFromDual(SNode *pNode, SNode **pRes) { return sclCalcConstants(pNode, true, pRes); }
 
 int32_t scalarCalculate(SNode *pNode, SArray *pBlockList, SScalarParam *pDst) {
+  return sclCalculate(pNode, pBlockList, pDst, NULL);
+}
+
+int32_t sclCalculate(SNode *pNode, SArray *pBlockList, SScalarParam *pDst, SHashObj *pPrograms) {
   if (NULL == pNode || NULL == pBlockList) {
     SCL_ERR_RET(TSDB_CODE_QRY_INVALID_INPUT);
   }
 
   int32_t    code = 0;
-  SScalarCtx ctx = {.code = 0, .pBlockList = pBlockList, .param = pDst ? pDst->param : NULL};
+  SScalarCtx ctx = {.code = 0, .pBlockList = pBlockList, .param = pDst ? pDst->param : NULL, .pPrograms = pPrograms};
 
   // TODO: OPT performance
   ctx.pRes = taosHashInit(SCL_DEFAULT_OP_NUM, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false, HASH_NO_LOCK);
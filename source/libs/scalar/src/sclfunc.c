@@ -2374,6 +2374,23 @@ int32_t percentileScalarFunction(SScalarParam *pInput, int32_t inputNum, SScalar
 
   if (hasNull) {
     colDataAppendNULL(pOutputData, 0);
+  } else if (inputNum > 2) {
+    // every percentile of a single value is the value itself
+    int32_t bytes = pOutputData->info.bytes;
+    char   *buf = taosMemoryCalloc(1, bytes);
+    if (buf == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+
+    int32_t len = snprintf(varDataVal(buf), bytes - VARSTR_HEADER_SIZE, "[");
+    for (int32_t i = 1; i < inputNum; ++i) {
+      len += snprintf(varDataVal(buf) + len, bytes - VARSTR_HEADER_SIZE - len, (i == 1) ? "%.15g" : ", %.15g", val);
+    }
+    len += snprintf(varDataVal(buf) + len, bytes - VARSTR_HEADER_SIZE - len, "]");
+    varDataSetLen(buf, TMIN(len, bytes - VARSTR_HEADER_SIZE));
+
+    colDataAppend(pOutputData, 0, buf, false);
+    taosMemoryFree(buf);
   } else {
     colDataAppend(pOutputData, 0, (char *)&val, false);
   }
@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "function.h"
+#include "querynodes.h"
+#include "scalar.h"
+#include "sclInt.h"
+#include "sclvector.h"
+#include "tdatablock.h"
+
+// An arithmetic expression over the numeric columns of a block is compiled into a program of instructions over
+// registers, each of which holds the double values of a chunk of rows. The program runs chunk by chunk and the last
+// instruction writes into the output column, so the intermediate results stay in the cache and the registers are
+// reused for all chunks and blocks, instead of a column being created for each node as scalarCalculate does.
+//
+// Only the operators whose result is NULL as long as one of the operands is NULL are compiled, so the NULL rows of
+// the result are the NULL rows of the columns loaded, and the rows divided by 0.
+
+#define SCL_PROGRAM_CHUNK_ROWS 1024
+#define SCL_PROGRAM_MAX_REGS   16
+
+typedef enum ESclOperandType {
+  SCL_OPERAND_REG = 1,
+  SCL_OPERAND_CONST,
+} ESclOperandType;
+
+typedef struct SSclOperand {
+  int8_t  type;
+  int16_t reg;
+  double  val;
+} SSclOperand;
+
+typedef enum ESclInstType {
+  SCL_INST_LOAD = 1,  // load a column into a register
+  SCL_INST_ADD,
+  SCL_INST_SUB,
+  SCL_INST_MULTI,
+  SCL_INST_DIV,
+  SCL_INST_MINUS,
+} ESclInstType;
+
+typedef struct SSclInst {
+  int8_t      type;
+  int16_t     dst;  // -1 for the output column
+  int16_t     slotId;
+  SSclOperand left;
+  SSclOperand right;
+} SSclInst;
+
+struct SScalarProgram {
+  SArray  *pInsts;  // SSclInst
+  SArray  *pSlots;  // int16_t, the slots of the columns loaded
+  int16_t  blockId;  // the data block of the columns loaded
+  bool     allNull;  // divided by constant 0
+  int32_t  numOfRegs;
+  double  *pRegBuf;
+  double **pRegs;  // the data of each register in the current chunk, which may be the column itself
+};
+
+typedef struct SSclCompileCxt {
+  SScalarProgram *pProgram;
+  int16_t         nextReg;
+} SSclCompileCxt;
+
+static int32_t sclCompileNode(SSclCompileCxt *pCxt, SNode *pNode, SSclOperand *pRes);
+
+static int32_t sclCompileColumn(SSclCompileCxt *pCxt, SColumnNode *pCol, SSclOperand *pRes) {
+  if (!IS_NUMERIC_TYPE(pCol->node.resType.type) || pCxt->nextReg >= SCL_PROGRAM_MAX_REGS) {
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+  if (taosArrayGetSize(pCxt->pProgram->pSlots) > 0 && pCxt->pProgram->blockId != pCol->dataBlockId) {
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+  pCxt->pProgram->blockId = pCol->dataBlockId;
+
+  SSclInst inst = {.type = SCL_INST_LOAD, .dst = pCxt->nextReg++, .slotId = pCol->slotId};
+  if (NULL == taosArrayPush(pCxt->pProgram->pInsts, &inst)) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  bool    exist = false;
+  int32_t numOfSlots = taosArrayGetSize(pCxt->pProgram->pSlots);
+  for (int32_t i = 0; i < numOfSlots; ++i) {
+    if (*(int16_t *)taosArrayGet(pCxt->pProgram->pSlots, i) == pCol->slotId) {
+      exist = true;
+      break;
+    }
+  }
+  if (!exist && NULL == taosArrayPush(pCxt->pProgram->pSlots, &pCol->slotId)) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pCxt->pProgram->numOfRegs = TMAX(pCxt->pProgram->numOfRegs, pCxt->nextReg);
+  *pRes = (SSclOperand){.type = SCL_OPERAND_REG, .reg = inst.dst};
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t sclCompileValue(SValueNode *pVal, SSclOperand *pRes) {
+  if (pVal->isNull || !IS_NUMERIC_TYPE(pVal->node.resType.type)) {
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+
+  *pRes = (SSclOperand){.type = SCL_OPERAND_CONST};
+  GET_TYPED_DATA(pRes->val, double, pVal->node.resType.type, nodesGetValueFromNode(pVal));
+  return TSDB_CODE_SUCCESS;
+}
+
+static int8_t sclGetInstType(EOperatorType opType) {
+  switch (opType) {
+    case OP_TYPE_ADD:
+      return SCL_INST_ADD;
+    case OP_TYPE_SUB:
+      return SCL_INST_SUB;
+    case OP_TYPE_MULTI:
+      return SCL_INST_MULTI;
+    case OP_TYPE_DIV:
+      return SCL_INST_DIV;
+    case OP_TYPE_MINUS:
+      return SCL_INST_MINUS;
+    default:
+      break;
+  }
+  return 0;
+}
+
+static double sclFoldConst(int8_t type, double left, double right) {
+  switch (type) {
+    case SCL_INST_ADD:
+      return left + right;
+    case SCL_INST_SUB:
+      return left - right;
+    case SCL_INST_MULTI:
+      return left * right;
+    case SCL_INST_DIV:
+      return left / right;
+    default:
+      return (left == 0) ? 0 : -left;
+  }
+}
+
+static int32_t sclCompileOperator(SSclCompileCxt *pCxt, SOperatorNode *pOp, SSclOperand *pRes) {
+  int8_t type = sclGetInstType(pOp->opType);
+  if (0 == type || TSDB_DATA_TYPE_DOUBLE != pOp->node.resType.type) {
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+
+  SSclInst inst = {.type = type};
+  int32_t  code = sclCompileNode(pCxt, pOp->pLeft, &inst.left);
+  if (TSDB_CODE_SUCCESS == code && SCL_INST_MINUS != type) {
+    code = sclCompileNode(pCxt, pOp->pRight, &inst.right);
+  }
+  if (TSDB_CODE_SUCCESS != code) {
+    return code;
+  }
+
+  if (SCL_INST_DIV == type && SCL_OPERAND_CONST == inst.right.type && 0 == inst.right.val) {
+    pCxt->pProgram->allNull = true;
+  }
+
+  if (SCL_OPERAND_CONST == inst.left.type && (SCL_INST_MINUS == type || SCL_OPERAND_CONST == inst.right.type)) {
+    if (SCL_INST_DIV == type && 0 == inst.right.val) {
+      return TSDB_CODE_OPS_NOT_SUPPORT;
+    }
+    *pRes = (SSclOperand){.type = SCL_OPERAND_CONST, .val = sclFoldConst(type, inst.left.val, inst.right.val)};
+    return TSDB_CODE_SUCCESS;
+  }
+
+  // the registers of the operands are on the top of the stack, and the result takes the lowest one of them
+  inst.dst = (SCL_OPERAND_REG == inst.left.type) ? inst.left.reg : inst.right.reg;
+  pCxt->nextReg = inst.dst + 1;
+  if (NULL == taosArrayPush(pCxt->pProgram->pInsts, &inst)) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  *pRes = (SSclOperand){.type = SCL_OPERAND_REG, .reg = inst.dst};
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t sclCompileNode(SSclCompileCxt *pCxt, SNode *pNode, SSclOperand *pRes) {
+  if (NULL == pNode) {
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+
+  switch (nodeType(pNode)) {
+    case QUERY_NODE_COLUMN:
+      return sclCompileColumn(pCxt, (SColumnNode *)pNode, pRes);
+    case QUERY_NODE_VALUE:
+      return sclCompileValue((SValueNode *)pNode, pRes);
+    case QUERY_NODE_OPERATOR:
+      return sclCompileOperator(pCxt, (SOperatorNode *)pNode, pRes);
+    default:
+      break;
+  }
+  return TSDB_CODE_OPS_NOT_SUPPORT;
+}
+
+static int32_t sclCreateProgram(SNode *pNode, SScalarProgram *pProgram) {
+  pProgram->pInsts = taosArrayInit(8, sizeof(SSclInst));
+  pProgram->pSlots = taosArrayInit(4, sizeof(int16_t));
+  if (NULL == pProgram->pInsts || NULL == pProgram->pSlots) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  SSclCompileCxt cxt = {.pProgram = pProgram, .nextReg = 0};
+  SSclOperand    res = {0};
+  int32_t        code = sclCompileNode(&cxt, pNode, &res);
+  if (TSDB_CODE_SUCCESS != code) {
+    return code;
+  }
+
+  // a single column or a constant is not worth a program
+  SSclInst *pLast = taosArrayGetLast(pProgram->pInsts);
+  if (SCL_OPERAND_REG != res.type || NULL == pLast || SCL_INST_LOAD == pLast->type) {
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+  pLast->dst = -1;
+
+  pProgram->pRegBuf = taosMemoryMalloc(sizeof(double) * SCL_PROGRAM_CHUNK_ROWS * pProgram->numOfRegs);
+  pProgram->pRegs = taosMemoryCalloc(pProgram->numOfRegs, POINTER_BYTES);
+  if (NULL == pProgram->pRegBuf || NULL == pProgram->pRegs) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t scalarCompile(SNode *pNode, SScalarProgram **pProgram) {
+  *pProgram = taosMemoryCalloc(1, sizeof(SScalarProgram));
+  if (NULL == *pProgram) {
+    SCL_ERR_RET(TSDB_CODE_OUT_OF_MEMORY);
+  }
+
+  int32_t code = sclCreateProgram(pNode, *pProgram);
+  if (TSDB_CODE_SUCCESS != code) {
+    scalarDestroyProgram(*pProgram);
+    *pProgram = NULL;
+  }
+
+  if (TSDB_CODE_OPS_NOT_SUPPORT == code) {
+    return TSDB_CODE_SUCCESS;
+  }
+  SCL_RET(code);
+}
+
+void scalarDestroyProgram(SScalarProgram *pProgram) {
+  if (NULL == pProgram) {
+    return;
+  }
+
+  taosArrayDestroy(pProgram->pInsts);
+  taosArrayDestroy(pProgram->pSlots);
+  taosMemoryFree(pProgram->pRegBuf);
+  taosMemoryFree(pProgram->pRegs);
+  taosMemoryFree(pProgram);
+}
+
+static FORCE_INLINE const double *sclGetOperandData(SScalarProgram *pProgram, const SSclOperand *pOperand) {
+  return (SCL_OPERAND_REG == pOperand->type) ? pProgram->pRegs[pOperand->reg] : &pOperand->val;
+}
+
+static void sclExecInst(SScalarProgram *pProgram, const SSclInst *pInst, SSDataBlock *pSrcBlock, int32_t start,
+                        int32_t numOfRows, SColumnInfoData *pOutput, int32_t offset) {
+  double *pDst = (pInst->dst < 0) ? ((double *)pOutput->pData + offset + start)
+                                  : (pProgram->pRegBuf + pInst->dst * SCL_PROGRAM_CHUNK_ROWS);
+
+  if (SCL_INST_LOAD == pInst->type) {
+    SColumnInfoData *pCol = taosArrayGet(pSrcBlock->pDataBlock, pInst->slotId);
+    pProgram->pRegs[pInst->dst] = (double *)vectorGetDoubleData(pCol, start, numOfRows, pDst);
+    return;
+  }
+
+  const double *pLeft = sclGetOperandData(pProgram, &pInst->left);
+  const double *pRight = sclGetOperandData(pProgram, &pInst->right);
+  bool          leftScalar = (SCL_OPERAND_CONST == pInst->left.type);
+  bool          rightScalar = (SCL_OPERAND_CONST == pInst->right.type);
+
+  switch (pInst->type) {
+    case SCL_INST_ADD:
+      vectorMathAddKernel(pDst, pLeft, pRight, numOfRows, leftScalar, rightScalar);
+      break;
+    case SCL_INST_SUB:
+      vectorMathSubKernel(pDst, pLeft, pRight, numOfRows, leftScalar, rightScalar);
+      break;
+    case SCL_INST_MULTI:
+      vectorMathMultiplyKernel(pDst, pLeft, pRight, numOfRows, leftScalar, rightScalar);
+      break;
+    case SCL_INST_DIV:
+      if (!rightScalar) {  // divide by 0 check, before the divisor in the same register is overwritten
+        for (int32_t i = 0; i < numOfRows; ++i) {
+          if (pRight[i] == 0) {
+            colDataAppendNULL(pOutput, offset + start + i);
+          }
+        }
+      }
+      vectorMathDivideKernel(pDst, pLeft, pRight, numOfRows, leftScalar, rightScalar);
+      break;
+    case SCL_INST_MINUS:
+      for (int32_t i = 0; i < numOfRows; ++i) {
+        pDst[i] = (pLeft[i] == 0) ? 0 : -pLeft[i];
+      }
+      break;
+    default:
+      ASSERT(0);
+  }
+
+  if (pInst->dst >= 0) {
+    pProgram->pRegs[pInst->dst] = pDst;
+  }
+}
+
+// set the NULL bits of the rows in [offset, offset + numOfRows) of the output by the ones of the source column
+static void sclSetOutputNull(SColumnInfoData *pOutput, int32_t offset, const SColumnInfoData *pCol,
+                             int32_t numOfRows) {
+  int32_t i = 0;
+  if (BitPos(offset) == 0) {
+    int32_t bytes = numOfRows >> NBIT;
+    char   *pDst = pOutput->nullbitmap + (offset >> NBIT);
+    if (NULL == pCol) {
+      memset(pDst, 0, bytes);
+    } else {
+      for (int32_t j = 0; j < bytes; ++j) {
+        pDst[j] |= pCol->nullbitmap[j];
+      }
+    }
+    i = bytes << NBIT;
+  }
+
+  for (; i < numOfRows; ++i) {
+    if (NULL == pCol) {
+      colDataClearNull_f(pOutput->nullbitmap, offset + i);
+    } else if (colDataIsNull_f(pCol->nullbitmap, i)) {
+      colDataSetNull_f(pOutput->nullbitmap, offset + i);
+    }
+  }
+}
+
+int32_t scalarExecute(SScalarProgram *pProgram, SSDataBlock *pSrcBlock, SColumnInfoData *pOutput, int32_t offset) {
+  int32_t numOfRows = pSrcBlock->info.rows;
+  int32_t numOfCols = taosArrayGetSize(pSrcBlock->pDataBlock);
+  int32_t numOfSlots = taosArrayGetSize(pProgram->pSlots);
+  for (int32_t i = 0; i < numOfSlots; ++i) {
+    if (*(int16_t *)taosArrayGet(pProgram->pSlots, i) >= numOfCols) {
+      sclError("slot not exist in block, slotId:%d, numOfCols:%d", *(int16_t *)taosArrayGet(pProgram->pSlots, i),
+               numOfCols);
+      SCL_ERR_RET(TSDB_CODE_QRY_INVALID_INPUT);
+    }
+  }
+
+  if (pProgram->allNull) {
+    colDataAppendNNULL(pOutput, offset, numOfRows);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  sclSetOutputNull(pOutput, offset, NULL, numOfRows);
+  for (int32_t i = 0; i < numOfSlots; ++i) {
+    SColumnInfoData *pCol = taosArrayGet(pSrcBlock->pDataBlock, *(int16_t *)taosArrayGet(pProgram->pSlots, i));
+    if (pCol->hasNull && NULL != pCol->nullbitmap) {
+      sclSetOutputNull(pOutput, offset, pCol, numOfRows);
+      pOutput->hasNull = true;
+    }
+  }
+
+  int32_t numOfInsts = taosArrayGetSize(pProgram->pInsts);
+  for (int32_t start = 0; start < numOfRows; start += SCL_PROGRAM_CHUNK_ROWS) {
+    int32_t rows = TMIN(SCL_PROGRAM_CHUNK_ROWS, numOfRows - start);
+    for (int32_t i = 0; i < numOfInsts; ++i) {
+      sclExecInst(pProgram, taosArrayGet(pProgram->pInsts, i), pSrcBlock, start, rows, pOutput, offset);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+typedef struct SSclCompileTreeCxt {
+  SHashObj *pPrograms;
+  int32_t   code;
+} SSclCompileTreeCxt;
+
+static EDealRes sclMarkCompiledWalker(SNode *pNode, void *pContext) {
+  SSclCompileTreeCxt *pCxt = (SSclCompileTreeCxt *)pContext;
+  if (QUERY_NODE_OPERATOR == nodeType(pNode)) {
+    SScalarProgram *pProgram = NULL;
+    if (taosHashPut(pCxt->pPrograms, &pNode, POINTER_BYTES, &pProgram, POINTER_BYTES)) {
+      pCxt->code = TSDB_CODE_OUT_OF_MEMORY;
+      return DEAL_RES_ERROR;
+    }
+  }
+  return DEAL_RES_CONTINUE;
+}
+
+static EDealRes sclCompileWalker(SNode *pNode, void *pContext) {
+  SSclCompileTreeCxt *pCxt = (SSclCompileTreeCxt *)pContext;
+  if (QUERY_NODE_OPERATOR != nodeType(pNode) || 0 == sclGetInstType(((SOperatorNode *)pNode)->opType)) {
+    return DEAL_RES_CONTINUE;
+  }
+
+  SScalarProgram *pProgram = NULL;
+  pCxt->code = scalarCompile(pNode, &pProgram);
+  if (TSDB_CODE_SUCCESS != pCxt->code) {
+    return DEAL_RES_ERROR;
+  }
+  if (NULL == pProgram) {
+    return DEAL_RES_CONTINUE;
+  }
+
+  if (taosHashPut(pCxt->pPrograms, &pNode, POINTER_BYTES, &pProgram, POINTER_BYTES)) {
+    scalarDestroyProgram(pProgram);
+    pCxt->code = TSDB_CODE_OUT_OF_MEMORY;
+    return DEAL_RES_ERROR;
+  }
+
+  // the operators inside are not calculated by themselves any more
+  nodesWalkExpr(((SOperatorNode *)pNode)->pLeft, sclMarkCompiledWalker, pCxt);
+  nodesWalkExpr(((SOperatorNode *)pNode)->pRight, sclMarkCompiledWalker, pCxt);
+  return (TSDB_CODE_SUCCESS == pCxt->code) ? DEAL_RES_IGNORE_CHILD : DEAL_RES_ERROR;
+}
+
+// compile the largest arithmetic subtrees of a condition, which scalarCalculate would calculate node by node
+int32_t sclCompileSubtrees(SNode *pNode, SHashObj **pPrograms) {
+  *pPrograms = NULL;
+
+  SSclCompileTreeCxt cxt = {.code = TSDB_CODE_SUCCESS};
+  cxt.pPrograms = taosHashInit(4, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false, HASH_NO_LOCK);
+  if (NULL == cxt.pPrograms) {
+    SCL_ERR_RET(TSDB_CODE_OUT_OF_MEMORY);
+  }
+
+  nodesWalkExpr(pNode, sclCompileWalker, &cxt);
+  if (TSDB_CODE_SUCCESS != cxt.code || 0 == taosHashGetSize(cxt.pPrograms)) {
+    sclDestroyPrograms(cxt.pPrograms);
+    SCL_RET(cxt.code);
+  }
+
+  *pPrograms = cxt.pPrograms;
+  return TSDB_CODE_SUCCESS;
+}
+
+void sclDestroyPrograms(SHashObj *pPrograms) {
+  if (NULL == pPrograms) {
+    return;
+  }
+
+  void *pIter = taosHashIterate(pPrograms, NULL);
+  while (pIter) {
+    scalarDestroyProgram(*(SScalarProgram **)pIter);
+    pIter = taosHashIterate(pPrograms, pIter);
+  }
+  taosHashCleanup(pPrograms);
+}
+
+int32_t sclExecProgram(SScalarProgram *pProgram, SOperatorNode *node, SScalarCtx *ctx, SScalarParam *output) {
+  SSDataBlock *pBlock = NULL;
+  for (int32_t i = 0; i < taosArrayGetSize(ctx->pBlockList); ++i) {
+    SSDataBlock *pb = taosArrayGetP(ctx->pBlockList, i);
+    if (pb->info.id.blockId == pProgram->blockId) {
+      pBlock = pb;
+      break;
+    }
+  }
+
+  if (NULL == pBlock) {
+    sclError("column tupleId is not found, tupleId:%d, dataBlockNum:%d", pProgram->blockId,
+             (int32_t)taosArrayGetSize(ctx->pBlockList));
+    SCL_ERR_RET(TSDB_CODE_QRY_INVALID_INPUT);
+  }
+
+  SCL_ERR_RET(sclCreateColumnInfoData(&node->node.resType, pBlock->info.rows, output));
+  output->numOfRows = pBlock->info.rows;
+  SCL_RET(scalarExecute(pProgram, pBlock, output->columnData, 0));
+}
@@ -968,6 +968,192 @@ enum {
   VECTOR_UN_CONVERT = 0x2,
 };
 
+// The arithmetic operators over fixed length numeric operands with the double result are computed by the kernels
+// below: the operands are converted to double by the loop specialized for their type, the operator is applied in a
+// loop without branch, and the NULL bitmap of the result is the OR of the bitmaps of the operands, so that the loops
+// can be vectorized by the compiler.
+#define VECTOR_CONVERT_TO_DOUBLE(_type, _src, _dst, _num) \
+  do {                                                    \
+    const _type *_p = (const _type *)(_src);              \
+    for (int32_t _i = 0; _i < (_num); ++_i) {             \
+      (_dst)[_i] = (double)_p[_i];                        \
+    }                                                     \
+  } while (0)
+
+#define DEFINE_VECTOR_MATH_KERNEL(_name, _op)                                                                        \
+  void vectorMath##_name##Kernel(double *pOut, const double *pLeft, const double *pRight, int32_t numOfRows,         \
+                                 bool leftScalar, bool rightScalar) {                                                \
+    if (leftScalar) {                                                                                                \
+      double v = pLeft[0];                                                                                           \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                                                      \
+        pOut[i] = v _op pRight[i];                                                                                   \
+      }                                                                                                              \
+    } else if (rightScalar) {                                                                                        \
+      double v = pRight[0];                                                                                          \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                                                      \
+        pOut[i] = pLeft[i] _op v;                                                                                    \
+      }                                                                                                              \
+    } else {                                                                                                         \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                                                      \
+        pOut[i] = pLeft[i] _op pRight[i];                                                                            \
+      }                                                                                                              \
+    }                                                                                                                \
+  }
+
+DEFINE_VECTOR_MATH_KERNEL(Add, +)
+DEFINE_VECTOR_MATH_KERNEL(Sub, -)
+DEFINE_VECTOR_MATH_KERNEL(Multiply, *)
+DEFINE_VECTOR_MATH_KERNEL(Divide, /)
+
+// return the data of the rows from start of the column as double, which is converted into pBuf if the column is not
+// of double type
+const double *vectorGetDoubleData(SColumnInfoData *pCol, int32_t start, int32_t numOfRows, double *pBuf) {
+  char *pData = pCol->pData + start * pCol->info.bytes;
+  switch (pCol->info.type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      VECTOR_CONVERT_TO_DOUBLE(int8_t, pData, pBuf, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      VECTOR_CONVERT_TO_DOUBLE(uint8_t, pData, pBuf, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      VECTOR_CONVERT_TO_DOUBLE(int16_t, pData, pBuf, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      VECTOR_CONVERT_TO_DOUBLE(uint16_t, pData, pBuf, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      VECTOR_CONVERT_TO_DOUBLE(int32_t, pData, pBuf, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      VECTOR_CONVERT_TO_DOUBLE(uint32_t, pData, pBuf, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      VECTOR_CONVERT_TO_DOUBLE(int64_t, pData, pBuf, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      VECTOR_CONVERT_TO_DOUBLE(uint64_t, pData, pBuf, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      VECTOR_CONVERT_TO_DOUBLE(float, pData, pBuf, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      return (const double *)pData;
+    default:
+      ASSERT(0);
+  }
+
+  return pBuf;
+}
+
+static void vectorMergeNullBitmap(SColumnInfoData *pOutputCol, const SColumnInfoData *pCol, int32_t numOfRows) {
+  if (!pCol->hasNull || pCol->nullbitmap == NULL) {
+    return;
+  }
+
+  int32_t len = BitmapLen(numOfRows);
+  for (int32_t i = 0; i < len; ++i) {
+    pOutputCol->nullbitmap[i] |= pCol->nullbitmap[i];
+  }
+  pOutputCol->hasNull = true;
+}
+
+// return false if the operands are not supported by the kernels, and the operator is computed row by row
+static bool vectorMathApplyKernel(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut, int32_t _ord,
+                                  EOperatorType op) {
+  SColumnInfoData *pLeftCol = pLeft->columnData;
+  SColumnInfoData *pRightCol = pRight->columnData;
+  SColumnInfoData *pOutputCol = pOut->columnData;
+
+  if (_ord != TSDB_ORDER_ASC || pOutputCol->info.type != TSDB_DATA_TYPE_DOUBLE ||
+      !IS_NUMERIC_TYPE(pLeftCol->info.type) || !IS_NUMERIC_TYPE(pRightCol->info.type)) {
+    return false;
+  }
+
+  int32_t numOfRows = TMAX(pLeft->numOfRows, pRight->numOfRows);
+  bool    leftScalar = (pLeft->numOfRows == 1 && numOfRows > 1);
+  bool    rightScalar = (pRight->numOfRows == 1 && numOfRows > 1);
+  if (!leftScalar && !rightScalar && pLeft->numOfRows != pRight->numOfRows) {
+    return false;
+  }
+
+  double *output = (double *)pOutputCol->pData;
+  double *pBuf = NULL;
+  if (!leftScalar && !rightScalar && pLeftCol->info.type != TSDB_DATA_TYPE_DOUBLE &&
+      pRightCol->info.type != TSDB_DATA_TYPE_DOUBLE) {
+    // the output is occupied by the converted left operand
+    pBuf = taosMemoryMalloc(numOfRows * sizeof(double));
+    if (pBuf == NULL) {
+      return false;
+    }
+  }
+
+  pOut->numOfRows = numOfRows;
+
+  double        leftVal = 0, rightVal = 0;
+  const double *pLeftData = &leftVal;
+  const double *pRightData = &rightVal;
+  if (leftScalar) {
+    if (colDataIsNull_s(pLeftCol, 0)) {
+      colDataAppendNNULL(pOutputCol, 0, numOfRows);
+      return true;
+    }
+    leftVal = getVectorDoubleValueFn(pLeftCol->info.type)(pLeftCol->pData, 0);
+  }
+  if (rightScalar) {
+    if (colDataIsNull_s(pRightCol, 0)) {
+      colDataAppendNNULL(pOutputCol, 0, numOfRows);
+      return true;
+    }
+    rightVal = getVectorDoubleValueFn(pRightCol->info.type)(pRightCol->pData, 0);
+    if (op == OP_TYPE_DIV && rightVal == 0) {  // divide by 0
+      colDataAppendNNULL(pOutputCol, 0, numOfRows);
+      return true;
+    }
+  }
+
+  if (!leftScalar) {
+    pLeftData = vectorGetDoubleData(pLeftCol, 0, numOfRows, output);
+  }
+  if (!rightScalar) {
+    pRightData = vectorGetDoubleData(pRightCol, 0, numOfRows, (pLeftData == output) ? pBuf : output);
+    if (op == OP_TYPE_DIV) {  // divide by 0 check, before the converted operand in output is overwritten
+      for (int32_t i = 0; i < numOfRows; ++i) {
+        if (pRightData[i] == 0) {
+          colDataAppendNULL(pOutputCol, i);
+        }
+      }
+    }
+  }
+
+  switch (op) {
+    case OP_TYPE_ADD:
+      vectorMathAddKernel(output, pLeftData, pRightData, numOfRows, leftScalar, rightScalar);
+      break;
+    case OP_TYPE_SUB:
+      vectorMathSubKernel(output, pLeftData, pRightData, numOfRows, leftScalar, rightScalar);
+      break;
+    case OP_TYPE_MULTI:
+      vectorMathMultiplyKernel(output, pLeftData, pRightData, numOfRows, leftScalar, rightScalar);
+      break;
+    case OP_TYPE_DIV:
+      vectorMathDivideKernel(output, pLeftData, pRightData, numOfRows, leftScalar, rightScalar);
+      break;
+    default:
+      ASSERT(0);
+  }
+
+  if (!leftScalar) {
+    vectorMergeNullBitmap(pOutputCol, pLeftCol, numOfRows);
+  }
+  if (!rightScalar) {
+    vectorMergeNullBitmap(pOutputCol, pRightCol, numOfRows);
+  }
+
+  taosMemoryFree(pBuf);
+  return true;
+}
+
 // TODO not correct for descending order scan
 static void vectorMathAddHelper(SColumnInfoData *pLeftCol, SColumnInfoData *pRightCol, SColumnInfoData *pOutputCol,
                                 int32_t numOfRows, int32_t step, int32_t i) {
@@ -1040,6 +1226,10 @@ static void doReleaseVec(SColumnInfoData *pCol, int32_t type) {
 }
 
 void vectorMathAdd(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut, int32_t _ord) {
+  if (vectorMathApplyKernel(pLeft, pRight, pOut, _ord, OP_TYPE_ADD)) {
+    return;
+  }
+
   SColumnInfoData *pOutputCol = pOut->columnData;
 
   int32_t i = ((_ord) == TSDB_ORDER_ASC) ? 0 : TMAX(pLeft->numOfRows, pRight->numOfRows) - 1;
@@ -1147,6 +1337,10 @@ static void vectorMathTsSubHelper(SColumnInfoData *pLeftCol, SColumnInfoData *pR
 }
 
 void vectorMathSub(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut, int32_t _ord) {
+  if (vectorMathApplyKernel(pLeft, pRight, pOut, _ord, OP_TYPE_SUB)) {
+    return;
+  }
+
   SColumnInfoData *pOutputCol = pOut->columnData;
 
   pOut->numOfRows = TMAX(pLeft->numOfRows, pRight->numOfRows);
@@ -1226,6 +1420,10 @@ static void vectorMathMultiplyHelper(SColumnInfoData *pLeftCol, SColumnInfoData
 }
 
 void vectorMathMultiply(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut, int32_t _ord) {
+  if (vectorMathApplyKernel(pLeft, pRight, pOut, _ord, OP_TYPE_MULTI)) {
+    return;
+  }
+
   SColumnInfoData *pOutputCol = pOut->columnData;
   pOut->numOfRows = TMAX(pLeft->numOfRows, pRight->numOfRows);
 
@@ -1259,6 +1457,10 @@ void vectorMathMultiply(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam
 }
 
 void vectorMathDivide(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut, int32_t _ord) {
+  if (vectorMathApplyKernel(pLeft, pRight, pOut, _ord, OP_TYPE_DIV)) {
+    return;
+  }
+
   SColumnInfoData *pOutputCol = pOut->columnData;
   pOut->numOfRows = TMAX(pLeft->numOfRows, pRight->numOfRows);
 
@@ -1499,6 +1499,184 @@ TEST(columnTest, smallint_value_add_int_column) {
   nodesDestroyNode(opNode);
 }
 
+TEST(columnTest, compiled_math_expression) {
+  const int32_t rowNum = 2500;
+  int32_t      *av = (int32_t *)taosMemoryMalloc(rowNum * sizeof(int32_t));
+  int64_t      *bv = (int64_t *)taosMemoryMalloc(rowNum * sizeof(int64_t));
+  double       *cv = (double *)taosMemoryMalloc(rowNum * sizeof(double));
+  for (int32_t i = 0; i < rowNum; ++i) {
+    av[i] = i - 1000;
+    bv[i] = (int64_t)i * 3;
+    cv[i] = (i % 11 == 0) ? 0 : (double)i / 4;
+  }
+
+  // -((a * 1.8 + 32) - b / c)
+  SNode       *pA = NULL, *pB = NULL, *pC = NULL, *pV1 = NULL, *pV2 = NULL;
+  SNode       *pMul = NULL, *pAdd = NULL, *pDiv = NULL, *pSub = NULL, *opNode = NULL;
+  SSDataBlock *src = NULL;
+  double       v1 = 1.8;
+  int64_t      v2 = 32;
+  scltMakeColumnNode(&pA, &src, TSDB_DATA_TYPE_INT, sizeof(int32_t), rowNum, av);
+  scltMakeColumnNode(&pB, &src, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), rowNum, bv);
+  scltMakeColumnNode(&pC, &src, TSDB_DATA_TYPE_DOUBLE, sizeof(double), rowNum, cv);
+  scltMakeValueNode(&pV1, TSDB_DATA_TYPE_DOUBLE, &v1);
+  scltMakeValueNode(&pV2, TSDB_DATA_TYPE_BIGINT, &v2);
+  scltMakeOpNode(&pMul, OP_TYPE_MULTI, TSDB_DATA_TYPE_DOUBLE, pA, pV1);
+  scltMakeOpNode(&pAdd, OP_TYPE_ADD, TSDB_DATA_TYPE_DOUBLE, pMul, pV2);
+  scltMakeOpNode(&pDiv, OP_TYPE_DIV, TSDB_DATA_TYPE_DOUBLE, pB, pC);
+  scltMakeOpNode(&pSub, OP_TYPE_SUB, TSDB_DATA_TYPE_DOUBLE, pAdd, pDiv);
+  scltMakeOpNode(&opNode, OP_TYPE_MINUS, TSDB_DATA_TYPE_DOUBLE, pSub, NULL);
+
+  SColumnInfoData *pACol = (SColumnInfoData *)taosArrayGet(src->pDataBlock, ((SColumnNode *)pA)->slotId);
+  for (int32_t i = 0; i < rowNum; i += 7) {
+    colDataAppendNULL(pACol, i);
+  }
+
+  SScalarProgram *pProgram = NULL;
+  ASSERT_EQ(scalarCompile(opNode, &pProgram), 0);
+  ASSERT_NE(pProgram, nullptr);
+
+  SColumnInfoData output = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 1);
+  colInfoDataEnsureCapacity(&output, rowNum + 3, true);
+  for (int32_t offset = 0; offset <= 3; offset += 3) {
+    ASSERT_EQ(scalarExecute(pProgram, src, &output, offset), 0);
+
+    SArray *blockList = taosArrayInit(1, POINTER_BYTES);
+    taosArrayPush(blockList, &src);
+    SColumnInfoData expect = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 1);
+    SScalarParam    dst = {.columnData = &expect};
+    ASSERT_EQ(scalarCalculate(opNode, blockList, &dst), 0);
+    ASSERT_EQ(dst.numOfRows, rowNum);
+
+    for (int32_t i = 0; i < rowNum; ++i) {
+      bool isNull = colDataIsNull_s(&expect, i);
+      ASSERT_EQ(colDataIsNull_s(&output, i + offset), isNull);
+      if (!isNull) {
+        ASSERT_EQ(*(double *)colDataGetData(&output, i + offset), *(double *)colDataGetData(&expect, i));
+      }
+    }
+
+    colDataDestroy(&expect);
+    taosArrayDestroy(blockList);
+  }
+
+  // not supported by the program
+  char    binaryVar[5] = {0};
+  SNode  *pBinary = NULL, *pBinaryOp = NULL, *pD = NULL;
+  int32_t intv = 1;
+  varDataSetLen(binaryVar, 1);
+  binaryVar[VARSTR_HEADER_SIZE] = '1';
+  scltMakeValueNode(&pBinary, TSDB_DATA_TYPE_BINARY, binaryVar);
+  scltMakeValueNode(&pD, TSDB_DATA_TYPE_INT, &intv);
+  scltMakeOpNode(&pBinaryOp, OP_TYPE_ADD, TSDB_DATA_TYPE_DOUBLE, pD, pBinary);
+  SScalarProgram *pNotSupported = NULL;
+  ASSERT_EQ(scalarCompile(pBinaryOp, &pNotSupported), 0);
+  ASSERT_EQ(pNotSupported, nullptr);
+
+  scalarDestroyProgram(pProgram);
+  colDataDestroy(&output);
+  blockDataDestroy(src);
+  nodesDestroyNode(opNode);
+  nodesDestroyNode(pBinaryOp);
+  taosMemoryFree(av);
+  taosMemoryFree(bv);
+  taosMemoryFree(cv);
+}
+
+TEST(columnTest, compiled_math_filter) {
+  const int32_t rowNum = 2500;
+  int32_t      *av = (int32_t *)taosMemoryMalloc(rowNum * sizeof(int32_t));
+  int64_t      *bv = (int64_t *)taosMemoryMalloc(rowNum * sizeof(int64_t));
+  double       *cv = (double *)taosMemoryMalloc(rowNum * sizeof(double));
+  for (int32_t i = 0; i < rowNum; ++i) {
+    av[i] = i - 1000;
+    bv[i] = (int64_t)(i % 300) * 3;
+    cv[i] = (i % 11 == 0) ? 0 : (double)(i % 50) / 4;
+  }
+
+  // (a * 1.8 + 32) - b / c > 100 and -(a - b) < 500 and a > -900
+  SNode       *pA1 = NULL, *pA2 = NULL, *pA3 = NULL, *pB1 = NULL, *pB2 = NULL, *pC = NULL;
+  SNode       *pV1 = NULL, *pV2 = NULL, *pV3 = NULL, *pV4 = NULL, *pV5 = NULL;
+  SNode       *pMul = NULL, *pAdd = NULL, *pDiv = NULL, *pSub1 = NULL, *pSub2 = NULL, *pMinus = NULL;
+  SNode       *pCond[3] = {NULL}, *logicNode = NULL;
+  SSDataBlock *src = NULL;
+  double       v1 = 1.8;
+  int64_t      v2 = 32, v3 = 100, v4 = 500, v5 = -900;
+  scltMakeColumnNode(&pA1, &src, TSDB_DATA_TYPE_INT, sizeof(int32_t), rowNum, av);
+  scltMakeColumnNode(&pB1, &src, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), rowNum, bv);
+  scltMakeColumnNode(&pC, &src, TSDB_DATA_TYPE_DOUBLE, sizeof(double), rowNum, cv);
+  pA2 = nodesCloneNode(pA1);
+  pA3 = nodesCloneNode(pA1);
+  pB2 = nodesCloneNode(pB1);
+  scltMakeValueNode(&pV1, TSDB_DATA_TYPE_DOUBLE, &v1);
+  scltMakeValueNode(&pV2, TSDB_DATA_TYPE_BIGINT, &v2);
+  scltMakeValueNode(&pV3, TSDB_DATA_TYPE_BIGINT, &v3);
+  scltMakeValueNode(&pV4, TSDB_DATA_TYPE_BIGINT, &v4);
+  scltMakeValueNode(&pV5, TSDB_DATA_TYPE_BIGINT, &v5);
+  scltMakeOpNode(&pMul, OP_TYPE_MULTI, TSDB_DATA_TYPE_DOUBLE, pA1, pV1);
+  scltMakeOpNode(&pAdd, OP_TYPE_ADD, TSDB_DATA_TYPE_DOUBLE, pMul, pV2);
+  scltMakeOpNode(&pDiv, OP_TYPE_DIV, TSDB_DATA_TYPE_DOUBLE, pB1, pC);
+  scltMakeOpNode(&pSub1, OP_TYPE_SUB, TSDB_DATA_TYPE_DOUBLE, pAdd, pDiv);
+  scltMakeOpNode(&pCond[0], OP_TYPE_GREATER_THAN, TSDB_DATA_TYPE_BOOL, pSub1, pV3);
+  scltMakeOpNode(&pSub2, OP_TYPE_SUB, TSDB_DATA_TYPE_DOUBLE, pA2, pB2);
+  scltMakeOpNode(&pMinus, OP_TYPE_MINUS, TSDB_DATA_TYPE_DOUBLE, pSub2, NULL);
+  scltMakeOpNode(&pCond[1], OP_TYPE_LOWER_THAN, TSDB_DATA_TYPE_BOOL, pMinus, pV4);
+  scltMakeOpNode(&pCond[2], OP_TYPE_GREATER_THAN, TSDB_DATA_TYPE_BOOL, pA3, pV5);
+  scltMakeLogicNode(&logicNode, LOGIC_COND_TYPE_AND, pCond, 3);
+
+  SColumnInfoData *pACol = (SColumnInfoData *)taosArrayGet(src->pDataBlock, ((SColumnNode *)pA1)->slotId);
+  for (int32_t i = 0; i < rowNum; i += 7) {
+    colDataAppendNULL(pACol, i);
+  }
+
+  // the two arithmetic operands of the comparisons are compiled, and the operators inside them are not calculated
+  SFilterInfo *filter = NULL;
+  ASSERT_EQ(filterInitFromNode(logicNode, &filter, 0), 0);
+  ASSERT_TRUE(filter->scalarMode);
+  ASSERT_NE(filter->sclCtx.pPrograms, nullptr);
+  int32_t numOfPrograms = 0;
+  void   *pIter = taosHashIterate(filter->sclCtx.pPrograms, NULL);
+  while (pIter) {
+    numOfPrograms += (*(SScalarProgram **)pIter != NULL);
+    pIter = taosHashIterate(filter->sclCtx.pPrograms, pIter);
+  }
+  ASSERT_EQ(numOfPrograms, 2);
+  ASSERT_EQ(taosHashGetSize(filter->sclCtx.pPrograms), 6);
+
+  SColumnInfoData *pRes = NULL;
+  int32_t          status = 0;
+  filterExecute(filter, src, &pRes, NULL, taosArrayGetSize(src->pDataBlock), &status);
+  ASSERT_NE(pRes, nullptr);
+  ASSERT_EQ(status, FILTER_RESULT_PARTIAL_QUALIFIED);
+
+  SArray *blockList = taosArrayInit(1, POINTER_BYTES);
+  taosArrayPush(blockList, &src);
+  SColumnInfoData expect = createColumnInfoData(TSDB_DATA_TYPE_BOOL, sizeof(bool), 1);
+  SScalarParam    dst = {.columnData = &expect};
+  ASSERT_EQ(scalarCalculate(logicNode, blockList, &dst), 0);
+  ASSERT_EQ(dst.numOfRows, rowNum);
+
+  int32_t numOfQualified = 0;
+  for (int32_t i = 0; i < rowNum; ++i) {
+    bool qualified = !colDataIsNull_s(&expect, i) && *(bool *)colDataGetData(&expect, i);
+    ASSERT_EQ(*(bool *)colDataGetData(pRes, i), qualified) << "row:" << i;
+    numOfQualified += qualified;
+  }
+  ASSERT_GT(numOfQualified, 0);
+  ASSERT_LT(numOfQualified, rowNum);
+
+  colDataDestroy(&expect);
+  colDataDestroy(pRes);
+  taosMemoryFree(pRes);
+  taosArrayDestroy(blockList);
+  filterFreeInfo(filter);
+  blockDataDestroy(src);
+  nodesDestroyNode(logicNode);
+  taosMemoryFree(av);
+  taosMemoryFree(bv);
+  taosMemoryFree(cv);
+}
+
 TEST(columnTest, bigint_column_multi_binary_column) {
   SNode  *pLeft = NULL, *pRight = NULL, *opNode = NULL;
   int64_t leftv[5] = {1, 2, 3, 4, 5};
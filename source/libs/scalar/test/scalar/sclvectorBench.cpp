@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "function.h"
+#include "querynodes.h"
+#include "sclvector.h"
+#include "tdatablock.h"
+
+// Check the kernels of the arithmetic operators against the computation row by row through the converting function of
+// the type. The timing case is disabled by default, run it with --gtest_also_run_disabled_tests.
+
+namespace {
+
+SColumnInfoData *createMathColumn(int32_t type, int32_t rows, uint32_t seed, int32_t nullRatio) {
+  SColumnInfoData *pCol = (SColumnInfoData *)taosMemoryCalloc(1, sizeof(SColumnInfoData));
+  *pCol = createColumnInfoData(type, tDataTypes[type].bytes, 1);
+  colInfoDataEnsureCapacity(pCol, rows, true);
+
+  for (int32_t i = 0; i < rows; ++i) {
+    if (nullRatio > 0 && taosRandR(&seed) % 100 < nullRatio) {
+      colDataAppendNULL(pCol, i);
+      continue;
+    }
+
+    int64_t v = (int64_t)(taosRandR(&seed) % 200) - 100;
+    switch (type) {
+      case TSDB_DATA_TYPE_SMALLINT:
+        ((int16_t *)pCol->pData)[i] = (int16_t)v;
+        break;
+      case TSDB_DATA_TYPE_INT:
+        ((int32_t *)pCol->pData)[i] = (int32_t)v;
+        break;
+      case TSDB_DATA_TYPE_UINT:
+        ((uint32_t *)pCol->pData)[i] = (uint32_t)(v + 100);
+        break;
+      case TSDB_DATA_TYPE_BIGINT:
+        ((int64_t *)pCol->pData)[i] = v * 1000000;
+        break;
+      case TSDB_DATA_TYPE_FLOAT:
+        ((float *)pCol->pData)[i] = (float)v / 4;
+        break;
+      case TSDB_DATA_TYPE_DOUBLE:
+        ((double *)pCol->pData)[i] = (double)v / 8;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return pCol;
+}
+
+void destroyMathColumn(SColumnInfoData *pCol) {
+  colDataDestroy(pCol);
+  taosMemoryFree(pCol);
+}
+
+void computeByRow(EOperatorType op, SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut) {
+  SColumnInfoData     *pLeftCol = pLeft->columnData;
+  SColumnInfoData     *pRightCol = pRight->columnData;
+  _getDoubleValue_fn_t leftFn = getVectorDoubleValueFn(pLeftCol->info.type);
+  _getDoubleValue_fn_t rightFn = getVectorDoubleValueFn(pRightCol->info.type);
+
+  int32_t rows = TMAX(pLeft->numOfRows, pRight->numOfRows);
+  double *output = (double *)pOut->columnData->pData;
+  for (int32_t i = 0; i < rows; ++i) {
+    int32_t l = (pLeft->numOfRows == 1) ? 0 : i;
+    int32_t r = (pRight->numOfRows == 1) ? 0 : i;
+    if (colDataIsNull_s(pLeftCol, l) || colDataIsNull_s(pRightCol, r)) {
+      colDataAppendNULL(pOut->columnData, i);
+      continue;
+    }
+
+    double lv = leftFn(pLeftCol->pData, l);
+    double rv = rightFn(pRightCol->pData, r);
+    switch (op) {
+      case OP_TYPE_ADD:
+        output[i] = lv + rv;
+        break;
+      case OP_TYPE_SUB:
+        output[i] = lv - rv;
+        break;
+      case OP_TYPE_MULTI:
+        output[i] = lv * rv;
+        break;
+      default:
+        if (rv == 0) {
+          colDataAppendNULL(pOut->columnData, i);
+        } else {
+          output[i] = lv / rv;
+        }
+        break;
+    }
+  }
+  pOut->numOfRows = rows;
+}
+
+void checkMathOp(EOperatorType op, int32_t leftType, int32_t leftRows, int32_t rightType, int32_t rightRows) {
+  int32_t         rows = TMAX(leftRows, rightRows);
+  SColumnInfoData output = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 1);
+  SColumnInfoData expect = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 1);
+  colInfoDataEnsureCapacity(&output, rows, true);
+  colInfoDataEnsureCapacity(&expect, rows, true);
+
+  SScalarParam left = {0}, right = {0}, out = {0}, exp = {0};
+  left.columnData = createMathColumn(leftType, leftRows, 1, leftRows > 1 ? 10 : 0);
+  left.numOfRows = leftRows;
+  right.columnData = createMathColumn(rightType, rightRows, 2, rightRows > 1 ? 10 : 0);
+  right.numOfRows = rightRows;
+  out.columnData = &output;
+  exp.columnData = &expect;
+
+  getBinScalarOperatorFn(op)(&left, &right, &out, TSDB_ORDER_ASC);
+  computeByRow(op, &left, &right, &exp);
+
+  ASSERT_EQ(out.numOfRows, rows);
+  for (int32_t i = 0; i < rows; ++i) {
+    bool isNull = colDataIsNull_s(&expect, i);
+    ASSERT_EQ(colDataIsNull_s(&output, i), isNull);
+    if (!isNull) {
+      ASSERT_EQ(((double *)output.pData)[i], ((double *)expect.pData)[i]);
+    }
+  }
+
+  destroyMathColumn(left.columnData);
+  destroyMathColumn(right.columnData);
+  colDataDestroy(&output);
+  colDataDestroy(&expect);
+}
+
+}  // namespace
+
+TEST(sclvectorTest, mathKernel) {
+  const int32_t rows = 4099;
+  EOperatorType ops[] = {OP_TYPE_ADD, OP_TYPE_SUB, OP_TYPE_MULTI, OP_TYPE_DIV};
+  for (int32_t i = 0; i < sizeof(ops) / sizeof(ops[0]); ++i) {
+    checkMathOp(ops[i], TSDB_DATA_TYPE_INT, rows, TSDB_DATA_TYPE_DOUBLE, 1);
+    checkMathOp(ops[i], TSDB_DATA_TYPE_DOUBLE, 1, TSDB_DATA_TYPE_SMALLINT, rows);
+    checkMathOp(ops[i], TSDB_DATA_TYPE_BIGINT, rows, TSDB_DATA_TYPE_BIGINT, rows);
+    checkMathOp(ops[i], TSDB_DATA_TYPE_DOUBLE, rows, TSDB_DATA_TYPE_UINT, rows);
+    checkMathOp(ops[i], TSDB_DATA_TYPE_FLOAT, rows, TSDB_DATA_TYPE_DOUBLE, rows);
+    checkMathOp(ops[i], TSDB_DATA_TYPE_INT, 1, TSDB_DATA_TYPE_FLOAT, 1);
+  }
+}
+
+TEST(sclvectorBench, DISABLED_mathThroughput) {
+  const int32_t rows = 4096;
+  const int32_t loops = 2000;
+
+  SScalarParam left = {0}, right = {0}, out = {0};
+  left.columnData = createMathColumn(TSDB_DATA_TYPE_INT, rows, 1, 10);
+  left.numOfRows = rows;
+  right.columnData = createMathColumn(TSDB_DATA_TYPE_BIGINT, rows, 2, 10);
+  right.numOfRows = rows;
+
+  SColumnInfoData output = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 1);
+  colInfoDataEnsureCapacity(&output, rows, true);
+  out.columnData = &output;
+
+  int64_t st = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) {
+    computeByRow(OP_TYPE_SUB, &left, &right, &out);
+  }
+  int64_t rowEl = taosGetTimestampUs() - st;
+
+  _bin_scalar_fn_t fn = getBinScalarOperatorFn(OP_TYPE_SUB);
+  st = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) {
+    fn(&left, &right, &out, TSDB_ORDER_ASC);
+  }
+  int64_t kernelEl = taosGetTimestampUs() - st;
+
+  ::testing::Test::RecordProperty("rowByRowUs", (int)rowEl);
+  ::testing::Test::RecordProperty("kernelUs", (int)kernelEl);
+
+  destroyMathColumn(left.columnData);
+  destroyMathColumn(right.columnData);
+  colDataDestroy(&output);
+}
+
+#pragma GCC diagnostic pop
@@ -17,6 +17,9 @@
 #include "streamInc.h"
 #include "tcommon.h"
 #include "tcompare.h"
+#include "tglobal.h"
+#include "thash.h"
+#include "tlist.h"
 #include "ttimer.h"
 
 // todo refactor
@@ -106,6 +109,208 @@ static inline int stateKeyCmpr(const void* pKey1, int kLen1, const void* pKey2,
   return 0;
 }
 
+/*
+ * Write buffer of the window state. Values are kept in the buffer and handed out without copy, the dirty ones are
+ * written to pStateDb in key order when the state is committed or a cursor is opened on pStateDb. A value returned by
+ * streamStateGet or streamStateAddIfNotExist must be given back by streamStateReleaseBuf, a value dropped from the
+ * buffer before that is kept in pDetached until it is released.
+ */
+#define STATE_BUF_VALID 0x1  // the value is visible, otherwise it is only reserved by streamStateAddIfNotExist
+#define STATE_BUF_DIRTY 0x2  // the value is not written to pStateDb yet
+
+typedef struct SStateBufEntry {
+  SStateKey key;
+  void*     pVal;  // allocated by tdbRealloc, so that it can be taken over from tdbTbGet
+  int32_t   vLen;
+  int8_t    flags;
+  int32_t   ref;  // handed out and not released yet
+  int64_t   accessVer;
+  TD_DLIST_NODE(SStateBufEntry) dirtyNode;
+} SStateBufEntry;
+
+struct SStreamStateBuf {
+  SHashObj* pEntries;   // SStateKey -> SStateBufEntry*
+  SHashObj* pDetached;  // pVal -> ref, the values dropped from the buffer while they are handed out
+  TD_DLIST(SStateBufEntry) dirty;
+  int64_t size;
+  int64_t capacity;
+  int64_t ver;  // increased by each commit
+  int64_t hit;
+  int64_t miss;
+};
+
+static SStreamStateBuf* stateBufCreate(int64_t capacity) {
+  if (capacity <= 0) {
+    return NULL;
+  }
+
+  SStreamStateBuf* pBuf = taosMemoryCalloc(1, sizeof(SStreamStateBuf));
+  if (pBuf == NULL) {
+    return NULL;
+  }
+  pBuf->pEntries = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
+  pBuf->pDetached = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT), false, HASH_NO_LOCK);
+  if (pBuf->pEntries == NULL || pBuf->pDetached == NULL) {
+    taosHashCleanup(pBuf->pEntries);
+    taosHashCleanup(pBuf->pDetached);
+    taosMemoryFree(pBuf);
+    return NULL;
+  }
+  TD_DLIST_INIT(&pBuf->dirty);
+  pBuf->capacity = capacity;
+  return pBuf;
+}
+
+// a value still handed out is freed when the last reference is released
+static void stateBufDropVal(SStreamStateBuf* pBuf, void* pVal, int32_t ref) {
+  if (ref == 0) {
+    tdbFree(pVal);
+  } else if (taosHashPut(pBuf->pDetached, &pVal, POINTER_BYTES, &ref, sizeof(int32_t)) != 0) {
+    // leaked rather than freed under its holders
+    qError("stream state buffer failed to keep a value handed out, ref:%d", ref);
+  }
+}
+
+static SStateBufEntry* stateBufGet(SStreamStateBuf* pBuf, const SStateKey* pKey) {
+  SStateBufEntry** ppEntry = taosHashGet(pBuf->pEntries, pKey, sizeof(SStateKey));
+  if (ppEntry == NULL) {
+    return NULL;
+  }
+  (*ppEntry)->accessVer = pBuf->ver;
+  return *ppEntry;
+}
+
+static SStateBufEntry* stateBufAdd(SStreamStateBuf* pBuf, const SStateKey* pKey, void* pVal, int32_t vLen,
+                                   int8_t flags) {
+  if (pBuf->size + vLen > pBuf->capacity) {
+    return NULL;
+  }
+
+  SStateBufEntry* pEntry = taosMemoryCalloc(1, sizeof(SStateBufEntry));
+  if (pEntry == NULL) {
+    return NULL;
+  }
+  pEntry->key = *pKey;
+  pEntry->pVal = pVal;
+  pEntry->vLen = vLen;
+  pEntry->accessVer = pBuf->ver;
+  if (taosHashPut(pBuf->pEntries, pKey, sizeof(SStateKey), &pEntry, POINTER_BYTES) != 0) {
+    taosMemoryFree(pEntry);
+    return NULL;
+  }
+  pEntry->flags = flags;
+  if (flags & STATE_BUF_DIRTY) {
+    TD_DLIST_APPEND_WITH_FIELD(&pBuf->dirty, pEntry, dirtyNode);
+  }
+  pBuf->size += vLen;
+  return pEntry;
+}
+
+static void stateBufSetDirty(SStreamStateBuf* pBuf, SStateBufEntry* pEntry) {
+  if (!(pEntry->flags & STATE_BUF_DIRTY)) {
+    TD_DLIST_APPEND_WITH_FIELD(&pBuf->dirty, pEntry, dirtyNode);
+  }
+  pEntry->flags = STATE_BUF_VALID | STATE_BUF_DIRTY;
+}
+
+static void stateBufRemove(SStreamStateBuf* pBuf, SStateBufEntry* pEntry) {
+  SStateKey key = pEntry->key;
+  if (pEntry->flags & STATE_BUF_DIRTY) {
+    TD_DLIST_POP_WITH_FIELD(&pBuf->dirty, pEntry, dirtyNode);
+  }
+  pBuf->size -= pEntry->vLen;
+  taosHashRemove(pBuf->pEntries, &key, sizeof(SStateKey));
+  stateBufDropVal(pBuf, pEntry->pVal, pEntry->ref);
+  taosMemoryFree(pEntry);
+}
+
+static void stateBufClear(SStreamStateBuf* pBuf) {
+  void* pIter = taosHashIterate(pBuf->pEntries, NULL);
+  while (pIter) {
+    SStateBufEntry* pEntry = *(SStateBufEntry**)pIter;
+    stateBufDropVal(pBuf, pEntry->pVal, pEntry->ref);
+    taosMemoryFree(pEntry);
+    pIter = taosHashIterate(pBuf->pEntries, pIter);
+  }
+  taosHashClear(pBuf->pEntries);
+  TD_DLIST_INIT(&pBuf->dirty);
+  pBuf->size = 0;
+}
+
+static void stateBufDestroy(SStreamStateBuf* pBuf) {
+  if (pBuf == NULL) {
+    return;
+  }
+  stateBufClear(pBuf);
+  taosHashCleanup(pBuf->pEntries);
+
+  void* pIter = taosHashIterate(pBuf->pDetached, NULL);
+  while (pIter) {
+    tdbFree(*(void**)taosHashGetKey(pIter, NULL));
+    pIter = taosHashIterate(pBuf->pDetached, pIter);
+  }
+  taosHashCleanup(pBuf->pDetached);
+  taosMemoryFree(pBuf);
+}
+
+static int32_t stateBufEntryCmpr(const void* p1, const void* p2) {
+  SStateBufEntry* pEntry1 = *(SStateBufEntry**)p1;
+  SStateBufEntry* pEntry2 = *(SStateBufEntry**)p2;
+  return stateKeyCmpr(&pEntry1->key, sizeof(SStateKey), &pEntry2->key, sizeof(SStateKey));
+}
+
+// write the values changed since the last flush to pStateDb in key order, they are still kept in the buffer
+static int32_t stateBufFlush(STdbState* pTdbState) {
+  SStreamStateBuf* pBuf = pTdbState->pStateBuf;
+  if (pBuf == NULL || TD_DLIST_NELES(&pBuf->dirty) == 0) {
+    return 0;
+  }
+
+  SArray* pDirty = taosArrayInit(TD_DLIST_NELES(&pBuf->dirty), POINTER_BYTES);
+  if (pDirty == NULL) {
+    return -1;
+  }
+  for (SStateBufEntry* pEntry = TD_DLIST_HEAD(&pBuf->dirty); pEntry != NULL;
+       pEntry = TD_DLIST_NODE_NEXT_WITH_FIELD(pEntry, dirtyNode)) {
+    taosArrayPush(pDirty, &pEntry);
+  }
+  taosArraySort(pDirty, stateBufEntryCmpr);
+
+  int32_t code = 0;
+  for (int32_t i = 0; i < taosArrayGetSize(pDirty); ++i) {
+    SStateBufEntry* pEntry = taosArrayGetP(pDirty, i);
+    code = tdbTbUpsert(pTdbState->pStateDb, &pEntry->key, sizeof(SStateKey), pEntry->pVal, pEntry->vLen,
+                       pTdbState->txn);
+    if (code < 0) {
+      break;
+    }
+    TD_DLIST_POP_WITH_FIELD(&pBuf->dirty, pEntry, dirtyNode);
+    pEntry->flags &= ~STATE_BUF_DIRTY;
+  }
+
+  taosArrayDestroy(pDirty);
+  return code;
+}
+
+// the buffer is kept across commits for the hot windows, the ones not accessed since the last commit go first
+static void stateBufEvict(SStreamStateBuf* pBuf) {
+  if (pBuf->size > pBuf->capacity / 2) {
+    void* pIter = taosHashIterate(pBuf->pEntries, NULL);
+    while (pIter) {
+      SStateBufEntry* pEntry = *(SStateBufEntry**)pIter;
+      pIter = taosHashIterate(pBuf->pEntries, pIter);
+      if (pEntry->accessVer < pBuf->ver && pEntry->ref == 0 && !(pEntry->flags & STATE_BUF_DIRTY)) {
+        stateBufRemove(pBuf, pEntry);
+      }
+    }
+  }
+
+  if (pBuf->size > pBuf->capacity / 2) {
+    stateBufClear(pBuf);
+  }
+  pBuf->ver++;
+}
+
 SStreamState* streamStateOpen(char* path, SStreamTask* pTask, bool specPath, int32_t szPage, int32_t pages) {
   szPage = szPage < 0 ? 4096 : szPage;
   pages = pages < 0 ? 256 : pages;
@@ -163,6 +368,7 @@ SStreamState* streamStateOpen(char* path, SStreamTask* pTask, bool specPath, int
     goto _err;
   }
 
+  pState->pTdbState->pStateBuf = stateBufCreate((int64_t)tsStreamBufferSize * 1024 * 1024);
   pState->pTdbState->pOwner = pTask;
 
   return pState;
@@ -179,6 +385,7 @@ _err:
 }
 
 void streamStateClose(SStreamState* pState) {
+  stateBufFlush(pState->pTdbState);
   tdbCommit(pState->pTdbState->db, pState->pTdbState->txn);
   tdbPostCommit(pState->pTdbState->db, pState->pTdbState->txn);
   tdbTbClose(pState->pTdbState->pStateDb);
@@ -201,6 +408,16 @@ int32_t streamStateBegin(SStreamState* pState) {
 }
 
 int32_t streamStateCommit(SStreamState* pState) {
+  SStreamStateBuf* pBuf = pState->pTdbState->pStateBuf;
+  if (stateBufFlush(pState->pTdbState) < 0) {
+    return -1;
+  }
+  if (pBuf != NULL) {
+    qDebug("stream state buffer commit, hit:%" PRId64 ", miss:%" PRId64 ", entries:%d, size:%" PRId64, pBuf->hit,
+           pBuf->miss, taosHashGetSize(pBuf->pEntries), pBuf->size);
+    stateBufEvict(pBuf);
+  }
+
   if (tdbCommit(pState->pTdbState->db, pState->pTdbState->txn) < 0) {
     return -1;
   }
@@ -216,6 +433,12 @@ int32_t streamStateCommit(SStreamState* pState) {
 }
 
 int32_t streamStateAbort(SStreamState* pState) {
+  // the buffer may hold values of the aborted transaction
+  SStreamStateBuf* pBuf = pState->pTdbState->pStateBuf;
+  if (pBuf != NULL) {
+    stateBufClear(pBuf);
+  }
+
   if (tdbAbort(pState->pTdbState->db, pState->pTdbState->txn) < 0) {
     return -1;
   }
@@ -238,10 +461,47 @@ int32_t streamStateFuncDel(SStreamState* pState, const STupleKey* key) {
   return tdbTbDelete(pState->pTdbState->pFuncStateDb, key, sizeof(STupleKey), pState->pTdbState->txn);
 }
 
-// todo refactor
 int32_t streamStatePut(SStreamState* pState, const SWinKey* key, const void* value, int32_t vLen) {
-  SStateKey sKey = {.key = *key, .opNum = pState->number};
-  return tdbTbUpsert(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), value, vLen, pState->pTdbState->txn);
+  SStreamStateBuf* pBuf = pState->pTdbState->pStateBuf;
+  SStateKey        sKey = {.key = *key, .opNum = pState->number};
+  if (pBuf == NULL) {
+    return tdbTbUpsert(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), value, vLen, pState->pTdbState->txn);
+  }
+
+  SStateBufEntry* pEntry = stateBufGet(pBuf, &sKey);
+  if (pEntry != NULL) {
+    // the value may be updated in place through the buffer returned by streamStateAddIfNotExist
+    if (value != pEntry->pVal || vLen > pEntry->vLen) {
+      void* pVal = tdbRealloc(NULL, vLen);
+      if (pVal == NULL) {
+        return -1;
+      }
+      if (vLen > 0) {
+        memcpy(pVal, value, vLen);
+      }
+      stateBufDropVal(pBuf, pEntry->pVal, pEntry->ref);
+      pEntry->pVal = pVal;
+      pEntry->ref = 0;
+    }
+    pBuf->size += vLen - pEntry->vLen;
+    pEntry->vLen = vLen;
+    stateBufSetDirty(pBuf, pEntry);
+    return 0;
+  }
+
+  void* pVal = tdbRealloc(NULL, vLen);
+  if (pVal == NULL) {
+    return -1;
+  }
+  if (vLen > 0) {
+    memcpy(pVal, value, vLen);
+  }
+  if (stateBufAdd(pBuf, &sKey, pVal, vLen, STATE_BUF_VALID | STATE_BUF_DIRTY) == NULL) {
+    // the buffer is full, write through
+    tdbFree(pVal);
+    return tdbTbUpsert(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), value, vLen, pState->pTdbState->txn);
+  }
+  return 0;
 }
 
 // todo refactor
@@ -249,10 +509,47 @@ int32_t streamStateFillPut(SStreamState* pState, const SWinKey* key, const void*
   return tdbTbUpsert(pState->pTdbState->pFillStateDb, key, sizeof(SWinKey), value, vLen, pState->pTdbState->txn);
 }
 
-// todo refactor
 int32_t streamStateGet(SStreamState* pState, const SWinKey* key, void** pVal, int32_t* pVLen) {
-  SStateKey sKey = {.key = *key, .opNum = pState->number};
-  return tdbTbGet(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), pVal, pVLen);
+  SStreamStateBuf* pBuf = pState->pTdbState->pStateBuf;
+  SStateKey        sKey = {.key = *key, .opNum = pState->number};
+  if (pBuf == NULL) {
+    return tdbTbGet(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), pVal, pVLen);
+  }
+
+  SStateBufEntry* pEntry = stateBufGet(pBuf, &sKey);
+  if (pEntry != NULL && (pEntry->flags & STATE_BUF_VALID)) {
+    pBuf->hit++;
+    if (pVal != NULL) {
+      *pVal = pEntry->pVal;
+      *pVLen = pEntry->vLen;
+      pEntry->ref++;
+    }
+    return 0;
+  }
+  if (pEntry != NULL) {
+    // only reserved, it is not stored anywhere yet
+    return -1;
+  }
+
+  pBuf->miss++;
+  void*   pTmp = NULL;
+  int32_t len = 0;
+  if (tdbTbGet(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), &pTmp, &len) < 0) {
+    return -1;
+  }
+
+  // the value read from pStateDb is taken over by the buffer if there is room
+  pEntry = stateBufAdd(pBuf, &sKey, pTmp, len, STATE_BUF_VALID);
+  if (pVal != NULL) {
+    *pVal = pTmp;
+    *pVLen = len;
+    if (pEntry != NULL) {
+      pEntry->ref++;
+    }
+  } else if (pEntry == NULL) {
+    tdbFree(pTmp);
+  }
+  return 0;
 }
 
 // todo refactor
@@ -260,10 +557,20 @@ int32_t streamStateFillGet(SStreamState* pState, const SWinKey* key, void** pVal
   return tdbTbGet(pState->pTdbState->pFillStateDb, key, sizeof(SWinKey), pVal, pVLen);
 }
 
-// todo refactor
 int32_t streamStateDel(SStreamState* pState, const SWinKey* key) {
-  SStateKey sKey = {.key = *key, .opNum = pState->number};
-  return tdbTbDelete(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), pState->pTdbState->txn);
+  SStreamStateBuf* pBuf = pState->pTdbState->pStateBuf;
+  SStateKey        sKey = {.key = *key, .opNum = pState->number};
+  bool             exist = false;
+  if (pBuf != NULL) {
+    SStateBufEntry* pEntry = stateBufGet(pBuf, &sKey);
+    if (pEntry != NULL) {
+      exist = (pEntry->flags & STATE_BUF_VALID);
+      stateBufRemove(pBuf, pEntry);
+    }
+  }
+
+  int32_t code = tdbTbDelete(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), pState->pTdbState->txn);
+  return exist ? 0 : code;
 }
 
 int32_t streamStateClear(SStreamState* pState) {
@@ -291,26 +598,72 @@ int32_t streamStateFillDel(SStreamState* pState, const SWinKey* key) {
 }
 
 int32_t streamStateAddIfNotExist(SStreamState* pState, const SWinKey* key, void** pVal, int32_t* pVLen) {
-  // todo refactor
   int32_t size = *pVLen;
   if (streamStateGet(pState, key, pVal, pVLen) == 0) {
     return 0;
   }
+
+  SStreamStateBuf* pBuf = pState->pTdbState->pStateBuf;
+  SStateKey        sKey = {.key = *key, .opNum = pState->number};
+  SStateBufEntry*  pEntry = (pBuf != NULL) ? stateBufGet(pBuf, &sKey) : NULL;
+  if (pEntry != NULL) {
+    // reserved by a previous call and not put yet
+    *pVal = pEntry->pVal;
+    *pVLen = pEntry->vLen;
+    pEntry->ref++;
+    return 0;
+  }
+
   *pVal = tdbRealloc(NULL, size);
+  if (*pVal == NULL) {
+    return -1;
+  }
   memset(*pVal, 0, size);
+  *pVLen = size;
+  if (pBuf != NULL) {
+    // reserve it in the buffer, so that streamStatePut of the same value needs no copy
+    pEntry = stateBufAdd(pBuf, &sKey, *pVal, size, 0);
+    if (pEntry != NULL) {
+      pEntry->ref++;
+    }
+  }
   return 0;
 }
 
 int32_t streamStateReleaseBuf(SStreamState* pState, const SWinKey* key, void* pVal) {
-  // todo refactor
   if (!pVal) {
     return 0;
   }
+
+  SStreamStateBuf* pBuf = (pState != NULL && key != NULL) ? pState->pTdbState->pStateBuf : NULL;
+  if (pBuf != NULL) {
+    SStateKey       sKey = {.key = *key, .opNum = pState->number};
+    SStateBufEntry* pEntry = stateBufGet(pBuf, &sKey);
+    if (pEntry != NULL && pEntry->pVal == pVal) {
+      if (pEntry->ref > 0) {
+        pEntry->ref--;
+      }
+      if (!(pEntry->flags & STATE_BUF_VALID) && pEntry->ref == 0) {
+        // reserved but never put
+        stateBufRemove(pBuf, pEntry);
+      }
+      return 0;
+    }
+
+    int32_t* pRef = taosHashGet(pBuf->pDetached, &pVal, POINTER_BYTES);
+    if (pRef != NULL) {
+      if (--(*pRef) > 0) {
+        return 0;
+      }
+      taosHashRemove(pBuf->pDetached, &pVal, POINTER_BYTES);
+    }
+  }
   streamFreeVal(pVal);
   return 0;
 }
 
 SStreamStateCur* streamStateGetCur(SStreamState* pState, const SWinKey* key) {
+  if (stateBufFlush(pState->pTdbState) < 0) return NULL;
   SStreamStateCur* pCur = taosMemoryCalloc(1, sizeof(SStreamStateCur));
   if (pCur == NULL) return NULL;
   tdbTbcOpen(pState->pTdbState->pStateDb, &pCur->pCur, NULL);
@@ -417,6 +770,9 @@ int32_t streamStateSeekLast(SStreamState* pState, SStreamStateCur* pCur) {
 }
 
 SStreamStateCur* streamStateSeekKeyNext(SStreamState* pState, const SWinKey* key) {
+  if (stateBufFlush(pState->pTdbState) < 0) {
+    return NULL;
+  }
   SStreamStateCur* pCur = taosMemoryCalloc(1, sizeof(SStreamStateCur));
   if (pCur == NULL) {
     return NULL;
@@ -832,7 +1188,23 @@ int32_t streamStateGetParName(SStreamState* pState, int64_t groupId, void** pVal
   return tdbTbGet(pState->pTdbState->pParNameDb, &groupId, sizeof(int64_t), pVal, &len);
 }
 
+void streamStateGetBufStat(SStreamState* pState, SStreamStateBufStat* pStat) {
+  SStreamStateBuf* pBuf = pState->pTdbState->pStateBuf;
+  memset(pStat, 0, sizeof(SStreamStateBufStat));
+  if (pBuf != NULL) {
+    pStat->hit = pBuf->hit;
+    pStat->miss = pBuf->miss;
+    pStat->numOfEntries = taosHashGetSize(pBuf->pEntries);
+    pStat->numOfDirty = TD_DLIST_NELES(&pBuf->dirty);
+    pStat->numOfDetached = taosHashGetSize(pBuf->pDetached);
+    pStat->size = pBuf->size;
+  }
+}
+
 void streamStateDestroy(SStreamState* pState) {
+  if (pState->pTdbState != NULL) {
+    stateBufDestroy(pState->pTdbState->pStateBuf);
+  }
   taosMemoryFreeClear(pState->pTdbState);
   taosMemoryFreeClear(pState);
 }
@@ -20,7 +20,7 @@
 #include "ttime.h"
 
 #define DEFAULT_FALSE_POSITIVE   0.01
-#define DEFAULT_BUCKET_SIZE      1310720
+#define DEFAULT_BUCKET_SIZE      1310720  // a multiple of UPDATE_INFO_NUM_SHARDS, so a bucket belongs to one shard
 #define DEFAULT_MAP_CAPACITY     1310720
 #define DEFAULT_MAP_SIZE         (DEFAULT_MAP_CAPACITY * 10)
 #define ROWS_PER_MILLISECOND     1
@@ -33,14 +33,43 @@
 
 static int64_t adjustExpEntries(int64_t entries) { return TMIN(DEFAULT_EXPECTED_ENTRIES, entries); }
 
+// a single 64-bit mix of the key, its two halves are used as the hash pair of the blocked bloom filters
+static FORCE_INLINE uint64_t updateKeyHash(uint64_t tbUid, TSKEY ts) {
+  uint64_t h = (tbUid * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)ts;
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static FORCE_INLINE int32_t updateKeyPut(SScalableBf *pSBf, uint64_t hash) {
+  return tScalableBfPutHash(pSBf, hash >> 32, hash & 0xFFFFFFFFULL);
+}
+
+static SScalableBf *windowSBfInit(SUpdateInfo *pInfo) {
+  int64_t rows = adjustExpEntries(pInfo->interval * ROWS_PER_MILLISECOND);
+  return tScalableBfInitBlocked(rows, DEFAULT_FALSE_POSITIVE);
+}
+
+static FORCE_INLINE void tableSetDirty(SUpdateInfo *pInfo, uint64_t tableId) {
+  pInfo->dirtyShards |= 1ULL << (tableId % UPDATE_INFO_NUM_SHARDS);
+}
+
+static FORCE_INLINE void windowSBfSetDirty(SUpdateInfo *pInfo, int64_t index) {
+  *(int8_t *)taosArrayGet(pInfo->pSBFDirty, index) = 1;
+}
+
 static void windowSBfAdd(SUpdateInfo *pInfo, uint64_t count) {
   if (pInfo->numSBFs < count) {
     count = pInfo->numSBFs;
   }
+  int8_t dirty = 1;
   for (uint64_t i = 0; i < count; ++i) {
-    int64_t      rows = adjustExpEntries(pInfo->interval * ROWS_PER_MILLISECOND);
-    SScalableBf *tsSBF = tScalableBfInit(rows, DEFAULT_FALSE_POSITIVE);
+    SScalableBf *tsSBF = windowSBfInit(pInfo);
     taosArrayPush(pInfo->pTsSBFs, &tsSBF);
+    taosArrayPush(pInfo->pSBFDirty, &dirty);
   }
 }
 
@@ -56,8 +85,10 @@ static void windowSBfDelete(SUpdateInfo *pInfo, uint64_t count) {
       tScalableBfDestroy(pTsSBFs);
       taosArrayRemove(pInfo->pTsSBFs, 0);
     }
+    taosArrayPopFrontBatch(pInfo->pSBFDirty, count);
   } else {
     taosArrayClearEx(pInfo->pTsSBFs, clearItemHelper);
+    taosArrayClear(pInfo->pSBFDirty);
   }
   pInfo->minTS += pInfo->interval * count;
 }
@@ -109,7 +140,8 @@ SUpdateInfo *updateInfoInit(int64_t interval, int32_t precision, int64_t waterma
   uint64_t bfSize = (uint64_t)(pInfo->watermark / pInfo->interval);
 
   pInfo->pTsSBFs = taosArrayInit(bfSize, sizeof(void *));
-  if (pInfo->pTsSBFs == NULL) {
+  pInfo->pSBFDirty = taosArrayInit(bfSize, sizeof(int8_t));
+  if (pInfo->pTsSBFs == NULL || pInfo->pSBFDirty == NULL) {
     updateInfoDestroy(pInfo);
     return NULL;
   }
@@ -133,10 +165,12 @@ SUpdateInfo *updateInfoInit(int64_t interval, int32_t precision, int64_t waterma
   pInfo->maxVersion = 0;
   pInfo->scanGroupId = 0;
   pInfo->scanWindow = (STimeWindow){.skey = INT64_MIN, .ekey = INT64_MAX};
+  // nothing has been serialized yet, the first serialization carries all parts
+  pInfo->dirtyShards = UINT64_MAX;
   return pInfo;
 }
 
-static SScalableBf *getSBf(SUpdateInfo *pInfo, TSKEY ts) {
+static SScalableBf *getSBf(SUpdateInfo *pInfo, TSKEY ts, int64_t *pIndex) {
   if (ts <= 0) {
     return NULL;
   }
@@ -155,10 +189,11 @@ static SScalableBf *getSBf(SUpdateInfo *pInfo, TSKEY ts) {
   }
   SScalableBf *res = taosArrayGetP(pInfo->pTsSBFs, index);
   if (res == NULL) {
-    int64_t rows = adjustExpEntries(pInfo->interval * ROWS_PER_MILLISECOND);
-    res = tScalableBfInit(rows, DEFAULT_FALSE_POSITIVE);
-    taosArrayPush(pInfo->pTsSBFs, &res);
+    res = windowSBfInit(pInfo);
+    taosArraySet(pInfo->pTsSBFs, index, &res);
+    windowSBfSetDirty(pInfo, index);
   }
+  *pIndex = index;
   return res;
 }
 
@@ -178,29 +213,23 @@ TSKEY updateInfoFillBlockData(SUpdateInfo *pInfo, SSDataBlock *pBlock, int32_t p
   for (int32_t i = 0; i < pBlock->info.rows; i++) {
     TSKEY ts = ((TSKEY *)pColDataInfo->pData)[i];
     maxTs = TMAX(maxTs, ts);
-    SScalableBf *pSBf = getSBf(pInfo, ts);
-    if (pSBf) {
-      SUpdateKey updateKey = {
-          .tbUid = tbUid,
-          .ts = ts,
-      };
-      tScalableBfPut(pSBf, &updateKey, sizeof(SUpdateKey));
+    int64_t      index = 0;
+    SScalableBf *pSBf = getSBf(pInfo, ts, &index);
+    if (pSBf && updateKeyPut(pSBf, updateKeyHash(tbUid, ts)) == TSDB_CODE_SUCCESS) {
+      windowSBfSetDirty(pInfo, index);
     }
   }
   TSKEY *pMaxTs = taosHashGet(pInfo->pMap, &tbUid, sizeof(int64_t));
   if (pMaxTs == NULL || *pMaxTs > maxTs) {
     taosHashPut(pInfo->pMap, &tbUid, sizeof(int64_t), &maxTs, sizeof(TSKEY));
+    tableSetDirty(pInfo, tbUid);
   }
   return maxTs;
 }
 
 bool updateInfoIsUpdated(SUpdateInfo *pInfo, uint64_t tableId, TSKEY ts) {
-  int32_t res = TSDB_CODE_FAILED;
-
-  SUpdateKey updateKey = {
-      .tbUid = tableId,
-      .ts = ts,
-  };
+  int32_t  res = TSDB_CODE_FAILED;
+  uint64_t hash = updateKeyHash(tableId, ts);
 
   TSKEY   *pMapMaxTs = taosHashGet(pInfo->pMap, &tableId, sizeof(uint64_t));
   uint64_t index = ((uint64_t)tableId) % pInfo->numBuckets;
@@ -208,8 +237,9 @@ bool updateInfoIsUpdated(SUpdateInfo *pInfo, uint64_t tableId, TSKEY ts) {
   if (ts < maxTs - pInfo->watermark) {
     // this window has been closed.
     if (pInfo->pCloseWinSBF) {
-      res = tScalableBfPut(pInfo->pCloseWinSBF, &updateKey, sizeof(SUpdateKey));
+      res = updateKeyPut(pInfo->pCloseWinSBF, hash);
       if (res == TSDB_CODE_SUCCESS) {
+        pInfo->closeWinDirty = 1;
         return false;
       } else {
         return true;
@@ -218,20 +248,26 @@ bool updateInfoIsUpdated(SUpdateInfo *pInfo, uint64_t tableId, TSKEY ts) {
     return true;
   }
 
-  SScalableBf *pSBf = getSBf(pInfo, ts);
+  int64_t      sbfIndex = 0;
+  SScalableBf *pSBf = getSBf(pInfo, ts, &sbfIndex);
   // pSBf may be a null pointer
   if (pSBf) {
-    res = tScalableBfPut(pSBf, &updateKey, sizeof(SUpdateKey));
+    res = updateKeyPut(pSBf, hash);
+    if (res == TSDB_CODE_SUCCESS) {
+      windowSBfSetDirty(pInfo, sbfIndex);
+    }
   }
 
   int32_t size = taosHashGetSize(pInfo->pMap);
   if ((!pMapMaxTs && size < DEFAULT_MAP_SIZE) || (pMapMaxTs && *pMapMaxTs < ts)) {
     taosHashPut(pInfo->pMap, &tableId, sizeof(uint64_t), &ts, sizeof(TSKEY));
+    tableSetDirty(pInfo, tableId);
     return false;
   }
 
   if (!pMapMaxTs && maxTs < ts) {
     taosArraySet(pInfo->pTsBuckets, index, &ts);
+    tableSetDirty(pInfo, tableId);
     return false;
   }
 
@@ -280,6 +316,8 @@ void updateInfoDestroy(SUpdateInfo *pInfo) {
   }
 
   taosArrayDestroy(pInfo->pTsSBFs);
+  taosArrayDestroy(pInfo->pSBFDirty);
+  tScalableBfDestroy(pInfo->pCloseWinSBF);
   taosHashCleanup(pInfo->pMap);
   taosMemoryFree(pInfo);
 }
@@ -288,8 +326,8 @@ void updateInfoAddCloseWindowSBF(SUpdateInfo *pInfo) {
   if (pInfo->pCloseWinSBF) {
     return;
   }
-  int64_t rows = adjustExpEntries(pInfo->interval * ROWS_PER_MILLISECOND);
-  pInfo->pCloseWinSBF = tScalableBfInit(rows, DEFAULT_FALSE_POSITIVE);
+  pInfo->pCloseWinSBF = windowSBfInit(pInfo);
+  pInfo->closeWinDirty = 1;
 }
 
 void updateInfoDestoryColseWinSBF(SUpdateInfo *pInfo) {
@@ -300,109 +338,246 @@ void updateInfoDestoryColseWinSBF(SUpdateInfo *pInfo) {
   pInfo->pCloseWinSBF = NULL;
 }
 
-int32_t updateInfoSerialize(void *buf, int32_t bufLen, const SUpdateInfo *pInfo) {
-  ASSERT(pInfo);
-  SEncoder encoder = {0};
-  tEncoderInit(&encoder, buf, bufLen);
-  if (tStartEncode(&encoder) < 0) return -1;
-
-  int32_t size = taosArrayGetSize(pInfo->pTsBuckets);
-  if (tEncodeI32(&encoder, size) < 0) return -1;
-  for (int32_t i = 0; i < size; i++) {
-    TSKEY *pTs = (TSKEY *)taosArrayGet(pInfo->pTsBuckets, i);
-    if (tEncodeI64(&encoder, *pTs) < 0) return -1;
+// pick the tables of the dirty shards out of the map in one pass
+static int32_t updateInfoCollectShards(const SUpdateInfo *pInfo, SArray **pShards) {
+  void  *pIte = NULL;
+  size_t keyLen = 0;
+  while ((pIte = taosHashIterate(pInfo->pMap, pIte)) != NULL) {
+    SUpdateKey entry = {.tbUid = *(int64_t *)taosHashGetKey(pIte, &keyLen), .ts = *(TSKEY *)pIte};
+    int32_t    shard = (uint64_t)entry.tbUid % UPDATE_INFO_NUM_SHARDS;
+    if ((pInfo->dirtyShards & (1ULL << shard)) == 0) {
+      continue;
+    }
+    if (pShards[shard] == NULL) {
+      pShards[shard] = taosArrayInit(16, sizeof(SUpdateKey));
+      if (pShards[shard] == NULL) {
+        taosHashCancelIterate(pInfo->pMap, pIte);
+        return -1;
+      }
+    }
+    taosArrayPush(pShards[shard], &entry);
   }
+  return 0;
+}
 
-  if (tEncodeU64(&encoder, pInfo->numBuckets) < 0) return -1;
+static int32_t updateInfoEncode(SEncoder *pEncoder, const SUpdateInfo *pInfo, SArray **pShards) {
+  if (tStartEncode(pEncoder) < 0) return -1;
+
+  if (tEncodeU64(pEncoder, pInfo->numBuckets) < 0) return -1;
+  if (tEncodeU64(pEncoder, pInfo->numSBFs) < 0) return -1;
+  if (tEncodeI64(pEncoder, pInfo->interval) < 0) return -1;
+  if (tEncodeI64(pEncoder, pInfo->watermark) < 0) return -1;
+  if (tEncodeI64(pEncoder, pInfo->minTS) < 0) return -1;
+  if (tEncodeI64(pEncoder, pInfo->scanWindow.skey) < 0) return -1;
+  if (tEncodeI64(pEncoder, pInfo->scanWindow.ekey) < 0) return -1;
+  if (tEncodeU64(pEncoder, pInfo->scanGroupId) < 0) return -1;
+  if (tEncodeU64(pEncoder, pInfo->maxVersion) < 0) return -1;
+
+  // the ts buckets and the max ts of the tables of the dirty shards
+  if (tEncodeU64(pEncoder, pInfo->dirtyShards) < 0) return -1;
+  for (int32_t i = 0; i < UPDATE_INFO_NUM_SHARDS; i++) {
+    if ((pInfo->dirtyShards & (1ULL << i)) == 0) {
+      continue;
+    }
+    // most buckets are never set, varint keeps them at one byte
+    for (uint64_t j = i; j < pInfo->numBuckets; j += UPDATE_INFO_NUM_SHARDS) {
+      if (tEncodeI64v(pEncoder, *(TSKEY *)taosArrayGet(pInfo->pTsBuckets, j)) < 0) return -1;
+    }
+    int32_t size = taosArrayGetSize(pShards[i]);
+    if (tEncodeI32(pEncoder, size) < 0) return -1;
+    for (int32_t j = 0; j < size; j++) {
+      SUpdateKey *pEntry = taosArrayGet(pShards[i], j);
+      if (tEncodeI64(pEncoder, pEntry->tbUid) < 0) return -1;
+      if (tEncodeI64(pEncoder, pEntry->ts) < 0) return -1;
+    }
+  }
 
+  // the dirty window filters, by their index from minTS
   int32_t sBfSize = taosArrayGetSize(pInfo->pTsSBFs);
-  if (tEncodeI32(&encoder, sBfSize) < 0) return -1;
+  int32_t numOfDirty = 0;
   for (int32_t i = 0; i < sBfSize; i++) {
-    SScalableBf *pSBf = taosArrayGetP(pInfo->pTsSBFs, i);
-    if (tScalableBfEncode(pSBf, &encoder) < 0) return -1;
+    numOfDirty += *(int8_t *)taosArrayGet(pInfo->pSBFDirty, i);
   }
-
-  if (tEncodeU64(&encoder, pInfo->numSBFs) < 0) return -1;
-  if (tEncodeI64(&encoder, pInfo->interval) < 0) return -1;
-  if (tEncodeI64(&encoder, pInfo->watermark) < 0) return -1;
-  if (tEncodeI64(&encoder, pInfo->minTS) < 0) return -1;
-
-  if (tScalableBfEncode(pInfo->pCloseWinSBF, &encoder) < 0) return -1;
-
-  int32_t mapSize = taosHashGetSize(pInfo->pMap);
-  if (tEncodeI32(&encoder, mapSize) < 0) return -1;
-  void  *pIte = NULL;
-  size_t keyLen = 0;
-  while ((pIte = taosHashIterate(pInfo->pMap, pIte)) != NULL) {
-    void *key = taosHashGetKey(pIte, &keyLen);
-    if (tEncodeU64(&encoder, *(uint64_t *)key) < 0) return -1;
-    if (tEncodeI64(&encoder, *(TSKEY *)pIte) < 0) return -1;
+  if (tEncodeI32(pEncoder, numOfDirty) < 0) return -1;
+  for (int32_t i = 0; i < sBfSize; i++) {
+    if (*(int8_t *)taosArrayGet(pInfo->pSBFDirty, i) == 0) {
+      continue;
+    }
+    if (tEncodeI32(pEncoder, i) < 0) return -1;
+    if (tScalableBfEncode(taosArrayGetP(pInfo->pTsSBFs, i), pEncoder) < 0) return -1;
   }
 
-  if (tEncodeI64(&encoder, pInfo->scanWindow.skey) < 0) return -1;
-  if (tEncodeI64(&encoder, pInfo->scanWindow.ekey) < 0) return -1;
-  if (tEncodeU64(&encoder, pInfo->scanGroupId) < 0) return -1;
-  if (tEncodeU64(&encoder, pInfo->maxVersion) < 0) return -1;
+  int8_t hasCloseWin = pInfo->pCloseWinSBF != NULL;
+  int8_t closeWinDirty = hasCloseWin && pInfo->closeWinDirty;
+  if (tEncodeI8(pEncoder, hasCloseWin) < 0) return -1;
+  if (tEncodeI8(pEncoder, closeWinDirty) < 0) return -1;
+  if (closeWinDirty && tScalableBfEncode(pInfo->pCloseWinSBF, pEncoder) < 0) return -1;
 
-  tEndEncode(&encoder);
+  tEndEncode(pEncoder);
+  return 0;
+}
 
-  int32_t tlen = encoder.pos;
+/**
+ * Serialize the parts changed since the last updateInfoClearDirty: the meta, the dirty table shards, the dirty window
+ * filters and the closed-window filter if it changed. An info that has never been cleared is serialized in full.
+ * Call with a NULL buf to get the length.
+ */
+int32_t updateInfoSerialize(void *buf, int32_t bufLen, const SUpdateInfo *pInfo) {
+  ASSERT(pInfo);
+  SArray  *shards[UPDATE_INFO_NUM_SHARDS] = {0};
+  SEncoder encoder = {0};
+  int32_t  tlen = -1;
+
+  tEncoderInit(&encoder, buf, bufLen);
+  if (updateInfoCollectShards(pInfo, shards) == 0 && updateInfoEncode(&encoder, pInfo, shards) == 0) {
+    tlen = encoder.pos;
+  }
   tEncoderClear(&encoder);
+
+  for (int32_t i = 0; i < UPDATE_INFO_NUM_SHARDS; i++) {
+    taosArrayDestroy(shards[i]);
+  }
   return tlen;
 }
 
-int32_t updateInfoDeserialize(void *buf, int32_t bufLen, SUpdateInfo *pInfo) {
-  ASSERT(pInfo);
-  SDecoder decoder = {0};
-  tDecoderInit(&decoder, buf, bufLen);
-  if (tStartDecode(&decoder) < 0) return -1;
-
-  int32_t size = 0;
-  if (tDecodeI32(&decoder, &size) < 0) return -1;
-  pInfo->pTsBuckets = taosArrayInit(size, sizeof(TSKEY));
-  TSKEY ts = INT64_MIN;
+void updateInfoClearDirty(SUpdateInfo *pInfo) {
+  pInfo->dirtyShards = 0;
+  pInfo->closeWinDirty = 0;
+  int32_t size = taosArrayGetSize(pInfo->pSBFDirty);
   for (int32_t i = 0; i < size; i++) {
-    if (tDecodeI64(&decoder, &ts) < 0) return -1;
-    taosArrayPush(pInfo->pTsBuckets, &ts);
+    *(int8_t *)taosArrayGet(pInfo->pSBFDirty, i) = 0;
   }
+}
 
-  if (tDecodeU64(&decoder, &pInfo->numBuckets) < 0) return -1;
+// move the window filters to the restored minTS, the ones kept are overwritten by the dirty parts that follow
+static void updateInfoAlignWindows(SUpdateInfo *pInfo, int64_t interval, TSKEY minTS, uint64_t numSBFs) {
+  uint64_t size = taosArrayGetSize(pInfo->pTsSBFs);
+  uint64_t numOfDropped = size;
+  if (pInfo->interval == interval && pInfo->minTS >= 0 && minTS >= pInfo->minTS &&
+      (minTS - pInfo->minTS) % interval == 0) {
+    numOfDropped = TMIN((minTS - pInfo->minTS) / interval, size);
+  }
+  for (uint64_t i = 0; i < numOfDropped; i++) {
+    tScalableBfDestroy(taosArrayGetP(pInfo->pTsSBFs, i));
+  }
+  taosArrayPopFrontBatch(pInfo->pTsSBFs, numOfDropped);
+  taosArrayPopFrontBatch(pInfo->pSBFDirty, numOfDropped);
 
-  int32_t sBfSize = 0;
-  if (tDecodeI32(&decoder, &sBfSize) < 0) return -1;
-  pInfo->pTsSBFs = taosArrayInit(sBfSize, sizeof(void *));
-  for (int32_t i = 0; i < sBfSize; i++) {
-    SScalableBf *pSBf = tScalableBfDecode(&decoder);
-    if (!pSBf) return -1;
-    taosArrayPush(pInfo->pTsSBFs, &pSBf);
+  size -= numOfDropped;
+  if (size > numSBFs) {
+    for (uint64_t i = numSBFs; i < size; i++) {
+      tScalableBfDestroy(taosArrayGetP(pInfo->pTsSBFs, i));
+    }
+    taosArrayPopTailBatch(pInfo->pTsSBFs, size - numSBFs);
+    taosArrayPopTailBatch(pInfo->pSBFDirty, size - numSBFs);
+    size = numSBFs;
   }
 
-  if (tDecodeU64(&decoder, &pInfo->numSBFs) < 0) return -1;
-  if (tDecodeI64(&decoder, &pInfo->interval) < 0) return -1;
-  if (tDecodeI64(&decoder, &pInfo->watermark) < 0) return -1;
-  if (tDecodeI64(&decoder, &pInfo->minTS) < 0) return -1;
-  pInfo->pCloseWinSBF = tScalableBfDecode(&decoder);
+  pInfo->interval = interval;
+  pInfo->minTS = minTS;
+  pInfo->numSBFs = numSBFs;
+  windowSBfAdd(pInfo, numSBFs - size);
+}
 
-  int32_t mapSize = 0;
-  if (tDecodeI32(&decoder, &mapSize) < 0) return -1;
-  _hash_fn_t hashFn = taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT);
-  pInfo->pMap = taosHashInit(mapSize, hashFn, true, HASH_NO_LOCK);
-  uint64_t uid = 0;
-  ts = INT64_MIN;
-  for (int32_t i = 0; i < mapSize; i++) {
-    if (tDecodeU64(&decoder, &uid) < 0) return -1;
-    if (tDecodeI64(&decoder, &ts) < 0) return -1;
-    taosHashPut(pInfo->pMap, &uid, sizeof(uint64_t), &ts, sizeof(TSKEY));
+static int32_t updateInfoDecode(SDecoder *pDecoder, SUpdateInfo *pInfo) {
+  if (tStartDecode(pDecoder) < 0) return -1;
+
+  uint64_t numBuckets = 0;
+  uint64_t numSBFs = 0;
+  int64_t  interval = 0;
+  TSKEY    minTS = 0;
+  if (tDecodeU64(pDecoder, &numBuckets) < 0) return -1;
+  if (numBuckets != pInfo->numBuckets) return -1;
+  if (tDecodeU64(pDecoder, &numSBFs) < 0) return -1;
+  if (tDecodeI64(pDecoder, &interval) < 0) return -1;
+  if (tDecodeI64(pDecoder, &pInfo->watermark) < 0) return -1;
+  if (tDecodeI64(pDecoder, &minTS) < 0) return -1;
+  if (tDecodeI64(pDecoder, &pInfo->scanWindow.skey) < 0) return -1;
+  if (tDecodeI64(pDecoder, &pInfo->scanWindow.ekey) < 0) return -1;
+  if (tDecodeU64(pDecoder, &pInfo->scanGroupId) < 0) return -1;
+  if (tDecodeU64(pDecoder, &pInfo->maxVersion) < 0) return -1;
+  if (interval <= 0) return -1;
+
+  uint64_t dirtyShards = 0;
+  if (tDecodeU64(pDecoder, &dirtyShards) < 0) return -1;
+  if (dirtyShards != 0) {
+    // the tables of a serialized shard replace the ones held
+    SArray *pRemoved = taosArrayInit(16, sizeof(int64_t));
+    if (pRemoved == NULL) return -1;
+    void  *pIte = NULL;
+    size_t keyLen = 0;
+    while ((pIte = taosHashIterate(pInfo->pMap, pIte)) != NULL) {
+      int64_t *pUid = taosHashGetKey(pIte, &keyLen);
+      if (dirtyShards & (1ULL << ((uint64_t)*pUid % UPDATE_INFO_NUM_SHARDS))) {
+        taosArrayPush(pRemoved, pUid);
+      }
+    }
+    for (int32_t i = 0; i < taosArrayGetSize(pRemoved); i++) {
+      taosHashRemove(pInfo->pMap, taosArrayGet(pRemoved, i), sizeof(int64_t));
+    }
+    taosArrayDestroy(pRemoved);
+  }
+  for (int32_t i = 0; i < UPDATE_INFO_NUM_SHARDS; i++) {
+    if ((dirtyShards & (1ULL << i)) == 0) {
+      continue;
+    }
+    TSKEY ts = 0;
+    for (uint64_t j = i; j < pInfo->numBuckets; j += UPDATE_INFO_NUM_SHARDS) {
+      if (tDecodeI64v(pDecoder, &ts) < 0) return -1;
+      taosArraySet(pInfo->pTsBuckets, j, &ts);
+    }
+    int32_t size = 0;
+    if (tDecodeI32(pDecoder, &size) < 0) return -1;
+    for (int32_t j = 0; j < size; j++) {
+      SUpdateKey entry = {0};
+      if (tDecodeI64(pDecoder, &entry.tbUid) < 0) return -1;
+      if (tDecodeI64(pDecoder, &entry.ts) < 0) return -1;
+      if (taosHashPut(pInfo->pMap, &entry.tbUid, sizeof(int64_t), &entry.ts, sizeof(TSKEY)) != 0) return -1;
+    }
   }
-  ASSERT(mapSize == taosHashGetSize(pInfo->pMap));
 
-  if (tDecodeI64(&decoder, &pInfo->scanWindow.skey) < 0) return -1;
-  if (tDecodeI64(&decoder, &pInfo->scanWindow.ekey) < 0) return -1;
-  if (tDecodeU64(&decoder, &pInfo->scanGroupId) < 0) return -1;
-  if (tDecodeU64(&decoder, &pInfo->maxVersion) < 0) return -1;
+  updateInfoAlignWindows(pInfo, interval, minTS, numSBFs);
+  int32_t numOfDirty = 0;
+  if (tDecodeI32(pDecoder, &numOfDirty) < 0) return -1;
+  for (int32_t i = 0; i < numOfDirty; i++) {
+    int32_t index = 0;
+    if (tDecodeI32(pDecoder, &index) < 0) return -1;
+    if (index < 0 || index >= taosArrayGetSize(pInfo->pTsSBFs)) return -1;
+    SScalableBf *pSBf = tScalableBfDecode(pDecoder);
+    if (!pSBf) return -1;
+    tScalableBfDestroy(taosArrayGetP(pInfo->pTsSBFs, index));
+    taosArraySet(pInfo->pTsSBFs, index, &pSBf);
+  }
 
-  tEndDecode(&decoder);
+  int8_t hasCloseWin = 0;
+  int8_t closeWinDirty = 0;
+  if (tDecodeI8(pDecoder, &hasCloseWin) < 0) return -1;
+  if (tDecodeI8(pDecoder, &closeWinDirty) < 0) return -1;
+  if (closeWinDirty) {
+    SScalableBf *pSBf = tScalableBfDecode(pDecoder);
+    if (!pSBf) return -1;
+    tScalableBfDestroy(pInfo->pCloseWinSBF);
+    pInfo->pCloseWinSBF = pSBf;
+  } else if (hasCloseWin) {
+    updateInfoAddCloseWindowSBF(pInfo);
+  } else {
+    updateInfoDestoryColseWinSBF(pInfo);
+  }
 
-  tDecoderClear(&decoder);
+  tEndDecode(pDecoder);
   return 0;
 }
+
+/**
+ * Apply the parts written by updateInfoSerialize to an info created by updateInfoInit, in the order they were
+ * serialized. The restored info is clean, so its next serialization only carries what changes after it.
+ */
+int32_t updateInfoDeserialize(void *buf, int32_t bufLen, SUpdateInfo *pInfo) {
+  ASSERT(pInfo);
+  SDecoder decoder = {0};
+  tDecoderInit(&decoder, buf, bufLen);
+  int32_t code = updateInfoDecode(&decoder, pInfo);
+  tDecoderClear(&decoder);
+  updateInfoClearDirty(pInfo);
+  return code;
+}
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include "streamState.h"
+#include "tglobal.h"
+
+namespace {
+
+const char *statePath = TD_TMP_DIR_PATH "streamStateTest";
+
+SStreamState *openState() {
+  taosRemoveDir(statePath);
+  taosMkDir(statePath);
+  return streamStateOpen((char *)statePath, NULL, true, -1, -1);
+}
+
+int32_t getInt(SStreamState *pState, const SWinKey *pKey, int32_t *pRes) {
+  void   *pVal = NULL;
+  int32_t len = 0;
+  int32_t code = streamStateGet(pState, pKey, &pVal, &len);
+  if (code == 0) {
+    *pRes = *(int32_t *)pVal;
+    streamStateReleaseBuf(pState, pKey, pVal);
+  }
+  return code;
+}
+
+}  // namespace
+
+TEST(TD_STREAM_STATE_TEST, putGetDel) {
+  SStreamState *pState = openState();
+  ASSERT_NE(pState, nullptr);
+
+  for (int32_t i = 0; i < 1000; i++) {
+    SWinKey key = {.groupId = (uint64_t)(i % 10), .ts = i};
+    ASSERT_EQ(streamStatePut(pState, &key, &i, sizeof(int32_t)), 0);
+  }
+
+  int32_t res = 0;
+  SWinKey key = {.groupId = 3, .ts = 13};
+  ASSERT_EQ(getInt(pState, &key, &res), 0);
+  ASSERT_EQ(res, 13);
+
+  ASSERT_EQ(streamStateDel(pState, &key), 0);
+  ASSERT_NE(getInt(pState, &key, &res), 0);
+  ASSERT_NE(streamStateDel(pState, &key), 0);
+
+  // values are visible in pStateDb after commit
+  ASSERT_EQ(streamStateCommit(pState), 0);
+  key.ts = 23;
+  ASSERT_EQ(getInt(pState, &key, &res), 0);
+  ASSERT_EQ(res, 23);
+
+  SStreamStateBufStat stat = {0};
+  streamStateGetBufStat(pState, &stat);
+  if (tsStreamBufferSize > 0) {
+    ASSERT_EQ(stat.hit, 2);
+  }
+
+  streamStateClose(pState);
+}
+
+TEST(TD_STREAM_STATE_TEST, addIfNotExist) {
+  SStreamState *pState = openState();
+  ASSERT_NE(pState, nullptr);
+
+  SWinKey key = {.groupId = 1, .ts = 100};
+  void   *pVal = NULL;
+  int32_t len = sizeof(int64_t);
+  ASSERT_EQ(streamStateAddIfNotExist(pState, &key, &pVal, &len), 0);
+  ASSERT_EQ(*(int64_t *)pVal, 0);
+
+  // not visible until it is put
+  ASSERT_NE(streamStateGet(pState, &key, NULL, NULL), 0);
+  *(int64_t *)pVal = 42;
+  ASSERT_EQ(streamStatePut(pState, &key, pVal, sizeof(int64_t)), 0);
+  streamStateReleaseBuf(pState, &key, pVal);
+
+  pVal = NULL;
+  ASSERT_EQ(streamStateAddIfNotExist(pState, &key, &pVal, &len), 0);
+  ASSERT_EQ(*(int64_t *)pVal, 42);
+  streamStateReleaseBuf(pState, &key, pVal);
+
+  // released without put
+  SWinKey key2 = {.groupId = 1, .ts = 200};
+  ASSERT_EQ(streamStateAddIfNotExist(pState, &key2, &pVal, &len), 0);
+  streamStateReleaseBuf(pState, &key2, pVal);
+  ASSERT_NE(streamStateGet(pState, &key2, NULL, NULL), 0);
+
+  streamStateClose(pState);
+}
+
+TEST(TD_STREAM_STATE_TEST, cursor) {
+  SStreamState *pState = openState();
+  ASSERT_NE(pState, nullptr);
+
+  for (int32_t i = 10; i > 0; i--) {
+    SWinKey key = {.groupId = 1, .ts = i};
+    ASSERT_EQ(streamStatePut(pState, &key, &i, sizeof(int32_t)), 0);
+  }
+
+  // buffered values are seen by cursors
+  SWinKey first = {0};
+  ASSERT_EQ(streamStateGetFirst(pState, &first), 0);
+  ASSERT_EQ(first.ts, 1);
+
+  SWinKey          key = {.groupId = 1, .ts = 5};
+  SStreamStateCur *pCur = streamStateSeekKeyNext(pState, &key);
+  SWinKey          next = {0};
+  ASSERT_EQ(streamStateGetKVByCur(pCur, &next, NULL, 0), 0);
+  ASSERT_EQ(next.ts, 6);
+  streamStateFreeCur(pCur);
+
+  streamStateClose(pState);
+}
+
+TEST(TD_STREAM_STATE_TEST, incrementalFlush) {
+  SStreamState *pState = openState();
+  ASSERT_NE(pState, nullptr);
+  if (tsStreamBufferSize <= 0) {
+    streamStateClose(pState);
+    return;
+  }
+
+  for (int32_t i = 0; i < 100; i++) {
+    SWinKey key = {.groupId = 1, .ts = i};
+    ASSERT_EQ(streamStatePut(pState, &key, &i, sizeof(int32_t)), 0);
+  }
+  SStreamStateBufStat stat = {0};
+  streamStateGetBufStat(pState, &stat);
+  ASSERT_EQ(stat.numOfDirty, 100);
+
+  // only the values changed since the previous cursor are written
+  SWinKey          key = {.groupId = 1, .ts = 0};
+  SStreamStateCur *pCur = streamStateSeekKeyNext(pState, &key);
+  streamStateFreeCur(pCur);
+  streamStateGetBufStat(pState, &stat);
+  ASSERT_EQ(stat.numOfDirty, 0);
+  ASSERT_EQ(stat.numOfEntries, 100);
+
+  int32_t val = 1000;
+  key.ts = 50;
+  ASSERT_EQ(streamStatePut(pState, &key, &val, sizeof(int32_t)), 0);
+  ASSERT_EQ(streamStatePut(pState, &key, &val, sizeof(int32_t)), 0);
+  streamStateGetBufStat(pState, &stat);
+  ASSERT_EQ(stat.numOfDirty, 1);
+
+  key.ts = 49;
+  pCur = streamStateSeekKeyNext(pState, &key);
+  SWinKey next = {0};
+  void   *pVal = NULL;
+  int32_t len = 0;
+  ASSERT_EQ(streamStateGetKVByCur(pCur, &next, (const void **)&pVal, &len), 0);
+  ASSERT_EQ(next.ts, 50);
+  ASSERT_EQ(*(int32_t *)pVal, 1000);
+  streamStateFreeCur(pCur);
+
+  // a deleted dirty value is not written any more
+  key.ts = 200;
+  ASSERT_EQ(streamStatePut(pState, &key, &val, sizeof(int32_t)), 0);
+  ASSERT_EQ(streamStateDel(pState, &key), 0);
+  streamStateGetBufStat(pState, &stat);
+  ASSERT_EQ(stat.numOfDirty, 0);
+
+  // clearing the state opens a cursor for each deleted window
+  ASSERT_EQ(streamStateClear(pState), 0);
+  SWinKey first = {0};
+  ASSERT_NE(streamStateGetFirst(pState, &first), 0);
+
+  streamStateClose(pState);
+}
+
+TEST(TD_STREAM_STATE_TEST, handedOutValue) {
+  int32_t bufferSize = tsStreamBufferSize;
+  tsStreamBufferSize = 1;
+  SStreamState *pState = openState();
+  tsStreamBufferSize = bufferSize;
+  ASSERT_NE(pState, nullptr);
+
+  char    val[1024] = {0};
+  SWinKey key = {.groupId = 1, .ts = 0};
+  for (int32_t i = 0; i < 600; i++) {
+    key.ts = i;
+    snprintf(val, sizeof(val), "value %d", i);
+    ASSERT_EQ(streamStatePut(pState, &key, val, sizeof(val)), 0);
+  }
+
+  // deleted while it is held
+  void   *pVal1 = NULL;
+  int32_t len = 0;
+  key.ts = 1;
+  ASSERT_EQ(streamStateGet(pState, &key, &pVal1, &len), 0);
+  ASSERT_EQ(streamStateDel(pState, &key), 0);
+  ASSERT_STREQ((char *)pVal1, "value 1");
+
+  // replaced by another buffer while it is held
+  void   *pVal2 = NULL;
+  SWinKey key2 = {.groupId = 1, .ts = 2};
+  ASSERT_EQ(streamStateGet(pState, &key2, &pVal2, &len), 0);
+  snprintf(val, sizeof(val), "value 2 updated");
+  ASSERT_EQ(streamStatePut(pState, &key2, val, sizeof(val)), 0);
+  ASSERT_STREQ((char *)pVal2, "value 2");
+
+  // the whole buffer is evicted by the commit, it is more than half full
+  void   *pVal3 = NULL;
+  SWinKey key3 = {.groupId = 1, .ts = 3};
+  ASSERT_EQ(streamStateGet(pState, &key3, &pVal3, &len), 0);
+  ASSERT_EQ(streamStateCommit(pState), 0);
+  SStreamStateBufStat stat = {0};
+  streamStateGetBufStat(pState, &stat);
+  ASSERT_EQ(stat.numOfEntries, 0);
+  ASSERT_EQ(stat.numOfDetached, 3);
+  ASSERT_STREQ((char *)pVal3, "value 3");
+
+  // and by an abort
+  void   *pVal4 = NULL;
+  SWinKey key4 = {.groupId = 1, .ts = 4};
+  ASSERT_EQ(streamStateGet(pState, &key4, &pVal4, &len), 0);
+  ASSERT_EQ(streamStateAbort(pState), 0);
+  ASSERT_STREQ((char *)pVal4, "value 4");
+
+  streamStateReleaseBuf(pState, &key, pVal1);
+  streamStateReleaseBuf(pState, &key2, pVal2);
+  streamStateReleaseBuf(pState, &key3, pVal3);
+  streamStateReleaseBuf(pState, &key4, pVal4);
+  streamStateGetBufStat(pState, &stat);
+  ASSERT_EQ(stat.numOfDetached, 0);
+
+  int32_t res = 0;
+  ASSERT_EQ(getInt(pState, &key2, &res), 0);
+  ASSERT_EQ(res, *(int32_t *)"valu");
+
+  streamStateClose(pState);
+}
+
+int main(int argc, char *argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -190,6 +190,100 @@ TEST(TD_STREAM_UPDATE_TEST, update) {
   updateInfoDestroy(pSU5);
   updateInfoDestroy(pSU6);
   updateInfoDestroy(pSU7);
+  taosMemoryFree(buf);
+}
+
+static int32_t serializeTo(SUpdateInfo *pInfo, SUpdateInfo *pTarget) {
+  int32_t bufLen = updateInfoSerialize(NULL, 0, pInfo);
+  void   *buf = taosMemoryCalloc(1, bufLen);
+  EXPECT_EQ(updateInfoSerialize(buf, bufLen, pInfo), bufLen);
+  EXPECT_EQ(updateInfoDeserialize(buf, bufLen, pTarget), 0);
+  updateInfoClearDirty(pInfo);
+  taosMemoryFree(buf);
+  return bufLen;
+}
+
+static bool equalInfo(SUpdateInfo *left, SUpdateInfo *right) {
+  if (left->minTS != right->minTS || left->numSBFs != right->numSBFs) return false;
+  if (taosHashGetSize(left->pMap) != taosHashGetSize(right->pMap)) return false;
+  void  *pIte = NULL;
+  size_t keyLen = 0;
+  while ((pIte = taosHashIterate(left->pMap, pIte)) != NULL) {
+    void  *key = taosHashGetKey(pIte, &keyLen);
+    TSKEY *pTs = (TSKEY *)taosHashGet(right->pMap, key, keyLen);
+    if (pTs == NULL || *pTs != *(TSKEY *)pIte) {
+      taosHashCancelIterate(left->pMap, pIte);
+      return false;
+    }
+  }
+  for (int32_t i = 0; i < taosArrayGetSize(left->pTsBuckets); i++) {
+    if (*(TSKEY *)taosArrayGet(left->pTsBuckets, i) != *(TSKEY *)taosArrayGet(right->pTsBuckets, i)) return false;
+  }
+  int32_t size = taosArrayGetSize(left->pTsSBFs);
+  if (size != taosArrayGetSize(right->pTsSBFs)) return false;
+  for (int32_t i = 0; i < size; i++) {
+    if (!equalSBF((SScalableBf *)taosArrayGetP(left->pTsSBFs, i), (SScalableBf *)taosArrayGetP(right->pTsSBFs, i))) {
+      return false;
+    }
+  }
+  return equalSBF(left->pCloseWinSBF, right->pCloseWinSBF);
+}
+
+TEST(TD_STREAM_UPDATE_TEST, incrementalSerialize) {
+  const int64_t interval = 20 * 1000;
+  const int64_t watermark = 10 * 60 * 1000;
+  SUpdateInfo  *pSU = updateInfoInit(interval, TSDB_TIME_PRECISION_MILLI, watermark);
+  SUpdateInfo  *pSU1 = updateInfoInit(interval, TSDB_TIME_PRECISION_MILLI, watermark);
+  updateInfoAddCloseWindowSBF(pSU);
+  for (int64_t uid = 0; uid < 256; uid++) {
+    for (int64_t ts = interval; ts < interval * 4; ts += 1000) {
+      GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, uid, ts), false);
+    }
+  }
+
+  // a new info is serialized in full
+  GTEST_ASSERT_EQ(pSU->dirtyShards, UINT64_MAX);
+  int32_t fullLen = serializeTo(pSU, pSU1);
+  GTEST_ASSERT_EQ(pSU->dirtyShards, 0);
+  GTEST_ASSERT_EQ(pSU1->dirtyShards, 0);
+  GTEST_ASSERT_EQ(equalInfo(pSU, pSU1), true);
+
+  // nothing changed, only the meta is serialized
+  int32_t emptyLen = serializeTo(pSU, pSU1);
+  GTEST_ASSERT_LT(emptyLen, 128);
+  GTEST_ASSERT_EQ(equalInfo(pSU, pSU1), true);
+
+  // one new row carries its window and its table shard
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, 3, interval * 4 + 1), false);
+  GTEST_ASSERT_EQ(pSU->dirtyShards, 1ULL << 3);
+  int32_t numOfDirty = 0;
+  for (int32_t i = 0; i < taosArrayGetSize(pSU->pSBFDirty); i++) {
+    numOfDirty += *(int8_t *)taosArrayGet(pSU->pSBFDirty, i);
+  }
+  GTEST_ASSERT_EQ(numOfDirty, 1);
+  GTEST_ASSERT_EQ(pSU->closeWinDirty, 0);
+  int32_t deltaLen = serializeTo(pSU, pSU1);
+  GTEST_ASSERT_LT(deltaLen, fullLen / 10);
+  GTEST_ASSERT_EQ(equalInfo(pSU, pSU1), true);
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU1, 3, interval * 4 + 1), true);
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU1, 4, interval * 4 + 1), false);
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, 4, interval * 4 + 1), false);
+
+  // the windows moved out of the watermark are dropped on both sides
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, 6, interval * 105), false);
+  serializeTo(pSU, pSU1);
+  GTEST_ASSERT_EQ(pSU1->minTS, pSU->minTS);
+  GTEST_ASSERT_EQ(equalInfo(pSU, pSU1), true);
+
+  // a restored info keeps serializing only its own changes
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU1, 7, interval * 105 + 1), false);
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, 7, interval * 105 + 1), false);
+  GTEST_ASSERT_EQ(pSU1->dirtyShards, 1ULL << 7);
+  serializeTo(pSU1, pSU);
+  GTEST_ASSERT_EQ(equalInfo(pSU, pSU1), true);
+
+  updateInfoDestroy(pSU);
+  updateInfoDestroy(pSU1);
 }
 
 int main(int argc, char *argv[]) {
@@ -40,6 +40,7 @@ typedef struct {
   int32_t   id;
   char     *path;
   SDiskSize size;
+  int64_t   ioNextUs;  // when the I/O budget of the disk is free again, see tfsThrottle()
 } STfsDisk;
 
 typedef struct {
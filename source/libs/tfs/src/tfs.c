@@ -145,6 +145,29 @@ const char *tfsGetPrimaryPath(STfs *pTfs) { return TFS_PRIMARY_DISK(pTfs)->path;
 
 const char *tfsGetDiskPath(STfs *pTfs, SDiskID diskId) { return TFS_DISK_AT(pTfs, diskId)->path; }
 
+int64_t tfsThrottleAt(STfs *pTfs, SDiskID diskId, int64_t nBytes, int64_t speed, int64_t nowUs) {
+  STfsDisk *pDisk = TFS_DISK_AT(pTfs, diskId);
+  if (pDisk == NULL || speed <= 0 || nBytes <= 0) return 0;
+
+  // Each call takes a slot of the disk time. The slot may start up to its own length in the past, as the bytes
+  // reported were moved before the call, so a single caller keeps the full speed without sleeping twice.
+  int64_t costUs = (int64_t)((double)nBytes * 1000000 / speed);
+  int64_t nextUs, endUs;
+  do {
+    nextUs = atomic_load_64(&pDisk->ioNextUs);
+    endUs = TMAX(nextUs, nowUs - costUs) + costUs;
+  } while (atomic_val_compare_exchange_64(&pDisk->ioNextUs, nextUs, endUs) != nextUs);
+
+  return endUs - nowUs;
+}
+
+void tfsThrottle(STfs *pTfs, SDiskID diskId, int64_t nBytes, int64_t speed) {
+  int64_t waitUs = tfsThrottleAt(pTfs, diskId, nBytes, speed, taosGetTimestampUs());
+  if (waitUs >= 1000) {
+    taosMsleep((int32_t)(waitUs / 1000));
+  }
+}
+
 void tfsInitFile(STfs *pTfs, STfsFile *pFile, SDiskID diskId, const char *rname) {
   STfsDisk *pDisk = TFS_DISK_AT(pTfs, diskId);
   if (pDisk == NULL) return;
@@ -721,4 +721,39 @@ TEST_F(TfsTest, 05_MultiDisk) {
   }
 
   tfsClose(pTfs);
-}
\ No newline at end of file
+}
+TEST_F(TfsTest, 06_Throttle) {
+  SDiskCfg dCfg = {0};
+  tstrncpy(dCfg.dir, root, TSDB_FILENAME_LEN);
+  dCfg.level = 0;
+  dCfg.primary = 1;
+
+  taosRemoveDir(root);
+  taosMulMkDir(root);
+  STfs *pTfs = tfsOpen(&dCfg, 1);
+  ASSERT_NE(pTfs, nullptr);
+
+  SDiskID did = {0};
+  int64_t speed = 1000 * 1000;
+  int64_t nowUs = 1000000000;
+
+  // unlimited
+  for (int32_t i = 0; i < 10; i++) {
+    EXPECT_LE(tfsThrottleAt(pTfs, did, speed, 0, nowUs), 0);
+  }
+
+  // 1MB/s, each 100KB costs 100ms of the budget, the first one passes as it was moved before the call
+  EXPECT_LE(tfsThrottleAt(pTfs, did, speed / 10, speed, nowUs), 0);
+  EXPECT_EQ(tfsThrottleAt(pTfs, did, speed / 10, speed, nowUs), 100000);
+  EXPECT_EQ(tfsThrottleAt(pTfs, did, speed / 10, speed, nowUs), 200000);
+
+  // the budget is shared by the callers of the disk
+  EXPECT_EQ(tfsThrottleAt(pTfs, did, speed / 10, speed, nowUs + 150000), 150000);
+
+  // once idle, the budget does not build up
+  nowUs += 10000000;
+  EXPECT_LE(tfsThrottleAt(pTfs, did, speed / 10, speed, nowUs), 0);
+  EXPECT_EQ(tfsThrottleAt(pTfs, did, speed / 10, speed, nowUs), 100000);
+
+  tfsClose(pTfs);
+}
@@ -32,6 +32,7 @@
 #include <sys/sendfile.h>
 #endif
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 #define LINUX_FILE_NO_TEXT_OPTION 0
 #define O_TEXT                    LINUX_FILE_NO_TEXT_OPTION
@@ -751,6 +752,43 @@ int64_t taosFSendFile(TdFilePtr pFileOut, TdFilePtr pFileIn, int64_t *offset, in
 #endif
 }
 
+// Same as taosFSendFile, but lets the file system copy the data without passing it through the page cache of the
+// source, or clone it on file systems that support reflinks. Falls back to taosFSendFile where that is not possible,
+// for example across file systems on older kernels.
+int64_t taosFCopyFile(TdFilePtr pFileOut, TdFilePtr pFileIn, int64_t *offset, int64_t size) {
+  if (pFileOut == NULL || pFileIn == NULL) {
+    return 0;
+  }
+
+#if defined(LINUX) && defined(__NR_copy_file_range)
+  assert(pFileIn->fd >= 0 && pFileOut->fd >= 0);
+
+  int64_t leftbytes = size;
+  while (leftbytes > 0) {
+    int64_t copied = syscall(__NR_copy_file_range, pFileIn->fd, offset, pFileOut->fd, NULL, (size_t)leftbytes, 0);
+    if (copied == -1) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      } else if (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP || errno == EBADF) {
+        int64_t sent = taosFSendFile(pFileOut, pFileIn, offset, leftbytes);
+        if (sent < 0) return -1;
+        return size - leftbytes + sent;
+      } else {
+        return -1;
+      }
+    } else if (copied == 0) {
+      return size - leftbytes;
+    }
+
+    leftbytes -= copied;
+  }
+
+  return size;
+#else
+  return taosFSendFile(pFileOut, pFileIn, offset, size);
+#endif
+}
+
 void taosFprintfFile(TdFilePtr pFile, const char *format, ...) {
   if (pFile == NULL) {
     return;
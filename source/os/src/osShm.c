@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define ALLOW_FORBID_FUNC
+#include "os.h"
+
+#ifdef WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+typedef struct TdShm {
+  char    name[TD_SHM_NAME_LEN];
+  int64_t size;
+  void   *pAddr;
+  bool    owner;
+  bool    linked;
+#ifdef WINDOWS
+  HANDLE hMap;
+#endif
+} TdShm;
+
+static TdShmPtr taosMapShm(const char *name, int64_t size, bool create) {
+  if (name == NULL || strlen(name) >= TD_SHM_NAME_LEN || size <= 0) {
+    terrno = TSDB_CODE_INVALID_PARA;
+    return NULL;
+  }
+
+  TdShmPtr pShm = (TdShmPtr)taosMemoryCalloc(1, sizeof(TdShm));
+  if (pShm == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+  tstrncpy(pShm->name, name, TD_SHM_NAME_LEN);
+  pShm->size = size;
+  pShm->owner = create;
+
+#ifdef WINDOWS
+  if (create) {
+    pShm->hMap = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(size >> 32),
+                                    (DWORD)(size & 0xFFFFFFFF), name);
+    if (pShm->hMap != NULL && GetLastError() == ERROR_ALREADY_EXISTS) {
+      CloseHandle(pShm->hMap);
+      pShm->hMap = NULL;
+    }
+  } else {
+    pShm->hMap = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+  }
+  if (pShm->hMap == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(GetLastError());
+    taosMemoryFree(pShm);
+    return NULL;
+  }
+
+  pShm->pAddr = MapViewOfFile(pShm->hMap, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)size);
+  if (pShm->pAddr == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(GetLastError());
+    CloseHandle(pShm->hMap);
+    taosMemoryFree(pShm);
+    return NULL;
+  }
+#else
+  int32_t fd = create ? shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR) : shm_open(name, O_RDWR, 0);
+  if (fd < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    taosMemoryFree(pShm);
+    return NULL;
+  }
+  pShm->linked = create;
+
+  if (create) {
+    // ftruncate only sets the size, pages of a full /dev/shm would raise SIGBUS on the first access, so reserve them
+#if defined(_TD_DARWIN_64)
+    int32_t code = (ftruncate(fd, size) != 0) ? errno : 0;
+#else
+    int32_t code = posix_fallocate(fd, 0, size);
+#endif
+    if (code != 0) {
+      terrno = TAOS_SYSTEM_ERROR(code);
+      close(fd);
+      taosCloseShm(&pShm);
+      return NULL;
+    }
+  }
+
+  void *pAddr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (pAddr == MAP_FAILED) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    taosCloseShm(&pShm);
+    return NULL;
+  }
+  pShm->pAddr = pAddr;
+#endif
+
+  return pShm;
+}
+
+TdShmPtr taosCreateShm(const char *name, int64_t size) { return taosMapShm(name, size, true); }
+
+TdShmPtr taosOpenShm(const char *name, int64_t size) { return taosMapShm(name, size, false); }
+
+void *taosShmAddr(TdShmPtr pShm) { return (pShm == NULL) ? NULL : pShm->pAddr; }
+
+int64_t taosShmSize(TdShmPtr pShm) { return (pShm == NULL) ? 0 : pShm->size; }
+
+void taosUnlinkShm(TdShmPtr pShm) {
+  if (pShm == NULL) {
+    return;
+  }
+
+#ifndef WINDOWS
+  // any side may remove the name once both of them have mapped the segment
+  shm_unlink(pShm->name);
+#endif
+  pShm->linked = false;
+}
+
+void taosCloseShm(TdShmPtr *ppShm) {
+  if (ppShm == NULL || *ppShm == NULL) {
+    return;
+  }
+
+  TdShmPtr pShm = *ppShm;
+#ifdef WINDOWS
+  if (pShm->pAddr != NULL) {
+    UnmapViewOfFile(pShm->pAddr);
+  }
+  if (pShm->hMap != NULL) {
+    CloseHandle(pShm->hMap);
+  }
+#else
+  if (pShm->pAddr != NULL) {
+    munmap(pShm->pAddr, pShm->size);
+  }
+  if (pShm->owner && pShm->linked) {
+    shm_unlink(pShm->name);
+  }
+#endif
+
+  taosMemoryFree(pShm);
+  *ppShm = NULL;
+}
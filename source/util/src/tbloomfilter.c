@@ -36,7 +36,7 @@ static FORCE_INLINE bool getBit(uint64_t *buf, uint64_t index) {
   return buf[unitIndex] & mask;
 }
 
-SBloomFilter *tBloomFilterInit(uint64_t expectedEntries, double errorRate) {
+static SBloomFilter *bloomFilterInit(uint64_t expectedEntries, double errorRate, bool blocked) {
   if (expectedEntries < 1 || errorRate <= 0 || errorRate >= 1.0) {
     return NULL;
   }
@@ -46,12 +46,16 @@ SBloomFilter *tBloomFilterInit(uint64_t expectedEntries, double errorRate) {
   }
   pBF->expectedEntries = expectedEntries;
   pBF->errorRate = errorRate;
+  pBF->blocked = blocked;
 
   double lnRate = fabs(log(errorRate));
   // ln(2)^2 = 0.480453013918201
   // m = - n * ln(P) / ( ln(2) )^2
   // m is the size of bloom filter, n is expected entries, P is false positive probability
   pBF->numUnits = (uint64_t)ceil(expectedEntries * lnRate / 0.480453013918201 / UNIT_NUM_BITS);
+  if (blocked) {
+    pBF->numUnits = (pBF->numUnits + BF_BLOCK_UNITS - 1) / BF_BLOCK_UNITS * BF_BLOCK_UNITS;
+  }
   pBF->numBits = pBF->numUnits * 64;
   pBF->size = 0;
 
@@ -69,16 +73,45 @@ SBloomFilter *tBloomFilterInit(uint64_t expectedEntries, double errorRate) {
   return pBF;
 }
 
-int32_t tBloomFilterPut(SBloomFilter *pBF, const void *keyBuf, uint32_t len) {
+SBloomFilter *tBloomFilterInit(uint64_t expectedEntries, double errorRate) {
+  return bloomFilterInit(expectedEntries, errorRate, false);
+}
+
+SBloomFilter *tBloomFilterInitBlocked(uint64_t expectedEntries, double errorRate) {
+  return bloomFilterInit(expectedEntries, errorRate, true);
+}
+
+// For a blocked filter the hash pair is mixed into one 64-bit value, the high half selects the block and the low half
+// the bits inside it, so a lookup touches a single cache line.
+static FORCE_INLINE uint64_t *getBlock(const SBloomFilter *pBF, uint64_t h1, uint64_t h2, uint64_t *pBitHash) {
+  uint64_t h = (h1 << 32) ^ h2;
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+  *pBitHash = h & 0xFFFFFFFFULL;
+  return (uint64_t *)pBF->buffer + ((h >> 32) % (pBF->numUnits / BF_BLOCK_UNITS)) * BF_BLOCK_UNITS;
+}
+
+int32_t tBloomFilterPutHash(SBloomFilter *pBF, uint64_t h1, uint64_t h2) {
   ASSERT(!tBloomFilterIsFull(pBF));
-  uint64_t                h1 = (uint64_t)pBF->hashFn1(keyBuf, len);
-  uint64_t                h2 = (uint64_t)pBF->hashFn2(keyBuf, len);
-  bool                    hasChange = false;
-  const register uint64_t size = pBF->numBits;
-  uint64_t                cbHash = h1;
-  for (uint64_t i = 0; i < pBF->hashFunctions; ++i) {
-    hasChange |= setBit(pBF->buffer, cbHash % size);
-    cbHash += h2;
+  bool hasChange = false;
+  if (pBF->blocked) {
+    uint64_t  cbHash = 0;
+    uint64_t *pBlock = getBlock(pBF, h1, h2, &cbHash);
+    uint64_t  delta = (cbHash >> 9) | 1;
+    for (uint64_t i = 0; i < pBF->hashFunctions; ++i) {
+      hasChange |= setBit(pBlock, cbHash % (BF_BLOCK_UNITS * UNIT_NUM_BITS));
+      cbHash += delta;
+    }
+  } else {
+    const register uint64_t size = pBF->numBits;
+    uint64_t                cbHash = h1;
+    for (uint64_t i = 0; i < pBF->hashFunctions; ++i) {
+      hasChange |= setBit(pBF->buffer, cbHash % size);
+      cbHash += h2;
+    }
   }
   if (hasChange) {
     pBF->size++;
@@ -87,9 +120,25 @@ int32_t tBloomFilterPut(SBloomFilter *pBF, const void *keyBuf, uint32_t len) {
   return TSDB_CODE_FAILED;
 }
 
-int32_t tBloomFilterNoContain(const SBloomFilter *pBF, const void *keyBuf, uint32_t len) {
-  uint64_t                h1 = (uint64_t)pBF->hashFn1(keyBuf, len);
-  uint64_t                h2 = (uint64_t)pBF->hashFn2(keyBuf, len);
+int32_t tBloomFilterPut(SBloomFilter *pBF, const void *keyBuf, uint32_t len) {
+  uint64_t h1 = (uint64_t)pBF->hashFn1(keyBuf, len);
+  uint64_t h2 = (uint64_t)pBF->hashFn2(keyBuf, len);
+  return tBloomFilterPutHash(pBF, h1, h2);
+}
+
+int32_t tBloomFilterNoContainHash(const SBloomFilter *pBF, uint64_t h1, uint64_t h2) {
+  if (pBF->blocked) {
+    uint64_t  cbHash = 0;
+    uint64_t *pBlock = getBlock(pBF, h1, h2, &cbHash);
+    uint64_t  delta = (cbHash >> 9) | 1;
+    for (uint64_t i = 0; i < pBF->hashFunctions; ++i) {
+      if (!getBit(pBlock, cbHash % (BF_BLOCK_UNITS * UNIT_NUM_BITS))) {
+        return TSDB_CODE_SUCCESS;
+      }
+      cbHash += delta;
+    }
+    return TSDB_CODE_FAILED;
+  }
   const register uint64_t size = pBF->numBits;
   uint64_t                cbHash = h1;
   for (uint64_t i = 0; i < pBF->hashFunctions; ++i) {
@@ -101,6 +150,12 @@ int32_t tBloomFilterNoContain(const SBloomFilter *pBF, const void *keyBuf, uint3
   return TSDB_CODE_FAILED;
 }
 
+int32_t tBloomFilterNoContain(const SBloomFilter *pBF, const void *keyBuf, uint32_t len) {
+  uint64_t h1 = (uint64_t)pBF->hashFn1(keyBuf, len);
+  uint64_t h2 = (uint64_t)pBF->hashFn2(keyBuf, len);
+  return tBloomFilterNoContainHash(pBF, h1, h2);
+}
+
 void tBloomFilterDestroy(SBloomFilter *pBF) {
   if (pBF == NULL) {
     return;
@@ -120,6 +175,7 @@ int32_t tBloomFilterEncode(const SBloomFilter *pBF, SEncoder *pEncoder) {
     if (tEncodeU64(pEncoder, pUnits[i]) < 0) return -1;
   }
   if (tEncodeDouble(pEncoder, pBF->errorRate) < 0) return -1;
+  if (tEncodeI8(pEncoder, pBF->blocked) < 0) return -1;
   return 0;
 }
 
@@ -137,6 +193,7 @@ SBloomFilter *tBloomFilterDecode(SDecoder *pDecoder) {
     if (tDecodeU64(pDecoder, pUnits + i) < 0) goto _error;
   }
   if (tDecodeDouble(pDecoder, &pBF->errorRate) < 0) goto _error;
+  if (tDecodeI8(pDecoder, &pBF->blocked) < 0) goto _error;
   /*pBF->hashFn1 = taosGetDefaultHashFunction(TSDB_DATA_TYPE_TIMESTAMP);*/
   /*pBF->hashFn2 = taosGetDefaultHashFunction(TSDB_DATA_TYPE_NCHAR);*/
   pBF->hashFn1 = taosFastHash;
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "thll.h"
+#include "thash.h"
+
+#define HLL_MAX_RANK (64 - HLL_SKETCH_BITS + 1)
+
+void tHllAdd(uint8_t *pRegs, const void *pData, uint32_t len) {
+  tHllAddHash(pRegs, MurmurHash3_64((const char *)pData, len));
+}
+
+// the low bits of the hash choose the register, which keeps the max position of the first 1 bit in the rest bits
+void tHllAddHash(uint8_t *pRegs, uint64_t hash) {
+  int32_t  index = (int32_t)(hash & (HLL_SKETCH_REGISTERS - 1));
+  uint64_t bits = hash >> HLL_SKETCH_BITS;
+  uint8_t  rank = (bits == 0) ? HLL_MAX_RANK : (uint8_t)(__builtin_ctzll(bits) + 1);
+  if (rank > pRegs[index]) {
+    pRegs[index] = rank;
+  }
+}
+
+void tHllMerge(uint8_t *pDst, const uint8_t *pSrc) {
+  for (int32_t i = 0; i < HLL_SKETCH_REGISTERS; ++i) {
+    if (pSrc[i] > pDst[i]) {
+      pDst[i] = pSrc[i];
+    }
+  }
+}
+
+int64_t tHllCount(const uint8_t *pRegs) {
+  double  sum = 0;
+  int32_t zeros = 0;
+  for (int32_t i = 0; i < HLL_SKETCH_REGISTERS; ++i) {
+    sum += 1.0 / ((uint64_t)1 << pRegs[i]);
+    if (0 == pRegs[i]) {
+      ++zeros;
+    }
+  }
+
+  const double m = HLL_SKETCH_REGISTERS;
+  double       alpha = 0.7213 / (1 + 1.079 / m);
+  double       estimate = alpha * m * m / sum;
+
+  // linear counting is more accurate for the small cardinalities
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * log(m / zeros);
+  }
+  return (int64_t)(estimate + 0.5);
+}
@@ -520,6 +520,23 @@ static void taosLRUCacheShardEraseUnrefEntries(SLRUCacheShard *shard) {
   taosArrayDestroy(lastReferenceList);
 }
 
+static bool taosLRUCacheShardApply(SLRUCacheShard *shard, _taos_lru_functor_t functor, void *ud) {
+  bool cont = true;
+
+  taosThreadMutexLock(&shard->mutex);
+
+  SLRUEntryTable *table = &shard->table;
+  for (uint32_t i = 0; cont && i < (uint32_t)(1 << table->lengthBits); ++i) {
+    for (SLRUEntry *h = table->list[i]; cont && h; h = h->nextHash) {
+      cont = functor(h->keyData, h->keyLength, h->value, ud);
+    }
+  }
+
+  taosThreadMutexUnlock(&shard->mutex);
+
+  return cont;
+}
+
 static bool taosLRUCacheShardRef(SLRUCacheShard *shard, LRUHandle *handle) {
   SLRUEntry *e = (SLRUEntry *)handle;
   taosThreadMutexLock(&shard->mutex);
@@ -721,6 +738,15 @@ void taosLRUCacheEraseUnrefEntries(SLRUCache *cache) {
   }
 }
 
+void taosLRUCacheApply(SLRUCache *cache, _taos_lru_functor_t functor, void *ud) {
+  int numShards = cache->numShards;
+  for (int i = 0; i < numShards; ++i) {
+    if (!taosLRUCacheShardApply(&cache->shards[i], functor, ud)) {
+      break;
+    }
+  }
+}
+
 bool taosLRUCacheRef(SLRUCache *cache, LRUHandle *handle) {
   if (handle == NULL) {
     return false;
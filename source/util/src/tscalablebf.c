@@ -23,7 +23,7 @@
 
 static SBloomFilter *tScalableBfAddFilter(SScalableBf *pSBf, uint64_t expectedEntries, double errorRate);
 
-SScalableBf *tScalableBfInit(uint64_t expectedEntries, double errorRate) {
+static SScalableBf *scalableBfInit(uint64_t expectedEntries, double errorRate, bool blocked) {
   const uint32_t defaultSize = 8;
   if (expectedEntries < 1 || errorRate <= 0 || errorRate >= 1.0) {
     return NULL;
@@ -33,6 +33,7 @@ SScalableBf *tScalableBfInit(uint64_t expectedEntries, double errorRate) {
     return NULL;
   }
   pSBf->numBits = 0;
+  pSBf->blocked = blocked;
   pSBf->bfArray = taosArrayInit(defaultSize, sizeof(void *));
   if (tScalableBfAddFilter(pSBf, expectedEntries, errorRate * DEFAULT_TIGHTENING_RATIO) == NULL) {
     tScalableBfDestroy(pSBf);
@@ -42,10 +43,24 @@ SScalableBf *tScalableBfInit(uint64_t expectedEntries, double errorRate) {
   return pSBf;
 }
 
+SScalableBf *tScalableBfInit(uint64_t expectedEntries, double errorRate) {
+  return scalableBfInit(expectedEntries, errorRate, false);
+}
+
+SScalableBf *tScalableBfInitBlocked(uint64_t expectedEntries, double errorRate) {
+  return scalableBfInit(expectedEntries, errorRate, true);
+}
+
 int32_t tScalableBfPut(SScalableBf *pSBf, const void *keyBuf, uint32_t len) {
+  SBloomFilter *pBF = taosArrayGetP(pSBf->bfArray, 0);
+  return tScalableBfPutHash(pSBf, pBF->hashFn1(keyBuf, len), pBF->hashFn2(keyBuf, len));
+}
+
+// the hash values are computed once by the caller and shared by all filters of the array
+int32_t tScalableBfPutHash(SScalableBf *pSBf, uint64_t h1, uint64_t h2) {
   int32_t size = taosArrayGetSize(pSBf->bfArray);
   for (int32_t i = size - 2; i >= 0; --i) {
-    if (tBloomFilterNoContain(taosArrayGetP(pSBf->bfArray, i), keyBuf, len) != TSDB_CODE_SUCCESS) {
+    if (tBloomFilterNoContainHash(taosArrayGetP(pSBf->bfArray, i), h1, h2) != TSDB_CODE_SUCCESS) {
       return TSDB_CODE_FAILED;
     }
   }
@@ -59,13 +74,18 @@ int32_t tScalableBfPut(SScalableBf *pSBf, const void *keyBuf, uint32_t len) {
       return TSDB_CODE_OUT_OF_MEMORY;
     }
   }
-  return tBloomFilterPut(pNormalBf, keyBuf, len);
+  return tBloomFilterPutHash(pNormalBf, h1, h2);
 }
 
 int32_t tScalableBfNoContain(const SScalableBf *pSBf, const void *keyBuf, uint32_t len) {
+  SBloomFilter *pBF = taosArrayGetP(pSBf->bfArray, 0);
+  return tScalableBfNoContainHash(pSBf, pBF->hashFn1(keyBuf, len), pBF->hashFn2(keyBuf, len));
+}
+
+int32_t tScalableBfNoContainHash(const SScalableBf *pSBf, uint64_t h1, uint64_t h2) {
   int32_t size = taosArrayGetSize(pSBf->bfArray);
   for (int32_t i = size - 1; i >= 0; --i) {
-    if (tBloomFilterNoContain(taosArrayGetP(pSBf->bfArray, i), keyBuf, len) != TSDB_CODE_SUCCESS) {
+    if (tBloomFilterNoContainHash(taosArrayGetP(pSBf->bfArray, i), h1, h2) != TSDB_CODE_SUCCESS) {
       return TSDB_CODE_FAILED;
     }
   }
@@ -73,7 +93,8 @@ int32_t tScalableBfNoContain(const SScalableBf *pSBf, const void *keyBuf, uint32
 }
 
 static SBloomFilter *tScalableBfAddFilter(SScalableBf *pSBf, uint64_t expectedEntries, double errorRate) {
-  SBloomFilter *pNormalBf = tBloomFilterInit(expectedEntries, errorRate);
+  SBloomFilter *pNormalBf = pSBf->blocked ? tBloomFilterInitBlocked(expectedEntries, errorRate)
+                                          : tBloomFilterInit(expectedEntries, errorRate);
   if (pNormalBf == NULL) {
     return NULL;
   }
@@ -108,6 +129,7 @@ int32_t tScalableBfEncode(const SScalableBf *pSBf, SEncoder *pEncoder) {
   }
   if (tEncodeU32(pEncoder, pSBf->growth) < 0) return -1;
   if (tEncodeU64(pEncoder, pSBf->numBits) < 0) return -1;
+  if (tEncodeI8(pEncoder, pSBf->blocked) < 0) return -1;
   return 0;
 }
 
@@ -128,6 +150,7 @@ SScalableBf *tScalableBfDecode(SDecoder *pDecoder) {
   }
   if (tDecodeU32(pDecoder, &pSBf->growth) < 0) goto _error;
   if (tDecodeU64(pDecoder, &pSBf->numBits) < 0) goto _error;
+  if (tDecodeI8(pDecoder, &pSBf->blocked) < 0) goto _error;
   return pSBf;
 
 _error:
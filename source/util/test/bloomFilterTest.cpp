@@ -134,4 +134,39 @@ TEST(TD_UTIL_BLOOMFILTER_TEST, scalable_bloomFilter) {
 
   tScalableBfDestroy(pSBF1);
   tScalableBfDestroy(pSBF4);
-}
\ No newline at end of file
+}
+TEST(TD_UTIL_BLOOMFILTER_TEST, blocked_bloomFilter) {
+  int64_t ts1 = 1650803518000;
+
+  SBloomFilter *pBF1 = tBloomFilterInitBlocked(100, 0.005);
+  GTEST_ASSERT_EQ(pBF1->numUnits % BF_BLOCK_UNITS, 0);
+  GTEST_ASSERT_EQ(pBF1->numBits, pBF1->numUnits * 64);
+  tBloomFilterDestroy(pBF1);
+
+  SScalableBf *pSBF1 = tScalableBfInitBlocked(1000, 0.01);
+  int64_t      count = 0;
+  int64_t      index = 0;
+  for (; count < 3000; index++) {
+    int64_t ts = index + ts1;
+    if (tScalableBfPut(pSBF1, &ts, sizeof(int64_t)) == TSDB_CODE_SUCCESS) {
+      count++;
+    }
+  }
+  GTEST_ASSERT_GT(taosArrayGetSize(pSBF1->bfArray), 1);
+
+  for (int64_t i = 0; i < index; i++) {
+    int64_t ts = i + ts1;
+    GTEST_ASSERT_EQ(tScalableBfNoContain(pSBF1, &ts, sizeof(int64_t)), TSDB_CODE_FAILED);
+  }
+
+  int64_t falsePositive = 0;
+  for (int64_t i = index; i < index + 10000; i++) {
+    int64_t ts = i + ts1;
+    if (tScalableBfNoContain(pSBF1, &ts, sizeof(int64_t)) != TSDB_CODE_SUCCESS) {
+      falsePositive++;
+    }
+  }
+  GTEST_ASSERT_LT(falsePositive, 300);
+
+  tScalableBfDestroy(pSBF1);
+}
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include "thll.h"
+
+TEST(HyperLogLogTest, count) {
+  int64_t counts[] = {0, 1, 10, 100, 1000, 100000, 1000000};
+  for (int64_t n : counts) {
+    uint8_t regs[HLL_SKETCH_REGISTERS] = {0};
+    for (int64_t i = 0; i < n; ++i) {
+      tHllAdd(regs, &i, sizeof(i));
+      // duplicates do not change the sketch
+      tHllAdd(regs, &i, sizeof(i));
+    }
+
+    int64_t estimate = tHllCount(regs);
+    if (n <= 1) {
+      ASSERT_EQ(estimate, n);
+    } else {
+      ASSERT_NEAR((double)estimate, (double)n, n * 0.3);
+    }
+  }
+}
+
+TEST(HyperLogLogTest, merge) {
+  uint8_t all[HLL_SKETCH_REGISTERS] = {0};
+  uint8_t merged[HLL_SKETCH_REGISTERS] = {0};
+
+  // the values are spread over the parts with overlaps, like the tag values of the child tables in vgroups
+  for (int32_t part = 0; part < 4; ++part) {
+    uint8_t regs[HLL_SKETCH_REGISTERS] = {0};
+    for (int64_t i = part * 5000; i < part * 5000 + 10000; ++i) {
+      tHllAdd(regs, &i, sizeof(i));
+      tHllAdd(all, &i, sizeof(i));
+    }
+    tHllMerge(merged, regs);
+  }
+
+  ASSERT_EQ(memcmp(all, merged, HLL_SKETCH_REGISTERS), 0);
+  ASSERT_NEAR((double)tHllCount(merged), 25000.0, 25000 * 0.3);
+}
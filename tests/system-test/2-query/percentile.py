@@ -117,6 +117,9 @@ class TDTestCase:
                 else:
                     tdSql.query(f'select percentile({k}, {param}) from {self.ntbname}')
                     tdSql.checkData(0, 0, np.percentile(floatData, param))
+        tdSql.query(f'select percentile(col4, 10, 50, 90) from {self.ntbname}')
+        tdSql.checkEqual(tdSql.queryResult[0][0], '[%.15g, %.15g, %.15g]' % tuple(np.percentile(intData, [10, 50, 90])))
+        tdSql.error(f'select percentile(col4, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11) from {self.ntbname}')
         tdSql.execute(f'drop database {self.dbname}')
     def function_check_ctb(self):
         tdSql.execute(f'create database {self.dbname}')
@@ -145,6 +148,8 @@ class TDTestCase:
                         data_num = tdSql.queryResult[0][0]
                         tdSql.query(f'select percentile({k},{param}) from {self.stbname}_{i}')
                         tdSql.checkData(0,0,data_num)
+        tdSql.error(f'select percentile(col4, 50) from {self.stbname}')
+        tdSql.error(f'select percentile(col4, 50) from {self.stbname}_0 partition by tbname')
         tdSql.execute(f'drop database {self.dbname}')            
     def run(self):
         self.function_check_ntb()